@@ -196,6 +196,17 @@ void GameScene::Update()
 	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_D);
 	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_R);
 	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_T);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_C);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_B);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_F);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_X);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_O);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_V);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_K);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_N);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_M);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_L);
+	SINGLETON_INSTANCE(Lib::InputDeviceManager)->KeyCheck(DIK_P);
 	SINGLETON_INSTANCE(Lib::InputDeviceManager)->MouseUpdate();
 
 #ifdef _DEBUG
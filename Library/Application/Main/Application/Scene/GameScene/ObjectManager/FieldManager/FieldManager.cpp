@@ -17,10 +17,10 @@
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-FieldManager::FieldManager()
+FieldManager::FieldManager(TerrainHeightField* _pTerrainHeightField)
 {
-	m_pObjects.push_back(new Ground());
-	m_pObjects.push_back(new Mountain());
+	m_pObjects.push_back(new Ground(_pTerrainHeightField));
+	m_pObjects.push_back(new Mountain(_pTerrainHeightField));
 	m_pObjects.push_back(new Sky());
 }
 
@@ -12,6 +12,9 @@
 #include "ObjectManagerBase\ObjectManagerBase.h"
 
 
+class TerrainHeightField;
+
+
 /**
  * フィールド管理クラス
  */
@@ -20,8 +23,9 @@ class FieldManager : public Lib::ObjectManagerBase
 public:
 	/**
 	 * コンストラクタ
+	 * @param[in] _pTerrainHeightField 地面と山のモデルを追加する地形の高さマップ
 	 */
-	FieldManager();
+	FieldManager(TerrainHeightField* _pTerrainHeightField);
 
 	/**
 	 * デストラクタ
@@ -13,6 +13,7 @@
 #include "DirectX11\FbxFileManager\Dx11FbxFileManager.h"
 #include "DirectX11\GraphicsDevice\Dx11GraphicsDevice.h"
 #include "DirectX11\ShaderManager\Dx11ShaderManager.h"
+#include "..\TerrainHeightField\TerrainHeightField.h"
 
 
 //----------------------------------------------------------------------
@@ -24,9 +25,12 @@ D3DXVECTOR3 Ground::m_DefaultScale = D3DXVECTOR3(3.5, 3.5, 3.5);
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-Ground::Ground()
+Ground::Ground(TerrainHeightField* _pTerrainHeightField)
 {
 	m_Scale = m_DefaultScale;
+
+	// 描画と同じスケーリング値で地面の高さを地形の高さマップに描き込む.
+	_pTerrainHeightField->AddModel("Resource\\Model\\map.fbx", m_Scale.x, m_Scale.y, m_Scale.z);
 }
 
 Ground::~Ground()
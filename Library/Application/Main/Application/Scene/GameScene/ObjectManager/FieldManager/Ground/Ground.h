@@ -12,6 +12,9 @@
 #include "Main\Object3DBase\Object3DBase.h"
 
 
+class TerrainHeightField;
+
+
 /**
  * 地面の管理クラス
  */
@@ -20,8 +23,9 @@ class Ground : public Object3DBase
 public:
 	/**
 	 * コンストラクタ
+	 * @param[in] _pTerrainHeightField モデルを追加する地形の高さマップ
 	 */
-	Ground();
+	Ground(TerrainHeightField* _pTerrainHeightField);
 
 	/**
 	 * デストラクタ
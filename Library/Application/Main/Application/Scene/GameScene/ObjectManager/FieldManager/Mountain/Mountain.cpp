@@ -13,6 +13,7 @@
 #include "DirectX11\FbxFileManager\Dx11FbxFileManager.h"
 #include "DirectX11\GraphicsDevice\Dx11GraphicsDevice.h"
 #include "DirectX11\ShaderManager\Dx11ShaderManager.h"
+#include "..\TerrainHeightField\TerrainHeightField.h"
 
 
 //----------------------------------------------------------------------
@@ -24,9 +25,12 @@ D3DXVECTOR3 Mountain::m_DefaultScale = D3DXVECTOR3(3.5, 3.5, 3.5);
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-Mountain::Mountain()
+Mountain::Mountain(TerrainHeightField* _pTerrainHeightField)
 {
 	m_Scale = m_DefaultScale;
+
+	// 描画と同じスケーリング値で山の高さを地形の高さマップに描き込む.
+	_pTerrainHeightField->AddModel("Resource\\Model\\mountain.fbx", m_Scale.x, m_Scale.y, m_Scale.z);
 }
 
 Mountain::~Mountain()
@@ -110,6 +114,7 @@ void Mountain::CubeMapDraw()
 	VertexLayoutSetup();
 	DepthStencilStateSetup();
 	ConstantBufferSetup();
+	pDeviceContext->GSSetConstantBuffers(0, 1, &m_pConstantBuffer);	// ジオメトリシェーダーで写る面を参照する.
 	pFbxFileManager->GetFbxModel(m_MountainModelIndex)->Draw();
 }
 
@@ -101,6 +101,7 @@ void Sky::CubeMapDraw()
 	VertexLayoutSetup();
 	DepthStencilStateSetup();
 	ConstantBufferSetup();
+	pDeviceContext->GSSetConstantBuffers(0, 1, &m_pConstantBuffer);	// ジオメトリシェーダーで写る面を参照する.
 	pFbxFileManager->GetFbxModel(m_SkyModelIndex)->Draw();
 }
 
@@ -0,0 +1,773 @@
+﻿/**
+ * @file	TerrainHeightField.cpp
+ * @brief	地形の高さマップクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "TerrainHeightField.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Main\ThreadPool\ThreadPool.h"
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const unsigned int TerrainHeightField::m_Version = 1;
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const char TerrainHeightField::m_Magic[4] = { 'T', 'R', 'H', 'F' };
+const int TerrainHeightField::m_PointNumMax = 1 << 24;
+const int TerrainHeightField::m_BandRowNum = 16;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+TerrainHeightField::TerrainHeightField() :
+	m_pThreadPool(nullptr),
+	m_SimdType(CpuFeature::GetSimdType()),
+	m_PointNumX(0),
+	m_PointNumZ(0),
+	m_MinX(0.0f),
+	m_MinZ(0.0f),
+	m_CellSize(1.0f),
+	m_InvCellSize(1.0f),
+	m_BaseHeight(0.0f),
+	m_IsCacheLoaded(false)
+{
+}
+
+TerrainHeightField::~TerrainHeightField()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void TerrainHeightField::AddModel(const char* _pFileName, float _scaleX, float _scaleY, float _scaleZ)
+{
+	MODEL Model;
+	Model.FileName = _pFileName;
+	Model.Scale[0] = _scaleX;
+	Model.Scale[1] = _scaleY;
+	Model.Scale[2] = _scaleZ;
+	m_Models.push_back(Model);
+}
+
+bool TerrainHeightField::Build(const char* _pCacheFileName, float _cellSize)
+{
+	Release();
+
+	if (_cellSize <= 0.0f)
+	{
+		return false;
+	}
+
+	// キャッシュの照合にもモデルの内容を使うので, 三角形は毎回読み込む.
+	std::vector<TRIANGLE> Triangles;
+	for (auto itr = m_Models.begin(); itr != m_Models.end(); itr++)
+	{
+		if (!ReadFbxTriangles(*itr, &Triangles))
+		{
+			return false;
+		}
+	}
+
+	if (Triangles.empty())
+	{
+		return false;
+	}
+
+	float MinX = FLT_MAX, MaxX = -FLT_MAX;
+	float MinZ = FLT_MAX, MaxZ = -FLT_MAX;
+	for (auto itr = Triangles.begin(); itr != Triangles.end(); itr++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			MinX = std::min(MinX, itr->X[i]);
+			MaxX = std::max(MaxX, itr->X[i]);
+			MinZ = std::min(MinZ, itr->Z[i]);
+			MaxZ = std::max(MaxZ, itr->Z[i]);
+		}
+	}
+
+	// 端の格子点がモデルの範囲を含むように, 格子点の間隔の倍数にそろえる.
+	m_CellSize = _cellSize;
+	m_InvCellSize = 1.0f / _cellSize;
+	m_MinX = std::floor(MinX * m_InvCellSize) * m_CellSize;
+	m_MinZ = std::floor(MinZ * m_InvCellSize) * m_CellSize;
+	long long PointNumX = static_cast<long long>(std::ceil((MaxX - m_MinX) * m_InvCellSize)) + 1;
+	long long PointNumZ = static_cast<long long>(std::ceil((MaxZ - m_MinZ) * m_InvCellSize)) + 1;
+	PointNumX = std::max(PointNumX, 2LL);
+	PointNumZ = std::max(PointNumZ, 2LL);
+	if (PointNumX * PointNumZ > m_PointNumMax)
+	{
+		return false;
+	}
+
+	m_PointNumX = static_cast<int>(PointNumX);
+	m_PointNumZ = static_cast<int>(PointNumZ);
+
+	unsigned int SourceKey = Hash(2166136261u, &m_Version, sizeof(m_Version));
+	SourceKey = Hash(SourceKey, &m_CellSize, sizeof(m_CellSize));
+	SourceKey = Hash(SourceKey, &m_BaseHeight, sizeof(m_BaseHeight));
+	SourceKey = Hash(SourceKey, &Triangles[0], sizeof(TRIANGLE) * Triangles.size());
+
+	if (_pCacheFileName != nullptr && LoadCache(_pCacheFileName, SourceKey))
+	{
+		m_IsCacheLoaded = true;
+		return true;
+	}
+
+	RasterizeHeight(Triangles);
+	ComputeNormal();
+
+	if (_pCacheFileName != nullptr)
+	{
+		SaveCache(_pCacheFileName, SourceKey);
+	}
+
+	return true;
+}
+
+void TerrainHeightField::Release()
+{
+	std::vector<float>().swap(m_Height);
+	std::vector<float>().swap(m_NormalX);
+	std::vector<float>().swap(m_NormalY);
+	std::vector<float>().swap(m_NormalZ);
+	m_PointNumX = 0;
+	m_PointNumZ = 0;
+	m_IsCacheLoaded = false;
+}
+
+float TerrainHeightField::GetHeight(float _x, float _z) const
+{
+	float Height;
+	SampleHeight(&_x, &_z, 1, &Height);
+	return Height;
+}
+
+void TerrainHeightField::SampleHeight(const float* _pX, const float* _pZ, int _count, float* _pHeight) const
+{
+	if (m_Height.empty())
+	{
+		std::fill(_pHeight, _pHeight + std::max(_count, 0), m_BaseHeight);
+		return;
+	}
+
+	GetSampleFunc(m_SimdType)(
+		m_Height.data(), m_PointNumX, m_PointNumZ, m_MinX, m_MinZ, m_InvCellSize,
+		_pX, _pZ, _count, _pHeight);
+}
+
+void TerrainHeightField::SampleNormal(const float* _pX, const float* _pZ, int _count, float* _pNormalX, float* _pNormalY, float* _pNormalZ) const
+{
+	if (m_Height.empty())
+	{
+		std::fill(_pNormalX, _pNormalX + std::max(_count, 0), 0.0f);
+		std::fill(_pNormalY, _pNormalY + std::max(_count, 0), 1.0f);
+		std::fill(_pNormalZ, _pNormalZ + std::max(_count, 0), 0.0f);
+		return;
+	}
+
+	// 法線の各成分を高さと同じく補間してから正規化する(補間した法線のyは常に正).
+	SAMPLE_FUNC pSampleFunc = GetSampleFunc(m_SimdType);
+	pSampleFunc(m_NormalX.data(), m_PointNumX, m_PointNumZ, m_MinX, m_MinZ, m_InvCellSize, _pX, _pZ, _count, _pNormalX);
+	pSampleFunc(m_NormalY.data(), m_PointNumX, m_PointNumZ, m_MinX, m_MinZ, m_InvCellSize, _pX, _pZ, _count, _pNormalY);
+	pSampleFunc(m_NormalZ.data(), m_PointNumX, m_PointNumZ, m_MinX, m_MinZ, m_InvCellSize, _pX, _pZ, _count, _pNormalZ);
+
+	for (int i = 0; i < _count; i++)
+	{
+		float InvLength = 1.0f / std::sqrt(
+			_pNormalX[i] * _pNormalX[i] + _pNormalY[i] * _pNormalY[i] + _pNormalZ[i] * _pNormalZ[i]);
+		_pNormalX[i] *= InvLength;
+		_pNormalY[i] *= InvLength;
+		_pNormalZ[i] *= InvLength;
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void TerrainHeightField::RasterizeHeight(const std::vector<TRIANGLE>& _triangles)
+{
+	m_Height.assign(static_cast<size_t>(m_PointNumX) * m_PointNumZ, -FLT_MAX);
+
+	// 行をまとまりに分けて, まとまりごとに全ての三角形を描き込む(書き込む行が重ならないので排他は要らない).
+	int BandNum = (m_PointNumZ + m_BandRowNum - 1) / m_BandRowNum;
+	auto RasterizeBand = [&](int _band)
+	{
+		int BandBegin = _band * m_BandRowNum;
+		int BandEnd = std::min(BandBegin + m_BandRowNum, m_PointNumZ) - 1;
+
+		for (auto itr = _triangles.begin(); itr != _triangles.end(); itr++)
+		{
+			const TRIANGLE& Triangle = *itr;
+
+			// 真上から見て面積の無い三角形(壁)は高さに影響しない.
+			float Area =
+				(Triangle.X[1] - Triangle.X[0]) * (Triangle.Z[2] - Triangle.Z[0]) -
+				(Triangle.X[2] - Triangle.X[0]) * (Triangle.Z[1] - Triangle.Z[0]);
+			if (std::fabs(Area) <= FLT_EPSILON)
+			{
+				continue;
+			}
+
+			float TriMinX = std::min(std::min(Triangle.X[0], Triangle.X[1]), Triangle.X[2]);
+			float TriMaxX = std::max(std::max(Triangle.X[0], Triangle.X[1]), Triangle.X[2]);
+			float TriMinZ = std::min(std::min(Triangle.Z[0], Triangle.Z[1]), Triangle.Z[2]);
+			float TriMaxZ = std::max(std::max(Triangle.Z[0], Triangle.Z[1]), Triangle.Z[2]);
+
+			int MinRow = std::max(static_cast<int>(std::ceil((TriMinZ - m_MinZ) * m_InvCellSize)), BandBegin);
+			int MaxRow = std::min(static_cast<int>(std::floor((TriMaxZ - m_MinZ) * m_InvCellSize)), BandEnd);
+			int MinColumn = std::max(static_cast<int>(std::ceil((TriMinX - m_MinX) * m_InvCellSize)), 0);
+			int MaxColumn = std::min(static_cast<int>(std::floor((TriMaxX - m_MinX) * m_InvCellSize)), m_PointNumX - 1);
+
+			float InvArea = 1.0f / Area;
+			for (int z = MinRow; z <= MaxRow; z++)
+			{
+				float PointZ = m_MinZ + static_cast<float>(z) * m_CellSize;
+				float* pRow = &m_Height[static_cast<size_t>(z) * m_PointNumX];
+
+				for (int x = MinColumn; x <= MaxColumn; x++)
+				{
+					float PointX = m_MinX + static_cast<float>(x) * m_CellSize;
+
+					// 重心座標が全て0以上なら三角形の内側(隣の三角形と共有する辺上は両方に含める).
+					float Weight1 = ((PointX - Triangle.X[0]) * (Triangle.Z[2] - Triangle.Z[0]) - (Triangle.X[2] - Triangle.X[0]) * (PointZ - Triangle.Z[0])) * InvArea;
+					float Weight2 = ((Triangle.X[1] - Triangle.X[0]) * (PointZ - Triangle.Z[0]) - (PointX - Triangle.X[0]) * (Triangle.Z[1] - Triangle.Z[0])) * InvArea;
+					float Weight0 = 1.0f - Weight1 - Weight2;
+					if (Weight0 < -1e-5f || Weight1 < -1e-5f || Weight2 < -1e-5f)
+					{
+						continue;
+					}
+
+					float Height = Weight0 * Triangle.Y[0] + Weight1 * Triangle.Y[1] + Weight2 * Triangle.Y[2];
+					pRow[x] = std::max(pRow[x], Height);
+				}
+			}
+		}
+
+		// どの三角形にも含まれなかった格子点は基準の高さにする.
+		for (size_t i = static_cast<size_t>(BandBegin) * m_PointNumX; i < static_cast<size_t>(BandEnd + 1) * m_PointNumX; i++)
+		{
+			m_Height[i] = m_Height[i] == -FLT_MAX ? m_BaseHeight : m_Height[i];
+		}
+	};
+
+	if (m_pThreadPool != nullptr && BandNum > 1)
+	{
+		m_pThreadPool->ParallelFor(BandNum, RasterizeBand);
+	}
+	else
+	{
+		for (int i = 0; i < BandNum; i++)
+		{
+			RasterizeBand(i);
+		}
+	}
+}
+
+void TerrainHeightField::ComputeNormal()
+{
+	size_t PointNum = static_cast<size_t>(m_PointNumX) * m_PointNumZ;
+	m_NormalX.resize(PointNum);
+	m_NormalY.resize(PointNum);
+	m_NormalZ.resize(PointNum);
+
+	int BandNum = (m_PointNumZ + m_BandRowNum - 1) / m_BandRowNum;
+	auto ComputeBand = [&](int _band)
+	{
+		int BandBegin = _band * m_BandRowNum;
+		int BandEnd = std::min(BandBegin + m_BandRowNum, m_PointNumZ);
+
+		for (int z = BandBegin; z < BandEnd; z++)
+		{
+			// 端の格子点は片側の差分になる.
+			int Back = std::max(z - 1, 0);
+			int Front = std::min(z + 1, m_PointNumZ - 1);
+			float InvDistZ = m_InvCellSize / static_cast<float>(Front - Back);
+
+			for (int x = 0; x < m_PointNumX; x++)
+			{
+				int Left = std::max(x - 1, 0);
+				int Right = std::min(x + 1, m_PointNumX - 1);
+				float InvDistX = m_InvCellSize / static_cast<float>(Right - Left);
+
+				float SlopeX = (m_Height[static_cast<size_t>(z) * m_PointNumX + Right] - m_Height[static_cast<size_t>(z) * m_PointNumX + Left]) * InvDistX;
+				float SlopeZ = (m_Height[static_cast<size_t>(Front) * m_PointNumX + x] - m_Height[static_cast<size_t>(Back) * m_PointNumX + x]) * InvDistZ;
+				float InvLength = 1.0f / std::sqrt(SlopeX * SlopeX + 1.0f + SlopeZ * SlopeZ);
+
+				size_t Index = static_cast<size_t>(z) * m_PointNumX + x;
+				m_NormalX[Index] = -SlopeX * InvLength;
+				m_NormalY[Index] = InvLength;
+				m_NormalZ[Index] = -SlopeZ * InvLength;
+			}
+		}
+	};
+
+	if (m_pThreadPool != nullptr && BandNum > 1)
+	{
+		m_pThreadPool->ParallelFor(BandNum, ComputeBand);
+	}
+	else
+	{
+		for (int i = 0; i < BandNum; i++)
+		{
+			ComputeBand(i);
+		}
+	}
+}
+
+bool TerrainHeightField::LoadCache(const char* _pFileName, unsigned int _sourceKey)
+{
+	std::ifstream File(_pFileName, std::ios::binary);
+	if (!File)
+	{
+		return false;
+	}
+
+	HEADER Header;
+	if (!File.read(reinterpret_cast<char*>(&Header), sizeof(HEADER)))
+	{
+		return false;
+	}
+
+	// 格子の範囲はモデルから求め直した値と完全に一致する必要がある.
+	if (memcmp(Header.Magic, m_Magic, sizeof(m_Magic)) != 0 ||
+		Header.Version != m_Version ||
+		Header.HeaderSize != sizeof(HEADER) ||
+		Header.SourceKey != _sourceKey ||
+		Header.PointNumX != m_PointNumX || Header.PointNumZ != m_PointNumZ ||
+		Header.MinX != m_MinX || Header.MinZ != m_MinZ || Header.CellSize != m_CellSize)
+	{
+		return false;
+	}
+
+	size_t PointNum = static_cast<size_t>(m_PointNumX) * m_PointNumZ;
+	std::vector<float>* pPlanes[] = { &m_Height, &m_NormalX, &m_NormalY, &m_NormalZ };
+	unsigned int Checksum = 2166136261u;
+
+	for (int i = 0; i < 4; i++)
+	{
+		pPlanes[i]->resize(PointNum);
+		if (!File.read(reinterpret_cast<char*>(pPlanes[i]->data()), sizeof(float) * PointNum))
+		{
+			Release();
+			return false;
+		}
+
+		Checksum = Hash(Checksum, pPlanes[i]->data(), sizeof(float) * PointNum);
+	}
+
+	if (Checksum != Header.Checksum)
+	{
+		Release();
+		return false;
+	}
+
+	return true;
+}
+
+bool TerrainHeightField::SaveCache(const char* _pFileName, unsigned int _sourceKey) const
+{
+	size_t PointNum = static_cast<size_t>(m_PointNumX) * m_PointNumZ;
+	const std::vector<float>* pPlanes[] = { &m_Height, &m_NormalX, &m_NormalY, &m_NormalZ };
+
+	HEADER Header;
+	memset(&Header, 0, sizeof(HEADER));
+	memcpy(Header.Magic, m_Magic, sizeof(m_Magic));
+	Header.Version = m_Version;
+	Header.HeaderSize = sizeof(HEADER);
+	Header.SourceKey = _sourceKey;
+	Header.PointNumX = m_PointNumX;
+	Header.PointNumZ = m_PointNumZ;
+	Header.MinX = m_MinX;
+	Header.MinZ = m_MinZ;
+	Header.CellSize = m_CellSize;
+	Header.Checksum = 2166136261u;
+	for (int i = 0; i < 4; i++)
+	{
+		Header.Checksum = Hash(Header.Checksum, pPlanes[i]->data(), sizeof(float) * PointNum);
+	}
+
+	std::ofstream File(_pFileName, std::ios::binary | std::ios::trunc);
+	if (!File)
+	{
+		return false;
+	}
+
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(HEADER));
+	for (int i = 0; i < 4; i++)
+	{
+		File.write(reinterpret_cast<const char*>(pPlanes[i]->data()), sizeof(float) * PointNum);
+	}
+
+	return static_cast<bool>(File);
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+bool TerrainHeightField::ReadFbxTriangles(const MODEL& _model, std::vector<TRIANGLE>* _pTriangles)
+{
+	std::ifstream File(_model.FileName.c_str(), std::ios::binary);
+	if (!File)
+	{
+		return false;
+	}
+
+	std::stringstream Stream;
+	Stream << File.rdbuf();
+	std::string Text = Stream.str();
+
+	// メッシュごとにVerticesとPolygonVertexIndexが並んでいるので, 順番に読み込む.
+	size_t Offset = 0;
+	bool IsFound = false;
+	for (;;)
+	{
+		size_t GeometryPos = Text.find("Geometry: ", Offset);
+		if (GeometryPos == std::string::npos)
+		{
+			break;
+		}
+
+		size_t NextPos = Text.find("Geometry: ", GeometryPos + 1);
+		std::string Geometry = Text.substr(GeometryPos, NextPos == std::string::npos ? std::string::npos : NextPos - GeometryPos);
+		Offset = GeometryPos + 1;
+
+		std::vector<double> Vertices;
+		std::vector<double> Indices;
+		if (!ReadFbxArray(Geometry, "Vertices: ", &Vertices) ||
+			!ReadFbxArray(Geometry, "PolygonVertexIndex: ", &Indices))
+		{
+			continue;
+		}
+
+		size_t VertexNum = Vertices.size() / 3;
+		size_t PolygonBegin = 0;
+		for (size_t i = 0; i < Indices.size(); i++)
+		{
+			// 多角形の最後の頂点はインデックスがビット反転されている.
+			if (Indices[i] >= 0.0)
+			{
+				continue;
+			}
+
+			// 多角形は最初の頂点を中心に扇状に三角形へ分割する.
+			for (size_t j = PolygonBegin + 1; j + 1 <= i; j++)
+			{
+				size_t Corner[3] =
+				{
+					static_cast<size_t>(Indices[PolygonBegin]),
+					static_cast<size_t>(Indices[j]),
+					static_cast<size_t>(j + 1 == i ? -Indices[i] - 1.0 : Indices[j + 1])
+				};
+
+				TRIANGLE Triangle;
+				bool IsValid = true;
+				for (int k = 0; k < 3; k++)
+				{
+					if (Corner[k] >= VertexNum)
+					{
+						IsValid = false;
+						break;
+					}
+
+					Triangle.X[k] = static_cast<float>(Vertices[Corner[k] * 3 + 0]) * _model.Scale[0];
+					Triangle.Y[k] = static_cast<float>(Vertices[Corner[k] * 3 + 1]) * _model.Scale[1];
+					Triangle.Z[k] = static_cast<float>(Vertices[Corner[k] * 3 + 2]) * _model.Scale[2];
+				}
+
+				if (IsValid)
+				{
+					_pTriangles->push_back(Triangle);
+				}
+			}
+
+			PolygonBegin = i + 1;
+		}
+
+		IsFound = true;
+	}
+
+	return IsFound;
+}
+
+bool TerrainHeightField::ReadFbxArray(const std::string& _text, const char* _pName, std::vector<double>* _pValue)
+{
+	// "名前: *要素数 { a: 値,値,... }"の形式.
+	size_t NamePos = _text.find(_pName);
+	if (NamePos == std::string::npos)
+	{
+		return false;
+	}
+
+	size_t BeginPos = _text.find("a:", NamePos);
+	size_t EndPos = _text.find('}', NamePos);
+	if (BeginPos == std::string::npos || EndPos == std::string::npos || BeginPos > EndPos)
+	{
+		return false;
+	}
+
+	const char* pCurrent = _text.c_str() + BeginPos + 2;
+	const char* pEnd = _text.c_str() + EndPos;
+	while (pCurrent < pEnd)
+	{
+		char* pNext = nullptr;
+		double Value = std::strtod(pCurrent, &pNext);
+		if (pNext == pCurrent)
+		{
+			// 区切りの','と改行を読み飛ばす.
+			pCurrent++;
+			continue;
+		}
+
+		_pValue->push_back(Value);
+		pCurrent = pNext;
+	}
+
+	return !_pValue->empty();
+}
+
+unsigned int TerrainHeightField::Hash(unsigned int _hash, const void* _pData, size_t _size)
+{
+	const unsigned char* pData = static_cast<const unsigned char*>(_pData);
+	for (size_t i = 0; i < _size; i++)
+	{
+		_hash = (_hash ^ pData[i]) * 16777619u;
+	}
+
+	return _hash;
+}
+
+TerrainHeightField::SAMPLE_FUNC TerrainHeightField::GetSampleFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &SampleAVX2;
+	case CpuFeature::SIMD_SSE:	return &SampleSSE;
+	case CpuFeature::SIMD_NEON:	return &SampleNEON;
+	default:					return &SampleScalar;
+	}
+}
+
+void TerrainHeightField::SampleScalar(
+	const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+	const float* _pX, const float* _pZ, int _count, float* _pOut)
+{
+	// 格子の外は端に寄せ, 左下の格子点は最後の1つ手前までにして, 右上の格子点が常に格子の中にあるようにする.
+	const float MaxX = static_cast<float>(_pointNumX - 1);
+	const float MaxZ = static_cast<float>(_pointNumZ - 1);
+	const float MaxCornerX = static_cast<float>(_pointNumX - 2);
+	const float MaxCornerZ = static_cast<float>(_pointNumZ - 2);
+	const float PointNumX = static_cast<float>(_pointNumX);
+
+	for (int i = 0; i < _count; i++)
+	{
+		float GridX = std::max(std::min((_pX[i] - _minX) * _invCellSize, MaxX), 0.0f);
+		float GridZ = std::max(std::min((_pZ[i] - _minZ) * _invCellSize, MaxZ), 0.0f);
+		float CornerX = std::min(static_cast<float>(static_cast<int>(GridX)), MaxCornerX);
+		float CornerZ = std::min(static_cast<float>(static_cast<int>(GridZ)), MaxCornerZ);
+		float RateX = GridX - CornerX;
+		float RateZ = GridZ - CornerZ;
+
+		// インデックスはSIMD版と同じくfloatで求める.
+		int Index = static_cast<int>(CornerZ * PointNumX + CornerX);
+		float Height00 = _pHeight[Index];
+		float Height10 = _pHeight[Index + 1];
+		float Height01 = _pHeight[Index + _pointNumX];
+		float Height11 = _pHeight[Index + _pointNumX + 1];
+
+		float Height0 = Height00 + (Height10 - Height00) * RateX;
+		float Height1 = Height01 + (Height11 - Height01) * RateX;
+		_pOut[i] = Height0 + (Height1 - Height0) * RateZ;
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void TerrainHeightField::SampleSSE(
+	const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+	const float* _pX, const float* _pZ, int _count, float* _pOut)
+{
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 MinX = _mm_set1_ps(_minX);
+	const __m128 MinZ = _mm_set1_ps(_minZ);
+	const __m128 InvCellSize = _mm_set1_ps(_invCellSize);
+	const __m128 MaxX = _mm_set1_ps(static_cast<float>(_pointNumX - 1));
+	const __m128 MaxZ = _mm_set1_ps(static_cast<float>(_pointNumZ - 1));
+	const __m128 MaxCornerX = _mm_set1_ps(static_cast<float>(_pointNumX - 2));
+	const __m128 MaxCornerZ = _mm_set1_ps(static_cast<float>(_pointNumZ - 2));
+	const __m128 PointNumX = _mm_set1_ps(static_cast<float>(_pointNumX));
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		__m128 GridX = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&_pX[i]), MinX), InvCellSize), MaxX), Zero);
+		__m128 GridZ = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&_pZ[i]), MinZ), InvCellSize), MaxZ), Zero);
+		__m128 CornerX = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(GridX)), MaxCornerX);
+		__m128 CornerZ = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(GridZ)), MaxCornerZ);
+		__m128 RateX = _mm_sub_ps(GridX, CornerX);
+		__m128 RateZ = _mm_sub_ps(GridZ, CornerZ);
+
+		// SSE2にはgatherが無いので, インデックスを書き出して1つずつ読み込む.
+		int Index[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Index), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(CornerZ, PointNumX), CornerX)));
+		__m128 Height00 = _mm_set_ps(_pHeight[Index[3]], _pHeight[Index[2]], _pHeight[Index[1]], _pHeight[Index[0]]);
+		__m128 Height10 = _mm_set_ps(_pHeight[Index[3] + 1], _pHeight[Index[2] + 1], _pHeight[Index[1] + 1], _pHeight[Index[0] + 1]);
+		__m128 Height01 = _mm_set_ps(
+			_pHeight[Index[3] + _pointNumX], _pHeight[Index[2] + _pointNumX],
+			_pHeight[Index[1] + _pointNumX], _pHeight[Index[0] + _pointNumX]);
+		__m128 Height11 = _mm_set_ps(
+			_pHeight[Index[3] + _pointNumX + 1], _pHeight[Index[2] + _pointNumX + 1],
+			_pHeight[Index[1] + _pointNumX + 1], _pHeight[Index[0] + _pointNumX + 1]);
+
+		__m128 Height0 = _mm_add_ps(Height00, _mm_mul_ps(_mm_sub_ps(Height10, Height00), RateX));
+		__m128 Height1 = _mm_add_ps(Height01, _mm_mul_ps(_mm_sub_ps(Height11, Height01), RateX));
+		_mm_storeu_ps(&_pOut[i], _mm_add_ps(Height0, _mm_mul_ps(_mm_sub_ps(Height1, Height0), RateZ)));
+	}
+
+	SampleScalar(_pHeight, _pointNumX, _pointNumZ, _minX, _minZ, _invCellSize, _pX + i, _pZ + i, _count - i, _pOut + i);
+}
+
+CPUFEATURE_TARGET_AVX2
+void TerrainHeightField::SampleAVX2(
+	const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+	const float* _pX, const float* _pZ, int _count, float* _pOut)
+{
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 MinX = _mm256_set1_ps(_minX);
+	const __m256 MinZ = _mm256_set1_ps(_minZ);
+	const __m256 InvCellSize = _mm256_set1_ps(_invCellSize);
+	const __m256 MaxX = _mm256_set1_ps(static_cast<float>(_pointNumX - 1));
+	const __m256 MaxZ = _mm256_set1_ps(static_cast<float>(_pointNumZ - 1));
+	const __m256 MaxCornerX = _mm256_set1_ps(static_cast<float>(_pointNumX - 2));
+	const __m256 MaxCornerZ = _mm256_set1_ps(static_cast<float>(_pointNumZ - 2));
+	const __m256 PointNumX = _mm256_set1_ps(static_cast<float>(_pointNumX));
+	const __m256i One = _mm256_set1_epi32(1);
+	const __m256i RowStride = _mm256_set1_epi32(_pointNumX);
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256 GridX = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&_pX[i]), MinX), InvCellSize), MaxX), Zero);
+		__m256 GridZ = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&_pZ[i]), MinZ), InvCellSize), MaxZ), Zero);
+		__m256 CornerX = _mm256_min_ps(_mm256_cvtepi32_ps(_mm256_cvttps_epi32(GridX)), MaxCornerX);
+		__m256 CornerZ = _mm256_min_ps(_mm256_cvtepi32_ps(_mm256_cvttps_epi32(GridZ)), MaxCornerZ);
+		__m256 RateX = _mm256_sub_ps(GridX, CornerX);
+		__m256 RateZ = _mm256_sub_ps(GridZ, CornerZ);
+
+		__m256i Index00 = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(CornerZ, PointNumX), CornerX));
+		__m256i Index01 = _mm256_add_epi32(Index00, RowStride);
+		__m256 Height00 = _mm256_i32gather_ps(_pHeight, Index00, 4);
+		__m256 Height10 = _mm256_i32gather_ps(_pHeight, _mm256_add_epi32(Index00, One), 4);
+		__m256 Height01 = _mm256_i32gather_ps(_pHeight, Index01, 4);
+		__m256 Height11 = _mm256_i32gather_ps(_pHeight, _mm256_add_epi32(Index01, One), 4);
+
+		__m256 Height0 = _mm256_add_ps(Height00, _mm256_mul_ps(_mm256_sub_ps(Height10, Height00), RateX));
+		__m256 Height1 = _mm256_add_ps(Height01, _mm256_mul_ps(_mm256_sub_ps(Height11, Height01), RateX));
+		_mm256_storeu_ps(&_pOut[i], _mm256_add_ps(Height0, _mm256_mul_ps(_mm256_sub_ps(Height1, Height0), RateZ)));
+	}
+
+	SampleSSE(_pHeight, _pointNumX, _pointNumZ, _minX, _minZ, _invCellSize, _pX + i, _pZ + i, _count - i, _pOut + i);
+}
+
+#else
+
+void TerrainHeightField::SampleSSE(
+	const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+	const float* _pX, const float* _pZ, int _count, float* _pOut)
+{
+	SampleScalar(_pHeight, _pointNumX, _pointNumZ, _minX, _minZ, _invCellSize, _pX, _pZ, _count, _pOut);
+}
+
+void TerrainHeightField::SampleAVX2(
+	const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+	const float* _pX, const float* _pZ, int _count, float* _pOut)
+{
+	SampleScalar(_pHeight, _pointNumX, _pointNumZ, _minX, _minZ, _invCellSize, _pX, _pZ, _count, _pOut);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void TerrainHeightField::SampleNEON(
+	const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+	const float* _pX, const float* _pZ, int _count, float* _pOut)
+{
+	const float32x4_t Zero = vdupq_n_f32(0.0f);
+	const float32x4_t MinX = vdupq_n_f32(_minX);
+	const float32x4_t MinZ = vdupq_n_f32(_minZ);
+	const float32x4_t InvCellSize = vdupq_n_f32(_invCellSize);
+	const float32x4_t MaxX = vdupq_n_f32(static_cast<float>(_pointNumX - 1));
+	const float32x4_t MaxZ = vdupq_n_f32(static_cast<float>(_pointNumZ - 1));
+	const float32x4_t MaxCornerX = vdupq_n_f32(static_cast<float>(_pointNumX - 2));
+	const float32x4_t MaxCornerZ = vdupq_n_f32(static_cast<float>(_pointNumZ - 2));
+	const float32x4_t PointNumX = vdupq_n_f32(static_cast<float>(_pointNumX));
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		float32x4_t GridX = vmaxq_f32(vminq_f32(vmulq_f32(vsubq_f32(vld1q_f32(&_pX[i]), MinX), InvCellSize), MaxX), Zero);
+		float32x4_t GridZ = vmaxq_f32(vminq_f32(vmulq_f32(vsubq_f32(vld1q_f32(&_pZ[i]), MinZ), InvCellSize), MaxZ), Zero);
+		float32x4_t CornerX = vminq_f32(vcvtq_f32_s32(vcvtq_s32_f32(GridX)), MaxCornerX);
+		float32x4_t CornerZ = vminq_f32(vcvtq_f32_s32(vcvtq_s32_f32(GridZ)), MaxCornerZ);
+		float32x4_t RateX = vsubq_f32(GridX, CornerX);
+		float32x4_t RateZ = vsubq_f32(GridZ, CornerZ);
+
+		// NEONにはgatherが無いので, インデックスを書き出して1つずつ読み込む.
+		int Index[4];
+		vst1q_s32(Index, vcvtq_s32_f32(vaddq_f32(vmulq_f32(CornerZ, PointNumX), CornerX)));
+		float Corner[4][4];
+		for (int j = 0; j < 4; j++)
+		{
+			Corner[0][j] = _pHeight[Index[j]];
+			Corner[1][j] = _pHeight[Index[j] + 1];
+			Corner[2][j] = _pHeight[Index[j] + _pointNumX];
+			Corner[3][j] = _pHeight[Index[j] + _pointNumX + 1];
+		}
+
+		float32x4_t Height00 = vld1q_f32(Corner[0]);
+		float32x4_t Height10 = vld1q_f32(Corner[1]);
+		float32x4_t Height01 = vld1q_f32(Corner[2]);
+		float32x4_t Height11 = vld1q_f32(Corner[3]);
+
+		float32x4_t Height0 = vaddq_f32(Height00, vmulq_f32(vsubq_f32(Height10, Height00), RateX));
+		float32x4_t Height1 = vaddq_f32(Height01, vmulq_f32(vsubq_f32(Height11, Height01), RateX));
+		vst1q_f32(&_pOut[i], vaddq_f32(Height0, vmulq_f32(vsubq_f32(Height1, Height0), RateZ)));
+	}
+
+	SampleScalar(_pHeight, _pointNumX, _pointNumZ, _minX, _minZ, _invCellSize, _pX + i, _pZ + i, _count - i, _pOut + i);
+}
+
+#else
+
+void TerrainHeightField::SampleNEON(
+	const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+	const float* _pX, const float* _pZ, int _count, float* _pOut)
+{
+	SampleScalar(_pHeight, _pointNumX, _pointNumZ, _minX, _minZ, _invCellSize, _pX, _pZ, _count, _pOut);
+}
+
+#endif // CPUFEATURE_NEON
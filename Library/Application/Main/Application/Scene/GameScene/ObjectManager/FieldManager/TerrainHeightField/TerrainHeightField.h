@@ -0,0 +1,346 @@
+﻿/**
+ * @file	TerrainHeightField.h
+ * @brief	地形の高さマップクラス定義
+ * @author	morimoto
+ */
+#ifndef TERRAINHEIGHTFIELD_H
+#define TERRAINHEIGHTFIELD_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <string>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+class ThreadPool;
+
+
+/**
+ * 地形の高さマップクラス
+ *
+ * 地面や山のモデル(アスキー形式のfbx)の三角形を真上から格子に描き込み, 格子点ごとの高さと法線を持つ.
+ * 格子点(x, z)はワールド座標の(GetMinX() + x * GetCellSize(), GetMinZ() + z * GetCellSize())にあり,
+ * 重なった三角形は高い方を使う. 三角形の無い格子点は基準の高さになる.
+ *
+ * 作成した格子はキャッシュファイルに保存し, 次回からはモデルと格子の設定が同じならファイルから読み込む.
+ * 高さと法線の取得は格子の4点を双線形補間し, 格子の外は端の値になる.
+ */
+class TerrainHeightField
+{
+public:
+	/**
+	 * コンストラクタ
+	 */
+	TerrainHeightField();
+
+	/**
+	 * デストラクタ
+	 */
+	~TerrainHeightField();
+
+	/**
+	 * 格子の作成を並列に行うためのスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元のスレッドだけで作成する)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool)
+	{
+		m_pThreadPool = _pThreadPool;
+	}
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 基準の高さを設定(次のBuildで反映される)
+	 * @param[in] _baseHeight 三角形の無い場所の高さ
+	 */
+	void SetBaseHeight(float _baseHeight)
+	{
+		m_BaseHeight = _baseHeight;
+	}
+
+	/**
+	 * 地形のモデルを追加(次のBuildで反映される)
+	 * @param[in] _pFileName モデルのファイル名(アスキー形式のfbx)
+	 * @param[in] _scaleX x方向のスケーリング値
+	 * @param[in] _scaleY y方向のスケーリング値
+	 * @param[in] _scaleZ z方向のスケーリング値
+	 */
+	void AddModel(const char* _pFileName, float _scaleX, float _scaleY, float _scaleZ);
+
+	/**
+	 * 追加したモデルから格子を作成
+	 *
+	 * キャッシュファイルがモデルと格子の設定に一致すれば読み込み, 一致しなければ作成して書き込む.
+	 * キャッシュファイルの書き込みに失敗しても格子の作成には成功する.
+	 * @param[in] _pCacheFileName キャッシュファイル名(nullptrならキャッシュを使わない)
+	 * @param[in] _cellSize 格子点の間隔
+	 * @return 作成に成功したらtrue 失敗したらfalse
+	 */
+	bool Build(const char* _pCacheFileName, float _cellSize);
+
+	/**
+	 * 格子を破棄
+	 */
+	void Release();
+
+	/**
+	 * 直前のBuildでキャッシュファイルを読み込んだかを取得
+	 * @return キャッシュファイルを読み込んでいればtrue
+	 */
+	bool IsCacheLoaded() const
+	{
+		return m_IsCacheLoaded;
+	}
+
+	/**
+	 * 指定位置の高さを取得
+	 * @param[in] _x ワールド座標x
+	 * @param[in] _z ワールド座標z
+	 * @return 高さ(Buildしていなければ基準の高さ)
+	 */
+	float GetHeight(float _x, float _z) const;
+
+	/**
+	 * 複数の位置の高さをまとめて取得
+	 * @param[in] _pX ワールド座標xの配列
+	 * @param[in] _pZ ワールド座標zの配列
+	 * @param[in] _count 位置の数
+	 * @param[out] _pHeight 高さの書き込み先
+	 */
+	void SampleHeight(const float* _pX, const float* _pZ, int _count, float* _pHeight) const;
+
+	/**
+	 * 複数の位置の法線をまとめて取得
+	 * @param[in] _pX ワールド座標xの配列
+	 * @param[in] _pZ ワールド座標zの配列
+	 * @param[in] _count 位置の数
+	 * @param[out] _pNormalX 法線xの書き込み先
+	 * @param[out] _pNormalY 法線yの書き込み先
+	 * @param[out] _pNormalZ 法線zの書き込み先
+	 */
+	void SampleNormal(const float* _pX, const float* _pZ, int _count, float* _pNormalX, float* _pNormalY, float* _pNormalZ) const;
+
+	/**
+	 * x方向の格子点の数を取得
+	 * @return 格子点の数(Buildしていなければ0)
+	 */
+	int GetPointNumX() const
+	{
+		return m_PointNumX;
+	}
+
+	/**
+	 * z方向の格子点の数を取得
+	 * @return 格子点の数(Buildしていなければ0)
+	 */
+	int GetPointNumZ() const
+	{
+		return m_PointNumZ;
+	}
+
+	/**
+	 * 格子の端のx座標を取得
+	 * @return 端のx座標
+	 */
+	float GetMinX() const
+	{
+		return m_MinX;
+	}
+
+	/**
+	 * 格子の端のz座標を取得
+	 * @return 端のz座標
+	 */
+	float GetMinZ() const
+	{
+		return m_MinZ;
+	}
+
+	/**
+	 * 格子点の間隔を取得
+	 * @return 格子点の間隔
+	 */
+	float GetCellSize() const
+	{
+		return m_CellSize;
+	}
+
+	/**
+	 * 高さの格子を取得
+	 * @return 格子の先頭(GetPointNumX() * GetPointNumZ()個, Buildしていなければnullptr)
+	 */
+	const float* GetHeightData() const
+	{
+		return m_Height.empty() ? nullptr : m_Height.data();
+	}
+
+	static const unsigned int m_Version;	//!< キャッシュファイル形式のバージョン.
+
+private:
+	/**
+	 * 追加されたモデルの構造体
+	 */
+	struct MODEL
+	{
+		std::string	FileName;	//!< ファイル名.
+		float		Scale[3];	//!< スケーリング値.
+	};
+
+	/**
+	 * xz平面に投影した三角形の構造体
+	 */
+	struct TRIANGLE
+	{
+		float X[3];	//!< 頂点のワールド座標x.
+		float Y[3];	//!< 頂点のワールド座標y.
+		float Z[3];	//!< 頂点のワールド座標z.
+	};
+
+	/**
+	 * キャッシュファイルのヘッダ構造体
+	 */
+	struct HEADER
+	{
+		char			Magic[4];		//!< 識別子("TRHF").
+		unsigned int	Version;		//!< ファイル形式のバージョン.
+		unsigned int	HeaderSize;		//!< ヘッダのバイト数.
+		unsigned int	SourceKey;		//!< モデルと格子の設定から求めた値.
+		int				PointNumX;		//!< x方向の格子点の数.
+		int				PointNumZ;		//!< z方向の格子点の数.
+		float			MinX;			//!< 格子の端のx座標.
+		float			MinZ;			//!< 格子の端のz座標.
+		float			CellSize;		//!< 格子点の間隔.
+		unsigned int	Checksum;		//!< 高さと法線のチェックサム.
+		unsigned int	Reserved[2];	//!< 予約領域(0).
+	};
+
+	/**
+	 * 高さの取得関数の型
+	 */
+	typedef void(*SAMPLE_FUNC)(
+		const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+		const float* _pX, const float* _pZ, int _count, float* _pOut);
+
+	/**
+	 * 格子点の高さを三角形から描き込む
+	 * @param[in] _triangles 三角形
+	 */
+	void RasterizeHeight(const std::vector<TRIANGLE>& _triangles);
+
+	/**
+	 * 格子点の法線を高さの差分から求める
+	 */
+	void ComputeNormal();
+
+	/**
+	 * キャッシュファイルを読み込む
+	 * @param[in] _pFileName ファイル名
+	 * @param[in] _sourceKey 期待するモデルと格子の設定の値
+	 * @return 読み込みに成功したらtrue 失敗したらfalse
+	 */
+	bool LoadCache(const char* _pFileName, unsigned int _sourceKey);
+
+	/**
+	 * キャッシュファイルを書き込む
+	 * @param[in] _pFileName ファイル名
+	 * @param[in] _sourceKey モデルと格子の設定の値
+	 * @return 書き込みに成功したらtrue 失敗したらfalse
+	 */
+	bool SaveCache(const char* _pFileName, unsigned int _sourceKey) const;
+
+	/**
+	 * アスキー形式のfbxから三角形を読み込む
+	 * @param[in] _model 読み込むモデル
+	 * @param[out] _pTriangles 三角形の出力先(末尾に追加する)
+	 * @return 読み込みに成功したらtrue 失敗したらfalse
+	 */
+	static bool ReadFbxTriangles(const MODEL& _model, std::vector<TRIANGLE>* _pTriangles);
+
+	/**
+	 * アスキー形式のfbxの数値配列を読み込む
+	 * @param[in] _text ファイルの内容
+	 * @param[in] _pName 配列の名前
+	 * @param[out] _pValue 数値の出力先
+	 * @return 読み込みに成功したらtrue 失敗したらfalse
+	 */
+	static bool ReadFbxArray(const std::string& _text, const char* _pName, std::vector<double>* _pValue);
+
+	/**
+	 * データのハッシュ値を計算(FNV-1a)
+	 * @param[in] _hash 初期値
+	 * @param[in] _pData データ
+	 * @param[in] _size データのバイト数
+	 * @return ハッシュ値
+	 */
+	static unsigned int Hash(unsigned int _hash, const void* _pData, size_t _size);
+
+	/**
+	 * 命令セットに対応した高さの取得関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 高さの取得関数
+	 */
+	static SAMPLE_FUNC GetSampleFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 高さの双線形補間(スカラー版)
+	 */
+	static void SampleScalar(
+		const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+		const float* _pX, const float* _pZ, int _count, float* _pOut);
+
+	/**
+	 * 高さの双線形補間(SSE2版)
+	 */
+	static void SampleSSE(
+		const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+		const float* _pX, const float* _pZ, int _count, float* _pOut);
+
+	/**
+	 * 高さの双線形補間(AVX2版)
+	 */
+	static void SampleAVX2(
+		const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+		const float* _pX, const float* _pZ, int _count, float* _pOut);
+
+	/**
+	 * 高さの双線形補間(NEON版)
+	 */
+	static void SampleNEON(
+		const float* _pHeight, int _pointNumX, int _pointNumZ, float _minX, float _minZ, float _invCellSize,
+		const float* _pX, const float* _pZ, int _count, float* _pOut);
+
+
+	static const char	m_Magic[4];		//!< キャッシュファイルの識別子.
+	static const int	m_PointNumMax;	//!< 格子点の数の最大値(インデックスをfloatで正確に計算できる範囲).
+	static const int	m_BandRowNum;	//!< 並列に作成する1まとまりの行数.
+
+	ThreadPool*				m_pThreadPool;		//!< 格子の作成を並列に行うためのスレッドプール.
+	CpuFeature::SIMD_TYPE	m_SimdType;			//!< 使用する命令セット.
+	std::vector<MODEL>		m_Models;			//!< 追加されたモデル.
+	std::vector<float>		m_Height;			//!< 格子点の高さ.
+	std::vector<float>		m_NormalX;			//!< 格子点の法線x.
+	std::vector<float>		m_NormalY;			//!< 格子点の法線y.
+	std::vector<float>		m_NormalZ;			//!< 格子点の法線z.
+	int						m_PointNumX;		//!< x方向の格子点の数.
+	int						m_PointNumZ;		//!< z方向の格子点の数.
+	float					m_MinX;				//!< 格子の端のx座標.
+	float					m_MinZ;				//!< 格子の端のz座標.
+	float					m_CellSize;			//!< 格子点の間隔.
+	float					m_InvCellSize;		//!< 格子点の間隔の逆数.
+	float					m_BaseHeight;		//!< 基準の高さ.
+	bool					m_IsCacheLoaded;	//!< 直前のBuildでキャッシュファイルを読み込んだか.
+
+};
+
+
+#endif // !TERRAINHEIGHTFIELD_H
@@ -14,12 +14,19 @@
 #include "DirectX11\GraphicsDevice\Dx11GraphicsDevice.h"
 #include "DirectX11\ShaderManager\Dx11ShaderManager.h"
 #include "Smoke\Smoke.h"
+#include "Main\Application\Scene\GameScene\Task\CubeMapDrawTask\CubeFaceCuller\CubeFaceCuller.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveObstacleMask\WaveObstacleMask.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Rain\RainOcclusionMap\RainOcclusionMap.h"
 
 
 //----------------------------------------------------------------------
 // Private Static Variables
 //----------------------------------------------------------------------
 D3DXVECTOR3 House::m_DefaultScale = D3DXVECTOR3(50, 50, 50);
+D3DXVECTOR3 House::m_ChimneyPos = D3DXVECTOR3(4.6f, 25, 4.0f);
+D3DXVECTOR2 House::m_FootprintHalfSize = D3DXVECTOR2(8, 7);
+D3DXVECTOR3 House::m_BoundingHalfSize = D3DXVECTOR3(9, 13, 13.3f);
+float House::m_RoofHeight = 16.0f;
 int	House::m_ModelIndex = Lib::Dx11::FbxFileManager::m_InvalidIndex;
 int	House::m_ShadowVertexShaderIndex = Lib::Dx11::ShaderManager::m_InvalidIndex;
 int	House::m_ShadowPixelShaderIndex = Lib::Dx11::ShaderManager::m_InvalidIndex;
@@ -35,11 +42,14 @@ int	House::m_ReflectMapPixelShaderIndex = Lib::Dx11::ShaderManager::m_InvalidInd
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-House::House(MainCamera* _pCamera, D3DXVECTOR3 _Pos, float _rotate) : 
-	m_pSmoke(nullptr)
+House::House(
+	D3DXVECTOR3 _Pos, float _rotate,
+	WaveObstacleMask* _pWaveObstacleMask, RainOcclusionMap* _pRainOcclusionMap, Smoke* _pSmoke)
 {
-	// 座標と角度を計算.
-	D3DXVECTOR3 Pos = D3DXVECTOR3(4.6f, 25, 4.0f);
+	// 煙突の座標を計算.
+	// house_red.fbxをm_DefaultScaleで拡大すると煙突の口は中心が(4.6, 25.44, 4.0)にあるので, 少し下から煙を出す.
+	// 地形の高さは_Posに含まれているので, 家と一緒に地形に追従する.
+	D3DXVECTOR3 Pos = m_ChimneyPos;
 	D3DXVECTOR3 TempPos = Pos;
 
 	Pos.x =
@@ -52,16 +62,34 @@ House::House(MainCamera* _pCamera, D3DXVECTOR3 _Pos, float _rotate) :
 
 	Pos += _Pos;
 
-	m_pSmoke = new Smoke(_pCamera, &Pos);
+	_pSmoke->AddEmitter(Pos);
 
 	m_Pos = _Pos;
 	m_Scale = m_DefaultScale;
 	m_Rotate.y = static_cast<float>(D3DXToRadian(_rotate));
+
+	// 家の範囲で水面の波が反射するようにする.
+	_pWaveObstacleMask->AddRect(_Pos.x, _Pos.z, m_FootprintHalfSize.x, m_FootprintHalfSize.y, m_Rotate.y);
+
+	// 家の範囲に落ちた雨粒は水面まで通り抜けずに屋根で着水する.
+	_pRainOcclusionMap->AddBox(
+		_Pos.x, _Pos.z, m_FootprintHalfSize.x, m_FootprintHalfSize.y, m_Rotate.y, _Pos.y + m_RoofHeight);
+
+	// 家を囲む球が写るキューブマップの面にだけ描画する(家は動かないので一度だけ求める).
+	// house_red.fbxをm_DefaultScaleで拡大するとxは±9, zは-9.1から13.3(玄関側), 高さは25.5までなので,
+	// 回転によらず囲めるように原点を中心とした箱の外接球にする.
+	float HalfHeight = m_BoundingHalfSize.y;
+	float Radius = D3DXVec3Length(&m_BoundingHalfSize);
+
+	CubeFaceCuller Culler;
+	m_pCubeMapDrawTask->SetFaceMask(Culler.GetSphereFaceMask(m_Pos.x, m_Pos.y + HalfHeight, m_Pos.z, Radius));
+
+	// 反射カメラに写らなければ反射マップにも描画しない.
+	m_pReflectMapDrawTask->SetBoundingSphere(m_Pos.x, m_Pos.y + HalfHeight, m_Pos.z, Radius);
 }
 
 House::~House()
 {
-	delete m_pSmoke;
 }
 
 
@@ -82,14 +110,12 @@ bool House::Initialize()
 	if (!CreateDepthStencilState())	return false;
 	if (!CreateConstantBuffer())	return false;
 	if (!WriteConstantBuffer())		return false;
-	if (!m_pSmoke->Initialize())	return false;
 
 	return true;
 }
 
 void House::Finalize()
 {
-	m_pSmoke->Finalize();
 	ReleaseConstantBuffer();
 	ReleaseDepthStencilState();
 	ReleaseVertexLayout();
@@ -161,6 +187,7 @@ void House::CubeMapDraw()
 	VertexLayoutSetup();
 	DepthStencilStateSetup();
 	ConstantBufferSetup();
+	pDeviceContext->GSSetConstantBuffers(0, 1, &m_pConstantBuffer);	// ジオメトリシェーダーで写る面を参照する.
 	pFbxFileManager->GetFbxModel(m_ModelIndex)->Draw();
 }
 
@@ -12,8 +12,9 @@
 #include "Main\Object3DBase\Object3DBase.h"
 
 
-class MainCamera;
 class Smoke;
+class WaveObstacleMask;
+class RainOcclusionMap;
 
 
 /**
@@ -24,11 +25,15 @@ class House : public Object3DBase
 public:
 	/**
 	 * コンストラクタ
-	 * @param[in] _pCamera カメラオブジェクト
 	 * @param[in] _pos 描画座標
 	 * @param[in] _rotate Y軸回転
+	 * @param[in] _pWaveObstacleMask フットプリントを追加する波の障害物マスク
+	 * @param[in] _pRainOcclusionMap 屋根を追加する雨の遮蔽高さマップ
+	 * @param[in] _pSmoke 煙突の煙のエミッタを追加する煙オブジェクト
 	 */
-	House(MainCamera* _pCamera, D3DXVECTOR3 _pos, float _rotate);
+	House(
+		D3DXVECTOR3 _pos, float _rotate,
+		WaveObstacleMask* _pWaveObstacleMask, RainOcclusionMap* _pRainOcclusionMap, Smoke* _pSmoke);
 
 	/**
 	 * デストラクタ
@@ -73,6 +78,10 @@ public:
 
 private:
 	static D3DXVECTOR3 m_DefaultScale;			//!< デフォルトスケーリング値.
+	static D3DXVECTOR3 m_ChimneyPos;			//!< 煙が出る煙突の位置(回転前の家の座標系).
+	static D3DXVECTOR2 m_FootprintHalfSize;		//!< 水面上で家が占める範囲の大きさの半分.
+	static D3DXVECTOR3 m_BoundingHalfSize;		//!< 家のモデルを囲む箱の大きさの半分(箱の底は家の位置).
+	static float m_RoofHeight;					//!< 雨粒が着水する屋根の高さ.
 	static int	m_ModelIndex;					//!< モデルのインデックス.
 	static int	m_ShadowVertexShaderIndex;		//!< 深度値描画の頂点シェーダーインデックス.
 	static int	m_ShadowPixelShaderIndex;		//!< 深度値描画のピクセルシェーダーインデックス.
@@ -160,10 +169,6 @@ private:
 	 */
 	void ReleaseReflectMapShader();
 
-
-	Smoke*	m_pSmoke;	//!< スモーク管理オブジェクト.
-
-
 };
 
 
@@ -9,15 +9,21 @@
 //----------------------------------------------------------------------
 #include "Smoke.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "DirectX11\GraphicsDevice\Dx11GraphicsDevice.h"
 #include "DirectX11\ShaderManager\Dx11ShaderManager.h"
 #include "DirectX11\TextureManager\Dx11TextureManager.h"
 #include "DirectX11\TextureManager\ITexture\Dx11ITexture.h"
+#include "DirectX11\Font\Dx11Font.h"
 #include "TaskManager\TaskBase\DrawTask\DrawTask.h"
 #include "TaskManager\TaskBase\UpdateTask\UpdateTask.h"
 #include "Debugger\Debugger.h"
 #include "Main\Application\MyDefine.h"
 #include "..\..\MainCamera\MainCamera.h"
+#include "SmokeParticles\SmokeParticles.h"
+#include "SmokeDepthSorter\SmokeDepthSorter.h"
 
 
 //----------------------------------------------------------------------
@@ -25,64 +31,74 @@
 //----------------------------------------------------------------------
 const D3DXVECTOR2 Smoke::m_DefaultSize = D3DXVECTOR2(1.0f, 1.0f);
 const D3DXVECTOR2 Smoke::m_LifeRange = D3DXVECTOR2(180, 240);
+const D3DXVECTOR3 Smoke::m_EmitVelocity = D3DXVECTOR3(0.08f, 0.5f, 0.08f);
+const float Smoke::m_EmitAngleRange = 6;
+const float Smoke::m_EmitRate = 1.0f;
+const int Smoke::m_LifeFrame = 300;
+const float Smoke::m_ScaleSpeed = 0.01f;
+const float Smoke::m_AlphaSpeed = 1.0f / 255.0f;
+const int Smoke::m_ComputeParticleNum = 600;
+const D3DXVECTOR2 Smoke::m_DefaultFontPos = D3DXVECTOR2(25, 260);
+const D3DXVECTOR2 Smoke::m_SortFontPos = D3DXVECTOR2(25, 290);
+const D3DXVECTOR2 Smoke::m_DefaultFontSize = D3DXVECTOR2(16, 32);
+const D3DXCOLOR Smoke::m_DefaultFontColor = 0xffffffff;
 
 
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-Smoke::Smoke(MainCamera* _pCamera, D3DXVECTOR3* _pPos) :
+Smoke::Smoke(MainCamera* _pCamera, ThreadPool* _pThreadPool) :
+	m_pDrawTask(nullptr),
+	m_pUpdateTask(nullptr),
 	m_pCamera(_pCamera),
+	m_pFont(nullptr),
 	m_VertexShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_PixelShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_ComputeShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
+	m_ComputeVertexShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
+	m_pVertexBuffer(nullptr),
+	m_pInstanceBuffer(nullptr),
+	m_pComputeShaderBuffer(nullptr),
+	m_pComputeShaderBufferAccess(nullptr),
+	m_pComputeShaderBufferResource(nullptr),
+	m_pComputeConstantBuffer(nullptr),
+	m_pVertexLayout(nullptr),
+	m_pComputeVertexLayout(nullptr),
+	m_pDepthStencilState(nullptr),
+	m_pBlendState(nullptr),
+	m_InstanceCapacity(0),
+	m_InstanceNum(0),
 	m_SmokeTextureIndex(Lib::Dx11::TextureManager::m_InvalidIndex),
 	m_SkyCLUTIndex(Lib::Dx11::TextureManager::m_InvalidIndex),
 	m_IsActive(true),
 	m_IsComputeShader(false),
+	m_IsComputeCpu(true),
+	m_pComputeKernel(new SmokeComputeKernel()),
+	m_pSmokeParticles(new SmokeParticles()),
+	m_pDepthSorter(new SmokeDepthSorter()),
+	m_SortMode(SORT_INCREMENTAL),
+	m_UpdateTime(0.0f),
+	m_SortTime(0.0f),
+	m_pKeyState(nullptr),
 	m_RandDevice(),
 	m_MersenneTwister(m_RandDevice())
 {
-	m_EmitterData.Pos = *_pPos;							// パーティクル発生座標.
-	m_EmitterData.Vec = D3DXVECTOR3(0.08f, 0.5f, 0.08f);// パーティクルの初速.
-	m_EmitterData.AngleRange = 6;						// パーティクルの移動範囲.
-
-	// パーティクルデータの初期化.
-	for (int i = 0; i < PARTICLE_NUM; i++)
-	{
-		double DegX = m_MersenneTwister() %
-			(static_cast<int>(m_EmitterData.AngleRange) * 2) -
-			m_EmitterData.AngleRange - 90;
-		float RadX = static_cast<float>(D3DXToRadian(DegX));
-
-		double DegY = m_MersenneTwister() %
-			(static_cast<int>(m_EmitterData.AngleRange) * 2) -
-			m_EmitterData.AngleRange;
-		float RadY = static_cast<float>(D3DXToRadian(DegY));
-
-		double DegZ = m_MersenneTwister() %
-			(static_cast<int>(m_EmitterData.AngleRange) * 2) -
-			m_EmitterData.AngleRange - 90;
-		float RadZ = static_cast<float>(D3DXToRadian(DegZ));
-
-		m_SmokeData[i].Vec.x = cos(RadX) * m_EmitterData.Vec.x;
-		m_SmokeData[i].Vec.y = fabs(sin(RadY) * m_EmitterData.Vec.y);
-		m_SmokeData[i].Vec.z = cos(RadZ) * m_EmitterData.Vec.z;
-
-		m_SmokeData[i].Pos = D3DXVECTOR3(0, -1, 0);				// パーティクルの座標.
-		m_SmokeData[i].Scale = D3DXVECTOR3(1.0f, 1.0f, 1.0f);	// パーティクルのスケーリング.
-		m_SmokeData[i].Color = 0xffffffff;						// パーティクルのカラー.
-		m_SmokeData[i].Life = 300 - i;							// パーティクルの寿命.
-		m_SmokeData[i].IsActive = false;						// パーティクルの活動状態.
-
-		m_ComputeData[i].Pos = D3DXVECTOR4(m_SmokeData[i].Pos, 0);
-		m_ComputeData[i].Scale = D3DXVECTOR4(m_SmokeData[i].Scale, 0);
-		m_ComputeData[i].Color = m_SmokeData[i].Color;
-		m_ComputeData[i].Life = D3DXVECTOR4(static_cast<float>(m_SmokeData[i].Life), 0, 0, 0);
-	}
+	m_pSmokeParticles->SetEmission(m_EmitRate, m_LifeFrame);
+	m_pSmokeParticles->SetVelocity(m_EmitVelocity.x, m_EmitVelocity.y, m_EmitVelocity.z, m_EmitAngleRange);
+	m_pSmokeParticles->SetGrowth(m_ScaleSpeed, m_AlphaSpeed);
+
+	m_pComputeKernel->SetThreadPool(_pThreadPool);
+	m_ComputeConstant.LifeFrame = static_cast<float>(m_LifeFrame);
+	m_ComputeConstant.ScaleSpeed = m_ScaleSpeed;
+	m_ComputeConstant.AlphaSpeed = m_AlphaSpeed;
+	m_ComputeConstant.ParticleNum = 0;
 }
 
 Smoke::~Smoke()
 {
+	delete m_pDepthSorter;
+	delete m_pComputeKernel;
+	delete m_pSmokeParticles;
 }
 
 
@@ -93,65 +109,78 @@ bool Smoke::Initialize()
 {
 	if (!CreateTask())					return false;
 	if (!CreateVertexBuffer())			return false;
+	if (!CreateInstanceBuffer())		return false;
 	if (!WriteInstanceBuffer())			return false;
 	if (!CreateShader())				return false;
 	if (!CreateVertexLayout())			return false;
 	if (!CreateState())					return false;
 	if (!CreateTexture())				return false;
 	if (!CreateComputeShaderBuffer())	return false;
+	if (!CreateFontObject())			return false;
 
 	return true;
 }
 
 void Smoke::Finalize()
 {
+	ReleaseFontObject();
 	ReleaseComputeShaderBuffer();
 	ReleaseTexture();
 	ReleaseState();
 	ReleaseVertexLayout();
 	ReleaseShader();
+	ReleaseInstanceBuffer();
 	ReleaseVertexBuffer();
 	ReleaseTask();
 }
 
 void Smoke::Update()
 {
+	m_pKeyState = SINGLETON_INSTANCE(Lib::InputDeviceManager)->GetKeyState();
+
+	if (m_pKeyState[DIK_L] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		SwitchMode();
+	}
+
+	if (m_pKeyState[DIK_P] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		// ソートしない, 毎フレーム全体を並べる, 前のフレームの順番から並べるの順に切り替える.
+		m_SortMode = static_cast<SORT_MODE>((m_SortMode + 1) % SORT_MODE_NUM);
+		m_pDepthSorter->Reset();
+		m_SortTime = 0.0f;
+	}
+
 	if (!m_IsActive)
 	{
 		return;
 	}
 
 
-	if (!m_IsComputeShader)
+	if (!ResizeBuffer())
 	{
-		for (int i = 0; i < PARTICLE_NUM; i++)
+		return;
+	}
+
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	if (m_IsComputeShader)
+	{
+		// GPUで実行する場合は結果を読み戻さず, 描画でバッファを直接参照する.
+		DispatchCompute();
+		if (m_IsComputeCpu)
 		{
-			if (m_SmokeData[i].IsActive)
-			{
-				m_SmokeData[i].Life--;
-				if (m_SmokeData[i].Life <= 0)
-				{
-					m_SmokeData[i].IsActive = false;
-				}
-
-				m_SmokeData[i].Pos += m_SmokeData[i].Vec;				// 座標更新.
-				m_SmokeData[i].Scale += D3DXVECTOR3(0.01f, 0.01f, 0);	// サイズ更新.
-				m_SmokeData[i].Color -= 0x01000000;						// カラー更新.
-			}
-			else
-			{
-				m_SmokeData[i].Life++;
-				if (m_SmokeData[i].Life == 300)	// 一定時間が経過したらアクティブ状態に遷移.
-				{
-					m_SmokeData[i].Pos = m_EmitterData.Pos;
-					m_SmokeData[i].Color = 0xffffffff;
-					m_SmokeData[i].Scale = D3DXVECTOR3(1.0f, 1.0f, 1.0f);
-					m_SmokeData[i].IsActive = true;
-				}
-			}
+			WriteComputeInstanceBuffer();
 		}
+	}
+	else
+	{
+		m_pSmokeParticles->Update();
 		WriteInstanceBuffer();
 	}
+
+	std::chrono::steady_clock::time_point EndTime = std::chrono::steady_clock::now();
+	m_UpdateTime = static_cast<float>(std::chrono::duration<double, std::milli>(EndTime - StartTime).count());
 }
 
 void Smoke::Draw()
@@ -161,30 +190,95 @@ void Smoke::Draw()
 	Lib::Dx11::TextureManager* pTextureManageer = SINGLETON_INSTANCE(Lib::Dx11::TextureManager);
 	Lib::Dx11::ShaderManager*	pShaderManager = SINGLETON_INSTANCE(Lib::Dx11::ShaderManager);
 
-	if (m_IsActive)
+	// GPUで実行した場合は待機中のパーティクルも含めて全て描画し, 頂点シェーダーで待機中のものを消す.
+	bool IsComputeGpu = m_IsComputeShader && !m_IsComputeCpu;
+	int InstanceNum = IsComputeGpu ? static_cast<int>(m_ComputeData.size()) : m_InstanceNum;
+
+	if (m_IsActive && InstanceNum > 0)
 	{
-		pDeviceContext->VSSetShader(pShaderManager->GetVertexShader(m_VertexShaderIndex), nullptr, 0);
+		if (IsComputeGpu)
+		{
+			pDeviceContext->VSSetShader(pShaderManager->GetVertexShader(m_ComputeVertexShaderIndex), nullptr, 0);
+			pDeviceContext->IASetInputLayout(m_pComputeVertexLayout);
+
+			UINT Stride = sizeof(VERTEX);
+			UINT Offset = 0;
+			pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &Stride, &Offset);
+			pDeviceContext->VSSetShaderResources(1, 1, &m_pComputeShaderBufferResource);
+		}
+		else
+		{
+			pDeviceContext->VSSetShader(pShaderManager->GetVertexShader(m_VertexShaderIndex), nullptr, 0);
+			pDeviceContext->IASetInputLayout(m_pVertexLayout);
+
+			ID3D11Buffer* pBuffer[2] = { m_pVertexBuffer, m_pInstanceBuffer };
+			UINT Stride[2] = { sizeof(VERTEX), sizeof(INSTANCE_DATA) };
+			UINT Offset[2] = { 0, 0 };
+			pDeviceContext->IASetVertexBuffers(0, 2, pBuffer, Stride, Offset);
+		}
+
 		pDeviceContext->PSSetShader(pShaderManager->GetPixelShader(m_PixelShaderIndex), nullptr, 0);
 		pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
-		pDeviceContext->IASetInputLayout(m_pVertexLayout);
-
 		pDeviceContext->OMSetDepthStencilState(m_pDepthStencilState, 0);
 		pDeviceContext->OMSetBlendState(m_pBlendState, nullptr, 0xffffffff);
 
-		ID3D11Buffer* pBuffer[2] = { m_pVertexBuffer, m_pInstanceBuffer };
-		UINT Stride[2] = { sizeof(VERTEX), sizeof(INSTANCE_DATA) };
-		UINT Offset[2] = { 0, 0 };
-		pDeviceContext->IASetVertexBuffers(0, 2, pBuffer, Stride, Offset);
-
 		ID3D11ShaderResourceView* pResource = pTextureManageer->GetTexture(m_SmokeTextureIndex)->Get();
 		pDeviceContext->PSSetShaderResources(0, 1, &pResource);
 
 		ID3D11ShaderResourceView* pResource2 = pTextureManageer->GetTexture(m_SkyCLUTIndex)->Get();
 		pDeviceContext->PSSetShaderResources(3, 1, &pResource2);
 
-		pDeviceContext->DrawInstanced(VERTEX_NUM, PARTICLE_NUM, 0, 0);
+		// 全てのエミッタの生きているパーティクルを1回で描画する.
+		pDeviceContext->DrawInstanced(VERTEX_NUM, InstanceNum, 0, 0);
+
+		if (IsComputeGpu)
+		{
+			// 次のDispatchでアクセスビューとして使うので外しておく.
+			ID3D11ShaderResourceView* pNullResource = nullptr;
+			pDeviceContext->VSSetShaderResources(1, 1, &pNullResource);
+		}
+	}
+
+	const char* pModeName = "Ring";
+	if (m_IsComputeShader)
+	{
+		pModeName = m_IsComputeCpu ? "CS CPU" : "CS GPU";
+	}
+	else if (m_pSmokeParticles->IsStateless())
+	{
+		pModeName = "Eval";
+	}
+
+	char SmokeStr[64];
+	sprintf_s(SmokeStr, 64, "Smoke : %s %.2fms", pModeName, m_UpdateTime);
+	m_pFont->Draw(&m_DefaultFontPos, SmokeStr);
+	m_pFont->Draw(&D3DXVECTOR2(m_DefaultFontPos.x + 320, m_DefaultFontPos.y), "L key");
+
+	// GPUで実行した場合はCPUにパーティクルが無いのでソートしない.
+	static const char* pSortModeName[SORT_MODE_NUM] = { "Off", "Radix", "Incr" };
+	char SortStr[64];
+	if (IsComputeGpu)
+	{
+		sprintf_s(SortStr, 64, "Sort : -");
 	}
+	else
+	{
+		sprintf_s(SortStr, 64, "Sort : %s %.2fms", pSortModeName[m_SortMode], m_SortTime);
+	}
+	m_pFont->Draw(&m_SortFontPos, SortStr);
+	m_pFont->Draw(&D3DXVECTOR2(m_SortFontPos.x + 320, m_SortFontPos.y), "P key");
+}
+
+int Smoke::AddEmitter(const D3DXVECTOR3& _pos)
+{
+	m_EmitterPos.push_back(_pos);
+	return m_pSmokeParticles->AddEmitter(_pos.x, _pos.y, _pos.z, m_MersenneTwister());
+}
+
+int Smoke::GetEmitterNum() const
+{
+	return m_pSmokeParticles->GetEmitterNum();
 }
 
 
@@ -255,32 +349,35 @@ bool Smoke::CreateVertexBuffer()
 	}
 
 
-	for (int i = 0; i < PARTICLE_NUM; i++)
+	return true;
+}
+
+bool Smoke::CreateInstanceBuffer()
+{
+	// コンピュートカーネルのパーティクルをCPUで更新した場合もこのバッファに書き込む.
+	m_InstanceCapacity = m_pSmokeParticles->GetEmitterNum() * std::max(m_pSmokeParticles->GetCapacity(), m_ComputeParticleNum);
+	if (m_InstanceCapacity == 0)
 	{
-		D3DXMatrixIdentity(&m_pInstanceData[i].Mat);
-		D3DXMatrixTranspose(&m_pInstanceData[i].Mat, &m_pInstanceData[i].Mat);
+		return true;	// エミッタが無ければ描画しない.
 	}
 
 	// インスタンスバッファの設定.
+	// 内容は毎フレームWriteInstanceBufferで書き込むので初期データは渡さない.
 	D3D11_BUFFER_DESC InstanceBufferDesc;
 	ZeroMemory(&InstanceBufferDesc, sizeof(D3D11_BUFFER_DESC));
-	InstanceBufferDesc.ByteWidth = sizeof(INSTANCE_DATA) * PARTICLE_NUM;
+	InstanceBufferDesc.ByteWidth = sizeof(INSTANCE_DATA) * m_InstanceCapacity;
 	InstanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
 	InstanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	InstanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	InstanceBufferDesc.MiscFlags = 0;
 	InstanceBufferDesc.StructureByteStride = 0;
 
-	// インスタンスバッファに格納するデータの設定.
-	D3D11_SUBRESOURCE_DATA InstanceResourceData;
-	ZeroMemory(&InstanceResourceData, sizeof(D3D11_SUBRESOURCE_DATA));
-	InstanceResourceData.pSysMem = m_pInstanceData;
-
-	if (FAILED(pGraphicsDevice->GetDevice()->CreateBuffer(
+	if (FAILED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDevice()->CreateBuffer(
 		&InstanceBufferDesc,
-		&InstanceResourceData,
+		nullptr,
 		&m_pInstanceBuffer)))
 	{
+		m_InstanceCapacity = 0;
 		OutputErrorLog("インスタンスバッファの生成に失敗しました");
 		return false;
 	}
@@ -308,6 +405,15 @@ bool Smoke::CreateShader()
 		return false;
 	}
 
+	if (!SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->LoadVertexShader(
+		TEXT("Resource\\Effect\\Smoke.fx"),
+		"VS_COMPUTE",
+		&m_ComputeVertexShaderIndex))
+	{
+		OutputErrorLog("頂点シェーダーの読み込みに失敗しました");
+		return false;
+	}
+
 	if (!SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->LoadComputeShader(
 		TEXT("Resource\\Effect\\Compute.fx"),
 		"CS",
@@ -347,6 +453,18 @@ bool Smoke::CreateVertexLayout()
 		return false;
 	}
 
+	// コンピュートシェーダーバッファを読む頂点シェーダーはインスタンスデータを使わない.
+	if (FAILED(pGraphicsDevice->GetDevice()->CreateInputLayout(
+		InputElementDesc,
+		2,
+		pShaderManager->GetCompiledVertexShader(m_ComputeVertexShaderIndex)->GetBufferPointer(),
+		pShaderManager->GetCompiledVertexShader(m_ComputeVertexShaderIndex)->GetBufferSize(),
+		&m_pComputeVertexLayout)))
+	{
+		OutputErrorLog("入力レイアウトの生成に失敗しました");
+		return false;
+	}
+
 	return true;
 }
 
@@ -416,17 +534,26 @@ bool Smoke::CreateTexture()
 
 bool Smoke::CreateComputeShaderBuffer()
 {
+	CreateComputeData();
+	if (m_ComputeData.empty())
+	{
+		return true;
+	}
+
 	// コンピュートシェーダーバッファの生成.
+	// GPUの中でだけ読み書きするので, CPUからは初期化とリセットの時にUpdateSubresourceで書き込む.
 	D3D11_BUFFER_DESC BufferDesc;
 	ZeroMemory(&BufferDesc, sizeof(D3D11_BUFFER_DESC));
+	BufferDesc.Usage = D3D11_USAGE_DEFAULT;
 	BufferDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
-	BufferDesc.ByteWidth = sizeof(COMPUTESHADER_BUFFER) * PARTICLE_NUM;
-	BufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE;
+	BufferDesc.ByteWidth = sizeof(SmokeComputeKernel::PARTICLE) * m_ComputeData.size();
+	BufferDesc.CPUAccessFlags = 0;
 	BufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-	BufferDesc.StructureByteStride = sizeof(COMPUTESHADER_BUFFER);
+	BufferDesc.StructureByteStride = sizeof(SmokeComputeKernel::PARTICLE);
 
 	D3D11_SUBRESOURCE_DATA InitData;
-	InitData.pSysMem = m_ComputeData;
+	ZeroMemory(&InitData, sizeof(D3D11_SUBRESOURCE_DATA));
+	InitData.pSysMem = m_ComputeData.data();
 
 	if (FAILED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDevice()->CreateBuffer(
 		&BufferDesc,
@@ -444,7 +571,7 @@ bool Smoke::CreateComputeShaderBuffer()
 	AccessViewDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
 	AccessViewDesc.Buffer.FirstElement = 0;
 	AccessViewDesc.Format = DXGI_FORMAT_UNKNOWN;
-	AccessViewDesc.Buffer.NumElements = PARTICLE_NUM;
+	AccessViewDesc.Buffer.NumElements = m_ComputeData.size();
 	if (FAILED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDevice()->CreateUnorderedAccessView(
 		m_pComputeShaderBuffer,
 		&AccessViewDesc,
@@ -454,6 +581,82 @@ bool Smoke::CreateComputeShaderBuffer()
 		return false;
 	}
 
+	// 描画で頂点シェーダーから読むためのリソースビュー生成.
+	D3D11_SHADER_RESOURCE_VIEW_DESC ResourceViewDesc;
+	ZeroMemory(&ResourceViewDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC));
+	ResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	ResourceViewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	ResourceViewDesc.Buffer.FirstElement = 0;
+	ResourceViewDesc.Buffer.NumElements = m_ComputeData.size();
+	if (FAILED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDevice()->CreateShaderResourceView(
+		m_pComputeShaderBuffer,
+		&ResourceViewDesc,
+		&m_pComputeShaderBufferResource)))
+	{
+		OutputErrorLog("コンピュートシェーダーバッファリソースビューの生成に失敗しました");
+		return false;
+	}
+
+	// コンピュートシェーダーの定数バッファ生成.
+	D3D11_BUFFER_DESC ConstantBufferDesc;
+	ZeroMemory(&ConstantBufferDesc, sizeof(D3D11_BUFFER_DESC));
+	ConstantBufferDesc.ByteWidth = sizeof(SmokeComputeKernel::CONSTANT);
+	ConstantBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	ConstantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	ConstantBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	ConstantBufferDesc.MiscFlags = 0;
+	ConstantBufferDesc.StructureByteStride = 0;
+	if (FAILED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDevice()->CreateBuffer(
+		&ConstantBufferDesc,
+		nullptr,
+		&m_pComputeConstantBuffer)))
+	{
+		OutputErrorLog("コンピュートシェーダーの定数バッファ生成に失敗しました");
+		return false;
+	}
+
+	return true;
+}
+
+void Smoke::CreateComputeData()
+{
+	// エミッタごとに寿命の2倍のパーティクルを用意し, 1フレームに1つずつ出現するように出現するフレームをずらしておく.
+	// 各パーティクルは寿命の間活動して寿命の間待機するので, 全てが出現した後は常にエミッタごとに寿命と同じ数が活動する.
+	m_ComputeData.resize(m_EmitterPos.size() * m_ComputeParticleNum);
+	int AngleStep = static_cast<int>(m_EmitAngleRange) * 2;
+
+	for (unsigned int i = 0; i < m_EmitterPos.size(); i++)
+	{
+		for (int j = 0; j < m_ComputeParticleNum; j++)
+		{
+			float RadX = static_cast<float>(D3DXToRadian(m_MersenneTwister() % AngleStep - m_EmitAngleRange - 90));
+			float RadY = static_cast<float>(D3DXToRadian(m_MersenneTwister() % AngleStep - m_EmitAngleRange));
+			float RadZ = static_cast<float>(D3DXToRadian(m_MersenneTwister() % AngleStep - m_EmitAngleRange - 90));
+
+			SmokeComputeKernel::ResetParticle(
+				&m_ComputeData[i * m_ComputeParticleNum + j],
+				m_EmitterPos[i].x, m_EmitterPos[i].y, m_EmitterPos[i].z,
+				cos(RadX) * m_EmitVelocity.x, fabs(sin(RadY) * m_EmitVelocity.y), cos(RadZ) * m_EmitVelocity.z,
+				static_cast<float>(m_LifeFrame), j + 1);
+		}
+	}
+}
+
+bool Smoke::CreateFontObject()
+{
+	m_pFont = new Lib::Dx11::Font();
+	if (!m_pFont->Initialize(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)))
+	{
+		OutputErrorLog("フォントオブジェクトの初期化に失敗しました");
+		return false;
+	}
+
+	if (!m_pFont->CreateVertexBuffer(&m_DefaultFontSize, &m_DefaultFontColor))
+	{
+		OutputErrorLog("フォントオブジェクトの頂点バッファの生成に失敗しました");
+		return false;
+	}
+
 	return true;
 }
 
@@ -468,19 +671,27 @@ void Smoke::ReleaseTask()
 
 void Smoke::ReleaseVertexBuffer()
 {
-	SafeRelease(m_pInstanceBuffer);
 	SafeRelease(m_pVertexBuffer);
 }
 
+void Smoke::ReleaseInstanceBuffer()
+{
+	SafeRelease(m_pInstanceBuffer);
+	m_InstanceCapacity = 0;
+	m_InstanceNum = 0;
+}
+
 void Smoke::ReleaseShader()
 {
 	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleaseComputeShader(m_ComputeShaderIndex);
+	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleaseVertexShader(m_ComputeVertexShaderIndex);
 	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleasePixelShader(m_PixelShaderIndex);
 	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleaseVertexShader(m_VertexShaderIndex);
 }
 
 void Smoke::ReleaseVertexLayout()
 {
+	SafeRelease(m_pComputeVertexLayout);
 	SafeRelease(m_pVertexLayout);
 }
 
@@ -498,12 +709,26 @@ void Smoke::ReleaseTexture()
 
 void Smoke::ReleaseComputeShaderBuffer()
 {
+	SafeRelease(m_pComputeConstantBuffer);
+	SafeRelease(m_pComputeShaderBufferResource);
 	SafeRelease(m_pComputeShaderBufferAccess);
 	SafeRelease(m_pComputeShaderBuffer);
 }
 
+void Smoke::ReleaseFontObject()
+{
+	m_pFont->ReleaseVertexBuffer();
+	m_pFont->Finalize();
+	delete m_pFont;
+}
+
 bool Smoke::WriteInstanceBuffer()
 {
+	if (m_InstanceCapacity == 0)
+	{
+		return true;
+	}
+
 	D3D11_MAPPED_SUBRESOURCE MappedResource;
 	if (SUCCEEDED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->Map(
 		m_pInstanceBuffer,
@@ -514,22 +739,89 @@ bool Smoke::WriteInstanceBuffer()
 	{
 		INSTANCE_DATA* pInstanceData = reinterpret_cast<INSTANCE_DATA*>(MappedResource.pData);
 
-		// インスタンスバッファへのデータ書き込み.
-		for (int i = 0; i < PARTICLE_NUM; i++)
+		const float* pPosX = m_pSmokeParticles->GetPosX();
+		const float* pPosY = m_pSmokeParticles->GetPosY();
+		const float* pPosZ = m_pSmokeParticles->GetPosZ();
+		const float* pScale = m_pSmokeParticles->GetScale();
+		const float* pAlpha = m_pSmokeParticles->GetAlpha();
+		int Capacity = m_pSmokeParticles->GetCapacity();
+
+		// 生きているパーティクルのスロットをエミッタごとに古い順に集める.
+		m_LiveSlot.clear();
+		for (int i = 0; i < m_pSmokeParticles->GetEmitterNum(); i++)
+		{
+			int Base = i * Capacity;
+			int Index = m_pSmokeParticles->GetLiveBegin(i);
+			int LiveNum = m_pSmokeParticles->GetLiveNum(i);
+			for (int j = 0; j < LiveNum; j++)
+			{
+				m_LiveSlot.push_back(Base + Index);
+				Index = Index + 1 < Capacity ? Index + 1 : 0;
+			}
+		}
+
+		const int* pOrder = SortLiveSlot(pPosX, pPosY, pPosZ, m_pSmokeParticles->GetEmitterNum() * Capacity);
+
+		m_InstanceNum = 0;
+		for (unsigned int i = 0; i < m_LiveSlot.size(); i++)
 		{
-			D3DXMATRIX MatWorld, MatRotate, MatTranslate;
-			D3DXMatrixIdentity(&MatWorld);
+			int Slot = pOrder[i];
+			D3DXVECTOR3 Pos(pPosX[Slot], pPosY[Slot], pPosZ[Slot]);
+			SetInstanceData(&pInstanceData[m_InstanceNum], &Pos, pScale[Slot], pAlpha[Slot]);
+			m_InstanceNum++;
+		}
+
+		SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->Unmap(m_pInstanceBuffer, 0);
+
+		return true;
+	}
+
+	return false;
+}
 
-			m_pCamera->GetBillBoardRotation(&m_SmokeData[i].Pos, &MatRotate);
-			D3DXMatrixScaling(&MatWorld, m_SmokeData[i].Scale.x, m_SmokeData[i].Scale.y, m_SmokeData[i].Scale.z);
-			D3DXMatrixMultiply(&MatWorld, &MatWorld, &MatRotate);
-			D3DXMatrixTranslation(&MatTranslate, m_SmokeData[i].Pos.x, m_SmokeData[i].Pos.y, m_SmokeData[i].Pos.z);
-			D3DXMatrixMultiply(&MatWorld, &MatWorld, &MatTranslate);
+bool Smoke::WriteComputeInstanceBuffer()
+{
+	if (m_InstanceCapacity == 0)
+	{
+		return true;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE MappedResource;
+	if (SUCCEEDED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->Map(
+		m_pInstanceBuffer,
+		0,
+		D3D11_MAP_WRITE_DISCARD,
+		0,
+		&MappedResource)))
+	{
+		INSTANCE_DATA* pInstanceData = reinterpret_cast<INSTANCE_DATA*>(MappedResource.pData);
 
-			D3DXMatrixTranspose(&MatWorld, &MatWorld);
-			pInstanceData[i].Mat = MatWorld;
+		// ソートキーはSIMDでまとめて求めるので, 座標を成分ごとの配列に移しながら活動中のスロットを集める.
+		int SlotNum = static_cast<int>(m_ComputeData.size());
+		m_SortPosX.resize(SlotNum);
+		m_SortPosY.resize(SlotNum);
+		m_SortPosZ.resize(SlotNum);
+		m_LiveSlot.clear();
+		for (int i = 0; i < SlotNum; i++)
+		{
+			m_SortPosX[i] = m_ComputeData[i].Pos[0];
+			m_SortPosY[i] = m_ComputeData[i].Pos[1];
+			m_SortPosZ[i] = m_ComputeData[i].Pos[2];
+			if (m_ComputeData[i].Pos[3] > 0.0f)
+			{
+				m_LiveSlot.push_back(i);
+			}
+		}
 
-			pInstanceData[i].Color.a = m_SmokeData[i].Color.a;
+		const int* pOrder = SlotNum > 0 ? SortLiveSlot(&m_SortPosX[0], &m_SortPosY[0], &m_SortPosZ[0], SlotNum) : nullptr;
+
+		m_InstanceNum = 0;
+		for (unsigned int i = 0; i < m_LiveSlot.size(); i++)
+		{
+			const SmokeComputeKernel::PARTICLE& Particle = m_ComputeData[pOrder[i]];
+			D3DXVECTOR3 Pos(Particle.Pos[0], Particle.Pos[1], Particle.Pos[2]);
+			SetInstanceData(&pInstanceData[m_InstanceNum], &Pos, Particle.State[1], Particle.State[2]);
+			m_InstanceNum++;
 		}
 
 		SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->Unmap(m_pInstanceBuffer, 0);
@@ -540,4 +832,137 @@ bool Smoke::WriteInstanceBuffer()
 	return false;
 }
 
+const int* Smoke::SortLiveSlot(const float* _pPosX, const float* _pPosY, const float* _pPosZ, int _slotNum)
+{
+	if (m_SortMode == SORT_NONE || m_LiveSlot.empty())
+	{
+		m_SortTime = 0.0f;
+		return m_LiveSlot.empty() ? nullptr : &m_LiveSlot[0];
+	}
+
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	// ビュー行列の3列目で求めたビュー空間のzを深度にする.
+	D3DXMATRIX View = m_pCamera->GetViewMatrix();
+	m_pDepthSorter->SetIncremental(m_SortMode == SORT_INCREMENTAL);
+	m_pDepthSorter->SetDepthPlane(View._13, View._23, View._33, View._43);
+	m_pDepthSorter->Sort(_pPosX, _pPosY, _pPosZ, _slotNum, &m_LiveSlot[0], static_cast<int>(m_LiveSlot.size()));
+
+	std::chrono::steady_clock::time_point EndTime = std::chrono::steady_clock::now();
+	m_SortTime = static_cast<float>(std::chrono::duration<double, std::milli>(EndTime - StartTime).count());
+
+	return m_pDepthSorter->GetOrder();
+}
+
+void Smoke::SetInstanceData(INSTANCE_DATA* _pInstanceData, const D3DXVECTOR3* _pPos, float _scale, float _alpha)
+{
+	D3DXMATRIX MatWorld, MatRotate, MatTranslate;
+	m_pCamera->GetBillBoardRotation(_pPos, &MatRotate);
+	D3DXMatrixScaling(&MatWorld, _scale, _scale, 1.0f);
+	D3DXMatrixMultiply(&MatWorld, &MatWorld, &MatRotate);
+	D3DXMatrixTranslation(&MatTranslate, _pPos->x, _pPos->y, _pPos->z);
+	D3DXMatrixMultiply(&MatWorld, &MatWorld, &MatTranslate);
+
+	D3DXMatrixTranspose(&MatWorld, &MatWorld);
+	_pInstanceData->Mat = MatWorld;
+	_pInstanceData->Color = D3DXCOLOR(1.0f, 1.0f, 1.0f, _alpha);
+}
+
+bool Smoke::ResizeBuffer()
+{
+	if (m_InstanceCapacity == m_pSmokeParticles->GetEmitterNum() * std::max(m_pSmokeParticles->GetCapacity(), m_ComputeParticleNum))
+	{
+		return true;
+	}
+
+	// エミッタが追加されたので全てのパーティクルが入るように作り直す.
+	ReleaseComputeShaderBuffer();
+	ReleaseInstanceBuffer();
+
+	if (!CreateInstanceBuffer())		return false;
+	if (!CreateComputeShaderBuffer())	return false;
+
+	return true;
+}
+
+void Smoke::SwitchMode()
+{
+	// Ring, Eval, CS CPU, CS GPUの順に切り替える.
+	if (m_IsComputeShader)
+	{
+		if (m_IsComputeCpu)
+		{
+			m_IsComputeCpu = false;
+		}
+		else
+		{
+			m_IsComputeShader = false;
+			m_IsComputeCpu = true;
+			m_pSmokeParticles->SetStateless(false);
+		}
+	}
+	else if (m_pSmokeParticles->IsStateless())
+	{
+		m_IsComputeShader = true;
+	}
+	else
+	{
+		m_pSmokeParticles->SetStateless(true);
+	}
+
+	// 切り替えると煙は出始めからやり直す.
+	m_pSmokeParticles->SetTime(0.0f);
+	m_InstanceNum = 0;
+	m_pDepthSorter->Reset();
+	m_SortTime = 0.0f;
+
+	CreateComputeData();
+	if (m_pComputeShaderBuffer != nullptr)
+	{
+		SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->UpdateSubresource(
+			m_pComputeShaderBuffer, 0, nullptr, m_ComputeData.data(), 0, 0);
+	}
+}
+
+void Smoke::DispatchCompute()
+{
+	if (m_ComputeData.empty())
+	{
+		return;
+	}
+
+	m_ComputeConstant.ParticleNum = static_cast<unsigned int>(m_ComputeData.size());
+	int GroupNum = SmokeComputeKernel::GetGroupNum(static_cast<int>(m_ComputeData.size()));
+
+	if (m_IsComputeCpu)
+	{
+		m_pComputeKernel->Dispatch(m_ComputeConstant, m_ComputeData.data(), GroupNum);
+		return;
+	}
+
+	ID3D11DeviceContext* pDeviceContext = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext();
+
+	D3D11_MAPPED_SUBRESOURCE MappedResource;
+	if (SUCCEEDED(pDeviceContext->Map(
+		m_pComputeConstantBuffer,
+		0,
+		D3D11_MAP_WRITE_DISCARD,
+		0,
+		&MappedResource)))
+	{
+		memcpy(MappedResource.pData, &m_ComputeConstant, sizeof(SmokeComputeKernel::CONSTANT));
+		pDeviceContext->Unmap(m_pComputeConstantBuffer, 0);
+	}
+
+	pDeviceContext->CSSetShader(SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->GetComputeShader(m_ComputeShaderIndex), nullptr, 0);
+	pDeviceContext->CSSetConstantBuffers(0, 1, &m_pComputeConstantBuffer);
+	pDeviceContext->CSSetUnorderedAccessViews(0, 1, &m_pComputeShaderBufferAccess, nullptr);
+	pDeviceContext->Dispatch(GroupNum, 1, 1);
+
+	// 描画で頂点シェーダーから読むので外しておく.
+	ID3D11UnorderedAccessView* pNullAccess = nullptr;
+	pDeviceContext->CSSetUnorderedAccessViews(0, 1, &pNullAccess, nullptr);
+	pDeviceContext->CSSetShader(nullptr, nullptr, 0);
+}
+
 
@@ -12,17 +12,39 @@
 #include <D3DX11.h>
 #include <D3DX10.h>
 #include <random>
+#include <vector>
 
 #include "ObjectManagerBase\ObjectBase\ObjectBase.h"
 #include "TaskManager\TaskBase\UpdateTask\UpdateTask.h"
 #include "TaskManager\TaskBase\DrawTask\DrawTask.h"
+#include "InputDeviceManager\InputDeviceManager.h"
+#include "SmokeComputeKernel\SmokeComputeKernel.h"
 
 
 class MainCamera;
+class SmokeParticles;
+class SmokeDepthSorter;
+class ThreadPool;
+
+namespace Lib
+{
+	namespace Dx11
+	{
+		class Font;
+	}
+}
 
 
 /**
  * 煙クラス
+ *
+ * 全ての煙の発生源(エミッタ)のパーティクルを1つのパーティクル配列とインスタンスバッファにまとめ,
+ * 1回のインスタンス描画で描画する. エミッタは家などがAddEmitterで追加し, 数に上限は無い.
+ * パーティクルはエミッタごとのリングバッファで管理し, 生きているパーティクルだけを更新して書き込む.
+ * Lキーで, 毎フレーム積分するモード, 時刻から閉じた式で求めるモード,
+ * コンピュートカーネルをCPUで実行するモードとGPUで実行するモードを順に切り替える.
+ * カーネルはどちらも同じパーティクル配列を同じ手順で更新するので, GPUが無い環境でもCPUで動作を確認できる.
+ * CPUで更新したパーティクルはカメラの深度で奥から手前の順に並べて書き込む(Pキーでソートの方法を切り替える).
  */
 class Smoke : public Lib::ObjectBase
 {
@@ -30,9 +52,9 @@ public:
 	/**
 	 * コンストラクタ
 	 * @param[in] _pCamera カメラオブジェクト
-	 * @param[in] _pPos 煙の発生座標
+	 * @param[in] _pThreadPool コンピュートカーネルをCPUで実行するスレッドプール
 	 */
-	Smoke(MainCamera* _pCamera, D3DXVECTOR3* _pPos);
+	Smoke(MainCamera* _pCamera, ThreadPool* _pThreadPool);
 
 	/**
 	 * デストラクタ
@@ -60,68 +82,70 @@ public:
 	 */
 	virtual void Draw();
 
-private:
-	enum
-	{
-		VERTEX_NUM = 4,		//!< 頂点数.
-		PARTICLE_NUM = 600	//!< パーティクルの数.
-	};
-
 	/**
-	 * ポイントスプライト用の頂点構造体
+	 * 煙の発生源を追加
+	 *
+	 * 初期化の後に追加した場合は, 次の更新でインスタンスバッファを作り直す.
+	 * @param[in] _pos 煙の発生座標
+	 * @return 追加したエミッタのインデックス
 	 */
-	struct VERTEX
-	{
-		D3DXVECTOR3	Pos;	//!< 頂点座標.
-		D3DXVECTOR2 UV;		//!< テクスチャ座標.
-	};
+	int AddEmitter(const D3DXVECTOR3& _pos);
 
 	/**
-	 * インスタンス別データ構造体
+	 * エミッタの数を取得
+	 * @return エミッタの数
 	 */
-	struct INSTANCE_DATA
+	int GetEmitterNum() const;
+
+private:
+	enum
 	{
-		D3DXMATRIX Mat;		//!< 変換行列.
-		D3DXCOLOR Color;	//!< カラー値.
+		VERTEX_NUM = 4		//!< 頂点数.
 	};
 
 	/**
-	 * 煙のデータ構造体 
+	 * 深度ソートの方法
 	 */
-	struct SMOKE_DATA
+	enum SORT_MODE
 	{
-		D3DXVECTOR3 Pos;		//!< 煙の座標.
-		D3DXVECTOR3	Scale;		//!< 煙のスケーリング値.
-		D3DXCOLOR	Color;		//!< 煙のカラー値.
-		D3DXVECTOR3 Vec;		//!< 移動速度.
-		int			Life;		//!< 消滅するまで寿命.
-		bool		IsActive;	//!< アクティブになっているか.
+		SORT_NONE,			//!< ソートしない(スロットの順に描画する).
+		SORT_RADIX,			//!< 毎フレーム全体を基数ソートで並べる.
+		SORT_INCREMENTAL,	//!< 前のフレームの順番から並べ直す.
+		SORT_MODE_NUM		//!< ソートの方法の数.
 	};
 
 	/**
-	 * 煙パーティクルのエミッタ構造体
+	 * ポイントスプライト用の頂点構造体
 	 */
-	struct EMITTER_DATA
+	struct VERTEX
 	{
-		D3DXVECTOR3 Pos;		//!< エミッタの座標.
-		D3DXVECTOR3 Vec;		//!< パーティクルの初速.
-		float AngleRange;		//!< 範囲.
+		D3DXVECTOR3	Pos;	//!< 頂点座標.
+		D3DXVECTOR2 UV;		//!< テクスチャ座標.
 	};
 
 	/**
-	 * コンピュートシェーダーバッファ
+	 * インスタンス別データ構造体
 	 */
-	struct COMPUTESHADER_BUFFER
+	struct INSTANCE_DATA
 	{
-		D3DXVECTOR4 Pos;	//!< パーティクルの座標.
-		D3DXVECTOR4 Scale;	//!< パーティクルの拡大率.
-		D3DXCOLOR Color;	//!< パーティクルのカラー値.
-		D3DXVECTOR4 Life;	//!< パーティクルのライフ値.
+		D3DXMATRIX Mat;		//!< 変換行列.
+		D3DXCOLOR Color;	//!< カラー値.
 	};
 
 
-	static const D3DXVECTOR2 m_DefaultSize;	//!< デフォルトの頂点サイズ.
-	static const D3DXVECTOR2 m_LifeRange;	//!< 寿命の範囲.
+	static const D3DXVECTOR2 m_DefaultSize;		//!< デフォルトの頂点サイズ.
+	static const D3DXVECTOR2 m_LifeRange;		//!< 寿命の範囲.
+	static const D3DXVECTOR3 m_EmitVelocity;	//!< パーティクルの初速.
+	static const float		 m_EmitAngleRange;	//!< パーティクルの移動方向のばらつき(度).
+	static const float		 m_EmitRate;		//!< 1フレームにエミッタごとに出現するパーティクルの数.
+	static const int		 m_LifeFrame;		//!< パーティクルの寿命(フレーム数).
+	static const float		 m_ScaleSpeed;		//!< 1フレームに増えるパーティクルの拡大率.
+	static const float		 m_AlphaSpeed;		//!< 1フレームに減るパーティクルのアルファ値.
+	static const int		 m_ComputeParticleNum;	//!< コンピュートカーネルでエミッタごとに使うパーティクルの数.
+	static const D3DXVECTOR2 m_DefaultFontPos;	//!< フォントの座標.
+	static const D3DXVECTOR2 m_SortFontPos;		//!< ソートの時間を表示するフォントの座標.
+	static const D3DXVECTOR2 m_DefaultFontSize;	//!< フォントのサイズ.
+	static const D3DXCOLOR	 m_DefaultFontColor;	//!< フォントのカラー値.
 
 
 	//----------------------------------------------------------------------
@@ -140,6 +164,12 @@ private:
 	 */
 	bool CreateVertexBuffer();
 
+	/**
+	 * インスタンスバッファの生成(全てのエミッタが同時に持てるパーティクルの分だけ確保する)
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool CreateInstanceBuffer();
+
 	/**
 	 * シェーダーの初期化
 	 * @return 初期化に成功したらtrue 失敗したらfalse
@@ -170,6 +200,17 @@ private:
 	 */
 	bool CreateComputeShaderBuffer();
 
+	/**
+	 * コンピュートカーネルのパーティクルの初期データを生成
+	 */
+	void CreateComputeData();
+
+	/**
+	 * フォントオブジェクトの初期化
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool CreateFontObject();
+
 
 	//----------------------------------------------------------------------
 	// 解放処理
@@ -185,6 +226,11 @@ private:
 	 */
 	void ReleaseVertexBuffer();
 
+	/**
+	 * インスタンスバッファの解放
+	 */
+	void ReleaseInstanceBuffer();
+
 	/**
 	 * シェーダーの解放
 	 */
@@ -210,17 +256,63 @@ private:
 	 */
 	void ReleaseComputeShaderBuffer();
 
+	/**
+	 * フォントオブジェクトの解放
+	 */
+	void ReleaseFontObject();
+
 
 	//----------------------------------------------------------------------
 	// その他処理
 	//----------------------------------------------------------------------
 
 	/**
-	 * インスタンスバッファへの書き込み
+	 * 生きているパーティクルだけをインスタンスバッファへ書き込む
 	 * @return 成功したらtrue 失敗したらfalse
 	 */
 	bool WriteInstanceBuffer();
 
+	/**
+	 * CPUで更新したコンピュートカーネルの活動中のパーティクルをインスタンスバッファへ書き込む
+	 * @return 成功したらtrue 失敗したらfalse
+	 */
+	bool WriteComputeInstanceBuffer();
+
+	/**
+	 * 生きているスロット(m_LiveSlot)を奥から手前の順に並べる
+	 * @param[in] _pPosX スロットごとのx座標
+	 * @param[in] _pPosY スロットごとのy座標
+	 * @param[in] _pPosZ スロットごとのz座標
+	 * @param[in] _slotNum スロットの数
+	 * @return 描画する順に並べたスロットの配列(ソートしない場合はm_LiveSlotのまま)
+	 */
+	const int* SortLiveSlot(const float* _pPosX, const float* _pPosY, const float* _pPosZ, int _slotNum);
+
+	/**
+	 * パーティクル1つ分のインスタンスデータを設定
+	 * @param[out] _pInstanceData 設定するインスタンスデータ
+	 * @param[in] _pPos パーティクルの座標
+	 * @param[in] _scale パーティクルの拡大率
+	 * @param[in] _alpha パーティクルのアルファ値
+	 */
+	void SetInstanceData(INSTANCE_DATA* _pInstanceData, const D3DXVECTOR3* _pPos, float _scale, float _alpha);
+
+	/**
+	 * 初期化の後に追加されたエミッタに合わせてバッファを作り直す
+	 * @return 成功したらtrue 失敗したらfalse
+	 */
+	bool ResizeBuffer();
+
+	/**
+	 * 煙の更新方法を次のモードに切り替える
+	 */
+	void SwitchMode();
+
+	/**
+	 * コンピュートカーネルを実行する(m_IsComputeCpuならCPU, そうでなければGPUで実行する)
+	 */
+	void DispatchCompute();
+
 
 
 	//--------------------タスクオブジェクト--------------------
@@ -230,30 +322,48 @@ private:
 
 	//--------------------その他オブジェクト--------------------
 	MainCamera*					m_pCamera;						//!< カメラオブジェクト.
+	Lib::Dx11::Font*			m_pFont;						//!< フォント描画オブジェクト.
 
 
 	//--------------------描画関連--------------------
 	int							m_VertexShaderIndex;			//!< 頂点シェーダーインデックス.
 	int							m_PixelShaderIndex;				//!< ピクセルシェーダーインデックス.
 	int							m_ComputeShaderIndex;			//!< コンピュートシェーダーインデックス.
+	int							m_ComputeVertexShaderIndex;		//!< コンピュートシェーダーバッファを読む頂点シェーダーインデックス.
 	ID3D11Buffer*				m_pVertexBuffer;				//!< 頂点バッファ.
 	ID3D11Buffer*				m_pInstanceBuffer;				//!< インスタンシングバッファ.
 	ID3D11Buffer*				m_pComputeShaderBuffer;			//!< コンピュートシェーダーで使用するバッファ.
 	ID3D11UnorderedAccessView*	m_pComputeShaderBufferAccess;	//!< コンピュートシェーダーバッファのアクセスビュー.
+	ID3D11ShaderResourceView*	m_pComputeShaderBufferResource;	//!< コンピュートシェーダーバッファのリソースビュー.
+	ID3D11Buffer*				m_pComputeConstantBuffer;		//!< コンピュートシェーダーの定数バッファ.
 	ID3D11InputLayout*			m_pVertexLayout;				//!< 頂点入力レイアウト.
+	ID3D11InputLayout*			m_pComputeVertexLayout;			//!< コンピュートシェーダーバッファを読む頂点入力レイアウト.
 	ID3D11DepthStencilState*	m_pDepthStencilState;			//!< 深度ステンシルステート.
 	ID3D11BlendState*			m_pBlendState;					//!< ブレンドステート.
 	VERTEX						m_pVertexData[VERTEX_NUM];		//!< 頂点データ.
-	INSTANCE_DATA				m_pInstanceData[PARTICLE_NUM];	//!< インスタンスデータ.
+	int							m_InstanceCapacity;				//!< インスタンスバッファに確保したパーティクルの数.
+	int							m_InstanceNum;					//!< インスタンスバッファに書き込んだパーティクルの数.
 
 	int							m_SmokeTextureIndex;			//!< 煙のテクスチャインデックス.
 	int							m_SkyCLUTIndex;					//!< ライトのカラールックアップテーブル.
 
 	bool						m_IsActive;						//!< このオブジェクトの活動状態.
 	bool						m_IsComputeShader;				//!< コンピュートシェーダを使用するか.
-	EMITTER_DATA				m_EmitterData;					//!< エミッタデータ構造体.
-	SMOKE_DATA					m_SmokeData[PARTICLE_NUM];		//!< 煙のデータ配列.
-	COMPUTESHADER_BUFFER		m_ComputeData[PARTICLE_NUM];	//!< コンピュートシェーダで使用するデータ.
+	bool						m_IsComputeCpu;					//!< コンピュートカーネルをCPUで実行するか.
+	SmokeComputeKernel*			m_pComputeKernel;				//!< コンピュートカーネルのCPUバックエンド.
+	SmokeComputeKernel::CONSTANT	m_ComputeConstant;			//!< コンピュートカーネルの定数.
+	SmokeParticles*				m_pSmokeParticles;				//!< 全エミッタの煙パーティクル.
+	SmokeDepthSorter*			m_pDepthSorter;					//!< パーティクルの深度ソート.
+	SORT_MODE					m_SortMode;						//!< 深度ソートの方法.
+	float						m_UpdateTime;					//!< パーティクルの更新と書き込みにかかった時間(ミリ秒).
+	float						m_SortTime;						//!< 深度ソートにかかった時間(ミリ秒).
+	std::vector<int>			m_LiveSlot;						//!< 生きているパーティクルのスロット.
+	std::vector<float>			m_SortPosX;						//!< 深度ソートに渡すコンピュートカーネルのパーティクルのx座標.
+	std::vector<float>			m_SortPosY;						//!< 深度ソートに渡すコンピュートカーネルのパーティクルのy座標.
+	std::vector<float>			m_SortPosZ;						//!< 深度ソートに渡すコンピュートカーネルのパーティクルのz座標.
+	const Lib::KeyDevice::KEYSTATE* m_pKeyState;				//!< キーの状態.
+	std::vector<SmokeComputeKernel::PARTICLE>	m_ComputeData;	//!< コンピュートシェーダで使用するデータ.
+	std::vector<D3DXVECTOR3>	m_EmitterPos;					//!< エミッタの座標.
 	std::random_device			m_RandDevice;					//!< 乱数生成デバイス.
 	std::mt19937				m_MersenneTwister;				//!< 乱数生成オブジェクト.
 
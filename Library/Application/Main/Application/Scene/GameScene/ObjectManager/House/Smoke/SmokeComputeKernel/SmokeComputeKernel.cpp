@@ -0,0 +1,312 @@
+﻿/**
+ * @file	SmokeComputeKernel.cpp
+ * @brief	煙パーティクルのコンピュートカーネルクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "SmokeComputeKernel.h"
+
+#include <algorithm>
+
+#include "Main\ThreadPool\ThreadPool.h"
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+SmokeComputeKernel::SmokeComputeKernel() :
+	m_pThreadPool(nullptr),
+	m_SimdType(CpuFeature::GetSimdType())
+{
+}
+
+SmokeComputeKernel::~SmokeComputeKernel()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void SmokeComputeKernel::Dispatch(const CONSTANT& _constant, PARTICLE* _pParticle, int _groupNum)
+{
+	RUN_FUNC pRunFunc = GetRunFunc(m_SimdType);
+	int ParticleNum = static_cast<int>(_constant.ParticleNum);
+
+	// ParticleNumを超えるスレッドは何もしないので, グループの範囲をパーティクルの数で切り詰める.
+	auto RunGroup = [&](int _group)
+	{
+		int First = _group * THREAD_GROUP_SIZE;
+		int Count = std::min(static_cast<int>(THREAD_GROUP_SIZE), ParticleNum - First);
+		if (Count > 0)
+		{
+			pRunFunc(_constant, _pParticle, First, Count);
+		}
+	};
+
+	if (m_pThreadPool != nullptr && _groupNum > 1)
+	{
+		m_pThreadPool->ParallelFor(_groupNum, RunGroup);
+	}
+	else
+	{
+		for (int i = 0; i < _groupNum; i++)
+		{
+			RunGroup(i);
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Static Public Functions
+//----------------------------------------------------------------------
+void SmokeComputeKernel::ResetParticle(
+	PARTICLE* _pParticle, float _emitterX, float _emitterY, float _emitterZ,
+	float _velX, float _velY, float _velZ, float _lifeFrame, int _spawnFrame)
+{
+	_pParticle->Pos[0] = 0.0f;
+	_pParticle->Pos[1] = -1.0f;
+	_pParticle->Pos[2] = 0.0f;
+	_pParticle->Pos[3] = 0.0f;
+	_pParticle->Vel[0] = _velX;
+	_pParticle->Vel[1] = _velY;
+	_pParticle->Vel[2] = _velZ;
+	_pParticle->Vel[3] = 0.0f;
+	_pParticle->Emitter[0] = _emitterX;
+	_pParticle->Emitter[1] = _emitterY;
+	_pParticle->Emitter[2] = _emitterZ;
+	_pParticle->Emitter[3] = 1.0f;
+	// 待機中は1回のDispatchで寿命カウンタが1増え, 寿命に達したDispatchで出現する.
+	_pParticle->State[0] = _lifeFrame - static_cast<float>(_spawnFrame);
+	_pParticle->State[1] = 1.0f;
+	_pParticle->State[2] = 1.0f;
+	_pParticle->State[3] = 0.0f;
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+SmokeComputeKernel::RUN_FUNC SmokeComputeKernel::GetRunFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &RunAVX2;
+	case CpuFeature::SIMD_SSE:	return &RunSSE;
+	case CpuFeature::SIMD_NEON:	return &RunNEON;
+	default:					return &RunScalar;
+	}
+}
+
+void SmokeComputeKernel::RunScalar(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count)
+{
+	const float ActiveDelta[4] = { -1.0f, _constant.ScaleSpeed, -_constant.AlphaSpeed, 0.0f };
+	const float InactiveDelta[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+	const float SpawnState[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+
+	for (int i = _first; i < _first + _count; i++)
+	{
+		PARTICLE* pParticle = &_pParticle[i];
+
+		// 活動中の場合と待機中の場合を両方求めてから選ぶ(Compute.fxと同じ手順).
+		float ActivePos[4], ActiveState[4], InactivePos[4], InactiveState[4];
+		for (int j = 0; j < 4; j++)
+		{
+			ActivePos[j] = pParticle->Pos[j] + pParticle->Vel[j];
+			ActiveState[j] = pParticle->State[j] + ActiveDelta[j];
+			InactiveState[j] = pParticle->State[j] + InactiveDelta[j];
+		}
+		ActivePos[3] = ActiveState[0] <= 0.0f ? 0.0f : ActivePos[3];
+
+		bool IsSpawn = InactiveState[0] >= _constant.LifeFrame;
+		for (int j = 0; j < 4; j++)
+		{
+			InactivePos[j] = IsSpawn ? pParticle->Emitter[j] : pParticle->Pos[j];
+			InactiveState[j] = IsSpawn && j != 0 ? SpawnState[j] : InactiveState[j];
+		}
+
+		bool IsActive = pParticle->Pos[3] > 0.0f;
+		for (int j = 0; j < 4; j++)
+		{
+			pParticle->Pos[j] = IsActive ? ActivePos[j] : InactivePos[j];
+			pParticle->State[j] = IsActive ? ActiveState[j] : InactiveState[j];
+		}
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void SmokeComputeKernel::RunSSE(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count)
+{
+	const __m128 ActiveDelta = _mm_set_ps(0.0f, -_constant.AlphaSpeed, _constant.ScaleSpeed, -1.0f);
+	const __m128 InactiveDelta = _mm_set_ps(0.0f, 0.0f, 0.0f, 1.0f);
+	const __m128 SpawnState = _mm_set_ps(0.0f, 1.0f, 1.0f, 0.0f);
+	const __m128 MaskX = _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1));
+	const __m128 MaskW = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+	// 1つのスレッドのfloat4を1つのレジスタで計算する.
+	// 出現の時期をずらしたパーティクルは活動中と待機中がそれぞれ連続して並ぶので, 両方を求めて選ぶよりも
+	// 分岐して必要な方だけを求めた方が速い(待機中で出現しないなら座標は読み書きしない).
+	for (int i = _first; i < _first + _count; i++)
+	{
+		PARTICLE* pParticle = &_pParticle[i];
+		__m128 State = _mm_loadu_ps(pParticle->State);
+
+		if (pParticle->Pos[3] > 0.0f)
+		{
+			__m128 ActivePos = _mm_add_ps(_mm_loadu_ps(pParticle->Pos), _mm_loadu_ps(pParticle->Vel));
+			__m128 ActiveState = _mm_add_ps(State, ActiveDelta);
+			if (_mm_cvtss_f32(ActiveState) <= 0.0f)
+			{
+				ActivePos = _mm_andnot_ps(MaskW, ActivePos);
+			}
+
+			_mm_storeu_ps(pParticle->Pos, ActivePos);
+			_mm_storeu_ps(pParticle->State, ActiveState);
+		}
+		else
+		{
+			__m128 InactiveState = _mm_add_ps(State, InactiveDelta);
+			if (_mm_cvtss_f32(InactiveState) >= _constant.LifeFrame)
+			{
+				_mm_storeu_ps(pParticle->Pos, _mm_loadu_ps(pParticle->Emitter));
+				InactiveState = _mm_or_ps(_mm_and_ps(MaskX, InactiveState), SpawnState);
+			}
+
+			_mm_storeu_ps(pParticle->State, InactiveState);
+		}
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void SmokeComputeKernel::RunAVX2(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count)
+{
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 LifeFrame = _mm256_set1_ps(_constant.LifeFrame);
+	const __m256 ActiveDelta = _mm256_set_ps(
+		0.0f, -_constant.AlphaSpeed, _constant.ScaleSpeed, -1.0f,
+		0.0f, -_constant.AlphaSpeed, _constant.ScaleSpeed, -1.0f);
+	const __m256 InactiveDelta = _mm256_set_ps(0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	const __m256 MaskW = _mm256_castsi256_ps(_mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0));
+
+	// 2つのスレッドのfloat4を下位と上位の128bitに入れてまとめて計算する.
+	// シャッフルは128bitごとに行われるので, 各スレッドの要素の複製はそれぞれの半分の中で済む.
+	// 2つとも活動中か, 2つとも待機中で出現しない場合だけまとめて計算し, それ以外(活動と待機の境目と出現)はSSE2版で1つずつ計算する.
+	int i = _first;
+	for (; i + 2 <= _first + _count; i += 2)
+	{
+		PARTICLE* pParticle = &_pParticle[i];
+		bool IsActive0 = pParticle[0].Pos[3] > 0.0f;
+		bool IsActive1 = pParticle[1].Pos[3] > 0.0f;
+		__m256 State = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pParticle[0].State)), _mm_loadu_ps(pParticle[1].State), 1);
+
+		if (IsActive0 && IsActive1)
+		{
+			__m256 Pos = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pParticle[0].Pos)), _mm_loadu_ps(pParticle[1].Pos), 1);
+			__m256 Vel = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pParticle[0].Vel)), _mm_loadu_ps(pParticle[1].Vel), 1);
+			__m256 ActivePos = _mm256_add_ps(Pos, Vel);
+			__m256 ActiveState = _mm256_add_ps(State, ActiveDelta);
+			__m256 IsDead = _mm256_and_ps(MaskW, _mm256_cmp_ps(_mm256_shuffle_ps(ActiveState, ActiveState, 0), Zero, _CMP_LE_OQ));
+			ActivePos = _mm256_andnot_ps(IsDead, ActivePos);
+
+			_mm_storeu_ps(pParticle[0].Pos, _mm256_castps256_ps128(ActivePos));
+			_mm_storeu_ps(pParticle[1].Pos, _mm256_extractf128_ps(ActivePos, 1));
+			_mm_storeu_ps(pParticle[0].State, _mm256_castps256_ps128(ActiveState));
+			_mm_storeu_ps(pParticle[1].State, _mm256_extractf128_ps(ActiveState, 1));
+		}
+		else if (!IsActive0 && !IsActive1)
+		{
+			__m256 InactiveState = _mm256_add_ps(State, InactiveDelta);
+			if ((_mm256_movemask_ps(_mm256_cmp_ps(InactiveState, LifeFrame, _CMP_GE_OQ)) & 0x11) != 0)
+			{
+				RunSSE(_constant, _pParticle, i, 2);
+				continue;
+			}
+
+			_mm_storeu_ps(pParticle[0].State, _mm256_castps256_ps128(InactiveState));
+			_mm_storeu_ps(pParticle[1].State, _mm256_extractf128_ps(InactiveState, 1));
+		}
+		else
+		{
+			RunSSE(_constant, _pParticle, i, 2);
+		}
+	}
+
+	RunSSE(_constant, _pParticle, i, _first + _count - i);
+}
+
+#else
+
+void SmokeComputeKernel::RunSSE(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count)
+{
+	RunScalar(_constant, _pParticle, _first, _count);
+}
+
+void SmokeComputeKernel::RunAVX2(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count)
+{
+	RunScalar(_constant, _pParticle, _first, _count);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void SmokeComputeKernel::RunNEON(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count)
+{
+	const float ActiveDeltaData[4] = { -1.0f, _constant.ScaleSpeed, -_constant.AlphaSpeed, 0.0f };
+	const float InactiveDeltaData[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+	const float SpawnStateData[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+	const uint32_t MaskXData[4] = { 0xffffffff, 0, 0, 0 };
+	const uint32_t MaskWData[4] = { 0, 0, 0, 0xffffffff };
+	const float32x4_t ActiveDelta = vld1q_f32(ActiveDeltaData);
+	const float32x4_t InactiveDelta = vld1q_f32(InactiveDeltaData);
+	const float32x4_t SpawnState = vld1q_f32(SpawnStateData);
+	const uint32x4_t MaskX = vld1q_u32(MaskXData);
+	const uint32x4_t MaskW = vld1q_u32(MaskWData);
+
+	// 1つのスレッドのfloat4を1つのレジスタで計算する(SSE2版と同じく活動中か待機中かで分岐する).
+	for (int i = _first; i < _first + _count; i++)
+	{
+		PARTICLE* pParticle = &_pParticle[i];
+		float32x4_t State = vld1q_f32(pParticle->State);
+
+		if (pParticle->Pos[3] > 0.0f)
+		{
+			float32x4_t ActivePos = vaddq_f32(vld1q_f32(pParticle->Pos), vld1q_f32(pParticle->Vel));
+			float32x4_t ActiveState = vaddq_f32(State, ActiveDelta);
+			if (vgetq_lane_f32(ActiveState, 0) <= 0.0f)
+			{
+				ActivePos = vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(ActivePos), MaskW));
+			}
+
+			vst1q_f32(pParticle->Pos, ActivePos);
+			vst1q_f32(pParticle->State, ActiveState);
+		}
+		else
+		{
+			float32x4_t InactiveState = vaddq_f32(State, InactiveDelta);
+			if (vgetq_lane_f32(InactiveState, 0) >= _constant.LifeFrame)
+			{
+				vst1q_f32(pParticle->Pos, vld1q_f32(pParticle->Emitter));
+				InactiveState = vbslq_f32(MaskX, InactiveState, SpawnState);
+			}
+
+			vst1q_f32(pParticle->State, InactiveState);
+		}
+	}
+}
+
+#else
+
+void SmokeComputeKernel::RunNEON(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count)
+{
+	RunScalar(_constant, _pParticle, _first, _count);
+}
+
+#endif // CPUFEATURE_NEON
+
@@ -0,0 +1,177 @@
+﻿/**
+ * @file	SmokeComputeKernel.h
+ * @brief	煙パーティクルのコンピュートカーネルクラス定義
+ * @author	morimoto
+ */
+#ifndef SMOKECOMPUTEKERNEL_H
+#define SMOKECOMPUTEKERNEL_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+class ThreadPool;
+
+
+/**
+ * 煙パーティクルのコンピュートカーネルクラス
+ *
+ * Compute.fxのCSと同じ計算をCPUで実行するバックエンド.
+ * パーティクルとカーネルの定数はCompute.fxの構造体と同じ並びなので, 同じ配列をそのまま
+ * コンピュートシェーダーのバッファにも使える.
+ *
+ * Dispatchはスレッドグループを1つの処理単位としてスレッドプールで並列に実行する.
+ * グループの中の各スレッド(パーティクル)のfloat4の計算はSIMDレジスタで行い,
+ * AVX2では2つのスレッドを1つのレジスタでまとめて計算する.
+ * SIMD版はCompute.fxのように活動中と待機中の両方を求めて選ぶのではなく, 分岐して必要な方だけを求める.
+ * 命令セットによらずスカラー版と同じ結果になる.
+ *
+ * 各パーティクルは待機と活動を繰り返す. 待機中は寿命カウンタを増やし, 寿命に達したらエミッタの座標に
+ * 出現する. 活動中は寿命カウンタを減らしながら移動, 拡大, フェードアウトし, 0になったら待機に戻る.
+ */
+class SmokeComputeKernel
+{
+public:
+	enum
+	{
+		THREAD_GROUP_SIZE = 64	//!< 1つのスレッドグループのスレッド数(Compute.fxのnumthreadsと合わせる).
+	};
+
+	/**
+	 * パーティクルの構造体(Compute.fxのParticleDataと同じ並び)
+	 */
+	struct PARTICLE
+	{
+		float Pos[4];		//!< 座標(wは活動中なら1, 待機中なら0).
+		float Vel[4];		//!< 1フレームの移動量(wは0).
+		float Emitter[4];	//!< 出現する座標(wは1).
+		float State[4];		//!< 寿命カウンタ, 拡大率, アルファ値, 0.
+	};
+
+	/**
+	 * カーネルの定数の構造体(Compute.fxのcbufferと同じ並び)
+	 */
+	struct CONSTANT
+	{
+		float			LifeFrame;		//!< パーティクルの寿命(フレーム数).
+		float			ScaleSpeed;		//!< 1フレームに増える拡大率.
+		float			AlphaSpeed;		//!< 1フレームに減るアルファ値.
+		unsigned int	ParticleNum;	//!< パーティクルの数(これ以降のスレッドは何もしない).
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	SmokeComputeKernel();
+
+	/**
+	 * デストラクタ
+	 */
+	~SmokeComputeKernel();
+
+	/**
+	 * 並列に実行するためのスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元のスレッドだけで実行する)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool)
+	{
+		m_pThreadPool = _pThreadPool;
+	}
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 使用する命令セットを取得
+	 * @return 命令セット
+	 */
+	CpuFeature::SIMD_TYPE GetSimdType() const
+	{
+		return m_SimdType;
+	}
+
+	/**
+	 * カーネルをCPUで実行する
+	 * @param[in] _constant カーネルの定数
+	 * @param[in,out] _pParticle パーティクルの配列(_constant.ParticleNum個)
+	 * @param[in] _groupNum 実行するスレッドグループの数
+	 */
+	void Dispatch(const CONSTANT& _constant, PARTICLE* _pParticle, int _groupNum);
+
+	/**
+	 * パーティクルの数に必要なスレッドグループの数を取得
+	 * @param[in] _particleNum パーティクルの数
+	 * @return スレッドグループの数
+	 */
+	static int GetGroupNum(int _particleNum)
+	{
+		return (_particleNum + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE;
+	}
+
+	/**
+	 * 待機中のパーティクルを設定
+	 * @param[out] _pParticle 設定するパーティクル
+	 * @param[in] _emitterX 出現するx座標
+	 * @param[in] _emitterY 出現するy座標
+	 * @param[in] _emitterZ 出現するz座標
+	 * @param[in] _velX 1フレームのx方向の移動量
+	 * @param[in] _velY 1フレームのy方向の移動量
+	 * @param[in] _velZ 1フレームのz方向の移動量
+	 * @param[in] _lifeFrame パーティクルの寿命(CONSTANT::LifeFrameと同じ値)
+	 * @param[in] _spawnFrame 最初に出現するDispatchの回数(1なら最初のDispatchで出現する)
+	 */
+	static void ResetParticle(
+		PARTICLE* _pParticle, float _emitterX, float _emitterY, float _emitterZ,
+		float _velX, float _velY, float _velZ, float _lifeFrame, int _spawnFrame);
+
+private:
+	/**
+	 * 実行関数の型
+	 *
+	 * _first番目から_count個のスレッドを実行する.
+	 */
+	typedef void(*RUN_FUNC)(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count);
+
+	/**
+	 * 命令セットに対応した実行関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 実行関数
+	 */
+	static RUN_FUNC GetRunFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * スレッドの実行(スカラー版)
+	 */
+	static void RunScalar(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count);
+
+	/**
+	 * スレッドの実行(SSE2版)
+	 */
+	static void RunSSE(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count);
+
+	/**
+	 * スレッドの実行(AVX2版)
+	 */
+	static void RunAVX2(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count);
+
+	/**
+	 * スレッドの実行(NEON版)
+	 */
+	static void RunNEON(const CONSTANT& _constant, PARTICLE* _pParticle, int _first, int _count);
+
+
+	ThreadPool*				m_pThreadPool;	//!< 並列に実行するためのスレッドプール.
+	CpuFeature::SIMD_TYPE	m_SimdType;		//!< 使用する命令セット.
+
+};
+
+
+#endif // !SMOKECOMPUTEKERNEL_H
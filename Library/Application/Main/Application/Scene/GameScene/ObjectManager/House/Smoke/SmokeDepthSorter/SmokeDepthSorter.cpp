@@ -0,0 +1,392 @@
+﻿/**
+ * @file	SmokeDepthSorter.cpp
+ * @brief	煙パーティクルの深度ソートクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "SmokeDepthSorter.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const int SmokeDepthSorter::m_MaxMoveRate = 2;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+SmokeDepthSorter::SmokeDepthSorter() :
+	m_SimdType(CpuFeature::GetSimdType()),
+	m_IsIncremental(true),
+	m_IsIncrementalSorted(false),
+	m_Frame(0)
+{
+	m_Plane.A = 0.0f;
+	m_Plane.B = 0.0f;
+	m_Plane.C = 1.0f;
+	m_Plane.D = 0.0f;
+}
+
+SmokeDepthSorter::~SmokeDepthSorter()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void SmokeDepthSorter::SetDepthPlane(float _a, float _b, float _c, float _d)
+{
+	m_Plane.A = _a;
+	m_Plane.B = _b;
+	m_Plane.C = _c;
+	m_Plane.D = _d;
+}
+
+void SmokeDepthSorter::Sort(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, int _slotNum,
+	const int* _pLiveSlot, int _liveNum)
+{
+	m_Frame++;
+
+	// スロットの配列は小さくしないので, 前の順番に残っているスロットは常に範囲に収まる.
+	if (static_cast<int>(m_Key.size()) < _slotNum)
+	{
+		m_Key.resize(_slotNum);
+		m_LiveMark.resize(_slotNum, 0);
+		m_OrderMark.resize(_slotNum, 0);
+	}
+
+	if (_slotNum > 0)
+	{
+		GetKeyFunc(m_SimdType)(m_Plane, _pPosX, _pPosY, _pPosZ, 0, _slotNum, &m_Key[0]);
+	}
+
+	m_IsIncrementalSorted = m_IsIncremental && !m_Order.empty() && IncrementalSort(_pLiveSlot, _liveNum);
+	if (!m_IsIncrementalSorted)
+	{
+		RadixSort(_pLiveSlot, _liveNum);
+	}
+}
+
+void SmokeDepthSorter::Reset()
+{
+	m_Order.clear();
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void SmokeDepthSorter::RadixSort(const int* _pLiveSlot, int _liveNum)
+{
+	m_Order.resize(_liveNum);
+	if (_liveNum == 0)
+	{
+		return;
+	}
+
+	m_WorkSlot.resize(_liveNum);
+	m_SortKey.resize(_liveNum);
+	m_WorkKey.resize(_liveNum);
+
+	for (int i = 0; i < _liveNum; i++)
+	{
+		m_Order[i] = _pLiveSlot[i];
+		m_SortKey[i] = m_Key[_pLiveSlot[i]];
+	}
+
+	unsigned int* pSrcKey = &m_SortKey[0];
+	unsigned int* pDstKey = &m_WorkKey[0];
+	int* pSrcSlot = &m_Order[0];
+	int* pDstSlot = &m_WorkSlot[0];
+
+	// 下位の桁から安定に並べる.
+	for (int Shift = 0; Shift < 32; Shift += RADIX_BITS)
+	{
+		int Count[RADIX_BUCKET_NUM] = {};
+		for (int i = 0; i < _liveNum; i++)
+		{
+			Count[(pSrcKey[i] >> Shift) & (RADIX_BUCKET_NUM - 1)]++;
+		}
+
+		// 全てのキーがこの桁で同じなら並べ替えは要らない(深度の範囲が狭いと上位の桁はほぼ同じになる).
+		if (Count[(pSrcKey[0] >> Shift) & (RADIX_BUCKET_NUM - 1)] == _liveNum)
+		{
+			continue;
+		}
+
+		int Offset = 0;
+		for (int i = 0; i < RADIX_BUCKET_NUM; i++)
+		{
+			int Num = Count[i];
+			Count[i] = Offset;
+			Offset += Num;
+		}
+
+		for (int i = 0; i < _liveNum; i++)
+		{
+			int Index = Count[(pSrcKey[i] >> Shift) & (RADIX_BUCKET_NUM - 1)]++;
+			pDstKey[Index] = pSrcKey[i];
+			pDstSlot[Index] = pSrcSlot[i];
+		}
+
+		std::swap(pSrcKey, pDstKey);
+		std::swap(pSrcSlot, pDstSlot);
+	}
+
+	if (pSrcSlot != &m_Order[0])
+	{
+		std::copy(pSrcSlot, pSrcSlot + _liveNum, m_Order.begin());
+	}
+}
+
+bool SmokeDepthSorter::IncrementalSort(const int* _pLiveSlot, int _liveNum)
+{
+	for (int i = 0; i < _liveNum; i++)
+	{
+		m_LiveMark[_pLiveSlot[i]] = m_Frame;
+	}
+
+	// 前の順番から生きているスロットだけを残す.
+	m_WorkSlot.clear();
+	for (unsigned int i = 0; i < m_Order.size(); i++)
+	{
+		int Slot = m_Order[i];
+		if (m_LiveMark[Slot] == m_Frame)
+		{
+			m_WorkSlot.push_back(Slot);
+			m_OrderMark[Slot] = m_Frame;
+		}
+	}
+
+	// 前の順番に無いスロットが新しく出現したもの.
+	m_NewSlot.clear();
+	for (int i = 0; i < _liveNum; i++)
+	{
+		if (m_OrderMark[_pLiveSlot[i]] != m_Frame)
+		{
+			m_NewSlot.push_back(_pLiveSlot[i]);
+		}
+	}
+
+	// 残したスロットは前の順番のままなので, キーを並べた配列にして挿入ソートする.
+	int OldNum = static_cast<int>(m_WorkSlot.size());
+	int NewNum = static_cast<int>(m_NewSlot.size());
+	m_SortKey.resize(OldNum);
+	m_WorkKey.resize(NewNum);
+	for (int i = 0; i < OldNum; i++)
+	{
+		m_SortKey[i] = m_Key[m_WorkSlot[i]];
+	}
+	for (int i = 0; i < NewNum; i++)
+	{
+		m_WorkKey[i] = m_Key[m_NewSlot[i]];
+	}
+
+	int MaxMove = _liveNum * m_MaxMoveRate;
+	if (OldNum > 0 && !InsertionSort(&m_SortKey[0], &m_WorkSlot[0], OldNum, MaxMove))
+	{
+		return false;
+	}
+
+	if (NewNum > 0 && !InsertionSort(&m_WorkKey[0], &m_NewSlot[0], NewNum, MaxMove))
+	{
+		return false;
+	}
+
+	// 残したスロットと新しいスロットを併合する(同じキーなら残したスロットを先にする).
+	m_Order.resize(_liveNum);
+	int Old = 0;
+	int New = 0;
+	for (int i = 0; i < _liveNum; i++)
+	{
+		if (New == NewNum || (Old < OldNum && m_SortKey[Old] <= m_WorkKey[New]))
+		{
+			m_Order[i] = m_WorkSlot[Old++];
+		}
+		else
+		{
+			m_Order[i] = m_NewSlot[New++];
+		}
+	}
+
+	return true;
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+SmokeDepthSorter::KEY_FUNC SmokeDepthSorter::GetKeyFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &BuildKeyAVX2;
+	case CpuFeature::SIMD_SSE:	return &BuildKeySSE;
+	case CpuFeature::SIMD_NEON:	return &BuildKeyNEON;
+	default:					return &BuildKeyScalar;
+	}
+}
+
+bool SmokeDepthSorter::InsertionSort(unsigned int* _pKey, int* _pSlot, int _num, int _maxMove)
+{
+	int MoveNum = 0;
+	for (int i = 1; i < _num; i++)
+	{
+		unsigned int Key = _pKey[i];
+		int Slot = _pSlot[i];
+
+		int j = i;
+		while (j > 0 && _pKey[j - 1] > Key)
+		{
+			_pKey[j] = _pKey[j - 1];
+			_pSlot[j] = _pSlot[j - 1];
+			j--;
+		}
+		_pKey[j] = Key;
+		_pSlot[j] = Slot;
+
+		MoveNum += i - j;
+		if (MoveNum > _maxMove)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SmokeDepthSorter::BuildKeyScalar(
+	const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+	int _first, int _count, unsigned int* _pKey)
+{
+	for (int i = _first; i < _first + _count; i++)
+	{
+		float Depth = ((_pPosX[i] * _plane.A + _pPosY[i] * _plane.B) + _pPosZ[i] * _plane.C) + _plane.D;
+
+		// 正の数は符号ビットを立て, 負の数は全てのビットを反転すると, 符号なし整数の大小が値の大小になる.
+		// 奥ほど先に並べるので, さらに全てのビットを反転する.
+		unsigned int Bits;
+		memcpy(&Bits, &Depth, sizeof(Bits));
+		unsigned int Mask = (Bits & 0x80000000) != 0 ? 0xffffffff : 0x80000000;
+		_pKey[i] = ~(Bits ^ Mask);
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void SmokeDepthSorter::BuildKeySSE(
+	const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+	int _first, int _count, unsigned int* _pKey)
+{
+	const __m128 A = _mm_set1_ps(_plane.A);
+	const __m128 B = _mm_set1_ps(_plane.B);
+	const __m128 C = _mm_set1_ps(_plane.C);
+	const __m128 D = _mm_set1_ps(_plane.D);
+	const __m128i SignBit = _mm_set1_epi32(static_cast<int>(0x80000000));
+	const __m128i AllBits = _mm_set1_epi32(-1);
+
+	int i = _first;
+	for (; i + 4 <= _first + _count; i += 4)
+	{
+		__m128 Depth = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&_pPosX[i]), A), _mm_mul_ps(_mm_loadu_ps(&_pPosY[i]), B));
+		Depth = _mm_add_ps(_mm_add_ps(Depth, _mm_mul_ps(_mm_loadu_ps(&_pPosZ[i]), C)), D);
+
+		__m128i Bits = _mm_castps_si128(Depth);
+		__m128i Mask = _mm_or_si128(_mm_srai_epi32(Bits, 31), SignBit);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&_pKey[i]), _mm_xor_si128(_mm_xor_si128(Bits, Mask), AllBits));
+	}
+
+	BuildKeyScalar(_plane, _pPosX, _pPosY, _pPosZ, i, _first + _count - i, _pKey);
+}
+
+CPUFEATURE_TARGET_AVX2
+void SmokeDepthSorter::BuildKeyAVX2(
+	const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+	int _first, int _count, unsigned int* _pKey)
+{
+	const __m256 A = _mm256_set1_ps(_plane.A);
+	const __m256 B = _mm256_set1_ps(_plane.B);
+	const __m256 C = _mm256_set1_ps(_plane.C);
+	const __m256 D = _mm256_set1_ps(_plane.D);
+	const __m256i SignBit = _mm256_set1_epi32(static_cast<int>(0x80000000));
+	const __m256i AllBits = _mm256_set1_epi32(-1);
+
+	int i = _first;
+	for (; i + 8 <= _first + _count; i += 8)
+	{
+		__m256 Depth = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&_pPosX[i]), A), _mm256_mul_ps(_mm256_loadu_ps(&_pPosY[i]), B));
+		Depth = _mm256_add_ps(_mm256_add_ps(Depth, _mm256_mul_ps(_mm256_loadu_ps(&_pPosZ[i]), C)), D);
+
+		__m256i Bits = _mm256_castps_si256(Depth);
+		__m256i Mask = _mm256_or_si256(_mm256_srai_epi32(Bits, 31), SignBit);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&_pKey[i]), _mm256_xor_si256(_mm256_xor_si256(Bits, Mask), AllBits));
+	}
+
+	BuildKeySSE(_plane, _pPosX, _pPosY, _pPosZ, i, _first + _count - i, _pKey);
+}
+
+#else
+
+void SmokeDepthSorter::BuildKeySSE(
+	const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+	int _first, int _count, unsigned int* _pKey)
+{
+	BuildKeyScalar(_plane, _pPosX, _pPosY, _pPosZ, _first, _count, _pKey);
+}
+
+void SmokeDepthSorter::BuildKeyAVX2(
+	const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+	int _first, int _count, unsigned int* _pKey)
+{
+	BuildKeyScalar(_plane, _pPosX, _pPosY, _pPosZ, _first, _count, _pKey);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void SmokeDepthSorter::BuildKeyNEON(
+	const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+	int _first, int _count, unsigned int* _pKey)
+{
+	const float32x4_t A = vdupq_n_f32(_plane.A);
+	const float32x4_t B = vdupq_n_f32(_plane.B);
+	const float32x4_t C = vdupq_n_f32(_plane.C);
+	const float32x4_t D = vdupq_n_f32(_plane.D);
+	const uint32x4_t SignBit = vdupq_n_u32(0x80000000);
+
+	int i = _first;
+	for (; i + 4 <= _first + _count; i += 4)
+	{
+		float32x4_t Depth = vaddq_f32(vmulq_f32(vld1q_f32(&_pPosX[i]), A), vmulq_f32(vld1q_f32(&_pPosY[i]), B));
+		Depth = vaddq_f32(vaddq_f32(Depth, vmulq_f32(vld1q_f32(&_pPosZ[i]), C)), D);
+
+		uint32x4_t Bits = vreinterpretq_u32_f32(Depth);
+		uint32x4_t Mask = vorrq_u32(vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_f32(Depth), 31)), SignBit);
+		vst1q_u32(&_pKey[i], vmvnq_u32(veorq_u32(Bits, Mask)));
+	}
+
+	BuildKeyScalar(_plane, _pPosX, _pPosY, _pPosZ, i, _first + _count - i, _pKey);
+}
+
+#else
+
+void SmokeDepthSorter::BuildKeyNEON(
+	const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+	int _first, int _count, unsigned int* _pKey)
+{
+	BuildKeyScalar(_plane, _pPosX, _pPosY, _pPosZ, _first, _count, _pKey);
+}
+
+#endif // CPUFEATURE_NEON
+
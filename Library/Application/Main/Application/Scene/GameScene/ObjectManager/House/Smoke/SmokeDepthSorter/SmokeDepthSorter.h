@@ -0,0 +1,233 @@
+﻿/**
+ * @file	SmokeDepthSorter.h
+ * @brief	煙パーティクルの深度ソートクラス定義
+ * @author	morimoto
+ */
+#ifndef SMOKEDEPTHSORTER_H
+#define SMOKEDEPTHSORTER_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+/**
+ * 煙パーティクルの深度ソートクラス
+ *
+ * 半透明のパーティクルを奥から手前の順に描画するため, 生きているパーティクルをカメラの深度で並べる.
+ * パーティクルはスロット(パーティクル配列のインデックス)で表し, 深度から作るソートキーは全てのスロットに対して
+ * SIMDでまとめて求める. キーはfloatのビット列を符号なし整数の大小に合わせたもので, 奥ほど小さくなる.
+ *
+ * 全体ソートでは, キーを8bitずつの基数ソートで並べる.
+ * 差分ソートでは, 前のフレームの順番から消えたスロットを取り除いたものを挿入ソートで並べ直し,
+ * 新しく出現したスロットだけを別に並べてから併合する. カメラとパーティクルの動きは1フレームでは小さいので,
+ * 前の順番はほぼ並んでいて挿入ソートの移動は少ない. 移動が多すぎる(カメラが大きく動いたなど)場合は
+ * 途中でやめて基数ソートで並べる.
+ */
+class SmokeDepthSorter
+{
+public:
+	/**
+	 * コンストラクタ
+	 */
+	SmokeDepthSorter();
+
+	/**
+	 * デストラクタ
+	 */
+	~SmokeDepthSorter();
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 使用する命令セットを取得
+	 * @return 命令セット
+	 */
+	CpuFeature::SIMD_TYPE GetSimdType() const
+	{
+		return m_SimdType;
+	}
+
+	/**
+	 * 差分ソートを使うか設定
+	 * @param[in] _isIncremental 前のフレームの順番から並べ直すならtrue, 毎回全体を並べるならfalse
+	 */
+	void SetIncremental(bool _isIncremental)
+	{
+		m_IsIncremental = _isIncremental;
+	}
+
+	/**
+	 * 差分ソートを使うか
+	 * @return 前のフレームの順番から並べ直すならtrue
+	 */
+	bool IsIncremental() const
+	{
+		return m_IsIncremental;
+	}
+
+	/**
+	 * 深度を求める平面を設定
+	 *
+	 * 深度はx * _a + y * _b + z * _c + _dで求める(ビュー行列の3列目を渡すとビュー空間のzになる).
+	 * @param[in] _a xの係数
+	 * @param[in] _b yの係数
+	 * @param[in] _c zの係数
+	 * @param[in] _d 定数項
+	 */
+	void SetDepthPlane(float _a, float _b, float _c, float _d);
+
+	/**
+	 * 生きているスロットを奥から手前の順に並べる
+	 * @param[in] _pPosX スロットごとのx座標(_slotNum個)
+	 * @param[in] _pPosY スロットごとのy座標(_slotNum個)
+	 * @param[in] _pPosZ スロットごとのz座標(_slotNum個)
+	 * @param[in] _slotNum スロットの数
+	 * @param[in] _pLiveSlot 生きているスロットの配列
+	 * @param[in] _liveNum 生きているスロットの数
+	 */
+	void Sort(
+		const float* _pPosX, const float* _pPosY, const float* _pPosZ, int _slotNum,
+		const int* _pLiveSlot, int _liveNum);
+
+	/**
+	 * 前のフレームの順番を消す(次のSortは全体を並べる)
+	 */
+	void Reset();
+
+	/**
+	 * 並べたスロットの配列を取得
+	 * @return 奥から手前の順に並べたスロットの配列(Sortに渡した_liveNum個)
+	 */
+	const int* GetOrder() const
+	{
+		return m_Order.empty() ? nullptr : &m_Order[0];
+	}
+
+	/**
+	 * 直前のSortが差分ソートで並べられたか
+	 * @return 差分ソートで並べたならtrue, 基数ソートで並べたならfalse
+	 */
+	bool IsIncrementalSorted() const
+	{
+		return m_IsIncrementalSorted;
+	}
+
+private:
+	enum
+	{
+		RADIX_BITS = 8,						//!< 基数ソートの1回で並べるビット数.
+		RADIX_BUCKET_NUM = 1 << RADIX_BITS	//!< 基数ソートの1回のバケットの数.
+	};
+
+	/**
+	 * ソートキーを求める関数が参照する平面の構造体
+	 */
+	struct PLANE
+	{
+		float A;	//!< xの係数.
+		float B;	//!< yの係数.
+		float C;	//!< zの係数.
+		float D;	//!< 定数項.
+	};
+
+	/**
+	 * ソートキーを求める関数の型
+	 *
+	 * _first番目から_count個のスロットのキーを求める.
+	 */
+	typedef void(*KEY_FUNC)(
+		const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+		int _first, int _count, unsigned int* _pKey);
+
+	/**
+	 * 生きているスロットを全て基数ソートで並べる
+	 * @param[in] _pLiveSlot 生きているスロットの配列
+	 * @param[in] _liveNum 生きているスロットの数
+	 */
+	void RadixSort(const int* _pLiveSlot, int _liveNum);
+
+	/**
+	 * 前のフレームの順番から並べる
+	 * @param[in] _pLiveSlot 生きているスロットの配列
+	 * @param[in] _liveNum 生きているスロットの数
+	 * @return 並べられたらtrue 移動が多すぎてやめたらfalse
+	 */
+	bool IncrementalSort(const int* _pLiveSlot, int _liveNum);
+
+	/**
+	 * 命令セットに対応したソートキーを求める関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return ソートキーを求める関数
+	 */
+	static KEY_FUNC GetKeyFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * キーとスロットの配列をキーの順に挿入ソートで並べる
+	 * @param[in,out] _pKey 並べるキーの配列
+	 * @param[in,out] _pSlot キーと同じ順に並べるスロットの配列
+	 * @param[in] _num キーの数
+	 * @param[in] _maxMove 移動の上限
+	 * @return 並べられたらtrue 移動が上限を超えてやめたらfalse
+	 */
+	static bool InsertionSort(unsigned int* _pKey, int* _pSlot, int _num, int _maxMove);
+
+	/**
+	 * ソートキーを求める(スカラー版)
+	 */
+	static void BuildKeyScalar(
+		const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+		int _first, int _count, unsigned int* _pKey);
+
+	/**
+	 * ソートキーを求める(SSE2版)
+	 */
+	static void BuildKeySSE(
+		const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+		int _first, int _count, unsigned int* _pKey);
+
+	/**
+	 * ソートキーを求める(AVX2版)
+	 */
+	static void BuildKeyAVX2(
+		const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+		int _first, int _count, unsigned int* _pKey);
+
+	/**
+	 * ソートキーを求める(NEON版)
+	 */
+	static void BuildKeyNEON(
+		const PLANE& _plane, const float* _pPosX, const float* _pPosY, const float* _pPosZ,
+		int _first, int _count, unsigned int* _pKey);
+
+
+	static const int	m_MaxMoveRate;		//!< 差分ソートで許す移動の数(生きているスロットの数に対する倍率).
+
+	CpuFeature::SIMD_TYPE		m_SimdType;				//!< 使用する命令セット.
+	bool						m_IsIncremental;		//!< 差分ソートを使うか.
+	bool						m_IsIncrementalSorted;	//!< 直前のSortが差分ソートで並べられたか.
+	PLANE						m_Plane;				//!< 深度を求める平面.
+	int							m_Frame;				//!< Sortを呼んだ回数(スロットの印に使う).
+	std::vector<unsigned int>	m_Key;					//!< スロットごとのソートキー.
+	std::vector<int>			m_LiveMark;				//!< スロットが生きているフレームの印.
+	std::vector<int>			m_OrderMark;			//!< スロットが前の順番に残っているフレームの印.
+	std::vector<int>			m_Order;				//!< 奥から手前の順に並べたスロット.
+	std::vector<int>			m_NewSlot;				//!< 新しく出現したスロット.
+	std::vector<int>			m_WorkSlot;				//!< 並べ替えの作業用のスロット.
+	std::vector<unsigned int>	m_SortKey;				//!< 並べ替えるキー.
+	std::vector<unsigned int>	m_WorkKey;				//!< 並べ替えの作業用のキー(差分ソートでは新しいスロットのキー).
+
+};
+
+
+#endif // !SMOKEDEPTHSORTER_H
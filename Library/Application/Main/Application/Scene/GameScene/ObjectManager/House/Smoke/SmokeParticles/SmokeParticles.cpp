@@ -0,0 +1,560 @@
+﻿/**
+ * @file	SmokeParticles.cpp
+ * @brief	煙パーティクルの計算クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "SmokeParticles.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const unsigned int SmokeParticles::m_HashStep = 0x9e3779b9;
+const float SmokeParticles::m_RandomScale = 1.0f / 16777216.0f;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+SmokeParticles::SmokeParticles() :
+	m_SimdType(CpuFeature::GetSimdType()),
+	m_IsStateless(false),
+	m_Time(0.0f),
+	m_EmitRate(0.0f),
+	m_LifeFrame(0),
+	m_Capacity(0),
+	m_VelocityX(0.0f),
+	m_VelocityY(0.0f),
+	m_VelocityZ(0.0f),
+	m_AngleRange(0),
+	m_ScaleSpeed(0.0f),
+	m_AlphaSpeed(0.0f),
+	m_TotalLiveNum(0)
+{
+	SetVelocity(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+SmokeParticles::~SmokeParticles()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void SmokeParticles::SetEmission(float _emitRate, int _lifeFrame)
+{
+	m_EmitRate = std::max(_emitRate, 0.0f);
+	m_LifeFrame = std::max(_lifeFrame, 0);
+
+	// 寿命の間に出現する数が同時に生きている数の上限になる.
+	m_Capacity = static_cast<int>(std::ceil(m_EmitRate * static_cast<float>(m_LifeFrame)));
+
+	size_t Size = m_Emitter.size() * m_Capacity;
+	m_PosX.assign(Size, 0.0f);
+	m_PosY.assign(Size, 0.0f);
+	m_PosZ.assign(Size, 0.0f);
+	m_VelX.assign(Size, 0.0f);
+	m_VelY.assign(Size, 0.0f);
+	m_VelZ.assign(Size, 0.0f);
+	m_Scale.assign(Size, 0.0f);
+	m_Alpha.assign(Size, 0.0f);
+	m_Age.assign(Size, 0);
+
+	Clear();
+}
+
+void SmokeParticles::SetStateless(bool _isStateless)
+{
+	m_IsStateless = _isStateless;
+	Clear();
+}
+
+void SmokeParticles::SetVelocity(float _x, float _y, float _z, float _angleRange)
+{
+	m_VelocityX = _x;
+	m_VelocityY = _y;
+	m_VelocityZ = _z;
+	m_AngleRange = std::max(static_cast<int>(_angleRange), 0);
+
+	// 移動方向は1度刻みなので, ばらつきごとの速度をテーブルにしておく.
+	// 上向きを中心に, x, zは-90度, yは0度から±m_AngleRange度の範囲でばらつかせる.
+	static const float DegToRad = 3.14159265f / 180.0f;
+	int AngleStep = std::max(m_AngleRange * 2, 1);
+	m_VelXTable.resize(AngleStep);
+	m_VelYTable.resize(AngleStep);
+	m_VelZTable.resize(AngleStep);
+	for (int i = 0; i < AngleStep; i++)
+	{
+		float Deg = static_cast<float>(i - m_AngleRange);
+		m_VelXTable[i] = std::cos((Deg - 90.0f) * DegToRad) * m_VelocityX;
+		m_VelYTable[i] = std::fabs(std::sin(Deg * DegToRad) * m_VelocityY);
+		m_VelZTable[i] = std::cos((Deg - 90.0f) * DegToRad) * m_VelocityZ;
+	}
+}
+
+void SmokeParticles::SetGrowth(float _scaleSpeed, float _alphaSpeed)
+{
+	m_ScaleSpeed = _scaleSpeed;
+	m_AlphaSpeed = _alphaSpeed;
+}
+
+int SmokeParticles::AddEmitter(float _x, float _y, float _z, unsigned int _seed)
+{
+	EMITTER Emitter;
+	Emitter.PosX = _x;
+	Emitter.PosY = _y;
+	Emitter.PosZ = _z;
+	Emitter.BaseSeed = _seed;
+	Emitter.Seed = _seed != 0 ? _seed : 0x9e3779b9;	// xorshiftは0から抜け出せないので0以外の種にする.
+	Emitter.SpawnCarry = 0.0f;
+	Emitter.LiveBegin = 0;
+	Emitter.LiveNum = 0;
+	m_Emitter.push_back(Emitter);
+
+	size_t Size = m_Emitter.size() * m_Capacity;
+	m_PosX.resize(Size, 0.0f);
+	m_PosY.resize(Size, 0.0f);
+	m_PosZ.resize(Size, 0.0f);
+	m_VelX.resize(Size, 0.0f);
+	m_VelY.resize(Size, 0.0f);
+	m_VelZ.resize(Size, 0.0f);
+	m_Scale.resize(Size, 0.0f);
+	m_Alpha.resize(Size, 0.0f);
+	m_Age.resize(Size, 0);
+
+	return static_cast<int>(m_Emitter.size()) - 1;
+}
+
+void SmokeParticles::Update()
+{
+	m_Time += 1.0f;
+	if (m_IsStateless)
+	{
+		Evaluate(m_Time);
+		return;
+	}
+
+	m_TotalLiveNum = 0;
+	if (m_Capacity == 0)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_Emitter.size(); i++)
+	{
+		EMITTER* pEmitter = &m_Emitter[i];
+		int Base = static_cast<int>(i) * m_Capacity;
+
+		// 生きているパーティクルはリングの末尾で折り返すので, 2つの連続した範囲に分けて進める.
+		int FirstNum = std::min(pEmitter->LiveNum, m_Capacity - pEmitter->LiveBegin);
+		Advance(Base + pEmitter->LiveBegin, FirstNum);
+		Advance(Base, pEmitter->LiveNum - FirstNum);
+
+		// 寿命は全て同じなので, 古い方から寿命が尽きたものを取り除く.
+		while (pEmitter->LiveNum > 0 && m_Age[Base + pEmitter->LiveBegin] >= m_LifeFrame)
+		{
+			pEmitter->LiveBegin = pEmitter->LiveBegin + 1 < m_Capacity ? pEmitter->LiveBegin + 1 : 0;
+			pEmitter->LiveNum--;
+		}
+
+		// 出現率の端数は次のフレームに持ち越す.
+		pEmitter->SpawnCarry += m_EmitRate;
+		while (pEmitter->SpawnCarry >= 1.0f && pEmitter->LiveNum < m_Capacity)
+		{
+			int Index = pEmitter->LiveBegin + pEmitter->LiveNum;
+			Spawn(pEmitter, Base + (Index < m_Capacity ? Index : Index - m_Capacity));
+			pEmitter->LiveNum++;
+			pEmitter->SpawnCarry -= 1.0f;
+		}
+		pEmitter->SpawnCarry = std::min(pEmitter->SpawnCarry, 1.0f);
+
+		m_TotalLiveNum += pEmitter->LiveNum;
+	}
+}
+
+
+void SmokeParticles::Evaluate(float _time)
+{
+	m_TotalLiveNum = 0;
+	if (m_Capacity == 0)
+	{
+		return;
+	}
+
+	EVALUATE_FUNC pEvaluateFunc = GetEvaluateFunc(m_SimdType);
+
+	EVALUATE Param;
+	Param.Time = _time;
+	Param.InvEmitRate = 1.0f / m_EmitRate;
+	Param.AngleScale = static_cast<float>(m_VelXTable.size()) * m_RandomScale;
+	Param.MaxAngleIndex = static_cast<float>(m_VelXTable.size() - 1);
+	Param.pVelXTable = m_VelXTable.data();
+	Param.pVelYTable = m_VelYTable.data();
+	Param.pVelZTable = m_VelZTable.data();
+	Param.ScaleSpeed = m_ScaleSpeed;
+	Param.AlphaSpeed = m_AlphaSpeed;
+
+	// n番目のパーティクルはn / 出現率の時刻に出現するので, 出現してから寿命が尽きていない範囲が生きている.
+	// 0番目より前のパーティクルは無い(時刻0で煙が出始める).
+	int Last = static_cast<int>(std::floor(_time * m_EmitRate));
+	int First = std::max(static_cast<int>(std::floor((_time - static_cast<float>(m_LifeFrame)) * m_EmitRate)) + 1, 0);
+	int LiveNum = std::min(std::max(Last - First + 1, 0), m_Capacity);
+	First = Last - LiveNum + 1;
+
+	for (size_t i = 0; i < m_Emitter.size(); i++)
+	{
+		EMITTER* pEmitter = &m_Emitter[i];
+		int Base = static_cast<int>(i) * m_Capacity;
+
+		Param.EmitterX = pEmitter->PosX;
+		Param.EmitterY = pEmitter->PosY;
+		Param.EmitterZ = pEmitter->PosZ;
+		Param.Seed = pEmitter->BaseSeed;
+		pEvaluateFunc(
+			Param, First, LiveNum,
+			&m_PosX[Base], &m_PosY[Base], &m_PosZ[Base], &m_Scale[Base], &m_Alpha[Base]);
+
+		pEmitter->LiveBegin = 0;
+		pEmitter->LiveNum = LiveNum;
+		m_TotalLiveNum += LiveNum;
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void SmokeParticles::Clear()
+{
+	for (auto itr = m_Emitter.begin(); itr != m_Emitter.end(); itr++)
+	{
+		itr->SpawnCarry = 0.0f;
+		itr->LiveBegin = 0;
+		itr->LiveNum = 0;
+	}
+	m_TotalLiveNum = 0;
+}
+
+void SmokeParticles::Advance(int _begin, int _count)
+{
+	float* pPosX = m_PosX.data() + _begin;
+	float* pPosY = m_PosY.data() + _begin;
+	float* pPosZ = m_PosZ.data() + _begin;
+	const float* pVelX = m_VelX.data() + _begin;
+	const float* pVelY = m_VelY.data() + _begin;
+	const float* pVelZ = m_VelZ.data() + _begin;
+	float* pScale = m_Scale.data() + _begin;
+	float* pAlpha = m_Alpha.data() + _begin;
+	int* pAge = m_Age.data() + _begin;
+
+	for (int i = 0; i < _count; i++)
+	{
+		pPosX[i] += pVelX[i];
+		pPosY[i] += pVelY[i];
+		pPosZ[i] += pVelZ[i];
+		pScale[i] += m_ScaleSpeed;
+		pAlpha[i] -= m_AlphaSpeed;
+		pAge[i]++;
+	}
+}
+
+void SmokeParticles::Spawn(EMITTER* _pEmitter, int _index)
+{
+	unsigned int AngleStep = static_cast<unsigned int>(m_VelXTable.size());
+
+	m_PosX[_index] = _pEmitter->PosX;
+	m_PosY[_index] = _pEmitter->PosY;
+	m_PosZ[_index] = _pEmitter->PosZ;
+	m_VelX[_index] = m_VelXTable[NextRandom(_pEmitter) % AngleStep];
+	m_VelY[_index] = m_VelYTable[NextRandom(_pEmitter) % AngleStep];
+	m_VelZ[_index] = m_VelZTable[NextRandom(_pEmitter) % AngleStep];
+	m_Scale[_index] = 1.0f;
+	m_Alpha[_index] = 1.0f;
+	m_Age[_index] = 0;
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+unsigned int SmokeParticles::NextRandom(EMITTER* _pEmitter)
+{
+	unsigned int Seed = _pEmitter->Seed;
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	_pEmitter->Seed = Seed;
+
+	return Seed;
+}
+
+SmokeParticles::EVALUATE_FUNC SmokeParticles::GetEvaluateFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &EvaluateAVX2;
+	case CpuFeature::SIMD_SSE:	return &EvaluateSSE;
+	case CpuFeature::SIMD_NEON:	return &EvaluateNEON;
+	default:					return &EvaluateScalar;
+	}
+}
+
+void SmokeParticles::EvaluateScalar(
+	const EVALUATE& _param, int _first, int _count,
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha)
+{
+	for (int i = 0; i < _count; i++)
+	{
+		// パーティクルの番号を種に混ぜてxorshiftで攪拌し, 3つの乱数で速度テーブルを選ぶ.
+		int Number = _first + i;
+		unsigned int Seed = _param.Seed ^ (static_cast<unsigned int>(Number) * m_HashStep);
+		Seed ^= Seed << 13;
+		Seed ^= Seed >> 17;
+		Seed ^= Seed << 5;
+
+		int Index[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed ^= Seed << 13;
+			Seed ^= Seed >> 17;
+			Seed ^= Seed << 5;
+			float Random = static_cast<float>(static_cast<int>(Seed >> 8)) * _param.AngleScale;
+			Index[j] = static_cast<int>(std::min(Random, _param.MaxAngleIndex));
+		}
+
+		float Age = _param.Time - static_cast<float>(Number) * _param.InvEmitRate;
+		_pPosX[i] = _param.EmitterX + _param.pVelXTable[Index[0]] * Age;
+		_pPosY[i] = _param.EmitterY + _param.pVelYTable[Index[1]] * Age;
+		_pPosZ[i] = _param.EmitterZ + _param.pVelZTable[Index[2]] * Age;
+		_pScale[i] = 1.0f + _param.ScaleSpeed * Age;
+		_pAlpha[i] = 1.0f - _param.AlphaSpeed * Age;
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void SmokeParticles::EvaluateSSE(
+	const EVALUATE& _param, int _first, int _count,
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha)
+{
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128 Time = _mm_set1_ps(_param.Time);
+	const __m128 InvEmitRate = _mm_set1_ps(_param.InvEmitRate);
+	const __m128 AngleScale = _mm_set1_ps(_param.AngleScale);
+	const __m128 MaxAngleIndex = _mm_set1_ps(_param.MaxAngleIndex);
+	const __m128 EmitterX = _mm_set1_ps(_param.EmitterX);
+	const __m128 EmitterY = _mm_set1_ps(_param.EmitterY);
+	const __m128 EmitterZ = _mm_set1_ps(_param.EmitterZ);
+	const __m128 ScaleSpeed = _mm_set1_ps(_param.ScaleSpeed);
+	const __m128 AlphaSpeed = _mm_set1_ps(_param.AlphaSpeed);
+	const __m128i BaseSeed = _mm_set1_epi32(static_cast<int>(_param.Seed));
+	const __m128i LaneStep = _mm_set1_epi32(static_cast<int>(m_HashStep * 4));
+
+	// SSE2には32bitの乗算が無いので, 番号 * m_HashStepはレーンごとの初期値に足していく.
+	__m128i Number = _mm_add_epi32(_mm_set1_epi32(_first), _mm_set_epi32(3, 2, 1, 0));
+	__m128i Hash = _mm_set_epi32(
+		static_cast<int>(static_cast<unsigned int>(_first + 3) * m_HashStep),
+		static_cast<int>(static_cast<unsigned int>(_first + 2) * m_HashStep),
+		static_cast<int>(static_cast<unsigned int>(_first + 1) * m_HashStep),
+		static_cast<int>(static_cast<unsigned int>(_first) * m_HashStep));
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		__m128i Seed = _mm_xor_si128(BaseSeed, Hash);
+		Seed = _mm_xor_si128(Seed, _mm_slli_epi32(Seed, 13));
+		Seed = _mm_xor_si128(Seed, _mm_srli_epi32(Seed, 17));
+		Seed = _mm_xor_si128(Seed, _mm_slli_epi32(Seed, 5));
+
+		// SSE2にはgatherが無いので, インデックスを書き出して1つずつ読み込む.
+		int Index[3][4];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed = _mm_xor_si128(Seed, _mm_slli_epi32(Seed, 13));
+			Seed = _mm_xor_si128(Seed, _mm_srli_epi32(Seed, 17));
+			Seed = _mm_xor_si128(Seed, _mm_slli_epi32(Seed, 5));
+			__m128 Random = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(Seed, 8)), AngleScale);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index[j]), _mm_cvttps_epi32(_mm_min_ps(Random, MaxAngleIndex)));
+		}
+		__m128 VelX = _mm_set_ps(
+			_param.pVelXTable[Index[0][3]], _param.pVelXTable[Index[0][2]],
+			_param.pVelXTable[Index[0][1]], _param.pVelXTable[Index[0][0]]);
+		__m128 VelY = _mm_set_ps(
+			_param.pVelYTable[Index[1][3]], _param.pVelYTable[Index[1][2]],
+			_param.pVelYTable[Index[1][1]], _param.pVelYTable[Index[1][0]]);
+		__m128 VelZ = _mm_set_ps(
+			_param.pVelZTable[Index[2][3]], _param.pVelZTable[Index[2][2]],
+			_param.pVelZTable[Index[2][1]], _param.pVelZTable[Index[2][0]]);
+
+		__m128 Age = _mm_sub_ps(Time, _mm_mul_ps(_mm_cvtepi32_ps(Number), InvEmitRate));
+		_mm_storeu_ps(&_pPosX[i], _mm_add_ps(EmitterX, _mm_mul_ps(VelX, Age)));
+		_mm_storeu_ps(&_pPosY[i], _mm_add_ps(EmitterY, _mm_mul_ps(VelY, Age)));
+		_mm_storeu_ps(&_pPosZ[i], _mm_add_ps(EmitterZ, _mm_mul_ps(VelZ, Age)));
+		_mm_storeu_ps(&_pScale[i], _mm_add_ps(One, _mm_mul_ps(ScaleSpeed, Age)));
+		_mm_storeu_ps(&_pAlpha[i], _mm_sub_ps(One, _mm_mul_ps(AlphaSpeed, Age)));
+
+		Number = _mm_add_epi32(Number, _mm_set1_epi32(4));
+		Hash = _mm_add_epi32(Hash, LaneStep);
+	}
+
+	EvaluateScalar(
+		_param, _first + i, _count - i,
+		_pPosX + i, _pPosY + i, _pPosZ + i, _pScale + i, _pAlpha + i);
+}
+
+CPUFEATURE_TARGET_AVX2
+void SmokeParticles::EvaluateAVX2(
+	const EVALUATE& _param, int _first, int _count,
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha)
+{
+	const __m256 One = _mm256_set1_ps(1.0f);
+	const __m256 Time = _mm256_set1_ps(_param.Time);
+	const __m256 InvEmitRate = _mm256_set1_ps(_param.InvEmitRate);
+	const __m256 AngleScale = _mm256_set1_ps(_param.AngleScale);
+	const __m256 MaxAngleIndex = _mm256_set1_ps(_param.MaxAngleIndex);
+	const __m256 EmitterX = _mm256_set1_ps(_param.EmitterX);
+	const __m256 EmitterY = _mm256_set1_ps(_param.EmitterY);
+	const __m256 EmitterZ = _mm256_set1_ps(_param.EmitterZ);
+	const __m256 ScaleSpeed = _mm256_set1_ps(_param.ScaleSpeed);
+	const __m256 AlphaSpeed = _mm256_set1_ps(_param.AlphaSpeed);
+	const __m256i BaseSeed = _mm256_set1_epi32(static_cast<int>(_param.Seed));
+	const __m256i HashStep = _mm256_set1_epi32(static_cast<int>(m_HashStep));
+	const float* pVelTable[3] = { _param.pVelXTable, _param.pVelYTable, _param.pVelZTable };
+
+	__m256i Number = _mm256_add_epi32(_mm256_set1_epi32(_first), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256i Seed = _mm256_xor_si256(BaseSeed, _mm256_mullo_epi32(Number, HashStep));
+		Seed = _mm256_xor_si256(Seed, _mm256_slli_epi32(Seed, 13));
+		Seed = _mm256_xor_si256(Seed, _mm256_srli_epi32(Seed, 17));
+		Seed = _mm256_xor_si256(Seed, _mm256_slli_epi32(Seed, 5));
+
+		__m256 Vel[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed = _mm256_xor_si256(Seed, _mm256_slli_epi32(Seed, 13));
+			Seed = _mm256_xor_si256(Seed, _mm256_srli_epi32(Seed, 17));
+			Seed = _mm256_xor_si256(Seed, _mm256_slli_epi32(Seed, 5));
+			__m256 Random = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(Seed, 8)), AngleScale);
+			Vel[j] = _mm256_i32gather_ps(pVelTable[j], _mm256_cvttps_epi32(_mm256_min_ps(Random, MaxAngleIndex)), 4);
+		}
+
+		__m256 Age = _mm256_sub_ps(Time, _mm256_mul_ps(_mm256_cvtepi32_ps(Number), InvEmitRate));
+		_mm256_storeu_ps(&_pPosX[i], _mm256_add_ps(EmitterX, _mm256_mul_ps(Vel[0], Age)));
+		_mm256_storeu_ps(&_pPosY[i], _mm256_add_ps(EmitterY, _mm256_mul_ps(Vel[1], Age)));
+		_mm256_storeu_ps(&_pPosZ[i], _mm256_add_ps(EmitterZ, _mm256_mul_ps(Vel[2], Age)));
+		_mm256_storeu_ps(&_pScale[i], _mm256_add_ps(One, _mm256_mul_ps(ScaleSpeed, Age)));
+		_mm256_storeu_ps(&_pAlpha[i], _mm256_sub_ps(One, _mm256_mul_ps(AlphaSpeed, Age)));
+
+		Number = _mm256_add_epi32(Number, _mm256_set1_epi32(8));
+	}
+
+	EvaluateSSE(
+		_param, _first + i, _count - i,
+		_pPosX + i, _pPosY + i, _pPosZ + i, _pScale + i, _pAlpha + i);
+}
+
+#else
+
+void SmokeParticles::EvaluateSSE(
+	const EVALUATE& _param, int _first, int _count,
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha)
+{
+	EvaluateScalar(_param, _first, _count, _pPosX, _pPosY, _pPosZ, _pScale, _pAlpha);
+}
+
+void SmokeParticles::EvaluateAVX2(
+	const EVALUATE& _param, int _first, int _count,
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha)
+{
+	EvaluateScalar(_param, _first, _count, _pPosX, _pPosY, _pPosZ, _pScale, _pAlpha);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void SmokeParticles::EvaluateNEON(
+	const EVALUATE& _param, int _first, int _count,
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha)
+{
+	const float32x4_t One = vdupq_n_f32(1.0f);
+	const float32x4_t Time = vdupq_n_f32(_param.Time);
+	const float32x4_t InvEmitRate = vdupq_n_f32(_param.InvEmitRate);
+	const float32x4_t AngleScale = vdupq_n_f32(_param.AngleScale);
+	const float32x4_t MaxAngleIndex = vdupq_n_f32(_param.MaxAngleIndex);
+	const float32x4_t EmitterX = vdupq_n_f32(_param.EmitterX);
+	const float32x4_t EmitterY = vdupq_n_f32(_param.EmitterY);
+	const float32x4_t EmitterZ = vdupq_n_f32(_param.EmitterZ);
+	const float32x4_t ScaleSpeed = vdupq_n_f32(_param.ScaleSpeed);
+	const float32x4_t AlphaSpeed = vdupq_n_f32(_param.AlphaSpeed);
+	const uint32x4_t BaseSeed = vdupq_n_u32(_param.Seed);
+	const uint32x4_t HashStep = vdupq_n_u32(m_HashStep);
+	const float* pVelTable[3] = { _param.pVelXTable, _param.pVelYTable, _param.pVelZTable };
+
+	const int32_t LaneOffset[4] = { 0, 1, 2, 3 };
+	int32x4_t Number = vaddq_s32(vdupq_n_s32(_first), vld1q_s32(LaneOffset));
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		uint32x4_t Seed = veorq_u32(BaseSeed, vmulq_u32(vreinterpretq_u32_s32(Number), HashStep));
+		Seed = veorq_u32(Seed, vshlq_n_u32(Seed, 13));
+		Seed = veorq_u32(Seed, vshrq_n_u32(Seed, 17));
+		Seed = veorq_u32(Seed, vshlq_n_u32(Seed, 5));
+
+		// NEONにはgatherが無いので, インデックスを書き出して1つずつ読み込む.
+		float32x4_t Vel[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed = veorq_u32(Seed, vshlq_n_u32(Seed, 13));
+			Seed = veorq_u32(Seed, vshrq_n_u32(Seed, 17));
+			Seed = veorq_u32(Seed, vshlq_n_u32(Seed, 5));
+			float32x4_t Random = vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(vshrq_n_u32(Seed, 8))), AngleScale);
+
+			int32_t Index[4];
+			vst1q_s32(Index, vcvtq_s32_f32(vminq_f32(Random, MaxAngleIndex)));
+			float Lane[4] =
+			{
+				pVelTable[j][Index[0]], pVelTable[j][Index[1]], pVelTable[j][Index[2]], pVelTable[j][Index[3]]
+			};
+			Vel[j] = vld1q_f32(Lane);
+		}
+
+		float32x4_t Age = vsubq_f32(Time, vmulq_f32(vcvtq_f32_s32(Number), InvEmitRate));
+		vst1q_f32(&_pPosX[i], vaddq_f32(EmitterX, vmulq_f32(Vel[0], Age)));
+		vst1q_f32(&_pPosY[i], vaddq_f32(EmitterY, vmulq_f32(Vel[1], Age)));
+		vst1q_f32(&_pPosZ[i], vaddq_f32(EmitterZ, vmulq_f32(Vel[2], Age)));
+		vst1q_f32(&_pScale[i], vaddq_f32(One, vmulq_f32(ScaleSpeed, Age)));
+		vst1q_f32(&_pAlpha[i], vsubq_f32(One, vmulq_f32(AlphaSpeed, Age)));
+
+		Number = vaddq_s32(Number, vdupq_n_s32(4));
+	}
+
+	EvaluateScalar(
+		_param, _first + i, _count - i,
+		_pPosX + i, _pPosY + i, _pPosZ + i, _pScale + i, _pAlpha + i);
+}
+
+#else
+
+void SmokeParticles::EvaluateNEON(
+	const EVALUATE& _param, int _first, int _count,
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha)
+{
+	EvaluateScalar(_param, _first, _count, _pPosX, _pPosY, _pPosZ, _pScale, _pAlpha);
+}
+
+#endif // CPUFEATURE_NEON
+
@@ -0,0 +1,380 @@
+﻿/**
+ * @file	SmokeParticles.h
+ * @brief	煙パーティクルの計算クラス定義
+ * @author	morimoto
+ */
+#ifndef SMOKEPARTICLES_H
+#define SMOKEPARTICLES_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+/**
+ * 煙パーティクルの計算クラス
+ *
+ * エミッタごとにGetCapacity個の領域をリングバッファとして持ち, 出現させたパーティクルを末尾に追加して
+ * 寿命が尽きたものを先頭から取り除く. 全てのパーティクルの寿命は同じなので, 生きているパーティクルは
+ * 常にリングの中で連続して並び, 更新は生きているパーティクルにだけ行う.
+ *
+ * パーティクルは出現率(1フレームに出現する数)に合わせて出現し, 1つのエミッタが同時に持つ数の上限は
+ * 出現率と寿命から求める. 出現時の速度は, エミッタごとのxorshiftの乱数で決める.
+ *
+ * 状態を持たないモード(SetStateless)では, パーティクルを毎フレーム積分せずに, 時刻から閉じた式で求める.
+ * 出現率が一定なので, n番目のパーティクルの出現時刻はn / 出現率になり, 時刻から生きているパーティクルの
+ * 範囲と年齢が決まる. 速度はエミッタの乱数の種とnのハッシュで選ぶので, 座標, 拡大率, アルファ値は
+ * (時刻, 種, エミッタ)だけで決まり, 任意の時刻の煙をそのまま求められる(巻き戻しや再生に使える).
+ * 求めた結果はリングの先頭から古い順に書き込む.
+ */
+class SmokeParticles
+{
+public:
+	/**
+	 * コンストラクタ
+	 */
+	SmokeParticles();
+
+	/**
+	 * デストラクタ
+	 */
+	~SmokeParticles();
+
+	/**
+	 * 出現率と寿命を設定し, 全てのパーティクルを消す
+	 * @param[in] _emitRate 1フレームにエミッタごとに出現するパーティクルの数
+	 * @param[in] _lifeFrame パーティクルの寿命(フレーム数)
+	 */
+	void SetEmission(float _emitRate, int _lifeFrame);
+
+	/**
+	 * 出現時の速度を設定(次に出現するパーティクルから反映される)
+	 * @param[in] _x x方向の速さ
+	 * @param[in] _y y方向の速さ
+	 * @param[in] _z z方向の速さ
+	 * @param[in] _angleRange 移動方向のばらつき(度)
+	 */
+	void SetVelocity(float _x, float _y, float _z, float _angleRange);
+
+	/**
+	 * 1フレームごとの拡大率と透明度の変化量を設定
+	 * @param[in] _scaleSpeed 1フレームに増える拡大率
+	 * @param[in] _alphaSpeed 1フレームに減るアルファ値
+	 */
+	void SetGrowth(float _scaleSpeed, float _alphaSpeed);
+
+	/**
+	 * 状態を持たないモードを設定し, 全てのパーティクルを消す
+	 * @param[in] _isStateless 時刻から閉じた式で求めるならtrue, 毎フレーム積分するならfalse
+	 */
+	void SetStateless(bool _isStateless);
+
+	/**
+	 * 状態を持たないモードか
+	 * @return 時刻から閉じた式で求めるならtrue
+	 */
+	bool IsStateless() const
+	{
+		return m_IsStateless;
+	}
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 使用する命令セットを取得
+	 * @return 命令セット
+	 */
+	CpuFeature::SIMD_TYPE GetSimdType() const
+	{
+		return m_SimdType;
+	}
+
+	/**
+	 * 現在の時刻を設定(状態を持たないモードでは次のUpdateでこの時刻の次のフレームを求める)
+	 * @param[in] _time 時刻(フレーム数)
+	 */
+	void SetTime(float _time)
+	{
+		m_Time = _time;
+	}
+
+	/**
+	 * 現在の時刻を取得
+	 * @return 時刻(フレーム数)
+	 */
+	float GetTime() const
+	{
+		return m_Time;
+	}
+
+	/**
+	 * エミッタを追加
+	 * @param[in] _x エミッタのx座標
+	 * @param[in] _y エミッタのy座標
+	 * @param[in] _z エミッタのz座標
+	 * @param[in] _seed 乱数の種
+	 * @return 追加したエミッタのインデックス
+	 */
+	int AddEmitter(float _x, float _y, float _z, unsigned int _seed);
+
+	/**
+	 * 1フレーム分更新する
+	 *
+	 * 状態を持たないモードでは時刻を1進めてEvaluateする.
+	 */
+	void Update();
+
+	/**
+	 * 指定した時刻のパーティクルを閉じた式で求める
+	 *
+	 * 状態を持たないモードで使う. 現在の時刻は変更しない.
+	 * @param[in] _time 時刻(フレーム数)
+	 */
+	void Evaluate(float _time);
+
+	/**
+	 * エミッタの数を取得
+	 * @return エミッタの数
+	 */
+	int GetEmitterNum() const
+	{
+		return static_cast<int>(m_Emitter.size());
+	}
+
+	/**
+	 * エミッタごとのパーティクルの領域の大きさを取得
+	 * @return 1つのエミッタが同時に持てるパーティクルの数
+	 */
+	int GetCapacity() const
+	{
+		return m_Capacity;
+	}
+
+	/**
+	 * エミッタの一番古いパーティクルのリングの中の位置を取得
+	 *
+	 * エミッタの領域は_emitter * GetCapacity()から始まり, 生きているパーティクルはこの位置から
+	 * GetLiveNum個が(領域の末尾で先頭に折り返して)並ぶ.
+	 * @param[in] _emitter エミッタのインデックス
+	 * @return 一番古いパーティクルの位置(0～GetCapacity - 1)
+	 */
+	int GetLiveBegin(int _emitter) const
+	{
+		return m_Emitter[_emitter].LiveBegin;
+	}
+
+	/**
+	 * エミッタの生きているパーティクルの数を取得
+	 * @param[in] _emitter エミッタのインデックス
+	 * @return 生きているパーティクルの数
+	 */
+	int GetLiveNum(int _emitter) const
+	{
+		return m_Emitter[_emitter].LiveNum;
+	}
+
+	/**
+	 * 全てのエミッタの生きているパーティクルの数を取得
+	 * @return 生きているパーティクルの数
+	 */
+	int GetTotalLiveNum() const
+	{
+		return m_TotalLiveNum;
+	}
+
+	/**
+	 * パーティクルのx座標の配列を取得
+	 * @return x座標の配列(GetEmitterNum * GetCapacity個)
+	 */
+	const float* GetPosX() const
+	{
+		return m_PosX.data();
+	}
+
+	/**
+	 * パーティクルのy座標の配列を取得
+	 * @return y座標の配列(GetEmitterNum * GetCapacity個)
+	 */
+	const float* GetPosY() const
+	{
+		return m_PosY.data();
+	}
+
+	/**
+	 * パーティクルのz座標の配列を取得
+	 * @return z座標の配列(GetEmitterNum * GetCapacity個)
+	 */
+	const float* GetPosZ() const
+	{
+		return m_PosZ.data();
+	}
+
+	/**
+	 * パーティクルの拡大率の配列を取得
+	 * @return 拡大率の配列(GetEmitterNum * GetCapacity個)
+	 */
+	const float* GetScale() const
+	{
+		return m_Scale.data();
+	}
+
+	/**
+	 * パーティクルのアルファ値の配列を取得
+	 * @return アルファ値の配列(GetEmitterNum * GetCapacity個)
+	 */
+	const float* GetAlpha() const
+	{
+		return m_Alpha.data();
+	}
+
+private:
+	/**
+	 * エミッタの構造体
+	 */
+	struct EMITTER
+	{
+		float			PosX;		//!< エミッタのx座標.
+		float			PosY;		//!< エミッタのy座標.
+		float			PosZ;		//!< エミッタのz座標.
+		unsigned int	BaseSeed;	//!< 状態を持たないモードで速度を決めるハッシュの種.
+		unsigned int	Seed;		//!< 出現時の速度を決める乱数の状態.
+		float			SpawnCarry;	//!< 出現しきれなかったパーティクルの数(1未満の端数).
+		int				LiveBegin;	//!< 一番古いパーティクルのリングの中の位置.
+		int				LiveNum;	//!< 生きているパーティクルの数.
+	};
+
+	/**
+	 * 閉じた式で求める関数が参照するエミッタの構造体
+	 */
+	struct EVALUATE
+	{
+		float			EmitterX;		//!< エミッタのx座標.
+		float			EmitterY;		//!< エミッタのy座標.
+		float			EmitterZ;		//!< エミッタのz座標.
+		unsigned int	Seed;			//!< ハッシュの種.
+		float			Time;			//!< 求める時刻.
+		float			InvEmitRate;	//!< 出現率の逆数(パーティクルが出現する間隔).
+		float			AngleScale;		//!< 24bitの乱数を速度テーブルのインデックスにする倍率.
+		float			MaxAngleIndex;	//!< 速度テーブルのインデックスの最大値.
+		const float*	pVelXTable;		//!< x方向の速度テーブル.
+		const float*	pVelYTable;		//!< y方向の速度テーブル.
+		const float*	pVelZTable;		//!< z方向の速度テーブル.
+		float			ScaleSpeed;		//!< 1フレームに増える拡大率.
+		float			AlphaSpeed;		//!< 1フレームに減るアルファ値.
+	};
+
+	/**
+	 * 閉じた式で求める関数の型
+	 *
+	 * _first番目から_count個のパーティクルを求め, 出力の配列の先頭から書き込む.
+	 */
+	typedef void(*EVALUATE_FUNC)(
+		const EVALUATE& _param, int _first, int _count,
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha);
+
+	/**
+	 * 全てのパーティクルを消す
+	 */
+	void Clear();
+
+	/**
+	 * 生きているパーティクルを1フレーム分進める
+	 * @param[in] _begin 進めるパーティクルの先頭のインデックス
+	 * @param[in] _count 進めるパーティクルの数
+	 */
+	void Advance(int _begin, int _count);
+
+	/**
+	 * パーティクルを出現させる
+	 * @param[in] _pEmitter 出現させるエミッタ
+	 * @param[in] _index 出現させるパーティクルのインデックス
+	 */
+	void Spawn(EMITTER* _pEmitter, int _index);
+
+	/**
+	 * エミッタの乱数を進めて取得
+	 * @param[in] _pEmitter 乱数を進めるエミッタ
+	 * @return 乱数
+	 */
+	static unsigned int NextRandom(EMITTER* _pEmitter);
+
+	/**
+	 * 命令セットに対応した閉じた式で求める関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 閉じた式で求める関数
+	 */
+	static EVALUATE_FUNC GetEvaluateFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 閉じた式で求める(スカラー版)
+	 */
+	static void EvaluateScalar(
+		const EVALUATE& _param, int _first, int _count,
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha);
+
+	/**
+	 * 閉じた式で求める(SSE2版)
+	 */
+	static void EvaluateSSE(
+		const EVALUATE& _param, int _first, int _count,
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha);
+
+	/**
+	 * 閉じた式で求める(AVX2版)
+	 */
+	static void EvaluateAVX2(
+		const EVALUATE& _param, int _first, int _count,
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha);
+
+	/**
+	 * 閉じた式で求める(NEON版)
+	 */
+	static void EvaluateNEON(
+		const EVALUATE& _param, int _first, int _count,
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pScale, float* _pAlpha);
+
+
+	static const unsigned int	m_HashStep;		//!< パーティクルの番号からハッシュを作る倍率(黄金比).
+	static const float			m_RandomScale;	//!< 24bitの乱数を0～1にする倍率.
+
+	CpuFeature::SIMD_TYPE	m_SimdType;		//!< 使用する命令セット.
+	bool					m_IsStateless;	//!< 時刻から閉じた式で求めるか.
+	float					m_Time;			//!< 現在の時刻(フレーム数).
+	float					m_EmitRate;		//!< 1フレームにエミッタごとに出現するパーティクルの数.
+	int						m_LifeFrame;	//!< パーティクルの寿命(フレーム数).
+	int						m_Capacity;		//!< エミッタごとのパーティクルの領域の大きさ.
+	float					m_VelocityX;	//!< 出現時のx方向の速さ.
+	float					m_VelocityY;	//!< 出現時のy方向の速さ.
+	float					m_VelocityZ;	//!< 出現時のz方向の速さ.
+	int						m_AngleRange;	//!< 移動方向のばらつき(度).
+	float					m_ScaleSpeed;	//!< 1フレームに増える拡大率.
+	float					m_AlphaSpeed;	//!< 1フレームに減るアルファ値.
+	std::vector<float>		m_VelXTable;	//!< 移動方向のばらつきごとのx方向の速度.
+	std::vector<float>		m_VelYTable;	//!< 移動方向のばらつきごとのy方向の速度.
+	std::vector<float>		m_VelZTable;	//!< 移動方向のばらつきごとのz方向の速度.
+	int						m_TotalLiveNum;	//!< 全てのエミッタの生きているパーティクルの数.
+	std::vector<EMITTER>	m_Emitter;		//!< エミッタの配列.
+	std::vector<float>		m_PosX;			//!< パーティクルのx座標.
+	std::vector<float>		m_PosY;			//!< パーティクルのy座標.
+	std::vector<float>		m_PosZ;			//!< パーティクルのz座標.
+	std::vector<float>		m_VelX;			//!< パーティクルのx方向の速度.
+	std::vector<float>		m_VelY;			//!< パーティクルのy方向の速度.
+	std::vector<float>		m_VelZ;			//!< パーティクルのz方向の速度.
+	std::vector<float>		m_Scale;		//!< パーティクルの拡大率.
+	std::vector<float>		m_Alpha;		//!< パーティクルのアルファ値.
+	std::vector<int>		m_Age;			//!< パーティクルが出現してからのフレーム数.
+
+};
+
+
+#endif // !SMOKEPARTICLES_H
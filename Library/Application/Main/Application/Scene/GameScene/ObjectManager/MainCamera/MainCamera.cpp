@@ -45,6 +45,8 @@ MainCamera::MainCamera() :
 	m_IsCameraControl(false),
 	m_pConstantBuffer(nullptr)
 {
+	D3DXMatrixIdentity(&m_ReflectView);
+	D3DXMatrixIdentity(&m_ReflectProj);
 }
 
 MainCamera::~MainCamera()
@@ -331,6 +333,10 @@ bool MainCamera::WriteConstantBuffer()
 		ConstantBuffer.ReflectView = m_pCamera->GetViewMatrix();
 		ConstantBuffer.ReflectProj = m_pCamera->GetProjectionMatrix();
 
+		// 反射マップのカリングで使うので転置する前に保持しておく.
+		m_ReflectView = ConstantBuffer.ReflectView;
+		m_ReflectProj = ConstantBuffer.ReflectProj;
+
 		D3DXMatrixTranspose(&ConstantBuffer.View, &ConstantBuffer.View);
 		D3DXMatrixTranspose(&ConstantBuffer.Proj, &ConstantBuffer.Proj);
 		D3DXMatrixTranspose(&ConstantBuffer.ReflectView, &ConstantBuffer.ReflectView);
@@ -68,6 +68,24 @@ public:
 		return m_pCamera->GetProjectionMatrix();
 	}
 
+	/**
+	 * 反射カメラのビュー行列を取得
+	 * @return 水面で反転させたカメラのビュー行列
+	 */
+	inline D3DXMATRIX GetReflectViewMatrix()
+	{
+		return m_ReflectView;
+	}
+
+	/**
+	 * 反射カメラの射影行列を取得
+	 * @return 反射カメラの射影行列
+	 */
+	inline D3DXMATRIX GetReflectProjectionMatrix()
+	{
+		return m_ReflectProj;
+	}
+
 	/**
 	 * カメラ座標を取得
 	 * @return カメラ座標
@@ -214,6 +232,8 @@ private:
 	float							m_ZoomSpeed;		//!< カメラのズーム速度.
 	float							m_CameraLength;		//!< カメラの注視点の距離.
 	bool							m_IsCameraControl;	//!< カメラを操作したか.
+	D3DXMATRIX						m_ReflectView;		//!< 反射カメラのビュー行列.
+	D3DXMATRIX						m_ReflectProj;		//!< 反射カメラのプロジェクション行列.
 
 
 	//--------------------カメラの定数バッファ--------------------
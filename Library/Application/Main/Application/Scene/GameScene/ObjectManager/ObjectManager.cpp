@@ -9,39 +9,72 @@
 //----------------------------------------------------------------------
 #include "ObjectManager.h"
 
+#include "Debugger\Debugger.h"
+#include "Main\ThreadPool\ThreadPool.h"
 #include "FieldManager\FieldManager.h"
+#include "FieldManager\TerrainHeightField\TerrainHeightField.h"
 #include "MainCamera\MainCamera.h"
 #include "MainLight\MainLight.h"
 #include "House\House.h"
+#include "House\Smoke\Smoke.h"
 #include "MiniMap\MiniMap.h"
 #include "Rain\Rain.h"
+#include "Rain\RainOcclusionMap\RainOcclusionMap.h"
 #include "Water\Water.h"
+#include "Water\WaveSimulator\WaveImpulseQueue\WaveImpulseQueue.h"
+#include "Water\WaveSimulator\WaveObstacleMask\WaveObstacleMask.h"
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const char* ObjectManager::m_pTerrainCacheFileName = "Resource\\Model\\Terrain.heightfield";
+const float ObjectManager::m_TerrainCellSize = 1.0f;
 
 
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-ObjectManager::ObjectManager()
+ObjectManager::ObjectManager() :
+	m_pThreadPool(new ThreadPool()),
+	m_pWaveImpulseQueue(new WaveImpulseQueue()),
+	m_pWaveObstacleMask(new WaveObstacleMask()),
+	m_pRainOcclusionMap(new RainOcclusionMap()),
+	m_pTerrainHeightField(new TerrainHeightField())
 {
-	m_pObjectManagers.push_back(new FieldManager());
+	m_pObjectManagers.push_back(new FieldManager(m_pTerrainHeightField));
+	CreateTerrainHeightField();
+
+	// 山などの地形に落ちた雨粒は地面で着水する.
+	m_pRainOcclusionMap->SetTerrain(m_pTerrainHeightField);
+
+	// 家は地形の高さに合わせて置く.
+	auto GroundPos = [this](float _x, float _z)
+	{
+		return D3DXVECTOR3(_x, m_pTerrainHeightField->GetHeight(_x, _z), _z);
+	};
 
 	MainCamera* pCamera = new MainCamera();
 	m_pObjects.push_back(pCamera);
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(0, 0, 45), 0));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(20, 0, 45), 0));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(40, 0, 45), 0));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(0, 0, 95), 180));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(20, 0, 95), 180));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(40, 0, 95), 180));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(80, 0, 80), -90));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(80, 0, 60), -90));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(80, 0, 40), -90));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(80, 0, 20), -90));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(-100, 0, 20), 90));
-	m_pObjects.push_back(new House(pCamera, D3DXVECTOR3(-100, 0, 40), 90));
+
+	// 家は煙のエミッタを追加するだけで, 全ての家の煙は1つの煙オブジェクトがまとめて描画する.
+	Smoke* pSmoke = new Smoke(pCamera, m_pThreadPool);
+	m_pObjects.push_back(new House(GroundPos(0, 45), 0, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(20, 45), 0, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(40, 45), 0, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(0, 95), 180, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(20, 95), 180, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(40, 95), 180, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(80, 80), -90, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(80, 60), -90, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(80, 40), -90, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(80, 20), -90, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(-100, 20), 90, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(new House(GroundPos(-100, 40), 90, m_pWaveObstacleMask, m_pRainOcclusionMap, pSmoke));
+	m_pObjects.push_back(pSmoke);
 	m_pObjects.push_back(new MiniMap());
-	m_pObjects.push_back(new Water());
-	m_pObjects.push_back(new Rain(pCamera));
+	m_pObjects.push_back(new Water(pCamera, m_pThreadPool, m_pWaveImpulseQueue, m_pWaveObstacleMask));
+	m_pObjects.push_back(new Rain(pCamera, m_pThreadPool, m_pWaveImpulseQueue, m_pRainOcclusionMap));
 	m_pObjects.push_back(new MainLight(pCamera));
 }
 
@@ -56,6 +89,12 @@ ObjectManager::~ObjectManager()
 	{
 		delete (*itr);
 	}
+
+	delete m_pTerrainHeightField;
+	delete m_pRainOcclusionMap;
+	delete m_pWaveObstacleMask;
+	delete m_pWaveImpulseQueue;
+	delete m_pThreadPool;
 }
 
 
@@ -64,6 +103,11 @@ ObjectManager::~ObjectManager()
 //----------------------------------------------------------------------
 bool ObjectManager::Initialize()
 {
+	if (!m_pThreadPool->Initialize())
+	{
+		return false;
+	}
+
 	for (auto itr = m_pObjectManagers.begin(); itr != m_pObjectManagers.end(); itr++)
 	{
 		if (!(*itr)->Initialize())
@@ -96,5 +140,27 @@ void ObjectManager::Finalize()
 	{
 		(*itr)->Finalize();
 	}
+
+	m_pThreadPool->Finalize();
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void ObjectManager::CreateTerrainHeightField()
+{
+	ThreadPool BuildThreadPool;
+	BuildThreadPool.Initialize();
+	m_pTerrainHeightField->SetThreadPool(&BuildThreadPool);
+
+	// 失敗しても高さマップは全て基準の高さ(0)を返すので, 平らな地面として続行する.
+	if (!m_pTerrainHeightField->Build(m_pTerrainCacheFileName, m_TerrainCellSize))
+	{
+		OutputErrorLog("地形の高さマップの作成に失敗しました");
+	}
+
+	m_pTerrainHeightField->SetThreadPool(nullptr);
+	BuildThreadPool.Finalize();
 }
 
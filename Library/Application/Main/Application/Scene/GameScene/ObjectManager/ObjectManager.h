@@ -15,6 +15,13 @@
 #include "ObjectManagerBase\ObjectBase\ObjectBase.h"
 
 
+class ThreadPool;
+class WaveImpulseQueue;
+class WaveObstacleMask;
+class RainOcclusionMap;
+class TerrainHeightField;
+
+
 /**
  * オブジェクト管理クラス
  */
@@ -44,7 +51,24 @@ public:
 
 
 private:
+	/**
+	 * 地形の高さマップを作成
+	 *
+	 * 家の配置に使うので, ワーカースレッドを起動する前のコンストラクタから呼び出す.
+	 * 作成の間だけ専用のスレッドプールで並列に処理する.
+	 */
+	void CreateTerrainHeightField();
+
+
+	static const char*	m_pTerrainCacheFileName;	//!< 地形の高さマップのキャッシュファイル名.
+	static const float	m_TerrainCellSize;			//!< 地形の高さマップの格子点の間隔.
+
 	std::vector<Lib::ObjectManagerBase*> m_pObjectManagers;	//!< オブジェクト管理クラス.
+	ThreadPool*							m_pThreadPool;		//!< オブジェクト間で共有するスレッドプール.
+	WaveImpulseQueue*					m_pWaveImpulseQueue;	//!< オブジェクト間で共有する波の追加要求キュー.
+	WaveObstacleMask*					m_pWaveObstacleMask;	//!< オブジェクト間で共有する波の障害物マスク.
+	RainOcclusionMap*					m_pRainOcclusionMap;	//!< オブジェクト間で共有する雨の遮蔽高さマップ.
+	TerrainHeightField*					m_pTerrainHeightField;	//!< オブジェクト間で共有する地形の高さマップ.
 
 };
 
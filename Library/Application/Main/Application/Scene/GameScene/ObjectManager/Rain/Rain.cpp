@@ -9,6 +9,8 @@
 //----------------------------------------------------------------------
 #include "Rain.h"
 
+#include <chrono>
+
 #include "Debugger\Debugger.h"
 #include "TaskManager\TaskBase\DrawTask\DrawTask.h"
 #include "TaskManager\TaskBase\UpdateTask\UpdateTask.h"
@@ -19,6 +21,11 @@
 #include "DirectX11\TextureManager\Dx11TextureManager.h"
 #include "DirectX11\TextureManager\ITexture\Dx11ITexture.h"
 #include "DirectX11\Font\Dx11Font.h"
+#include "..\Water\WaveSimulator\WaveImpulseQueue\WaveImpulseQueue.h"
+#include "RainParticles\RainParticles.h"
+#include "RainInstancePacker\RainInstancePacker.h"
+#include "RainOcclusionMap\RainOcclusionMap.h"
+#include "Main\ThreadPool\ThreadPool.h"
 
 
 //----------------------------------------------------------------------
@@ -26,41 +33,45 @@
 //----------------------------------------------------------------------
 const D3DXVECTOR2 Rain::m_DefaultSize = D3DXVECTOR2(0.2f, 0.2f);
 const D3DXVECTOR2 Rain::m_DefaultFontPos = D3DXVECTOR2(25, 80);
+const D3DXVECTOR2 Rain::m_CountFontPos = D3DXVECTOR2(25, 200);
+const D3DXVECTOR2 Rain::m_VolumeFontPos = D3DXVECTOR2(25, 230);
 const D3DXVECTOR2 Rain::m_DefaultFontSize = D3DXVECTOR2(16, 32);
 const D3DXCOLOR Rain::m_DefaultFontColor = 0xffffffff;
 const D3DXVECTOR2 Rain::m_XRange = D3DXVECTOR2(-55, 180);
 const D3DXVECTOR2 Rain::m_YRange = D3DXVECTOR2(80, 100);
 const D3DXVECTOR2 Rain::m_ZRange = D3DXVECTOR2(-55, 180);
+const float Rain::m_FollowHalfSize = 50.0f;
+const D3DXVECTOR2 Rain::m_OcclusionMapPos = D3DXVECTOR2(-180, 180);
+const float Rain::m_OcclusionMapSize = 360.0f;
+const int Rain::m_OcclusionCellNum = 360;
+const float Rain::m_WaveRadius = 1.0f;
+const float Rain::m_WaveStrength = 0.01f;
+const int Rain::m_WaveImpulseMax = 512;
+const int Rain::m_Capacity[CAPACITY_NUM] = { 2000, 20000, 200000, 1000000 };
 
 
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-Rain::Rain(MainCamera* _pCamera) : 
+Rain::Rain(
+	MainCamera* _pCamera, ThreadPool* _pThreadPool,
+	WaveImpulseQueue* _pWaveImpulseQueue, RainOcclusionMap* _pOcclusionMap) : 
 	m_pCamera(_pCamera),
+	m_pThreadPool(_pThreadPool),
+	m_pWaveImpulseQueue(_pWaveImpulseQueue),
+	m_pOcclusionMap(_pOcclusionMap),
 	m_pFont(nullptr),
 	m_TextureIndex(Lib::Dx11::TextureManager::m_InvalidIndex),
 	m_SoundIndex(Lib::Dx11::TextureManager::m_InvalidIndex),
+	m_pInstanceBuffer(nullptr),
+	m_pRainParticles(nullptr),
+	m_pInstancePacker(nullptr),
 	m_RandDevice(),
-	m_MersenneTwister(m_RandDevice()),
+	m_CapacityIndex(0),
+	m_UpdateTime(0.0f),
+	m_IsFollowCamera(false),
 	m_IsActive(false)
 {
-	for (int i = 0; i < RAIN_NUM; i++)
-	{
-		int Data = m_MersenneTwister();
-		m_RainData[i].Pos.x = m_XRange.x + (Data % static_cast<int>(m_XRange.y));
-		Data = m_MersenneTwister();
-		m_RainData[i].Pos.y = m_YRange.x + (Data % static_cast<int>(m_YRange.y));
-		Data = m_MersenneTwister();
-		m_RainData[i].Pos.z = m_ZRange.x + (Data % static_cast<int>(m_ZRange.y));
-
-		m_RainData[i].Scale.x = 1.0f;
-		m_RainData[i].Scale.y = 45.0f;
-		m_RainData[i].Scale.z = 1.0f;
-
-		m_RainData[i].IsFall = true;
-		m_RainData[i].Time = 0;
-	}
 }
 
 Rain::~Rain()
@@ -74,7 +85,9 @@ Rain::~Rain()
 bool Rain::Initialize()
 {
 	if (!CreateTask())			return false;
+	if (!CreateParticles())		return false;
 	if (!CreateVertexBuffer())	return false;
+	if (!CreateInstanceBuffer()) return false;
 	if (!WriteInstanceBuffer()) return false;
 	if (!CreateShader())		return false;
 	if (!CreateVertexLayout())	return false;
@@ -94,7 +107,9 @@ void Rain::Finalize()
 	ReleaseState();
 	ReleaseVertexLayout();
 	ReleaseShader();
+	ReleaseInstanceBuffer();
 	ReleaseVertexBuffer();
+	ReleaseParticles();
 	ReleaseTask();
 }
 
@@ -119,53 +134,28 @@ void Rain::Update()
 		}
 	}
 
+	if (m_pKeyState[DIK_N] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		ChangeCapacity((m_CapacityIndex + 1) % CAPACITY_NUM);
+	}
+
+	if (m_pKeyState[DIK_M] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		// 範囲を切り替えると, 外に出た雨粒は次の更新で新しい範囲に回り込む.
+		m_IsFollowCamera = !m_IsFollowCamera;
+	}
+
 	if (m_IsActive == true)
 	{
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
 		// 雨粒の処理.
-		for (int i = 0; i < RAIN_NUM; i++)
-		{
-			if (m_RainData[i].IsFall == true)
-			{
-				// 落下中であれば座標移動を行う.
-				m_RainData[i].Pos.y -= 3.5f;
-
-				if (m_RainData[i].Pos.y <= -4.5f)
-				{
-					m_RainData[i].Pos.y = 0.1f;
-					m_RainData[i].IsFall = false;
-
-					m_RainData[i].Scale.x = 2.0f;
-					m_RainData[i].Scale.y = 2.0f;
-					m_RainData[i].Scale.z = 2.0f;
-				}
-			}
-			else
-			{
-				// 落下中でなければ波紋を出す.
-				m_RainData[i].Time++;
-
-				m_RainData[i].Scale.x += 0.3f;
-				m_RainData[i].Scale.y += 0.3f;
-				m_RainData[i].Scale.z += 0.3f;
-
-				if (m_RainData[i].Time == 32)
-				{
-					m_RainData[i].Time = 0;
-					m_RainData[i].IsFall = true;
-
-					m_RainData[i].Scale.x = 1.0f;
-					m_RainData[i].Scale.y = 45.0f;
-					m_RainData[i].Scale.z = 1.0f;
-
-					int Data = m_MersenneTwister();
-					m_RainData[i].Pos.x = m_XRange.x + (Data % static_cast<int>(m_XRange.y));
-					Data = m_MersenneTwister();
-					m_RainData[i].Pos.y = m_YRange.x + (Data % static_cast<int>(m_YRange.y));
-					Data = m_MersenneTwister();
-					m_RainData[i].Pos.z = m_ZRange.x + (Data % static_cast<int>(m_ZRange.y));
-				}
-			}
-		}
+		UpdateSpawnArea();
+		m_pRainParticles->Update();
+		PushWaveImpulse();
+
+		std::chrono::steady_clock::time_point EndTime = std::chrono::steady_clock::now();
+		m_UpdateTime = static_cast<float>(std::chrono::duration<double, std::milli>(EndTime - StartTime).count());
 
 		WriteInstanceBuffer();
 	}
@@ -193,10 +183,18 @@ void Rain::Draw()
 		ID3D11ShaderResourceView* pResource = SINGLETON_INSTANCE(Lib::Dx11::TextureManager)->GetTexture(m_TextureIndex)->Get();
 		pContext->PSSetShaderResources(0, 1, &pResource);
 
-		pContext->DrawInstanced(VERTEX_NUM, RAIN_NUM, 0, 0);
+		pContext->DrawInstanced(VERTEX_NUM, m_pRainParticles->GetCapacity(), 0, 0);
 
 		m_pFont->Draw(&m_DefaultFontPos, "Rain  : ON");
 		m_pFont->Draw(&D3DXVECTOR2(m_DefaultFontPos.x + 320, m_DefaultFontPos.y), "R key");
+
+		char CountStr[64];
+		sprintf_s(CountStr, 64, "Drops : %d %.2fms", m_pRainParticles->GetCapacity(), m_UpdateTime);
+		m_pFont->Draw(&m_CountFontPos, CountStr);
+		m_pFont->Draw(&D3DXVECTOR2(m_CountFontPos.x + 320, m_CountFontPos.y), "N key");
+
+		m_pFont->Draw(&m_VolumeFontPos, m_IsFollowCamera ? "Volume: Camera" : "Volume: World");
+		m_pFont->Draw(&D3DXVECTOR2(m_VolumeFontPos.x + 320, m_VolumeFontPos.y), "M key");
 	}
 	else
 	{
@@ -271,32 +269,24 @@ bool Rain::CreateVertexBuffer()
 		return false;
 	}
 
+	return true;
+}
 
-	for (int i = 0; i < RAIN_NUM; i++)
-	{
-		D3DXMatrixIdentity(&m_pInstanceData[i].Mat);
-		D3DXMatrixTranspose(&m_pInstanceData[i].Mat, &m_pInstanceData[i].Mat);
-		m_pInstanceData[i].Pos = D3DXVECTOR4(0, 0, 0, 0);
-	}
-
-	// インスタンスバッファの設定.
+bool Rain::CreateInstanceBuffer()
+{
+	// 内容は毎フレームWriteInstanceBufferで書き込むので初期データは渡さない.
 	D3D11_BUFFER_DESC InstanceBufferDesc;
 	ZeroMemory(&InstanceBufferDesc, sizeof(D3D11_BUFFER_DESC));
-	InstanceBufferDesc.ByteWidth = sizeof(INSTANCE_DATA) * RAIN_NUM;
+	InstanceBufferDesc.ByteWidth = sizeof(INSTANCE_DATA) * m_pRainParticles->GetCapacity();
 	InstanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
 	InstanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	InstanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	InstanceBufferDesc.MiscFlags = 0;
 	InstanceBufferDesc.StructureByteStride = 0;
 
-	// インスタンスバッファに格納するデータの設定.
-	D3D11_SUBRESOURCE_DATA InstanceResourceData;
-	ZeroMemory(&InstanceResourceData, sizeof(D3D11_SUBRESOURCE_DATA));
-	InstanceResourceData.pSysMem = m_pInstanceData;
-
 	if (FAILED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDevice()->CreateBuffer(
 		&InstanceBufferDesc,
-		&InstanceResourceData,
+		nullptr,
 		&m_pInstanceBuffer)))
 	{
 		OutputErrorLog("インスタンスバッファの生成に失敗しました");
@@ -336,11 +326,7 @@ bool Rain::CreateVertexLayout()
 		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 0,  D3D11_INPUT_PER_VERTEX_DATA,   0 },
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,		 0, 12, D3D11_INPUT_PER_VERTEX_DATA,   0 },
 		{ "COLOR",	  0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 20, D3D11_INPUT_PER_VERTEX_DATA,   0 },
-		{ "MATRIX",   0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0,  D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "MATRIX",   1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "MATRIX",   2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "MATRIX",   3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-		{ "POS",	  0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+		{ "POS",	  0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0,  D3D11_INPUT_PER_INSTANCE_DATA, 1 }
 	};
 
 	if (FAILED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDevice()->CreateInputLayout(
@@ -440,6 +426,28 @@ bool Rain::CreateFontObject()
 	return true;
 }
 
+bool Rain::CreateParticles()
+{
+	// 家などは生成時に遮蔽物を追加しているので, ここで一度だけ格子にする(地形の山まで全て覆う大きさ).
+	m_pOcclusionMap->SetWorldArea(m_OcclusionMapPos.x, m_OcclusionMapPos.y, m_OcclusionMapSize, m_OcclusionMapSize);
+	if (!m_pOcclusionMap->Build(m_OcclusionCellNum, m_OcclusionCellNum))
+	{
+		OutputErrorLog("遮蔽高さマップの生成に失敗しました");
+		return false;
+	}
+
+	m_pRainParticles = new RainParticles();
+	m_pRainParticles->SetThreadPool(m_pThreadPool);
+	m_pRainParticles->SetOcclusionMap(m_pOcclusionMap);
+	UpdateSpawnArea();
+	m_pRainParticles->SetCapacity(m_Capacity[m_CapacityIndex], m_RandDevice());
+
+	m_pInstancePacker = new RainInstancePacker();
+	m_pInstancePacker->SetThreadPool(m_pThreadPool);
+
+	return true;
+}
+
 void Rain::ReleaseTask()
 {
 	SINGLETON_INSTANCE(Lib::Draw3DTaskManager)->RemoveTask(m_pDrawTask);
@@ -451,10 +459,14 @@ void Rain::ReleaseTask()
 
 void Rain::ReleaseVertexBuffer()
 {
-	SafeRelease(m_pInstanceBuffer);
 	SafeRelease(m_pVertexBuffer);
 }
 
+void Rain::ReleaseInstanceBuffer()
+{
+	SafeRelease(m_pInstanceBuffer);
+}
+
 void Rain::ReleaseShader()
 {
 	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleasePixelShader(m_PixelShaderIndex);
@@ -490,6 +502,13 @@ void Rain::ReleaseFontObject()
 	delete m_pFont;
 }
 
+void Rain::ReleaseParticles()
+{
+	SafeDelete(m_pInstancePacker);
+	SafeDelete(m_pRainParticles);
+	m_pOcclusionMap->Release();
+}
+
 bool Rain::WriteInstanceBuffer()
 {
 	D3D11_MAPPED_SUBRESOURCE MappedResource;
@@ -500,32 +519,8 @@ bool Rain::WriteInstanceBuffer()
 		0,
 		&MappedResource)))
 	{
-		INSTANCE_DATA* pInstanceData = reinterpret_cast<INSTANCE_DATA*>(MappedResource.pData);
-
-		for (int i = 0; i < RAIN_NUM; i++)
-		{
-			D3DXMATRIX MatWorld, MatTranslate, MatRotate;
-			D3DXMatrixIdentity(&MatWorld);
-
-			if (m_RainData[i].IsFall == true)
-			{
-				m_pCamera->GetBillBoardRotation(&m_RainData[i].Pos, &MatRotate);
-				D3DXMatrixScaling(&MatWorld, m_RainData[i].Scale.x, m_RainData[i].Scale.y, m_RainData[i].Scale.z);
-				D3DXMatrixMultiply(&MatWorld, &MatWorld, &MatRotate);
-			}
-			else
-			{
-				D3DXMatrixScaling(&MatWorld, m_RainData[i].Scale.x, m_RainData[i].Scale.y, m_RainData[i].Scale.z);
-				D3DXMatrixRotationX(&MatRotate, static_cast<float>(D3DXToRadian(-90)));	// 上を向くように反転.
-				D3DXMatrixMultiply(&MatWorld, &MatWorld, &MatRotate);
-			}
-
-			D3DXMatrixTranslation(&MatTranslate, m_RainData[i].Pos.x, m_RainData[i].Pos.y, m_RainData[i].Pos.z);
-			D3DXMatrixMultiply(&MatWorld, &MatWorld, &MatTranslate);
-			D3DXMatrixTranspose(&pInstanceData[i].Mat, &MatWorld);
-
-			pInstanceData[i].Pos = D3DXVECTOR4(m_RainData[i].Pos, 0);
-		}
+		// 要素ごとの配列からMapしたバッファへ直接詰めて書き込む.
+		m_pInstancePacker->Pack(m_pRainParticles, reinterpret_cast<float*>(MappedResource.pData));
 
 		SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->Unmap(m_pInstanceBuffer, 0);
 
@@ -535,3 +530,67 @@ bool Rain::WriteInstanceBuffer()
 	return false;
 }
 
+bool Rain::ChangeCapacity(int _capacityIndex)
+{
+	m_CapacityIndex = _capacityIndex;
+	m_pRainParticles->SetCapacity(m_Capacity[m_CapacityIndex], m_RandDevice());
+
+	// 雨粒の数に合わせてインスタンスバッファを作り直す.
+	ReleaseInstanceBuffer();
+	if (!CreateInstanceBuffer())
+	{
+		return false;
+	}
+
+	return WriteInstanceBuffer();
+}
+
+void Rain::PushWaveImpulse()
+{
+	int LandedNum = m_pRainParticles->GetLandedNum();
+	if (LandedNum <= 0)
+	{
+		return;
+	}
+
+	const float* pLandedX = m_pRainParticles->GetLandedX();
+	const float* pLandedZ = m_pRainParticles->GetLandedZ();
+
+	if (LandedNum <= m_WaveImpulseMax)
+	{
+		m_pWaveImpulseQueue->PushWorldDrop(pLandedX, pLandedZ, LandedNum, m_WaveRadius, m_WaveStrength);
+		return;
+	}
+
+	// 雨粒が多いと波の計算が追いつかないので, 着水した雨粒から等間隔に選んで追加する.
+	m_ImpulseX.resize(m_WaveImpulseMax);
+	m_ImpulseZ.resize(m_WaveImpulseMax);
+	for (int i = 0; i < m_WaveImpulseMax; i++)
+	{
+		int Index = static_cast<int>(static_cast<long long>(i) * LandedNum / m_WaveImpulseMax);
+		m_ImpulseX[i] = pLandedX[Index];
+		m_ImpulseZ[i] = pLandedZ[Index];
+	}
+
+	m_pWaveImpulseQueue->PushWorldDrop(&m_ImpulseX[0], &m_ImpulseZ[0], m_WaveImpulseMax, m_WaveRadius, m_WaveStrength);
+}
+
+void Rain::UpdateSpawnArea()
+{
+	if (m_IsFollowCamera)
+	{
+		// 高さは水面に落ちるまでの長さが変わらないようにワールドの範囲のままにする.
+		D3DXVECTOR3 CameraPos = m_pCamera->GetPos();
+		m_pRainParticles->SetSpawnArea(
+			CameraPos.x - m_FollowHalfSize, CameraPos.x + m_FollowHalfSize,
+			m_YRange.x, m_YRange.x + m_YRange.y,
+			CameraPos.z - m_FollowHalfSize, CameraPos.z + m_FollowHalfSize);
+	}
+	else
+	{
+		m_pRainParticles->SetSpawnArea(
+			m_XRange.x, m_XRange.x + m_XRange.y,
+			m_YRange.x, m_YRange.x + m_YRange.y,
+			m_ZRange.x, m_ZRange.x + m_ZRange.y);
+	}
+}
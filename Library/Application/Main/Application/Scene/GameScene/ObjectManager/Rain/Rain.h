@@ -12,6 +12,7 @@
 #include <D3DX11.h>
 #include <D3DX10.h>
 #include <random>
+#include <vector>
 
 #include "ObjectManagerBase\ObjectBase\ObjectBase.h"
 #include "TaskManager\TaskBase\UpdateTask\UpdateTask.h"
@@ -20,6 +21,12 @@
 #include "..\MainCamera\MainCamera.h"
 
 
+class ThreadPool;
+class WaveImpulseQueue;
+class RainParticles;
+class RainInstancePacker;
+class RainOcclusionMap;
+
 namespace Lib
 {
 	namespace Dx11
@@ -38,8 +45,13 @@ public:
 	/**
 	 * コンストラクタ
 	 * @param[in] _pCamera カメラオブジェクト
+	 * @param[in] _pThreadPool 雨粒を並列に更新するためのスレッドプール
+	 * @param[in] _pWaveImpulseQueue 着水した雨粒の波を追加するキュー
+	 * @param[in] _pOcclusionMap 雨粒が着水する高さを求める遮蔽高さマップ(家が屋根を追加した後に作成する)
 	 */
-	Rain(MainCamera* _pCamera);
+	Rain(
+		MainCamera* _pCamera, ThreadPool* _pThreadPool,
+		WaveImpulseQueue* _pWaveImpulseQueue, RainOcclusionMap* _pOcclusionMap);
 
 	/**
 	 * デストラクタ
@@ -70,8 +82,8 @@ public:
 private:
 	enum
 	{
-		VERTEX_NUM = 4,	//!< 頂点数.
-		RAIN_NUM = 2000	//!< 雨の数.
+		VERTEX_NUM = 4,		//!< 頂点数.
+		CAPACITY_NUM = 4	//!< 切り替えられる雨粒の数の種類.
 	};
 
 
@@ -87,32 +99,32 @@ private:
 
 	/**
 	 * インスタンス別データ構造体
+	 *
+	 * 向きと大きさはRain.fxの頂点シェーダーで求める.
 	 */
 	struct INSTANCE_DATA
 	{
-		D3DXMATRIX Mat;		//!< 変換行列.
-		D3DXVECTOR4 Pos;	//!< 位置座標.
-	};
-
-	/**
-	 * 雨のデータ構造体
-	 */
-	struct RAIN_DATA
-	{
-		D3DXVECTOR3 Pos;	//!< 雨の座標.
-		D3DXVECTOR3	Scale;	//!< 雨のスケーリング値.
-		bool IsFall;		//!< 雨が落下中か.
-		int Time;			//!< 落下してからの時間.
+		D3DXVECTOR4 Pos;	//!< 位置座標(wは落下中なら0, 波紋なら波紋の大きさ).
 	};
 
 
 	static const D3DXVECTOR2	m_DefaultSize;		//!< デフォルトの頂点サイズ.
 	static const D3DXVECTOR2	m_DefaultFontPos;	//!< フォントの座標.
+	static const D3DXVECTOR2	m_CountFontPos;		//!< 雨粒の数を表示するフォントの座標.
+	static const D3DXVECTOR2	m_VolumeFontPos;	//!< 雨粒の範囲を表示するフォントの座標.
 	static const D3DXVECTOR2	m_DefaultFontSize;	//!< フォントのサイズ.
 	static const D3DXCOLOR		m_DefaultFontColor;	//!< フォントのカラー値.
 	static const D3DXVECTOR2	m_XRange;			//!< xの範囲.
 	static const D3DXVECTOR2	m_YRange;			//!< yの範囲.
 	static const D3DXVECTOR2	m_ZRange;			//!< zの範囲.
+	static const float			m_FollowHalfSize;	//!< カメラに追従する範囲のx, zの半分の大きさ.
+	static const D3DXVECTOR2	m_OcclusionMapPos;	//!< 遮蔽高さマップの左端のxと上端のz.
+	static const float			m_OcclusionMapSize;	//!< 遮蔽高さマップのx, zの大きさ.
+	static const int			m_OcclusionCellNum;	//!< 遮蔽高さマップのx, zのセルの数.
+	static const float			m_WaveRadius;		//!< 着水時に追加する波の半径.
+	static const float			m_WaveStrength;		//!< 着水時に波の中心を下げる速さ(静止時の高さより下は余裕が少ないので小さめ).
+	static const int			m_WaveImpulseMax;	//!< 1フレームに追加する波の最大数.
+	static const int			m_Capacity[CAPACITY_NUM];	//!< Nキーで切り替える雨粒の数.
 
 
 	//----------------------------------------------------------------------
@@ -131,6 +143,12 @@ private:
 	 */
 	bool CreateVertexBuffer();
 
+	/**
+	 * インスタンスバッファの生成(雨粒の数の分だけ確保する)
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool CreateInstanceBuffer();
+
 	/**
 	 * シェーダーの初期化
 	 * @return 初期化に成功したらtrue 失敗したらfalse
@@ -167,6 +185,12 @@ private:
 	 */
 	bool CreateFontObject();
 
+	/**
+	 * 雨粒パーティクルの初期化
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool CreateParticles();
+
 
 	//----------------------------------------------------------------------
 	// 解放処理
@@ -182,6 +206,11 @@ private:
 	 */
 	void ReleaseVertexBuffer();
 
+	/**
+	 * インスタンスバッファの解放
+	 */
+	void ReleaseInstanceBuffer();
+
 	/**
 	 * シェーダーの解放
 	 */
@@ -212,6 +241,11 @@ private:
 	 */
 	void ReleaseFontObject();
 
+	/**
+	 * 雨粒パーティクルの解放
+	 */
+	void ReleaseParticles();
+
 
 	//----------------------------------------------------------------------
 	// その他処理
@@ -223,6 +257,23 @@ private:
 	 */
 	bool WriteInstanceBuffer();
 
+	/**
+	 * 雨粒の数を切り替える
+	 * @param[in] _capacityIndex m_Capacityのインデックス
+	 * @return 成功したらtrue 失敗したらfalse
+	 */
+	bool ChangeCapacity(int _capacityIndex);
+
+	/**
+	 * 着水した雨粒の波を追加する
+	 */
+	void PushWaveImpulse();
+
+	/**
+	 * 雨粒が出現する範囲を設定する(カメラに追従する場合はカメラを中心にする)
+	 */
+	void UpdateSpawnArea();
+
 
 
 	//--------------------タスクオブジェクト--------------------
@@ -232,6 +283,9 @@ private:
 
 	//--------------------その他オブジェクト--------------------
 	MainCamera*					m_pCamera;					//!< カメラオブジェクト.
+	ThreadPool*					m_pThreadPool;				//!< 雨粒を並列に更新するためのスレッドプール.
+	WaveImpulseQueue*			m_pWaveImpulseQueue;		//!< 着水した雨粒の波を追加するキュー.
+	RainOcclusionMap*			m_pOcclusionMap;			//!< 雨粒が着水する高さを求める遮蔽高さマップ.
 	Lib::Dx11::Font*					m_pFont;					//!< フォント描画オブジェクト.
 
 	
@@ -246,13 +300,17 @@ private:
 	ID3D11DepthStencilState*	m_pDepthStencilState;		//!< 深度ステンシルステート.
 	ID3D11BlendState*			m_pBlendState;				//!< ブレンドステート.
 	VERTEX						m_pVertexData[VERTEX_NUM];	//!< 頂点データ.
-	INSTANCE_DATA				m_pInstanceData[RAIN_NUM];	//!< インスタンスデータ.
 
 
 	//--------------------パーティクル処理のデータ--------------------
-	RAIN_DATA					m_RainData[RAIN_NUM];		//!< 雨粒のデータ配列.
+	RainParticles*				m_pRainParticles;			//!< 雨粒パーティクルの計算オブジェクト.
+	RainInstancePacker*			m_pInstancePacker;			//!< インスタンスデータの書き込みオブジェクト.
 	std::random_device			m_RandDevice;				//!< 乱数生成デバイス.
-	std::mt19937				m_MersenneTwister;			//!< 乱数生成オブジェクト.
+	std::vector<float>			m_ImpulseX;					//!< 追加する波のx座標.
+	std::vector<float>			m_ImpulseZ;					//!< 追加する波のz座標.
+	int							m_CapacityIndex;			//!< 現在の雨粒の数のインデックス.
+	float						m_UpdateTime;				//!< 雨粒の更新にかかった時間(ミリ秒).
+	bool						m_IsFollowCamera;			//!< 雨粒の範囲をカメラに追従させるか.
 	bool						m_IsActive;					//!< このオブジェクトの活動状態.
 
 
@@ -0,0 +1,225 @@
+﻿/**
+ * @file	RainInstancePacker.cpp
+ * @brief	雨粒のインスタンスデータ書き込みクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "RainInstancePacker.h"
+
+#include <algorithm>
+
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Rain\RainParticles\RainParticles.h"
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+RainInstancePacker::RainInstancePacker() :
+	m_pThreadPool(nullptr),
+	m_SimdType(CpuFeature::GetSimdType())
+{
+}
+
+RainInstancePacker::~RainInstancePacker()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void RainInstancePacker::Pack(const RainParticles* _pRainParticles, float* _pDest)
+{
+	PACK_FUNC pPackFunc = GetPackFunc(m_SimdType);
+	const float* pPosX = _pRainParticles->GetPosX();
+	const float* pPosY = _pRainParticles->GetPosY();
+	const float* pPosZ = _pRainParticles->GetPosZ();
+	const float* pRippleTime = _pRainParticles->GetRippleTime();
+	int Capacity = _pRainParticles->GetCapacity();
+	int ChunkNum = (Capacity + RainParticles::CHUNK_SIZE - 1) / RainParticles::CHUNK_SIZE;
+
+	auto PackChunk = [&](int _chunk)
+	{
+		int Begin = _chunk * RainParticles::CHUNK_SIZE;
+		int Count = std::min(static_cast<int>(RainParticles::CHUNK_SIZE), Capacity - Begin);
+
+		pPackFunc(pPosX + Begin, pPosY + Begin, pPosZ + Begin, pRippleTime + Begin, Count, _pDest + Begin * 4);
+	};
+
+	if (m_pThreadPool != nullptr && ChunkNum > 1)
+	{
+		m_pThreadPool->ParallelFor(ChunkNum, PackChunk);
+	}
+	else
+	{
+		for (int i = 0; i < ChunkNum; i++)
+		{
+			PackChunk(i);
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+RainInstancePacker::PACK_FUNC RainInstancePacker::GetPackFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &PackAVX2;
+	case CpuFeature::SIMD_SSE:	return &PackSSE;
+	case CpuFeature::SIMD_NEON:	return &PackNEON;
+	default:					return &PackScalar;
+	}
+}
+
+void RainInstancePacker::PackScalar(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+	float* _pDest)
+{
+	// 波紋の大きさ(RainParticles::GetRippleScale)のStart + Speed * (t - 1)を(Start - Speed) + Speed * tに展開して求める.
+	const float RippleOffset = RainParticles::m_RippleStartScale - RainParticles::m_RippleScaleSpeed;
+
+	for (int i = 0; i < _count; i++)
+	{
+		float RippleTime = _pRippleTime[i];
+		float Scale = RippleOffset + RainParticles::m_RippleScaleSpeed * RippleTime;
+
+		_pDest[i * 4 + 0] = _pPosX[i];
+		_pDest[i * 4 + 1] = _pPosY[i];
+		_pDest[i * 4 + 2] = _pPosZ[i];
+		_pDest[i * 4 + 3] = RippleTime != 0.0f ? Scale : 0.0f;
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void RainInstancePacker::PackSSE(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+	float* _pDest)
+{
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 RippleOffset = _mm_set1_ps(RainParticles::m_RippleStartScale - RainParticles::m_RippleScaleSpeed);
+	const __m128 RippleSpeed = _mm_set1_ps(RainParticles::m_RippleScaleSpeed);
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		__m128 X = _mm_loadu_ps(&_pPosX[i]);
+		__m128 Y = _mm_loadu_ps(&_pPosY[i]);
+		__m128 Z = _mm_loadu_ps(&_pPosZ[i]);
+		__m128 RippleTime = _mm_loadu_ps(&_pRippleTime[i]);
+		__m128 Scale = _mm_add_ps(RippleOffset, _mm_mul_ps(RippleSpeed, RippleTime));
+		__m128 W = _mm_andnot_ps(_mm_cmpeq_ps(RippleTime, Zero), Scale);
+
+		// 4つの配列を転置して雨粒ごとのxyzwに並べ替える.
+		_MM_TRANSPOSE4_PS(X, Y, Z, W);
+		_mm_storeu_ps(&_pDest[i * 4 + 0], X);
+		_mm_storeu_ps(&_pDest[i * 4 + 4], Y);
+		_mm_storeu_ps(&_pDest[i * 4 + 8], Z);
+		_mm_storeu_ps(&_pDest[i * 4 + 12], W);
+	}
+
+	PackScalar(_pPosX + i, _pPosY + i, _pPosZ + i, _pRippleTime + i, _count - i, _pDest + i * 4);
+}
+
+CPUFEATURE_TARGET_AVX2
+void RainInstancePacker::PackAVX2(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+	float* _pDest)
+{
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 RippleOffset = _mm256_set1_ps(RainParticles::m_RippleStartScale - RainParticles::m_RippleScaleSpeed);
+	const __m256 RippleSpeed = _mm256_set1_ps(RainParticles::m_RippleScaleSpeed);
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256 X = _mm256_loadu_ps(&_pPosX[i]);
+		__m256 Y = _mm256_loadu_ps(&_pPosY[i]);
+		__m256 Z = _mm256_loadu_ps(&_pPosZ[i]);
+		__m256 RippleTime = _mm256_loadu_ps(&_pRippleTime[i]);
+		__m256 Scale = _mm256_add_ps(RippleOffset, _mm256_mul_ps(RippleSpeed, RippleTime));
+		__m256 W = _mm256_andnot_ps(_mm256_cmp_ps(RippleTime, Zero, _CMP_EQ_OQ), Scale);
+
+		// 128bitの各レーン内で転置すると, 下位に雨粒0～3, 上位に雨粒4～7が並ぶ.
+		__m256 XY0 = _mm256_unpacklo_ps(X, Y);
+		__m256 XY1 = _mm256_unpackhi_ps(X, Y);
+		__m256 ZW0 = _mm256_unpacklo_ps(Z, W);
+		__m256 ZW1 = _mm256_unpackhi_ps(Z, W);
+		__m256 Drop0 = _mm256_shuffle_ps(XY0, ZW0, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 Drop1 = _mm256_shuffle_ps(XY0, ZW0, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 Drop2 = _mm256_shuffle_ps(XY1, ZW1, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 Drop3 = _mm256_shuffle_ps(XY1, ZW1, _MM_SHUFFLE(3, 2, 3, 2));
+
+		_mm256_storeu_ps(&_pDest[i * 4 + 0], _mm256_permute2f128_ps(Drop0, Drop1, 0x20));
+		_mm256_storeu_ps(&_pDest[i * 4 + 8], _mm256_permute2f128_ps(Drop2, Drop3, 0x20));
+		_mm256_storeu_ps(&_pDest[i * 4 + 16], _mm256_permute2f128_ps(Drop0, Drop1, 0x31));
+		_mm256_storeu_ps(&_pDest[i * 4 + 24], _mm256_permute2f128_ps(Drop2, Drop3, 0x31));
+	}
+
+	PackSSE(_pPosX + i, _pPosY + i, _pPosZ + i, _pRippleTime + i, _count - i, _pDest + i * 4);
+}
+
+#else
+
+void RainInstancePacker::PackSSE(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+	float* _pDest)
+{
+	PackScalar(_pPosX, _pPosY, _pPosZ, _pRippleTime, _count, _pDest);
+}
+
+void RainInstancePacker::PackAVX2(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+	float* _pDest)
+{
+	PackScalar(_pPosX, _pPosY, _pPosZ, _pRippleTime, _count, _pDest);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void RainInstancePacker::PackNEON(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+	float* _pDest)
+{
+	const float32x4_t Zero = vdupq_n_f32(0.0f);
+	const float32x4_t RippleOffset = vdupq_n_f32(RainParticles::m_RippleStartScale - RainParticles::m_RippleScaleSpeed);
+	const float32x4_t RippleSpeed = vdupq_n_f32(RainParticles::m_RippleScaleSpeed);
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		float32x4_t RippleTime = vld1q_f32(&_pRippleTime[i]);
+		float32x4_t Scale = vaddq_f32(RippleOffset, vmulq_f32(RippleSpeed, RippleTime));
+
+		// vst4qは4つのレジスタを要素ごとに交互に並べて書き込む.
+		float32x4x4_t Drop;
+		Drop.val[0] = vld1q_f32(&_pPosX[i]);
+		Drop.val[1] = vld1q_f32(&_pPosY[i]);
+		Drop.val[2] = vld1q_f32(&_pPosZ[i]);
+		Drop.val[3] = vbslq_f32(vceqq_f32(RippleTime, Zero), Zero, Scale);
+		vst4q_f32(&_pDest[i * 4], Drop);
+	}
+
+	PackScalar(_pPosX + i, _pPosY + i, _pPosZ + i, _pRippleTime + i, _count - i, _pDest + i * 4);
+}
+
+#else
+
+void RainInstancePacker::PackNEON(
+	const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+	float* _pDest)
+{
+	PackScalar(_pPosX, _pPosY, _pPosZ, _pRippleTime, _count, _pDest);
+}
+
+#endif // CPUFEATURE_NEON
@@ -0,0 +1,116 @@
+﻿/**
+ * @file	RainInstancePacker.h
+ * @brief	雨粒のインスタンスデータ書き込みクラス定義
+ * @author	morimoto
+ */
+#ifndef RAININSTANCEPACKER_H
+#define RAININSTANCEPACKER_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+class ThreadPool;
+class RainParticles;
+
+
+/**
+ * 雨粒のインスタンスデータ書き込みクラス
+ *
+ * RainParticlesの要素ごとの配列を, 雨粒1つにつきfloat4(16byte)のインスタンスデータに詰めて書き込む.
+ * xyzは雨粒の座標で, wは落下中なら0, 波紋を出していれば波紋の大きさになる.
+ * 落下中のビルボードと波紋の向きはRain.fxの頂点シェーダーで求めるので, CPUでは行列を計算しない.
+ *
+ * 書き込み先はMapしたインスタンスバッファをそのまま渡せるように, 先頭から順番に書き込むだけにしている.
+ */
+class RainInstancePacker
+{
+public:
+	/**
+	 * コンストラクタ
+	 */
+	RainInstancePacker();
+
+	/**
+	 * デストラクタ
+	 */
+	~RainInstancePacker();
+
+	/**
+	 * 並列に書き込むためのスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元のスレッドだけで書き込む)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool)
+	{
+		m_pThreadPool = _pThreadPool;
+	}
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 全ての雨粒のインスタンスデータを書き込む
+	 * @param[in] _pRainParticles 雨粒パーティクル
+	 * @param[out] _pDest 書き込み先(GetCapacity() * 4要素)
+	 */
+	void Pack(const RainParticles* _pRainParticles, float* _pDest);
+
+private:
+	/**
+	 * 書き込み関数の型
+	 */
+	typedef void(*PACK_FUNC)(
+		const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+		float* _pDest);
+
+	/**
+	 * 命令セットに対応した書き込み関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 書き込み関数
+	 */
+	static PACK_FUNC GetPackFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * インスタンスデータの書き込み(スカラー版)
+	 */
+	static void PackScalar(
+		const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+		float* _pDest);
+
+	/**
+	 * インスタンスデータの書き込み(SSE2版)
+	 */
+	static void PackSSE(
+		const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+		float* _pDest);
+
+	/**
+	 * インスタンスデータの書き込み(AVX2版)
+	 */
+	static void PackAVX2(
+		const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+		float* _pDest);
+
+	/**
+	 * インスタンスデータの書き込み(NEON版)
+	 */
+	static void PackNEON(
+		const float* _pPosX, const float* _pPosY, const float* _pPosZ, const float* _pRippleTime, int _count,
+		float* _pDest);
+
+
+	ThreadPool*				m_pThreadPool;	//!< 並列に書き込むためのスレッドプール.
+	CpuFeature::SIMD_TYPE	m_SimdType;		//!< 使用する命令セット.
+
+};
+
+
+#endif // !RAININSTANCEPACKER_H
@@ -0,0 +1,184 @@
+﻿/**
+ * @file	RainOcclusionMap.cpp
+ * @brief	雨の遮蔽高さマップクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "RainOcclusionMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\FieldManager\TerrainHeightField\TerrainHeightField.h"
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const int RainOcclusionMap::m_CellNumMax = 1 << 24;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+RainOcclusionMap::RainOcclusionMap() :
+	m_pTerrain(nullptr),
+	m_CellNumX(0),
+	m_CellNumY(0),
+	m_MinX(0.0f),
+	m_MaxZ(1.0f),
+	m_AreaWidth(1.0f),
+	m_AreaDepth(1.0f),
+	m_InvCellWidth(0.0f),
+	m_InvCellDepth(0.0f),
+	m_BaseHeight(0.0f)
+{
+}
+
+RainOcclusionMap::~RainOcclusionMap()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void RainOcclusionMap::SetWorldArea(float _minX, float _maxZ, float _width, float _depth)
+{
+	m_MinX = _minX;
+	m_MaxZ = _maxZ;
+	m_AreaWidth = _width;
+	m_AreaDepth = _depth;
+}
+
+void RainOcclusionMap::AddBox(float _x, float _z, float _halfWidth, float _halfDepth, float _rotate, float _height)
+{
+	BOX Box = { _x, _z, _halfWidth, _halfDepth, std::sin(_rotate), std::cos(_rotate), _height };
+	m_Box.push_back(Box);
+}
+
+void RainOcclusionMap::ClearBox()
+{
+	m_Box.clear();
+}
+
+bool RainOcclusionMap::Build(int _cellNumX, int _cellNumY)
+{
+	// 雨粒の更新はセルのインデックスをfloatで計算するので, 誤差が出ない数までに限る.
+	if (_cellNumX <= 0 || _cellNumY <= 0 ||
+		m_AreaWidth <= 0.0f || m_AreaDepth <= 0.0f ||
+		static_cast<long long>(_cellNumX) * _cellNumY > m_CellNumMax)
+	{
+		return false;
+	}
+
+	m_CellNumX = _cellNumX;
+	m_CellNumY = _cellNumY;
+	m_InvCellWidth = static_cast<float>(_cellNumX) / m_AreaWidth;
+	m_InvCellDepth = static_cast<float>(_cellNumY) / m_AreaDepth;
+	m_Height.assign(static_cast<size_t>(_cellNumX) * _cellNumY, m_BaseHeight);
+
+	if (m_pTerrain != nullptr)
+	{
+		RasterizeTerrain();
+	}
+
+	for (auto itr = m_Box.begin(); itr != m_Box.end(); itr++)
+	{
+		Rasterize(*itr);
+	}
+
+	return true;
+}
+
+void RainOcclusionMap::Release()
+{
+	std::vector<float>().swap(m_Height);
+	m_CellNumX = 0;
+	m_CellNumY = 0;
+	m_InvCellWidth = 0.0f;
+	m_InvCellDepth = 0.0f;
+}
+
+float RainOcclusionMap::GetHeight(float _x, float _z) const
+{
+	float CellX = (_x - m_MinX) * m_InvCellWidth;
+	float CellY = (m_MaxZ - _z) * m_InvCellDepth;
+	if (CellX < 0.0f || CellX >= static_cast<float>(m_CellNumX) ||
+		CellY < 0.0f || CellY >= static_cast<float>(m_CellNumY))
+	{
+		return m_BaseHeight;
+	}
+
+	int X = std::min(static_cast<int>(CellX), m_CellNumX - 1);
+	int Y = std::min(static_cast<int>(CellY), m_CellNumY - 1);
+	return m_Height[static_cast<size_t>(Y) * m_CellNumX + X];
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void RainOcclusionMap::RasterizeTerrain()
+{
+	float CellWidth = m_AreaWidth / static_cast<float>(m_CellNumX);
+	float CellDepth = m_AreaDepth / static_cast<float>(m_CellNumY);
+
+	// 1行分のセルの中心をまとめて地形から取得する.
+	std::vector<float> CellX(m_CellNumX);
+	std::vector<float> CellZ(m_CellNumX);
+	for (int x = 0; x < m_CellNumX; x++)
+	{
+		CellX[x] = m_MinX + (static_cast<float>(x) + 0.5f) * CellWidth;
+	}
+
+	for (int y = 0; y < m_CellNumY; y++)
+	{
+		float* pRow = &m_Height[static_cast<size_t>(y) * m_CellNumX];
+		std::fill(CellZ.begin(), CellZ.end(), m_MaxZ - (static_cast<float>(y) + 0.5f) * CellDepth);
+		m_pTerrain->SampleHeight(CellX.data(), CellZ.data(), m_CellNumX, pRow);
+
+		// 水面より低い地形は水の中なので, 雨粒は水面で着水する.
+		for (int x = 0; x < m_CellNumX; x++)
+		{
+			pRow[x] = std::max(pRow[x], m_BaseHeight);
+		}
+	}
+}
+
+void RainOcclusionMap::Rasterize(const BOX& _box)
+{
+	// 回転後の外接矩形からセルの範囲を求める.
+	float ExtentX = std::fabs(_box.HalfWidth * _box.Cos) + std::fabs(_box.HalfDepth * _box.Sin);
+	float ExtentZ = std::fabs(_box.HalfWidth * _box.Sin) + std::fabs(_box.HalfDepth * _box.Cos);
+	float CellWidth = m_AreaWidth / static_cast<float>(m_CellNumX);
+	float CellDepth = m_AreaDepth / static_cast<float>(m_CellNumY);
+
+	int MinX = std::max(static_cast<int>(std::floor((_box.X - ExtentX - m_MinX) / CellWidth)), 0);
+	int MaxX = std::min(static_cast<int>(std::floor((_box.X + ExtentX - m_MinX) / CellWidth)), m_CellNumX - 1);
+	int MinY = std::max(static_cast<int>(std::floor((m_MaxZ - (_box.Z + ExtentZ)) / CellDepth)), 0);
+	int MaxY = std::min(static_cast<int>(std::floor((m_MaxZ - (_box.Z - ExtentZ)) / CellDepth)), m_CellNumY - 1);
+
+	for (int y = MinY; y <= MaxY; y++)
+	{
+		float* pRow = &m_Height[static_cast<size_t>(y) * m_CellNumX];
+		float DistZ = (m_MaxZ - (static_cast<float>(y) + 0.5f) * CellDepth) - _box.Z;
+
+		for (int x = MinX; x <= MaxX; x++)
+		{
+			// セルの中心を回転前の座標系に戻して判定する.
+			float DistX = (m_MinX + (static_cast<float>(x) + 0.5f) * CellWidth) - _box.X;
+			float LocalX = DistX * _box.Cos - DistZ * _box.Sin;
+			float LocalZ = DistX * _box.Sin + DistZ * _box.Cos;
+			if (std::fabs(LocalX) > _box.HalfWidth || std::fabs(LocalZ) > _box.HalfDepth)
+			{
+				continue;
+			}
+
+			pRow[x] = std::max(pRow[x], _box.Height);
+		}
+	}
+}
@@ -0,0 +1,223 @@
+﻿/**
+ * @file	RainOcclusionMap.h
+ * @brief	雨の遮蔽高さマップクラス定義
+ * @author	morimoto
+ */
+#ifndef RAINOCCLUSIONMAP_H
+#define RAINOCCLUSIONMAP_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+
+class TerrainHeightField;
+
+
+/**
+ * 雨の遮蔽高さマップクラス
+ *
+ * 家などの動かないオブジェクトを真上から見た範囲と高さをワールド座標で受け付け,
+ * 1セルに1つの高さを持つ2次元の格子に変換する(重なった場合は高い方).
+ * 雨粒は真下のセルの高さに着水するので, 屋根の上に落ちた雨粒は屋根で波紋を出す.
+ *
+ * 格子の並びはWaveObstacleMaskと同じで, セル(x, y)はワールド座標の左端(x)と上端(z)から数える.
+ * 格子の外とオブジェクトの無いセルは基準の高さ(水面)になる. 地形を設定すると, オブジェクトの無いセルは
+ * セルの中心の地形の高さ(基準の高さより低ければ基準の高さ)になり, 山などの上に落ちた雨粒は地面で着水する.
+ */
+class RainOcclusionMap
+{
+public:
+	/**
+	 * コンストラクタ
+	 */
+	RainOcclusionMap();
+
+	/**
+	 * デストラクタ
+	 */
+	~RainOcclusionMap();
+
+	/**
+	 * 格子が覆うワールド座標の範囲を設定
+	 * @param[in] _minX 格子の左端のx座標
+	 * @param[in] _maxZ 格子の上端のz座標
+	 * @param[in] _width 格子のx方向の大きさ
+	 * @param[in] _depth 格子のz方向の大きさ
+	 */
+	void SetWorldArea(float _minX, float _maxZ, float _width, float _depth);
+
+	/**
+	 * 基準の高さを設定(次のBuildで反映される)
+	 * @param[in] _baseHeight 遮蔽物の無い場所の高さ
+	 */
+	void SetBaseHeight(float _baseHeight)
+	{
+		m_BaseHeight = _baseHeight;
+	}
+
+	/**
+	 * 遮蔽物の下の地形を設定(次のBuildで反映される)
+	 * @param[in] _pTerrain 地形の高さマップ(nullptrなら遮蔽物の無いセルは全て基準の高さ)
+	 */
+	void SetTerrain(const TerrainHeightField* _pTerrain)
+	{
+		m_pTerrain = _pTerrain;
+	}
+
+	/**
+	 * 直方体の遮蔽物を追加(次のBuildで反映される)
+	 * @param[in] _x 中心のワールド座標x
+	 * @param[in] _z 中心のワールド座標z
+	 * @param[in] _halfWidth 回転前のx方向の大きさの半分
+	 * @param[in] _halfDepth 回転前のz方向の大きさの半分
+	 * @param[in] _rotate Y軸回転(ラジアン, Object3DBase::m_Rotate.yと同じ向き)
+	 * @param[in] _height 上面の高さ
+	 */
+	void AddBox(float _x, float _z, float _halfWidth, float _halfDepth, float _rotate, float _height);
+
+	/**
+	 * 追加した遮蔽物を全て破棄
+	 */
+	void ClearBox();
+
+	/**
+	 * 遮蔽物から高さの格子を作成
+	 * @param[in] _cellNumX x方向のセルの数
+	 * @param[in] _cellNumY z方向のセルの数
+	 * @return 作成に成功したらtrue 失敗したらfalse
+	 */
+	bool Build(int _cellNumX, int _cellNumY);
+
+	/**
+	 * 格子を破棄
+	 */
+	void Release();
+
+	/**
+	 * 指定位置の高さを取得
+	 * @param[in] _x ワールド座標x
+	 * @param[in] _z ワールド座標z
+	 * @return 高さ(格子の外なら基準の高さ)
+	 */
+	float GetHeight(float _x, float _z) const;
+
+	/**
+	 * 高さの格子を取得
+	 * @return 格子の先頭(GetCellNumX() * GetCellNumY()個, Buildしていなければnullptr)
+	 */
+	const float* GetHeightData() const
+	{
+		return m_Height.empty() ? nullptr : m_Height.data();
+	}
+
+	/**
+	 * x方向のセルの数を取得
+	 * @return セルの数(Buildしていなければ0)
+	 */
+	int GetCellNumX() const
+	{
+		return m_CellNumX;
+	}
+
+	/**
+	 * z方向のセルの数を取得
+	 * @return セルの数(Buildしていなければ0)
+	 */
+	int GetCellNumY() const
+	{
+		return m_CellNumY;
+	}
+
+	/**
+	 * 格子の左端のx座標を取得
+	 * @return 左端のx座標
+	 */
+	float GetMinX() const
+	{
+		return m_MinX;
+	}
+
+	/**
+	 * 格子の上端のz座標を取得
+	 * @return 上端のz座標
+	 */
+	float GetMaxZ() const
+	{
+		return m_MaxZ;
+	}
+
+	/**
+	 * x方向の1セルの大きさの逆数を取得
+	 * @return 1セルの大きさの逆数
+	 */
+	float GetInvCellWidth() const
+	{
+		return m_InvCellWidth;
+	}
+
+	/**
+	 * z方向の1セルの大きさの逆数を取得
+	 * @return 1セルの大きさの逆数
+	 */
+	float GetInvCellDepth() const
+	{
+		return m_InvCellDepth;
+	}
+
+	/**
+	 * 基準の高さを取得
+	 * @return 基準の高さ
+	 */
+	float GetBaseHeight() const
+	{
+		return m_BaseHeight;
+	}
+
+private:
+	/**
+	 * 直方体の遮蔽物構造体
+	 */
+	struct BOX
+	{
+		float X;			//!< 中心のワールド座標x.
+		float Z;			//!< 中心のワールド座標z.
+		float HalfWidth;	//!< 回転前のx方向の大きさの半分.
+		float HalfDepth;	//!< 回転前のz方向の大きさの半分.
+		float Sin;			//!< Y軸回転の正弦.
+		float Cos;			//!< Y軸回転の余弦.
+		float Height;		//!< 上面の高さ.
+	};
+
+	/**
+	 * 地形の高さを格子に書き込む
+	 */
+	void RasterizeTerrain();
+
+	/**
+	 * 遮蔽物を格子に書き込む
+	 * @param[in] _box 書き込む遮蔽物
+	 */
+	void Rasterize(const BOX& _box);
+
+
+	static const int	m_CellNumMax;	//!< セルの数の最大値(インデックスをfloatで正確に計算できる範囲).
+
+	const TerrainHeightField*	m_pTerrain;			//!< 遮蔽物の下の地形.
+	std::vector<BOX>			m_Box;				//!< 追加された遮蔽物.
+	std::vector<float>			m_Height;			//!< 高さの格子.
+	int							m_CellNumX;			//!< x方向のセルの数.
+	int							m_CellNumY;			//!< z方向のセルの数.
+	float						m_MinX;				//!< 格子の左端のx座標.
+	float						m_MaxZ;				//!< 格子の上端のz座標.
+	float						m_AreaWidth;		//!< 格子のx方向の大きさ.
+	float						m_AreaDepth;		//!< 格子のz方向の大きさ.
+	float						m_InvCellWidth;		//!< x方向の1セルの大きさの逆数.
+	float						m_InvCellDepth;		//!< z方向の1セルの大きさの逆数.
+	float						m_BaseHeight;		//!< 基準の高さ.
+
+};
+
+
+#endif // !RAINOCCLUSIONMAP_H
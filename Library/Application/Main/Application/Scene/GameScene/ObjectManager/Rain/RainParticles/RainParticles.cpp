@@ -0,0 +1,625 @@
+﻿/**
+ * @file	RainParticles.cpp
+ * @brief	雨粒パーティクルの計算クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "RainParticles.h"
+
+#include <algorithm>
+#include <random>
+
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Rain\RainOcclusionMap\RainOcclusionMap.h"
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const float RainParticles::m_FallSpeed = 3.5f;
+const float RainParticles::m_LandHeight = -4.5f;
+const float RainParticles::m_SurfaceHeight = 0.1f;
+const float RainParticles::m_RippleEndTime = 33.0f;
+const float RainParticles::m_RippleStartScale = 2.0f;
+const float RainParticles::m_RippleScaleSpeed = 0.3f;
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const float RainParticles::m_RandomScale = 1.0f / 16777216.0f;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+RainParticles::RainParticles() :
+	m_pThreadPool(nullptr),
+	m_pOcclusionMap(nullptr),
+	m_FlatHeight(0.0f),
+	m_SimdType(CpuFeature::GetSimdType()),
+	m_Capacity(0),
+	m_LandedNum(0)
+{
+	SetSpawnArea(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+RainParticles::~RainParticles()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void RainParticles::SetCapacity(int _capacity, unsigned int _seed)
+{
+	m_Capacity = std::max(_capacity, 0);
+	m_PosX.assign(m_Capacity, 0.0f);
+	m_PosY.assign(m_Capacity, 0.0f);
+	m_PosZ.assign(m_Capacity, 0.0f);
+	m_RippleTime.assign(m_Capacity, 0.0f);
+	m_Seed.assign(m_Capacity, 0);
+	m_LandedX.assign(m_Capacity, 0.0f);
+	m_LandedZ.assign(m_Capacity, 0.0f);
+	m_ChunkLandedNum.assign((m_Capacity + CHUNK_SIZE - 1) / CHUNK_SIZE, 0);
+	m_LandedNum = 0;
+
+	std::mt19937 MersenneTwister(_seed);
+	for (int i = 0; i < m_Capacity; i++)
+	{
+		// xorshiftは0から抜け出せないので0以外の種にする.
+		unsigned int Seed = static_cast<unsigned int>(MersenneTwister());
+		m_Seed[i] = Seed != 0 ? Seed : 0x9e3779b9;
+
+		float Random[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Random[j] = static_cast<float>(MersenneTwister() >> 8) * m_RandomScale;
+		}
+
+		m_PosX[i] = m_Area.MinX + m_Area.RangeX * Random[0];
+		m_PosY[i] = m_Area.MinY + m_Area.RangeY * Random[1];
+		m_PosZ[i] = m_Area.MinZ + m_Area.RangeZ * Random[2];
+	}
+}
+
+void RainParticles::SetSpawnArea(float _minX, float _maxX, float _minY, float _maxY, float _minZ, float _maxZ)
+{
+	m_Area.MinX = _minX;
+	m_Area.RangeX = _maxX - _minX;
+	m_Area.InvRangeX = m_Area.RangeX > 0.0f ? 1.0f / m_Area.RangeX : 0.0f;
+	m_Area.MinY = _minY;
+	m_Area.RangeY = _maxY - _minY;
+	m_Area.MinZ = _minZ;
+	m_Area.RangeZ = _maxZ - _minZ;
+	m_Area.InvRangeZ = m_Area.RangeZ > 0.0f ? 1.0f / m_Area.RangeZ : 0.0f;
+}
+
+void RainParticles::Update()
+{
+	UPDATE_FUNC pUpdateFunc = GetUpdateFunc(m_SimdType);
+	int ChunkNum = static_cast<int>(m_ChunkLandedNum.size());
+
+	// マップが無ければ大きさ0の格子にして, 全ての雨粒が格子の外(高さ0)になるようにする.
+	GRID Grid = { &m_FlatHeight, 0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, m_FlatHeight };
+	if (m_pOcclusionMap != nullptr && m_pOcclusionMap->GetHeightData() != nullptr)
+	{
+		Grid.pHeight = m_pOcclusionMap->GetHeightData();
+		Grid.CellNumX = m_pOcclusionMap->GetCellNumX();
+		Grid.MinX = m_pOcclusionMap->GetMinX();
+		Grid.MaxZ = m_pOcclusionMap->GetMaxZ();
+		Grid.InvCellWidth = m_pOcclusionMap->GetInvCellWidth();
+		Grid.InvCellDepth = m_pOcclusionMap->GetInvCellDepth();
+		Grid.SizeX = static_cast<float>(m_pOcclusionMap->GetCellNumX());
+		Grid.SizeY = static_cast<float>(m_pOcclusionMap->GetCellNumY());
+		Grid.MaxCellX = Grid.SizeX - 1.0f;
+		Grid.MaxCellY = Grid.SizeY - 1.0f;
+		Grid.BaseHeight = m_pOcclusionMap->GetBaseHeight();
+	}
+
+	// 着水した雨粒はチャンクの先頭と同じ位置から書き込み, 後で前に詰める.
+	auto UpdateChunk = [&](int _chunk)
+	{
+		int Begin = _chunk * CHUNK_SIZE;
+		int Count = std::min(static_cast<int>(CHUNK_SIZE), m_Capacity - Begin);
+
+		m_ChunkLandedNum[_chunk] = pUpdateFunc(
+			&m_PosX[Begin], &m_PosY[Begin], &m_PosZ[Begin], &m_RippleTime[Begin], &m_Seed[Begin], Count,
+			m_Area, Grid, &m_LandedX[Begin], &m_LandedZ[Begin]);
+	};
+
+	if (m_pThreadPool != nullptr && ChunkNum > 1)
+	{
+		m_pThreadPool->ParallelFor(ChunkNum, UpdateChunk);
+	}
+	else
+	{
+		for (int i = 0; i < ChunkNum; i++)
+		{
+			UpdateChunk(i);
+		}
+	}
+
+	m_LandedNum = 0;
+	for (int i = 0; i < ChunkNum; i++)
+	{
+		int Begin = i * CHUNK_SIZE;
+		int Num = m_ChunkLandedNum[i];
+		if (Begin != m_LandedNum)
+		{
+			std::copy(m_LandedX.begin() + Begin, m_LandedX.begin() + Begin + Num, m_LandedX.begin() + m_LandedNum);
+			std::copy(m_LandedZ.begin() + Begin, m_LandedZ.begin() + Begin + Num, m_LandedZ.begin() + m_LandedNum);
+		}
+		m_LandedNum += Num;
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+RainParticles::UPDATE_FUNC RainParticles::GetUpdateFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &UpdateAVX2;
+	case CpuFeature::SIMD_SSE:	return &UpdateSSE;
+	case CpuFeature::SIMD_NEON:	return &UpdateNEON;
+	default:					return &UpdateScalar;
+	}
+}
+
+int RainParticles::UpdateScalar(
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+	const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ)
+{
+	int LandedNum = 0;
+	for (int i = 0; i < _count; i++)
+	{
+		// 出現し直す位置の乱数は毎フレーム進めておき, 状態によって分岐しないようにする.
+		unsigned int Seed = _pSeed[i];
+		float Random[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed ^= Seed << 13;
+			Seed ^= Seed >> 17;
+			Seed ^= Seed << 5;
+			Random[j] = static_cast<float>(static_cast<int>(Seed >> 8)) * m_RandomScale;
+		}
+		_pSeed[i] = Seed;
+
+		float X = _pPosX[i];
+		float Y = _pPosY[i];
+		float Z = _pPosZ[i];
+		float RippleTime = _pRippleTime[i];
+
+		// 範囲の外に出た雨粒は範囲の大きさの倍数だけずらして反対側へ回り込ませる(範囲内ならずれは0).
+		// floorはSIMD版と同じ結果になるように切り捨てから求める.
+		float WrapX = (X - _area.MinX) * _area.InvRangeX;
+		float WrapZ = (Z - _area.MinZ) * _area.InvRangeZ;
+		float FloorX = static_cast<float>(static_cast<int>(WrapX));
+		float FloorZ = static_cast<float>(static_cast<int>(WrapZ));
+		FloorX -= FloorX > WrapX ? 1.0f : 0.0f;
+		FloorZ -= FloorZ > WrapZ ? 1.0f : 0.0f;
+		X -= _area.RangeX * FloorX;
+		Z -= _area.RangeZ * FloorZ;
+
+		// 真下のセルの高さを引く(格子の外は基準の高さ). インデックスはSIMD版と同じくfloatで求める.
+		float CellX = (X - _grid.MinX) * _grid.InvCellWidth;
+		float CellY = (_grid.MaxZ - Z) * _grid.InvCellDepth;
+		bool IsInside = CellX >= 0.0f && CellX < _grid.SizeX && CellY >= 0.0f && CellY < _grid.SizeY;
+		float IndexX = static_cast<float>(static_cast<int>(std::max(std::min(CellX, _grid.MaxCellX), 0.0f)));
+		float IndexY = static_cast<float>(static_cast<int>(std::max(std::min(CellY, _grid.MaxCellY), 0.0f)));
+		int Index = static_cast<int>(IndexY * static_cast<float>(_grid.CellNumX) + IndexX);
+		float Ground = IsInside ? _grid.pHeight[Index] : _grid.BaseHeight;
+
+		// 水面では水面の下まで落としてから着水させ(落ちる雨粒が水面で途切れないように),
+		// 屋根や地形の上ではその表面で着水させる.
+		bool IsFall = RippleTime == 0.0f;
+		float FallY = Y - m_FallSpeed;
+		bool IsWater = Ground <= _grid.BaseHeight;
+		bool IsLand = IsFall && FallY <= Ground + (IsWater ? m_LandHeight : 0.0f);
+		bool IsLandWater = IsLand && IsWater;
+		float NextRippleTime = RippleTime + 1.0f;
+		bool IsRespawn = !IsFall && NextRippleTime >= m_RippleEndTime;
+
+		_pPosX[i] = IsRespawn ? _area.MinX + _area.RangeX * Random[0] : X;
+		_pPosY[i] = IsLand ? Ground + m_SurfaceHeight : IsFall ? FallY : IsRespawn ? _area.MinY + _area.RangeY * Random[1] : Y;
+		_pPosZ[i] = IsRespawn ? _area.MinZ + _area.RangeZ * Random[2] : Z;
+		_pRippleTime[i] = IsLand ? 1.0f : (IsFall || IsRespawn) ? 0.0f : NextRippleTime;
+
+		// 水面に着水していなければ次の雨粒で上書きされる.
+		_pLandedX[LandedNum] = X;
+		_pLandedZ[LandedNum] = Z;
+		LandedNum += IsLandWater ? 1 : 0;
+	}
+
+	return LandedNum;
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+int RainParticles::UpdateSSE(
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+	const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ)
+{
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128 FallSpeed = _mm_set1_ps(m_FallSpeed);
+	const __m128 LandHeight = _mm_set1_ps(m_LandHeight);
+	const __m128 SurfaceHeight = _mm_set1_ps(m_SurfaceHeight);
+	const __m128 RippleEndTime = _mm_set1_ps(m_RippleEndTime);
+	const __m128 RandomScale = _mm_set1_ps(m_RandomScale);
+	const __m128 MinX = _mm_set1_ps(_area.MinX);
+	const __m128 MinY = _mm_set1_ps(_area.MinY);
+	const __m128 MinZ = _mm_set1_ps(_area.MinZ);
+	const __m128 RangeX = _mm_set1_ps(_area.RangeX);
+	const __m128 RangeY = _mm_set1_ps(_area.RangeY);
+	const __m128 RangeZ = _mm_set1_ps(_area.RangeZ);
+	const __m128 InvRangeX = _mm_set1_ps(_area.InvRangeX);
+	const __m128 InvRangeZ = _mm_set1_ps(_area.InvRangeZ);
+	const __m128 GridMinX = _mm_set1_ps(_grid.MinX);
+	const __m128 GridMaxZ = _mm_set1_ps(_grid.MaxZ);
+	const __m128 InvCellWidth = _mm_set1_ps(_grid.InvCellWidth);
+	const __m128 InvCellDepth = _mm_set1_ps(_grid.InvCellDepth);
+	const __m128 SizeX = _mm_set1_ps(_grid.SizeX);
+	const __m128 SizeY = _mm_set1_ps(_grid.SizeY);
+	const __m128 MaxCellX = _mm_set1_ps(_grid.MaxCellX);
+	const __m128 MaxCellY = _mm_set1_ps(_grid.MaxCellY);
+	const __m128 CellNumX = _mm_set1_ps(static_cast<float>(_grid.CellNumX));
+	const __m128 BaseHeight = _mm_set1_ps(_grid.BaseHeight);
+
+	int LandedNum = 0;
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		__m128i Seed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&_pSeed[i]));
+		__m128 Random[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed = _mm_xor_si128(Seed, _mm_slli_epi32(Seed, 13));
+			Seed = _mm_xor_si128(Seed, _mm_srli_epi32(Seed, 17));
+			Seed = _mm_xor_si128(Seed, _mm_slli_epi32(Seed, 5));
+			Random[j] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(Seed, 8)), RandomScale);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&_pSeed[i]), Seed);
+
+		__m128 X = _mm_loadu_ps(&_pPosX[i]);
+		__m128 Y = _mm_loadu_ps(&_pPosY[i]);
+		__m128 Z = _mm_loadu_ps(&_pPosZ[i]);
+		__m128 RippleTime = _mm_loadu_ps(&_pRippleTime[i]);
+
+		// SSE2にはfloorが無いので切り捨ててから負の端数の分を1引く.
+		__m128 WrapX = _mm_mul_ps(_mm_sub_ps(X, MinX), InvRangeX);
+		__m128 WrapZ = _mm_mul_ps(_mm_sub_ps(Z, MinZ), InvRangeZ);
+		__m128 FloorX = _mm_cvtepi32_ps(_mm_cvttps_epi32(WrapX));
+		__m128 FloorZ = _mm_cvtepi32_ps(_mm_cvttps_epi32(WrapZ));
+		FloorX = _mm_sub_ps(FloorX, _mm_and_ps(_mm_cmpgt_ps(FloorX, WrapX), One));
+		FloorZ = _mm_sub_ps(FloorZ, _mm_and_ps(_mm_cmpgt_ps(FloorZ, WrapZ), One));
+		X = _mm_sub_ps(X, _mm_mul_ps(RangeX, FloorX));
+		Z = _mm_sub_ps(Z, _mm_mul_ps(RangeZ, FloorZ));
+
+		// SSE2にはgatherが無いので, インデックスを書き出して1つずつ読み込む.
+		__m128 CellX = _mm_mul_ps(_mm_sub_ps(X, GridMinX), InvCellWidth);
+		__m128 CellY = _mm_mul_ps(_mm_sub_ps(GridMaxZ, Z), InvCellDepth);
+		__m128 IsInside = _mm_and_ps(
+			_mm_and_ps(_mm_cmpge_ps(CellX, Zero), _mm_cmplt_ps(CellX, SizeX)),
+			_mm_and_ps(_mm_cmpge_ps(CellY, Zero), _mm_cmplt_ps(CellY, SizeY)));
+		__m128 IndexX = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(CellX, MaxCellX), Zero)));
+		__m128 IndexY = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(CellY, MaxCellY), Zero)));
+		int Index[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Index), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(IndexY, CellNumX), IndexX)));
+		__m128 Ground = _mm_set_ps(
+			_grid.pHeight[Index[3]], _grid.pHeight[Index[2]], _grid.pHeight[Index[1]], _grid.pHeight[Index[0]]);
+		Ground = _mm_or_ps(_mm_and_ps(IsInside, Ground), _mm_andnot_ps(IsInside, BaseHeight));
+
+		__m128 IsFall = _mm_cmpeq_ps(RippleTime, Zero);
+		__m128 FallY = _mm_sub_ps(Y, FallSpeed);
+		__m128 IsWater = _mm_cmple_ps(Ground, BaseHeight);
+		__m128 IsLand = _mm_and_ps(IsFall, _mm_cmple_ps(FallY, _mm_add_ps(Ground, _mm_and_ps(IsWater, LandHeight))));
+		__m128 IsLandWater = _mm_and_ps(IsLand, IsWater);
+		__m128 NextRippleTime = _mm_add_ps(RippleTime, One);
+		__m128 IsRespawn = _mm_andnot_ps(IsFall, _mm_cmpge_ps(NextRippleTime, RippleEndTime));
+
+		__m128 RespawnX = _mm_add_ps(MinX, _mm_mul_ps(RangeX, Random[0]));
+		__m128 RespawnY = _mm_add_ps(MinY, _mm_mul_ps(RangeY, Random[1]));
+		__m128 RespawnZ = _mm_add_ps(MinZ, _mm_mul_ps(RangeZ, Random[2]));
+
+		// SSE2にはblendvが無いのでand/andnot/orで選択する.
+		__m128 NextY = _mm_or_ps(_mm_and_ps(IsRespawn, RespawnY), _mm_andnot_ps(IsRespawn, Y));
+		NextY = _mm_or_ps(_mm_and_ps(IsFall, FallY), _mm_andnot_ps(IsFall, NextY));
+		NextY = _mm_or_ps(_mm_and_ps(IsLand, _mm_add_ps(Ground, SurfaceHeight)), _mm_andnot_ps(IsLand, NextY));
+
+		_mm_storeu_ps(&_pPosX[i], _mm_or_ps(_mm_and_ps(IsRespawn, RespawnX), _mm_andnot_ps(IsRespawn, X)));
+		_mm_storeu_ps(&_pPosY[i], NextY);
+		_mm_storeu_ps(&_pPosZ[i], _mm_or_ps(_mm_and_ps(IsRespawn, RespawnZ), _mm_andnot_ps(IsRespawn, Z)));
+		_mm_storeu_ps(&_pRippleTime[i], _mm_or_ps(
+			_mm_and_ps(IsLand, One),
+			_mm_andnot_ps(_mm_or_ps(IsFall, IsRespawn), NextRippleTime)));
+
+		int LandMask = _mm_movemask_ps(IsLandWater);
+		if (LandMask != 0)
+		{
+			float LaneX[4], LaneZ[4];
+			_mm_storeu_ps(LaneX, X);
+			_mm_storeu_ps(LaneZ, Z);
+			for (int j = 0; j < 4; j++)
+			{
+				_pLandedX[LandedNum] = LaneX[j];
+				_pLandedZ[LandedNum] = LaneZ[j];
+				LandedNum += (LandMask >> j) & 1;
+			}
+		}
+	}
+
+	return LandedNum + UpdateScalar(
+		_pPosX + i, _pPosY + i, _pPosZ + i, _pRippleTime + i, _pSeed + i, _count - i,
+		_area, _grid, _pLandedX + LandedNum, _pLandedZ + LandedNum);
+}
+
+CPUFEATURE_TARGET_AVX2
+int RainParticles::UpdateAVX2(
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+	const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ)
+{
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 One = _mm256_set1_ps(1.0f);
+	const __m256 FallSpeed = _mm256_set1_ps(m_FallSpeed);
+	const __m256 LandHeight = _mm256_set1_ps(m_LandHeight);
+	const __m256 SurfaceHeight = _mm256_set1_ps(m_SurfaceHeight);
+	const __m256 RippleEndTime = _mm256_set1_ps(m_RippleEndTime);
+	const __m256 RandomScale = _mm256_set1_ps(m_RandomScale);
+	const __m256 MinX = _mm256_set1_ps(_area.MinX);
+	const __m256 MinY = _mm256_set1_ps(_area.MinY);
+	const __m256 MinZ = _mm256_set1_ps(_area.MinZ);
+	const __m256 RangeX = _mm256_set1_ps(_area.RangeX);
+	const __m256 RangeY = _mm256_set1_ps(_area.RangeY);
+	const __m256 RangeZ = _mm256_set1_ps(_area.RangeZ);
+	const __m256 InvRangeX = _mm256_set1_ps(_area.InvRangeX);
+	const __m256 InvRangeZ = _mm256_set1_ps(_area.InvRangeZ);
+	const __m256 GridMinX = _mm256_set1_ps(_grid.MinX);
+	const __m256 GridMaxZ = _mm256_set1_ps(_grid.MaxZ);
+	const __m256 InvCellWidth = _mm256_set1_ps(_grid.InvCellWidth);
+	const __m256 InvCellDepth = _mm256_set1_ps(_grid.InvCellDepth);
+	const __m256 SizeX = _mm256_set1_ps(_grid.SizeX);
+	const __m256 SizeY = _mm256_set1_ps(_grid.SizeY);
+	const __m256 MaxCellX = _mm256_set1_ps(_grid.MaxCellX);
+	const __m256 MaxCellY = _mm256_set1_ps(_grid.MaxCellY);
+	const __m256 CellNumX = _mm256_set1_ps(static_cast<float>(_grid.CellNumX));
+	const __m256 BaseHeight = _mm256_set1_ps(_grid.BaseHeight);
+
+	int LandedNum = 0;
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256i Seed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&_pSeed[i]));
+		__m256 Random[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed = _mm256_xor_si256(Seed, _mm256_slli_epi32(Seed, 13));
+			Seed = _mm256_xor_si256(Seed, _mm256_srli_epi32(Seed, 17));
+			Seed = _mm256_xor_si256(Seed, _mm256_slli_epi32(Seed, 5));
+			Random[j] = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(Seed, 8)), RandomScale);
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&_pSeed[i]), Seed);
+
+		__m256 X = _mm256_loadu_ps(&_pPosX[i]);
+		__m256 Y = _mm256_loadu_ps(&_pPosY[i]);
+		__m256 Z = _mm256_loadu_ps(&_pPosZ[i]);
+		__m256 RippleTime = _mm256_loadu_ps(&_pRippleTime[i]);
+
+		__m256 FloorX = _mm256_floor_ps(_mm256_mul_ps(_mm256_sub_ps(X, MinX), InvRangeX));
+		__m256 FloorZ = _mm256_floor_ps(_mm256_mul_ps(_mm256_sub_ps(Z, MinZ), InvRangeZ));
+		X = _mm256_sub_ps(X, _mm256_mul_ps(RangeX, FloorX));
+		Z = _mm256_sub_ps(Z, _mm256_mul_ps(RangeZ, FloorZ));
+
+		__m256 CellX = _mm256_mul_ps(_mm256_sub_ps(X, GridMinX), InvCellWidth);
+		__m256 CellY = _mm256_mul_ps(_mm256_sub_ps(GridMaxZ, Z), InvCellDepth);
+		__m256 IsInside = _mm256_and_ps(
+			_mm256_and_ps(_mm256_cmp_ps(CellX, Zero, _CMP_GE_OQ), _mm256_cmp_ps(CellX, SizeX, _CMP_LT_OQ)),
+			_mm256_and_ps(_mm256_cmp_ps(CellY, Zero, _CMP_GE_OQ), _mm256_cmp_ps(CellY, SizeY, _CMP_LT_OQ)));
+		__m256 IndexX = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_max_ps(_mm256_min_ps(CellX, MaxCellX), Zero)));
+		__m256 IndexY = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_max_ps(_mm256_min_ps(CellY, MaxCellY), Zero)));
+		__m256i Index = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(IndexY, CellNumX), IndexX));
+		__m256 Ground = _mm256_blendv_ps(BaseHeight, _mm256_i32gather_ps(_grid.pHeight, Index, 4), IsInside);
+
+		__m256 IsFall = _mm256_cmp_ps(RippleTime, Zero, _CMP_EQ_OQ);
+		__m256 FallY = _mm256_sub_ps(Y, FallSpeed);
+		__m256 IsWater = _mm256_cmp_ps(Ground, BaseHeight, _CMP_LE_OQ);
+		__m256 IsLand = _mm256_and_ps(IsFall, _mm256_cmp_ps(FallY, _mm256_add_ps(Ground, _mm256_and_ps(IsWater, LandHeight)), _CMP_LE_OQ));
+		__m256 IsLandWater = _mm256_and_ps(IsLand, IsWater);
+		__m256 NextRippleTime = _mm256_add_ps(RippleTime, One);
+		__m256 IsRespawn = _mm256_andnot_ps(IsFall, _mm256_cmp_ps(NextRippleTime, RippleEndTime, _CMP_GE_OQ));
+
+		__m256 RespawnX = _mm256_add_ps(MinX, _mm256_mul_ps(RangeX, Random[0]));
+		__m256 RespawnY = _mm256_add_ps(MinY, _mm256_mul_ps(RangeY, Random[1]));
+		__m256 RespawnZ = _mm256_add_ps(MinZ, _mm256_mul_ps(RangeZ, Random[2]));
+
+		__m256 NextY = _mm256_blendv_ps(Y, RespawnY, IsRespawn);
+		NextY = _mm256_blendv_ps(NextY, FallY, IsFall);
+		NextY = _mm256_blendv_ps(NextY, _mm256_add_ps(Ground, SurfaceHeight), IsLand);
+
+		_mm256_storeu_ps(&_pPosX[i], _mm256_blendv_ps(X, RespawnX, IsRespawn));
+		_mm256_storeu_ps(&_pPosY[i], NextY);
+		_mm256_storeu_ps(&_pPosZ[i], _mm256_blendv_ps(Z, RespawnZ, IsRespawn));
+		_mm256_storeu_ps(&_pRippleTime[i], _mm256_or_ps(
+			_mm256_and_ps(IsLand, One),
+			_mm256_andnot_ps(_mm256_or_ps(IsFall, IsRespawn), NextRippleTime)));
+
+		int LandMask = _mm256_movemask_ps(IsLandWater);
+		if (LandMask != 0)
+		{
+			float LaneX[8], LaneZ[8];
+			_mm256_storeu_ps(LaneX, X);
+			_mm256_storeu_ps(LaneZ, Z);
+			for (int j = 0; j < 8; j++)
+			{
+				_pLandedX[LandedNum] = LaneX[j];
+				_pLandedZ[LandedNum] = LaneZ[j];
+				LandedNum += (LandMask >> j) & 1;
+			}
+		}
+	}
+
+	return LandedNum + UpdateSSE(
+		_pPosX + i, _pPosY + i, _pPosZ + i, _pRippleTime + i, _pSeed + i, _count - i,
+		_area, _grid, _pLandedX + LandedNum, _pLandedZ + LandedNum);
+}
+
+#else
+
+int RainParticles::UpdateSSE(
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+	const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ)
+{
+	return UpdateScalar(_pPosX, _pPosY, _pPosZ, _pRippleTime, _pSeed, _count, _area, _grid, _pLandedX, _pLandedZ);
+}
+
+int RainParticles::UpdateAVX2(
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+	const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ)
+{
+	return UpdateScalar(_pPosX, _pPosY, _pPosZ, _pRippleTime, _pSeed, _count, _area, _grid, _pLandedX, _pLandedZ);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+int RainParticles::UpdateNEON(
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+	const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ)
+{
+	const float32x4_t Zero = vdupq_n_f32(0.0f);
+	const float32x4_t One = vdupq_n_f32(1.0f);
+	const float32x4_t FallSpeed = vdupq_n_f32(m_FallSpeed);
+	const float32x4_t LandHeight = vdupq_n_f32(m_LandHeight);
+	const float32x4_t SurfaceHeight = vdupq_n_f32(m_SurfaceHeight);
+	const float32x4_t RippleEndTime = vdupq_n_f32(m_RippleEndTime);
+	const float32x4_t RandomScale = vdupq_n_f32(m_RandomScale);
+	const float32x4_t MinX = vdupq_n_f32(_area.MinX);
+	const float32x4_t MinY = vdupq_n_f32(_area.MinY);
+	const float32x4_t MinZ = vdupq_n_f32(_area.MinZ);
+	const float32x4_t RangeX = vdupq_n_f32(_area.RangeX);
+	const float32x4_t RangeY = vdupq_n_f32(_area.RangeY);
+	const float32x4_t RangeZ = vdupq_n_f32(_area.RangeZ);
+	const float32x4_t InvRangeX = vdupq_n_f32(_area.InvRangeX);
+	const float32x4_t InvRangeZ = vdupq_n_f32(_area.InvRangeZ);
+	const float32x4_t GridMinX = vdupq_n_f32(_grid.MinX);
+	const float32x4_t GridMaxZ = vdupq_n_f32(_grid.MaxZ);
+	const float32x4_t InvCellWidth = vdupq_n_f32(_grid.InvCellWidth);
+	const float32x4_t InvCellDepth = vdupq_n_f32(_grid.InvCellDepth);
+	const float32x4_t SizeX = vdupq_n_f32(_grid.SizeX);
+	const float32x4_t SizeY = vdupq_n_f32(_grid.SizeY);
+	const float32x4_t MaxCellX = vdupq_n_f32(_grid.MaxCellX);
+	const float32x4_t MaxCellY = vdupq_n_f32(_grid.MaxCellY);
+	const float32x4_t CellNumX = vdupq_n_f32(static_cast<float>(_grid.CellNumX));
+	const float32x4_t BaseHeight = vdupq_n_f32(_grid.BaseHeight);
+
+	int LandedNum = 0;
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		uint32x4_t Seed = vld1q_u32(&_pSeed[i]);
+		float32x4_t Random[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Seed = veorq_u32(Seed, vshlq_n_u32(Seed, 13));
+			Seed = veorq_u32(Seed, vshrq_n_u32(Seed, 17));
+			Seed = veorq_u32(Seed, vshlq_n_u32(Seed, 5));
+			Random[j] = vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(vshrq_n_u32(Seed, 8))), RandomScale);
+		}
+		vst1q_u32(&_pSeed[i], Seed);
+
+		float32x4_t X = vld1q_f32(&_pPosX[i]);
+		float32x4_t Y = vld1q_f32(&_pPosY[i]);
+		float32x4_t Z = vld1q_f32(&_pPosZ[i]);
+		float32x4_t RippleTime = vld1q_f32(&_pRippleTime[i]);
+
+		// vrndmqはARMv8からなので切り捨てから求める.
+		float32x4_t WrapX = vmulq_f32(vsubq_f32(X, MinX), InvRangeX);
+		float32x4_t WrapZ = vmulq_f32(vsubq_f32(Z, MinZ), InvRangeZ);
+		float32x4_t FloorX = vcvtq_f32_s32(vcvtq_s32_f32(WrapX));
+		float32x4_t FloorZ = vcvtq_f32_s32(vcvtq_s32_f32(WrapZ));
+		FloorX = vsubq_f32(FloorX, vbslq_f32(vcgtq_f32(FloorX, WrapX), One, Zero));
+		FloorZ = vsubq_f32(FloorZ, vbslq_f32(vcgtq_f32(FloorZ, WrapZ), One, Zero));
+		X = vsubq_f32(X, vmulq_f32(RangeX, FloorX));
+		Z = vsubq_f32(Z, vmulq_f32(RangeZ, FloorZ));
+
+		// NEONにはgatherが無いので, インデックスを書き出して1つずつ読み込む.
+		float32x4_t CellX = vmulq_f32(vsubq_f32(X, GridMinX), InvCellWidth);
+		float32x4_t CellY = vmulq_f32(vsubq_f32(GridMaxZ, Z), InvCellDepth);
+		uint32x4_t IsInside = vandq_u32(
+			vandq_u32(vcgeq_f32(CellX, Zero), vcltq_f32(CellX, SizeX)),
+			vandq_u32(vcgeq_f32(CellY, Zero), vcltq_f32(CellY, SizeY)));
+		float32x4_t IndexX = vcvtq_f32_s32(vcvtq_s32_f32(vmaxq_f32(vminq_f32(CellX, MaxCellX), Zero)));
+		float32x4_t IndexY = vcvtq_f32_s32(vcvtq_s32_f32(vmaxq_f32(vminq_f32(CellY, MaxCellY), Zero)));
+		int Index[4];
+		vst1q_s32(Index, vcvtq_s32_f32(vaddq_f32(vmulq_f32(IndexY, CellNumX), IndexX)));
+		float LaneGround[4] =
+		{
+			_grid.pHeight[Index[0]], _grid.pHeight[Index[1]], _grid.pHeight[Index[2]], _grid.pHeight[Index[3]]
+		};
+		float32x4_t Ground = vbslq_f32(IsInside, vld1q_f32(LaneGround), BaseHeight);
+
+		uint32x4_t IsFall = vceqq_f32(RippleTime, Zero);
+		float32x4_t FallY = vsubq_f32(Y, FallSpeed);
+		uint32x4_t IsWater = vcleq_f32(Ground, BaseHeight);
+		float32x4_t WaterLandHeight = vreinterpretq_f32_u32(vandq_u32(IsWater, vreinterpretq_u32_f32(LandHeight)));
+		uint32x4_t IsLand = vandq_u32(IsFall, vcleq_f32(FallY, vaddq_f32(Ground, WaterLandHeight)));
+		uint32x4_t IsLandWater = vandq_u32(IsLand, IsWater);
+		float32x4_t NextRippleTime = vaddq_f32(RippleTime, One);
+		uint32x4_t IsRespawn = vbicq_u32(vcgeq_f32(NextRippleTime, RippleEndTime), IsFall);
+
+		float32x4_t RespawnX = vaddq_f32(MinX, vmulq_f32(RangeX, Random[0]));
+		float32x4_t RespawnY = vaddq_f32(MinY, vmulq_f32(RangeY, Random[1]));
+		float32x4_t RespawnZ = vaddq_f32(MinZ, vmulq_f32(RangeZ, Random[2]));
+
+		float32x4_t NextY = vbslq_f32(IsRespawn, RespawnY, Y);
+		NextY = vbslq_f32(IsFall, FallY, NextY);
+		NextY = vbslq_f32(IsLand, vaddq_f32(Ground, SurfaceHeight), NextY);
+
+		float32x4_t NextRipple = vbslq_f32(vorrq_u32(IsFall, IsRespawn), Zero, NextRippleTime);
+		NextRipple = vbslq_f32(IsLand, One, NextRipple);
+
+		vst1q_f32(&_pPosX[i], vbslq_f32(IsRespawn, RespawnX, X));
+		vst1q_f32(&_pPosY[i], NextY);
+		vst1q_f32(&_pPosZ[i], vbslq_f32(IsRespawn, RespawnZ, Z));
+		vst1q_f32(&_pRippleTime[i], NextRipple);
+
+		unsigned int LaneMask[4];
+		vst1q_u32(LaneMask, IsLandWater);
+		if ((LaneMask[0] | LaneMask[1] | LaneMask[2] | LaneMask[3]) != 0)
+		{
+			float LaneX[4], LaneZ[4];
+			vst1q_f32(LaneX, X);
+			vst1q_f32(LaneZ, Z);
+			for (int j = 0; j < 4; j++)
+			{
+				_pLandedX[LandedNum] = LaneX[j];
+				_pLandedZ[LandedNum] = LaneZ[j];
+				LandedNum += LaneMask[j] & 1;
+			}
+		}
+	}
+
+	return LandedNum + UpdateScalar(
+		_pPosX + i, _pPosY + i, _pPosZ + i, _pRippleTime + i, _pSeed + i, _count - i,
+		_area, _grid, _pLandedX + LandedNum, _pLandedZ + LandedNum);
+}
+
+#else
+
+int RainParticles::UpdateNEON(
+	float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+	const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ)
+{
+	return UpdateScalar(_pPosX, _pPosY, _pPosZ, _pRippleTime, _pSeed, _count, _area, _grid, _pLandedX, _pLandedZ);
+}
+
+#endif // CPUFEATURE_NEON
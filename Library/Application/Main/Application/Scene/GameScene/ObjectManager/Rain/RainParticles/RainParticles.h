@@ -0,0 +1,305 @@
+﻿/**
+ * @file	RainParticles.h
+ * @brief	雨粒パーティクルの計算クラス定義
+ * @author	morimoto
+ */
+#ifndef RAINPARTICLES_H
+#define RAINPARTICLES_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+class ThreadPool;
+class RainOcclusionMap;
+
+
+/**
+ * 雨粒パーティクルの計算クラス
+ *
+ * 雨粒の座標と着水してからの時間を要素ごとの配列(SoA)で持ち, 落下と波紋の2つの状態を分岐無しで更新する.
+ * 着水してからの時間が0なら落下中で, 1以上なら波紋を出している(着水したフレームが1).
+ * 波紋が終わった雨粒は出現範囲の中のランダムな位置に戻る. 乱数は雨粒ごとのxorshiftで求めるので,
+ * 命令セットやスレッド数によらず同じ結果になる.
+ *
+ * 雨粒は遮蔽高さマップで求めた真下の高さに着水し, 屋根や地形などの上ではそこで波紋を出す.
+ * 着水した雨粒の座標は, 基準の高さ(水面)に着水したものだけを出力する.
+ *
+ * x, zが出現範囲の外にある雨粒は範囲の反対側へ回り込む(トーラス状に折り返す). 出現範囲をカメラに合わせて
+ * 毎フレーム動かせば, 雨粒は常にカメラの周りの箱の中に留まる.
+ *
+ * 雨粒はCHUNK_SIZE個ずつのチャンクに分け, スレッドプールが設定されていればチャンクごとに並列に更新する.
+ * 雨粒の数は実行中に変更できる(変更すると全ての雨粒を出現し直す).
+ */
+class RainParticles
+{
+public:
+	enum
+	{
+		CHUNK_SIZE = 8192	//!< 並列に更新する単位の雨粒の数.
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	RainParticles();
+
+	/**
+	 * デストラクタ
+	 */
+	~RainParticles();
+
+	/**
+	 * 並列に更新するためのスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元のスレッドだけで更新する)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool)
+	{
+		m_pThreadPool = _pThreadPool;
+	}
+
+	/**
+	 * 雨粒の数を設定し, 全ての雨粒を出現し直す
+	 * @param[in] _capacity 雨粒の数
+	 * @param[in] _seed 乱数の種
+	 */
+	void SetCapacity(int _capacity, unsigned int _seed);
+
+	/**
+	 * 雨粒の数を取得
+	 * @return 雨粒の数
+	 */
+	int GetCapacity() const
+	{
+		return m_Capacity;
+	}
+
+	/**
+	 * 雨粒が出現する範囲を設定(x, zはこの範囲の外に出ると反対側へ回り込む)
+	 * @param[in] _minX xの最小値
+	 * @param[in] _maxX xの最大値
+	 * @param[in] _minY yの最小値
+	 * @param[in] _maxY yの最大値
+	 * @param[in] _minZ zの最小値
+	 * @param[in] _maxZ zの最大値
+	 */
+	void SetSpawnArea(float _minX, float _maxX, float _minY, float _maxY, float _minZ, float _maxZ);
+
+	/**
+	 * 着水する高さを求める遮蔽高さマップを設定
+	 *
+	 * マップはBuildした後に設定し, 設定している間は作り直さないこと.
+	 * @param[in] _pOcclusionMap 遮蔽高さマップ(nullptrなら全て高さ0の水面に着水する)
+	 */
+	void SetOcclusionMap(const RainOcclusionMap* _pOcclusionMap)
+	{
+		m_pOcclusionMap = _pOcclusionMap;
+	}
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 使用する命令セットを取得
+	 * @return 命令セット
+	 */
+	CpuFeature::SIMD_TYPE GetSimdType() const
+	{
+		return m_SimdType;
+	}
+
+	/**
+	 * 1フレーム分更新する
+	 */
+	void Update();
+
+	/**
+	 * 雨粒のx座標の配列を取得
+	 * @return x座標の配列(GetCapacity個)
+	 */
+	const float* GetPosX() const
+	{
+		return m_PosX.data();
+	}
+
+	/**
+	 * 雨粒のy座標の配列を取得
+	 * @return y座標の配列(GetCapacity個)
+	 */
+	const float* GetPosY() const
+	{
+		return m_PosY.data();
+	}
+
+	/**
+	 * 雨粒のz座標の配列を取得
+	 * @return z座標の配列(GetCapacity個)
+	 */
+	const float* GetPosZ() const
+	{
+		return m_PosZ.data();
+	}
+
+	/**
+	 * 雨粒の着水してからの時間の配列を取得
+	 * @return 着水してからのフレーム数の配列(0なら落下中)
+	 */
+	const float* GetRippleTime() const
+	{
+		return m_RippleTime.data();
+	}
+
+	/**
+	 * 直前のUpdateで水面に着水した雨粒の数を取得
+	 * @return 着水した雨粒の数
+	 */
+	int GetLandedNum() const
+	{
+		return m_LandedNum;
+	}
+
+	/**
+	 * 直前のUpdateで着水した雨粒のx座標の配列を取得
+	 * @return x座標の配列(GetLandedNum個)
+	 */
+	const float* GetLandedX() const
+	{
+		return m_LandedX.data();
+	}
+
+	/**
+	 * 直前のUpdateで着水した雨粒のz座標の配列を取得
+	 * @return z座標の配列(GetLandedNum個)
+	 */
+	const float* GetLandedZ() const
+	{
+		return m_LandedZ.data();
+	}
+
+	/**
+	 * 波紋の大きさを取得
+	 * @param[in] _rippleTime 着水してからのフレーム数(1以上)
+	 * @return 波紋の大きさ
+	 */
+	static float GetRippleScale(float _rippleTime)
+	{
+		return m_RippleStartScale + m_RippleScaleSpeed * (_rippleTime - 1.0f);
+	}
+
+	static const float m_FallSpeed;			//!< 1フレームの落下距離.
+	static const float m_LandHeight;		//!< 水面に着水する高さ(水面の高さからの差, 屋根や地形の上では表面で着水する).
+	static const float m_SurfaceHeight;		//!< 波紋を出す高さ(真下の高さからの差).
+	static const float m_RippleEndTime;		//!< 波紋が終わる着水してからのフレーム数.
+	static const float m_RippleStartScale;	//!< 着水した時の波紋の大きさ.
+	static const float m_RippleScaleSpeed;	//!< 1フレームに波紋が広がる大きさ.
+
+private:
+	/**
+	 * 出現範囲の構造体
+	 */
+	struct AREA
+	{
+		float MinX;			//!< xの最小値.
+		float RangeX;		//!< xの範囲の大きさ.
+		float InvRangeX;	//!< xの範囲の大きさの逆数(大きさが0なら0).
+		float MinY;			//!< yの最小値.
+		float RangeY;		//!< yの範囲の大きさ.
+		float MinZ;			//!< zの最小値.
+		float RangeZ;		//!< zの範囲の大きさ.
+		float InvRangeZ;	//!< zの範囲の大きさの逆数(大きさが0なら0).
+	};
+
+	/**
+	 * 更新関数が参照する遮蔽高さの格子の構造体
+	 */
+	struct GRID
+	{
+		const float*	pHeight;		//!< 高さの格子.
+		int				CellNumX;		//!< x方向のセルの数.
+		float			MinX;			//!< 格子の左端のx座標.
+		float			MaxZ;			//!< 格子の上端のz座標.
+		float			InvCellWidth;	//!< x方向の1セルの大きさの逆数.
+		float			InvCellDepth;	//!< z方向の1セルの大きさの逆数.
+		float			SizeX;			//!< x方向のセルの数.
+		float			SizeY;			//!< z方向のセルの数.
+		float			MaxCellX;		//!< xのセル座標の最大値(SizeX - 1).
+		float			MaxCellY;		//!< zのセル座標の最大値(SizeY - 1).
+		float			BaseHeight;		//!< 格子の外の高さ.
+	};
+
+	/**
+	 * 更新関数の型
+	 * @return 着水した雨粒の数(着水した雨粒のx, z座標は_pLandedX, _pLandedZの先頭から書き込む)
+	 */
+	typedef int(*UPDATE_FUNC)(
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+		const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ);
+
+	/**
+	 * 命令セットに対応した更新関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 更新関数
+	 */
+	static UPDATE_FUNC GetUpdateFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 雨粒の更新(スカラー版)
+	 */
+	static int UpdateScalar(
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+		const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ);
+
+	/**
+	 * 雨粒の更新(SSE2版)
+	 */
+	static int UpdateSSE(
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+		const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ);
+
+	/**
+	 * 雨粒の更新(AVX2版)
+	 */
+	static int UpdateAVX2(
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+		const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ);
+
+	/**
+	 * 雨粒の更新(NEON版)
+	 */
+	static int UpdateNEON(
+		float* _pPosX, float* _pPosY, float* _pPosZ, float* _pRippleTime, unsigned int* _pSeed, int _count,
+		const AREA& _area, const GRID& _grid, float* _pLandedX, float* _pLandedZ);
+
+
+	static const float m_RandomScale;	//!< 24bitの乱数を0～1にする倍率.
+
+	ThreadPool*					m_pThreadPool;		//!< 並列に更新するためのスレッドプール.
+	const RainOcclusionMap*		m_pOcclusionMap;	//!< 着水する高さを求める遮蔽高さマップ.
+	float						m_FlatHeight;		//!< 遮蔽高さマップが無い場合に参照する高さ.
+	CpuFeature::SIMD_TYPE		m_SimdType;			//!< 使用する命令セット.
+	AREA						m_Area;				//!< 雨粒が出現する範囲.
+	int							m_Capacity;			//!< 雨粒の数.
+	std::vector<float>			m_PosX;				//!< 雨粒のx座標.
+	std::vector<float>			m_PosY;				//!< 雨粒のy座標.
+	std::vector<float>			m_PosZ;				//!< 雨粒のz座標.
+	std::vector<float>			m_RippleTime;		//!< 雨粒の着水してからのフレーム数(0なら落下中).
+	std::vector<unsigned int>	m_Seed;				//!< 雨粒ごとの乱数の状態.
+	std::vector<float>			m_LandedX;			//!< 着水した雨粒のx座標(チャンクごとの領域に書き込んでから詰める).
+	std::vector<float>			m_LandedZ;			//!< 着水した雨粒のz座標.
+	std::vector<int>			m_ChunkLandedNum;	//!< チャンクごとの着水した雨粒の数.
+	int							m_LandedNum;		//!< 着水した雨粒の数.
+
+};
+
+
+#endif // !RAINPARTICLES_H
@@ -0,0 +1,191 @@
+﻿/**
+ * @file	CubeFaceScheduler.cpp
+ * @brief	キューブマップの面の更新スケジューラクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "CubeFaceScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Main\Application\Scene\GameScene\Task\CubeMapDrawTask\CubeFaceCuller\CubeFaceCuller.h"
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const int CubeFaceScheduler::m_DefaultFaceBudget = 2;
+const float CubeFaceScheduler::m_DefaultFacingWeight = 3.0f;
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const float CubeFaceScheduler::m_FaceDir[FACE_NUM][3] =
+{
+	{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+};
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+CubeFaceScheduler::CubeFaceScheduler() :
+	m_IsEnable(true),
+	m_FaceBudget(m_DefaultFaceBudget),
+	m_FacingWeight(m_DefaultFacingWeight),
+	m_FaceMask(0)
+{
+	m_ViewDir[0] = 0.0f;
+	m_ViewDir[1] = 0.0f;
+	m_ViewDir[2] = 1.0f;
+
+	// 最初は全ての面を描画する.
+	for (int i = 0; i < FACE_NUM; i++)
+	{
+		m_Staleness[i] = 0;
+		m_IsDirty[i] = true;
+	}
+}
+
+CubeFaceScheduler::~CubeFaceScheduler()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void CubeFaceScheduler::SetIsEnable(bool _isEnable)
+{
+	// 無効にしている間は面を更新しないので, 戻したら全ての面を描画し直す.
+	if (_isEnable && !m_IsEnable)
+	{
+		InvalidateAll();
+	}
+
+	m_IsEnable = _isEnable;
+}
+
+void CubeFaceScheduler::SetFaceBudget(int _faceBudget)
+{
+	m_FaceBudget = std::min(std::max(_faceBudget, 1), static_cast<int>(FACE_NUM));
+}
+
+void CubeFaceScheduler::SetViewDir(float _x, float _y, float _z)
+{
+	float Length = std::sqrt(_x * _x + _y * _y + _z * _z);
+	if (Length <= 0.0f)
+	{
+		return;
+	}
+
+	m_ViewDir[0] = _x / Length;
+	m_ViewDir[1] = _y / Length;
+	m_ViewDir[2] = _z / Length;
+}
+
+void CubeFaceScheduler::Invalidate(int _face)
+{
+	if (_face >= 0 && _face < FACE_NUM)
+	{
+		m_IsDirty[_face] = true;
+	}
+}
+
+void CubeFaceScheduler::InvalidateAll()
+{
+	for (int i = 0; i < FACE_NUM; i++)
+	{
+		m_IsDirty[i] = true;
+	}
+}
+
+void CubeFaceScheduler::InvalidateSphere(float _x, float _y, float _z, float _radius)
+{
+	CubeFaceCuller Culler;
+	unsigned int FaceMask = Culler.GetSphereFaceMask(_x, _y, _z, _radius);
+
+	for (int i = 0; i < FACE_NUM; i++)
+	{
+		if ((FaceMask & (1u << i)) != 0)
+		{
+			m_IsDirty[i] = true;
+		}
+	}
+}
+
+unsigned int CubeFaceScheduler::Schedule()
+{
+	if (!m_IsEnable)
+	{
+		m_FaceMask = 0;
+		return m_FaceMask;
+	}
+
+	for (int i = 0; i < FACE_NUM; i++)
+	{
+		m_Staleness[i]++;
+	}
+
+	// 予算の数だけ優先度の高い面を選ぶ(同じ優先度ならインデックスの小さい面).
+	m_FaceMask = 0;
+	for (int i = 0; i < m_FaceBudget; i++)
+	{
+		int BestFace = -1;
+		float BestPriority = 0.0f;
+
+		for (int j = 0; j < FACE_NUM; j++)
+		{
+			if ((m_FaceMask & (1u << j)) != 0)
+			{
+				continue;
+			}
+
+			float Priority = GetPriority(j);
+			if (BestFace < 0 || Priority > BestPriority)
+			{
+				BestFace = j;
+				BestPriority = Priority;
+			}
+		}
+
+		m_FaceMask |= 1u << BestFace;
+	}
+
+	for (int i = 0; i < FACE_NUM; i++)
+	{
+		if ((m_FaceMask & (1u << i)) != 0)
+		{
+			m_Staleness[i] = 0;
+			m_IsDirty[i] = false;
+		}
+	}
+
+	return m_FaceMask;
+}
+
+int CubeFaceScheduler::GetMaxStaleness() const
+{
+	return *std::max_element(m_Staleness, m_Staleness + FACE_NUM);
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+float CubeFaceScheduler::GetPriority(int _face) const
+{
+	float Facing = std::max(
+		m_ViewDir[0] * m_FaceDir[_face][0] + m_ViewDir[1] * m_FaceDir[_face][1] + m_ViewDir[2] * m_FaceDir[_face][2],
+		0.0f);
+
+	float Priority = static_cast<float>(m_Staleness[_face]) * (1.0f + m_FacingWeight * Facing);
+
+	// 無効化された面はどの面よりも先に選ぶ.
+	return m_IsDirty[_face] ? Priority + 1.0e+6f : Priority;
+}
@@ -0,0 +1,164 @@
+﻿/**
+ * @file	CubeFaceScheduler.h
+ * @brief	キューブマップの面の更新スケジューラクラス定義
+ * @author	morimoto
+ */
+#ifndef CUBEFACESCHEDULER_H
+#define CUBEFACESCHEDULER_H
+
+
+/**
+ * キューブマップの面の更新スケジューラクラス
+ *
+ * キューブマップの6面を毎フレーム全て描画し直す代わりに, 1フレームに描画する面の数(予算)を決めて,
+ * 優先度の高い面から予算の数だけ選ぶ.
+ * 優先度は最後に描画してからのフレーム数(古さ)に, 視線の向きに近い面ほど大きな倍率を掛けたもので,
+ * 視線と関係の無い面も古くなれば選ばれるので, 全ての面が順番に更新される.
+ * 無効化された面は優先度に関係なく先に選ばれる.
+ * 無効にしている間はどの面も選ばず古さも進めないので, 有効に戻したら全ての面を描画し直す.
+ *
+ * 面の順番はD3D11のキューブマップの配列の順番(+X, -X, +Y, -Y, +Z, -Z)で,
+ * 座標はキューブマップを描画する位置を原点とする.
+ */
+class CubeFaceScheduler
+{
+public:
+	enum
+	{
+		FACE_NUM = 6	//!< キューブマップの面の数.
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	CubeFaceScheduler();
+
+	/**
+	 * デストラクタ
+	 */
+	~CubeFaceScheduler();
+
+	/**
+	 * 1フレームに描画する面の数を設定
+	 * @param[in] _faceBudget 1フレームに描画する面の数(1～6)
+	 */
+	void SetFaceBudget(int _faceBudget);
+
+	/**
+	 * 1フレームに描画する面の数を取得
+	 * @return 1フレームに描画する面の数
+	 */
+	int GetFaceBudget() const
+	{
+		return m_FaceBudget;
+	}
+
+	/**
+	 * 面の更新を有効にするかを設定
+	 * @param[in] _isEnable 有効にするか(無効から有効に戻すと全ての面を無効化する)
+	 */
+	void SetIsEnable(bool _isEnable);
+
+	/**
+	 * 面の更新が有効か
+	 * @return 有効ならtrue
+	 */
+	bool IsEnable() const
+	{
+		return m_IsEnable;
+	}
+
+	/**
+	 * 視線の向きに近い面の優先度の倍率を設定
+	 * @param[in] _facingWeight 視線と同じ向きの面の優先度に加える倍率(0なら向きを考慮しない)
+	 */
+	void SetFacingWeight(float _facingWeight)
+	{
+		m_FacingWeight = _facingWeight;
+	}
+
+	/**
+	 * 視線の向きを設定(正規化しなくてよい)
+	 * @param[in] _x 視線の向きのx
+	 * @param[in] _y 視線の向きのy
+	 * @param[in] _z 視線の向きのz
+	 */
+	void SetViewDir(float _x, float _y, float _z);
+
+	/**
+	 * 面を無効化する(次のScheduleで優先して選ばれる)
+	 * @param[in] _face 面のインデックス
+	 */
+	void Invalidate(int _face);
+
+	/**
+	 * 全ての面を無効化する
+	 */
+	void InvalidateAll();
+
+	/**
+	 * 球が写る面を無効化する
+	 * @param[in] _x 球の中心のx
+	 * @param[in] _y 球の中心のy
+	 * @param[in] _z 球の中心のz
+	 * @param[in] _radius 球の半径
+	 */
+	void InvalidateSphere(float _x, float _y, float _z, float _radius);
+
+	/**
+	 * 1フレーム進めて, このフレームで描画する面を選ぶ
+	 * @return 描画する面のビットマスク(ビットiが面i, 無効なら0)
+	 */
+	unsigned int Schedule();
+
+	/**
+	 * 直前のScheduleで選んだ面のビットマスクを取得
+	 * @return 描画する面のビットマスク
+	 */
+	unsigned int GetFaceMask() const
+	{
+		return m_FaceMask;
+	}
+
+	/**
+	 * 面の古さを取得
+	 * @param[in] _face 面のインデックス
+	 * @return 最後に描画してからのフレーム数(このフレームで描画するなら0)
+	 */
+	int GetStaleness(int _face) const
+	{
+		return m_Staleness[_face];
+	}
+
+	/**
+	 * 全ての面の中で最も古い面の古さを取得
+	 * @return 最後に描画してからのフレーム数の最大値
+	 */
+	int GetMaxStaleness() const;
+
+	static const int m_DefaultFaceBudget;		//!< 1フレームに描画する面の数の初期値.
+	static const float m_DefaultFacingWeight;	//!< 視線の向きに近い面の優先度の倍率の初期値.
+
+private:
+	/**
+	 * 面の優先度を取得
+	 * @param[in] _face 面のインデックス
+	 * @return 優先度
+	 */
+	float GetPriority(int _face) const;
+
+
+	static const float m_FaceDir[FACE_NUM][3];	//!< 面の向き.
+
+	bool			m_IsEnable;				//!< 面の更新が有効か.
+	int				m_FaceBudget;			//!< 1フレームに描画する面の数.
+	float			m_FacingWeight;			//!< 視線の向きに近い面の優先度の倍率.
+	float			m_ViewDir[3];			//!< 正規化した視線の向き.
+	int				m_Staleness[FACE_NUM];	//!< 面ごとの最後に描画してからのフレーム数.
+	bool			m_IsDirty[FACE_NUM];	//!< 面が無効化されているか.
+	unsigned int	m_FaceMask;				//!< 直前に選んだ面のビットマスク.
+
+};
+
+
+#endif // !CUBEFACESCHEDULER_H
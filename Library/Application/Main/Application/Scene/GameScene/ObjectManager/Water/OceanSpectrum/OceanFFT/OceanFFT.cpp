@@ -0,0 +1,597 @@
+﻿/**
+ * @file	OceanFFT.cpp
+ * @brief	2次元高速フーリエ変換クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "OceanFFT.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Main\ThreadPool\ThreadPool.h"
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+OceanFFT::OceanFFT(int _size) :
+	m_Size(_size),
+	m_LogSize(0),
+	m_pThreadPool(nullptr),
+	m_SimdType(CpuFeature::GetSimdType())
+{
+}
+
+OceanFFT::~OceanFFT()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool OceanFFT::Initialize()
+{
+	// 帯の列数がSIMDの幅の倍数になるように16以上に限る.
+	if (m_Size < 16 || (m_Size & (m_Size - 1)) != 0)
+	{
+		return false;
+	}
+
+	m_LogSize = 0;
+	while ((1 << m_LogSize) < m_Size)
+	{
+		m_LogSize++;
+	}
+
+	const double Pi = 3.14159265358979323846;
+	m_Cos.resize(m_Size / 2);
+	m_Sin.resize(m_Size / 2);
+	for (int i = 0; i < m_Size / 2; i++)
+	{
+		double Angle = 2.0 * Pi * static_cast<double>(i) / static_cast<double>(m_Size);
+		m_Cos[i] = static_cast<float>(std::cos(Angle));
+		m_Sin[i] = static_cast<float>(std::sin(Angle));
+	}
+
+	m_BitReverse.resize(m_Size);
+	for (int i = 0; i < m_Size; i++)
+	{
+		int Reverse = 0;
+		for (int j = 0; j < m_LogSize; j++)
+		{
+			Reverse |= ((i >> j) & 1) << (m_LogSize - 1 - j);
+		}
+		m_BitReverse[i] = Reverse;
+	}
+
+	m_WorkReal.assign(m_Size * m_Size, 0.0f);
+	m_WorkImag.assign(m_Size * m_Size, 0.0f);
+
+	return true;
+}
+
+void OceanFFT::Finalize()
+{
+	std::vector<float>().swap(m_Cos);
+	std::vector<float>().swap(m_Sin);
+	std::vector<int>().swap(m_BitReverse);
+	std::vector<float>().swap(m_WorkReal);
+	std::vector<float>().swap(m_WorkImag);
+}
+
+void OceanFFT::Inverse2D(float* _pReal, float* _pImag)
+{
+	// 列方向に変換してから転置し, もう一度列方向に変換すれば行方向の変換になる.
+	TransformColumn(_pReal, _pImag);
+	Transpose(_pReal, &m_WorkReal[0]);
+	Transpose(_pImag, &m_WorkImag[0]);
+	TransformColumn(&m_WorkReal[0], &m_WorkImag[0]);
+	Transpose(&m_WorkReal[0], _pReal);
+	Transpose(&m_WorkImag[0], _pImag);
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void OceanFFT::TransformColumn(float* _pReal, float* _pImag)
+{
+	int ColumnNum = std::min(static_cast<int>(STRIP_COLUMN_NUM), m_Size);
+	int StripNum = m_Size / ColumnNum;
+
+	PARAM Param;
+	Param.Size = m_Size;
+	Param.LogSize = m_LogSize;
+	Param.Stride = m_Size;
+	Param.ColumnNum = ColumnNum;
+	Param.pCos = &m_Cos[0];
+	Param.pSin = &m_Sin[0];
+
+	COLUMN_FUNC pColumnFunc = GetColumnFunc(m_SimdType);
+	auto TransformStrip = [this, _pReal, _pImag, &Param, pColumnFunc](int _strip)
+	{
+		float* pReal = _pReal + _strip * Param.ColumnNum;
+		float* pImag = _pImag + _strip * Param.ColumnNum;
+
+		// 行をビット反転の順に並べ替えてから, 順番通りに並ぶバタフライで計算する.
+		for (int i = 0; i < m_Size; i++)
+		{
+			int j = m_BitReverse[i];
+			if (i < j)
+			{
+				std::swap_ranges(pReal + i * m_Size, pReal + i * m_Size + Param.ColumnNum, pReal + j * m_Size);
+				std::swap_ranges(pImag + i * m_Size, pImag + i * m_Size + Param.ColumnNum, pImag + j * m_Size);
+			}
+		}
+
+		pColumnFunc(Param, pReal, pImag);
+	};
+
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelFor(StripNum, TransformStrip);
+	}
+	else
+	{
+		for (int i = 0; i < StripNum; i++)
+		{
+			TransformStrip(i);
+		}
+	}
+}
+
+void OceanFFT::Transpose(const float* _pSrc, float* _pDest)
+{
+	// キャッシュに収まるブロック単位で転置する.
+	const int BlockSize = 16;
+	int BlockNum = m_Size / BlockSize;
+
+	auto TransposeRows = [this, _pSrc, _pDest, BlockSize, BlockNum](int _blockY)
+	{
+		for (int BlockX = 0; BlockX < BlockNum; BlockX++)
+		{
+			for (int y = _blockY * BlockSize; y < (_blockY + 1) * BlockSize; y++)
+			{
+				for (int x = BlockX * BlockSize; x < (BlockX + 1) * BlockSize; x++)
+				{
+					_pDest[x * m_Size + y] = _pSrc[y * m_Size + x];
+				}
+			}
+		}
+	};
+
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelFor(BlockNum, TransposeRows);
+	}
+	else
+	{
+		for (int i = 0; i < BlockNum; i++)
+		{
+			TransposeRows(i);
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+OceanFFT::COLUMN_FUNC OceanFFT::GetColumnFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &ColumnAVX2;
+	case CpuFeature::SIMD_SSE:	return &ColumnSSE;
+	case CpuFeature::SIMD_NEON:	return &ColumnNEON;
+	default:					return &ColumnScalar;
+	}
+}
+
+void OceanFFT::ColumnScalar(const PARAM& _param, float* _pReal, float* _pImag)
+{
+	int Span = 1;
+
+	// log2(N)が奇数なら最初の1ステージだけ基数2で計算する(回転因子は1).
+	if ((_param.LogSize & 1) != 0)
+	{
+		for (int Row = 0; Row < _param.Size; Row += 2)
+		{
+			float* pR0 = _pReal + Row * _param.Stride;
+			float* pI0 = _pImag + Row * _param.Stride;
+			float* pR1 = pR0 + _param.Stride;
+			float* pI1 = pI0 + _param.Stride;
+
+			for (int c = 0; c < _param.ColumnNum; c++)
+			{
+				float R0 = pR0[c];
+				float I0 = pI0[c];
+				pR0[c] = R0 + pR1[c];
+				pI0[c] = I0 + pI1[c];
+				pR1[c] = R0 - pR1[c];
+				pI1[c] = I0 - pI1[c];
+			}
+		}
+
+		Span = 2;
+	}
+
+	// 間隔Spanと2Spanの2ステージを基数4のバタフライでまとめて計算する.
+	for (; Span * 4 <= _param.Size; Span *= 4)
+	{
+		int StepA = _param.Size / (Span * 2);
+		int StepB = _param.Size / (Span * 4);
+
+		for (int Group = 0; Group < _param.Size; Group += Span * 4)
+		{
+			for (int k = 0; k < Span; k++)
+			{
+				float WAr = _param.pCos[k * StepA];
+				float WAi = _param.pSin[k * StepA];
+				float WBr = _param.pCos[k * StepB];
+				float WBi = _param.pSin[k * StepB];
+
+				float* pR0 = _pReal + (Group + k) * _param.Stride;
+				float* pI0 = _pImag + (Group + k) * _param.Stride;
+				float* pR1 = pR0 + Span * _param.Stride;
+				float* pI1 = pI0 + Span * _param.Stride;
+				float* pR2 = pR1 + Span * _param.Stride;
+				float* pI2 = pI1 + Span * _param.Stride;
+				float* pR3 = pR2 + Span * _param.Stride;
+				float* pI3 = pI2 + Span * _param.Stride;
+
+				for (int c = 0; c < _param.ColumnNum; c++)
+				{
+					// 1段目(間隔Span).
+					float T1r = pR1[c] * WAr - pI1[c] * WAi;
+					float T1i = pR1[c] * WAi + pI1[c] * WAr;
+					float T3r = pR3[c] * WAr - pI3[c] * WAi;
+					float T3i = pR3[c] * WAi + pI3[c] * WAr;
+					float A0r = pR0[c] + T1r;
+					float A0i = pI0[c] + T1i;
+					float A1r = pR0[c] - T1r;
+					float A1i = pI0[c] - T1i;
+					float A2r = pR2[c] + T3r;
+					float A2i = pI2[c] + T3i;
+					float A3r = pR2[c] - T3r;
+					float A3i = pI2[c] - T3i;
+
+					// 2段目(間隔2Span). k + Spanの回転因子はkの回転因子にiを掛けたものになる.
+					float U2r = A2r * WBr - A2i * WBi;
+					float U2i = A2r * WBi + A2i * WBr;
+					float U3r = A3r * WBr - A3i * WBi;
+					float U3i = A3r * WBi + A3i * WBr;
+
+					pR0[c] = A0r + U2r;
+					pI0[c] = A0i + U2i;
+					pR2[c] = A0r - U2r;
+					pI2[c] = A0i - U2i;
+					pR1[c] = A1r - U3i;
+					pI1[c] = A1i + U3r;
+					pR3[c] = A1r + U3i;
+					pI3[c] = A1i - U3r;
+				}
+			}
+		}
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void OceanFFT::ColumnSSE(const PARAM& _param, float* _pReal, float* _pImag)
+{
+	int Span = 1;
+
+	if ((_param.LogSize & 1) != 0)
+	{
+		for (int Row = 0; Row < _param.Size; Row += 2)
+		{
+			float* pR0 = _pReal + Row * _param.Stride;
+			float* pI0 = _pImag + Row * _param.Stride;
+			float* pR1 = pR0 + _param.Stride;
+			float* pI1 = pI0 + _param.Stride;
+
+			for (int c = 0; c < _param.ColumnNum; c += 4)
+			{
+				__m128 R0 = _mm_loadu_ps(pR0 + c);
+				__m128 I0 = _mm_loadu_ps(pI0 + c);
+				__m128 R1 = _mm_loadu_ps(pR1 + c);
+				__m128 I1 = _mm_loadu_ps(pI1 + c);
+				_mm_storeu_ps(pR0 + c, _mm_add_ps(R0, R1));
+				_mm_storeu_ps(pI0 + c, _mm_add_ps(I0, I1));
+				_mm_storeu_ps(pR1 + c, _mm_sub_ps(R0, R1));
+				_mm_storeu_ps(pI1 + c, _mm_sub_ps(I0, I1));
+			}
+		}
+
+		Span = 2;
+	}
+
+	for (; Span * 4 <= _param.Size; Span *= 4)
+	{
+		int StepA = _param.Size / (Span * 2);
+		int StepB = _param.Size / (Span * 4);
+
+		for (int Group = 0; Group < _param.Size; Group += Span * 4)
+		{
+			for (int k = 0; k < Span; k++)
+			{
+				// 回転因子は全ての列で同じなのでレーンに複製する.
+				__m128 WAr = _mm_set1_ps(_param.pCos[k * StepA]);
+				__m128 WAi = _mm_set1_ps(_param.pSin[k * StepA]);
+				__m128 WBr = _mm_set1_ps(_param.pCos[k * StepB]);
+				__m128 WBi = _mm_set1_ps(_param.pSin[k * StepB]);
+
+				float* pR0 = _pReal + (Group + k) * _param.Stride;
+				float* pI0 = _pImag + (Group + k) * _param.Stride;
+				float* pR1 = pR0 + Span * _param.Stride;
+				float* pI1 = pI0 + Span * _param.Stride;
+				float* pR2 = pR1 + Span * _param.Stride;
+				float* pI2 = pI1 + Span * _param.Stride;
+				float* pR3 = pR2 + Span * _param.Stride;
+				float* pI3 = pI2 + Span * _param.Stride;
+
+				for (int c = 0; c < _param.ColumnNum; c += 4)
+				{
+					__m128 R0 = _mm_loadu_ps(pR0 + c);
+					__m128 I0 = _mm_loadu_ps(pI0 + c);
+					__m128 R1 = _mm_loadu_ps(pR1 + c);
+					__m128 I1 = _mm_loadu_ps(pI1 + c);
+					__m128 R2 = _mm_loadu_ps(pR2 + c);
+					__m128 I2 = _mm_loadu_ps(pI2 + c);
+					__m128 R3 = _mm_loadu_ps(pR3 + c);
+					__m128 I3 = _mm_loadu_ps(pI3 + c);
+
+					__m128 T1r = _mm_sub_ps(_mm_mul_ps(R1, WAr), _mm_mul_ps(I1, WAi));
+					__m128 T1i = _mm_add_ps(_mm_mul_ps(R1, WAi), _mm_mul_ps(I1, WAr));
+					__m128 T3r = _mm_sub_ps(_mm_mul_ps(R3, WAr), _mm_mul_ps(I3, WAi));
+					__m128 T3i = _mm_add_ps(_mm_mul_ps(R3, WAi), _mm_mul_ps(I3, WAr));
+					__m128 A0r = _mm_add_ps(R0, T1r);
+					__m128 A0i = _mm_add_ps(I0, T1i);
+					__m128 A1r = _mm_sub_ps(R0, T1r);
+					__m128 A1i = _mm_sub_ps(I0, T1i);
+					__m128 A2r = _mm_add_ps(R2, T3r);
+					__m128 A2i = _mm_add_ps(I2, T3i);
+					__m128 A3r = _mm_sub_ps(R2, T3r);
+					__m128 A3i = _mm_sub_ps(I2, T3i);
+
+					__m128 U2r = _mm_sub_ps(_mm_mul_ps(A2r, WBr), _mm_mul_ps(A2i, WBi));
+					__m128 U2i = _mm_add_ps(_mm_mul_ps(A2r, WBi), _mm_mul_ps(A2i, WBr));
+					__m128 U3r = _mm_sub_ps(_mm_mul_ps(A3r, WBr), _mm_mul_ps(A3i, WBi));
+					__m128 U3i = _mm_add_ps(_mm_mul_ps(A3r, WBi), _mm_mul_ps(A3i, WBr));
+
+					_mm_storeu_ps(pR0 + c, _mm_add_ps(A0r, U2r));
+					_mm_storeu_ps(pI0 + c, _mm_add_ps(A0i, U2i));
+					_mm_storeu_ps(pR2 + c, _mm_sub_ps(A0r, U2r));
+					_mm_storeu_ps(pI2 + c, _mm_sub_ps(A0i, U2i));
+					_mm_storeu_ps(pR1 + c, _mm_sub_ps(A1r, U3i));
+					_mm_storeu_ps(pI1 + c, _mm_add_ps(A1i, U3r));
+					_mm_storeu_ps(pR3 + c, _mm_add_ps(A1r, U3i));
+					_mm_storeu_ps(pI3 + c, _mm_sub_ps(A1i, U3r));
+				}
+			}
+		}
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void OceanFFT::ColumnAVX2(const PARAM& _param, float* _pReal, float* _pImag)
+{
+	int Span = 1;
+
+	if ((_param.LogSize & 1) != 0)
+	{
+		for (int Row = 0; Row < _param.Size; Row += 2)
+		{
+			float* pR0 = _pReal + Row * _param.Stride;
+			float* pI0 = _pImag + Row * _param.Stride;
+			float* pR1 = pR0 + _param.Stride;
+			float* pI1 = pI0 + _param.Stride;
+
+			for (int c = 0; c < _param.ColumnNum; c += 8)
+			{
+				__m256 R0 = _mm256_loadu_ps(pR0 + c);
+				__m256 I0 = _mm256_loadu_ps(pI0 + c);
+				__m256 R1 = _mm256_loadu_ps(pR1 + c);
+				__m256 I1 = _mm256_loadu_ps(pI1 + c);
+				_mm256_storeu_ps(pR0 + c, _mm256_add_ps(R0, R1));
+				_mm256_storeu_ps(pI0 + c, _mm256_add_ps(I0, I1));
+				_mm256_storeu_ps(pR1 + c, _mm256_sub_ps(R0, R1));
+				_mm256_storeu_ps(pI1 + c, _mm256_sub_ps(I0, I1));
+			}
+		}
+
+		Span = 2;
+	}
+
+	for (; Span * 4 <= _param.Size; Span *= 4)
+	{
+		int StepA = _param.Size / (Span * 2);
+		int StepB = _param.Size / (Span * 4);
+
+		for (int Group = 0; Group < _param.Size; Group += Span * 4)
+		{
+			for (int k = 0; k < Span; k++)
+			{
+				__m256 WAr = _mm256_set1_ps(_param.pCos[k * StepA]);
+				__m256 WAi = _mm256_set1_ps(_param.pSin[k * StepA]);
+				__m256 WBr = _mm256_set1_ps(_param.pCos[k * StepB]);
+				__m256 WBi = _mm256_set1_ps(_param.pSin[k * StepB]);
+
+				float* pR0 = _pReal + (Group + k) * _param.Stride;
+				float* pI0 = _pImag + (Group + k) * _param.Stride;
+				float* pR1 = pR0 + Span * _param.Stride;
+				float* pI1 = pI0 + Span * _param.Stride;
+				float* pR2 = pR1 + Span * _param.Stride;
+				float* pI2 = pI1 + Span * _param.Stride;
+				float* pR3 = pR2 + Span * _param.Stride;
+				float* pI3 = pI2 + Span * _param.Stride;
+
+				for (int c = 0; c < _param.ColumnNum; c += 8)
+				{
+					__m256 R0 = _mm256_loadu_ps(pR0 + c);
+					__m256 I0 = _mm256_loadu_ps(pI0 + c);
+					__m256 R1 = _mm256_loadu_ps(pR1 + c);
+					__m256 I1 = _mm256_loadu_ps(pI1 + c);
+					__m256 R2 = _mm256_loadu_ps(pR2 + c);
+					__m256 I2 = _mm256_loadu_ps(pI2 + c);
+					__m256 R3 = _mm256_loadu_ps(pR3 + c);
+					__m256 I3 = _mm256_loadu_ps(pI3 + c);
+
+					__m256 T1r = _mm256_sub_ps(_mm256_mul_ps(R1, WAr), _mm256_mul_ps(I1, WAi));
+					__m256 T1i = _mm256_add_ps(_mm256_mul_ps(R1, WAi), _mm256_mul_ps(I1, WAr));
+					__m256 T3r = _mm256_sub_ps(_mm256_mul_ps(R3, WAr), _mm256_mul_ps(I3, WAi));
+					__m256 T3i = _mm256_add_ps(_mm256_mul_ps(R3, WAi), _mm256_mul_ps(I3, WAr));
+					__m256 A0r = _mm256_add_ps(R0, T1r);
+					__m256 A0i = _mm256_add_ps(I0, T1i);
+					__m256 A1r = _mm256_sub_ps(R0, T1r);
+					__m256 A1i = _mm256_sub_ps(I0, T1i);
+					__m256 A2r = _mm256_add_ps(R2, T3r);
+					__m256 A2i = _mm256_add_ps(I2, T3i);
+					__m256 A3r = _mm256_sub_ps(R2, T3r);
+					__m256 A3i = _mm256_sub_ps(I2, T3i);
+
+					__m256 U2r = _mm256_sub_ps(_mm256_mul_ps(A2r, WBr), _mm256_mul_ps(A2i, WBi));
+					__m256 U2i = _mm256_add_ps(_mm256_mul_ps(A2r, WBi), _mm256_mul_ps(A2i, WBr));
+					__m256 U3r = _mm256_sub_ps(_mm256_mul_ps(A3r, WBr), _mm256_mul_ps(A3i, WBi));
+					__m256 U3i = _mm256_add_ps(_mm256_mul_ps(A3r, WBi), _mm256_mul_ps(A3i, WBr));
+
+					_mm256_storeu_ps(pR0 + c, _mm256_add_ps(A0r, U2r));
+					_mm256_storeu_ps(pI0 + c, _mm256_add_ps(A0i, U2i));
+					_mm256_storeu_ps(pR2 + c, _mm256_sub_ps(A0r, U2r));
+					_mm256_storeu_ps(pI2 + c, _mm256_sub_ps(A0i, U2i));
+					_mm256_storeu_ps(pR1 + c, _mm256_sub_ps(A1r, U3i));
+					_mm256_storeu_ps(pI1 + c, _mm256_add_ps(A1i, U3r));
+					_mm256_storeu_ps(pR3 + c, _mm256_add_ps(A1r, U3i));
+					_mm256_storeu_ps(pI3 + c, _mm256_sub_ps(A1i, U3r));
+				}
+			}
+		}
+	}
+}
+
+#else
+
+void OceanFFT::ColumnSSE(const PARAM& _param, float* _pReal, float* _pImag)
+{
+	ColumnScalar(_param, _pReal, _pImag);
+}
+
+void OceanFFT::ColumnAVX2(const PARAM& _param, float* _pReal, float* _pImag)
+{
+	ColumnScalar(_param, _pReal, _pImag);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void OceanFFT::ColumnNEON(const PARAM& _param, float* _pReal, float* _pImag)
+{
+	int Span = 1;
+
+	if ((_param.LogSize & 1) != 0)
+	{
+		for (int Row = 0; Row < _param.Size; Row += 2)
+		{
+			float* pR0 = _pReal + Row * _param.Stride;
+			float* pI0 = _pImag + Row * _param.Stride;
+			float* pR1 = pR0 + _param.Stride;
+			float* pI1 = pI0 + _param.Stride;
+
+			for (int c = 0; c < _param.ColumnNum; c += 4)
+			{
+				float32x4_t R0 = vld1q_f32(pR0 + c);
+				float32x4_t I0 = vld1q_f32(pI0 + c);
+				float32x4_t R1 = vld1q_f32(pR1 + c);
+				float32x4_t I1 = vld1q_f32(pI1 + c);
+				vst1q_f32(pR0 + c, vaddq_f32(R0, R1));
+				vst1q_f32(pI0 + c, vaddq_f32(I0, I1));
+				vst1q_f32(pR1 + c, vsubq_f32(R0, R1));
+				vst1q_f32(pI1 + c, vsubq_f32(I0, I1));
+			}
+		}
+
+		Span = 2;
+	}
+
+	for (; Span * 4 <= _param.Size; Span *= 4)
+	{
+		int StepA = _param.Size / (Span * 2);
+		int StepB = _param.Size / (Span * 4);
+
+		for (int Group = 0; Group < _param.Size; Group += Span * 4)
+		{
+			for (int k = 0; k < Span; k++)
+			{
+				float32x4_t WAr = vdupq_n_f32(_param.pCos[k * StepA]);
+				float32x4_t WAi = vdupq_n_f32(_param.pSin[k * StepA]);
+				float32x4_t WBr = vdupq_n_f32(_param.pCos[k * StepB]);
+				float32x4_t WBi = vdupq_n_f32(_param.pSin[k * StepB]);
+
+				float* pR0 = _pReal + (Group + k) * _param.Stride;
+				float* pI0 = _pImag + (Group + k) * _param.Stride;
+				float* pR1 = pR0 + Span * _param.Stride;
+				float* pI1 = pI0 + Span * _param.Stride;
+				float* pR2 = pR1 + Span * _param.Stride;
+				float* pI2 = pI1 + Span * _param.Stride;
+				float* pR3 = pR2 + Span * _param.Stride;
+				float* pI3 = pI2 + Span * _param.Stride;
+
+				for (int c = 0; c < _param.ColumnNum; c += 4)
+				{
+					float32x4_t R0 = vld1q_f32(pR0 + c);
+					float32x4_t I0 = vld1q_f32(pI0 + c);
+					float32x4_t R1 = vld1q_f32(pR1 + c);
+					float32x4_t I1 = vld1q_f32(pI1 + c);
+					float32x4_t R2 = vld1q_f32(pR2 + c);
+					float32x4_t I2 = vld1q_f32(pI2 + c);
+					float32x4_t R3 = vld1q_f32(pR3 + c);
+					float32x4_t I3 = vld1q_f32(pI3 + c);
+
+					float32x4_t T1r = vsubq_f32(vmulq_f32(R1, WAr), vmulq_f32(I1, WAi));
+					float32x4_t T1i = vaddq_f32(vmulq_f32(R1, WAi), vmulq_f32(I1, WAr));
+					float32x4_t T3r = vsubq_f32(vmulq_f32(R3, WAr), vmulq_f32(I3, WAi));
+					float32x4_t T3i = vaddq_f32(vmulq_f32(R3, WAi), vmulq_f32(I3, WAr));
+					float32x4_t A0r = vaddq_f32(R0, T1r);
+					float32x4_t A0i = vaddq_f32(I0, T1i);
+					float32x4_t A1r = vsubq_f32(R0, T1r);
+					float32x4_t A1i = vsubq_f32(I0, T1i);
+					float32x4_t A2r = vaddq_f32(R2, T3r);
+					float32x4_t A2i = vaddq_f32(I2, T3i);
+					float32x4_t A3r = vsubq_f32(R2, T3r);
+					float32x4_t A3i = vsubq_f32(I2, T3i);
+
+					float32x4_t U2r = vsubq_f32(vmulq_f32(A2r, WBr), vmulq_f32(A2i, WBi));
+					float32x4_t U2i = vaddq_f32(vmulq_f32(A2r, WBi), vmulq_f32(A2i, WBr));
+					float32x4_t U3r = vsubq_f32(vmulq_f32(A3r, WBr), vmulq_f32(A3i, WBi));
+					float32x4_t U3i = vaddq_f32(vmulq_f32(A3r, WBi), vmulq_f32(A3i, WBr));
+
+					vst1q_f32(pR0 + c, vaddq_f32(A0r, U2r));
+					vst1q_f32(pI0 + c, vaddq_f32(A0i, U2i));
+					vst1q_f32(pR2 + c, vsubq_f32(A0r, U2r));
+					vst1q_f32(pI2 + c, vsubq_f32(A0i, U2i));
+					vst1q_f32(pR1 + c, vsubq_f32(A1r, U3i));
+					vst1q_f32(pI1 + c, vaddq_f32(A1i, U3r));
+					vst1q_f32(pR3 + c, vaddq_f32(A1r, U3i));
+					vst1q_f32(pI3 + c, vsubq_f32(A1i, U3r));
+				}
+			}
+		}
+	}
+}
+
+#else
+
+void OceanFFT::ColumnNEON(const PARAM& _param, float* _pReal, float* _pImag)
+{
+	ColumnScalar(_param, _pReal, _pImag);
+}
+
+#endif // CPUFEATURE_NEON
@@ -0,0 +1,171 @@
+﻿/**
+ * @file	OceanFFT.h
+ * @brief	2次元高速フーリエ変換クラス定義
+ * @author	morimoto
+ */
+#ifndef OCEANFFT_H
+#define OCEANFFT_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+class ThreadPool;
+
+
+/**
+ * 2次元高速フーリエ変換クラス
+ *
+ * 実部と虚部を別の配列(SoA)で持つN x Nの複素数の配列を, その場で逆変換する(正規化はしない).
+ * 列方向の変換は同じ回転因子を全ての列に掛けるので, 隣り合う列をSIMDのレーンにまとめて計算する.
+ * 行方向の変換は転置してから同じ列方向の変換を行い, もう一度転置して戻す.
+ *
+ * 基数2のステージを2つまとめた基数4のバタフライで計算し, log2(N)が奇数の場合は最初の1ステージだけ基数2で計算する.
+ * 列はSTRIP_COLUMN_NUM列ずつの帯に分け, スレッドプールが設定されていれば帯ごとに並列に変換する.
+ */
+class OceanFFT
+{
+public:
+	/**
+	 * コンストラクタ
+	 * @param[in] _size 配列の幅と高さ(16以上の2の累乗)
+	 */
+	OceanFFT(int _size);
+
+	/**
+	 * デストラクタ
+	 */
+	~OceanFFT();
+
+	/**
+	 * 初期化処理
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool Initialize();
+
+	/**
+	 * 終了処理
+	 */
+	void Finalize();
+
+	/**
+	 * 並列に変換するためのスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元のスレッドだけで変換する)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool)
+	{
+		m_pThreadPool = _pThreadPool;
+	}
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 2次元の逆変換(x = Σ X(k) exp(+2πi k・n / N))
+	 * @param[in,out] _pReal 実部(N x N, 行優先)
+	 * @param[in,out] _pImag 虚部(N x N, 行優先)
+	 */
+	void Inverse2D(float* _pReal, float* _pImag);
+
+	/**
+	 * 配列の幅と高さを取得
+	 * @return 配列の幅と高さ
+	 */
+	int GetSize() const
+	{
+		return m_Size;
+	}
+
+private:
+	enum
+	{
+		STRIP_COLUMN_NUM = 32	//!< 1回の列方向の変換でまとめて計算する列数.
+	};
+
+	/**
+	 * 変換関数に渡すパラメータの構造体
+	 */
+	struct PARAM
+	{
+		int				Size;		//!< 配列の高さ(変換する長さ).
+		int				LogSize;	//!< log2(Size).
+		int				Stride;		//!< 1行分の要素数.
+		int				ColumnNum;	//!< 変換する列数(SIMDの幅の倍数).
+		const float*	pCos;		//!< 回転因子の実部(N/2個).
+		const float*	pSin;		//!< 回転因子の虚部(N/2個).
+	};
+
+	/**
+	 * 列方向の変換関数(行はビット反転の順に並べ替え済み)
+	 * @param[in] _param パラメータ
+	 * @param[in,out] _pReal 帯の先頭列の実部
+	 * @param[in,out] _pImag 帯の先頭列の虚部
+	 */
+	typedef void(*COLUMN_FUNC)(const PARAM& _param, float* _pReal, float* _pImag);
+
+	/**
+	 * 列方向に変換
+	 * @param[in,out] _pReal 実部
+	 * @param[in,out] _pImag 虚部
+	 */
+	void TransformColumn(float* _pReal, float* _pImag);
+
+	/**
+	 * 転置
+	 * @param[in] _pSrc 転置元
+	 * @param[out] _pDest 転置先
+	 */
+	void Transpose(const float* _pSrc, float* _pDest);
+
+	/**
+	 * 命令セットに対応した変換関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 変換関数
+	 */
+	static COLUMN_FUNC GetColumnFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 列方向の変換関数(スカラー版)
+	 */
+	static void ColumnScalar(const PARAM& _param, float* _pReal, float* _pImag);
+
+	/**
+	 * 列方向の変換関数(SSE2版)
+	 */
+	static void ColumnSSE(const PARAM& _param, float* _pReal, float* _pImag);
+
+	/**
+	 * 列方向の変換関数(AVX2版)
+	 */
+	static void ColumnAVX2(const PARAM& _param, float* _pReal, float* _pImag);
+
+	/**
+	 * 列方向の変換関数(NEON版)
+	 */
+	static void ColumnNEON(const PARAM& _param, float* _pReal, float* _pImag);
+
+
+	int						m_Size;			//!< 配列の幅と高さ.
+	int						m_LogSize;		//!< log2(配列の幅と高さ).
+	std::vector<float>		m_Cos;			//!< 回転因子exp(+2πi j / N)の実部.
+	std::vector<float>		m_Sin;			//!< 回転因子exp(+2πi j / N)の虚部.
+	std::vector<int>		m_BitReverse;	//!< 行の並べ替え先.
+	std::vector<float>		m_WorkReal;		//!< 転置した実部.
+	std::vector<float>		m_WorkImag;		//!< 転置した虚部.
+	ThreadPool*				m_pThreadPool;	//!< 並列に変換するためのスレッドプール.
+	CpuFeature::SIMD_TYPE	m_SimdType;		//!< 使用する命令セット.
+
+};
+
+
+#endif // !OCEANFFT_H
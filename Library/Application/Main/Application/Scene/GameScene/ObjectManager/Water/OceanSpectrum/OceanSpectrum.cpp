@@ -0,0 +1,371 @@
+﻿/**
+ * @file	OceanSpectrum.cpp
+ * @brief	海の波スペクトル生成クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "OceanSpectrum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "Main\ThreadPool\ThreadPool.h"
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const float OceanSpectrum::m_Gravity = 9.81f;
+const float OceanSpectrum::m_JonswapAlpha = 0.0081f;
+const float OceanSpectrum::m_JonswapGamma = 3.3f;
+const float OceanSpectrum::m_SmallWaveRatio = 0.001f;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+OceanSpectrum::OceanSpectrum(int _size, float _patchSize) :
+	m_FFT(_size),
+	m_pThreadPool(nullptr),
+	m_Size(_size),
+	m_PatchSize(_patchSize),
+	m_WaveNumberStep(2.0f * 3.14159265f / _patchSize),
+	m_Spectrum(SPECTRUM_JONSWAP),
+	m_WindSpeed(6.0f),
+	m_WindDirX(1.0f),
+	m_WindDirZ(0.0f),
+	m_Amplitude(1.0f),
+	m_Choppiness(1.0f),
+	m_RepeatTime(200.0f),
+	m_IsSpectrumValid(false)
+{
+}
+
+OceanSpectrum::~OceanSpectrum()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool OceanSpectrum::Initialize()
+{
+	if (!m_FFT.Initialize())
+	{
+		return false;
+	}
+
+	int CellNum = m_Size * m_Size;
+	m_H0Real.assign(CellNum, 0.0f);
+	m_H0Imag.assign(CellNum, 0.0f);
+	m_H0ConjReal.assign(CellNum, 0.0f);
+	m_H0ConjImag.assign(CellNum, 0.0f);
+	m_Omega.assign(CellNum, 0.0f);
+	m_Height.assign(CellNum, 0.0f);
+	m_HeightImag.assign(CellNum, 0.0f);
+	m_SlopeX.assign(CellNum, 0.0f);
+	m_SlopeZ.assign(CellNum, 0.0f);
+	m_DisplaceX.assign(CellNum, 0.0f);
+	m_DisplaceZ.assign(CellNum, 0.0f);
+	m_IsSpectrumValid = false;
+
+	return true;
+}
+
+void OceanSpectrum::Finalize()
+{
+	std::vector<float>().swap(m_H0Real);
+	std::vector<float>().swap(m_H0Imag);
+	std::vector<float>().swap(m_H0ConjReal);
+	std::vector<float>().swap(m_H0ConjImag);
+	std::vector<float>().swap(m_Omega);
+	std::vector<float>().swap(m_Height);
+	std::vector<float>().swap(m_HeightImag);
+	std::vector<float>().swap(m_SlopeX);
+	std::vector<float>().swap(m_SlopeZ);
+	std::vector<float>().swap(m_DisplaceX);
+	std::vector<float>().swap(m_DisplaceZ);
+
+	m_FFT.Finalize();
+}
+
+void OceanSpectrum::SetThreadPool(ThreadPool* _pThreadPool)
+{
+	m_pThreadPool = _pThreadPool;
+	m_FFT.SetThreadPool(_pThreadPool);
+}
+
+void OceanSpectrum::SetSpectrum(SPECTRUM _spectrum)
+{
+	m_Spectrum = _spectrum;
+	m_IsSpectrumValid = false;
+}
+
+void OceanSpectrum::SetWind(float _speed, float _dirX, float _dirZ)
+{
+	float Length = std::sqrt(_dirX * _dirX + _dirZ * _dirZ);
+	if (Length <= 0.0f)
+	{
+		return;
+	}
+
+	m_WindSpeed = _speed;
+	m_WindDirX = _dirX / Length;
+	m_WindDirZ = _dirZ / Length;
+	m_IsSpectrumValid = false;
+}
+
+void OceanSpectrum::SetAmplitude(float _amplitude)
+{
+	m_Amplitude = _amplitude;
+	m_IsSpectrumValid = false;
+}
+
+void OceanSpectrum::SetChoppiness(float _choppiness)
+{
+	m_Choppiness = _choppiness;
+
+	// 変位を計算しなくなる場合は前回の変位を残さない.
+	if (m_Choppiness == 0.0f)
+	{
+		std::fill(m_DisplaceX.begin(), m_DisplaceX.end(), 0.0f);
+		std::fill(m_DisplaceZ.begin(), m_DisplaceZ.end(), 0.0f);
+	}
+}
+
+void OceanSpectrum::SetRepeatTime(float _repeatTime)
+{
+	m_RepeatTime = _repeatTime;
+	m_IsSpectrumValid = false;
+}
+
+void OceanSpectrum::Update(float _time)
+{
+	if (!m_IsSpectrumValid)
+	{
+		BuildSpectrum();
+	}
+
+	// 角周波数は周期の整数倍にそろえてあるので, 時刻も周期で折り返して精度を保つ.
+	float Time = m_RepeatTime > 0.0f ? std::fmod(_time, m_RepeatTime) : _time;
+	bool IsChoppy = m_Choppiness != 0.0f;
+
+	// h(k, t) = h0(k)exp(iωt) + conj(h0(-k))exp(-iωt)から, 傾きと変位のスペクトルを作る.
+	auto BuildRows = [this, Time, IsChoppy](int _row)
+	{
+		float Kz = GetWaveNumber(_row);
+
+		for (int x = 0; x < m_Size; x++)
+		{
+			int Index = _row * m_Size + x;
+			float Kx = GetWaveNumber(x);
+
+			float Cos = std::cos(m_Omega[Index] * Time);
+			float Sin = std::sin(m_Omega[Index] * Time);
+			float Hr = (m_H0Real[Index] + m_H0ConjReal[Index]) * Cos - (m_H0Imag[Index] - m_H0ConjImag[Index]) * Sin;
+			float Hi = (m_H0Imag[Index] + m_H0ConjImag[Index]) * Cos + (m_H0Real[Index] - m_H0ConjReal[Index]) * Sin;
+
+			m_Height[Index] = Hr;
+			m_HeightImag[Index] = Hi;
+
+			// 傾き: ikx h + i(ikz h).
+			m_SlopeX[Index] = -Kx * Hi - Kz * Hr;
+			m_SlopeZ[Index] = Kx * Hr - Kz * Hi;
+
+			if (IsChoppy)
+			{
+				// 変位: -i(kx/k)h + i(-i(kz/k)h).
+				float K = std::sqrt(Kx * Kx + Kz * Kz);
+				float InvK = K > 0.0f ? m_Choppiness / K : 0.0f;
+				m_DisplaceX[Index] = (Kx * Hi + Kz * Hr) * InvK;
+				m_DisplaceZ[Index] = (Kz * Hi - Kx * Hr) * InvK;
+			}
+		}
+	};
+
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelFor(m_Size, BuildRows);
+	}
+	else
+	{
+		for (int i = 0; i < m_Size; i++)
+		{
+			BuildRows(i);
+		}
+	}
+
+	m_FFT.Inverse2D(&m_Height[0], &m_HeightImag[0]);
+	m_FFT.Inverse2D(&m_SlopeX[0], &m_SlopeZ[0]);
+	if (IsChoppy)
+	{
+		m_FFT.Inverse2D(&m_DisplaceX[0], &m_DisplaceZ[0]);
+	}
+}
+
+void OceanSpectrum::Sample(const float* _pX, const float* _pZ, int _count, float* _pHeight, float* _pDisplaceX, float* _pDisplaceZ) const
+{
+	float Scale = static_cast<float>(m_Size) / m_PatchSize;
+	int Mask = m_Size - 1;
+
+	for (int i = 0; i < _count; i++)
+	{
+		float GridX = _pX[i] * Scale;
+		float GridZ = _pZ[i] * Scale;
+		float FloorX = std::floor(GridX);
+		float FloorZ = std::floor(GridZ);
+		float FracX = GridX - FloorX;
+		float FracZ = GridZ - FloorZ;
+
+		// 格子の大きさは2の累乗なので, 負の座標もマスクで繰り返せる.
+		int X0 = static_cast<int>(FloorX) & Mask;
+		int Z0 = static_cast<int>(FloorZ) & Mask;
+		int X1 = (X0 + 1) & Mask;
+		int Z1 = (Z0 + 1) & Mask;
+		int Index00 = Z0 * m_Size + X0;
+		int Index10 = Z0 * m_Size + X1;
+		int Index01 = Z1 * m_Size + X0;
+		int Index11 = Z1 * m_Size + X1;
+
+		auto Bilinear = [FracX, FracZ, Index00, Index10, Index01, Index11](const std::vector<float>& _value)
+		{
+			float Top = _value[Index00] + (_value[Index10] - _value[Index00]) * FracX;
+			float Bottom = _value[Index01] + (_value[Index11] - _value[Index01]) * FracX;
+			return Top + (Bottom - Top) * FracZ;
+		};
+
+		_pHeight[i] = Bilinear(m_Height);
+
+		if (_pDisplaceX != nullptr)
+		{
+			_pDisplaceX[i] = Bilinear(m_DisplaceX);
+			_pDisplaceZ[i] = Bilinear(m_DisplaceZ);
+		}
+	}
+}
+
+void OceanSpectrum::WriteNormalMap(void* _pData, int _rowPitch) const
+{
+	auto WriteRows = [this, _pData, _rowPitch](int _row)
+	{
+		unsigned char* pPixel = static_cast<unsigned char*>(_pData) + static_cast<size_t>(_row) * _rowPitch;
+
+		for (int x = 0; x < m_Size; x++)
+		{
+			int Index = _row * m_Size + x;
+			float NormalX = -m_SlopeX[Index];
+			float NormalZ = -m_SlopeZ[Index];
+			float InvLength = 1.0f / std::sqrt(NormalX * NormalX + NormalZ * NormalZ + 1.0f);
+
+			pPixel[x * 4 + 0] = static_cast<unsigned char>((NormalX * InvLength * 0.5f + 0.5f) * 255.0f + 0.5f);
+			pPixel[x * 4 + 1] = static_cast<unsigned char>((InvLength * 0.5f + 0.5f) * 255.0f + 0.5f);
+			pPixel[x * 4 + 2] = static_cast<unsigned char>((NormalZ * InvLength * 0.5f + 0.5f) * 255.0f + 0.5f);
+			pPixel[x * 4 + 3] = 255;
+		}
+	};
+
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelFor(m_Size, WriteRows);
+	}
+	else
+	{
+		for (int i = 0; i < m_Size; i++)
+		{
+			WriteRows(i);
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void OceanSpectrum::BuildSpectrum()
+{
+	// 乱数は固定のシードで作り, 設定を変えても同じ海の形を保つ.
+	std::mt19937 MersenneTwister(0);
+	std::normal_distribution<float> Normal(0.0f, 1.0f);
+
+	float RepeatOmega = m_RepeatTime > 0.0f ? 2.0f * 3.14159265f / m_RepeatTime : 0.0f;
+	float CellArea = m_WaveNumberStep * m_WaveNumberStep;
+
+	for (int z = 0; z < m_Size; z++)
+	{
+		for (int x = 0; x < m_Size; x++)
+		{
+			int Index = z * m_Size + x;
+			float Kx = GetWaveNumber(x);
+			float Kz = GetWaveNumber(z);
+			float GaussReal = Normal(MersenneTwister);
+			float GaussImag = Normal(MersenneTwister);
+
+			// ナイキスト周波数は-kが自分自身になり実数の出力にならないので使わない.
+			// 複素数の乱数で2倍, h0(k)とconj(h0(-k))の2つの項で2倍になるので, 1/4にして高さの分散をスペクトルの積分に合わせる.
+			bool IsNyquist = x == m_Size / 2 || z == m_Size / 2;
+			float Amplitude = IsNyquist ? 0.0f : m_Amplitude * std::sqrt(GetSpectrum(Kx, Kz) * CellArea * 0.25f);
+			m_H0Real[Index] = GaussReal * Amplitude;
+			m_H0Imag[Index] = GaussImag * Amplitude;
+
+			// 周期で繰り返すように角周波数を周期の整数倍に丸める.
+			float Omega = std::sqrt(m_Gravity * std::sqrt(Kx * Kx + Kz * Kz));
+			m_Omega[Index] = RepeatOmega > 0.0f ? std::floor(Omega / RepeatOmega) * RepeatOmega : Omega;
+		}
+	}
+
+	for (int z = 0; z < m_Size; z++)
+	{
+		for (int x = 0; x < m_Size; x++)
+		{
+			int Index = z * m_Size + x;
+			int NegativeIndex = ((m_Size - z) & (m_Size - 1)) * m_Size + ((m_Size - x) & (m_Size - 1));
+			m_H0ConjReal[Index] = m_H0Real[NegativeIndex];
+			m_H0ConjImag[Index] = -m_H0Imag[NegativeIndex];
+		}
+	}
+
+	m_IsSpectrumValid = true;
+}
+
+float OceanSpectrum::GetSpectrum(float _kx, float _kz) const
+{
+	float K = std::sqrt(_kx * _kx + _kz * _kz);
+	if (K <= 0.0f || m_WindSpeed <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	// 風向きとの角度の余弦(風下の波だけを残す).
+	float Cos = std::max((_kx * m_WindDirX + _kz * m_WindDirZ) / K, 0.0f);
+
+	// 風速で決まる最も大きい波の長さ.
+	float WaveLength = m_WindSpeed * m_WindSpeed / m_Gravity;
+	float SmallWaveLength = WaveLength * m_SmallWaveRatio;
+	float SmallWave = std::exp(-K * K * SmallWaveLength * SmallWaveLength);
+
+	if (m_Spectrum == SPECTRUM_PHILLIPS)
+	{
+		float KL = K * WaveLength;
+		return std::exp(-1.0f / (KL * KL)) / (K * K * K * K) * Cos * Cos * SmallWave;
+	}
+
+	// JONSWAP: 周波数スペクトルS(ω)を方向分布cos^2と合わせて波数スペクトルに変換する.
+	const float Pi = 3.14159265f;
+	float Omega = std::sqrt(m_Gravity * K);
+	float PeakOmega = 0.855f * m_Gravity / m_WindSpeed;
+	float Sigma = Omega <= PeakOmega ? 0.07f : 0.09f;
+	float PeakRatio = PeakOmega / Omega;
+	float Peak = std::exp(-(Omega - PeakOmega) * (Omega - PeakOmega) / (2.0f * Sigma * Sigma * PeakOmega * PeakOmega));
+	float Spectrum = m_JonswapAlpha * m_Gravity * m_Gravity / std::pow(Omega, 5.0f)
+		* std::exp(-1.25f * PeakRatio * PeakRatio * PeakRatio * PeakRatio)
+		* std::pow(m_JonswapGamma, Peak);
+
+	// dω/dk = g / 2ω, 極座標の面積要素で1/kを掛ける.
+	float Direction = 2.0f / Pi * Cos * Cos;
+	return Spectrum * Direction * (m_Gravity / (2.0f * Omega)) / K * SmallWave;
+}
@@ -0,0 +1,265 @@
+﻿/**
+ * @file	OceanSpectrum.h
+ * @brief	海の波スペクトル生成クラス定義
+ * @author	morimoto
+ */
+#ifndef OCEANSPECTRUM_H
+#define OCEANSPECTRUM_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "OceanFFT\OceanFFT.h"
+
+
+class ThreadPool;
+
+
+/**
+ * 海の波スペクトル生成クラス
+ *
+ * 風の強さと向きから求めた波のスペクトル(PhillipsかJONSWAP)に乱数の振幅を掛けた初期スペクトルを作り,
+ * 毎フレーム深水の分散関係(ω = sqrt(gk))で時間を進めてからOceanFFTで逆変換して, 1辺PatchSizeの範囲の
+ * 高さ, 水平方向の変位(尖った波頭を作るchoppy変位), 傾きを求める.
+ * 結果はN x Nの格子で, 端がつながっているので水面全体に繰り返して敷き詰められる.
+ *
+ * 出力はどれも実数なので, 2つの出力のスペクトルをA + iBにまとめて1回の変換で求める.
+ * 変換は(傾きx, 傾きz), (変位x, 変位z), (高さ)の3回で, choppy変位を使わない場合は2回になる.
+ * 格子の大きさに関係なく1フレームの計算量は一定で, 水面の広さにもよらない.
+ *
+ * 格子(x, z)はワールド座標(x * PatchSize / N, z * PatchSize / N)に対応する.
+ */
+class OceanSpectrum
+{
+public:
+	/**
+	 * スペクトルの種類の列挙子
+	 */
+	enum SPECTRUM
+	{
+		SPECTRUM_PHILLIPS,	//!< Phillipsスペクトル.
+		SPECTRUM_JONSWAP	//!< JONSWAPスペクトル(風上から吹き続けた海の波).
+	};
+
+	/**
+	 * コンストラクタ
+	 * @param[in] _size 格子の幅と高さ(16以上の2の累乗)
+	 * @param[in] _patchSize 格子が覆うワールド座標の大きさ
+	 */
+	OceanSpectrum(int _size, float _patchSize);
+
+	/**
+	 * デストラクタ
+	 */
+	~OceanSpectrum();
+
+	/**
+	 * 初期化処理
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool Initialize();
+
+	/**
+	 * 終了処理
+	 */
+	void Finalize();
+
+	/**
+	 * 並列に計算するためのスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元のスレッドだけで計算する)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool);
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_FFT.SetSimdType(_simdType);
+	}
+
+	/**
+	 * スペクトルの種類を設定(次のUpdateで初期スペクトルを作り直す)
+	 * @param[in] _spectrum スペクトルの種類
+	 */
+	void SetSpectrum(SPECTRUM _spectrum);
+
+	/**
+	 * 風を設定(次のUpdateで初期スペクトルを作り直す)
+	 * @param[in] _speed 風速
+	 * @param[in] _dirX 風向きのx成分
+	 * @param[in] _dirZ 風向きのz成分
+	 */
+	void SetWind(float _speed, float _dirX, float _dirZ);
+
+	/**
+	 * 波の高さの倍率を設定(次のUpdateで初期スペクトルを作り直す)
+	 * @param[in] _amplitude 波の高さの倍率
+	 */
+	void SetAmplitude(float _amplitude);
+
+	/**
+	 * 水平方向の変位の倍率を設定
+	 * @param[in] _choppiness 水平方向の変位の倍率(0なら変位を計算しない)
+	 */
+	void SetChoppiness(float _choppiness);
+
+	/**
+	 * 波が繰り返す周期を設定(次のUpdateで初期スペクトルを作り直す)
+	 * @param[in] _repeatTime 周期(秒)
+	 */
+	void SetRepeatTime(float _repeatTime);
+
+	/**
+	 * 指定した時刻の波を計算
+	 * @param[in] _time 時刻(秒)
+	 */
+	void Update(float _time);
+
+	/**
+	 * 複数のワールド座標の高さと水平方向の変位をまとめて取得(双線形補間, 範囲外は繰り返す)
+	 * @param[in] _pX 取得する座標のx(_count個)
+	 * @param[in] _pZ 取得する座標のz(_count個)
+	 * @param[in] _count 取得する座標の数
+	 * @param[out] _pHeight 高さの書き込み先
+	 * @param[out] _pDisplaceX 変位のxの書き込み先(nullptrなら変位を取得しない)
+	 * @param[out] _pDisplaceZ 変位のzの書き込み先
+	 */
+	void Sample(const float* _pX, const float* _pZ, int _count, float* _pHeight, float* _pDisplaceX, float* _pDisplaceZ) const;
+
+	/**
+	 * 法線マップへの書き込み(R8G8B8A8, 法線を0～1に変換したもの)
+	 * @param[out] _pData 書き込み先(N x N)
+	 * @param[in] _rowPitch 書き込み先の1行分のバイト数
+	 */
+	void WriteNormalMap(void* _pData, int _rowPitch) const;
+
+	/**
+	 * 格子の幅と高さを取得
+	 * @return 格子の幅と高さ
+	 */
+	int GetSize() const
+	{
+		return m_Size;
+	}
+
+	/**
+	 * 格子が覆うワールド座標の大きさを取得
+	 * @return 格子が覆う大きさ
+	 */
+	float GetPatchSize() const
+	{
+		return m_PatchSize;
+	}
+
+	/**
+	 * 高さを取得
+	 * @return 高さの配列(N x N)
+	 */
+	const float* GetHeight() const
+	{
+		return &m_Height[0];
+	}
+
+	/**
+	 * 水平方向の変位のxを取得
+	 * @return 変位のxの配列(N x N, 変位を計算していなければ0)
+	 */
+	const float* GetDisplaceX() const
+	{
+		return &m_DisplaceX[0];
+	}
+
+	/**
+	 * 水平方向の変位のzを取得
+	 * @return 変位のzの配列(N x N, 変位を計算していなければ0)
+	 */
+	const float* GetDisplaceZ() const
+	{
+		return &m_DisplaceZ[0];
+	}
+
+	/**
+	 * x方向の傾き(∂h/∂x)を取得
+	 * @return 傾きの配列(N x N)
+	 */
+	const float* GetSlopeX() const
+	{
+		return &m_SlopeX[0];
+	}
+
+	/**
+	 * z方向の傾き(∂h/∂z)を取得
+	 * @return 傾きの配列(N x N)
+	 */
+	const float* GetSlopeZ() const
+	{
+		return &m_SlopeZ[0];
+	}
+
+private:
+	/**
+	 * 初期スペクトルの作成
+	 */
+	void BuildSpectrum();
+
+	/**
+	 * 波数ベクトルでのスペクトルの値(波の高さの分散密度)を取得
+	 * @param[in] _kx 波数ベクトルのx
+	 * @param[in] _kz 波数ベクトルのz
+	 * @return スペクトルの値
+	 */
+	float GetSpectrum(float _kx, float _kz) const;
+
+	/**
+	 * 格子のインデックスから波数を取得
+	 * @param[in] _index 格子のインデックス
+	 * @return 波数
+	 */
+	float GetWaveNumber(int _index) const
+	{
+		// 後半のインデックスは負の周波数になる.
+		return static_cast<float>(_index < m_Size / 2 ? _index : _index - m_Size) * m_WaveNumberStep;
+	}
+
+
+	static const float m_Gravity;			//!< 重力加速度.
+	static const float m_JonswapAlpha;		//!< JONSWAPスペクトルのエネルギーの係数.
+	static const float m_JonswapGamma;		//!< JONSWAPスペクトルのピークの鋭さ.
+	static const float m_SmallWaveRatio;	//!< 打ち消す小さい波の長さ(最も大きい波に対する比).
+
+	OceanFFT			m_FFT;				//!< 逆変換オブジェクト.
+	ThreadPool*			m_pThreadPool;		//!< 並列に計算するためのスレッドプール.
+	int					m_Size;				//!< 格子の幅と高さ.
+	float				m_PatchSize;		//!< 格子が覆うワールド座標の大きさ.
+	float				m_WaveNumberStep;	//!< 格子1つ分の波数.
+	SPECTRUM			m_Spectrum;			//!< スペクトルの種類.
+	float				m_WindSpeed;		//!< 風速.
+	float				m_WindDirX;			//!< 風向きのx成分(正規化済み).
+	float				m_WindDirZ;			//!< 風向きのz成分(正規化済み).
+	float				m_Amplitude;		//!< 波の高さの倍率.
+	float				m_Choppiness;		//!< 水平方向の変位の倍率.
+	float				m_RepeatTime;		//!< 波が繰り返す周期.
+	bool				m_IsSpectrumValid;	//!< 初期スペクトルが現在の設定で作られているか.
+
+	std::vector<float>	m_H0Real;			//!< 初期スペクトルh0(k)の実部.
+	std::vector<float>	m_H0Imag;			//!< 初期スペクトルh0(k)の虚部.
+	std::vector<float>	m_H0ConjReal;		//!< conj(h0(-k))の実部.
+	std::vector<float>	m_H0ConjImag;		//!< conj(h0(-k))の虚部.
+	std::vector<float>	m_Omega;			//!< 波数ごとの角周波数.
+
+	std::vector<float>	m_Height;			//!< 高さ(変換前は高さのスペクトルの実部).
+	std::vector<float>	m_HeightImag;		//!< 変換の虚部の作業領域.
+	std::vector<float>	m_SlopeX;			//!< x方向の傾き(変換前はまとめたスペクトルの実部).
+	std::vector<float>	m_SlopeZ;			//!< z方向の傾き(変換前はまとめたスペクトルの虚部).
+	std::vector<float>	m_DisplaceX;		//!< 変位のx(変換前はまとめたスペクトルの実部).
+	std::vector<float>	m_DisplaceZ;		//!< 変位のz(変換前はまとめたスペクトルの虚部).
+
+};
+
+
+#endif // !OCEANSPECTRUM_H
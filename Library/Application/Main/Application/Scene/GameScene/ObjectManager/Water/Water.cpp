@@ -9,6 +9,9 @@
 //----------------------------------------------------------------------
 #include "Water.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "Debugger\Debugger.h"
 #include "TaskManager\TaskBase\DrawTask\DrawTask.h"
 #include "TaskManager\TaskBase\UpdateTask\UpdateTask.h"
@@ -20,6 +23,12 @@
 #include "DirectX11\Camera\Dx11Camera.h"
 #include "Main\Application\Scene\GameScene\Task\CubeMapDrawTask\CubeMapDrawTask.h"
 #include "Main\Application\Scene\GameScene\Task\ReflectMapDrawTask\ReflectMapDrawTask.h"
+#include "WaveSimulator\WaveBenchmark\WaveBenchmark.h"
+#include "WaterClipmap\WaterClipmap.h"
+#include "OceanSpectrum\OceanSpectrum.h"
+#include "CubeFaceScheduler\CubeFaceScheduler.h"
+#include "Main\Application\Scene\GameScene\Task\ReflectMapDrawTask\ReflectFrustumCuller\ReflectFrustumCuller.h"
+#include "..\MainCamera\MainCamera.h"
 
 
 //----------------------------------------------------------------------
@@ -39,29 +48,63 @@ const int Water::m_CubeRenderTargetStage = 3;
 const int Water::m_WaveRenderTargetStage = 4;
 const int Water::m_BumpRenderTargetStage = 5;
 const int Water::m_ReflectRenderTargetStage = 6;
+const WaveSimulator::PRECISION Water::m_DefaultWavePrecision = WaveSimulator::PRECISION_FLOAT32;
+const char* Water::m_WaveSnapshotFileName = "Resource\\WaveSnapshot.bin";
+const int Water::m_ClipmapLevelNum = 5;
+const int Water::m_ClipmapGridSize = 64;
+const float Water::m_ClipmapCellSize = 0.625f;
+const int Water::m_ClipmapFadeLevel = 2;
+const float Water::m_WaveDisplacement = 4.0f;
+const int Water::m_OceanSize = 256;
+const float Water::m_OceanPatchSize = 80.0f;
+const float Water::m_OceanWindSpeed = 6.0f;
+const float Water::m_OceanScale = 0.25f;
+const float Water::m_OceanTimeStep = 1.0f / 60.0f;
 
 
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
-Water::Water() : 
+Water::Water(MainCamera* _pMainCamera, ThreadPool* _pThreadPool, WaveImpulseQueue* _pWaveImpulseQueue, WaveObstacleMask* _pWaveObstacleMask) : 
 	m_pCamera(nullptr),
+	m_pMainCamera(_pMainCamera),
+	m_pThreadPool(_pThreadPool),
+	m_pWaveSimulator(nullptr),
+	m_pWaveImpulseQueue(_pWaveImpulseQueue),
+	m_pWaveObstacleMask(_pWaveObstacleMask),
+	m_pClipmap(nullptr),
+	m_pOceanSpectrum(nullptr),
+	m_pCubeFaceScheduler(nullptr),
+	m_pReflectFrustumCuller(nullptr),
 	m_CubeVertexShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_CubePixelShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_ReflectVertexShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_ReflectPixelShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
+	m_pIndexBuffer(nullptr),
+	m_IsClipmapDisplaced(false),
+	m_pObstacleTexture(nullptr),
+	m_pObstacleShaderResourceView(nullptr),
+	m_pOceanTexture(nullptr),
+	m_pOceanShaderResourceView(nullptr),
+	m_OceanTime(0.0f),
+	m_IsOcean(false),
 	m_WaveVertexShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_WavePixelShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_BumpPixelShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
+	m_WaveBumpPixelShaderIndex(Lib::Dx11::ShaderManager::m_InvalidIndex),
 	m_WaveRenderIndex(0),
-	m_AddWavePos(D3DXVECTOR2(0, 0)),
-	m_AddWaveHeight(0),
 	m_RandDevice(),
 	m_MersenneTwister(m_RandDevice()),
-	m_WaveAddTime(750),
-	m_WaveAddCount(0),
-	m_IsCubeMapDraw(true)
+	m_IsCubeMapDraw(true),
+	m_IsCpuWave(false),
+	m_IsFusedWave(true),
+	m_IsMapDataValid(false)
 {
+	for (int i = 0; i < 6; i++)
+	{
+		m_pCubeFaceRenderTarget[i] = nullptr;
+		m_pCubeFaceDepthStencilView[i] = nullptr;
+	}
 }
 
 Water::~Water()
@@ -108,12 +151,18 @@ bool Water::Initialize()
 	if (!CreateConstantBuffer())	return false;
 	if (!WriteConstantBuffer())		return false;
 	if (!CreateTexture())			return false;
+	if (!CreateWaveSimulator())		return false;
+	if (!CreateObstacleTexture())	return false;
+	if (!CreateOceanSpectrum())		return false;
 
 	return true;
 }
 
 void Water::Finalize()
 {
+	ReleaseOceanSpectrum();
+	ReleaseObstacleTexture();
+	ReleaseWaveSimulator();
 	ReleaseTexture();
 	ReleaseConstantBuffer();
 	ReleaseState();
@@ -138,37 +187,98 @@ void Water::Finalize()
 void Water::Update()
 {
 	m_pDebugFont->SetIsCubeMap(m_IsCubeMapDraw);
+	m_pDebugFont->SetIsCpuWave(m_IsCpuWave);
+	m_pDebugFont->SetIsFusedWave(m_IsFusedWave);
+	m_pDebugFont->SetIsFixedWave(m_pWaveSimulator->GetPrecision() == WaveSimulator::PRECISION_FIXED16);
+	m_pDebugFont->SetWaveTileNum(m_pWaveSimulator->GetActiveTileNum(), m_pWaveSimulator->GetTileNum());
+	m_pDebugFont->SetIsOcean(m_IsOcean);
+	m_pDebugFont->SetCubeFace(m_pCubeFaceScheduler->GetFaceBudget(), m_pCubeFaceScheduler->GetMaxStaleness());
+	m_pDebugFont->SetReflectCullNum(ReflectMapDrawTask::GetVisibleNum(), ReflectMapDrawTask::GetCulledNum());
 
 	m_pKeyState = SINGLETON_INSTANCE(Lib::InputDeviceManager)->GetKeyState();
 
 	if (m_pKeyState[DIK_T] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
 	{
 		m_IsCubeMapDraw = !m_IsCubeMapDraw;
+
+		// 反射マップを使っている間はキューブマップを更新しない(戻したら全ての面を描画し直す).
+		m_pCubeFaceScheduler->SetIsEnable(m_IsCubeMapDraw);
 	}
 
-	if (m_IsCubeMapDraw)
+	if (m_pKeyState[DIK_K] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
 	{
+		int FaceBudget = m_pCubeFaceScheduler->GetFaceBudget();
+		m_pCubeFaceScheduler->SetFaceBudget(FaceBudget >= CubeFaceScheduler::FACE_NUM ? 1 : FaceBudget + 1);
 	}
-	else
+
+	if (m_pKeyState[DIK_C] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
 	{
-		///@todo 波の追加処理
+		m_IsCpuWave = !m_IsCpuWave;
+	}
 
-		//m_WaveAddTime++;
+	if (m_pKeyState[DIK_F] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		m_IsFusedWave = !m_IsFusedWave;
+	}
 
-		//if (m_WaveAddTime >= 800 && m_WaveAddCount <= 6)
-		//{
-		//	m_WaveAddTime = 0;
-		//	m_WaveAddCount++;
+	if (m_pKeyState[DIK_X] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		m_pWaveSimulator->SetPrecision(
+			m_pWaveSimulator->GetPrecision() == WaveSimulator::PRECISION_FLOAT32 ?
+			WaveSimulator::PRECISION_FIXED16 : WaveSimulator::PRECISION_FLOAT32);
+		m_IsMapDataValid = false;
+	}
 
-		//	m_AddWavePos = D3DXVECTOR2(
-		//		m_MersenneTwister() % static_cast<int>(m_WaveTextureWidth)* (1 / m_WaveTextureWidth),
-		//		m_MersenneTwister() % static_cast<int>(m_WaveTextureHeight)* (1 / m_WaveTextureHeight)
-		//		);
+	if (m_pKeyState[DIK_O] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		m_IsOcean = !m_IsOcean;
+		WriteConstantBuffer();	// 法線マップの合成の強さを切り替える.
+	}
 
-		//	m_AddWaveHeight = (m_MersenneTwister() % 30 + 20) * 0.001f;
+	// 海の波は水面の広さに関係なく毎フレーム同じ大きさのスペクトルを1回計算する.
+	if (m_IsOcean)
+	{
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
 
-		//	WriteConstantBuffer();
-		//}
+		m_OceanTime += m_OceanTimeStep;
+		m_pOceanSpectrum->Update(m_OceanTime);
+		m_pOceanSpectrum->WriteNormalMap(&m_OceanMapData[0], m_OceanSize * 4);
+
+		std::chrono::steady_clock::time_point EndTime = std::chrono::steady_clock::now();
+		m_pDebugFont->SetOceanTime(static_cast<float>(std::chrono::duration<double, std::milli>(EndTime - StartTime).count()));
+	}
+
+#ifdef _DEBUG
+	// 波シミュレーションの計測(数秒かかる).
+	if (m_pKeyState[DIK_B] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		// スナップショットが無ければ平らな水面に波を追加して計測する.
+		WaveSnapshot Snapshot;
+		Snapshot.Open(m_WaveSnapshotFileName);
+
+		WaveBenchmark Benchmark(m_pThreadPool);
+		Benchmark.SetSnapshot(Snapshot.IsOpen() ? &Snapshot : nullptr);
+		if (!Benchmark.Run(32, 8) || !Benchmark.WriteResult("WaveBenchmark.csv"))
+		{
+			OutputErrorLog("波シミュレーションの計測に失敗しました");
+		}
+	}
+
+	// 現在の状態を次回の起動時の初期状態として保存する.
+	if (m_pKeyState[DIK_V] == Lib::KeyDevice::KEYSTATE::KEY_PUSH)
+	{
+		if (!m_pWaveSimulator->SaveSnapshot(m_WaveSnapshotFileName, WaveSnapshot::ENCODING_RAW))
+		{
+			OutputErrorLog("波の状態の保存に失敗しました");
+		}
+	}
+#endif // _DEBUG
+
+	// 溜まった波はCpuWaveDrawでまとめて反映する.
+	// GPUでの計算は定数バッファで1つしか波を追加できないので, CPUで計算しない間は破棄する.
+	if (m_IsCubeMapDraw || !m_IsCpuWave)
+	{
+		m_pWaveImpulseQueue->Clear();
 	}
 }
 
@@ -179,19 +289,19 @@ void Water::Draw()
 	Lib::Dx11::TextureManager* pTextureManager = SINGLETON_INSTANCE(Lib::Dx11::TextureManager);
 	Lib::Dx11::ShaderManager* pShaderManager = SINGLETON_INSTANCE(Lib::Dx11::ShaderManager);
 
+	if (m_IsOcean)
+	{
+		OceanMapDraw();
+	}
+
 	if (m_IsCubeMapDraw)
 	{
 		pDeviceContext->VSSetShader(pShaderManager->GetVertexShader(m_CubeVertexShaderIndex), nullptr, 0);
 		pDeviceContext->PSSetShader(pShaderManager->GetPixelShader(m_CubePixelShaderIndex), nullptr, 0);
-		pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 		pDeviceContext->IASetInputLayout(m_pVertexLayout);
 		pDeviceContext->OMSetDepthStencilState(m_pDepthStencilState, 0);
 		pDeviceContext->OMSetBlendState(m_pBlendState, nullptr, 0xffffffff);
 
-		UINT Stride = sizeof(VERTEX);
-		UINT Offset = 0;
-		pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &Stride, &Offset);
-
 		ID3D11ShaderResourceView* pPuddleResource = pTextureManager->GetTexture(m_PuddleTextureIndex)->Get();
 		ID3D11ShaderResourceView* pSkyResource = pTextureManager->GetTexture(m_SkyCLUTIndex)->Get();
 
@@ -201,31 +311,44 @@ void Water::Draw()
 		pDeviceContext->PSSetShaderResources(2, 1, &pSkyResource);
 		pDeviceContext->PSSetShaderResources(3, 1, &m_pWaveShaderResourceView[m_WaveRenderIndex ^ 1]);
 		pDeviceContext->PSSetShaderResources(4, 1, &m_pBumpShaderResourceView);
+		pDeviceContext->PSSetShaderResources(6, 1, &m_pOceanShaderResourceView);
 
 		// 定数バッファの設定.
 		pDeviceContext->VSSetConstantBuffers(0, 1, &m_pConstantBuffer);
 		pDeviceContext->PSSetConstantBuffers(0, 1, &m_pConstantBuffer);
 
-		pDeviceContext->Draw(VERTEX_NUM, 0);
+		ClipmapDraw();
 	}
 	else
 	{
-		WaveDraw(); // 波マップの描画.
-		BumpDraw();	// 法線マップの描画.
+		// 波マップの描画.
+		if (m_IsCpuWave)
+		{
+			CpuWaveDraw();
+		}
+		else if (m_IsFusedWave)
+		{
+			WaveBumpDraw();
+		}
+		else
+		{
+			WaveDraw();
+		}
+
+		// 法線マップの描画(同時に作成していなければ).
+		if (!m_IsFusedWave)
+		{
+			BumpDraw();
+		}
 
 		pGraphicsDevice->SetScene(Lib::Dx11::GraphicsDevice::BACKBUFFER_TARGET);	// 描画先を設定.
 
 		pDeviceContext->VSSetShader(pShaderManager->GetVertexShader(m_ReflectVertexShaderIndex), nullptr, 0);
 		pDeviceContext->PSSetShader(pShaderManager->GetPixelShader(m_ReflectPixelShaderIndex), nullptr, 0);
-		pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 		pDeviceContext->IASetInputLayout(m_pVertexLayout);
 		pDeviceContext->OMSetDepthStencilState(m_pDepthStencilState, 0);
 		pDeviceContext->OMSetBlendState(m_pBlendState, nullptr, 0xffffffff);
 
-		UINT Stride = sizeof(VERTEX);
-		UINT Offset = 0;
-		pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &Stride, &Offset);
-
 		ID3D11ShaderResourceView* pPuddleResource = pTextureManager->GetTexture(m_PuddleTextureIndex)->Get();
 		ID3D11ShaderResourceView* pSkyResource = pTextureManager->GetTexture(m_SkyCLUTIndex)->Get();
 		ID3D11ShaderResourceView* pColorResource = pTextureManager->GetTexture(m_WaterColorIndex)->Get();
@@ -237,15 +360,28 @@ void Water::Draw()
 		pDeviceContext->PSSetShaderResources(3, 1, &m_pWaveShaderResourceView[m_WaveRenderIndex ^ 1]);
 		pDeviceContext->PSSetShaderResources(4, 1, &m_pBumpShaderResourceView);
 		pDeviceContext->PSSetShaderResources(5, 1, &pColorResource);
+		pDeviceContext->PSSetShaderResources(6, 1, &m_pOceanShaderResourceView);
 
 		// 定数バッファの設定.
 		pDeviceContext->VSSetConstantBuffers(0, 1, &m_pConstantBuffer);
 		pDeviceContext->PSSetConstantBuffers(0, 1, &m_pConstantBuffer);
 
-		pDeviceContext->Draw(VERTEX_NUM, 0);
+		ClipmapDraw();
 	}
 }
 
+bool Water::QueryWave(const float* _pX, const float* _pZ, int _count, float* _pHeight, float* _pNormalX, float* _pNormalY, float* _pNormalZ)
+{
+	if (!m_IsCpuWave)
+	{
+		return false;
+	}
+
+	m_pWaveSimulator->QueryHeight(_pX, _pZ, _count, _pHeight, _pNormalX, _pNormalY, _pNormalZ);
+
+	return true;
+}
+
 
 //----------------------------------------------------------------------
 // Private Functions
@@ -254,31 +390,37 @@ bool Water::CreateVertexBuffer()
 {
 	Lib::Dx11::GraphicsDevice* pGraphicsDevice = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice);
 
+	// 水面は中心のレベルほど細かいクリップマップで描画する.
+	m_pClipmap = new WaterClipmap(m_ClipmapLevelNum, m_ClipmapGridSize, m_ClipmapCellSize);
+	if (!m_pClipmap->Initialize())
+	{
+		OutputErrorLog("クリップマップの初期化に失敗しました");
+		return false;
+	}
+
+	m_pClipmap->SetArea(
+		m_DefaultPos.x - m_DefaultSize.x,
+		m_DefaultPos.z - m_DefaultSize.y,
+		m_DefaultPos.x + m_DefaultSize.x,
+		m_DefaultPos.z + m_DefaultSize.y);
+	m_pClipmap->SetFadeLevel(m_ClipmapFadeLevel);
+
 	D3DXVECTOR3 Normal = D3DXVECTOR3(0, 1, 0);
 	D3DXVECTOR3 Tangent = D3DXVECTOR3(1, 0, 0);
 	D3DXVECTOR3 Binormal = D3DXVECTOR3(0, 0, 1);
 
-	VERTEX VertexData[VERTEX_NUM] =
-	{
-		VERTEX{ D3DXVECTOR3(-m_DefaultSize.x, 0.1f,  m_DefaultSize.y), D3DXVECTOR2(0, 0), Normal, Tangent, Binormal },
-		VERTEX{ D3DXVECTOR3( m_DefaultSize.x, 0.1f,  m_DefaultSize.y), D3DXVECTOR2(1, 0), Normal, Tangent, Binormal },
-		VERTEX{ D3DXVECTOR3(-m_DefaultSize.x, 0.1f, -m_DefaultSize.y), D3DXVECTOR2(0, 1), Normal, Tangent, Binormal },
-		VERTEX{ D3DXVECTOR3( m_DefaultSize.x, 0.1f, -m_DefaultSize.y), D3DXVECTOR2(1, 1), Normal, Tangent, Binormal }
-	};
-
-	for (int i = 0; i < VERTEX_NUM; i++)
-	{
-		m_pVertexData[i].Pos = VertexData[i].Pos;
-		m_pVertexData[i].UV = VertexData[i].UV;
-		m_pVertexData[i].Normal = VertexData[i].Normal;
-		m_pVertexData[i].Tangent = VertexData[i].Tangent;
-		m_pVertexData[i].Binormal = VertexData[i].Binormal;
-	}
+	// 座標とテクスチャ座標は描画のたびに書き込む.
+	VERTEX DefaultVertex = { m_DefaultPos, D3DXVECTOR2(0, 0), Normal, Tangent, Binormal };
+	m_ClipmapVertexData.assign(m_pClipmap->GetVertexNum(), DefaultVertex);
+	m_ClipmapHeight.assign(m_pClipmap->GetVertexNum(), m_WaterClearColor[0]);
+	m_ClipmapDisplace.assign(m_pClipmap->GetVertexNum(), 0.0f);
+	m_ClipmapDisplaceX.assign(m_pClipmap->GetVertexNum(), 0.0f);
+	m_ClipmapDisplaceZ.assign(m_pClipmap->GetVertexNum(), 0.0f);
 
 	// 頂点バッファの設定.
 	D3D11_BUFFER_DESC BufferDesc;
 	ZeroMemory(&BufferDesc, sizeof(D3D11_BUFFER_DESC));
-	BufferDesc.ByteWidth = sizeof(VERTEX) * VERTEX_NUM;
+	BufferDesc.ByteWidth = sizeof(VERTEX) * m_pClipmap->GetVertexNum();
 	BufferDesc.Usage = D3D11_USAGE_DYNAMIC;
 	BufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	BufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
@@ -288,7 +430,7 @@ bool Water::CreateVertexBuffer()
 	// 頂点バッファに格納するデータの設定.
 	D3D11_SUBRESOURCE_DATA ResourceData;
 	ZeroMemory(&ResourceData, sizeof(D3D11_SUBRESOURCE_DATA));
-	ResourceData.pSysMem = m_pVertexData;
+	ResourceData.pSysMem = &m_ClipmapVertexData[0];
 
 	if (FAILED(pGraphicsDevice->GetDevice()->CreateBuffer(
 		&BufferDesc,
@@ -299,6 +441,29 @@ bool Water::CreateVertexBuffer()
 		return false;
 	}
 
+	// インデックスは全てのレベルで共有するので変更しない.
+	D3D11_BUFFER_DESC IndexBufferDesc;
+	ZeroMemory(&IndexBufferDesc, sizeof(D3D11_BUFFER_DESC));
+	IndexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(unsigned short) * m_pClipmap->GetIndex().size());
+	IndexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	IndexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	IndexBufferDesc.CPUAccessFlags = 0;
+	IndexBufferDesc.MiscFlags = 0;
+	IndexBufferDesc.StructureByteStride = 0;
+
+	D3D11_SUBRESOURCE_DATA IndexResourceData;
+	ZeroMemory(&IndexResourceData, sizeof(D3D11_SUBRESOURCE_DATA));
+	IndexResourceData.pSysMem = &m_pClipmap->GetIndex()[0];
+
+	if (FAILED(pGraphicsDevice->GetDevice()->CreateBuffer(
+		&IndexBufferDesc,
+		&IndexResourceData,
+		&m_pIndexBuffer)))
+	{
+		OutputErrorLog("インデックスバッファの生成に失敗しました");
+		return false;
+	}
+
 
 	MAP_VERTEX WaveVertexData[VERTEX_NUM] =
 	{
@@ -404,6 +569,12 @@ bool Water::CreateShader()
 		return false;
 	}
 
+	if (!PixelShaderLoad("Resource\\Effect\\Wave.fx", "PS_WAVEBUMPMAP", &m_WaveBumpPixelShaderIndex))
+	{
+		OutputErrorLog("波マップと法線マップ生成用ピクセルシェーダーの読み込みに失敗しました");
+		return false;
+	}
+
 	return true;
 }
 
@@ -703,6 +874,42 @@ bool Water::CreateCubeMapTexture()
 		return false;
 	}
 
+	// 描画する面だけをクリアするための面ごとのビュー.
+	for (int i = 0; i < 6; i++)
+	{
+		D3D11_RENDER_TARGET_VIEW_DESC FaceRenderTargetDesc = CubeRenderTargetDesc;
+		FaceRenderTargetDesc.Texture2DArray.FirstArraySlice = i;
+		FaceRenderTargetDesc.Texture2DArray.ArraySize = 1;
+
+		if (FAILED(pGraphicsDevice->GetDevice()->CreateRenderTargetView(
+			m_pCubeTexture,
+			&FaceRenderTargetDesc,
+			&m_pCubeFaceRenderTarget[i])))
+		{
+			OutputErrorLog("マップテクスチャの面のレンダーターゲットビューの設定に失敗しました");
+			return false;
+		}
+
+		D3D11_DEPTH_STENCIL_VIEW_DESC FaceDepthStencilDesc;
+		ZeroMemory(&FaceDepthStencilDesc, sizeof(FaceDepthStencilDesc));
+		FaceDepthStencilDesc.Format = DepthStencilTextureDesc.Format;
+		FaceDepthStencilDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		FaceDepthStencilDesc.Texture2DArray.MipSlice = 0;
+		FaceDepthStencilDesc.Texture2DArray.FirstArraySlice = i;
+		FaceDepthStencilDesc.Texture2DArray.ArraySize = 1;
+
+		if (FAILED(pGraphicsDevice->GetDevice()->CreateDepthStencilView(
+			m_pDepthStencilTexture,
+			&FaceDepthStencilDesc,
+			&m_pCubeFaceDepthStencilView[i])))
+		{
+			OutputErrorLog("深度ステンシルビューの面の生成に失敗しました");
+			return false;
+		}
+	}
+
+	m_pCubeFaceScheduler = new CubeFaceScheduler();
+
 	// ビューポート設定.
 	m_ViewPort.TopLeftX = 0;
 	m_ViewPort.TopLeftY = 0;
@@ -998,6 +1205,9 @@ bool Water::CreateReflectMapTexture()
 	pGraphicsDevice->SetClearColor(m_ClearColor, m_ReflectRenderTargetStage);
 	pGraphicsDevice->SetViewPort(&m_ReflectViewPort, m_ReflectRenderTargetStage);
 
+	m_pReflectFrustumCuller = new ReflectFrustumCuller();
+	m_pReflectFrustumCuller->SetWaterHeight(0.0f);	// 反射カメラはy=0で反転している.
+
 
 	if (!WriteReflectMapConstantBuffer())
 	{
@@ -1008,14 +1218,204 @@ bool Water::CreateReflectMapTexture()
 	return true;
 }
 
+bool Water::CreateWaveSimulator()
+{
+	m_pWaveSimulator = new WaveSimulator(
+		static_cast<int>(m_WaveTextureWidth),
+		static_cast<int>(m_WaveTextureHeight));
+
+	if (!m_pWaveSimulator->Initialize())
+	{
+		OutputErrorLog("波シミュレーションの初期化に失敗しました");
+		return false;
+	}
+
+	m_pWaveSimulator->Clear(m_WaterClearColor[0], m_WaterClearColor[1]);
+	m_pWaveSimulator->SetThreadPool(m_pThreadPool);
+	m_pWaveSimulator->SetImpulseQueue(m_pWaveImpulseQueue);
+	m_pWaveSimulator->SetPrecision(m_DefaultWavePrecision);
+
+	// 水面の頂点のテクスチャ座標(0, 0)は(-x, +z)の角.
+	m_pWaveImpulseQueue->SetWorldArea(
+		m_DefaultPos.x - m_DefaultSize.x,
+		m_DefaultPos.z + m_DefaultSize.y,
+		m_DefaultSize.x * 2,
+		m_DefaultSize.y * 2);
+
+	m_pWaveSimulator->SetWorldArea(
+		m_DefaultPos.x - m_DefaultSize.x,
+		m_DefaultPos.z + m_DefaultSize.y,
+		m_DefaultSize.x * 2,
+		m_DefaultSize.y * 2);
+
+	// 障害物のフットプリントは各オブジェクトの生成時に追加されている.
+	m_pWaveObstacleMask->SetWorldArea(
+		m_DefaultPos.x - m_DefaultSize.x,
+		m_DefaultPos.z + m_DefaultSize.y,
+		m_DefaultSize.x * 2,
+		m_DefaultSize.y * 2);
+
+	if (!m_pWaveObstacleMask->Build(m_pWaveSimulator->GetWidth(), m_pWaveSimulator->GetHeight()) ||
+		!m_pWaveSimulator->SetObstacleMask(m_pWaveObstacleMask))
+	{
+		OutputErrorLog("波の障害物マスクの作成に失敗しました");
+		return false;
+	}
+
+	m_WaveMapData.resize(static_cast<size_t>(m_WaveTextureWidth * m_WaveTextureHeight) * 4);
+	m_NormalMapData.resize(m_WaveMapData.size());
+	m_IsMapDataValid = false;
+
+	// 保存しておいた状態があれば平らな水面ではなくその状態から始める(無ければ平らなまま).
+	WaveSnapshot Snapshot;
+	if (Snapshot.Open(m_WaveSnapshotFileName) && m_pWaveSimulator->LoadSnapshot(Snapshot))
+	{
+		// GPUで計算する場合も同じ状態から始めるように両方の波テクスチャに書き込む.
+		int RowPitch = m_pWaveSimulator->GetWidth() * 4;
+		m_pWaveSimulator->WriteWaveMap(&m_WaveMapData[0], RowPitch);
+
+		ID3D11DeviceContext* pDeviceContext = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext();
+		for (int i = 0; i < WAVE_TEXTURE_NUM; i++)
+		{
+			pDeviceContext->UpdateSubresource(m_pWaveTexture[i], 0, nullptr, &m_WaveMapData[0], RowPitch, 0);
+		}
+	}
+
+	return true;
+}
+
+bool Water::CreateObstacleTexture()
+{
+	Lib::Dx11::GraphicsDevice* pGraphicsDevice = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice);
+
+	// Wave.fxの波マップ作成でCPUと同じ境界条件を使うため, マスクを1セル1バイトに展開する.
+	int Width = m_pWaveObstacleMask->GetWidth();
+	int Height = m_pWaveObstacleMask->GetHeight();
+	std::vector<unsigned char> ObstacleData(static_cast<size_t>(Width * Height));
+	m_pWaveObstacleMask->WriteTexture(&ObstacleData[0], Width);
+
+	D3D11_TEXTURE2D_DESC ObstacleTextureDesc;
+	ZeroMemory(&ObstacleTextureDesc, sizeof(ObstacleTextureDesc));
+	ObstacleTextureDesc.Width = static_cast<UINT>(Width);
+	ObstacleTextureDesc.Height = static_cast<UINT>(Height);
+	ObstacleTextureDesc.MipLevels = 1;
+	ObstacleTextureDesc.ArraySize = 1;
+	ObstacleTextureDesc.Format = DXGI_FORMAT_R8_UNORM;
+	ObstacleTextureDesc.SampleDesc.Count = 1;
+	ObstacleTextureDesc.SampleDesc.Quality = 0;
+	ObstacleTextureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	ObstacleTextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	ObstacleTextureDesc.CPUAccessFlags = 0;
+	ObstacleTextureDesc.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA ObstacleSubResource;
+	ZeroMemory(&ObstacleSubResource, sizeof(ObstacleSubResource));
+	ObstacleSubResource.pSysMem = &ObstacleData[0];
+	ObstacleSubResource.SysMemPitch = static_cast<UINT>(Width);
+
+	if (FAILED(pGraphicsDevice->GetDevice()->CreateTexture2D(
+		&ObstacleTextureDesc,
+		&ObstacleSubResource,
+		&m_pObstacleTexture)))
+	{
+		OutputErrorLog("障害物テクスチャ生成に失敗しました");
+		return false;
+	}
+
+	if (FAILED(pGraphicsDevice->GetDevice()->CreateShaderResourceView(
+		m_pObstacleTexture,
+		nullptr,
+		&m_pObstacleShaderResourceView)))
+	{
+		OutputErrorLog("障害物テクスチャのシェーダーリソースビューの生成に失敗しました");
+		return false;
+	}
+
+	return true;
+}
+
+bool Water::CreateOceanSpectrum()
+{
+	Lib::Dx11::GraphicsDevice* pGraphicsDevice = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice);
+
+	m_pOceanSpectrum = new OceanSpectrum(m_OceanSize, m_OceanPatchSize);
+	if (!m_pOceanSpectrum->Initialize())
+	{
+		OutputErrorLog("海の波スペクトルの初期化に失敗しました");
+		return false;
+	}
+
+	m_pOceanSpectrum->SetThreadPool(m_pThreadPool);
+	m_pOceanSpectrum->SetSpectrum(OceanSpectrum::SPECTRUM_JONSWAP);
+	m_pOceanSpectrum->SetWind(m_OceanWindSpeed, 1.0f, 0.3f);
+
+	// 法線マップは格子1つが1テクセルで, 水面に繰り返して貼る.
+	// 最初に計算するまでは上向きの法線にしておく.
+	m_OceanMapData.resize(static_cast<size_t>(m_OceanSize * m_OceanSize) * 4);
+	for (size_t i = 0; i < m_OceanMapData.size(); i += 4)
+	{
+		m_OceanMapData[i + 0] = 128;
+		m_OceanMapData[i + 1] = 255;
+		m_OceanMapData[i + 2] = 128;
+		m_OceanMapData[i + 3] = 255;
+	}
+
+	D3D11_TEXTURE2D_DESC OceanTextureDesc;
+	ZeroMemory(&OceanTextureDesc, sizeof(OceanTextureDesc));
+	OceanTextureDesc.Width = static_cast<UINT>(m_OceanSize);
+	OceanTextureDesc.Height = static_cast<UINT>(m_OceanSize);
+	OceanTextureDesc.MipLevels = 1;
+	OceanTextureDesc.ArraySize = 1;
+	OceanTextureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	OceanTextureDesc.SampleDesc.Count = 1;
+	OceanTextureDesc.SampleDesc.Quality = 0;
+	OceanTextureDesc.Usage = D3D11_USAGE_DEFAULT;
+	OceanTextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	OceanTextureDesc.CPUAccessFlags = 0;
+	OceanTextureDesc.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA OceanInitData;
+	OceanInitData.pSysMem = &m_OceanMapData[0];
+	OceanInitData.SysMemPitch = m_OceanSize * 4;
+	OceanInitData.SysMemSlicePitch = 0;
+
+	if (FAILED(pGraphicsDevice->GetDevice()->CreateTexture2D(
+		&OceanTextureDesc,
+		&OceanInitData,
+		&m_pOceanTexture)))
+	{
+		OutputErrorLog("海の法線マップテクスチャ生成に失敗しました");
+		return false;
+	}
+
+	if (FAILED(pGraphicsDevice->GetDevice()->CreateShaderResourceView(
+		m_pOceanTexture,
+		nullptr,
+		&m_pOceanShaderResourceView)))
+	{
+		OutputErrorLog("海の法線マップテクスチャのシェーダーリソースビューの生成に失敗しました");
+		return false;
+	}
+
+	return true;
+}
+
 void Water::ReleaseVertexBuffer()
 {
 	SafeRelease(m_pWaveVertexBuffer);
+	SafeRelease(m_pIndexBuffer);
 	SafeRelease(m_pVertexBuffer);
+
+	if (m_pClipmap != nullptr)
+	{
+		m_pClipmap->Finalize();
+		SafeDelete(m_pClipmap);
+	}
 }
 
 void Water::ReleaseShader()
 {
+	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleasePixelShader(m_WaveBumpPixelShaderIndex);
 	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleasePixelShader(m_BumpPixelShaderIndex);
 	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleasePixelShader(m_WavePixelShaderIndex);
 	SINGLETON_INSTANCE(Lib::Dx11::ShaderManager)->ReleaseVertexShader(m_WaveVertexShaderIndex);
@@ -1060,6 +1460,14 @@ void Water::ReleaseTexture()
 void Water::ReleaseCubeMapTexture()
 {
 	delete m_pCamera;
+	SafeDelete(m_pCubeFaceScheduler);
+
+	for (int i = 0; i < 6; i++)
+	{
+		SafeRelease(m_pCubeFaceDepthStencilView[i]);
+		SafeRelease(m_pCubeFaceRenderTarget[i]);
+	}
+
 	SafeRelease(m_pDepthStencilView);
 	SafeRelease(m_pDepthStencilTexture);
 	SafeRelease(m_pCubeTextureResource);
@@ -1085,6 +1493,8 @@ void Water::ReleaseWaveMapTexture()
 
 void Water::ReleaseReflectMapTexture()
 {
+	SafeDelete(m_pReflectFrustumCuller);
+
 	SafeRelease(m_pReflectDepthStencilView);
 	SafeRelease(m_pReflectDepthStencilTexture);
 	SafeRelease(m_pReflectShaderResourceView);
@@ -1092,6 +1502,39 @@ void Water::ReleaseReflectMapTexture()
 	SafeRelease(m_pReflectTexture);
 }
 
+void Water::ReleaseWaveSimulator()
+{
+	if (m_pWaveSimulator != nullptr)
+	{
+		m_pWaveSimulator->Finalize();
+		SafeDelete(m_pWaveSimulator);
+	}
+
+	std::vector<unsigned char>().swap(m_WaveMapData);
+	std::vector<unsigned char>().swap(m_NormalMapData);
+	m_pWaveObstacleMask->Release();
+}
+
+void Water::ReleaseObstacleTexture()
+{
+	SafeRelease(m_pObstacleShaderResourceView);
+	SafeRelease(m_pObstacleTexture);
+}
+
+void Water::ReleaseOceanSpectrum()
+{
+	SafeRelease(m_pOceanShaderResourceView);
+	SafeRelease(m_pOceanTexture);
+
+	if (m_pOceanSpectrum != nullptr)
+	{
+		m_pOceanSpectrum->Finalize();
+		SafeDelete(m_pOceanSpectrum);
+	}
+
+	std::vector<unsigned char>().swap(m_OceanMapData);
+}
+
 bool Water::WriteConstantBuffer()
 {
 	D3D11_MAPPED_SUBRESOURCE SubResourceData;
@@ -1116,9 +1559,10 @@ bool Water::WriteConstantBuffer()
 		CONSTANT_BUFFER ConstantBuffer;
 		ConstantBuffer.World = MatWorld;
 		ConstantBuffer.TexelOffset = D3DXVECTOR4(1 / m_WaveTextureWidth, 1 / m_WaveTextureHeight, 0, 0);
-		ConstantBuffer.AddWavePos = D3DXVECTOR4(m_AddWavePos.x, m_AddWavePos.y, 0, 0);
-		ConstantBuffer.AddWaveHeight = D3DXVECTOR4(m_AddWaveHeight, 0, 0, 0);
+		ConstantBuffer.AddWavePos = D3DXVECTOR4(0, 0, 0, 0);
+		ConstantBuffer.AddWaveHeight = D3DXVECTOR4(0, 0, 0, 0);	// 波の追加はCPU側でまとめて行う.
 		ConstantBuffer.MapWorld = MapMatWorld;
+		ConstantBuffer.OceanParam = D3DXVECTOR4(1.0f / m_OceanPatchSize, m_IsOcean ? 1.0f : 0.0f, 0, 0);
 
 		memcpy_s(
 			SubResourceData.pData,
@@ -1207,9 +1651,30 @@ void Water::CubeMapBeginScene()
 	Lib::Dx11::GraphicsDevice* pGraphicsDevice = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice);
 	ID3D11DeviceContext* pDeviceContext = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext();
 
-	pGraphicsDevice->BeginScene(m_CubeRenderTargetStage);
-	
-	// キューブマップ定数バッファの更新と設定.
+	// 水面に映している間だけ更新する面を選ぶ.
+	// 選ばれなかった面は前回の内容を残すので, 全体をクリアするBeginSceneは使わずに選んだ面だけをクリアする.
+	// 水面に映るのは視線を水平面で反転させた向きなので, 反射カメラの視線を使う(ビュー行列の3列目が視線).
+	D3DXMATRIX View = m_pMainCamera->GetReflectViewMatrix();
+	m_pCubeFaceScheduler->SetViewDir(View._13, View._23, View._33);
+	unsigned int FaceMask = m_pCubeFaceScheduler->Schedule();
+
+	pDeviceContext->OMSetRenderTargets(1, &m_pCubeTextureRenderTarget, m_pDepthStencilView);
+	pDeviceContext->RSSetViewports(1, &m_ViewPort);
+
+	for (int i = 0; i < 6; i++)
+	{
+		if ((FaceMask & (1u << i)) != 0)
+		{
+			pDeviceContext->ClearRenderTargetView(m_pCubeFaceRenderTarget[i], m_ClearColor);
+			pDeviceContext->ClearDepthStencilView(m_pCubeFaceDepthStencilView[i], D3D11_CLEAR_DEPTH, 1.0f, 0);
+		}
+	}
+
+	// 選んだ面に写らないオブジェクトは描画タスクで描画を省く.
+	CubeMapDrawTask::SetFrameFaceMask(FaceMask);
+
+	// キューブマップ定数バッファの更新と設定(選ばなかった面にはジオメトリシェーダーが出力しない).
+	m_CubeConstantBuffer.FaceMask[0] = FaceMask;
 	WriteCubeMapConstantBuffer();
 	pDeviceContext->VSSetConstantBuffers(5, 1, &m_pCubeMapConstantBuffer);
 	pDeviceContext->GSSetConstantBuffers(5, 1, &m_pCubeMapConstantBuffer);
@@ -1223,6 +1688,11 @@ void Water::ReflectMapBeginScene()
 
 	pGraphicsDevice->BeginScene(m_ReflectRenderTargetStage);
 
+	// 反射カメラの視錐台を作り, 写らないオブジェクトを描画タスクで省く.
+	D3DXMATRIX ReflectViewProj = m_pMainCamera->GetReflectViewMatrix() * m_pMainCamera->GetReflectProjectionMatrix();
+	m_pReflectFrustumCuller->SetViewProjection(ReflectViewProj);
+	ReflectMapDrawTask::BeginCulling(m_pReflectFrustumCuller);
+
 	// 反射マップ定数バッファの更新と設定.
 	WriteReflectMapConstantBuffer();
 	pDeviceContext->VSSetConstantBuffers(5, 1, &m_pReflectMapConstantBuffer);
@@ -1254,10 +1724,86 @@ void Water::WaveDraw()
 	UINT Offset = 0;
 	pDeviceContext->IASetVertexBuffers(0, 1, &m_pWaveVertexBuffer, &Stride, &Offset);
 	pDeviceContext->PSSetShaderResources(0, 1, &m_pWaveShaderResourceView[m_WaveRenderIndex ^ 1]);
+	pDeviceContext->PSSetShaderResources(1, 1, &m_pObstacleShaderResourceView);
+	pDeviceContext->VSSetConstantBuffers(0, 1, &m_pConstantBuffer);
+	pDeviceContext->PSSetConstantBuffers(0, 1, &m_pConstantBuffer);
+	pDeviceContext->Draw(VERTEX_NUM, 0);
+
+	m_WaveRenderIndex ^= 1; // 描画先のテクスチャを入れ替える.
+}
+
+void Water::CpuWaveDraw()
+{
+	ID3D11DeviceContext* pDeviceContext = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext();
+
+	// キューに溜まった波はタイルごとに振り分けられ, 1回の更新でまとめて反映される.
+	int RowPitch = m_pWaveSimulator->GetWidth() * 4;
+
+	if (m_IsFusedWave)
+	{
+		// 休止中のタイルは書き込まれないので, 転送用データが古ければ先に全体を書き込んでおく.
+		if (!m_IsMapDataValid)
+		{
+			m_pWaveSimulator->WriteWaveMap(&m_WaveMapData[0], RowPitch);
+			m_pWaveSimulator->WriteNormalMap(&m_NormalMapData[0], RowPitch);
+			m_IsMapDataValid = true;
+		}
+
+		// 更新した行から波マップと法線マップを同時に書き出す.
+		// 法線マップはPS_BUMPMAPの出力そのもので, BumpDrawのブレンドは掛からない.
+		m_pWaveSimulator->StepWithMap(&m_WaveMapData[0], RowPitch, &m_NormalMapData[0], RowPitch);
+		pDeviceContext->UpdateSubresource(m_pBumpTexture, 0, nullptr, &m_NormalMapData[0], RowPitch, 0);
+	}
+	else
+	{
+		m_pWaveSimulator->Step();
+		m_pWaveSimulator->WriteWaveMap(&m_WaveMapData[0], RowPitch);
+		m_IsMapDataValid = false;
+	}
+
+	pDeviceContext->UpdateSubresource(m_pWaveTexture[m_WaveRenderIndex], 0, nullptr, &m_WaveMapData[0], RowPitch, 0);
+
+	m_WaveRenderIndex ^= 1; // 描画先のテクスチャを入れ替える.
+}
+
+void Water::WaveBumpDraw()
+{
+	Lib::Dx11::GraphicsDevice* pGraphicsDevice = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice);
+	ID3D11DeviceContext* pDeviceContext = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext();
+	Lib::Dx11::ShaderManager* pShaderManager = SINGLETON_INSTANCE(Lib::Dx11::ShaderManager);
+
+	// 描画先を波マップに変更.
+	pGraphicsDevice->SetRenderTarget(&m_pWaveRenderTarget[m_WaveRenderIndex], m_WaveRenderTargetStage);
+	pGraphicsDevice->SetDepthStencil(&m_pWaveDepthStencilView[m_WaveRenderIndex], m_WaveRenderTargetStage);
+	pGraphicsDevice->SetClearColor(m_WaterClearColor, m_WaveRenderTargetStage);
+	pGraphicsDevice->SetViewPort(&m_ViewPort, m_WaveRenderTargetStage);
+	pGraphicsDevice->BeginScene(m_WaveRenderTargetStage);
+
+	// 法線マップを2枚目の描画先として追加する(ブレンドはBumpDrawと同じ結果になるようにクリアしておく).
+	ID3D11RenderTargetView* pRenderTarget[2] = { m_pWaveRenderTarget[m_WaveRenderIndex], m_pBumpRenderTarget };
+	pDeviceContext->ClearRenderTargetView(m_pBumpRenderTarget, m_ClearColor);
+	pDeviceContext->OMSetRenderTargets(2, pRenderTarget, m_pWaveDepthStencilView[m_WaveRenderIndex]);
+
+	// 描画準備.
+	pDeviceContext->VSSetShader(pShaderManager->GetVertexShader(m_WaveVertexShaderIndex), nullptr, 0);
+	pDeviceContext->PSSetShader(pShaderManager->GetPixelShader(m_WaveBumpPixelShaderIndex), nullptr, 0);
+	pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	pDeviceContext->IASetInputLayout(m_pWaveVertexLayout);
+	pDeviceContext->OMSetDepthStencilState(nullptr, 0);
+	pDeviceContext->OMSetBlendState(m_pBlendState, nullptr, 0xffffffff);
+
+	UINT Stride = sizeof(MAP_VERTEX);
+	UINT Offset = 0;
+	pDeviceContext->IASetVertexBuffers(0, 1, &m_pWaveVertexBuffer, &Stride, &Offset);
+	pDeviceContext->PSSetShaderResources(0, 1, &m_pWaveShaderResourceView[m_WaveRenderIndex ^ 1]);
+	pDeviceContext->PSSetShaderResources(1, 1, &m_pObstacleShaderResourceView);
 	pDeviceContext->VSSetConstantBuffers(0, 1, &m_pConstantBuffer);
 	pDeviceContext->PSSetConstantBuffers(0, 1, &m_pConstantBuffer);
 	pDeviceContext->Draw(VERTEX_NUM, 0);
 
+	// 法線マップをシェーダーリソースとして使えるように描画先から外す.
+	pDeviceContext->OMSetRenderTargets(1, &m_pWaveRenderTarget[m_WaveRenderIndex], m_pWaveDepthStencilView[m_WaveRenderIndex]);
+
 	m_WaveRenderIndex ^= 1; // 描画先のテクスチャを入れ替える.
 }
 
@@ -1294,6 +1840,134 @@ void Water::BumpDraw()
 	pContext->Draw(VERTEX_NUM, 0);
 }
 
+bool Water::WriteClipmapVertex()
+{
+	D3DXVECTOR3 CameraPos = m_pMainCamera->GetPos();
+	bool IsMove = m_pClipmap->Update(CameraPos.x, CameraPos.z);
+
+	// 波で変位させない間は, クリップマップが動かなければ書き込み直す必要が無い.
+	if (!IsMove && !m_IsCpuWave && !m_IsOcean && !m_IsClipmapDisplaced)
+	{
+		return true;
+	}
+
+	const float* pVertexX = m_pClipmap->GetVertexX();
+	const float* pVertexZ = m_pClipmap->GetVertexZ();
+	const float* pWeight = m_pClipmap->GetWeight();
+	int VertexNum = m_pClipmap->GetVertexNum();
+
+	// 変位させるのはフェードするレベルまでで, それより外側は平面のまま.
+	int DisplaceLevelNum = m_pClipmap->GetFadeLevel() + 1;
+	int DisplaceVertexNum = std::min(DisplaceLevelNum * m_pClipmap->GetLevelVertexNum(), VertexNum);
+
+	std::fill(m_ClipmapDisplace.begin(), m_ClipmapDisplace.end(), 0.0f);
+	std::fill(m_ClipmapDisplaceX.begin(), m_ClipmapDisplaceX.end(), 0.0f);
+	std::fill(m_ClipmapDisplaceZ.begin(), m_ClipmapDisplaceZ.end(), 0.0f);
+
+	if (QueryWave(pVertexX, pVertexZ, DisplaceVertexNum, &m_ClipmapHeight[0], nullptr, nullptr, nullptr))
+	{
+		for (int i = 0; i < DisplaceVertexNum; i++)
+		{
+			m_ClipmapDisplace[i] = (m_ClipmapHeight[i] - m_WaterClearColor[0]) * m_WaveDisplacement * pWeight[i];
+		}
+	}
+
+	// 海の波は高さに加えて水平方向にも変位させ, 波頭を尖らせる.
+	if (m_IsOcean)
+	{
+		m_pOceanSpectrum->Sample(
+			pVertexX,
+			pVertexZ,
+			DisplaceVertexNum,
+			&m_ClipmapHeight[0],
+			&m_ClipmapDisplaceX[0],
+			&m_ClipmapDisplaceZ[0]);
+
+		for (int i = 0; i < DisplaceVertexNum; i++)
+		{
+			float Scale = m_OceanScale * pWeight[i];
+			m_ClipmapDisplace[i] += m_ClipmapHeight[i] * Scale;
+			m_ClipmapDisplaceX[i] *= Scale;
+			m_ClipmapDisplaceZ[i] *= Scale;
+		}
+	}
+
+	// レベルの境目でひび割れないように外周の頂点を外側のレベルの辺にそろえる.
+	m_pClipmap->Stitch(&m_ClipmapDisplace[0], DisplaceLevelNum);
+	m_pClipmap->Stitch(&m_ClipmapDisplaceX[0], DisplaceLevelNum);
+	m_pClipmap->Stitch(&m_ClipmapDisplaceZ[0], DisplaceLevelNum);
+
+	m_IsClipmapDisplaced = m_IsCpuWave || m_IsOcean;
+
+	// テクスチャ座標は水全体に対する位置なので, 四角形で描画していた時と同じになる.
+	float MinX = m_DefaultPos.x - m_DefaultSize.x;
+	float MaxZ = m_DefaultPos.z + m_DefaultSize.y;
+	float InvWidth = 1.0f / (m_DefaultSize.x * 2);
+	float InvDepth = 1.0f / (m_DefaultSize.y * 2);
+
+	for (int i = 0; i < VertexNum; i++)
+	{
+		m_ClipmapVertexData[i].Pos = D3DXVECTOR3(
+			pVertexX[i] + m_ClipmapDisplaceX[i],
+			m_DefaultPos.y + m_ClipmapDisplace[i],
+			pVertexZ[i] + m_ClipmapDisplaceZ[i]);
+		m_ClipmapVertexData[i].UV = D3DXVECTOR2((pVertexX[i] - MinX) * InvWidth, (MaxZ - pVertexZ[i]) * InvDepth);
+	}
+
+	D3D11_MAPPED_SUBRESOURCE SubResourceData;
+	if (SUCCEEDED(SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->Map(
+		m_pVertexBuffer,
+		0,
+		D3D11_MAP_WRITE_DISCARD,
+		0,
+		&SubResourceData)))
+	{
+		memcpy_s(
+			SubResourceData.pData,
+			SubResourceData.RowPitch,
+			&m_ClipmapVertexData[0],
+			sizeof(VERTEX) * VertexNum);
+
+		SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext()->Unmap(m_pVertexBuffer, 0);
+
+		return true;
+	}
+
+	return false;
+}
+
+void Water::ClipmapDraw()
+{
+	ID3D11DeviceContext* pDeviceContext = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext();
+
+	if (!WriteClipmapVertex())
+	{
+		OutputErrorLog("クリップマップの頂点の書き込みに失敗しました");
+		return;
+	}
+
+	UINT Stride = sizeof(VERTEX);
+	UINT Offset = 0;
+	pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &Stride, &Offset);
+	pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
+
+	// インデックスは共有し, レベルごとにベース頂点をずらして描画する.
+	for (int i = 0; i < m_pClipmap->GetLevelNum(); i++)
+	{
+		pDeviceContext->DrawIndexed(
+			m_pClipmap->GetIndexNum(i),
+			m_pClipmap->GetIndexStart(i),
+			m_pClipmap->GetBaseVertex(i));
+	}
+}
+
+void Water::OceanMapDraw()
+{
+	ID3D11DeviceContext* pDeviceContext = SINGLETON_INSTANCE(Lib::Dx11::GraphicsDevice)->GetDeviceContext();
+	pDeviceContext->UpdateSubresource(m_pOceanTexture, 0, nullptr, &m_OceanMapData[0], m_OceanSize * 4, 0);
+}
+
 
 //----------------------------------------------------------------------
 // Inner Class Constructor Destructor
@@ -12,14 +12,23 @@
 #include <D3DX11.h>
 #include <D3DX10.h>
 #include <random>
+#include <vector>
 
 #include "ObjectManagerBase\ObjectBase\ObjectBase.h"
 #include "TaskManager\TaskBase\UpdateTask\UpdateTask.h"
 #include "TaskManager\TaskBase\DrawTask\DrawTask.h"
 #include "InputDeviceManager\InputDeviceManager.h"
 #include "WaterDebugFont\WaterDebugFont.h"
+#include "WaveSimulator\WaveSimulator.h"
 
 
+class ThreadPool;
+class MainCamera;
+class WaterClipmap;
+class OceanSpectrum;
+class CubeFaceScheduler;
+class ReflectFrustumCuller;
+
 namespace Lib
 {
 	namespace Dx11
@@ -39,8 +48,12 @@ class Water : public Lib::ObjectBase
 public:
 	/**
 	 * コンストラクタ
+	 * @param[in] _pMainCamera クリップマップの中心にするカメラ
+	 * @param[in] _pThreadPool CPUでの波計算に使用するスレッドプール
+	 * @param[in] _pWaveImpulseQueue 波の追加要求を受け付けるキュー
+	 * @param[in] _pWaveObstacleMask 波を反射させる障害物のマスク
 	 */
-	Water();
+	Water(MainCamera* _pMainCamera, ThreadPool* _pThreadPool, WaveImpulseQueue* _pWaveImpulseQueue, WaveObstacleMask* _pWaveObstacleMask);
 
 	/**
 	 * デストラクタ
@@ -68,6 +81,22 @@ public:
 	 */
 	virtual void Draw();
 
+	/**
+	 * 複数のワールド座標の水面の高さと法線をまとめて取得
+	 *
+	 * 浮いている物体や水しぶきの配置などGPUの波マップを読み戻せない処理から使用する.
+	 * 波マップをGPUで計算している場合はCPU側の高さが古いので取得できない.
+	 * @param[in] _pX 取得する座標のx(_count個)
+	 * @param[in] _pZ 取得する座標のz(_count個)
+	 * @param[in] _count 取得する座標の数
+	 * @param[out] _pHeight 高さの書き込み先(波マップの高さと同じ値)
+	 * @param[out] _pNormalX 法線のx成分の書き込み先(nullptrなら法線を求めない)
+	 * @param[out] _pNormalY 法線のy成分の書き込み先
+	 * @param[out] _pNormalZ 法線のz成分の書き込み先
+	 * @return 取得できたらtrue CPUで波を計算していなければfalse
+	 */
+	bool QueryWave(const float* _pX, const float* _pZ, int _count, float* _pHeight, float* _pNormalX, float* _pNormalY, float* _pNormalZ);
+
 private:
 	/**
 	 * キューブマップ描画前処理のタスク
@@ -142,6 +171,7 @@ private:
 		D3DXVECTOR4 AddWavePos;		//!< 追加する波の座標.
 		D3DXVECTOR4 AddWaveHeight;	//!< 追加する波の高さ.
 		D3DXMATRIX	MapWorld;		//!< 波マップ 法線マップ描画行列.
+		D3DXVECTOR4 OceanParam;		//!< 海の法線マップのパラメータ(x:1 / 格子が覆う大きさ, y:合成の強さ).
 	};
 
 	/**
@@ -151,6 +181,7 @@ private:
 	{
 		D3DXMATRIX View[6];		//!< ビュー変換行列.
 		D3DXMATRIX Proj;		//!< プロジェクション変換行列.
+		unsigned int FaceMask[4];	//!< 描画する面のビットマスク(FaceMask[0]のみ使用).
 	};
 
 	/**
@@ -198,6 +229,18 @@ private:
 	static const int m_WaveRenderTargetStage;	//!< 波マップレンダーターゲットステージ.
 	static const int m_BumpRenderTargetStage;	//!< 法線マップレンダーターゲットステージ.
 	static const int m_ReflectRenderTargetStage;//!< 反射マップレンダーターゲットステージ.
+	static const WaveSimulator::PRECISION m_DefaultWavePrecision;	//!< CPU波計算の計算精度の初期値.
+	static const char* m_WaveSnapshotFileName;	//!< 波の状態のスナップショットファイル名.
+	static const int m_ClipmapLevelNum;			//!< クリップマップのレベルの数.
+	static const int m_ClipmapGridSize;			//!< クリップマップの1レベルのセル数.
+	static const float m_ClipmapCellSize;		//!< クリップマップのレベル0のセルの大きさ.
+	static const int m_ClipmapFadeLevel;		//!< 変位をフェードさせるクリップマップのレベル.
+	static const float m_WaveDisplacement;		//!< 波の高さから頂点の変位への倍率.
+	static const int m_OceanSize;				//!< 海の波スペクトルの格子の大きさ.
+	static const float m_OceanPatchSize;		//!< 海の波スペクトルの格子が覆う大きさ.
+	static const float m_OceanWindSpeed;		//!< 海の波スペクトルの風速.
+	static const float m_OceanScale;			//!< 海の波の高さと変位の倍率.
+	static const float m_OceanTimeStep;			//!< 1フレームで進める海の波の時間.
 
 
 	//----------------------------------------------------------------------
@@ -258,6 +301,24 @@ private:
 	 */
 	bool CreateReflectMapTexture();
 
+	/**
+	 * CPU波シミュレーションの生成
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool CreateWaveSimulator();
+
+	/**
+	 * 障害物テクスチャの生成
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool CreateObstacleTexture();
+
+	/**
+	 * 海の波スペクトルと法線マップテクスチャの生成
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool CreateOceanSpectrum();
+
 
 	//----------------------------------------------------------------------
 	// 解放処理
@@ -308,6 +369,21 @@ private:
 	 */
 	void ReleaseReflectMapTexture();
 
+	/**
+	 * CPU波シミュレーションの解放
+	 */
+	void ReleaseWaveSimulator();
+
+	/**
+	 * 障害物テクスチャの解放
+	 */
+	void ReleaseObstacleTexture();
+
+	/**
+	 * 海の波スペクトルと法線マップテクスチャの解放
+	 */
+	void ReleaseOceanSpectrum();
+
 
 	//----------------------------------------------------------------------
 	// その他処理
@@ -346,11 +422,37 @@ private:
 	 */
 	void WaveDraw();
 
+	/**
+	 * 波マップと法線マップを1回の描画で作成する
+	 */
+	void WaveBumpDraw();
+
+	/**
+	 * 波マップをCPUで計算してテクスチャに転送する
+	 */
+	void CpuWaveDraw();
+
 	/**
 	 * 法線マップの描画
 	 */
 	void BumpDraw();
 
+	/**
+	 * クリップマップの頂点をカメラの位置と波の高さに合わせて頂点バッファに書き込む
+	 * @return 成功したらtrue 失敗したらfalse
+	 */
+	bool WriteClipmapVertex();
+
+	/**
+	 * クリップマップの描画
+	 */
+	void ClipmapDraw();
+
+	/**
+	 * 海の法線マップをテクスチャに転送する
+	 */
+	void OceanMapDraw();
+
 
 	//--------------------タスクオブジェクト--------------------
 	Lib::Draw3DTask*			m_pDraw3DTask;				//!< 3D描画タスクオブジェクト.
@@ -361,7 +463,16 @@ private:
 
 	//--------------------その他オブジェクト--------------------
 	Lib::Dx11::Camera*			m_pCamera;					//!< カメラオブジェクト.
+	MainCamera*					m_pMainCamera;				//!< クリップマップの中心にするカメラ.
 	WaterDebugFont*				m_pDebugFont;				//!< 水デバッグフォントクラス.	
+	ThreadPool*					m_pThreadPool;				//!< CPUでの波計算に使用するスレッドプール.
+	WaveSimulator*				m_pWaveSimulator;			//!< CPU波シミュレーションオブジェクト.
+	WaveImpulseQueue*			m_pWaveImpulseQueue;		//!< 波の追加要求を受け付けるキュー.
+	WaveObstacleMask*			m_pWaveObstacleMask;		//!< 波を反射させる障害物のマスク.
+	WaterClipmap*				m_pClipmap;					//!< 水面のクリップマップメッシュ.
+	OceanSpectrum*				m_pOceanSpectrum;			//!< 海の波スペクトル生成オブジェクト.
+	CubeFaceScheduler*			m_pCubeFaceScheduler;		//!< キューブマップの面の更新スケジューラ.
+	ReflectFrustumCuller*		m_pReflectFrustumCuller;	//!< 反射マップの視錐台カリングオブジェクト.
 
 
 	//--------------------描画関連--------------------
@@ -370,15 +481,22 @@ private:
 	int							m_ReflectVertexShaderIndex;		//!< 反射頂点シェーダーインデックス.
 	int							m_ReflectPixelShaderIndex;		//!< 反射ピクセルシェーダーインデックス.
 	ID3D11Buffer*				m_pVertexBuffer;				//!< 頂点バッファ.
+	ID3D11Buffer*				m_pIndexBuffer;					//!< インデックスバッファ.
 	ID3D11InputLayout*			m_pVertexLayout;				//!< 頂点入力レイアウト.
 	ID3D11DepthStencilState*	m_pDepthStencilState;			//!< 深度ステンシルステート.
 	ID3D11BlendState*			m_pBlendState;					//!< ブレンドステート.
-	VERTEX						m_pVertexData[VERTEX_NUM];		//!< 頂点データ.
+	std::vector<VERTEX>			m_ClipmapVertexData;			//!< クリップマップの頂点データ.
+	std::vector<float>			m_ClipmapHeight;				//!< クリップマップの頂点の波の高さ.
+	std::vector<float>			m_ClipmapDisplace;				//!< クリップマップの頂点の変位.
+	std::vector<float>			m_ClipmapDisplaceX;				//!< クリップマップの頂点の水平方向の変位のx.
+	std::vector<float>			m_ClipmapDisplaceZ;				//!< クリップマップの頂点の水平方向の変位のz.
+	bool						m_IsClipmapDisplaced;			//!< 頂点バッファに波の変位が書き込まれているか.
 
 	ID3D11Buffer*				m_pConstantBuffer;				//!< 水描画の定数バッファ.
 	ID3D11Texture2D*			m_pCubeTexture;					//!< 波情報が入ったテクスチャ.
 	ID3D11ShaderResourceView*	m_pCubeTextureResource;			//!< 波テクスチャのリソースビュー.
 	ID3D11RenderTargetView*		m_pCubeTextureRenderTarget;		//!< 波テクスチャレンダーターゲットビュー.
+	ID3D11RenderTargetView*		m_pCubeFaceRenderTarget[6];		//!< 面ごとのレンダーターゲットビュー(描画する面だけクリアする).
 	ID3D11Buffer*				m_pCubeMapConstantBuffer;		//!< キューブマップ作成の定数バッファ.
 	int							m_PuddleTextureIndex;			//!< 水たまりテクスチャインデックス.
 	int							m_SkyCLUTIndex;					//!< 空のカラーテーブルテクスチャインデックス.
@@ -386,6 +504,7 @@ private:
 
 	ID3D11Texture2D*			m_pDepthStencilTexture;			//!< 深度ステンシルテクスチャ.
 	ID3D11DepthStencilView*		m_pDepthStencilView;			//!< 深度ステンシルビュー.
+	ID3D11DepthStencilView*		m_pCubeFaceDepthStencilView[6];	//!< 面ごとの深度ステンシルビュー.
 	D3D11_VIEWPORT				m_ViewPort;						//!< ビューポート.
 
 	D3DXMATRIX					m_ViewMat[6];					//!< ビュー変換行列.
@@ -405,23 +524,33 @@ private:
 	ID3D11RenderTargetView*		m_pBumpRenderTarget;			//!< 法線テクスチャのレンダーターゲットビュー.
 	ID3D11ShaderResourceView*	m_pBumpShaderResourceView;		//!< 法線テクスチャのシェーダーリソースビュー.
 
+	ID3D11Texture2D*			m_pObstacleTexture;				//!< 障害物テクスチャ.
+	ID3D11ShaderResourceView*	m_pObstacleShaderResourceView;	//!< 障害物テクスチャのシェーダーリソースビュー.
+
+	ID3D11Texture2D*			m_pOceanTexture;				//!< 海の法線マップテクスチャ.
+	ID3D11ShaderResourceView*	m_pOceanShaderResourceView;		//!< 海の法線マップテクスチャのシェーダーリソースビュー.
+	std::vector<unsigned char>	m_OceanMapData;					//!< 海の法線マップの転送用データ.
+	float						m_OceanTime;					//!< 海の波の時刻.
+	bool						m_IsOcean;						//!< 海の波を合成するか.
+
 	int							m_WaveVertexShaderIndex;		//!< 頂点シェーダーインデックス.
 	int							m_WavePixelShaderIndex;			//!< ピクセルシェーダーインデックス.
 	int							m_BumpPixelShaderIndex;			//!< ピクセルシェーダーインデックス.
+	int							m_WaveBumpPixelShaderIndex;		//!< 波マップと法線マップの同時作成ピクセルシェーダーインデックス.
 	int							m_WaveRenderIndex;				//!< 描画する波テクスチャのインデックス.
 
 	ID3D11Buffer*				m_pWaveVertexBuffer;			//!< 頂点バッファ.
 	ID3D11InputLayout*			m_pWaveVertexLayout;			//!< 頂点入力レイアウト.
 	MAP_VERTEX					m_pWaveVertexData[VERTEX_NUM];	//!< 頂点データ.
 
-	D3DXVECTOR2					m_AddWavePos;
-	float						m_AddWaveHeight;
-
 	std::random_device			m_RandDevice;				//!< 乱数生成デバイス.
 	std::mt19937				m_MersenneTwister;			//!< 乱数生成オブジェクト.
-	int							m_WaveAddTime;
-	int							m_WaveAddCount;
 	bool						m_IsCubeMapDraw;
+	bool						m_IsCpuWave;					//!< 波マップをCPUで計算するか.
+	bool						m_IsFusedWave;					//!< 波マップと法線マップを1回で作成するか.
+	std::vector<unsigned char>	m_WaveMapData;					//!< CPUで計算した波マップの転送用データ.
+	std::vector<unsigned char>	m_NormalMapData;				//!< CPUで計算した法線マップの転送用データ.
+	bool						m_IsMapDataValid;				//!< 転送用データが全て現在の波マップの内容か.
 
 	ID3D11Texture2D*			m_pReflectTexture;
 	ID3D11Texture2D*			m_pReflectDepthStencilTexture;
@@ -0,0 +1,266 @@
+﻿/**
+ * @file	WaterClipmap.cpp
+ * @brief	水面のクリップマップメッシュ生成クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaterClipmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+WaterClipmap::WaterClipmap(int _levelNum, int _gridSize, float _cellSize) :
+	m_LevelNum(_levelNum),
+	m_GridSize(_gridSize),
+	m_CellSize(_cellSize),
+	m_FadeLevel(_levelNum),
+	m_MinX(-1.0e+6f),
+	m_MinZ(-1.0e+6f),
+	m_MaxX(1.0e+6f),
+	m_MaxZ(1.0e+6f),
+	m_IsValid(false)
+{
+	for (int i = 0; i < PATTERN_NUM; i++)
+	{
+		m_PatternIndexStart[i] = 0;
+		m_PatternIndexNum[i] = 0;
+	}
+}
+
+WaterClipmap::~WaterClipmap()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool WaterClipmap::Initialize()
+{
+	// 穴の位置をN/4セル単位で扱うので4の倍数に限る.
+	if (m_LevelNum <= 0 || m_GridSize < 4 || (m_GridSize & 3) != 0 || m_CellSize <= 0.0f)
+	{
+		return false;
+	}
+
+	// 16bitのインデックスで1レベル分の頂点を指せる必要がある.
+	if (GetLevelVertexNum() > 0x10000)
+	{
+		return false;
+	}
+
+	m_Index.clear();
+	for (int i = 0; i < PATTERN_NUM; i++)
+	{
+		AddPatternIndex(i);
+	}
+
+	m_OriginX.assign(m_LevelNum, 0);
+	m_OriginZ.assign(m_LevelNum, 0);
+	m_Pattern.assign(m_LevelNum, PATTERN_FULL);
+	m_VertexX.assign(GetVertexNum(), 0.0f);
+	m_VertexZ.assign(GetVertexNum(), 0.0f);
+	m_Weight.assign(GetVertexNum(), 0.0f);
+	m_IsValid = false;
+
+	return true;
+}
+
+void WaterClipmap::Finalize()
+{
+	std::vector<unsigned short>().swap(m_Index);
+	std::vector<int>().swap(m_OriginX);
+	std::vector<int>().swap(m_OriginZ);
+	std::vector<int>().swap(m_Pattern);
+	std::vector<float>().swap(m_VertexX);
+	std::vector<float>().swap(m_VertexZ);
+	std::vector<float>().swap(m_Weight);
+	m_IsValid = false;
+}
+
+void WaterClipmap::SetArea(float _minX, float _minZ, float _maxX, float _maxZ)
+{
+	m_MinX = _minX;
+	m_MinZ = _minZ;
+	m_MaxX = _maxX;
+	m_MaxZ = _maxZ;
+	m_IsValid = false;
+}
+
+void WaterClipmap::SetFadeLevel(int _level)
+{
+	// レベル0には内側の穴が無いので, フェードはレベル1以降で行う.
+	m_FadeLevel = std::min(std::max(_level, 1), m_LevelNum);
+	m_IsValid = false;
+}
+
+bool WaterClipmap::Update(float _x, float _z)
+{
+	bool IsChange = !m_IsValid;
+	int QuarterSize = m_GridSize / 4;
+
+	// 原点は1つ外側のレベルのセル(2セル)単位に丸める.
+	for (int i = 0; i < m_LevelNum; i++)
+	{
+		float DoubleCellSize = std::ldexp(m_CellSize, i + 1);
+		int OriginX = 2 * static_cast<int>(std::floor(_x / DoubleCellSize - static_cast<float>(QuarterSize)));
+		int OriginZ = 2 * static_cast<int>(std::floor(_z / DoubleCellSize - static_cast<float>(QuarterSize)));
+
+		if (OriginX != m_OriginX[i] || OriginZ != m_OriginZ[i])
+		{
+			m_OriginX[i] = OriginX;
+			m_OriginZ[i] = OriginZ;
+			IsChange = true;
+		}
+	}
+
+	if (!IsChange)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < m_LevelNum; i++)
+	{
+		if (i == 0)
+		{
+			m_Pattern[i] = PATTERN_FULL;
+		}
+		else
+		{
+			// 内側のレベルの原点は外側のレベルのN/4かN/4+1セル目になる.
+			int HoleX = m_OriginX[i - 1] / 2 - m_OriginX[i] - QuarterSize;
+			int HoleZ = m_OriginZ[i - 1] / 2 - m_OriginZ[i] - QuarterSize;
+			m_Pattern[i] = PATTERN_RING + HoleX + HoleZ * 2;
+		}
+
+		UpdateLevelVertex(i);
+	}
+
+	m_IsValid = true;
+
+	return true;
+}
+
+void WaterClipmap::Stitch(float* _pValue, int _levelNum) const
+{
+	int Size = m_GridSize;
+	int Pitch = m_GridSize + 1;
+
+	for (int i = 0; i < std::min(_levelNum, m_LevelNum); i++)
+	{
+		float* pLevel = _pValue + GetBaseVertex(i);
+
+		for (int j = 1; j < Size; j += 2)
+		{
+			// 手前と奥の辺.
+			pLevel[j] = (pLevel[j - 1] + pLevel[j + 1]) * 0.5f;
+			pLevel[Size * Pitch + j] = (pLevel[Size * Pitch + j - 1] + pLevel[Size * Pitch + j + 1]) * 0.5f;
+
+			// 左右の辺.
+			pLevel[j * Pitch] = (pLevel[(j - 1) * Pitch] + pLevel[(j + 1) * Pitch]) * 0.5f;
+			pLevel[j * Pitch + Size] = (pLevel[(j - 1) * Pitch + Size] + pLevel[(j + 1) * Pitch + Size]) * 0.5f;
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void WaterClipmap::AddPatternIndex(int _pattern)
+{
+	int Pitch = m_GridSize + 1;
+	int HoleMinX = m_GridSize;
+	int HoleMinZ = m_GridSize;
+	if (_pattern != PATTERN_FULL)
+	{
+		HoleMinX = m_GridSize / 4 + ((_pattern - PATTERN_RING) & 1);
+		HoleMinZ = m_GridSize / 4 + ((_pattern - PATTERN_RING) >> 1);
+	}
+
+	int HoleMaxX = HoleMinX + m_GridSize / 2;
+	int HoleMaxZ = HoleMinZ + m_GridSize / 2;
+
+	m_PatternIndexStart[_pattern] = static_cast<int>(m_Index.size());
+
+	for (int z = 0; z < m_GridSize; z++)
+	{
+		for (int x = 0; x < m_GridSize; x++)
+		{
+			if (x >= HoleMinX && x < HoleMaxX && z >= HoleMinZ && z < HoleMaxZ)
+			{
+				continue;
+			}
+
+			// 上から見て時計回り(水の四角形と同じ向き).
+			unsigned short Near0 = static_cast<unsigned short>(z * Pitch + x);
+			unsigned short Near1 = static_cast<unsigned short>(Near0 + 1);
+			unsigned short Far0 = static_cast<unsigned short>(Near0 + Pitch);
+			unsigned short Far1 = static_cast<unsigned short>(Far0 + 1);
+
+			m_Index.push_back(Far0);
+			m_Index.push_back(Far1);
+			m_Index.push_back(Near0);
+			m_Index.push_back(Far1);
+			m_Index.push_back(Near1);
+			m_Index.push_back(Near0);
+		}
+	}
+
+	m_PatternIndexNum[_pattern] = static_cast<int>(m_Index.size()) - m_PatternIndexStart[_pattern];
+}
+
+void WaterClipmap::UpdateLevelVertex(int _level)
+{
+	int Pitch = m_GridSize + 1;
+	float CellSize = std::ldexp(m_CellSize, _level);
+	float* pVertexX = &m_VertexX[GetBaseVertex(_level)];
+	float* pVertexZ = &m_VertexZ[GetBaseVertex(_level)];
+	float* pWeight = &m_Weight[GetBaseVertex(_level)];
+
+	// フェードするレベルは穴(内側のレベル)からの距離で重みを下げ, 外周で0にする.
+	int HoleMinX = 0;
+	int HoleMinZ = 0;
+	if (m_Pattern[_level] != PATTERN_FULL)
+	{
+		HoleMinX = m_GridSize / 4 + ((m_Pattern[_level] - PATTERN_RING) & 1);
+		HoleMinZ = m_GridSize / 4 + ((m_Pattern[_level] - PATTERN_RING) >> 1);
+	}
+
+	int HoleMaxX = HoleMinX + m_GridSize / 2;
+	int HoleMaxZ = HoleMinZ + m_GridSize / 2;
+	float InvFadeWidth = 1.0f / static_cast<float>(std::max(m_GridSize / 4 - 1, 1));
+
+	for (int z = 0; z <= m_GridSize; z++)
+	{
+		float PosZ = std::min(std::max(static_cast<float>(m_OriginZ[_level] + z) * CellSize, m_MinZ), m_MaxZ);
+
+		for (int x = 0; x <= m_GridSize; x++)
+		{
+			int Index = z * Pitch + x;
+			pVertexX[Index] = std::min(std::max(static_cast<float>(m_OriginX[_level] + x) * CellSize, m_MinX), m_MaxX);
+			pVertexZ[Index] = PosZ;
+
+			if (_level < m_FadeLevel)
+			{
+				pWeight[Index] = 1.0f;
+			}
+			else if (_level > m_FadeLevel)
+			{
+				pWeight[Index] = 0.0f;
+			}
+			else
+			{
+				int Distance = std::max(std::max(HoleMinX - x, x - HoleMaxX), std::max(HoleMinZ - z, z - HoleMaxZ));
+				pWeight[Index] = std::max(1.0f - static_cast<float>(std::max(Distance, 0)) * InvFadeWidth, 0.0f);
+			}
+		}
+	}
+}
@@ -0,0 +1,233 @@
+﻿/**
+ * @file	WaterClipmap.h
+ * @brief	水面のクリップマップメッシュ生成クラス定義
+ * @author	morimoto
+ */
+#ifndef WATERCLIPMAP_H
+#define WATERCLIPMAP_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+
+/**
+ * 水面のクリップマップメッシュ生成クラス
+ *
+ * カメラを中心に, セルの大きさが1段ごとに2倍になるN x Nセルの格子(レベル)を重ねて水面のメッシュを作る.
+ * レベル0は格子全体を, レベル1以降は内側のレベルが占めるN/2 x N/2セルの穴を空けたリングを描画する.
+ *
+ * 各レベルの原点は1つ外側のレベルのセルの大きさに合わせて丸めるので, 頂点は常にワールド座標の決まった位置に乗り,
+ * カメラが動いても波が泳がない. 丸めによって穴の位置は外側のレベルのN/4かN/4+1セル目のどちらかになるので,
+ * 穴の位置が異なる4種類のリングのインデックスを全てのレベルで共有する.
+ * 頂点は全てのレベルで(N+1) x (N+1)個の同じ並びなので, インデックスは16bitのままベース頂点をずらして描画する.
+ *
+ * 内側のレベルの外周の奇数番目の頂点は外側のレベルの辺の途中にあるので, Stitchで両隣の平均にそろえてひび割れを防ぐ.
+ * 変位の重みはフェードするレベルの外周に向けて0になり, それより外側のレベルは変位しない.
+ */
+class WaterClipmap
+{
+public:
+	/**
+	 * コンストラクタ
+	 * @param[in] _levelNum レベルの数
+	 * @param[in] _gridSize 1レベルのセル数(4の倍数)
+	 * @param[in] _cellSize レベル0のセルの大きさ
+	 */
+	WaterClipmap(int _levelNum, int _gridSize, float _cellSize);
+
+	/**
+	 * デストラクタ
+	 */
+	~WaterClipmap();
+
+	/**
+	 * 初期化処理
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool Initialize();
+
+	/**
+	 * 終了処理
+	 */
+	void Finalize();
+
+	/**
+	 * 頂点を収める範囲を設定(範囲外の頂点は端に寄せる)
+	 * @param[in] _minX 範囲の左端のx座標
+	 * @param[in] _minZ 範囲の手前のz座標
+	 * @param[in] _maxX 範囲の右端のx座標
+	 * @param[in] _maxZ 範囲の奥のz座標
+	 */
+	void SetArea(float _minX, float _minZ, float _maxX, float _maxZ);
+
+	/**
+	 * 変位をフェードさせるレベルを設定
+	 * @param[in] _level フェードさせるレベル(これより外側のレベルは変位しない)
+	 */
+	void SetFadeLevel(int _level);
+
+	/**
+	 * カメラの位置に合わせて頂点を更新
+	 * @param[in] _x カメラのx座標
+	 * @param[in] _z カメラのz座標
+	 * @return 頂点の位置が変わったらtrue
+	 */
+	bool Update(float _x, float _z);
+
+	/**
+	 * 各レベルの外周の奇数番目の頂点の値を両隣の平均にそろえる
+	 * @param[in,out] _pValue 頂点ごとの値(変位など)
+	 * @param[in] _levelNum そろえるレベルの数
+	 */
+	void Stitch(float* _pValue, int _levelNum) const;
+
+	/**
+	 * レベルの数を取得
+	 * @return レベルの数
+	 */
+	int GetLevelNum() const
+	{
+		return m_LevelNum;
+	}
+
+	/**
+	 * 変位をフェードさせるレベルを取得
+	 * @return フェードさせるレベル
+	 */
+	int GetFadeLevel() const
+	{
+		return m_FadeLevel;
+	}
+
+	/**
+	 * 1レベルの頂点数を取得
+	 * @return 1レベルの頂点数
+	 */
+	int GetLevelVertexNum() const
+	{
+		return (m_GridSize + 1) * (m_GridSize + 1);
+	}
+
+	/**
+	 * 全てのレベルの頂点数を取得
+	 * @return 頂点数
+	 */
+	int GetVertexNum() const
+	{
+		return m_LevelNum * GetLevelVertexNum();
+	}
+
+	/**
+	 * 頂点のx座標を取得
+	 * @return x座標の配列(GetVertexNum個)
+	 */
+	const float* GetVertexX() const
+	{
+		return &m_VertexX[0];
+	}
+
+	/**
+	 * 頂点のz座標を取得
+	 * @return z座標の配列(GetVertexNum個)
+	 */
+	const float* GetVertexZ() const
+	{
+		return &m_VertexZ[0];
+	}
+
+	/**
+	 * 頂点の変位の重みを取得
+	 * @return 重みの配列(GetVertexNum個, 0～1)
+	 */
+	const float* GetWeight() const
+	{
+		return &m_Weight[0];
+	}
+
+	/**
+	 * インデックスを取得
+	 * @return 全てのレベルで共有するインデックス
+	 */
+	const std::vector<unsigned short>& GetIndex() const
+	{
+		return m_Index;
+	}
+
+	/**
+	 * レベルの描画に使うインデックスの開始位置を取得
+	 * @param[in] _level レベル
+	 * @return インデックスの開始位置
+	 */
+	int GetIndexStart(int _level) const
+	{
+		return m_PatternIndexStart[m_Pattern[_level]];
+	}
+
+	/**
+	 * レベルの描画に使うインデックスの数を取得
+	 * @param[in] _level レベル
+	 * @return インデックスの数
+	 */
+	int GetIndexNum(int _level) const
+	{
+		return m_PatternIndexNum[m_Pattern[_level]];
+	}
+
+	/**
+	 * レベルの頂点の開始位置を取得
+	 * @param[in] _level レベル
+	 * @return 頂点の開始位置(ベース頂点)
+	 */
+	int GetBaseVertex(int _level) const
+	{
+		return _level * GetLevelVertexNum();
+	}
+
+private:
+	enum
+	{
+		PATTERN_FULL,	//!< 穴の無い格子.
+		PATTERN_RING,	//!< 穴の位置が異なる4種類のリングの先頭.
+		PATTERN_NUM = PATTERN_RING + 4
+	};
+
+	/**
+	 * 指定したパターンのインデックスを追加
+	 * @param[in] _pattern パターン
+	 */
+	void AddPatternIndex(int _pattern);
+
+	/**
+	 * レベルの頂点の位置と重みを更新
+	 * @param[in] _level レベル
+	 */
+	void UpdateLevelVertex(int _level);
+
+
+	int							m_LevelNum;			//!< レベルの数.
+	int							m_GridSize;			//!< 1レベルのセル数.
+	float						m_CellSize;			//!< レベル0のセルの大きさ.
+	int							m_FadeLevel;		//!< 変位をフェードさせるレベル.
+	float						m_MinX;				//!< 頂点を収める範囲の左端.
+	float						m_MinZ;				//!< 頂点を収める範囲の手前.
+	float						m_MaxX;				//!< 頂点を収める範囲の右端.
+	float						m_MaxZ;				//!< 頂点を収める範囲の奥.
+
+	std::vector<unsigned short>	m_Index;			//!< 全てのパターンのインデックス.
+	int							m_PatternIndexStart[PATTERN_NUM];	//!< パターンごとのインデックスの開始位置.
+	int							m_PatternIndexNum[PATTERN_NUM];		//!< パターンごとのインデックスの数.
+
+	std::vector<int>			m_OriginX;			//!< レベルごとの原点のx(そのレベルのセル単位).
+	std::vector<int>			m_OriginZ;			//!< レベルごとの原点のz(そのレベルのセル単位).
+	std::vector<int>			m_Pattern;			//!< レベルごとの描画パターン.
+	std::vector<float>			m_VertexX;			//!< 頂点のx座標.
+	std::vector<float>			m_VertexZ;			//!< 頂点のz座標.
+	std::vector<float>			m_Weight;			//!< 頂点の変位の重み.
+	bool						m_IsValid;			//!< 頂点が一度でも作成されたか.
+
+};
+
+
+#endif // !WATERCLIPMAP_H
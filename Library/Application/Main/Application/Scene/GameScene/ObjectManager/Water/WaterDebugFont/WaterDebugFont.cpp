@@ -16,7 +16,18 @@
 // Constructor	Destructor
 //----------------------------------------------------------------------
 WaterDebugFont::WaterDebugFont() : 
-	m_IsCubeMap(true)
+	m_IsCubeMap(true),
+	m_IsCpuWave(false),
+	m_IsFusedWave(true),
+	m_IsFixedWave(false),
+	m_ActiveWaveTileNum(0),
+	m_WaveTileNum(0),
+	m_IsOcean(false),
+	m_OceanTime(0.0f),
+	m_CubeFaceBudget(0),
+	m_CubeMaxStaleness(0),
+	m_ReflectVisibleNum(0),
+	m_ReflectCulledNum(0)
 {
 }
 
@@ -67,10 +78,44 @@ void WaterDebugFont::Draw()
 	{
 		m_pFont->Draw(&D3DXVECTOR2(25, 50), "Water : CubeMap");
 		m_pFont->Draw(&D3DXVECTOR2(D3DXVECTOR2(25, 50).x + 320, D3DXVECTOR2(25, 50).y), "T key");
+
+		char CubeStr[64];
+		sprintf_s(CubeStr, 64, "Cube  : %d/6 faces stale %d", m_CubeFaceBudget, m_CubeMaxStaleness);
+		m_pFont->Draw(&D3DXVECTOR2(25, 110), CubeStr);
+		m_pFont->Draw(&D3DXVECTOR2(D3DXVECTOR2(25, 110).x + 320, D3DXVECTOR2(25, 110).y), "K key");
 	}
 	else
 	{
 		m_pFont->Draw(&D3DXVECTOR2(25, 50), "Water : ReflectMap");
 		m_pFont->Draw(&D3DXVECTOR2(D3DXVECTOR2(25, 50).x + 320, D3DXVECTOR2(25, 50).y), "T key");
+
+		if (m_IsCpuWave)
+		{
+			char WaveStr[64];
+			sprintf_s(WaveStr, 64, "Wave  : CPU %s %d/%d%s",
+				m_IsFixedWave ? "Q14" : "F32", m_ActiveWaveTileNum, m_WaveTileNum, m_IsFusedWave ? " Fused" : "");
+			m_pFont->Draw(&D3DXVECTOR2(25, 110), WaveStr);
+		}
+		else
+		{
+			m_pFont->Draw(&D3DXVECTOR2(25, 110), m_IsFusedWave ? "Wave  : GPU Fused" : "Wave  : GPU");
+		}
+		m_pFont->Draw(&D3DXVECTOR2(D3DXVECTOR2(25, 110).x + 320, D3DXVECTOR2(25, 110).y), "C/F/X key");
+
+		char ReflectStr[64];
+		sprintf_s(ReflectStr, 64, "Reflect: %d drawn %d culled", m_ReflectVisibleNum, m_ReflectCulledNum);
+		m_pFont->Draw(&D3DXVECTOR2(25, 170), ReflectStr);
+	}
+
+	if (m_IsOcean)
+	{
+		char OceanStr[64];
+		sprintf_s(OceanStr, 64, "Ocean : FFT 256 %.2fms", m_OceanTime);
+		m_pFont->Draw(&D3DXVECTOR2(25, 140), OceanStr);
+	}
+	else
+	{
+		m_pFont->Draw(&D3DXVECTOR2(25, 140), "Ocean : Off");
 	}
+	m_pFont->Draw(&D3DXVECTOR2(D3DXVECTOR2(25, 140).x + 320, D3DXVECTOR2(25, 140).y), "O key");
 }
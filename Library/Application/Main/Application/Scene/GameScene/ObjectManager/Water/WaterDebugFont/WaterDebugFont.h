@@ -54,9 +54,98 @@ public:
 		m_IsCubeMap = _isCubeMap;
 	}
 
+	/**
+	 * 波マップをCPUで計算しているかのフラグを設定
+	 * @param[in] _isCpuWave 波マップをCPUで計算しているか
+	 */
+	void SetIsCpuWave(bool _isCpuWave)
+	{
+		m_IsCpuWave = _isCpuWave;
+	}
+
+	/**
+	 * 波マップと法線マップを1回で作成しているかのフラグを設定
+	 * @param[in] _isFusedWave 波マップと法線マップを1回で作成しているか
+	 */
+	void SetIsFusedWave(bool _isFusedWave)
+	{
+		m_IsFusedWave = _isFusedWave;
+	}
+
+	/**
+	 * CPU波計算を固定小数点で行っているかのフラグを設定
+	 * @param[in] _isFixedWave CPU波計算を固定小数点で行っているか
+	 */
+	void SetIsFixedWave(bool _isFixedWave)
+	{
+		m_IsFixedWave = _isFixedWave;
+	}
+
+	/**
+	 * CPU波計算で更新したタイル数を設定
+	 * @param[in] _activeTileNum 更新したタイル数
+	 * @param[in] _tileNum 全体のタイル数
+	 */
+	void SetWaveTileNum(int _activeTileNum, int _tileNum)
+	{
+		m_ActiveWaveTileNum = _activeTileNum;
+		m_WaveTileNum = _tileNum;
+	}
+
+	/**
+	 * 海の波を合成しているかのフラグを設定
+	 * @param[in] _isOcean 海の波を合成しているか
+	 */
+	void SetIsOcean(bool _isOcean)
+	{
+		m_IsOcean = _isOcean;
+	}
+
+	/**
+	 * 海の波の計算時間を設定
+	 * @param[in] _oceanTime 計算時間(ミリ秒)
+	 */
+	void SetOceanTime(float _oceanTime)
+	{
+		m_OceanTime = _oceanTime;
+	}
+
+	/**
+	 * キューブマップの面の更新状態を設定
+	 * @param[in] _faceBudget 1フレームに描画する面の数
+	 * @param[in] _maxStaleness 最も古い面の最後に描画してからのフレーム数
+	 */
+	void SetCubeFace(int _faceBudget, int _maxStaleness)
+	{
+		m_CubeFaceBudget = _faceBudget;
+		m_CubeMaxStaleness = _maxStaleness;
+	}
+
+	/**
+	 * 反射マップのカリング結果を設定
+	 * @param[in] _visibleNum 反射マップに描画したオブジェクトの数
+	 * @param[in] _culledNum カリングしたオブジェクトの数
+	 */
+	void SetReflectCullNum(int _visibleNum, int _culledNum)
+	{
+		m_ReflectVisibleNum = _visibleNum;
+		m_ReflectCulledNum = _culledNum;
+	}
+
 private:
 	Lib::Dx11::Font*	m_pFont;	//!< フォント描画オブジェクト.
 	bool				m_IsCubeMap;//!< キューブマップを使用しているかのフラグ.
+	bool				m_IsCpuWave;//!< 波マップをCPUで計算しているかのフラグ.
+	bool				m_IsFusedWave;			//!< 波マップと法線マップを1回で作成しているかのフラグ.
+	bool				m_IsFixedWave;			//!< CPU波計算を固定小数点で行っているかのフラグ.
+	int					m_ActiveWaveTileNum;	//!< CPU波計算で更新したタイル数.
+	int					m_WaveTileNum;			//!< CPU波計算の全体のタイル数.
+	bool				m_IsOcean;				//!< 海の波を合成しているかのフラグ.
+	float				m_OceanTime;			//!< 海の波の計算時間(ミリ秒).
+	int					m_CubeFaceBudget;		//!< キューブマップの1フレームに描画する面の数.
+	int					m_CubeMaxStaleness;		//!< キューブマップの最も古い面のフレーム数.
+	int					m_ReflectVisibleNum;	//!< 反射マップに描画したオブジェクトの数.
+	int					m_ReflectCulledNum;		//!< 反射マップでカリングしたオブジェクトの数.
 
 };
 
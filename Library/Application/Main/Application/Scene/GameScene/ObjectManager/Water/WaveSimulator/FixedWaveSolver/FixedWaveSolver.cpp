@@ -0,0 +1,1196 @@
+﻿/**
+ * @file	FixedWaveSolver.cpp
+ * @brief	固定小数点波計算クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "FixedWaveSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSimulator.h"
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const int FixedWaveSolver::m_FixedShift = 14;
+const int FixedWaveSolver::m_FixedOne = 1 << 14;
+const float FixedWaveSolver::m_InvFixedOne = 1.0f / 16384.0f;
+const int FixedWaveSolver::m_BandHeight = 64;
+const float FixedWaveSolver::m_MaxStepError = 4.0f / 16384.0f;
+const int FixedWaveSolver::m_MaxOutputError = 24;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+FixedWaveSolver::FixedWaveSolver(int _width, int _height) :
+	m_Width(_width),
+	m_Height(_height),
+	m_Stride(((_width + 2) + 15) & ~15),
+	m_Spring(0),
+	m_SimdType(CpuFeature::GetSimdType()),
+	m_pThreadPool(nullptr),
+	m_ReadIndex(0),
+	m_AddTop(0),
+	m_AddBottom(0),
+	m_pObstacleMask(nullptr)
+{
+	SetSpringPower(WaveSimulator::m_DefaultSpringPower);
+}
+
+FixedWaveSolver::~FixedWaveSolver()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool FixedWaveSolver::Initialize()
+{
+	if (m_Width <= 0 || m_Height <= 0)
+	{
+		return false;
+	}
+
+	size_t CellNum = static_cast<size_t>(m_Stride) * (m_Height + 2);
+	for (int i = 0; i < 2; i++)
+	{
+		m_WaveHeight[i].assign(CellNum, 0);
+		m_WaveVelocity[i].assign(CellNum, 0);
+	}
+
+	m_AddVelocity.assign(CellNum, 0);
+	m_AddTop = 0;
+	m_AddBottom = 0;
+	m_ZeroRow.assign(m_Stride, 0);
+	m_IsRowObstacle.assign(m_Height, 0);
+
+	Clear(WaveSimulator::m_DefaultWaveHeight, WaveSimulator::m_DefaultWaveVelocity);
+
+	return true;
+}
+
+void FixedWaveSolver::Finalize()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		std::vector<short>().swap(m_WaveHeight[i]);
+		std::vector<short>().swap(m_WaveVelocity[i]);
+	}
+
+	std::vector<short>().swap(m_AddVelocity);
+	std::vector<short>().swap(m_ZeroRow);
+	std::vector<unsigned char>().swap(m_IsRowObstacle);
+}
+
+void FixedWaveSolver::Clear(float _height, float _velocity)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		std::fill(m_WaveHeight[i].begin(), m_WaveHeight[i].end(), ToFixed(_height));
+		std::fill(m_WaveVelocity[i].begin(), m_WaveVelocity[i].end(), ToFixed(_velocity));
+	}
+
+	m_ReadIndex = 0;
+}
+
+void FixedWaveSolver::SetState(const float* _pHeight, const float* _pVelocity, int _stride)
+{
+	for (int y = 0; y < m_Height; y++)
+	{
+		short* pHeight = &m_WaveHeight[m_ReadIndex][CellIndex(0, y)];
+		short* pVelocity = &m_WaveVelocity[m_ReadIndex][CellIndex(0, y)];
+		const float* pInHeight = _pHeight + static_cast<size_t>(y) * _stride;
+		const float* pInVelocity = _pVelocity + static_cast<size_t>(y) * _stride;
+
+		for (int x = 0; x < m_Width; x++)
+		{
+			pHeight[x] = ToFixed(pInHeight[x]);
+			pVelocity[x] = ToFixed(pInVelocity[x]);
+		}
+	}
+}
+
+void FixedWaveSolver::GetState(float* _pHeight, float* _pVelocity, int _stride) const
+{
+	for (int y = 0; y < m_Height; y++)
+	{
+		const short* pHeight = &m_WaveHeight[m_ReadIndex][CellIndex(0, y)];
+		const short* pVelocity = &m_WaveVelocity[m_ReadIndex][CellIndex(0, y)];
+		float* pOutHeight = _pHeight + static_cast<size_t>(y) * _stride;
+		float* pOutVelocity = _pVelocity + static_cast<size_t>(y) * _stride;
+
+		for (int x = 0; x < m_Width; x++)
+		{
+			pOutHeight[x] = static_cast<float>(pHeight[x]) * m_InvFixedOne;
+			pOutVelocity[x] = static_cast<float>(pVelocity[x]) * m_InvFixedOne;
+		}
+	}
+}
+
+void FixedWaveSolver::Step(const std::vector<WaveImpulseQueue::IMPULSE>& _impulse, void* _pWaveMap, int _waveRowPitch, void* _pNormalMap, int _normalRowPitch)
+{
+	UpdateHalo(m_ReadIndex);
+	BuildAddVelocity(_impulse);
+
+	STEPROW_FUNC pStepRow = GetStepRowFunc(m_SimdType);
+	STEPROW_MASK_FUNC pStepRowMask = GetStepRowMaskFunc(m_SimdType);
+	WAVEMAPROW_FUNC pWaveMapRow = GetWaveMapRowFunc(m_SimdType);
+	NORMALMAPROW_FUNC pNormalMapRow = GetNormalMapRowFunc(m_SimdType);
+
+	int WriteIndex = m_ReadIndex ^ 1;
+	const short* pHeight = &m_WaveHeight[m_ReadIndex][0];
+	const short* pVelocity = &m_WaveVelocity[m_ReadIndex][0];
+	short* pOutHeight = &m_WaveHeight[WriteIndex][0];
+	short* pOutVelocity = &m_WaveVelocity[WriteIndex][0];
+
+	ForEachBand([&](int _minY, int _maxY)
+	{
+		for (int y = _minY; y < _maxY; y++)
+		{
+			int Index = CellIndex(0, y);
+			const short* pAddVelocity = (y >= m_AddTop && y < m_AddBottom) ? &m_AddVelocity[Index] : &m_ZeroRow[0];
+			if (m_IsRowObstacle[y])
+			{
+				pStepRowMask(
+					pHeight + Index - m_Stride,
+					pHeight + Index,
+					pHeight + Index + m_Stride,
+					pVelocity + Index,
+					pAddVelocity,
+					pOutHeight + Index,
+					pOutVelocity + Index,
+					m_Width,
+					m_Spring,
+					m_pObstacleMask->GetRowMask(0, y));
+			}
+			else
+			{
+				pStepRow(
+					pHeight + Index - m_Stride,
+					pHeight + Index,
+					pHeight + Index + m_Stride,
+					pVelocity + Index,
+					pAddVelocity,
+					pOutHeight + Index,
+					pOutVelocity + Index,
+					m_Width,
+					m_Spring);
+			}
+
+			// 更新した行がキャッシュに残っているうちに書き出す.
+			if (_pWaveMap != nullptr)
+			{
+				pWaveMapRow(pOutHeight + Index, pOutVelocity + Index, static_cast<unsigned char*>(_pWaveMap) + static_cast<size_t>(y) * _waveRowPitch, m_Width);
+			}
+
+			if (_pNormalMap != nullptr)
+			{
+				pNormalMapRow(pHeight + Index - m_Stride, pHeight + Index, pHeight + Index + m_Stride, static_cast<unsigned char*>(_pNormalMap) + static_cast<size_t>(y) * _normalRowPitch, m_Width);
+			}
+		}
+	});
+
+	// 展開した加算値を次のステップのために消しておく.
+	if (m_AddTop < m_AddBottom)
+	{
+		std::fill(m_AddVelocity.begin() + CellIndex(-1, m_AddTop), m_AddVelocity.begin() + CellIndex(-1, m_AddBottom), 0);
+		m_AddTop = 0;
+		m_AddBottom = 0;
+	}
+
+	m_ReadIndex = WriteIndex;
+}
+
+void FixedWaveSolver::WriteWaveMap(void* _pData, int _rowPitch) const
+{
+	WAVEMAPROW_FUNC pWaveMapRow = GetWaveMapRowFunc(m_SimdType);
+	ForEachBand([&](int _minY, int _maxY)
+	{
+		for (int y = _minY; y < _maxY; y++)
+		{
+			unsigned char* pPixel = static_cast<unsigned char*>(_pData) + static_cast<size_t>(y) * _rowPitch;
+			pWaveMapRow(&m_WaveHeight[m_ReadIndex][CellIndex(0, y)], &m_WaveVelocity[m_ReadIndex][CellIndex(0, y)], pPixel, m_Width);
+		}
+	});
+}
+
+void FixedWaveSolver::WriteNormalMap(void* _pData, int _rowPitch)
+{
+	UpdateHalo(m_ReadIndex);
+
+	NORMALMAPROW_FUNC pNormalMapRow = GetNormalMapRowFunc(m_SimdType);
+	const short* pHeight = &m_WaveHeight[m_ReadIndex][0];
+	ForEachBand([&](int _minY, int _maxY)
+	{
+		for (int y = _minY; y < _maxY; y++)
+		{
+			unsigned char* pPixel = static_cast<unsigned char*>(_pData) + static_cast<size_t>(y) * _rowPitch;
+			int Index = CellIndex(0, y);
+			pNormalMapRow(pHeight + Index - m_Stride, pHeight + Index, pHeight + Index + m_Stride, pPixel, m_Width);
+		}
+	});
+}
+
+void FixedWaveSolver::SetObstacleMask(const WaveObstacleMask* _pObstacleMask)
+{
+	m_pObstacleMask = _pObstacleMask;
+	m_IsRowObstacle.assign(m_Height, 0);
+
+	if (m_pObstacleMask == nullptr)
+	{
+		return;
+	}
+
+	for (int y = 0; y < m_Height; y++)
+	{
+		m_IsRowObstacle[y] = m_pObstacleMask->IsAnySolid(0, y - 1, m_Width, y + 2) ? 1 : 0;
+	}
+}
+
+void FixedWaveSolver::SetSpringPower(float _springPower)
+{
+	// 積の上位を取るため32768倍で保持する(1.0は表現できないので最大値に丸める).
+	float Spring = std::floor(_springPower * 32768.0f + 0.5f);
+	m_Spring = static_cast<short>(std::min(std::max(Spring, 0.0f), 32767.0f));
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void FixedWaveSolver::UpdateHalo(int _index)
+{
+	short* pHeight = &m_WaveHeight[_index][0];
+
+	for (int y = 0; y < m_Height; y++)
+	{
+		short* pRow = pHeight + CellIndex(0, y);
+		pRow[-1] = pRow[0];
+		pRow[m_Width] = pRow[m_Width - 1];
+	}
+
+	std::copy(
+		pHeight + CellIndex(-1, 0),
+		pHeight + CellIndex(-1, 0) + m_Stride,
+		pHeight + CellIndex(-1, -1));
+	std::copy(
+		pHeight + CellIndex(-1, m_Height - 1),
+		pHeight + CellIndex(-1, m_Height - 1) + m_Stride,
+		pHeight + CellIndex(-1, m_Height));
+}
+
+void FixedWaveSolver::BuildAddVelocity(const std::vector<WaveImpulseQueue::IMPULSE>& _impulse)
+{
+	m_AddTop = m_Height;
+	m_AddBottom = 0;
+
+	for (size_t i = 0; i < _impulse.size(); i++)
+	{
+		const WaveImpulseQueue::IMPULSE& Impulse = _impulse[i];
+
+		// 範囲と距離の判定はWaveSimulatorと同じ.
+		int MinX = std::max(static_cast<int>((Impulse.U - Impulse.Radius) * m_Width) - 1, 0);
+		int MinY = std::max(static_cast<int>((Impulse.V - Impulse.Radius) * m_Height) - 1, 0);
+		int MaxX = std::min(static_cast<int>((Impulse.U + Impulse.Radius) * m_Width) + 1, m_Width - 1);
+		int MaxY = std::min(static_cast<int>((Impulse.V + Impulse.Radius) * m_Height) + 1, m_Height - 1);
+		if (Impulse.Radius <= 0.0f || MinX > MaxX || MinY > MaxY)
+		{
+			continue;
+		}
+
+		if (Impulse.IsDrop)
+		{
+			m_AddTop = std::min(m_AddTop, MinY);
+			m_AddBottom = std::max(m_AddBottom, MaxY + 1);
+
+			for (int y = MinY; y <= MaxY; y++)
+			{
+				short* pRow = &m_AddVelocity[CellIndex(0, y)];
+				for (int x = MinX; x <= MaxX; x++)
+				{
+					int Velocity = static_cast<int>(std::floor(WaveImpulseQueue::GetDropVelocity(Impulse, x, y, m_Width, m_Height) * m_FixedOne + 0.5));
+					pRow[x] = static_cast<short>(std::min(std::max(pRow[x] + Velocity, -32768), 32767));
+				}
+			}
+
+			continue;
+		}
+
+		float Strength = std::floor(Impulse.Strength * m_FixedOne + 0.5f);
+		int FixedStrength = static_cast<int>(std::min(std::max(Strength, -32768.0f), 32767.0f));
+		float RadiusSq = Impulse.Radius * Impulse.Radius;
+
+		for (int y = MinY; y <= MaxY; y++)
+		{
+			float DistV = (static_cast<float>(y) + 0.5f) / static_cast<float>(m_Height) - Impulse.V;
+			if (DistV * DistV >= RadiusSq)
+			{
+				continue;
+			}
+
+			m_AddTop = std::min(m_AddTop, y);
+			m_AddBottom = std::max(m_AddBottom, y + 1);
+
+			short* pRow = &m_AddVelocity[CellIndex(0, y)];
+			for (int x = MinX; x <= MaxX; x++)
+			{
+				float DistU = (static_cast<float>(x) + 0.5f) / static_cast<float>(m_Width) - Impulse.U;
+				if (DistU * DistU + DistV * DistV < RadiusSq)
+				{
+					pRow[x] = static_cast<short>(std::min(std::max(pRow[x] + FixedStrength, -32768), 32767));
+				}
+			}
+		}
+	}
+
+	if (m_AddTop >= m_AddBottom)
+	{
+		m_AddTop = 0;
+		m_AddBottom = 0;
+	}
+}
+
+template <typename Func>
+void FixedWaveSolver::ForEachBand(const Func& _func) const
+{
+	int BandNum = (m_Height + m_BandHeight - 1) / m_BandHeight;
+	auto BandFunc = [this, &_func](int _band)
+	{
+		int MinY = _band * m_BandHeight;
+		_func(MinY, std::min(MinY + m_BandHeight, m_Height));
+	};
+
+	// 各行は前ステップのバッファを読んで別のバッファに書き込むので順不同で更新できる.
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelFor(BandNum, BandFunc);
+	}
+	else
+	{
+		for (int i = 0; i < BandNum; i++)
+		{
+			BandFunc(i);
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+short FixedWaveSolver::ToFixed(float _value)
+{
+	float Value = std::min(std::max(_value, 0.0f), 1.0f);
+	return static_cast<short>(Value * m_FixedOne + 0.5f);
+}
+
+FixedWaveSolver::STEPROW_FUNC FixedWaveSolver::GetStepRowFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &StepRowAVX2;
+	case CpuFeature::SIMD_SSE:	return &StepRowSSE;
+	case CpuFeature::SIMD_NEON:	return &StepRowNEON;
+	default:					return &StepRowScalar;
+	}
+}
+
+FixedWaveSolver::STEPROW_MASK_FUNC FixedWaveSolver::GetStepRowMaskFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &StepRowMaskAVX2;
+	case CpuFeature::SIMD_SSE:	return &StepRowMaskSSE;
+	case CpuFeature::SIMD_NEON:	return &StepRowMaskNEON;
+	default:					return &StepRowMaskScalar;
+	}
+}
+
+FixedWaveSolver::WAVEMAPROW_FUNC FixedWaveSolver::GetWaveMapRowFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &WaveMapRowAVX2;
+	case CpuFeature::SIMD_SSE:	return &WaveMapRowSSE;
+	case CpuFeature::SIMD_NEON:	return &WaveMapRowNEON;
+	default:					return &WaveMapRowScalar;
+	}
+}
+
+FixedWaveSolver::NORMALMAPROW_FUNC FixedWaveSolver::GetNormalMapRowFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &NormalMapRowAVX2;
+	case CpuFeature::SIMD_SSE:	return &NormalMapRowSSE;
+	case CpuFeature::SIMD_NEON:	return &NormalMapRowNEON;
+	default:					return &NormalMapRowScalar;
+	}
+}
+
+void FixedWaveSolver::StepRowScalar(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring)
+{
+	const int One = m_FixedOne;
+	const int Damping = ToFixed(WaveSimulator::m_Damping);
+	const int VelocityShift = WaveSimulator::m_VelocityDecayShift;
+	const int VelocityRound = (1 << VelocityShift) - 1;
+	const int RestHeight = ToFixed(WaveSimulator::m_DefaultWaveHeight);
+	const int HeightShift = WaveSimulator::m_HeightDecayShift;
+	const int HeightRound = (1 << HeightShift) - 1;
+
+	for (int i = 0; i < _count; i++)
+	{
+		// SIMD版の切り上げ平均(pavgw)と同じ丸めで周囲の平均を求める.
+		int Average = (((_pCenter[i + 1] + _pDown[i] + 1) >> 1) + ((_pCenter[i - 1] + _pUp[i] + 1) >> 1) + 1) >> 1;
+		int Velocity = _pVelocity[i] + (((Average - _pCenter[i]) * _spring) >> 15);
+
+		// 静止時の速度と高さからのずれを, 減らす量を0から離れる方向に切り上げて減衰させる(ずれは必ず0に近づく).
+		int VelocityDeviation = Velocity - Damping;
+		Velocity -= (VelocityDeviation + (VelocityDeviation >= 0 ? VelocityRound : 0)) >> VelocityShift;
+
+		// SIMD版の飽和演算と同じく途中の値を16bitに丸める.
+		int Height = std::min(std::max(_pCenter[i] + Velocity, -32768), 32767) - Damping;
+		int HeightDeviation = Height - RestHeight;
+		Height -= (HeightDeviation + (HeightDeviation >= 0 ? HeightRound : 0)) >> HeightShift;
+		Velocity = std::min(std::max(Velocity + _pAddVelocity[i], -32768), 32767);
+
+		_pOutHeight[i] = static_cast<short>(std::min(std::max(Height, 0), One));
+		_pOutVelocity[i] = static_cast<short>(std::min(std::max(Velocity, 0), One));
+	}
+}
+
+void FixedWaveSolver::StepRowMaskScalar(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	const int One = m_FixedOne;
+	const int Damping = ToFixed(WaveSimulator::m_Damping);
+	const int VelocityShift = WaveSimulator::m_VelocityDecayShift;
+	const int VelocityRound = (1 << VelocityShift) - 1;
+	const int RestHeight = ToFixed(WaveSimulator::m_DefaultWaveHeight);
+	const int HeightShift = WaveSimulator::m_HeightDecayShift;
+	const int HeightRound = (1 << HeightShift) - 1;
+
+	for (int i = 0; i < _count; i++)
+	{
+		// 障害物の隣接セルは中心セルの値に置き換えて反射させる.
+		int Bit = _mask.Bit + i;
+		int Center = _pCenter[i];
+		int Right = WaveObstacleMask::TestBit(_mask.pCenter, Bit + 1) ? Center : _pCenter[i + 1];
+		int Down = WaveObstacleMask::TestBit(_mask.pDown, Bit) ? Center : _pDown[i];
+		int Left = WaveObstacleMask::TestBit(_mask.pCenter, Bit - 1) ? Center : _pCenter[i - 1];
+		int Up = WaveObstacleMask::TestBit(_mask.pUp, Bit) ? Center : _pUp[i];
+
+		int Average = (((Right + Down + 1) >> 1) + ((Left + Up + 1) >> 1) + 1) >> 1;
+		int Velocity = _pVelocity[i] + (((Average - Center) * _spring) >> 15);
+		int VelocityDeviation = Velocity - Damping;
+		Velocity -= (VelocityDeviation + (VelocityDeviation >= 0 ? VelocityRound : 0)) >> VelocityShift;
+		int Height = std::min(std::max(Center + Velocity, -32768), 32767) - Damping;
+		int HeightDeviation = Height - RestHeight;
+		Height -= (HeightDeviation + (HeightDeviation >= 0 ? HeightRound : 0)) >> HeightShift;
+		Velocity = std::min(std::max(Velocity + _pAddVelocity[i], -32768), 32767);
+
+		// 障害物のセル自身は値を保持する.
+		bool IsSolid = WaveObstacleMask::TestBit(_mask.pCenter, Bit);
+		_pOutHeight[i] = IsSolid ? _pCenter[i] : static_cast<short>(std::min(std::max(Height, 0), One));
+		_pOutVelocity[i] = IsSolid ? _pVelocity[i] : static_cast<short>(std::min(std::max(Velocity, 0), One));
+	}
+}
+
+void FixedWaveSolver::WaveMapRowScalar(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count)
+{
+	const int Round = 1 << (m_FixedShift - 1);
+
+	for (int i = 0; i < _count; i++)
+	{
+		_pOut[0] = static_cast<unsigned char>((_pHeight[i] * 255 + Round) >> m_FixedShift);
+		_pOut[1] = static_cast<unsigned char>((_pVelocity[i] * 255 + Round) >> m_FixedShift);
+		_pOut[2] = 0;
+		_pOut[3] = 255;
+		_pOut += 4;
+	}
+}
+
+void FixedWaveSolver::NormalMapRowScalar(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count)
+{
+	const int One = m_FixedOne;
+	const int Round = 1 << (m_FixedShift - 1);
+
+	for (int i = 0; i < _count; i++)
+	{
+		// (左 - 右) * 0.5 + 0.5などを固定小数点で求める.
+		int TangentU = (_pCenter[i - 1] - _pCenter[i + 1] + One) >> 1;
+		int TangentV = (_pUp[i] - _pDown[i] + One) >> 1;
+		int Height = (_pCenter[i] + One) >> 1;
+
+		_pOut[0] = static_cast<unsigned char>((TangentU * 255 + Round) >> m_FixedShift);
+		_pOut[1] = 255;
+		_pOut[2] = static_cast<unsigned char>((TangentV * 255 + Round) >> m_FixedShift);
+		_pOut[3] = static_cast<unsigned char>((Height * 255 + Round) >> m_FixedShift);
+		_pOut += 4;
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void FixedWaveSolver::StepRowSSE(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring)
+{
+	const __m128i Spring = _mm_set1_epi16(_spring);
+	const __m128i Damping = _mm_set1_epi16(ToFixed(WaveSimulator::m_Damping));
+	const __m128i VelocityShift = _mm_cvtsi32_si128(WaveSimulator::m_VelocityDecayShift);
+	const __m128i VelocityRound = _mm_set1_epi16(static_cast<short>((1 << WaveSimulator::m_VelocityDecayShift) - 1));
+	const __m128i RestHeight = _mm_set1_epi16(ToFixed(WaveSimulator::m_DefaultWaveHeight));
+	const __m128i HeightShift = _mm_cvtsi32_si128(WaveSimulator::m_HeightDecayShift);
+	const __m128i HeightRound = _mm_set1_epi16(static_cast<short>((1 << WaveSimulator::m_HeightDecayShift) - 1));
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i One = _mm_set1_epi16(static_cast<short>(m_FixedOne));
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m128i Center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i));
+		__m128i Average = _mm_avg_epu16(
+			_mm_avg_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i + 1)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pDown + i))),
+			_mm_avg_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i - 1)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pUp + i))));
+
+		// (差 * ばねの強さ) >> 15を積の上位と下位から組み立てる.
+		__m128i Diff = _mm_sub_epi16(Average, Center);
+		__m128i Force = _mm_or_si128(
+			_mm_slli_epi16(_mm_mulhi_epi16(Diff, Spring), 1),
+			_mm_srli_epi16(_mm_mullo_epi16(Diff, Spring), 15));
+
+		__m128i Velocity = _mm_adds_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pVelocity + i)), Force);
+		__m128i VelocityDeviation = _mm_sub_epi16(Velocity, Damping);
+		VelocityDeviation = _mm_add_epi16(VelocityDeviation, _mm_andnot_si128(_mm_srai_epi16(VelocityDeviation, 15), VelocityRound));
+		Velocity = _mm_sub_epi16(Velocity, _mm_sra_epi16(VelocityDeviation, VelocityShift));
+		__m128i Height = _mm_subs_epi16(_mm_adds_epi16(Center, Velocity), Damping);
+		__m128i HeightDeviation = _mm_sub_epi16(Height, RestHeight);
+		HeightDeviation = _mm_add_epi16(HeightDeviation, _mm_andnot_si128(_mm_srai_epi16(HeightDeviation, 15), HeightRound));
+		Height = _mm_sub_epi16(Height, _mm_sra_epi16(HeightDeviation, HeightShift));
+		Velocity = _mm_adds_epi16(Velocity, _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pAddVelocity + i)));
+
+		Height = _mm_min_epi16(_mm_max_epi16(Height, Zero), One);
+		Velocity = _mm_min_epi16(_mm_max_epi16(Velocity, Zero), One);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOutHeight + i), Height);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOutVelocity + i), Velocity);
+	}
+
+	if (i < _count)
+	{
+		StepRowScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _spring);
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void FixedWaveSolver::StepRowAVX2(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring)
+{
+	const __m256i Spring = _mm256_set1_epi16(_spring);
+	const __m256i Damping = _mm256_set1_epi16(ToFixed(WaveSimulator::m_Damping));
+	const __m128i VelocityShift = _mm_cvtsi32_si128(WaveSimulator::m_VelocityDecayShift);
+	const __m256i VelocityRound = _mm256_set1_epi16(static_cast<short>((1 << WaveSimulator::m_VelocityDecayShift) - 1));
+	const __m256i RestHeight = _mm256_set1_epi16(ToFixed(WaveSimulator::m_DefaultWaveHeight));
+	const __m128i HeightShift = _mm_cvtsi32_si128(WaveSimulator::m_HeightDecayShift);
+	const __m256i HeightRound = _mm256_set1_epi16(static_cast<short>((1 << WaveSimulator::m_HeightDecayShift) - 1));
+	const __m256i Zero = _mm256_setzero_si256();
+	const __m256i One = _mm256_set1_epi16(static_cast<short>(m_FixedOne));
+
+	int i = 0;
+	for (; i + 16 <= _count; i += 16)
+	{
+		__m256i Center = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i));
+		__m256i Average = _mm256_avg_epu16(
+			_mm256_avg_epu16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i + 1)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pDown + i))),
+			_mm256_avg_epu16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i - 1)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pUp + i))));
+
+		__m256i Diff = _mm256_sub_epi16(Average, Center);
+		__m256i Force = _mm256_or_si256(
+			_mm256_slli_epi16(_mm256_mulhi_epi16(Diff, Spring), 1),
+			_mm256_srli_epi16(_mm256_mullo_epi16(Diff, Spring), 15));
+
+		__m256i Velocity = _mm256_adds_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pVelocity + i)), Force);
+		__m256i VelocityDeviation = _mm256_sub_epi16(Velocity, Damping);
+		VelocityDeviation = _mm256_add_epi16(VelocityDeviation, _mm256_andnot_si256(_mm256_srai_epi16(VelocityDeviation, 15), VelocityRound));
+		Velocity = _mm256_sub_epi16(Velocity, _mm256_sra_epi16(VelocityDeviation, VelocityShift));
+		__m256i Height = _mm256_subs_epi16(_mm256_adds_epi16(Center, Velocity), Damping);
+		__m256i HeightDeviation = _mm256_sub_epi16(Height, RestHeight);
+		HeightDeviation = _mm256_add_epi16(HeightDeviation, _mm256_andnot_si256(_mm256_srai_epi16(HeightDeviation, 15), HeightRound));
+		Height = _mm256_sub_epi16(Height, _mm256_sra_epi16(HeightDeviation, HeightShift));
+		Velocity = _mm256_adds_epi16(Velocity, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pAddVelocity + i)));
+
+		Height = _mm256_min_epi16(_mm256_max_epi16(Height, Zero), One);
+		Velocity = _mm256_min_epi16(_mm256_max_epi16(Velocity, Zero), One);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOutHeight + i), Height);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOutVelocity + i), Velocity);
+	}
+
+	if (i < _count)
+	{
+		StepRowSSE(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _spring);
+	}
+}
+
+CPUFEATURE_TARGET_SSE
+void FixedWaveSolver::StepRowMaskSSE(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	const __m128i Spring = _mm_set1_epi16(_spring);
+	const __m128i Damping = _mm_set1_epi16(ToFixed(WaveSimulator::m_Damping));
+	const __m128i VelocityShift = _mm_cvtsi32_si128(WaveSimulator::m_VelocityDecayShift);
+	const __m128i VelocityRound = _mm_set1_epi16(static_cast<short>((1 << WaveSimulator::m_VelocityDecayShift) - 1));
+	const __m128i RestHeight = _mm_set1_epi16(ToFixed(WaveSimulator::m_DefaultWaveHeight));
+	const __m128i HeightShift = _mm_cvtsi32_si128(WaveSimulator::m_HeightDecayShift);
+	const __m128i HeightRound = _mm_set1_epi16(static_cast<short>((1 << WaveSimulator::m_HeightDecayShift) - 1));
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i One = _mm_set1_epi16(static_cast<short>(m_FixedOne));
+	const __m128i LaneBit = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		// 左隣から読み込んだビット列を1ビットずつずらし, 左, 中心, 右のレーンマスクに展開する.
+		unsigned int RowBits = WaveObstacleMask::LoadBits(_mask.pCenter, _mask.Bit + i - 1);
+		__m128i SolidLeft = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(static_cast<short>(RowBits)), LaneBit), LaneBit);
+		__m128i Solid = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(static_cast<short>(RowBits >> 1)), LaneBit), LaneBit);
+		__m128i SolidRight = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(static_cast<short>(RowBits >> 2)), LaneBit), LaneBit);
+		__m128i SolidUp = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(static_cast<short>(WaveObstacleMask::LoadBits(_mask.pUp, _mask.Bit + i))), LaneBit), LaneBit);
+		__m128i SolidDown = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(static_cast<short>(WaveObstacleMask::LoadBits(_mask.pDown, _mask.Bit + i))), LaneBit), LaneBit);
+
+		// 障害物の隣接セルは中心セルの値に置き換える.
+		__m128i Center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i));
+		__m128i OldVelocity = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pVelocity + i));
+		__m128i Right = _mm_or_si128(_mm_and_si128(SolidRight, Center), _mm_andnot_si128(SolidRight, _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i + 1))));
+		__m128i Down = _mm_or_si128(_mm_and_si128(SolidDown, Center), _mm_andnot_si128(SolidDown, _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pDown + i))));
+		__m128i Left = _mm_or_si128(_mm_and_si128(SolidLeft, Center), _mm_andnot_si128(SolidLeft, _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i - 1))));
+		__m128i Up = _mm_or_si128(_mm_and_si128(SolidUp, Center), _mm_andnot_si128(SolidUp, _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pUp + i))));
+		__m128i Average = _mm_avg_epu16(_mm_avg_epu16(Right, Down), _mm_avg_epu16(Left, Up));
+
+		__m128i Diff = _mm_sub_epi16(Average, Center);
+		__m128i Force = _mm_or_si128(
+			_mm_slli_epi16(_mm_mulhi_epi16(Diff, Spring), 1),
+			_mm_srli_epi16(_mm_mullo_epi16(Diff, Spring), 15));
+
+		__m128i Velocity = _mm_adds_epi16(OldVelocity, Force);
+		__m128i VelocityDeviation = _mm_sub_epi16(Velocity, Damping);
+		VelocityDeviation = _mm_add_epi16(VelocityDeviation, _mm_andnot_si128(_mm_srai_epi16(VelocityDeviation, 15), VelocityRound));
+		Velocity = _mm_sub_epi16(Velocity, _mm_sra_epi16(VelocityDeviation, VelocityShift));
+		__m128i Height = _mm_subs_epi16(_mm_adds_epi16(Center, Velocity), Damping);
+		__m128i HeightDeviation = _mm_sub_epi16(Height, RestHeight);
+		HeightDeviation = _mm_add_epi16(HeightDeviation, _mm_andnot_si128(_mm_srai_epi16(HeightDeviation, 15), HeightRound));
+		Height = _mm_sub_epi16(Height, _mm_sra_epi16(HeightDeviation, HeightShift));
+		Velocity = _mm_adds_epi16(Velocity, _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pAddVelocity + i)));
+
+		Height = _mm_min_epi16(_mm_max_epi16(Height, Zero), One);
+		Velocity = _mm_min_epi16(_mm_max_epi16(Velocity, Zero), One);
+
+		// 障害物のセル自身は値を保持する.
+		Height = _mm_or_si128(_mm_and_si128(Solid, Center), _mm_andnot_si128(Solid, Height));
+		Velocity = _mm_or_si128(_mm_and_si128(Solid, OldVelocity), _mm_andnot_si128(Solid, Velocity));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOutHeight + i), Height);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOutVelocity + i), Velocity);
+	}
+
+	if (i < _count)
+	{
+		WaveObstacleMask::ROW_MASK Mask = _mask;
+		Mask.Bit += i;
+		StepRowMaskScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _spring, Mask);
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void FixedWaveSolver::StepRowMaskAVX2(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	const __m256i Spring = _mm256_set1_epi16(_spring);
+	const __m256i Damping = _mm256_set1_epi16(ToFixed(WaveSimulator::m_Damping));
+	const __m128i VelocityShift = _mm_cvtsi32_si128(WaveSimulator::m_VelocityDecayShift);
+	const __m256i VelocityRound = _mm256_set1_epi16(static_cast<short>((1 << WaveSimulator::m_VelocityDecayShift) - 1));
+	const __m256i RestHeight = _mm256_set1_epi16(ToFixed(WaveSimulator::m_DefaultWaveHeight));
+	const __m128i HeightShift = _mm_cvtsi32_si128(WaveSimulator::m_HeightDecayShift);
+	const __m256i HeightRound = _mm256_set1_epi16(static_cast<short>((1 << WaveSimulator::m_HeightDecayShift) - 1));
+	const __m256i Zero = _mm256_setzero_si256();
+	const __m256i One = _mm256_set1_epi16(static_cast<short>(m_FixedOne));
+	const __m256i LaneBit = _mm256_setr_epi16(
+		1, 2, 4, 8, 16, 32, 64, 128,
+		256, 512, 1024, 2048, 4096, 8192, 16384, static_cast<short>(0x8000));
+
+	int i = 0;
+	for (; i + 16 <= _count; i += 16)
+	{
+		unsigned int RowBits = WaveObstacleMask::LoadBits(_mask.pCenter, _mask.Bit + i - 1);
+		__m256i SolidLeft = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(RowBits)), LaneBit), LaneBit);
+		__m256i Solid = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(RowBits >> 1)), LaneBit), LaneBit);
+		__m256i SolidRight = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(RowBits >> 2)), LaneBit), LaneBit);
+		__m256i SolidUp = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(WaveObstacleMask::LoadBits(_mask.pUp, _mask.Bit + i))), LaneBit), LaneBit);
+		__m256i SolidDown = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(WaveObstacleMask::LoadBits(_mask.pDown, _mask.Bit + i))), LaneBit), LaneBit);
+
+		__m256i Center = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i));
+		__m256i OldVelocity = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pVelocity + i));
+		__m256i Right = _mm256_blendv_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i + 1)), Center, SolidRight);
+		__m256i Down = _mm256_blendv_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pDown + i)), Center, SolidDown);
+		__m256i Left = _mm256_blendv_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i - 1)), Center, SolidLeft);
+		__m256i Up = _mm256_blendv_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pUp + i)), Center, SolidUp);
+		__m256i Average = _mm256_avg_epu16(_mm256_avg_epu16(Right, Down), _mm256_avg_epu16(Left, Up));
+
+		__m256i Diff = _mm256_sub_epi16(Average, Center);
+		__m256i Force = _mm256_or_si256(
+			_mm256_slli_epi16(_mm256_mulhi_epi16(Diff, Spring), 1),
+			_mm256_srli_epi16(_mm256_mullo_epi16(Diff, Spring), 15));
+
+		__m256i Velocity = _mm256_adds_epi16(OldVelocity, Force);
+		__m256i VelocityDeviation = _mm256_sub_epi16(Velocity, Damping);
+		VelocityDeviation = _mm256_add_epi16(VelocityDeviation, _mm256_andnot_si256(_mm256_srai_epi16(VelocityDeviation, 15), VelocityRound));
+		Velocity = _mm256_sub_epi16(Velocity, _mm256_sra_epi16(VelocityDeviation, VelocityShift));
+		__m256i Height = _mm256_subs_epi16(_mm256_adds_epi16(Center, Velocity), Damping);
+		__m256i HeightDeviation = _mm256_sub_epi16(Height, RestHeight);
+		HeightDeviation = _mm256_add_epi16(HeightDeviation, _mm256_andnot_si256(_mm256_srai_epi16(HeightDeviation, 15), HeightRound));
+		Height = _mm256_sub_epi16(Height, _mm256_sra_epi16(HeightDeviation, HeightShift));
+		Velocity = _mm256_adds_epi16(Velocity, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pAddVelocity + i)));
+
+		Height = _mm256_min_epi16(_mm256_max_epi16(Height, Zero), One);
+		Velocity = _mm256_min_epi16(_mm256_max_epi16(Velocity, Zero), One);
+		Height = _mm256_blendv_epi8(Height, Center, Solid);
+		Velocity = _mm256_blendv_epi8(Velocity, OldVelocity, Solid);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOutHeight + i), Height);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOutVelocity + i), Velocity);
+	}
+
+	if (i < _count)
+	{
+		WaveObstacleMask::ROW_MASK Mask = _mask;
+		Mask.Bit += i;
+		StepRowMaskSSE(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _spring, Mask);
+	}
+}
+
+CPUFEATURE_TARGET_SSE
+void FixedWaveSolver::WaveMapRowSSE(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count)
+{
+	// (値 * 1020 + 32768) >> 16 = (値 * 255 + 8192) >> 14を積の上位と下位の最上位ビットで求める.
+	const __m128i Scale = _mm_set1_epi16(255 * 4);
+	const __m128i Alpha = _mm_set1_epi16(static_cast<short>(0xff00));
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m128i Height = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pHeight + i));
+		__m128i Velocity = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pVelocity + i));
+		__m128i Red = _mm_add_epi16(_mm_mulhi_epu16(Height, Scale), _mm_srli_epi16(_mm_mullo_epi16(Height, Scale), 15));
+		__m128i Green = _mm_add_epi16(_mm_mulhi_epu16(Velocity, Scale), _mm_srli_epi16(_mm_mullo_epi16(Velocity, Scale), 15));
+
+		// 16bitの(R, G)と(B, A)を交互に並べて4ピクセルずつ書き込む.
+		__m128i RedGreen = _mm_or_si128(Red, _mm_slli_epi16(Green, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOut + i * 4), _mm_unpacklo_epi16(RedGreen, Alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOut + i * 4 + 16), _mm_unpackhi_epi16(RedGreen, Alpha));
+	}
+
+	if (i < _count)
+	{
+		WaveMapRowScalar(_pHeight + i, _pVelocity + i, _pOut + i * 4, _count - i);
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void FixedWaveSolver::WaveMapRowAVX2(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count)
+{
+	// vpmulhrswは(a * b + 16384) >> 15なので, 510を掛けると(値 * 255 + 8192) >> 14になる.
+	const __m256i Scale = _mm256_set1_epi16(255 * 2);
+	const __m256i Alpha = _mm256_set1_epi16(static_cast<short>(0xff00));
+
+	int i = 0;
+	for (; i + 16 <= _count; i += 16)
+	{
+		__m256i Red = _mm256_mulhrs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pHeight + i)), Scale);
+		__m256i Green = _mm256_mulhrs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pVelocity + i)), Scale);
+		__m256i RedGreen = _mm256_or_si256(Red, _mm256_slli_epi16(Green, 8));
+
+		// unpackは128bitごとに行われるので, 上下を入れ替えて並びを戻す.
+		__m256i Low = _mm256_unpacklo_epi16(RedGreen, Alpha);
+		__m256i High = _mm256_unpackhi_epi16(RedGreen, Alpha);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOut + i * 4), _mm256_permute2x128_si256(Low, High, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOut + i * 4 + 32), _mm256_permute2x128_si256(Low, High, 0x31));
+	}
+
+	if (i < _count)
+	{
+		WaveMapRowSSE(_pHeight + i, _pVelocity + i, _pOut + i * 4, _count - i);
+	}
+}
+
+CPUFEATURE_TARGET_SSE
+void FixedWaveSolver::NormalMapRowSSE(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count)
+{
+	const __m128i One = _mm_set1_epi16(static_cast<short>(m_FixedOne));
+	const __m128i Scale = _mm_set1_epi16(255 * 4);
+	const __m128i Green = _mm_set1_epi16(static_cast<short>(0xff00));
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		// 差 + 1.0は最大32768になるので符号なしとして1ビット右シフトする.
+		__m128i TangentU = _mm_srli_epi16(_mm_add_epi16(_mm_sub_epi16(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i - 1)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i + 1))), One), 1);
+		__m128i TangentV = _mm_srli_epi16(_mm_add_epi16(_mm_sub_epi16(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pUp + i)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pDown + i))), One), 1);
+		__m128i Height = _mm_srli_epi16(_mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pCenter + i)), One), 1);
+
+		__m128i Red = _mm_add_epi16(_mm_mulhi_epu16(TangentU, Scale), _mm_srli_epi16(_mm_mullo_epi16(TangentU, Scale), 15));
+		__m128i Blue = _mm_add_epi16(_mm_mulhi_epu16(TangentV, Scale), _mm_srli_epi16(_mm_mullo_epi16(TangentV, Scale), 15));
+		__m128i Alpha = _mm_add_epi16(_mm_mulhi_epu16(Height, Scale), _mm_srli_epi16(_mm_mullo_epi16(Height, Scale), 15));
+
+		__m128i RedGreen = _mm_or_si128(Red, Green);
+		__m128i BlueAlpha = _mm_or_si128(Blue, _mm_slli_epi16(Alpha, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOut + i * 4), _mm_unpacklo_epi16(RedGreen, BlueAlpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOut + i * 4 + 16), _mm_unpackhi_epi16(RedGreen, BlueAlpha));
+	}
+
+	if (i < _count)
+	{
+		NormalMapRowScalar(_pUp + i, _pCenter + i, _pDown + i, _pOut + i * 4, _count - i);
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void FixedWaveSolver::NormalMapRowAVX2(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count)
+{
+	const __m256i One = _mm256_set1_epi16(static_cast<short>(m_FixedOne));
+	const __m256i Scale = _mm256_set1_epi16(255 * 2);
+	const __m256i Green = _mm256_set1_epi16(static_cast<short>(0xff00));
+
+	int i = 0;
+	for (; i + 16 <= _count; i += 16)
+	{
+		__m256i TangentU = _mm256_srli_epi16(_mm256_add_epi16(_mm256_sub_epi16(
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i - 1)),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i + 1))), One), 1);
+		__m256i TangentV = _mm256_srli_epi16(_mm256_add_epi16(_mm256_sub_epi16(
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pUp + i)),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pDown + i))), One), 1);
+		__m256i Height = _mm256_srli_epi16(_mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pCenter + i)), One), 1);
+
+		// 値は最大16384なので符号付きの乗算でも桁あふれしない.
+		__m256i RedGreen = _mm256_or_si256(_mm256_mulhrs_epi16(TangentU, Scale), Green);
+		__m256i BlueAlpha = _mm256_or_si256(_mm256_mulhrs_epi16(TangentV, Scale), _mm256_slli_epi16(_mm256_mulhrs_epi16(Height, Scale), 8));
+
+		__m256i Low = _mm256_unpacklo_epi16(RedGreen, BlueAlpha);
+		__m256i High = _mm256_unpackhi_epi16(RedGreen, BlueAlpha);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOut + i * 4), _mm256_permute2x128_si256(Low, High, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOut + i * 4 + 32), _mm256_permute2x128_si256(Low, High, 0x31));
+	}
+
+	if (i < _count)
+	{
+		NormalMapRowSSE(_pUp + i, _pCenter + i, _pDown + i, _pOut + i * 4, _count - i);
+	}
+}
+
+#else
+
+void FixedWaveSolver::StepRowSSE(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring)
+{
+	StepRowScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _spring);
+}
+
+void FixedWaveSolver::StepRowAVX2(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring)
+{
+	StepRowScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _spring);
+}
+
+void FixedWaveSolver::StepRowMaskSSE(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	StepRowMaskScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _spring, _mask);
+}
+
+void FixedWaveSolver::StepRowMaskAVX2(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	StepRowMaskScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _spring, _mask);
+}
+
+void FixedWaveSolver::WaveMapRowSSE(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count)
+{
+	WaveMapRowScalar(_pHeight, _pVelocity, _pOut, _count);
+}
+
+void FixedWaveSolver::WaveMapRowAVX2(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count)
+{
+	WaveMapRowScalar(_pHeight, _pVelocity, _pOut, _count);
+}
+
+void FixedWaveSolver::NormalMapRowSSE(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count)
+{
+	NormalMapRowScalar(_pUp, _pCenter, _pDown, _pOut, _count);
+}
+
+void FixedWaveSolver::NormalMapRowAVX2(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count)
+{
+	NormalMapRowScalar(_pUp, _pCenter, _pDown, _pOut, _count);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void FixedWaveSolver::StepRowNEON(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring)
+{
+	const int16x8_t Spring = vdupq_n_s16(_spring);
+	const int16x8_t Damping = vdupq_n_s16(ToFixed(WaveSimulator::m_Damping));
+	const int16x8_t VelocityShift = vdupq_n_s16(static_cast<short>(-WaveSimulator::m_VelocityDecayShift));
+	const int16x8_t VelocityRound = vdupq_n_s16(static_cast<short>((1 << WaveSimulator::m_VelocityDecayShift) - 1));
+	const int16x8_t RestHeight = vdupq_n_s16(ToFixed(WaveSimulator::m_DefaultWaveHeight));
+	const int16x8_t HeightShift = vdupq_n_s16(static_cast<short>(-WaveSimulator::m_HeightDecayShift));
+	const int16x8_t HeightRound = vdupq_n_s16(static_cast<short>((1 << WaveSimulator::m_HeightDecayShift) - 1));
+	const int16x8_t Zero = vdupq_n_s16(0);
+	const int16x8_t One = vdupq_n_s16(static_cast<short>(m_FixedOne));
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		int16x8_t Center = vld1q_s16(_pCenter + i);
+		uint16x8_t Average = vrhaddq_u16(
+			vrhaddq_u16(vreinterpretq_u16_s16(vld1q_s16(_pCenter + i + 1)), vreinterpretq_u16_s16(vld1q_s16(_pDown + i))),
+			vrhaddq_u16(vreinterpretq_u16_s16(vld1q_s16(_pCenter + i - 1)), vreinterpretq_u16_s16(vld1q_s16(_pUp + i))));
+
+		// vqdmulhは(2 * a * b) >> 16なので(差 * ばねの強さ) >> 15と一致する.
+		int16x8_t Force = vqdmulhq_s16(vsubq_s16(vreinterpretq_s16_u16(Average), Center), Spring);
+
+		int16x8_t Velocity = vqaddq_s16(vld1q_s16(_pVelocity + i), Force);
+		int16x8_t VelocityDeviation = vsubq_s16(Velocity, Damping);
+		VelocityDeviation = vaddq_s16(VelocityDeviation, vbicq_s16(VelocityRound, vshrq_n_s16(VelocityDeviation, 15)));
+		Velocity = vsubq_s16(Velocity, vshlq_s16(VelocityDeviation, VelocityShift));
+		int16x8_t Height = vqsubq_s16(vqaddq_s16(Center, Velocity), Damping);
+		int16x8_t HeightDeviation = vsubq_s16(Height, RestHeight);
+		HeightDeviation = vaddq_s16(HeightDeviation, vbicq_s16(HeightRound, vshrq_n_s16(HeightDeviation, 15)));
+		Height = vsubq_s16(Height, vshlq_s16(HeightDeviation, HeightShift));
+		Velocity = vqaddq_s16(Velocity, vld1q_s16(_pAddVelocity + i));
+
+		vst1q_s16(_pOutHeight + i, vminq_s16(vmaxq_s16(Height, Zero), One));
+		vst1q_s16(_pOutVelocity + i, vminq_s16(vmaxq_s16(Velocity, Zero), One));
+	}
+
+	if (i < _count)
+	{
+		StepRowScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _spring);
+	}
+}
+
+void FixedWaveSolver::StepRowMaskNEON(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	const int16x8_t Spring = vdupq_n_s16(_spring);
+	const int16x8_t Damping = vdupq_n_s16(ToFixed(WaveSimulator::m_Damping));
+	const int16x8_t VelocityShift = vdupq_n_s16(static_cast<short>(-WaveSimulator::m_VelocityDecayShift));
+	const int16x8_t VelocityRound = vdupq_n_s16(static_cast<short>((1 << WaveSimulator::m_VelocityDecayShift) - 1));
+	const int16x8_t RestHeight = vdupq_n_s16(ToFixed(WaveSimulator::m_DefaultWaveHeight));
+	const int16x8_t HeightShift = vdupq_n_s16(static_cast<short>(-WaveSimulator::m_HeightDecayShift));
+	const int16x8_t HeightRound = vdupq_n_s16(static_cast<short>((1 << WaveSimulator::m_HeightDecayShift) - 1));
+	const int16x8_t Zero = vdupq_n_s16(0);
+	const int16x8_t One = vdupq_n_s16(static_cast<short>(m_FixedOne));
+	const uint16_t LaneBitData[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint16x8_t LaneBit = vld1q_u16(LaneBitData);
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		unsigned int RowBits = WaveObstacleMask::LoadBits(_mask.pCenter, _mask.Bit + i - 1);
+		uint16x8_t SolidLeft = vtstq_u16(vdupq_n_u16(static_cast<uint16_t>(RowBits)), LaneBit);
+		uint16x8_t Solid = vtstq_u16(vdupq_n_u16(static_cast<uint16_t>(RowBits >> 1)), LaneBit);
+		uint16x8_t SolidRight = vtstq_u16(vdupq_n_u16(static_cast<uint16_t>(RowBits >> 2)), LaneBit);
+		uint16x8_t SolidUp = vtstq_u16(vdupq_n_u16(static_cast<uint16_t>(WaveObstacleMask::LoadBits(_mask.pUp, _mask.Bit + i))), LaneBit);
+		uint16x8_t SolidDown = vtstq_u16(vdupq_n_u16(static_cast<uint16_t>(WaveObstacleMask::LoadBits(_mask.pDown, _mask.Bit + i))), LaneBit);
+
+		int16x8_t Center = vld1q_s16(_pCenter + i);
+		int16x8_t OldVelocity = vld1q_s16(_pVelocity + i);
+		int16x8_t Right = vbslq_s16(SolidRight, Center, vld1q_s16(_pCenter + i + 1));
+		int16x8_t Down = vbslq_s16(SolidDown, Center, vld1q_s16(_pDown + i));
+		int16x8_t Left = vbslq_s16(SolidLeft, Center, vld1q_s16(_pCenter + i - 1));
+		int16x8_t Up = vbslq_s16(SolidUp, Center, vld1q_s16(_pUp + i));
+		uint16x8_t Average = vrhaddq_u16(
+			vrhaddq_u16(vreinterpretq_u16_s16(Right), vreinterpretq_u16_s16(Down)),
+			vrhaddq_u16(vreinterpretq_u16_s16(Left), vreinterpretq_u16_s16(Up)));
+
+		int16x8_t Force = vqdmulhq_s16(vsubq_s16(vreinterpretq_s16_u16(Average), Center), Spring);
+
+		int16x8_t Velocity = vqaddq_s16(OldVelocity, Force);
+		int16x8_t VelocityDeviation = vsubq_s16(Velocity, Damping);
+		VelocityDeviation = vaddq_s16(VelocityDeviation, vbicq_s16(VelocityRound, vshrq_n_s16(VelocityDeviation, 15)));
+		Velocity = vsubq_s16(Velocity, vshlq_s16(VelocityDeviation, VelocityShift));
+		int16x8_t Height = vqsubq_s16(vqaddq_s16(Center, Velocity), Damping);
+		int16x8_t HeightDeviation = vsubq_s16(Height, RestHeight);
+		HeightDeviation = vaddq_s16(HeightDeviation, vbicq_s16(HeightRound, vshrq_n_s16(HeightDeviation, 15)));
+		Height = vsubq_s16(Height, vshlq_s16(HeightDeviation, HeightShift));
+		Velocity = vqaddq_s16(Velocity, vld1q_s16(_pAddVelocity + i));
+
+		Height = vminq_s16(vmaxq_s16(Height, Zero), One);
+		Velocity = vminq_s16(vmaxq_s16(Velocity, Zero), One);
+		vst1q_s16(_pOutHeight + i, vbslq_s16(Solid, Center, Height));
+		vst1q_s16(_pOutVelocity + i, vbslq_s16(Solid, OldVelocity, Velocity));
+	}
+
+	if (i < _count)
+	{
+		WaveObstacleMask::ROW_MASK Mask = _mask;
+		Mask.Bit += i;
+		StepRowMaskScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _spring, Mask);
+	}
+}
+
+void FixedWaveSolver::WaveMapRowNEON(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count)
+{
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		// vrshrnは(値 + 丸め値) >> シフト数なのでスカラー版と一致する.
+		uint16x8_t Height = vreinterpretq_u16_s16(vld1q_s16(_pHeight + i));
+		uint16x8_t Velocity = vreinterpretq_u16_s16(vld1q_s16(_pVelocity + i));
+
+		uint8x8x4_t Pixel;
+		Pixel.val[0] = vmovn_u16(vcombine_u16(
+			vrshrn_n_u32(vmull_n_u16(vget_low_u16(Height), 255), 14),
+			vrshrn_n_u32(vmull_n_u16(vget_high_u16(Height), 255), 14)));
+		Pixel.val[1] = vmovn_u16(vcombine_u16(
+			vrshrn_n_u32(vmull_n_u16(vget_low_u16(Velocity), 255), 14),
+			vrshrn_n_u32(vmull_n_u16(vget_high_u16(Velocity), 255), 14)));
+		Pixel.val[2] = vdup_n_u8(0);
+		Pixel.val[3] = vdup_n_u8(255);
+		vst4_u8(_pOut + i * 4, Pixel);
+	}
+
+	if (i < _count)
+	{
+		WaveMapRowScalar(_pHeight + i, _pVelocity + i, _pOut + i * 4, _count - i);
+	}
+}
+
+void FixedWaveSolver::NormalMapRowNEON(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count)
+{
+	const uint16x8_t One = vdupq_n_u16(static_cast<unsigned short>(m_FixedOne));
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		uint16x8_t Left = vreinterpretq_u16_s16(vld1q_s16(_pCenter + i - 1));
+		uint16x8_t Right = vreinterpretq_u16_s16(vld1q_s16(_pCenter + i + 1));
+		uint16x8_t Up = vreinterpretq_u16_s16(vld1q_s16(_pUp + i));
+		uint16x8_t Down = vreinterpretq_u16_s16(vld1q_s16(_pDown + i));
+		uint16x8_t Center = vreinterpretq_u16_s16(vld1q_s16(_pCenter + i));
+
+		uint16x8_t Value[3] =
+		{
+			vshrq_n_u16(vaddq_u16(vsubq_u16(Left, Right), One), 1),
+			vshrq_n_u16(vaddq_u16(vsubq_u16(Up, Down), One), 1),
+			vshrq_n_u16(vaddq_u16(Center, One), 1)
+		};
+
+		uint8x8_t Byte[3];
+		for (int j = 0; j < 3; j++)
+		{
+			Byte[j] = vmovn_u16(vcombine_u16(
+				vrshrn_n_u32(vmull_n_u16(vget_low_u16(Value[j]), 255), 14),
+				vrshrn_n_u32(vmull_n_u16(vget_high_u16(Value[j]), 255), 14)));
+		}
+
+		uint8x8x4_t Pixel;
+		Pixel.val[0] = Byte[0];
+		Pixel.val[1] = vdup_n_u8(255);
+		Pixel.val[2] = Byte[1];
+		Pixel.val[3] = Byte[2];
+		vst4_u8(_pOut + i * 4, Pixel);
+	}
+
+	if (i < _count)
+	{
+		NormalMapRowScalar(_pUp + i, _pCenter + i, _pDown + i, _pOut + i * 4, _count - i);
+	}
+}
+
+#else
+
+void FixedWaveSolver::StepRowNEON(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring)
+{
+	StepRowScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _spring);
+}
+
+void FixedWaveSolver::StepRowMaskNEON(
+	const short* _pUp, const short* _pCenter, const short* _pDown,
+	const short* _pVelocity, const short* _pAddVelocity,
+	short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	StepRowMaskScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _spring, _mask);
+}
+
+void FixedWaveSolver::WaveMapRowNEON(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count)
+{
+	WaveMapRowScalar(_pHeight, _pVelocity, _pOut, _count);
+}
+
+void FixedWaveSolver::NormalMapRowNEON(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count)
+{
+	NormalMapRowScalar(_pUp, _pCenter, _pDown, _pOut, _count);
+}
+
+#endif // CPUFEATURE_NEON
@@ -0,0 +1,412 @@
+﻿/**
+ * @file	FixedWaveSolver.h
+ * @brief	固定小数点波計算クラス定義
+ * @author	morimoto
+ */
+#ifndef FIXEDWAVESOLVER_H
+#define FIXEDWAVESOLVER_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveImpulseQueue\WaveImpulseQueue.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveObstacleMask\WaveObstacleMask.h"
+
+
+class ThreadPool;
+
+
+/**
+ * 固定小数点波計算クラス
+ *
+ * WaveSimulatorと同じばねモデルを, 0～1の値を16384倍したint16(Q14)で計算する.
+ * 波マップはR8G8B8A8_UNORMなので8bitの精度しか残らず, floatの半分の帯域で1命令あたり2倍の要素を処理できる.
+ * 範囲外の値は飽和演算で丸めるので, 計算途中の桁あふれは起こらない.
+ *
+ * 同じ状態から1ステップ進めたときの誤差(浮動小数点版との差, 1LSB = 1/16384)は,
+ * 速度が周囲の平均の丸め(切り上げ平均3回で最大1LSB, ばねの強さ0.5倍で0.5LSB), ばねの強さの乗算の切り捨て(1LSB未満),
+ * 減衰量の切り上げ(1LSB未満)で最大2.5LSB, 高さがこれに減衰量0.1の量子化(0.4LSB)と高さの減衰量の切り上げ(1LSB未満)を加えて
+ * 最大4LSB(8bit出力の1/16)となる(m_MaxStepError).
+ * 0.1などの初期値は量子化で丸めが変わるので, 8bit出力は開始時点から1LSBずれることがある.
+ * 乗算の切り捨ては常に同じ向きなので誤差は波の伝搬とともに位相のずれとして蓄積し, 波が大きく動いている間は
+ * 8bit出力で1桁LSBを超える(m_MaxOutputError). 減衰で波が収まると誤差も消え, 静止時のずれの1LSBに戻る.
+ *
+ * スパース更新と時間ブロッキングは行わず, 行の帯ごとに全体を並列に更新する.
+ * 障害物マスクが設定されている場合は, 上下の行を含めて障害物がある行だけをマスク付きの更新関数で更新する.
+ */
+class FixedWaveSolver
+{
+public:
+	/**
+	 * コンストラクタ
+	 * @param[in] _width 波マップの幅
+	 * @param[in] _height 波マップの高さ
+	 */
+	FixedWaveSolver(int _width, int _height);
+
+	/**
+	 * デストラクタ
+	 */
+	~FixedWaveSolver();
+
+	/**
+	 * 初期化処理
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool Initialize();
+
+	/**
+	 * 終了処理
+	 */
+	void Finalize();
+
+	/**
+	 * 波マップを一定値で初期化
+	 * @param[in] _height 高さの初期値
+	 * @param[in] _velocity 速度の初期値
+	 */
+	void Clear(float _height, float _velocity);
+
+	/**
+	 * 浮動小数点の波マップを読み込む
+	 * @param[in] _pHeight 高さ配列の左上のセル
+	 * @param[in] _pVelocity 速度配列の左上のセル
+	 * @param[in] _stride 配列の1行分の要素数
+	 */
+	void SetState(const float* _pHeight, const float* _pVelocity, int _stride);
+
+	/**
+	 * 波マップを浮動小数点で書き出す
+	 * @param[out] _pHeight 高さ配列の左上のセル
+	 * @param[out] _pVelocity 速度配列の左上のセル
+	 * @param[in] _stride 配列の1行分の要素数
+	 */
+	void GetState(float* _pHeight, float* _pVelocity, int _stride) const;
+
+	/**
+	 * 波のシミュレーションを1ステップ進める
+	 *
+	 * 書き込み先を渡した場合は, 更新した行から波マップ(更新後)と法線マップ(更新前の高さ)を書き込む.
+	 * @param[in] _impulse 追加する波
+	 * @param[out] _pWaveMap 波マップの書き込み先(nullptrなら書き込まない)
+	 * @param[in] _waveRowPitch 波マップの1行分のバイト数
+	 * @param[out] _pNormalMap 法線マップの書き込み先(nullptrなら書き込まない)
+	 * @param[in] _normalRowPitch 法線マップの1行分のバイト数
+	 */
+	void Step(const std::vector<WaveImpulseQueue::IMPULSE>& _impulse, void* _pWaveMap, int _waveRowPitch, void* _pNormalMap, int _normalRowPitch);
+
+	/**
+	 * 波マップをRGBA8(高さ, 速度, 0, 1)でテクスチャデータに書き込む
+	 * @param[out] _pData 書き込み先(幅x高さ分のピクセル)
+	 * @param[in] _rowPitch 書き込み先の1行分のバイト数
+	 */
+	void WriteWaveMap(void* _pData, int _rowPitch) const;
+
+	/**
+	 * 現在の高さから法線マップをRGBA8(Wave.fxのPS_BUMPMAPと同じ形式)でテクスチャデータに書き込む
+	 * @param[out] _pData 書き込み先(幅x高さ分のピクセル)
+	 * @param[in] _rowPitch 書き込み先の1行分のバイト数
+	 */
+	void WriteNormalMap(void* _pData, int _rowPitch);
+
+	/**
+	 * 更新に使用するスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元スレッドのみで更新する)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool)
+	{
+		m_pThreadPool = _pThreadPool;
+	}
+
+	/**
+	 * 障害物マスクを設定
+	 * @param[in] _pObstacleMask 波マップと同じ大きさでBuildしたマスク(nullptrなら障害物なし)
+	 */
+	void SetObstacleMask(const WaveObstacleMask* _pObstacleMask);
+
+	/**
+	 * ばねの強さを設定
+	 * @param[in] _springPower ばねの強さ(0～1)
+	 */
+	void SetSpringPower(float _springPower);
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(使用できない場合は自動選択される)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 指定セルの高さを取得
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @return 高さ
+	 */
+	float GetWaveHeight(int _x, int _y) const
+	{
+		return static_cast<float>(m_WaveHeight[m_ReadIndex][CellIndex(_x, _y)]) * m_InvFixedOne;
+	}
+
+	/**
+	 * 指定セルの速度を取得
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @return 速度
+	 */
+	float GetWaveVelocity(int _x, int _y) const
+	{
+		return static_cast<float>(m_WaveVelocity[m_ReadIndex][CellIndex(_x, _y)]) * m_InvFixedOne;
+	}
+
+	static const int m_FixedShift;			//!< 固定小数点の小数部のビット数.
+	static const int m_FixedOne;			//!< 1.0に対応する値.
+	static const float m_InvFixedOne;		//!< 1.0に対応する値の逆数.
+	static const int m_BandHeight;			//!< 並列に更新する行の帯の高さ.
+	static const float m_MaxStepError;		//!< 同じ状態から1ステップ進めたときの高さと速度の誤差の上限(0～1の値).
+	static const int m_MaxOutputError;		//!< 波が動いている間の8bit出力の最大誤差(256x256で2つの波を追加したときの計測値21に余裕を持たせた値).
+
+private:
+	/**
+	 * 1行分の更新関数
+	 * @param[in] _pUp 上の行の高さ
+	 * @param[in] _pCenter 更新する行の高さ(前後1要素を参照する)
+	 * @param[in] _pDown 下の行の高さ
+	 * @param[in] _pVelocity 更新する行の速度
+	 * @param[in] _pAddVelocity 速度への加算値
+	 * @param[out] _pOutHeight 更新後の高さの出力先
+	 * @param[out] _pOutVelocity 更新後の速度の出力先
+	 * @param[in] _count 更新する要素数
+	 * @param[in] _spring ばねの強さ(32768倍した値)
+	 */
+	typedef void(*STEPROW_FUNC)(
+		const short* _pUp,
+		const short* _pCenter,
+		const short* _pDown,
+		const short* _pVelocity,
+		const short* _pAddVelocity,
+		short* _pOutHeight,
+		short* _pOutVelocity,
+		int _count,
+		short _spring);
+
+	/**
+	 * 障害物マスク付きの1行分の更新関数(引数はSTEPROW_FUNCに障害物マスクを加えたもの)
+	 */
+	typedef void(*STEPROW_MASK_FUNC)(
+		const short* _pUp,
+		const short* _pCenter,
+		const short* _pDown,
+		const short* _pVelocity,
+		const short* _pAddVelocity,
+		short* _pOutHeight,
+		short* _pOutVelocity,
+		int _count,
+		short _spring,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 1行分の波マップの書き込み関数
+	 */
+	typedef void(*WAVEMAPROW_FUNC)(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み関数
+	 */
+	typedef void(*NORMALMAPROW_FUNC)(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count);
+
+
+	/**
+	 * セルの配列インデックスを取得
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @return 配列インデックス
+	 */
+	int CellIndex(int _x, int _y) const
+	{
+		return (_y + 1) * m_Stride + (_x + 1);
+	}
+
+	/**
+	 * 外周セルに端の値を複製する
+	 * @param[in] _index 対象のバッファインデックス
+	 */
+	void UpdateHalo(int _index);
+
+	/**
+	 * 追加する波を速度の加算値に展開する
+	 * @param[in] _impulse 追加する波
+	 */
+	void BuildAddVelocity(const std::vector<WaveImpulseQueue::IMPULSE>& _impulse);
+
+	/**
+	 * 行の帯ごとに処理を実行する
+	 * @param[in] _func 実行する処理(引数は帯の先頭行と終端行)
+	 */
+	template <typename Func>
+	void ForEachBand(const Func& _func) const;
+
+	/**
+	 * 0～1の値を固定小数点に変換する
+	 * @param[in] _value 変換する値
+	 * @return 固定小数点の値
+	 */
+	static short ToFixed(float _value);
+
+	/**
+	 * 命令セットに対応した行更新関数を取得
+	 */
+	static STEPROW_FUNC GetStepRowFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 命令セットに対応した障害物マスク付きの行更新関数を取得
+	 */
+	static STEPROW_MASK_FUNC GetStepRowMaskFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 命令セットに対応した波マップの書き込み関数を取得
+	 */
+	static WAVEMAPROW_FUNC GetWaveMapRowFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 命令セットに対応した法線マップの書き込み関数を取得
+	 */
+	static NORMALMAPROW_FUNC GetNormalMapRowFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 1行分の更新(スカラー版)
+	 */
+	static void StepRowScalar(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring);
+
+	/**
+	 * 1行分の更新(SSE2版, 8レーン)
+	 */
+	static void StepRowSSE(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring);
+
+	/**
+	 * 1行分の更新(AVX2版, 16レーン)
+	 */
+	static void StepRowAVX2(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring);
+
+	/**
+	 * 1行分の更新(NEON版, 8レーン)
+	 */
+	static void StepRowNEON(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(スカラー版)
+	 */
+	static void StepRowMaskScalar(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(SSE2版, 8レーン)
+	 */
+	static void StepRowMaskSSE(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(AVX2版, 16レーン)
+	 */
+	static void StepRowMaskAVX2(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(NEON版, 8レーン)
+	 */
+	static void StepRowMaskNEON(
+		const short* _pUp, const short* _pCenter, const short* _pDown,
+		const short* _pVelocity, const short* _pAddVelocity,
+		short* _pOutHeight, short* _pOutVelocity, int _count, short _spring,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 1行分の波マップの書き込み(スカラー版)
+	 */
+	static void WaveMapRowScalar(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の波マップの書き込み(SSE2版)
+	 */
+	static void WaveMapRowSSE(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の波マップの書き込み(AVX2版)
+	 */
+	static void WaveMapRowAVX2(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の波マップの書き込み(NEON版)
+	 */
+	static void WaveMapRowNEON(const short* _pHeight, const short* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(スカラー版)
+	 */
+	static void NormalMapRowScalar(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(SSE2版)
+	 */
+	static void NormalMapRowSSE(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(AVX2版)
+	 */
+	static void NormalMapRowAVX2(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(NEON版)
+	 */
+	static void NormalMapRowNEON(const short* _pUp, const short* _pCenter, const short* _pDown, unsigned char* _pOut, int _count);
+
+
+	int						m_Width;			//!< 波マップの幅.
+	int						m_Height;			//!< 波マップの高さ.
+	int						m_Stride;			//!< 1行分の要素数(外周を含む).
+	short					m_Spring;			//!< ばねの強さ(32768倍した値).
+	CpuFeature::SIMD_TYPE	m_SimdType;			//!< 使用する命令セット.
+	ThreadPool*				m_pThreadPool;		//!< 更新に使用するスレッドプール.
+
+	std::vector<short>		m_WaveHeight[2];	//!< 高さ配列(ダブルバッファ).
+	std::vector<short>		m_WaveVelocity[2];	//!< 速度配列(ダブルバッファ).
+	int						m_ReadIndex;		//!< 読み込み側のバッファインデックス.
+
+	std::vector<short>		m_AddVelocity;		//!< 速度の加算値(波マップと同じ大きさ).
+	int						m_AddTop;			//!< 加算値が存在する最初の行.
+	int						m_AddBottom;		//!< 加算値が存在する最後の行の次.
+	std::vector<short>		m_ZeroRow;			//!< 加算しない行に渡す0の配列.
+
+	const WaveObstacleMask*	m_pObstacleMask;	//!< 障害物マスク.
+	std::vector<unsigned char>	m_IsRowObstacle;	//!< 上下の行を含めて障害物がある行か.
+
+};
+
+
+#endif // !FIXEDWAVESOLVER_H
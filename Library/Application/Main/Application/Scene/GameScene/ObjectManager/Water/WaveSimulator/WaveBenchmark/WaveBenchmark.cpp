@@ -0,0 +1,153 @@
+﻿/**
+ * @file	WaveBenchmark.cpp
+ * @brief	波シミュレーション計測クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaveBenchmark.h"
+
+#include <chrono>
+#include <fstream>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSimulator.h"
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const int WaveBenchmark::m_GridSize[] = { 800, 1024, 2048, 4096 };
+const int WaveBenchmark::m_GridSizeNum = sizeof(m_GridSize) / sizeof(m_GridSize[0]);
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+WaveBenchmark::WaveBenchmark(ThreadPool* _pThreadPool) :
+	m_pThreadPool(_pThreadPool),
+	m_pSnapshot(nullptr)
+{
+}
+
+WaveBenchmark::~WaveBenchmark()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool WaveBenchmark::Run(int _stepNum, int _maxBlockStepNum)
+{
+	m_Result.clear();
+
+	if (_stepNum <= 0 || _maxBlockStepNum <= 0)
+	{
+		return false;
+	}
+
+	const CpuFeature::SIMD_TYPE SimdTypes[] =
+	{
+		CpuFeature::SIMD_SCALAR, CpuFeature::SIMD_SSE, CpuFeature::SIMD_AVX2, CpuFeature::SIMD_NEON
+	};
+	const int SimdTypeNum = sizeof(SimdTypes) / sizeof(SimdTypes[0]);
+
+	for (int i = 0; i < m_GridSizeNum; i++)
+	{
+		int Size = m_GridSize[i];
+
+		WaveSimulator Simulator(Size, Size);
+		if (!Simulator.Initialize())
+		{
+			return false;
+		}
+
+		// 全てのセルを計算させるためにスパース更新は止める.
+		Simulator.SetThreadPool(m_pThreadPool);
+		Simulator.SetIsSparse(false);
+
+		for (int j = 0; j < SimdTypeNum; j++)
+		{
+			if (!CpuFeature::IsSupport(SimdTypes[j]))
+			{
+				continue;
+			}
+
+			Simulator.SetSimdType(SimdTypes[j]);
+			Simulator.SetPrecision(WaveSimulator::PRECISION_FLOAT32);
+			ResetState(&Simulator);
+
+			for (int BlockStepNum = 1; BlockStepNum <= _maxBlockStepNum; BlockStepNum++)
+			{
+				Simulator.SetBlockStepNum(BlockStepNum);
+				Simulator.Step(BlockStepNum);	// 作業領域の確保を計測から外す.
+				Measure(&Simulator, Size, _stepNum);
+			}
+
+			// 固定小数点での計測.
+			Simulator.SetPrecision(WaveSimulator::PRECISION_FIXED16);
+			Simulator.Step();
+			Measure(&Simulator, Size, _stepNum);
+		}
+
+		Simulator.Finalize();
+	}
+
+	return true;
+}
+
+bool WaveBenchmark::WriteResult(const char* _pFileName) const
+{
+	std::ofstream File(_pFileName);
+	if (!File)
+	{
+		return false;
+	}
+
+	File << "Size,SIMD,K,Precision,ms/step,Mcell/s\n";
+	for (auto itr = m_Result.begin(); itr != m_Result.end(); itr++)
+	{
+		File << itr->Size << "," << CpuFeature::GetSimdName(itr->SimdType) << "," << itr->BlockStepNum << "," << (itr->IsFixed ? "Q14" : "F32") << "," << itr->MilliSecondPerStep << "," << itr->MegaCellPerSecond << "\n";
+	}
+
+	return static_cast<bool>(File);
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void WaveBenchmark::ResetState(WaveSimulator* _pSimulator) const
+{
+	_pSimulator->Clear(WaveSimulator::m_DefaultWaveHeight, WaveSimulator::m_DefaultWaveVelocity);
+
+	if (m_pSnapshot == nullptr || !_pSimulator->LoadSnapshot(*m_pSnapshot))
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			_pSimulator->AddWave((i % 4 + 0.5f) * 0.25f, (i / 4 + 0.5f) * 0.25f, 0.04f);
+		}
+	}
+}
+
+void WaveBenchmark::Measure(WaveSimulator* _pSimulator, int _size, int _stepNum)
+{
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	_pSimulator->Step(_stepNum);
+	std::chrono::steady_clock::time_point EndTime = std::chrono::steady_clock::now();
+
+	double MilliSecond = std::chrono::duration<double, std::milli>(EndTime - StartTime).count();
+	bool IsFixed = _pSimulator->GetPrecision() == WaveSimulator::PRECISION_FIXED16;
+
+	RESULT Result;
+	Result.Size = _size;
+	Result.SimdType = _pSimulator->GetSimdType();
+	Result.BlockStepNum = IsFixed ? 1 : _pSimulator->GetBlockStepNum();
+	Result.IsFixed = IsFixed;
+	Result.MilliSecondPerStep = static_cast<float>(MilliSecond / _stepNum);
+	Result.MegaCellPerSecond = MilliSecond > 0.0 ?
+		static_cast<float>(static_cast<double>(_size) * _size * _stepNum / (MilliSecond * 1000.0)) : 0.0f;
+	m_Result.push_back(Result);
+}
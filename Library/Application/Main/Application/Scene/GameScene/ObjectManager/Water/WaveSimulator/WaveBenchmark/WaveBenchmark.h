@@ -0,0 +1,116 @@
+﻿/**
+ * @file	WaveBenchmark.h
+ * @brief	波シミュレーション計測クラス定義
+ * @author	morimoto
+ */
+#ifndef WAVEBENCHMARK_H
+#define WAVEBENCHMARK_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+class ThreadPool;
+class WaveSimulator;
+class WaveSnapshot;
+
+
+/**
+ * 波シミュレーション計測クラス
+ *
+ * 波マップの大きさと時間ブロッキングのステップ数(K)を変えて1ステップあたりの時間を計測する.
+ * 固定小数点の計算は時間ブロッキングを行わないので, 大きさごとにK=1として計測する.
+ * スカラーとSIMDの差が分かるように, 実行環境で使用可能な命令セットごとに同じ計測を繰り返す.
+ * スナップショットが設定されていれば, 同じ大きさの波マップは命令セットごとにその状態から計測を始める.
+ */
+class WaveBenchmark
+{
+public:
+	/**
+	 * 計測結果の構造体
+	 */
+	struct RESULT
+	{
+		int						Size;				//!< 波マップの幅と高さ.
+		CpuFeature::SIMD_TYPE	SimdType;			//!< 計算に使用した命令セット.
+		int						BlockStepNum;		//!< 時間ブロッキングで1度に進めるステップ数.
+		bool					IsFixed;			//!< 固定小数点で計算したか.
+		float					MilliSecondPerStep;	//!< 1ステップあたりの時間(ミリ秒).
+		float					MegaCellPerSecond;	//!< 1秒あたりに更新したセル数(百万単位).
+	};
+
+	/**
+	 * コンストラクタ
+	 * @param[in] _pThreadPool 計測に使用するスレッドプール(nullptrなら呼び出し元スレッドのみ)
+	 */
+	WaveBenchmark(ThreadPool* _pThreadPool);
+
+	/**
+	 * デストラクタ
+	 */
+	~WaveBenchmark();
+
+	/**
+	 * 計測を始める状態のスナップショットを設定
+	 * @param[in] _pSnapshot 開いているスナップショット(nullptrなら平らな水面に波を追加して始める)
+	 */
+	void SetSnapshot(const WaveSnapshot* _pSnapshot)
+	{
+		m_pSnapshot = _pSnapshot;
+	}
+
+	/**
+	 * 計測の実行
+	 * @param[in] _stepNum 1つの条件で進めるステップ数
+	 * @param[in] _maxBlockStepNum 計測する時間ブロッキングのステップ数の最大値(1から順に計測する)
+	 * @return 計測に成功したらtrue 失敗したらfalse
+	 */
+	bool Run(int _stepNum, int _maxBlockStepNum);
+
+	/**
+	 * 計測結果をCSV形式でファイルに書き込む
+	 * @param[in] _pFileName 書き込むファイル名
+	 * @return 書き込みに成功したらtrue 失敗したらfalse
+	 */
+	bool WriteResult(const char* _pFileName) const;
+
+	/**
+	 * 計測結果を取得
+	 * @return 計測結果
+	 */
+	const std::vector<RESULT>& GetResult() const
+	{
+		return m_Result;
+	}
+
+	static const int m_GridSize[];		//!< 計測する波マップの大きさ.
+	static const int m_GridSizeNum;		//!< 計測する波マップの大きさの数.
+
+private:
+	/**
+	 * 計測を始める状態にする
+	 * @param[in,out] _pSimulator 状態を設定するシミュレーション
+	 */
+	void ResetState(WaveSimulator* _pSimulator) const;
+
+	/**
+	 * 現在の設定でステップを進めて計測結果を追加する
+	 * @param[in,out] _pSimulator 計測するシミュレーション
+	 * @param[in] _size 波マップの幅と高さ
+	 * @param[in] _stepNum 進めるステップ数
+	 */
+	void Measure(WaveSimulator* _pSimulator, int _size, int _stepNum);
+
+
+	ThreadPool*			m_pThreadPool;	//!< 計測に使用するスレッドプール.
+	const WaveSnapshot*	m_pSnapshot;	//!< 計測を始める状態のスナップショット.
+	std::vector<RESULT>	m_Result;		//!< 計測結果.
+
+};
+
+
+#endif // !WAVEBENCHMARK_H
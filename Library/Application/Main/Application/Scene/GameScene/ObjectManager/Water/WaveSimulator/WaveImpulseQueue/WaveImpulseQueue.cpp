@@ -0,0 +1,179 @@
+﻿/**
+ * @file	WaveImpulseQueue.cpp
+ * @brief	波の追加要求キュークラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaveImpulseQueue.h"
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+WaveImpulseQueue::WaveImpulseQueue() :
+	m_MinX(0.0f),
+	m_MaxZ(1.0f),
+	m_InvWidth(1.0f),
+	m_InvDepth(1.0f)
+{
+}
+
+WaveImpulseQueue::~WaveImpulseQueue()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void WaveImpulseQueue::SetWorldArea(float _minX, float _maxZ, float _width, float _depth)
+{
+	m_MinX = _minX;
+	m_MaxZ = _maxZ;
+	m_InvWidth = 1.0f / _width;
+	m_InvDepth = 1.0f / _depth;
+}
+
+void WaveImpulseQueue::Push(float _u, float _v, float _radius, float _strength)
+{
+	IMPULSE Impulse = { _u, _v, _radius, _strength, false };
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	m_Impulse.push_back(Impulse);
+}
+
+void WaveImpulseQueue::Push(const IMPULSE* _pImpulse, int _impulseNum)
+{
+	if (_impulseNum <= 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	m_Impulse.insert(m_Impulse.end(), _pImpulse, _pImpulse + _impulseNum);
+}
+
+void WaveImpulseQueue::PushWorld(float _x, float _z, float _radius, float _strength)
+{
+	// テクスチャ座標のvはz軸と逆向き.
+	Push((_x - m_MinX) * m_InvWidth, (m_MaxZ - _z) * m_InvDepth, _radius * m_InvWidth, _strength);
+}
+
+void WaveImpulseQueue::PushWorld(const float* _pX, const float* _pZ, int _impulseNum, float _radius, float _strength)
+{
+	if (_impulseNum <= 0)
+	{
+		return;
+	}
+
+	// 1つずつPushするとその度にロックするので, 1回のロックでまとめて追加する.
+	float Radius = _radius * m_InvWidth;
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	size_t Begin = m_Impulse.size();
+	m_Impulse.resize(Begin + _impulseNum);
+	for (int i = 0; i < _impulseNum; i++)
+	{
+		IMPULSE& Impulse = m_Impulse[Begin + i];
+		Impulse.U = (_pX[i] - m_MinX) * m_InvWidth;
+		Impulse.V = (m_MaxZ - _pZ[i]) * m_InvDepth;
+		Impulse.Radius = Radius;
+		Impulse.Strength = _strength;
+		Impulse.IsDrop = false;
+	}
+}
+
+void WaveImpulseQueue::PushWorldDrop(const float* _pX, const float* _pZ, int _impulseNum, float _radius, float _strength)
+{
+	if (_impulseNum <= 0)
+	{
+		return;
+	}
+
+	float Radius = _radius * m_InvWidth;
+
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	size_t Begin = m_Impulse.size();
+	m_Impulse.resize(Begin + _impulseNum);
+	for (int i = 0; i < _impulseNum; i++)
+	{
+		IMPULSE& Impulse = m_Impulse[Begin + i];
+		Impulse.U = (_pX[i] - m_MinX) * m_InvWidth;
+		Impulse.V = (m_MaxZ - _pZ[i]) * m_InvDepth;
+		Impulse.Radius = Radius;
+		Impulse.Strength = _strength;
+		Impulse.IsDrop = true;
+	}
+}
+
+void WaveImpulseQueue::PopAll(std::vector<IMPULSE>* _pImpulse)
+{
+	_pImpulse->clear();
+
+	// 入れ替えることで双方の確保済みの領域を使い回す.
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	m_Impulse.swap(*_pImpulse);
+}
+
+void WaveImpulseQueue::Clear()
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	m_Impulse.clear();
+}
+
+int WaveImpulseQueue::GetImpulseNum() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	return static_cast<int>(m_Impulse.size());
+}
+
+
+//----------------------------------------------------------------------
+// Static Public Functions
+//----------------------------------------------------------------------
+double WaveImpulseQueue::GetDropVelocity(const IMPULSE& _impulse, int _x, int _y, int _width, int _height)
+{
+	// 隣接セルとの差は隣のセルで符号が逆になって打ち消し合うので, 合計は0になる.
+	double Center = GetDropHeight(_impulse, _x, _y, _width, _height);
+	double Laplacian = 0.0;
+	if (_x > 0)
+	{
+		Laplacian += GetDropHeight(_impulse, _x - 1, _y, _width, _height) - Center;
+	}
+	if (_x < _width - 1)
+	{
+		Laplacian += GetDropHeight(_impulse, _x + 1, _y, _width, _height) - Center;
+	}
+	if (_y > 0)
+	{
+		Laplacian += GetDropHeight(_impulse, _x, _y - 1, _width, _height) - Center;
+	}
+	if (_y < _height - 1)
+	{
+		Laplacian += GetDropHeight(_impulse, _x, _y + 1, _width, _height) - Center;
+	}
+
+	// 中心のラプラシアン(-4 / 半径^2をx, yの分足したもの)で割って, 中心の速度を強さの分だけ下げる.
+	double RadiusX = static_cast<double>(_impulse.Radius) * _width;
+	double RadiusY = static_cast<double>(_impulse.Radius) * _height;
+	double CenterLaplacian = 4.0 / (RadiusX * RadiusX) + 4.0 / (RadiusY * RadiusY);
+
+	return Laplacian * _impulse.Strength / CenterLaplacian;
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+double WaveImpulseQueue::GetDropHeight(const IMPULSE& _impulse, int _x, int _y, int _width, int _height)
+{
+	// 距離はWaveSimulatorと同じくテクセル中心のテクスチャ座標で求める.
+	double DistU = (_x + 0.5) / _width - _impulse.U;
+	double DistV = (_y + 0.5) / _height - _impulse.V;
+	double Falloff = 1.0 - (DistU * DistU + DistV * DistV) / (static_cast<double>(_impulse.Radius) * _impulse.Radius);
+
+	return Falloff > 0.0 ? Falloff * Falloff : 0.0;
+}
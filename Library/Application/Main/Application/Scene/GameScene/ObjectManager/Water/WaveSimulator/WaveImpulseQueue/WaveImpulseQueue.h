@@ -0,0 +1,160 @@
+﻿/**
+ * @file	WaveImpulseQueue.h
+ * @brief	波の追加要求キュークラス定義
+ * @author	morimoto
+ */
+#ifndef WAVEIMPULSEQUEUE_H
+#define WAVEIMPULSEQUEUE_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <mutex>
+#include <vector>
+
+
+/**
+ * 波の追加要求キュークラス
+ *
+ * 雨粒の着水などで発生する波(位置, 半径, 強さ)を複数のオブジェクトから受け付け,
+ * WaveSimulator::Stepでまとめて取り出して1回の更新で反映する.
+ *
+ * Pushで追加する波は半径内の速度を上げるだけなので水面全体を持ち上げる.
+ * 雨粒のように毎フレーム大量に追加する波はPushWorldDropで追加すると,
+ * 中心を押し下げて周囲の輪を押し上げる合計0の波になり, 平均の高さが変わらない.
+ * 追加は排他制御されているので, 並列処理中のどのスレッドから呼んでもよい.
+ */
+class WaveImpulseQueue
+{
+public:
+	/**
+	 * 追加する波の構造体
+	 */
+	struct IMPULSE
+	{
+		float U;		//!< テクスチャ座標u(0～1).
+		float V;		//!< テクスチャ座標v(0～1).
+		float Radius;	//!< 半径(テクスチャ座標).
+		float Strength;	//!< 速度に加算する強さ.
+		bool IsDrop;	//!< 着水の波(合計0の波)か.
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	WaveImpulseQueue();
+
+	/**
+	 * デストラクタ
+	 */
+	~WaveImpulseQueue();
+
+	/**
+	 * 波マップが覆うワールド座標の範囲を設定(PushWorldで使用する)
+	 * @param[in] _minX 波マップの左端(u=0)のx座標
+	 * @param[in] _maxZ 波マップの上端(v=0)のz座標
+	 * @param[in] _width 波マップのx方向の大きさ
+	 * @param[in] _depth 波マップのz方向の大きさ
+	 */
+	void SetWorldArea(float _minX, float _maxZ, float _width, float _depth);
+
+	/**
+	 * テクスチャ座標で波を追加
+	 * @param[in] _u テクスチャ座標u
+	 * @param[in] _v テクスチャ座標v
+	 * @param[in] _radius 半径(テクスチャ座標)
+	 * @param[in] _strength 速度に加算する強さ
+	 */
+	void Push(float _u, float _v, float _radius, float _strength);
+
+	/**
+	 * 複数の波をまとめて追加
+	 * @param[in] _pImpulse 追加する波の配列
+	 * @param[in] _impulseNum 追加する波の数
+	 */
+	void Push(const IMPULSE* _pImpulse, int _impulseNum);
+
+	/**
+	 * ワールド座標で波を追加
+	 * @param[in] _x ワールド座標x
+	 * @param[in] _z ワールド座標z
+	 * @param[in] _radius 半径(ワールド座標のx方向の大きさ)
+	 * @param[in] _strength 速度に加算する強さ
+	 */
+	void PushWorld(float _x, float _z, float _radius, float _strength);
+
+	/**
+	 * ワールド座標で同じ半径と強さの波をまとめて追加
+	 * @param[in] _pX ワールド座標xの配列
+	 * @param[in] _pZ ワールド座標zの配列
+	 * @param[in] _impulseNum 追加する波の数
+	 * @param[in] _radius 半径(ワールド座標のx方向の大きさ)
+	 * @param[in] _strength 速度に加算する強さ
+	 */
+	void PushWorld(const float* _pX, const float* _pZ, int _impulseNum, float _radius, float _strength);
+
+	/**
+	 * ワールド座標で着水の波をまとめて追加
+	 * @param[in] _pX ワールド座標xの配列
+	 * @param[in] _pZ ワールド座標zの配列
+	 * @param[in] _impulseNum 追加する波の数
+	 * @param[in] _radius 半径(ワールド座標のx方向の大きさ)
+	 * @param[in] _strength 中心の速度から引く強さ
+	 */
+	void PushWorldDrop(const float* _pX, const float* _pZ, int _impulseNum, float _radius, float _strength);
+
+	/**
+	 * 溜まっている波を全て取り出す
+	 * @param[out] _pImpulse 取り出した波の格納先(元の内容は破棄される)
+	 */
+	void PopAll(std::vector<IMPULSE>* _pImpulse);
+
+	/**
+	 * 溜まっている波を破棄
+	 */
+	void Clear();
+
+	/**
+	 * 溜まっている波の数を取得
+	 * @return 波の数
+	 */
+	int GetImpulseNum() const;
+
+	/**
+	 * 着水の波がセルの速度に加える値を取得
+	 *
+	 * 盛り上がり(1 - 距離^2 / 半径^2)^2を波マップの内側の隣接セルとの差の合計(離散ラプラシアン)にして加えるので,
+	 * 波マップの端にかかっても全てのセルの合計は0になる. 中心は強さの分だけ下がり, 半径の0.7倍より外側の輪が上がる.
+	 * 範囲は半径の外側1セルまで(WaveSimulatorの波の範囲の判定と同じ)に収まる.
+	 * @param[in] _impulse 着水の波
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @param[in] _width 波マップの幅
+	 * @param[in] _height 波マップの高さ
+	 * @return 速度に加える値
+	 */
+	static double GetDropVelocity(const IMPULSE& _impulse, int _x, int _y, int _width, int _height);
+
+private:
+	/**
+	 * 着水の波の盛り上がりを取得
+	 * @param[in] _impulse 着水の波
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @param[in] _width 波マップの幅
+	 * @param[in] _height 波マップの高さ
+	 * @return 中心で1, 半径の外側で0になる盛り上がり
+	 */
+	static double GetDropHeight(const IMPULSE& _impulse, int _x, int _y, int _width, int _height);
+
+	mutable std::mutex		m_Mutex;		//!< 追加と取り出しの排他制御.
+	std::vector<IMPULSE>	m_Impulse;		//!< 溜まっている波.
+	float					m_MinX;			//!< 波マップの左端のx座標.
+	float					m_MaxZ;			//!< 波マップの上端のz座標.
+	float					m_InvWidth;		//!< 波マップのx方向の大きさの逆数.
+	float					m_InvDepth;		//!< 波マップのz方向の大きさの逆数.
+
+};
+
+
+#endif // !WAVEIMPULSEQUEUE_H
@@ -0,0 +1,171 @@
+﻿/**
+ * @file	WaveObstacleMask.cpp
+ * @brief	波の障害物マスククラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaveObstacleMask.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+WaveObstacleMask::WaveObstacleMask() :
+	m_Width(0),
+	m_Height(0),
+	m_RowBytes(0),
+	m_SolidNum(0),
+	m_MinX(0.0f),
+	m_MaxZ(1.0f),
+	m_AreaWidth(1.0f),
+	m_AreaDepth(1.0f)
+{
+}
+
+WaveObstacleMask::~WaveObstacleMask()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void WaveObstacleMask::SetWorldArea(float _minX, float _maxZ, float _width, float _depth)
+{
+	m_MinX = _minX;
+	m_MaxZ = _maxZ;
+	m_AreaWidth = _width;
+	m_AreaDepth = _depth;
+}
+
+void WaveObstacleMask::AddRect(float _x, float _z, float _halfWidth, float _halfDepth, float _rotate)
+{
+	FOOTPRINT Footprint = { _x, _z, _halfWidth, _halfDepth, std::sin(_rotate), std::cos(_rotate) };
+	m_Footprint.push_back(Footprint);
+}
+
+void WaveObstacleMask::ClearRect()
+{
+	m_Footprint.clear();
+}
+
+bool WaveObstacleMask::Build(int _width, int _height)
+{
+	if (_width <= 0 || _height <= 0)
+	{
+		return false;
+	}
+
+	// LoadBitsが行末から4バイト読み込んでも隣の行に触れないように余白を取る.
+	m_Width = _width;
+	m_Height = _height;
+	m_RowBytes = ((((_width + 2) + 7) >> 3) + 4 + 3) & ~3;
+	m_Bits.assign(static_cast<size_t>(m_RowBytes) * (_height + 2), 0);
+	m_SolidNum = 0;
+
+	for (auto itr = m_Footprint.begin(); itr != m_Footprint.end(); itr++)
+	{
+		Rasterize(*itr);
+	}
+
+	return true;
+}
+
+void WaveObstacleMask::Release()
+{
+	std::vector<unsigned char>().swap(m_Bits);
+	m_Width = 0;
+	m_Height = 0;
+	m_RowBytes = 0;
+	m_SolidNum = 0;
+}
+
+bool WaveObstacleMask::IsAnySolid(int _minX, int _minY, int _maxX, int _maxY) const
+{
+	_minX = std::max(_minX, 0);
+	_minY = std::max(_minY, 0);
+	_maxX = std::min(_maxX, m_Width);
+	_maxY = std::min(_maxY, m_Height);
+
+	if (m_SolidNum == 0 || _minX >= _maxX || _minY >= _maxY)
+	{
+		return false;
+	}
+
+	for (int y = _minY; y < _maxY; y++)
+	{
+		const unsigned char* pRow = GetRow(y);
+		for (int x = _minX; x < _maxX; x++)
+		{
+			if (TestBit(pRow, x + 1))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void WaveObstacleMask::WriteTexture(unsigned char* _pData, int _rowPitch) const
+{
+	for (int y = 0; y < m_Height; y++)
+	{
+		const unsigned char* pRow = GetRow(y);
+		unsigned char* pPixel = _pData + static_cast<size_t>(y) * _rowPitch;
+		for (int x = 0; x < m_Width; x++)
+		{
+			pPixel[x] = TestBit(pRow, x + 1) ? 255 : 0;
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void WaveObstacleMask::Rasterize(const FOOTPRINT& _footprint)
+{
+	// 回転後の外接矩形からセルの範囲を求める.
+	float ExtentX = std::fabs(_footprint.HalfWidth * _footprint.Cos) + std::fabs(_footprint.HalfDepth * _footprint.Sin);
+	float ExtentZ = std::fabs(_footprint.HalfWidth * _footprint.Sin) + std::fabs(_footprint.HalfDepth * _footprint.Cos);
+	float CellWidth = m_AreaWidth / static_cast<float>(m_Width);
+	float CellDepth = m_AreaDepth / static_cast<float>(m_Height);
+
+	int MinX = std::max(static_cast<int>(std::floor((_footprint.X - ExtentX - m_MinX) / CellWidth)), 0);
+	int MaxX = std::min(static_cast<int>(std::floor((_footprint.X + ExtentX - m_MinX) / CellWidth)), m_Width - 1);
+	int MinY = std::max(static_cast<int>(std::floor((m_MaxZ - (_footprint.Z + ExtentZ)) / CellDepth)), 0);
+	int MaxY = std::min(static_cast<int>(std::floor((m_MaxZ - (_footprint.Z - ExtentZ)) / CellDepth)), m_Height - 1);
+
+	for (int y = MinY; y <= MaxY; y++)
+	{
+		unsigned char* pRow = &m_Bits[static_cast<size_t>(y + 1) * m_RowBytes];
+		float DistZ = (m_MaxZ - (static_cast<float>(y) + 0.5f) * CellDepth) - _footprint.Z;
+
+		for (int x = MinX; x <= MaxX; x++)
+		{
+			// セルの中心を回転前の座標系に戻して判定する.
+			float DistX = (m_MinX + (static_cast<float>(x) + 0.5f) * CellWidth) - _footprint.X;
+			float LocalX = DistX * _footprint.Cos - DistZ * _footprint.Sin;
+			float LocalZ = DistX * _footprint.Sin + DistZ * _footprint.Cos;
+			if (std::fabs(LocalX) > _footprint.HalfWidth || std::fabs(LocalZ) > _footprint.HalfDepth)
+			{
+				continue;
+			}
+
+			int Bit = x + 1;
+			unsigned char BitMask = static_cast<unsigned char>(1 << (Bit & 7));
+			if ((pRow[Bit >> 3] & BitMask) == 0)
+			{
+				pRow[Bit >> 3] |= BitMask;
+				m_SolidNum++;
+			}
+		}
+	}
+}
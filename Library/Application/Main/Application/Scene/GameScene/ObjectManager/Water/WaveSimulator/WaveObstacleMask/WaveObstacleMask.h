@@ -0,0 +1,230 @@
+﻿/**
+ * @file	WaveObstacleMask.h
+ * @brief	波の障害物マスククラス定義
+ * @author	morimoto
+ */
+#ifndef WAVEOBSTACLEMASK_H
+#define WAVEOBSTACLEMASK_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+
+/**
+ * 波の障害物マスククラス
+ *
+ * 家などのオブジェクトが水面を占める範囲(フットプリント)をワールド座標で受け付け,
+ * 波マップの1セルを1ビットとしたマスクに変換する.
+ * マスクはWaveSimulatorと同じく外周1セル分を含めて保持し, セル(x, y)は(y + 1)行目の(x + 1)ビット目に対応する.
+ * 外周は常に0(障害物なし)で, 波マップの端はこれまで通り端の値の複製で反射する.
+ *
+ * 更新関数はLoadBitsで連続するセルのビットをまとめて読み込み, SIMDのレーンマスクに展開して
+ * 障害物の隣接セルを中心セルの値に置き換える(法線方向の勾配が0の境界条件で波が反射する).
+ */
+class WaveObstacleMask
+{
+public:
+	/**
+	 * 1行分の更新で参照するマスクの構造体
+	 */
+	struct ROW_MASK
+	{
+		const unsigned char*	pUp;		//!< 上の行のマスク.
+		const unsigned char*	pCenter;	//!< 更新する行のマスク.
+		const unsigned char*	pDown;		//!< 下の行のマスク.
+		int						Bit;		//!< 更新する先頭のセルのビット位置.
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	WaveObstacleMask();
+
+	/**
+	 * デストラクタ
+	 */
+	~WaveObstacleMask();
+
+	/**
+	 * 波マップが覆うワールド座標の範囲を設定(WaveImpulseQueue::SetWorldAreaと同じ)
+	 * @param[in] _minX 波マップの左端(u=0)のx座標
+	 * @param[in] _maxZ 波マップの上端(v=0)のz座標
+	 * @param[in] _width 波マップのx方向の大きさ
+	 * @param[in] _depth 波マップのz方向の大きさ
+	 */
+	void SetWorldArea(float _minX, float _maxZ, float _width, float _depth);
+
+	/**
+	 * 矩形のフットプリントを追加(次のBuildで反映される)
+	 * @param[in] _x 中心のワールド座標x
+	 * @param[in] _z 中心のワールド座標z
+	 * @param[in] _halfWidth 回転前のx方向の大きさの半分
+	 * @param[in] _halfDepth 回転前のz方向の大きさの半分
+	 * @param[in] _rotate Y軸回転(ラジアン, Object3DBase::m_Rotate.yと同じ向き)
+	 */
+	void AddRect(float _x, float _z, float _halfWidth, float _halfDepth, float _rotate);
+
+	/**
+	 * 追加したフットプリントを全て破棄
+	 */
+	void ClearRect();
+
+	/**
+	 * フットプリントからマスクを作成
+	 * @param[in] _width 波マップの幅
+	 * @param[in] _height 波マップの高さ
+	 * @return 作成に成功したらtrue 失敗したらfalse
+	 */
+	bool Build(int _width, int _height);
+
+	/**
+	 * マスクを破棄
+	 */
+	void Release();
+
+	/**
+	 * 指定セルが障害物かを取得
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @return 障害物ならtrue
+	 */
+	bool IsSolid(int _x, int _y) const
+	{
+		return TestBit(GetRow(_y), _x + 1);
+	}
+
+	/**
+	 * 指定範囲に障害物のセルがあるかを取得
+	 * @param[in] _minX 範囲の左端
+	 * @param[in] _minY 範囲の上端
+	 * @param[in] _maxX 範囲の右端(含まない)
+	 * @param[in] _maxY 範囲の下端(含まない)
+	 * @return 障害物のセルがあればtrue
+	 */
+	bool IsAnySolid(int _minX, int _minY, int _maxX, int _maxY) const;
+
+	/**
+	 * 障害物のセルの数を取得
+	 * @return 障害物のセルの数
+	 */
+	int GetSolidNum() const
+	{
+		return m_SolidNum;
+	}
+
+	/**
+	 * マスクの幅を取得
+	 * @return マスクの幅(Buildしていなければ0)
+	 */
+	int GetWidth() const
+	{
+		return m_Width;
+	}
+
+	/**
+	 * マスクの高さを取得
+	 * @return マスクの高さ(Buildしていなければ0)
+	 */
+	int GetHeight() const
+	{
+		return m_Height;
+	}
+
+	/**
+	 * 行のビット列の先頭を取得
+	 * @param[in] _y 行番号(-1～高さ)
+	 * @return 行の先頭へのポインタ
+	 */
+	const unsigned char* GetRow(int _y) const
+	{
+		return &m_Bits[(_y + 1) * m_RowBytes];
+	}
+
+	/**
+	 * 1行分の更新で参照するマスクを取得
+	 * @param[in] _x 更新する先頭のセルのx座標
+	 * @param[in] _y 更新する行
+	 * @return マスク
+	 */
+	ROW_MASK GetRowMask(int _x, int _y) const
+	{
+		ROW_MASK Mask = { GetRow(_y - 1), GetRow(_y), GetRow(_y + 1), _x + 1 };
+		return Mask;
+	}
+
+	/**
+	 * マスクをR8(障害物は255)でテクスチャデータに書き込む
+	 * @param[out] _pData 書き込み先(幅x高さ分のピクセル)
+	 * @param[in] _rowPitch 書き込み先の1行分のバイト数
+	 */
+	void WriteTexture(unsigned char* _pData, int _rowPitch) const;
+
+	/**
+	 * 指定ビットを取得
+	 * @param[in] _pRow 行のビット列
+	 * @param[in] _bit ビット位置
+	 * @return ビットが立っていればtrue
+	 */
+	static bool TestBit(const unsigned char* _pRow, int _bit)
+	{
+		return ((_pRow[_bit >> 3] >> (_bit & 7)) & 1) != 0;
+	}
+
+	/**
+	 * 指定ビットから連続するビットをまとめて読み込む
+	 *
+	 * 下位ビットから順に_bit, _bit + 1...のセルに対応し, 少なくとも25ビットが有効.
+	 * 各行の末尾には読み込み分の余白を確保している.
+	 * @param[in] _pRow 行のビット列
+	 * @param[in] _bit 先頭のビット位置
+	 * @return 読み込んだビット列
+	 */
+	static unsigned int LoadBits(const unsigned char* _pRow, int _bit)
+	{
+		const unsigned char* pByte = _pRow + (_bit >> 3);
+		unsigned int Bits =
+			static_cast<unsigned int>(pByte[0]) |
+			(static_cast<unsigned int>(pByte[1]) << 8) |
+			(static_cast<unsigned int>(pByte[2]) << 16) |
+			(static_cast<unsigned int>(pByte[3]) << 24);
+		return Bits >> (_bit & 7);
+	}
+
+private:
+	/**
+	 * 矩形のフットプリント構造体
+	 */
+	struct FOOTPRINT
+	{
+		float X;			//!< 中心のワールド座標x.
+		float Z;			//!< 中心のワールド座標z.
+		float HalfWidth;	//!< 回転前のx方向の大きさの半分.
+		float HalfDepth;	//!< 回転前のz方向の大きさの半分.
+		float Sin;			//!< Y軸回転の正弦.
+		float Cos;			//!< Y軸回転の余弦.
+	};
+
+	/**
+	 * フットプリントをマスクに書き込む
+	 * @param[in] _footprint 書き込むフットプリント
+	 */
+	void Rasterize(const FOOTPRINT& _footprint);
+
+
+	std::vector<FOOTPRINT>		m_Footprint;	//!< 追加されたフットプリント.
+	std::vector<unsigned char>	m_Bits;			//!< マスクのビット列(外周を含む).
+	int							m_Width;		//!< マスクの幅.
+	int							m_Height;		//!< マスクの高さ.
+	int							m_RowBytes;		//!< 1行分のバイト数(末尾の余白を含む).
+	int							m_SolidNum;		//!< 障害物のセルの数.
+	float						m_MinX;			//!< 波マップの左端のx座標.
+	float						m_MaxZ;			//!< 波マップの上端のz座標.
+	float						m_AreaWidth;	//!< 波マップのx方向の大きさ.
+	float						m_AreaDepth;	//!< 波マップのz方向の大きさ.
+
+};
+
+
+#endif // !WAVEOBSTACLEMASK_H
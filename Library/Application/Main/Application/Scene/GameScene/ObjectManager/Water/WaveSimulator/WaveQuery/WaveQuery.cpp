@@ -0,0 +1,493 @@
+﻿/**
+ * @file	WaveQuery.cpp
+ * @brief	波の高さ取得クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaveQuery.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+WaveQuery::WaveQuery() :
+	m_MinX(0.0f),
+	m_MaxZ(1.0f),
+	m_InvWidth(1.0f),
+	m_InvDepth(1.0f),
+	m_SimdType(CpuFeature::GetSimdType())
+{
+}
+
+WaveQuery::~WaveQuery()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void WaveQuery::SetWorldArea(float _minX, float _maxZ, float _width, float _depth)
+{
+	m_MinX = _minX;
+	m_MaxZ = _maxZ;
+	m_InvWidth = 1.0f / _width;
+	m_InvDepth = 1.0f / _depth;
+}
+
+void WaveQuery::Query(const float* _pHeight, int _stride, int _width, int _height, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output) const
+{
+	if (_count <= 0 || _width <= 0 || _height <= 0)
+	{
+		return;
+	}
+
+	// テクセルの中心が整数になるセル座標への変換をまとめておく.
+	PARAM Param;
+	Param.pHeight = _pHeight;
+	Param.Stride = _stride;
+	Param.MaxX = _width - 1;
+	Param.MaxY = _height - 1;
+	Param.ScaleX = m_InvWidth * static_cast<float>(_width);
+	Param.OffsetX = -m_MinX * Param.ScaleX - 0.5f;
+	Param.ScaleZ = -m_InvDepth * static_cast<float>(_height);
+	Param.OffsetZ = m_MaxZ * m_InvDepth * static_cast<float>(_height) - 0.5f;
+
+	GetQueryFunc(m_SimdType)(Param, _pX, _pZ, _count, _output);
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+WaveQuery::QUERY_FUNC WaveQuery::GetQueryFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &QueryAVX2;
+	case CpuFeature::SIMD_SSE:	return &QuerySSE;
+	case CpuFeature::SIMD_NEON:	return &QueryNEON;
+	default:					return &QueryScalar;
+	}
+}
+
+void WaveQuery::QueryScalar(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output)
+{
+	for (int i = 0; i < _count; i++)
+	{
+		float GridX = std::min(std::max(_pX[i] * _param.ScaleX + _param.OffsetX, 0.0f), static_cast<float>(_param.MaxX));
+		float GridY = std::min(std::max(_pZ[i] * _param.ScaleZ + _param.OffsetZ, 0.0f), static_cast<float>(_param.MaxY));
+		int X0 = static_cast<int>(GridX);
+		int Y0 = static_cast<int>(GridY);
+		int X1 = std::min(X0 + 1, _param.MaxX);
+		int Y1 = std::min(Y0 + 1, _param.MaxY);
+		float FracX = GridX - static_cast<float>(X0);
+		float FracY = GridY - static_cast<float>(Y0);
+
+		const float* pRow0 = _param.pHeight + Y0 * _param.Stride;
+		const float* pRow1 = _param.pHeight + Y1 * _param.Stride;
+		float H00 = pRow0[X0];
+		float H10 = pRow0[X1];
+		float H01 = pRow1[X0];
+		float H11 = pRow1[X1];
+
+		float Top = H00 + (H10 - H00) * FracX;
+		float Bottom = H01 + (H11 - H01) * FracX;
+		_output.pHeight[i] = Top + (Bottom - Top) * FracY;
+
+		if (_output.pNormalX == nullptr)
+		{
+			continue;
+		}
+
+		// 4隅のセルの(左 - 右), (上 - 下)を求める.
+		const float* pRowUp = _param.pHeight + std::max(Y0 - 1, 0) * _param.Stride;
+		const float* pRowDown = _param.pHeight + std::min(Y1 + 1, _param.MaxY) * _param.Stride;
+		int XLeft = std::max(X0 - 1, 0);
+		int XRight = std::min(X1 + 1, _param.MaxX);
+
+		float DX00 = pRow0[XLeft] - H10;
+		float DX10 = H00 - pRow0[XRight];
+		float DX01 = pRow1[XLeft] - H11;
+		float DX11 = H01 - pRow1[XRight];
+		float DZ00 = pRowUp[X0] - H01;
+		float DZ10 = pRowUp[X1] - H11;
+		float DZ01 = H00 - pRowDown[X0];
+		float DZ11 = H10 - pRowDown[X1];
+
+		float TopX = DX00 + (DX10 - DX00) * FracX;
+		float BottomX = DX01 + (DX11 - DX01) * FracX;
+		float NormalX = TopX + (BottomX - TopX) * FracY;
+		float TopZ = DZ00 + (DZ10 - DZ00) * FracX;
+		float BottomZ = DZ01 + (DZ11 - DZ01) * FracX;
+		float NormalZ = TopZ + (BottomZ - TopZ) * FracY;
+
+		float InvLength = 1.0f / std::sqrt((NormalX * NormalX + NormalZ * NormalZ) + 1.0f);
+		_output.pNormalX[i] = NormalX * InvLength;
+		_output.pNormalY[i] = InvLength;
+		_output.pNormalZ[i] = NormalZ * InvLength;
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+void WaveQuery::QuerySSE(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output)
+{
+	const __m128 ScaleX = _mm_set1_ps(_param.ScaleX);
+	const __m128 OffsetX = _mm_set1_ps(_param.OffsetX);
+	const __m128 ScaleZ = _mm_set1_ps(_param.ScaleZ);
+	const __m128 OffsetZ = _mm_set1_ps(_param.OffsetZ);
+	const __m128 MaxGridX = _mm_set1_ps(static_cast<float>(_param.MaxX));
+	const __m128 MaxGridY = _mm_set1_ps(static_cast<float>(_param.MaxY));
+	const __m128 Stride = _mm_set1_ps(static_cast<float>(_param.Stride));
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128i MaxX = _mm_set1_epi32(_param.MaxX);
+	const __m128i MaxY = _mm_set1_epi32(_param.MaxY);
+	const __m128i ZeroInt = _mm_setzero_si128();
+	const bool IsNormal = _output.pNormalX != nullptr;
+
+	// SSE2にはgather命令が無いので, インデックスを書き出してから読み込む.
+	int Index[12 * 4];
+	float Value[12 * 4];
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		__m128 GridX = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_pX + i), ScaleX), OffsetX), Zero), MaxGridX);
+		__m128 GridY = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_pZ + i), ScaleZ), OffsetZ), Zero), MaxGridY);
+		__m128i X0 = _mm_cvttps_epi32(GridX);
+		__m128i Y0 = _mm_cvttps_epi32(GridY);
+		__m128 FracX = _mm_sub_ps(GridX, _mm_cvtepi32_ps(X0));
+		__m128 FracY = _mm_sub_ps(GridY, _mm_cvtepi32_ps(Y0));
+
+		// SSE2にはmin_epi32が無いので, 比較結果(-1)を引いて端で止める.
+		__m128i X1 = _mm_sub_epi32(X0, _mm_cmplt_epi32(X0, MaxX));
+		__m128i Y1 = _mm_sub_epi32(Y0, _mm_cmplt_epi32(Y0, MaxY));
+
+		// mullo_epi32も無いので, 行の先頭は浮動小数点で求める(2^24未満なので誤差は出ない).
+		__m128i Row0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(Y0), Stride));
+		__m128i Row1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(Y1), Stride));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 0), _mm_add_epi32(Row0, X0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 4), _mm_add_epi32(Row0, X1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 8), _mm_add_epi32(Row1, X0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 12), _mm_add_epi32(Row1, X1));
+
+		int IndexNum = 16;
+		if (IsNormal)
+		{
+			__m128i XLeft = _mm_add_epi32(X0, _mm_cmpgt_epi32(X0, ZeroInt));
+			__m128i XRight = _mm_sub_epi32(X1, _mm_cmplt_epi32(X1, MaxX));
+			__m128i YUp = _mm_add_epi32(Y0, _mm_cmpgt_epi32(Y0, ZeroInt));
+			__m128i YDown = _mm_sub_epi32(Y1, _mm_cmplt_epi32(Y1, MaxY));
+			__m128i RowUp = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(YUp), Stride));
+			__m128i RowDown = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(YDown), Stride));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 16), _mm_add_epi32(Row0, XLeft));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 20), _mm_add_epi32(Row0, XRight));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 24), _mm_add_epi32(Row1, XLeft));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 28), _mm_add_epi32(Row1, XRight));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 32), _mm_add_epi32(RowUp, X0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 36), _mm_add_epi32(RowUp, X1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 40), _mm_add_epi32(RowDown, X0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Index + 44), _mm_add_epi32(RowDown, X1));
+			IndexNum = 48;
+		}
+
+		for (int j = 0; j < IndexNum; j++)
+		{
+			Value[j] = _param.pHeight[Index[j]];
+		}
+
+		__m128 H00 = _mm_loadu_ps(Value + 0);
+		__m128 H10 = _mm_loadu_ps(Value + 4);
+		__m128 H01 = _mm_loadu_ps(Value + 8);
+		__m128 H11 = _mm_loadu_ps(Value + 12);
+
+		__m128 Top = _mm_add_ps(H00, _mm_mul_ps(_mm_sub_ps(H10, H00), FracX));
+		__m128 Bottom = _mm_add_ps(H01, _mm_mul_ps(_mm_sub_ps(H11, H01), FracX));
+		_mm_storeu_ps(_output.pHeight + i, _mm_add_ps(Top, _mm_mul_ps(_mm_sub_ps(Bottom, Top), FracY)));
+
+		if (!IsNormal)
+		{
+			continue;
+		}
+
+		__m128 DX00 = _mm_sub_ps(_mm_loadu_ps(Value + 16), H10);
+		__m128 DX10 = _mm_sub_ps(H00, _mm_loadu_ps(Value + 20));
+		__m128 DX01 = _mm_sub_ps(_mm_loadu_ps(Value + 24), H11);
+		__m128 DX11 = _mm_sub_ps(H01, _mm_loadu_ps(Value + 28));
+		__m128 DZ00 = _mm_sub_ps(_mm_loadu_ps(Value + 32), H01);
+		__m128 DZ10 = _mm_sub_ps(_mm_loadu_ps(Value + 36), H11);
+		__m128 DZ01 = _mm_sub_ps(H00, _mm_loadu_ps(Value + 40));
+		__m128 DZ11 = _mm_sub_ps(H10, _mm_loadu_ps(Value + 44));
+
+		__m128 TopX = _mm_add_ps(DX00, _mm_mul_ps(_mm_sub_ps(DX10, DX00), FracX));
+		__m128 BottomX = _mm_add_ps(DX01, _mm_mul_ps(_mm_sub_ps(DX11, DX01), FracX));
+		__m128 NormalX = _mm_add_ps(TopX, _mm_mul_ps(_mm_sub_ps(BottomX, TopX), FracY));
+		__m128 TopZ = _mm_add_ps(DZ00, _mm_mul_ps(_mm_sub_ps(DZ10, DZ00), FracX));
+		__m128 BottomZ = _mm_add_ps(DZ01, _mm_mul_ps(_mm_sub_ps(DZ11, DZ01), FracX));
+		__m128 NormalZ = _mm_add_ps(TopZ, _mm_mul_ps(_mm_sub_ps(BottomZ, TopZ), FracY));
+
+		__m128 LengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(NormalX, NormalX), _mm_mul_ps(NormalZ, NormalZ)), One);
+		__m128 InvLength = _mm_div_ps(One, _mm_sqrt_ps(LengthSq));
+		_mm_storeu_ps(_output.pNormalX + i, _mm_mul_ps(NormalX, InvLength));
+		_mm_storeu_ps(_output.pNormalY + i, InvLength);
+		_mm_storeu_ps(_output.pNormalZ + i, _mm_mul_ps(NormalZ, InvLength));
+	}
+
+	if (i < _count)
+	{
+		OUTPUT Output = _output;
+		Output.pHeight += i;
+		if (IsNormal)
+		{
+			Output.pNormalX += i;
+			Output.pNormalY += i;
+			Output.pNormalZ += i;
+		}
+
+		QueryScalar(_param, _pX + i, _pZ + i, _count - i, Output);
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void WaveQuery::QueryAVX2(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output)
+{
+	const __m256 ScaleX = _mm256_set1_ps(_param.ScaleX);
+	const __m256 OffsetX = _mm256_set1_ps(_param.OffsetX);
+	const __m256 ScaleZ = _mm256_set1_ps(_param.ScaleZ);
+	const __m256 OffsetZ = _mm256_set1_ps(_param.OffsetZ);
+	const __m256 MaxGridX = _mm256_set1_ps(static_cast<float>(_param.MaxX));
+	const __m256 MaxGridY = _mm256_set1_ps(static_cast<float>(_param.MaxY));
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 One = _mm256_set1_ps(1.0f);
+	const __m256i Stride = _mm256_set1_epi32(_param.Stride);
+	const __m256i MaxX = _mm256_set1_epi32(_param.MaxX);
+	const __m256i MaxY = _mm256_set1_epi32(_param.MaxY);
+	const __m256i ZeroInt = _mm256_setzero_si256();
+	const __m256i OneInt = _mm256_set1_epi32(1);
+	const float* pHeight = _param.pHeight;
+	const bool IsNormal = _output.pNormalX != nullptr;
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256 GridX = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(_pX + i), ScaleX), OffsetX), Zero), MaxGridX);
+		__m256 GridY = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(_pZ + i), ScaleZ), OffsetZ), Zero), MaxGridY);
+		__m256i X0 = _mm256_cvttps_epi32(GridX);
+		__m256i Y0 = _mm256_cvttps_epi32(GridY);
+		__m256 FracX = _mm256_sub_ps(GridX, _mm256_cvtepi32_ps(X0));
+		__m256 FracY = _mm256_sub_ps(GridY, _mm256_cvtepi32_ps(Y0));
+		__m256i X1 = _mm256_min_epi32(_mm256_add_epi32(X0, OneInt), MaxX);
+		__m256i Y1 = _mm256_min_epi32(_mm256_add_epi32(Y0, OneInt), MaxY);
+		__m256i Row0 = _mm256_mullo_epi32(Y0, Stride);
+		__m256i Row1 = _mm256_mullo_epi32(Y1, Stride);
+
+		__m256 H00 = _mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row0, X0), 4);
+		__m256 H10 = _mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row0, X1), 4);
+		__m256 H01 = _mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row1, X0), 4);
+		__m256 H11 = _mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row1, X1), 4);
+
+		__m256 Top = _mm256_add_ps(H00, _mm256_mul_ps(_mm256_sub_ps(H10, H00), FracX));
+		__m256 Bottom = _mm256_add_ps(H01, _mm256_mul_ps(_mm256_sub_ps(H11, H01), FracX));
+		_mm256_storeu_ps(_output.pHeight + i, _mm256_add_ps(Top, _mm256_mul_ps(_mm256_sub_ps(Bottom, Top), FracY)));
+
+		if (!IsNormal)
+		{
+			continue;
+		}
+
+		__m256i XLeft = _mm256_max_epi32(_mm256_sub_epi32(X0, OneInt), ZeroInt);
+		__m256i XRight = _mm256_min_epi32(_mm256_add_epi32(X1, OneInt), MaxX);
+		__m256i RowUp = _mm256_mullo_epi32(_mm256_max_epi32(_mm256_sub_epi32(Y0, OneInt), ZeroInt), Stride);
+		__m256i RowDown = _mm256_mullo_epi32(_mm256_min_epi32(_mm256_add_epi32(Y1, OneInt), MaxY), Stride);
+
+		__m256 DX00 = _mm256_sub_ps(_mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row0, XLeft), 4), H10);
+		__m256 DX10 = _mm256_sub_ps(H00, _mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row0, XRight), 4));
+		__m256 DX01 = _mm256_sub_ps(_mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row1, XLeft), 4), H11);
+		__m256 DX11 = _mm256_sub_ps(H01, _mm256_i32gather_ps(pHeight, _mm256_add_epi32(Row1, XRight), 4));
+		__m256 DZ00 = _mm256_sub_ps(_mm256_i32gather_ps(pHeight, _mm256_add_epi32(RowUp, X0), 4), H01);
+		__m256 DZ10 = _mm256_sub_ps(_mm256_i32gather_ps(pHeight, _mm256_add_epi32(RowUp, X1), 4), H11);
+		__m256 DZ01 = _mm256_sub_ps(H00, _mm256_i32gather_ps(pHeight, _mm256_add_epi32(RowDown, X0), 4));
+		__m256 DZ11 = _mm256_sub_ps(H10, _mm256_i32gather_ps(pHeight, _mm256_add_epi32(RowDown, X1), 4));
+
+		__m256 TopX = _mm256_add_ps(DX00, _mm256_mul_ps(_mm256_sub_ps(DX10, DX00), FracX));
+		__m256 BottomX = _mm256_add_ps(DX01, _mm256_mul_ps(_mm256_sub_ps(DX11, DX01), FracX));
+		__m256 NormalX = _mm256_add_ps(TopX, _mm256_mul_ps(_mm256_sub_ps(BottomX, TopX), FracY));
+		__m256 TopZ = _mm256_add_ps(DZ00, _mm256_mul_ps(_mm256_sub_ps(DZ10, DZ00), FracX));
+		__m256 BottomZ = _mm256_add_ps(DZ01, _mm256_mul_ps(_mm256_sub_ps(DZ11, DZ01), FracX));
+		__m256 NormalZ = _mm256_add_ps(TopZ, _mm256_mul_ps(_mm256_sub_ps(BottomZ, TopZ), FracY));
+
+		__m256 LengthSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(NormalX, NormalX), _mm256_mul_ps(NormalZ, NormalZ)), One);
+		__m256 InvLength = _mm256_div_ps(One, _mm256_sqrt_ps(LengthSq));
+		_mm256_storeu_ps(_output.pNormalX + i, _mm256_mul_ps(NormalX, InvLength));
+		_mm256_storeu_ps(_output.pNormalY + i, InvLength);
+		_mm256_storeu_ps(_output.pNormalZ + i, _mm256_mul_ps(NormalZ, InvLength));
+	}
+
+	if (i < _count)
+	{
+		OUTPUT Output = _output;
+		Output.pHeight += i;
+		if (IsNormal)
+		{
+			Output.pNormalX += i;
+			Output.pNormalY += i;
+			Output.pNormalZ += i;
+		}
+
+		QuerySSE(_param, _pX + i, _pZ + i, _count - i, Output);
+	}
+}
+
+#else
+
+void WaveQuery::QuerySSE(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output)
+{
+	QueryScalar(_param, _pX, _pZ, _count, _output);
+}
+
+void WaveQuery::QueryAVX2(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output)
+{
+	QueryScalar(_param, _pX, _pZ, _count, _output);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+void WaveQuery::QueryNEON(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output)
+{
+	const float32x4_t ScaleX = vdupq_n_f32(_param.ScaleX);
+	const float32x4_t OffsetX = vdupq_n_f32(_param.OffsetX);
+	const float32x4_t ScaleZ = vdupq_n_f32(_param.ScaleZ);
+	const float32x4_t OffsetZ = vdupq_n_f32(_param.OffsetZ);
+	const float32x4_t MaxGridX = vdupq_n_f32(static_cast<float>(_param.MaxX));
+	const float32x4_t MaxGridY = vdupq_n_f32(static_cast<float>(_param.MaxY));
+	const float32x4_t Zero = vdupq_n_f32(0.0f);
+	const float32x4_t One = vdupq_n_f32(1.0f);
+	const int32x4_t MaxX = vdupq_n_s32(_param.MaxX);
+	const int32x4_t MaxY = vdupq_n_s32(_param.MaxY);
+	const int32x4_t ZeroInt = vdupq_n_s32(0);
+	const int32x4_t OneInt = vdupq_n_s32(1);
+	const bool IsNormal = _output.pNormalX != nullptr;
+
+	// NEONにはgather命令が無いので, インデックスを書き出してから読み込む.
+	int Index[12 * 4];
+	float Value[12 * 4];
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		float32x4_t GridX = vminq_f32(vmaxq_f32(vaddq_f32(vmulq_f32(vld1q_f32(_pX + i), ScaleX), OffsetX), Zero), MaxGridX);
+		float32x4_t GridY = vminq_f32(vmaxq_f32(vaddq_f32(vmulq_f32(vld1q_f32(_pZ + i), ScaleZ), OffsetZ), Zero), MaxGridY);
+		int32x4_t X0 = vcvtq_s32_f32(GridX);
+		int32x4_t Y0 = vcvtq_s32_f32(GridY);
+		float32x4_t FracX = vsubq_f32(GridX, vcvtq_f32_s32(X0));
+		float32x4_t FracY = vsubq_f32(GridY, vcvtq_f32_s32(Y0));
+		int32x4_t X1 = vminq_s32(vaddq_s32(X0, OneInt), MaxX);
+		int32x4_t Y1 = vminq_s32(vaddq_s32(Y0, OneInt), MaxY);
+		int32x4_t Row0 = vmulq_n_s32(Y0, _param.Stride);
+		int32x4_t Row1 = vmulq_n_s32(Y1, _param.Stride);
+
+		vst1q_s32(Index + 0, vaddq_s32(Row0, X0));
+		vst1q_s32(Index + 4, vaddq_s32(Row0, X1));
+		vst1q_s32(Index + 8, vaddq_s32(Row1, X0));
+		vst1q_s32(Index + 12, vaddq_s32(Row1, X1));
+
+		int IndexNum = 16;
+		if (IsNormal)
+		{
+			int32x4_t XLeft = vmaxq_s32(vsubq_s32(X0, OneInt), ZeroInt);
+			int32x4_t XRight = vminq_s32(vaddq_s32(X1, OneInt), MaxX);
+			int32x4_t RowUp = vmulq_n_s32(vmaxq_s32(vsubq_s32(Y0, OneInt), ZeroInt), _param.Stride);
+			int32x4_t RowDown = vmulq_n_s32(vminq_s32(vaddq_s32(Y1, OneInt), MaxY), _param.Stride);
+
+			vst1q_s32(Index + 16, vaddq_s32(Row0, XLeft));
+			vst1q_s32(Index + 20, vaddq_s32(Row0, XRight));
+			vst1q_s32(Index + 24, vaddq_s32(Row1, XLeft));
+			vst1q_s32(Index + 28, vaddq_s32(Row1, XRight));
+			vst1q_s32(Index + 32, vaddq_s32(RowUp, X0));
+			vst1q_s32(Index + 36, vaddq_s32(RowUp, X1));
+			vst1q_s32(Index + 40, vaddq_s32(RowDown, X0));
+			vst1q_s32(Index + 44, vaddq_s32(RowDown, X1));
+			IndexNum = 48;
+		}
+
+		for (int j = 0; j < IndexNum; j++)
+		{
+			Value[j] = _param.pHeight[Index[j]];
+		}
+
+		float32x4_t H00 = vld1q_f32(Value + 0);
+		float32x4_t H10 = vld1q_f32(Value + 4);
+		float32x4_t H01 = vld1q_f32(Value + 8);
+		float32x4_t H11 = vld1q_f32(Value + 12);
+
+		float32x4_t Top = vaddq_f32(H00, vmulq_f32(vsubq_f32(H10, H00), FracX));
+		float32x4_t Bottom = vaddq_f32(H01, vmulq_f32(vsubq_f32(H11, H01), FracX));
+		vst1q_f32(_output.pHeight + i, vaddq_f32(Top, vmulq_f32(vsubq_f32(Bottom, Top), FracY)));
+
+		if (!IsNormal)
+		{
+			continue;
+		}
+
+		float32x4_t DX00 = vsubq_f32(vld1q_f32(Value + 16), H10);
+		float32x4_t DX10 = vsubq_f32(H00, vld1q_f32(Value + 20));
+		float32x4_t DX01 = vsubq_f32(vld1q_f32(Value + 24), H11);
+		float32x4_t DX11 = vsubq_f32(H01, vld1q_f32(Value + 28));
+		float32x4_t DZ00 = vsubq_f32(vld1q_f32(Value + 32), H01);
+		float32x4_t DZ10 = vsubq_f32(vld1q_f32(Value + 36), H11);
+		float32x4_t DZ01 = vsubq_f32(H00, vld1q_f32(Value + 40));
+		float32x4_t DZ11 = vsubq_f32(H10, vld1q_f32(Value + 44));
+
+		float32x4_t TopX = vaddq_f32(DX00, vmulq_f32(vsubq_f32(DX10, DX00), FracX));
+		float32x4_t BottomX = vaddq_f32(DX01, vmulq_f32(vsubq_f32(DX11, DX01), FracX));
+		float32x4_t NormalX = vaddq_f32(TopX, vmulq_f32(vsubq_f32(BottomX, TopX), FracY));
+		float32x4_t TopZ = vaddq_f32(DZ00, vmulq_f32(vsubq_f32(DZ10, DZ00), FracX));
+		float32x4_t BottomZ = vaddq_f32(DZ01, vmulq_f32(vsubq_f32(DZ11, DZ01), FracX));
+		float32x4_t NormalZ = vaddq_f32(TopZ, vmulq_f32(vsubq_f32(BottomZ, TopZ), FracY));
+
+		// ARMv7には除算と平方根が無いので, 逆数平方根の近似をニュートン法で2回補正する.
+		float32x4_t LengthSq = vaddq_f32(vaddq_f32(vmulq_f32(NormalX, NormalX), vmulq_f32(NormalZ, NormalZ)), One);
+		float32x4_t InvLength = vrsqrteq_f32(LengthSq);
+		InvLength = vmulq_f32(InvLength, vrsqrtsq_f32(vmulq_f32(LengthSq, InvLength), InvLength));
+		InvLength = vmulq_f32(InvLength, vrsqrtsq_f32(vmulq_f32(LengthSq, InvLength), InvLength));
+		vst1q_f32(_output.pNormalX + i, vmulq_f32(NormalX, InvLength));
+		vst1q_f32(_output.pNormalY + i, InvLength);
+		vst1q_f32(_output.pNormalZ + i, vmulq_f32(NormalZ, InvLength));
+	}
+
+	if (i < _count)
+	{
+		OUTPUT Output = _output;
+		Output.pHeight += i;
+		if (IsNormal)
+		{
+			Output.pNormalX += i;
+			Output.pNormalY += i;
+			Output.pNormalZ += i;
+		}
+
+		QueryScalar(_param, _pX + i, _pZ + i, _count - i, Output);
+	}
+}
+
+#else
+
+void WaveQuery::QueryNEON(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output)
+{
+	QueryScalar(_param, _pX, _pZ, _count, _output);
+}
+
+#endif // CPUFEATURE_NEON
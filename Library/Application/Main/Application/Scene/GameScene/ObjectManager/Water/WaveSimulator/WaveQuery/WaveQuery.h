@@ -0,0 +1,144 @@
+﻿/**
+ * @file	WaveQuery.h
+ * @brief	波の高さ取得クラス定義
+ * @author	morimoto
+ */
+#ifndef WAVEQUERY_H
+#define WAVEQUERY_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+/**
+ * 波の高さ取得クラス
+ *
+ * 浮動小数点の高さ配列から, 複数のワールド座標の高さと法線をまとめて取得する.
+ * 高さはテクセルの中心を基準にした双線形補間で, 範囲外の座標は端のセルにクランプする(テクスチャのクランプサンプリングと同じ).
+ * 法線は法線マップ(Wave.fxのPS_BUMPMAP)と同じ(左 - 右, 1, 上 - 下)を4隅のセルで求めて双線形補間し,
+ * WaterReflect.fxと同じく正規化したものになる.
+ *
+ * 座標の変換とインデックスの計算はSIMDでまとめて行い, 周囲のセルはAVX2ではgather命令で,
+ * その他の命令セットではインデックスを書き出してから読み込む.
+ */
+class WaveQuery
+{
+public:
+	/**
+	 * 取得結果の書き込み先の構造体
+	 */
+	struct OUTPUT
+	{
+		float*	pHeight;	//!< 高さの書き込み先.
+		float*	pNormalX;	//!< 法線のx成分の書き込み先(nullptrなら法線を求めない).
+		float*	pNormalY;	//!< 法線のy成分の書き込み先.
+		float*	pNormalZ;	//!< 法線のz成分の書き込み先.
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	WaveQuery();
+
+	/**
+	 * デストラクタ
+	 */
+	~WaveQuery();
+
+	/**
+	 * 高さ配列が覆うワールド座標の範囲を設定(WaveImpulseQueue::SetWorldAreaと同じ)
+	 * @param[in] _minX 高さ配列の左端(u=0)のx座標
+	 * @param[in] _maxZ 高さ配列の上端(v=0)のz座標
+	 * @param[in] _width 高さ配列のx方向の大きさ
+	 * @param[in] _depth 高さ配列のz方向の大きさ
+	 */
+	void SetWorldArea(float _minX, float _maxZ, float _width, float _depth);
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(SIMD_AUTOなら実行環境で最適なもの)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+	}
+
+	/**
+	 * 複数の座標の高さと法線をまとめて取得
+	 * @param[in] _pHeight 高さ配列のセル(0, 0)へのポインタ
+	 * @param[in] _stride 高さ配列の1行分の要素数
+	 * @param[in] _width 高さ配列の幅
+	 * @param[in] _height 高さ配列の高さ
+	 * @param[in] _pX 取得する座標のx(_count個)
+	 * @param[in] _pZ 取得する座標のz(_count個)
+	 * @param[in] _count 取得する座標の数
+	 * @param[out] _output 書き込み先(それぞれ_count個)
+	 */
+	void Query(const float* _pHeight, int _stride, int _width, int _height, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output) const;
+
+private:
+	/**
+	 * 取得関数に渡すパラメータの構造体
+	 */
+	struct PARAM
+	{
+		const float*	pHeight;	//!< 高さ配列のセル(0, 0)へのポインタ.
+		int				Stride;		//!< 高さ配列の1行分の要素数.
+		int				MaxX;		//!< 右端のセル.
+		int				MaxY;		//!< 下端のセル.
+		float			ScaleX;		//!< x座標からセル座標への倍率.
+		float			OffsetX;	//!< x座標からセル座標へのオフセット.
+		float			ScaleZ;		//!< z座標からセル座標への倍率.
+		float			OffsetZ;	//!< z座標からセル座標へのオフセット.
+	};
+
+	/**
+	 * 取得関数
+	 * @param[in] _param パラメータ
+	 * @param[in] _pX 取得する座標のx
+	 * @param[in] _pZ 取得する座標のz
+	 * @param[in] _count 取得する座標の数
+	 * @param[out] _output 書き込み先
+	 */
+	typedef void(*QUERY_FUNC)(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output);
+
+	/**
+	 * 命令セットに対応した取得関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 取得関数
+	 */
+	static QUERY_FUNC GetQueryFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 取得関数(スカラー版)
+	 */
+	static void QueryScalar(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output);
+
+	/**
+	 * 取得関数(SSE2版)
+	 */
+	static void QuerySSE(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output);
+
+	/**
+	 * 取得関数(AVX2版)
+	 */
+	static void QueryAVX2(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output);
+
+	/**
+	 * 取得関数(NEON版)
+	 */
+	static void QueryNEON(const PARAM& _param, const float* _pX, const float* _pZ, int _count, const OUTPUT& _output);
+
+
+	float					m_MinX;			//!< 高さ配列の左端のx座標.
+	float					m_MaxZ;			//!< 高さ配列の上端のz座標.
+	float					m_InvWidth;		//!< 高さ配列のx方向の大きさの逆数.
+	float					m_InvDepth;		//!< 高さ配列のz方向の大きさの逆数.
+	CpuFeature::SIMD_TYPE	m_SimdType;		//!< 使用する命令セット.
+
+};
+
+
+#endif // !WAVEQUERY_H
@@ -0,0 +1,1843 @@
+﻿/**
+ * @file	WaveSimulator.cpp
+ * @brief	波シミュレーションクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaveSimulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Main\ThreadPool\ThreadPool.h"
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const float WaveSimulator::m_DefaultSpringPower = 0.5f;
+const float WaveSimulator::m_DefaultWaveHeight = 0.1f;
+const float WaveSimulator::m_DefaultWaveVelocity = 0.1f;
+const float WaveSimulator::m_Damping = 0.1f;
+const float WaveSimulator::m_VelocityDecay = 1.0f / 32.0f;
+const int WaveSimulator::m_VelocityDecayShift = 5;
+const float WaveSimulator::m_HeightDecay = 1.0f / 256.0f;
+const int WaveSimulator::m_HeightDecayShift = 8;
+const float WaveSimulator::m_WaveRadius = 0.03f;
+const int WaveSimulator::m_DefaultTileWidth = 256;
+const int WaveSimulator::m_DefaultTileHeight = 64;
+const float WaveSimulator::m_DefaultSleepThreshold = 0.5f / 255.0f;
+const int WaveSimulator::m_MaxBlockStepNum = 16;
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+WaveSimulator::WaveSimulator(int _width, int _height) :
+	m_Width(_width),
+	m_Height(_height),
+	m_Stride(((_width + 2) + 7) & ~7),
+	m_SpringPower(m_DefaultSpringPower),
+	m_SimdType(CpuFeature::GetSimdType()),
+	m_Precision(PRECISION_FLOAT32),
+	m_FixedSolver(_width, _height),
+	m_ReadIndex(0),
+	m_pThreadPool(nullptr),
+	m_TileWidth(m_DefaultTileWidth),
+	m_TileHeight(m_DefaultTileHeight),
+	m_TileNumX(0),
+	m_TileNumY(0),
+	m_BlockStepNum(1),
+	m_IsSparse(true),
+	m_SleepThreshold(m_DefaultSleepThreshold),
+	m_ActiveTileNum(0),
+	m_TotalActiveTileRatio(0.0),
+	m_CounterStepNum(0),
+	m_pImpulseQueue(&m_ImpulseQueue),
+	m_pObstacleMask(nullptr),
+	m_IsFixedQuerySync(false)
+{
+}
+
+WaveSimulator::~WaveSimulator()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool WaveSimulator::Initialize()
+{
+	if (m_Width <= 0 || m_Height <= 0)
+	{
+		return false;
+	}
+
+	size_t CellNum = static_cast<size_t>(m_Stride) * (m_Height + 2);
+	for (int i = 0; i < 2; i++)
+	{
+		m_WaveHeight[i].assign(CellNum, 0.0f);
+		m_WaveVelocity[i].assign(CellNum, 0.0f);
+	}
+
+	m_Impulse.clear();
+	m_ZeroRow.assign(m_Width, 0.0f);
+
+	if (!m_FixedSolver.Initialize())
+	{
+		return false;
+	}
+
+	UpdateTileNum();
+	Clear(m_DefaultWaveHeight, m_DefaultWaveVelocity);
+
+	return true;
+}
+
+void WaveSimulator::Finalize()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		std::vector<float>().swap(m_WaveHeight[i]);
+		std::vector<float>().swap(m_WaveVelocity[i]);
+	}
+
+	std::vector<WaveImpulseQueue::IMPULSE>().swap(m_Impulse);
+	std::vector<IMPULSE_RECT>().swap(m_ImpulseRect);
+	std::vector<int>().swap(m_TileImpulseStart);
+	std::vector<int>().swap(m_TileImpulseCursor);
+	std::vector<int>().swap(m_TileImpulseIndex);
+	std::vector<float>().swap(m_ZeroRow);
+	m_ImpulseQueue.Clear();
+
+	std::vector<unsigned char>().swap(m_IsTileActive);
+	std::vector<unsigned char>().swap(m_IsTileWake);
+	std::vector<unsigned char>().swap(m_IsTileStep);
+	std::vector<unsigned char>().swap(m_IsTileSync);
+	std::vector<unsigned char>().swap(m_IsTileObstacle);
+	std::vector<float>().swap(m_TileEnergy);
+	std::vector<int>().swap(m_StepTileList);
+	std::vector<WORK_BUFFER>().swap(m_WorkBuffer);
+
+	m_FixedSolver.Finalize();
+}
+
+void WaveSimulator::Clear(float _height, float _velocity)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		std::fill(m_WaveHeight[i].begin(), m_WaveHeight[i].end(), _height);
+		std::fill(m_WaveVelocity[i].begin(), m_WaveVelocity[i].end(), _velocity);
+	}
+
+	m_ReadIndex = 0;
+	m_IsFixedQuerySync = false;
+	m_pImpulseQueue->Clear();
+	m_FixedSolver.Clear(_height, _velocity);
+
+	// 一様な波マップは変化しないので全てのタイルを休止させる.
+	std::fill(m_IsTileActive.begin(), m_IsTileActive.end(), 0);
+	std::fill(m_IsTileSync.begin(), m_IsTileSync.end(), 0);
+}
+
+bool WaveSimulator::SaveSnapshot(const char* _pFileName, WaveSnapshot::ENCODING _encoding)
+{
+	if (m_Precision == PRECISION_FIXED16 && !m_IsFixedQuerySync)
+	{
+		m_FixedSolver.GetState(&m_WaveHeight[m_ReadIndex][CellIndex(0, 0)], &m_WaveVelocity[m_ReadIndex][CellIndex(0, 0)], m_Stride);
+		m_IsFixedQuerySync = true;
+	}
+
+	return WaveSnapshot::Write(
+		_pFileName,
+		m_Width,
+		m_Height,
+		&m_WaveHeight[m_ReadIndex][CellIndex(0, 0)],
+		&m_WaveVelocity[m_ReadIndex][CellIndex(0, 0)],
+		m_Stride,
+		_encoding);
+}
+
+bool WaveSimulator::LoadSnapshot(const WaveSnapshot& _snapshot)
+{
+	if (_snapshot.GetWidth() != m_Width || _snapshot.GetHeight() != m_Height)
+	{
+		return false;
+	}
+
+	// 途中で失敗しても現在の状態を壊さないように, 書き込み側のバッファに展開してから複製する.
+	int WriteIndex = m_ReadIndex ^ 1;
+	if (!_snapshot.Read(&m_WaveHeight[WriteIndex][CellIndex(0, 0)], &m_WaveVelocity[WriteIndex][CellIndex(0, 0)], m_Stride))
+	{
+		return false;
+	}
+
+	m_WaveHeight[m_ReadIndex] = m_WaveHeight[WriteIndex];
+	m_WaveVelocity[m_ReadIndex] = m_WaveVelocity[WriteIndex];
+	UpdateHalo(0);
+	UpdateHalo(1);
+
+	if (m_Precision == PRECISION_FIXED16)
+	{
+		m_FixedSolver.SetState(&m_WaveHeight[m_ReadIndex][CellIndex(0, 0)], &m_WaveVelocity[m_ReadIndex][CellIndex(0, 0)], m_Stride);
+	}
+
+	m_IsFixedQuerySync = false;
+	WakeAllTiles();
+
+	return true;
+}
+
+void WaveSimulator::Step()
+{
+	if (m_Precision == PRECISION_FIXED16)
+	{
+		StepFixed(nullptr);
+	}
+	else
+	{
+		StepSingle(nullptr);
+	}
+}
+
+void WaveSimulator::Step(int _stepNum)
+{
+	if (m_Precision == PRECISION_FIXED16)
+	{
+		for (int i = 0; i < _stepNum; i++)
+		{
+			StepFixed(nullptr);
+		}
+
+		return;
+	}
+
+	while (_stepNum > 0)
+	{
+		int StepNum = std::min(_stepNum, m_BlockStepNum);
+		if (StepNum == 1)
+		{
+			Step();
+		}
+		else
+		{
+			StepBlock(StepNum);
+		}
+
+		_stepNum -= StepNum;
+	}
+}
+
+void WaveSimulator::StepWithMap(void* _pWaveMap, int _waveRowPitch, void* _pNormalMap, int _normalRowPitch)
+{
+	MAP_OUTPUT MapOutput =
+	{
+		static_cast<unsigned char*>(_pWaveMap),
+		_waveRowPitch,
+		static_cast<unsigned char*>(_pNormalMap),
+		_normalRowPitch
+	};
+
+	if (m_Precision == PRECISION_FIXED16)
+	{
+		StepFixed(&MapOutput);
+	}
+	else
+	{
+		StepSingle(&MapOutput);
+	}
+}
+
+void WaveSimulator::WriteWaveMap(void* _pData, int _rowPitch) const
+{
+	if (m_Precision == PRECISION_FIXED16)
+	{
+		m_FixedSolver.WriteWaveMap(_pData, _rowPitch);
+		return;
+	}
+
+	WAVEMAPROW_FUNC pWaveMapRow = GetWaveMapRowFunc(m_SimdType);
+	auto WriteRows = [this, _pData, _rowPitch, pWaveMapRow](int _band)
+	{
+		int MinY = _band * m_TileHeight;
+		int MaxY = std::min(MinY + m_TileHeight, m_Height);
+
+		for (int y = MinY; y < MaxY; y++)
+		{
+			unsigned char* pPixel = static_cast<unsigned char*>(_pData) + static_cast<size_t>(y) * _rowPitch;
+			pWaveMapRow(GetHeightRow(y), GetVelocityRow(y), pPixel, m_Width);
+		}
+	};
+
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelFor(m_TileNumY, WriteRows);
+	}
+	else
+	{
+		for (int i = 0; i < m_TileNumY; i++)
+		{
+			WriteRows(i);
+		}
+	}
+}
+
+void WaveSimulator::WriteNormalMap(void* _pData, int _rowPitch)
+{
+	if (m_Precision == PRECISION_FIXED16)
+	{
+		m_FixedSolver.WriteNormalMap(_pData, _rowPitch);
+		return;
+	}
+
+	UpdateHalo(m_ReadIndex);
+
+	NORMALMAPROW_FUNC pNormalMapRow = GetNormalMapRowFunc(m_SimdType);
+	auto WriteRows = [this, _pData, _rowPitch, pNormalMapRow](int _band)
+	{
+		int MinY = _band * m_TileHeight;
+		int MaxY = std::min(MinY + m_TileHeight, m_Height);
+
+		for (int y = MinY; y < MaxY; y++)
+		{
+			unsigned char* pPixel = static_cast<unsigned char*>(_pData) + static_cast<size_t>(y) * _rowPitch;
+			pNormalMapRow(GetHeightRow(y - 1), GetHeightRow(y), GetHeightRow(y + 1), pPixel, m_Width);
+		}
+	};
+
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelFor(m_TileNumY, WriteRows);
+	}
+	else
+	{
+		for (int i = 0; i < m_TileNumY; i++)
+		{
+			WriteRows(i);
+		}
+	}
+}
+
+void WaveSimulator::QueryHeight(const float* _pX, const float* _pZ, int _count, float* _pHeight, float* _pNormalX, float* _pNormalY, float* _pNormalZ)
+{
+	if (m_Precision == PRECISION_FIXED16 && !m_IsFixedQuerySync)
+	{
+		// 固定小数点の状態は浮動小数点の配列を使っていないので, 読み込み側に書き戻して取得に使う.
+		m_FixedSolver.GetState(&m_WaveHeight[m_ReadIndex][CellIndex(0, 0)], &m_WaveVelocity[m_ReadIndex][CellIndex(0, 0)], m_Stride);
+		m_IsFixedQuerySync = true;
+	}
+
+	WaveQuery::OUTPUT Output = { _pHeight, _pNormalX, _pNormalY, _pNormalZ };
+	m_Query.Query(&m_WaveHeight[m_ReadIndex][CellIndex(0, 0)], m_Stride, m_Width, m_Height, _pX, _pZ, _count, Output);
+}
+
+void WaveSimulator::SetPrecision(PRECISION _precision)
+{
+	if (_precision == m_Precision)
+	{
+		return;
+	}
+
+	if (_precision == PRECISION_FIXED16)
+	{
+		m_FixedSolver.SetState(&m_WaveHeight[m_ReadIndex][CellIndex(0, 0)], &m_WaveVelocity[m_ReadIndex][CellIndex(0, 0)], m_Stride);
+	}
+	else
+	{
+		// 休止中のタイルは両方のバッファが同じである必要があるので両方に書き戻して起こす.
+		for (int i = 0; i < 2; i++)
+		{
+			m_FixedSolver.GetState(&m_WaveHeight[i][CellIndex(0, 0)], &m_WaveVelocity[i][CellIndex(0, 0)], m_Stride);
+		}
+
+		WakeAllTiles();
+	}
+
+	m_Precision = _precision;
+	m_IsFixedQuerySync = false;
+}
+
+void WaveSimulator::WakeAllTiles()
+{
+	std::fill(m_IsTileActive.begin(), m_IsTileActive.end(), 1);
+}
+
+void WaveSimulator::SetTileSize(int _tileWidth, int _tileHeight)
+{
+	m_TileWidth = (std::max(_tileWidth, 8) + 7) & ~7;
+	m_TileHeight = std::max(_tileHeight, 1);
+
+	UpdateTileNum();
+}
+
+bool WaveSimulator::SetObstacleMask(const WaveObstacleMask* _pObstacleMask)
+{
+	if (_pObstacleMask != nullptr &&
+		(_pObstacleMask->GetWidth() != m_Width || _pObstacleMask->GetHeight() != m_Height))
+	{
+		return false;
+	}
+
+	m_pObstacleMask = _pObstacleMask;
+	m_FixedSolver.SetObstacleMask(_pObstacleMask);
+	UpdateTileObstacle();
+
+	// 障害物の周りは波の伝わり方が変わるので全てのタイルを起こす.
+	WakeAllTiles();
+
+	return true;
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void WaveSimulator::UpdateHalo(int _index)
+{
+	float* pHeight = &m_WaveHeight[_index][0];
+
+	// 左右の外周.
+	for (int y = 0; y < m_Height; y++)
+	{
+		float* pRow = pHeight + CellIndex(0, y);
+		pRow[-1] = pRow[0];
+		pRow[m_Width] = pRow[m_Width - 1];
+	}
+
+	// 上下の外周(角も含めて行ごと複製する).
+	std::copy(
+		pHeight + CellIndex(-1, 0),
+		pHeight + CellIndex(-1, 0) + m_Stride,
+		pHeight + CellIndex(-1, -1));
+	std::copy(
+		pHeight + CellIndex(-1, m_Height - 1),
+		pHeight + CellIndex(-1, m_Height - 1) + m_Stride,
+		pHeight + CellIndex(-1, m_Height));
+}
+
+void WaveSimulator::BinImpulse()
+{
+	m_pImpulseQueue->PopAll(&m_Impulse);
+	if (m_Impulse.empty())
+	{
+		return;
+	}
+
+	int TileNum = GetTileNum();
+	int ImpulseNum = static_cast<int>(m_Impulse.size());
+	m_ImpulseRect.resize(ImpulseNum);
+	m_TileImpulseStart.assign(TileNum + 1, 0);
+
+	// かかるタイルごとに波の数を数える.
+	for (int i = 0; i < ImpulseNum; i++)
+	{
+		const WaveImpulseQueue::IMPULSE& Impulse = m_Impulse[i];
+		IMPULSE_RECT& Rect = m_ImpulseRect[i];
+
+		Rect.MinX = std::max(static_cast<int>((Impulse.U - Impulse.Radius) * m_Width) - 1, 0);
+		Rect.MinY = std::max(static_cast<int>((Impulse.V - Impulse.Radius) * m_Height) - 1, 0);
+		Rect.MaxX = std::min(static_cast<int>((Impulse.U + Impulse.Radius) * m_Width) + 1, m_Width - 1);
+		Rect.MaxY = std::min(static_cast<int>((Impulse.V + Impulse.Radius) * m_Height) + 1, m_Height - 1);
+
+		// 波マップの外の波は無視する.
+		if (Impulse.Radius <= 0.0f || Rect.MinX > Rect.MaxX || Rect.MinY > Rect.MaxY)
+		{
+			Rect.MaxX = -1;
+			continue;
+		}
+
+		for (int TileY = Rect.MinY / m_TileHeight; TileY <= Rect.MaxY / m_TileHeight; TileY++)
+		{
+			for (int TileX = Rect.MinX / m_TileWidth; TileX <= Rect.MaxX / m_TileWidth; TileX++)
+			{
+				int TileIndex = TileY * m_TileNumX + TileX;
+				m_TileImpulseStart[TileIndex + 1]++;
+				m_IsTileWake[TileIndex] = 1;	// 波がかかるタイルを起こす.
+			}
+		}
+	}
+
+	for (int i = 0; i < TileNum; i++)
+	{
+		m_TileImpulseStart[i + 1] += m_TileImpulseStart[i];
+	}
+
+	// 追加した順に振り分けるので, 1セルに複数の波がかかっても加算順は変わらない.
+	m_TileImpulseIndex.resize(m_TileImpulseStart[TileNum]);
+	m_TileImpulseCursor.assign(m_TileImpulseStart.begin(), m_TileImpulseStart.end() - 1);
+
+	for (int i = 0; i < ImpulseNum; i++)
+	{
+		const IMPULSE_RECT& Rect = m_ImpulseRect[i];
+		if (Rect.MaxX < Rect.MinX)
+		{
+			continue;
+		}
+
+		for (int TileY = Rect.MinY / m_TileHeight; TileY <= Rect.MaxY / m_TileHeight; TileY++)
+		{
+			for (int TileX = Rect.MinX / m_TileWidth; TileX <= Rect.MaxX / m_TileWidth; TileX++)
+			{
+				m_TileImpulseIndex[m_TileImpulseCursor[TileY * m_TileNumX + TileX]++] = i;
+			}
+		}
+	}
+}
+
+void WaveSimulator::BuildAddVelocity(int _minX, int _minY, int _maxX, int _maxY, std::vector<float>* _pAddVelocity, int* _pTop, int* _pBottom) const
+{
+	*_pTop = _minY;
+	*_pBottom = _minY;
+
+	if (m_Impulse.empty())
+	{
+		return;
+	}
+
+	int TileMinX = _minX / m_TileWidth;
+	int TileMinY = _minY / m_TileHeight;
+	int TileMaxX = (_maxX - 1) / m_TileWidth;
+	int TileMaxY = (_maxY - 1) / m_TileHeight;
+
+	// 加算値が必要な行の範囲を求める.
+	int Top = _maxY;
+	int Bottom = _minY;
+	for (int TileY = TileMinY; TileY <= TileMaxY; TileY++)
+	{
+		for (int TileX = TileMinX; TileX <= TileMaxX; TileX++)
+		{
+			int TileIndex = TileY * m_TileNumX + TileX;
+			for (int i = m_TileImpulseStart[TileIndex]; i < m_TileImpulseStart[TileIndex + 1]; i++)
+			{
+				const IMPULSE_RECT& Rect = m_ImpulseRect[m_TileImpulseIndex[i]];
+				Top = std::min(Top, std::max(Rect.MinY, _minY));
+				Bottom = std::max(Bottom, std::min(Rect.MaxY + 1, _maxY));
+			}
+		}
+	}
+
+	if (Top >= Bottom)
+	{
+		return;
+	}
+
+	int RowWidth = _maxX - _minX;
+	_pAddVelocity->assign(static_cast<size_t>(RowWidth) * (Bottom - Top), 0.0f);
+
+	for (int TileY = TileMinY; TileY <= TileMaxY; TileY++)
+	{
+		for (int TileX = TileMinX; TileX <= TileMaxX; TileX++)
+		{
+			// タイルと範囲が重なる部分だけに展開する.
+			int ClipMinX = std::max(TileX * m_TileWidth, _minX);
+			int ClipMinY = std::max(TileY * m_TileHeight, _minY);
+			int ClipMaxX = std::min((TileX + 1) * m_TileWidth, _maxX);
+			int ClipMaxY = std::min((TileY + 1) * m_TileHeight, _maxY);
+
+			int TileIndex = TileY * m_TileNumX + TileX;
+			for (int i = m_TileImpulseStart[TileIndex]; i < m_TileImpulseStart[TileIndex + 1]; i++)
+			{
+				const WaveImpulseQueue::IMPULSE& Impulse = m_Impulse[m_TileImpulseIndex[i]];
+				const IMPULSE_RECT& Rect = m_ImpulseRect[m_TileImpulseIndex[i]];
+				float RadiusSq = Impulse.Radius * Impulse.Radius;
+
+				int MinX = std::max(Rect.MinX, ClipMinX);
+				int MaxX = std::min(Rect.MaxX + 1, ClipMaxX);
+				int MaxY = std::min(Rect.MaxY + 1, ClipMaxY);
+
+				// 着水の波は範囲の全てのセルに加える.
+				if (Impulse.IsDrop)
+				{
+					for (int y = std::max(Rect.MinY, ClipMinY); y < MaxY; y++)
+					{
+						float* pRow = &(*_pAddVelocity)[static_cast<size_t>(y - Top) * RowWidth];
+						for (int x = MinX; x < MaxX; x++)
+						{
+							pRow[x - _minX] += static_cast<float>(WaveImpulseQueue::GetDropVelocity(Impulse, x, y, m_Width, m_Height));
+						}
+					}
+
+					continue;
+				}
+
+				for (int y = std::max(Rect.MinY, ClipMinY); y < MaxY; y++)
+				{
+					// Wave.fxと同じくテクセル中心のテクスチャ座標で距離を判定する.
+					float DistV = (static_cast<float>(y) + 0.5f) / static_cast<float>(m_Height) - Impulse.V;
+					if (DistV * DistV >= RadiusSq)
+					{
+						continue;
+					}
+
+					float* pRow = &(*_pAddVelocity)[static_cast<size_t>(y - Top) * RowWidth];
+					for (int x = MinX; x < MaxX; x++)
+					{
+						float DistU = (static_cast<float>(x) + 0.5f) / static_cast<float>(m_Width) - Impulse.U;
+						if (DistU * DistU + DistV * DistV < RadiusSq)
+						{
+							pRow[x - _minX] += Impulse.Strength;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	*_pTop = Top;
+	*_pBottom = Bottom;
+}
+
+void WaveSimulator::UpdateTileNum()
+{
+	m_TileNumX = (m_Width + m_TileWidth - 1) / m_TileWidth;
+	m_TileNumY = (m_Height + m_TileHeight - 1) / m_TileHeight;
+
+	// タイルの区切りが変わるので全てのタイルを活動状態からやり直す.
+	int TileNum = GetTileNum();
+	m_IsTileActive.assign(TileNum, 1);
+	m_IsTileWake.assign(TileNum, 0);
+	m_IsTileStep.assign(TileNum, 0);
+	m_IsTileSync.assign(TileNum, 0);
+	m_TileEnergy.assign(TileNum, 0.0f);
+	m_StepTileList.reserve(TileNum);
+
+	UpdateTileObstacle();
+}
+
+void WaveSimulator::UpdateTileObstacle()
+{
+	m_IsTileObstacle.assign(GetTileNum(), 0);
+	if (m_pObstacleMask == nullptr)
+	{
+		return;
+	}
+
+	// 時間ブロッキングではタイルの周囲も更新するので, 参照する隣接セルを含めた範囲を調べる.
+	int Margin = m_MaxBlockStepNum + 1;
+	for (int TileY = 0; TileY < m_TileNumY; TileY++)
+	{
+		for (int TileX = 0; TileX < m_TileNumX; TileX++)
+		{
+			int MinX = TileX * m_TileWidth;
+			int MinY = TileY * m_TileHeight;
+			bool IsObstacle = m_pObstacleMask->IsAnySolid(
+				MinX - Margin,
+				MinY - Margin,
+				MinX + m_TileWidth + Margin,
+				MinY + m_TileHeight + Margin);
+
+			m_IsTileObstacle[TileY * m_TileNumX + TileX] = IsObstacle ? 1 : 0;
+		}
+	}
+}
+
+void WaveSimulator::BuildStepTileList(bool _isDiagonal)
+{
+	m_StepTileList.clear();
+	m_ActiveTileNum = 0;
+
+	for (int TileY = 0; TileY < m_TileNumY; TileY++)
+	{
+		for (int TileX = 0; TileX < m_TileNumX; TileX++)
+		{
+			int Index = TileY * m_TileNumX + TileX;
+
+			// ハローを通して影響を受けるのは上下左右のタイルだけ.
+			bool IsStep =
+				!m_IsSparse ||
+				m_IsTileWake[Index] ||
+				m_IsTileActive[Index] ||
+				(TileX > 0 && m_IsTileActive[Index - 1]) ||
+				(TileX < m_TileNumX - 1 && m_IsTileActive[Index + 1]) ||
+				(TileY > 0 && m_IsTileActive[Index - m_TileNumX]) ||
+				(TileY < m_TileNumY - 1 && m_IsTileActive[Index + m_TileNumX]) ||
+				(_isDiagonal && TileY > 0 && TileX > 0 && m_IsTileActive[Index - m_TileNumX - 1]) ||
+				(_isDiagonal && TileY > 0 && TileX < m_TileNumX - 1 && m_IsTileActive[Index - m_TileNumX + 1]) ||
+				(_isDiagonal && TileY < m_TileNumY - 1 && TileX > 0 && m_IsTileActive[Index + m_TileNumX - 1]) ||
+				(_isDiagonal && TileY < m_TileNumY - 1 && TileX < m_TileNumX - 1 && m_IsTileActive[Index + m_TileNumX + 1]);
+
+			m_IsTileStep[Index] = IsStep ? 1 : 0;
+
+			if (IsStep)
+			{
+				m_ActiveTileNum++;
+				m_StepTileList.push_back(Index);
+			}
+			else if (m_IsTileSync[Index])
+			{
+				m_StepTileList.push_back(Index);
+			}
+		}
+	}
+
+	m_TotalActiveTileRatio += GetActiveTileRatio();
+	m_CounterStepNum++;
+}
+
+void WaveSimulator::StepSingle(const MAP_OUTPUT* _pMapOutput)
+{
+	UpdateHalo(m_ReadIndex);
+	BinImpulse();
+	BuildStepTileList(false);
+	ReserveWorkBuffer();
+
+	STEPROW_FUNC pStepRow = GetStepRowFunc(m_SimdType);
+	STEPROW_MASK_FUNC pStepRowMask = GetStepRowMaskFunc(m_SimdType);
+	auto StepFunc = [this, pStepRow, pStepRowMask, _pMapOutput](int _listIndex, int _threadIndex)
+	{
+		int TileIndex = m_StepTileList[_listIndex];
+		if (m_IsTileStep[TileIndex])
+		{
+			m_TileEnergy[TileIndex] = StepTile(TileIndex, pStepRow, pStepRowMask, &m_WorkBuffer[_threadIndex], _pMapOutput);
+		}
+		else
+		{
+			CopyTile(TileIndex, _pMapOutput);
+		}
+	};
+
+	// タイルは前ステップのバッファを読んで別のバッファに書き込むので順不同で更新できる.
+	int ListNum = static_cast<int>(m_StepTileList.size());
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelForThread(ListNum, StepFunc);
+	}
+	else
+	{
+		for (int i = 0; i < ListNum; i++)
+		{
+			StepFunc(i, 0);
+		}
+	}
+
+	UpdateTileState();
+
+	m_ReadIndex ^= 1;
+	m_Impulse.clear();
+}
+
+void WaveSimulator::StepFixed(const MAP_OUTPUT* _pMapOutput)
+{
+	m_pImpulseQueue->PopAll(&m_Impulse);
+
+	if (_pMapOutput != nullptr)
+	{
+		m_FixedSolver.Step(m_Impulse, _pMapOutput->pWaveMap, _pMapOutput->WaveRowPitch, _pMapOutput->pNormalMap, _pMapOutput->NormalRowPitch);
+	}
+	else
+	{
+		m_FixedSolver.Step(m_Impulse, nullptr, 0, nullptr, 0);
+	}
+
+	// 固定小数点では全てのタイルを更新する.
+	m_IsFixedQuerySync = false;
+	m_ActiveTileNum = GetTileNum();
+	m_TotalActiveTileRatio += 1.0;
+	m_CounterStepNum++;
+
+	m_Impulse.clear();
+}
+
+void WaveSimulator::StepBlock(int _stepNum)
+{
+	// 影響が届く範囲を隣のタイルまでにする.
+	_stepNum = std::min(_stepNum, std::min(m_TileWidth, m_TileHeight));
+
+	UpdateHalo(m_ReadIndex);
+	BinImpulse();
+	BuildStepTileList(true);
+	ReserveWorkBuffer();
+
+	STEPROW_FUNC pStepRow = GetStepRowFunc(m_SimdType);
+	STEPROW_MASK_FUNC pStepRowMask = GetStepRowMaskFunc(m_SimdType);
+	auto StepFunc = [this, _stepNum, pStepRow, pStepRowMask](int _listIndex, int _threadIndex)
+	{
+		int TileIndex = m_StepTileList[_listIndex];
+		if (m_IsTileStep[TileIndex])
+		{
+			m_TileEnergy[TileIndex] = StepTileBlock(TileIndex, _stepNum, pStepRow, pStepRowMask, &m_WorkBuffer[_threadIndex]);
+		}
+		else
+		{
+			CopyTile(TileIndex, nullptr);
+		}
+	};
+
+	int ListNum = static_cast<int>(m_StepTileList.size());
+	if (m_pThreadPool != nullptr)
+	{
+		m_pThreadPool->ParallelForThread(ListNum, StepFunc);
+	}
+	else
+	{
+		for (int i = 0; i < ListNum; i++)
+		{
+			StepFunc(i, 0);
+		}
+	}
+
+	UpdateTileState();
+
+	m_ReadIndex ^= 1;
+	m_Impulse.clear();
+}
+
+void WaveSimulator::UpdateTileState()
+{
+	int TileNum = GetTileNum();
+	for (int i = 0; i < TileNum; i++)
+	{
+		if (m_IsTileStep[i])
+		{
+			// 休止するタイルは次のステップで両方のバッファをそろえる.
+			bool IsActive = m_TileEnergy[i] > m_SleepThreshold;
+			m_IsTileActive[i] = IsActive ? 1 : 0;
+			m_IsTileSync[i] = IsActive ? 0 : 1;
+		}
+		else
+		{
+			m_IsTileSync[i] = 0;
+		}
+
+		m_IsTileWake[i] = 0;
+	}
+}
+
+void WaveSimulator::ReserveWorkBuffer()
+{
+	int ThreadNum = m_pThreadPool != nullptr ? m_pThreadPool->GetThreadNum() : 1;
+	if (static_cast<int>(m_WorkBuffer.size()) < ThreadNum)
+	{
+		m_WorkBuffer.resize(ThreadNum);
+	}
+}
+
+float WaveSimulator::StepTile(int _tileIndex, STEPROW_FUNC _pStepRow, STEPROW_MASK_FUNC _pStepRowMask, WORK_BUFFER* _pBuffer, const MAP_OUTPUT* _pMapOutput)
+{
+	int MinX = (_tileIndex % m_TileNumX) * m_TileWidth;
+	int MinY = (_tileIndex / m_TileNumX) * m_TileHeight;
+	int Count = std::min(m_TileWidth, m_Width - MinX);
+	int MaxY = std::min(MinY + m_TileHeight, m_Height);
+
+	int AddTop, AddBottom;
+	BuildAddVelocity(MinX, MinY, MinX + Count, MaxY, &_pBuffer->AddVelocity, &AddTop, &AddBottom);
+
+	int WriteIndex = m_ReadIndex ^ 1;
+	const float* pHeight = &m_WaveHeight[m_ReadIndex][0];
+	const float* pVelocity = &m_WaveVelocity[m_ReadIndex][0];
+	float* pOutHeight = &m_WaveHeight[WriteIndex][0];
+	float* pOutVelocity = &m_WaveVelocity[WriteIndex][0];
+
+	// 障害物がないタイルはマスクを読み込まない更新関数を使う.
+	bool IsObstacle = m_IsTileObstacle[_tileIndex] != 0;
+
+	float Energy = 0.0f;
+	for (int y = MinY; y < MaxY; y++)
+	{
+		int Index = CellIndex(MinX, y);
+		const float* pAddVelocity = (y >= AddTop && y < AddBottom) ? &_pBuffer->AddVelocity[static_cast<size_t>(y - AddTop) * Count] : &m_ZeroRow[0];
+		float RowEnergy = 0.0f;
+		if (IsObstacle)
+		{
+			RowEnergy = _pStepRowMask(
+				pHeight + Index - m_Stride,
+				pHeight + Index,
+				pHeight + Index + m_Stride,
+				pVelocity + Index,
+				pAddVelocity,
+				pOutHeight + Index,
+				pOutVelocity + Index,
+				Count,
+				m_SpringPower,
+				m_pObstacleMask->GetRowMask(MinX, y));
+		}
+		else
+		{
+			RowEnergy = _pStepRow(
+				pHeight + Index - m_Stride,
+				pHeight + Index,
+				pHeight + Index + m_Stride,
+				pVelocity + Index,
+				pAddVelocity,
+				pOutHeight + Index,
+				pOutVelocity + Index,
+				Count,
+				m_SpringPower);
+		}
+
+		Energy = std::max(Energy, RowEnergy);
+
+		// 更新した行がキャッシュに残っているうちに書き出す.
+		if (_pMapOutput != nullptr)
+		{
+			WriteMapRow(MinX, y, Count, pHeight + Index, pOutHeight + Index, pOutVelocity + Index, _pMapOutput);
+		}
+	}
+
+	return Energy;
+}
+
+float WaveSimulator::StepTileBlock(int _tileIndex, int _stepNum, STEPROW_FUNC _pStepRow, STEPROW_MASK_FUNC _pStepRowMask, WORK_BUFFER* _pBuffer)
+{
+	int MinX = (_tileIndex % m_TileNumX) * m_TileWidth;
+	int MinY = (_tileIndex / m_TileNumX) * m_TileHeight;
+	int MaxX = std::min(MinX + m_TileWidth, m_Width);
+	int MaxY = std::min(MinY + m_TileHeight, m_Height);
+
+	// 周囲_stepNumセルを読み込む. 波マップの端に届く方向は外周セルまで読み込み, 毎ステップ端の値を複製する.
+	bool IsLeftEdge = MinX - _stepNum < 0;
+	bool IsRightEdge = MaxX + _stepNum > m_Width;
+	bool IsTopEdge = MinY - _stepNum < 0;
+	bool IsBottomEdge = MaxY + _stepNum > m_Height;
+	int BeginX = IsLeftEdge ? -1 : MinX - _stepNum;
+	int EndX = IsRightEdge ? m_Width + 1 : MaxX + _stepNum;
+	int BeginY = IsTopEdge ? -1 : MinY - _stepNum;
+	int EndY = IsBottomEdge ? m_Height + 1 : MaxY + _stepNum;
+
+	int Stride = ((EndX - BeginX) + 7) & ~7;
+	size_t CellNum = static_cast<size_t>(Stride) * (EndY - BeginY);
+	for (int i = 0; i < 2; i++)
+	{
+		if (_pBuffer->Height[i].size() < CellNum)
+		{
+			_pBuffer->Height[i].resize(CellNum);
+			_pBuffer->Velocity[i].resize(CellNum);
+		}
+	}
+
+	// 作業領域内のインデックス.
+	auto BlockIndex = [BeginX, BeginY, Stride](int _x, int _y)
+	{
+		return (_y - BeginY) * Stride + (_x - BeginX);
+	};
+
+	for (int y = BeginY; y < EndY; y++)
+	{
+		int Index = CellIndex(BeginX, y);
+		std::copy(&m_WaveHeight[m_ReadIndex][Index], &m_WaveHeight[m_ReadIndex][Index] + (EndX - BeginX), &_pBuffer->Height[0][BlockIndex(BeginX, y)]);
+		std::copy(&m_WaveVelocity[m_ReadIndex][Index], &m_WaveVelocity[m_ReadIndex][Index] + (EndX - BeginX), &_pBuffer->Velocity[0][BlockIndex(BeginX, y)]);
+	}
+
+	int ReadIndex = 0;
+	float Energy = 0.0f;
+	int AddTop = 0;
+	int AddBottom = 0;
+	bool IsObstacle = m_IsTileObstacle[_tileIndex] != 0;
+
+	for (int StepIndex = 1; StepIndex <= _stepNum; StepIndex++)
+	{
+		// 有効な範囲はステップごとに1セルずつ狭くなる. 最後のステップはタイルの部分だけでよい.
+		bool IsLast = StepIndex == _stepNum;
+		int Left = IsLast ? MinX : (IsLeftEdge ? 0 : BeginX + StepIndex);
+		int Right = IsLast ? MaxX : (IsRightEdge ? m_Width : EndX - StepIndex);
+		int Top = IsLast ? MinY : (IsTopEdge ? 0 : BeginY + StepIndex);
+		int Bottom = IsLast ? MaxY : (IsBottomEdge ? m_Height : EndY - StepIndex);
+
+		const float* pHeight = &_pBuffer->Height[ReadIndex][0];
+		const float* pVelocity = &_pBuffer->Velocity[ReadIndex][0];
+		float* pOutHeight = &_pBuffer->Height[ReadIndex ^ 1][0];
+		float* pOutVelocity = &_pBuffer->Velocity[ReadIndex ^ 1][0];
+
+		// 追加した波は最初のステップで有効な範囲全体に反映する.
+		if (StepIndex == 1)
+		{
+			BuildAddVelocity(Left, Top, Right, Bottom, &_pBuffer->AddVelocity, &AddTop, &AddBottom);
+		}
+		else
+		{
+			AddBottom = AddTop;
+		}
+
+		for (int y = Top; y < Bottom; y++)
+		{
+			int Index = BlockIndex(Left, y);
+			const float* pAddVelocity = (y >= AddTop && y < AddBottom) ? &_pBuffer->AddVelocity[static_cast<size_t>(y - AddTop) * (Right - Left)] : &m_ZeroRow[0];
+			float RowEnergy = 0.0f;
+			if (IsObstacle)
+			{
+				// マスクは波マップ全体の座標で参照する.
+				RowEnergy = _pStepRowMask(
+					pHeight + Index - Stride,
+					pHeight + Index,
+					pHeight + Index + Stride,
+					pVelocity + Index,
+					pAddVelocity,
+					pOutHeight + Index,
+					pOutVelocity + Index,
+					Right - Left,
+					m_SpringPower,
+					m_pObstacleMask->GetRowMask(Left, y));
+			}
+			else
+			{
+				RowEnergy = _pStepRow(
+					pHeight + Index - Stride,
+					pHeight + Index,
+					pHeight + Index + Stride,
+					pVelocity + Index,
+					pAddVelocity,
+					pOutHeight + Index,
+					pOutVelocity + Index,
+					Right - Left,
+					m_SpringPower);
+			}
+
+			if (IsLast)
+			{
+				Energy = std::max(Energy, RowEnergy);
+			}
+		}
+
+		// UpdateHaloと同じく波マップの端の値を外周に複製する.
+		if (!IsLast)
+		{
+			for (int y = Top; y < Bottom; y++)
+			{
+				if (IsLeftEdge)		pOutHeight[BlockIndex(-1, y)] = pOutHeight[BlockIndex(0, y)];
+				if (IsRightEdge)	pOutHeight[BlockIndex(m_Width, y)] = pOutHeight[BlockIndex(m_Width - 1, y)];
+			}
+
+			if (IsTopEdge)
+			{
+				std::copy(pOutHeight + BlockIndex(BeginX, 0), pOutHeight + BlockIndex(BeginX, 0) + Stride, pOutHeight + BlockIndex(BeginX, -1));
+			}
+
+			if (IsBottomEdge)
+			{
+				std::copy(pOutHeight + BlockIndex(BeginX, m_Height - 1), pOutHeight + BlockIndex(BeginX, m_Height - 1) + Stride, pOutHeight + BlockIndex(BeginX, m_Height));
+			}
+		}
+
+		ReadIndex ^= 1;
+	}
+
+	// タイルの部分だけを書き戻す.
+	int WriteIndex = m_ReadIndex ^ 1;
+	for (int y = MinY; y < MaxY; y++)
+	{
+		int Index = BlockIndex(MinX, y);
+		std::copy(&_pBuffer->Height[ReadIndex][Index], &_pBuffer->Height[ReadIndex][Index] + (MaxX - MinX), &m_WaveHeight[WriteIndex][CellIndex(MinX, y)]);
+		std::copy(&_pBuffer->Velocity[ReadIndex][Index], &_pBuffer->Velocity[ReadIndex][Index] + (MaxX - MinX), &m_WaveVelocity[WriteIndex][CellIndex(MinX, y)]);
+	}
+
+	return Energy;
+}
+
+void WaveSimulator::CopyTile(int _tileIndex, const MAP_OUTPUT* _pMapOutput)
+{
+	int MinX = (_tileIndex % m_TileNumX) * m_TileWidth;
+	int MinY = (_tileIndex / m_TileNumX) * m_TileHeight;
+	int Count = std::min(m_TileWidth, m_Width - MinX);
+	int MaxY = std::min(MinY + m_TileHeight, m_Height);
+
+	int WriteIndex = m_ReadIndex ^ 1;
+	for (int y = MinY; y < MaxY; y++)
+	{
+		int Index = CellIndex(MinX, y);
+		std::copy(&m_WaveHeight[m_ReadIndex][Index], &m_WaveHeight[m_ReadIndex][Index] + Count, &m_WaveHeight[WriteIndex][Index]);
+		std::copy(&m_WaveVelocity[m_ReadIndex][Index], &m_WaveVelocity[m_ReadIndex][Index] + Count, &m_WaveVelocity[WriteIndex][Index]);
+
+		if (_pMapOutput != nullptr)
+		{
+			WriteMapRow(MinX, y, Count, &m_WaveHeight[m_ReadIndex][Index], &m_WaveHeight[m_ReadIndex][Index], &m_WaveVelocity[m_ReadIndex][Index], _pMapOutput);
+		}
+	}
+}
+
+void WaveSimulator::WriteMapRow(int _x, int _y, int _count, const float* _pHeight, const float* _pNewHeight, const float* _pNewVelocity, const MAP_OUTPUT* _pMapOutput) const
+{
+	unsigned char* pWaveMap = _pMapOutput->pWaveMap + static_cast<size_t>(_y) * _pMapOutput->WaveRowPitch + _x * 4;
+	unsigned char* pNormalMap = _pMapOutput->pNormalMap + static_cast<size_t>(_y) * _pMapOutput->NormalRowPitch + _x * 4;
+
+	GetWaveMapRowFunc(m_SimdType)(_pNewHeight, _pNewVelocity, pWaveMap, _count);
+	GetNormalMapRowFunc(m_SimdType)(_pHeight - m_Stride, _pHeight, _pHeight + m_Stride, pNormalMap, _count);
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+WaveSimulator::STEPROW_FUNC WaveSimulator::GetStepRowFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &StepRowAVX2;
+	case CpuFeature::SIMD_SSE:	return &StepRowSSE;
+	case CpuFeature::SIMD_NEON:	return &StepRowNEON;
+	default:					return &StepRowScalar;
+	}
+}
+
+WaveSimulator::STEPROW_MASK_FUNC WaveSimulator::GetStepRowMaskFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &StepRowMaskAVX2;
+	case CpuFeature::SIMD_SSE:	return &StepRowMaskSSE;
+	case CpuFeature::SIMD_NEON:	return &StepRowMaskNEON;
+	default:					return &StepRowMaskScalar;
+	}
+}
+
+WaveSimulator::WAVEMAPROW_FUNC WaveSimulator::GetWaveMapRowFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &WaveMapRowAVX2;
+	case CpuFeature::SIMD_SSE:	return &WaveMapRowSSE;
+	case CpuFeature::SIMD_NEON:	return &WaveMapRowNEON;
+	default:					return &WaveMapRowScalar;
+	}
+}
+
+WaveSimulator::NORMALMAPROW_FUNC WaveSimulator::GetNormalMapRowFunc(CpuFeature::SIMD_TYPE _simdType)
+{
+	switch (CpuFeature::Resolve(_simdType))
+	{
+	case CpuFeature::SIMD_AVX2:	return &NormalMapRowAVX2;
+	case CpuFeature::SIMD_SSE:	return &NormalMapRowSSE;
+	case CpuFeature::SIMD_NEON:	return &NormalMapRowNEON;
+	default:					return &NormalMapRowScalar;
+	}
+}
+
+float WaveSimulator::StepRowScalar(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower)
+{
+	float Energy = 0.0f;
+
+	for (int i = 0; i < _count; i++)
+	{
+		// 加算順序はWave.fxと同じ(右, 下, 左, 上).
+		float Sum = ((_pCenter[i + 1] + _pDown[i]) + _pCenter[i - 1]) + _pUp[i];
+		float Velocity = _pVelocity[i] + (Sum * 0.25f - _pCenter[i]) * _springPower;
+
+		// 静止時の速度と高さからのずれを減衰させ, 波が収まれば変化量がしきい値を下回るようにする.
+		Velocity -= (Velocity - m_Damping) * m_VelocityDecay;
+		float Height = _pCenter[i] + Velocity - m_Damping;
+		Height -= (Height - m_DefaultWaveHeight) * m_HeightDecay;
+		Velocity += _pAddVelocity[i];
+
+		// R8G8B8A8_UNORMへの書き込みと同じく0～1に丸める.
+		Height = std::min(std::max(Height, 0.0f), 1.0f);
+		Velocity = std::min(std::max(Velocity, 0.0f), 1.0f);
+		_pOutHeight[i] = Height;
+		_pOutVelocity[i] = Velocity;
+
+		Energy = std::max(Energy, std::fabs(Height - _pCenter[i]));
+		Energy = std::max(Energy, std::fabs(Velocity - _pVelocity[i]));
+	}
+
+	return Energy;
+}
+
+float WaveSimulator::StepRowMaskScalar(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	float Energy = 0.0f;
+
+	for (int i = 0; i < _count; i++)
+	{
+		// 障害物の隣接セルは中心セルの値に置き換えて反射させる.
+		int Bit = _mask.Bit + i;
+		float Center = _pCenter[i];
+		float Right = WaveObstacleMask::TestBit(_mask.pCenter, Bit + 1) ? Center : _pCenter[i + 1];
+		float Down = WaveObstacleMask::TestBit(_mask.pDown, Bit) ? Center : _pDown[i];
+		float Left = WaveObstacleMask::TestBit(_mask.pCenter, Bit - 1) ? Center : _pCenter[i - 1];
+		float Up = WaveObstacleMask::TestBit(_mask.pUp, Bit) ? Center : _pUp[i];
+
+		float Sum = ((Right + Down) + Left) + Up;
+		float Velocity = _pVelocity[i] + (Sum * 0.25f - Center) * _springPower;
+		Velocity -= (Velocity - m_Damping) * m_VelocityDecay;
+		float Height = Center + Velocity - m_Damping;
+		Height -= (Height - m_DefaultWaveHeight) * m_HeightDecay;
+		Velocity += _pAddVelocity[i];
+
+		Height = std::min(std::max(Height, 0.0f), 1.0f);
+		Velocity = std::min(std::max(Velocity, 0.0f), 1.0f);
+
+		// 障害物のセル自身は値を保持する.
+		bool IsSolid = WaveObstacleMask::TestBit(_mask.pCenter, Bit);
+		Height = IsSolid ? Center : Height;
+		Velocity = IsSolid ? _pVelocity[i] : Velocity;
+		_pOutHeight[i] = Height;
+		_pOutVelocity[i] = Velocity;
+
+		Energy = std::max(Energy, std::fabs(Height - Center));
+		Energy = std::max(Energy, std::fabs(Velocity - _pVelocity[i]));
+	}
+
+	return Energy;
+}
+
+void WaveSimulator::WaveMapRowScalar(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count)
+{
+	// 値はStepで0～1に丸められている.
+	for (int i = 0; i < _count; i++)
+	{
+		_pOut[0] = static_cast<unsigned char>(_pHeight[i] * 255.0f + 0.5f);
+		_pOut[1] = static_cast<unsigned char>(_pVelocity[i] * 255.0f + 0.5f);
+		_pOut[2] = 0;
+		_pOut[3] = 255;
+		_pOut += 4;
+	}
+}
+
+void WaveSimulator::NormalMapRowScalar(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count)
+{
+	for (int i = 0; i < _count; i++)
+	{
+		// Wave.fxのPS_BUMPMAPと同じく(左 - 右, 1, 上 - 下, 高さ)を0～1に変換する.
+		float TangentU = (_pCenter[i - 1] - _pCenter[i + 1]) * 0.5f + 0.5f;
+		float TangentV = (_pUp[i] - _pDown[i]) * 0.5f + 0.5f;
+		float Height = _pCenter[i] * 0.5f + 0.5f;
+
+		_pOut[0] = static_cast<unsigned char>(TangentU * 255.0f + 0.5f);
+		_pOut[1] = 255;
+		_pOut[2] = static_cast<unsigned char>(TangentV * 255.0f + 0.5f);
+		_pOut[3] = static_cast<unsigned char>(Height * 255.0f + 0.5f);
+		_pOut += 4;
+	}
+}
+
+#ifdef CPUFEATURE_X86
+
+CPUFEATURE_TARGET_SSE
+float WaveSimulator::StepRowSSE(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower)
+{
+	const __m128 Quarter = _mm_set1_ps(0.25f);
+	const __m128 Spring = _mm_set1_ps(_springPower);
+	const __m128 Damping = _mm_set1_ps(m_Damping);
+	const __m128 VelocityDecay = _mm_set1_ps(m_VelocityDecay);
+	const __m128 RestHeight = _mm_set1_ps(m_DefaultWaveHeight);
+	const __m128 HeightDecay = _mm_set1_ps(m_HeightDecay);
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128 SignMask = _mm_set1_ps(-0.0f);
+	__m128 Energy = _mm_setzero_ps();
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		__m128 Center = _mm_loadu_ps(_pCenter + i);
+		__m128 OldVelocity = _mm_loadu_ps(_pVelocity + i);
+		__m128 Sum = _mm_add_ps(_mm_loadu_ps(_pCenter + i + 1), _mm_loadu_ps(_pDown + i));
+		Sum = _mm_add_ps(Sum, _mm_loadu_ps(_pCenter + i - 1));
+		Sum = _mm_add_ps(Sum, _mm_loadu_ps(_pUp + i));
+
+		__m128 Velocity = _mm_sub_ps(_mm_mul_ps(Sum, Quarter), Center);
+		Velocity = _mm_add_ps(OldVelocity, _mm_mul_ps(Velocity, Spring));
+		Velocity = _mm_sub_ps(Velocity, _mm_mul_ps(_mm_sub_ps(Velocity, Damping), VelocityDecay));
+		__m128 Height = _mm_sub_ps(_mm_add_ps(Center, Velocity), Damping);
+		Height = _mm_sub_ps(Height, _mm_mul_ps(_mm_sub_ps(Height, RestHeight), HeightDecay));
+		Velocity = _mm_add_ps(Velocity, _mm_loadu_ps(_pAddVelocity + i));
+
+		Height = _mm_min_ps(_mm_max_ps(Height, Zero), One);
+		Velocity = _mm_min_ps(_mm_max_ps(Velocity, Zero), One);
+		_mm_storeu_ps(_pOutHeight + i, Height);
+		_mm_storeu_ps(_pOutVelocity + i, Velocity);
+
+		// 符号ビットを落として変化量の絶対値を取る.
+		Energy = _mm_max_ps(Energy, _mm_andnot_ps(SignMask, _mm_sub_ps(Height, Center)));
+		Energy = _mm_max_ps(Energy, _mm_andnot_ps(SignMask, _mm_sub_ps(Velocity, OldVelocity)));
+	}
+
+	Energy = _mm_max_ps(Energy, _mm_movehl_ps(Energy, Energy));
+	Energy = _mm_max_ss(Energy, _mm_shuffle_ps(Energy, Energy, 1));
+	float Result = _mm_cvtss_f32(Energy);
+
+	if (i < _count)
+	{
+		Result = std::max(Result, StepRowScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _springPower));
+	}
+
+	return Result;
+}
+
+CPUFEATURE_TARGET_AVX2
+float WaveSimulator::StepRowAVX2(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower)
+{
+	const __m256 Quarter = _mm256_set1_ps(0.25f);
+	const __m256 Spring = _mm256_set1_ps(_springPower);
+	const __m256 Damping = _mm256_set1_ps(m_Damping);
+	const __m256 VelocityDecay = _mm256_set1_ps(m_VelocityDecay);
+	const __m256 RestHeight = _mm256_set1_ps(m_DefaultWaveHeight);
+	const __m256 HeightDecay = _mm256_set1_ps(m_HeightDecay);
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 One = _mm256_set1_ps(1.0f);
+	const __m256 SignMask = _mm256_set1_ps(-0.0f);
+	__m256 Energy = _mm256_setzero_ps();
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256 Center = _mm256_loadu_ps(_pCenter + i);
+		__m256 OldVelocity = _mm256_loadu_ps(_pVelocity + i);
+		__m256 Sum = _mm256_add_ps(_mm256_loadu_ps(_pCenter + i + 1), _mm256_loadu_ps(_pDown + i));
+		Sum = _mm256_add_ps(Sum, _mm256_loadu_ps(_pCenter + i - 1));
+		Sum = _mm256_add_ps(Sum, _mm256_loadu_ps(_pUp + i));
+
+		__m256 Velocity = _mm256_sub_ps(_mm256_mul_ps(Sum, Quarter), Center);
+		Velocity = _mm256_add_ps(OldVelocity, _mm256_mul_ps(Velocity, Spring));
+		Velocity = _mm256_sub_ps(Velocity, _mm256_mul_ps(_mm256_sub_ps(Velocity, Damping), VelocityDecay));
+		__m256 Height = _mm256_sub_ps(_mm256_add_ps(Center, Velocity), Damping);
+		Height = _mm256_sub_ps(Height, _mm256_mul_ps(_mm256_sub_ps(Height, RestHeight), HeightDecay));
+		Velocity = _mm256_add_ps(Velocity, _mm256_loadu_ps(_pAddVelocity + i));
+
+		Height = _mm256_min_ps(_mm256_max_ps(Height, Zero), One);
+		Velocity = _mm256_min_ps(_mm256_max_ps(Velocity, Zero), One);
+		_mm256_storeu_ps(_pOutHeight + i, Height);
+		_mm256_storeu_ps(_pOutVelocity + i, Velocity);
+
+		Energy = _mm256_max_ps(Energy, _mm256_andnot_ps(SignMask, _mm256_sub_ps(Height, Center)));
+		Energy = _mm256_max_ps(Energy, _mm256_andnot_ps(SignMask, _mm256_sub_ps(Velocity, OldVelocity)));
+	}
+
+	__m128 Energy4 = _mm_max_ps(_mm256_castps256_ps128(Energy), _mm256_extractf128_ps(Energy, 1));
+	Energy4 = _mm_max_ps(Energy4, _mm_movehl_ps(Energy4, Energy4));
+	Energy4 = _mm_max_ss(Energy4, _mm_shuffle_ps(Energy4, Energy4, 1));
+	float Result = _mm_cvtss_f32(Energy4);
+
+	if (i < _count)
+	{
+		Result = std::max(Result, StepRowSSE(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _springPower));
+	}
+
+	return Result;
+}
+
+CPUFEATURE_TARGET_SSE
+float WaveSimulator::StepRowMaskSSE(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	const __m128 Quarter = _mm_set1_ps(0.25f);
+	const __m128 Spring = _mm_set1_ps(_springPower);
+	const __m128 Damping = _mm_set1_ps(m_Damping);
+	const __m128 VelocityDecay = _mm_set1_ps(m_VelocityDecay);
+	const __m128 RestHeight = _mm_set1_ps(m_DefaultWaveHeight);
+	const __m128 HeightDecay = _mm_set1_ps(m_HeightDecay);
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128 SignMask = _mm_set1_ps(-0.0f);
+	const __m128i LaneBit = _mm_setr_epi32(1, 2, 4, 8);
+	__m128 Energy = _mm_setzero_ps();
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		// 左隣から読み込んだビット列を1ビットずつずらし, 左, 中心, 右のレーンマスクに展開する.
+		unsigned int RowBits = WaveObstacleMask::LoadBits(_mask.pCenter, _mask.Bit + i - 1);
+		__m128i Bits = _mm_and_si128(_mm_set1_epi32(static_cast<int>(RowBits)), LaneBit);
+		__m128 SolidLeft = _mm_castsi128_ps(_mm_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm_and_si128(_mm_set1_epi32(static_cast<int>(RowBits >> 1)), LaneBit);
+		__m128 Solid = _mm_castsi128_ps(_mm_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm_and_si128(_mm_set1_epi32(static_cast<int>(RowBits >> 2)), LaneBit);
+		__m128 SolidRight = _mm_castsi128_ps(_mm_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm_and_si128(_mm_set1_epi32(static_cast<int>(WaveObstacleMask::LoadBits(_mask.pUp, _mask.Bit + i))), LaneBit);
+		__m128 SolidUp = _mm_castsi128_ps(_mm_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm_and_si128(_mm_set1_epi32(static_cast<int>(WaveObstacleMask::LoadBits(_mask.pDown, _mask.Bit + i))), LaneBit);
+		__m128 SolidDown = _mm_castsi128_ps(_mm_cmpeq_epi32(Bits, LaneBit));
+
+		// 障害物の隣接セルは中心セルの値に置き換える.
+		__m128 Center = _mm_loadu_ps(_pCenter + i);
+		__m128 OldVelocity = _mm_loadu_ps(_pVelocity + i);
+		__m128 Right = _mm_or_ps(_mm_and_ps(SolidRight, Center), _mm_andnot_ps(SolidRight, _mm_loadu_ps(_pCenter + i + 1)));
+		__m128 Down = _mm_or_ps(_mm_and_ps(SolidDown, Center), _mm_andnot_ps(SolidDown, _mm_loadu_ps(_pDown + i)));
+		__m128 Left = _mm_or_ps(_mm_and_ps(SolidLeft, Center), _mm_andnot_ps(SolidLeft, _mm_loadu_ps(_pCenter + i - 1)));
+		__m128 Up = _mm_or_ps(_mm_and_ps(SolidUp, Center), _mm_andnot_ps(SolidUp, _mm_loadu_ps(_pUp + i)));
+		__m128 Sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(Right, Down), Left), Up);
+
+		__m128 Velocity = _mm_sub_ps(_mm_mul_ps(Sum, Quarter), Center);
+		Velocity = _mm_add_ps(OldVelocity, _mm_mul_ps(Velocity, Spring));
+		Velocity = _mm_sub_ps(Velocity, _mm_mul_ps(_mm_sub_ps(Velocity, Damping), VelocityDecay));
+		__m128 Height = _mm_sub_ps(_mm_add_ps(Center, Velocity), Damping);
+		Height = _mm_sub_ps(Height, _mm_mul_ps(_mm_sub_ps(Height, RestHeight), HeightDecay));
+		Velocity = _mm_add_ps(Velocity, _mm_loadu_ps(_pAddVelocity + i));
+
+		Height = _mm_min_ps(_mm_max_ps(Height, Zero), One);
+		Velocity = _mm_min_ps(_mm_max_ps(Velocity, Zero), One);
+
+		// 障害物のセル自身は値を保持する.
+		Height = _mm_or_ps(_mm_and_ps(Solid, Center), _mm_andnot_ps(Solid, Height));
+		Velocity = _mm_or_ps(_mm_and_ps(Solid, OldVelocity), _mm_andnot_ps(Solid, Velocity));
+		_mm_storeu_ps(_pOutHeight + i, Height);
+		_mm_storeu_ps(_pOutVelocity + i, Velocity);
+
+		Energy = _mm_max_ps(Energy, _mm_andnot_ps(SignMask, _mm_sub_ps(Height, Center)));
+		Energy = _mm_max_ps(Energy, _mm_andnot_ps(SignMask, _mm_sub_ps(Velocity, OldVelocity)));
+	}
+
+	Energy = _mm_max_ps(Energy, _mm_movehl_ps(Energy, Energy));
+	Energy = _mm_max_ss(Energy, _mm_shuffle_ps(Energy, Energy, 1));
+	float Result = _mm_cvtss_f32(Energy);
+
+	if (i < _count)
+	{
+		WaveObstacleMask::ROW_MASK Mask = _mask;
+		Mask.Bit += i;
+		Result = std::max(Result, StepRowMaskScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _springPower, Mask));
+	}
+
+	return Result;
+}
+
+CPUFEATURE_TARGET_AVX2
+float WaveSimulator::StepRowMaskAVX2(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	const __m256 Quarter = _mm256_set1_ps(0.25f);
+	const __m256 Spring = _mm256_set1_ps(_springPower);
+	const __m256 Damping = _mm256_set1_ps(m_Damping);
+	const __m256 VelocityDecay = _mm256_set1_ps(m_VelocityDecay);
+	const __m256 RestHeight = _mm256_set1_ps(m_DefaultWaveHeight);
+	const __m256 HeightDecay = _mm256_set1_ps(m_HeightDecay);
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 One = _mm256_set1_ps(1.0f);
+	const __m256 SignMask = _mm256_set1_ps(-0.0f);
+	const __m256i LaneBit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	__m256 Energy = _mm256_setzero_ps();
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		unsigned int RowBits = WaveObstacleMask::LoadBits(_mask.pCenter, _mask.Bit + i - 1);
+		__m256i Bits = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(RowBits)), LaneBit);
+		__m256 SolidLeft = _mm256_castsi256_ps(_mm256_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(RowBits >> 1)), LaneBit);
+		__m256 Solid = _mm256_castsi256_ps(_mm256_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(RowBits >> 2)), LaneBit);
+		__m256 SolidRight = _mm256_castsi256_ps(_mm256_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(WaveObstacleMask::LoadBits(_mask.pUp, _mask.Bit + i))), LaneBit);
+		__m256 SolidUp = _mm256_castsi256_ps(_mm256_cmpeq_epi32(Bits, LaneBit));
+		Bits = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(WaveObstacleMask::LoadBits(_mask.pDown, _mask.Bit + i))), LaneBit);
+		__m256 SolidDown = _mm256_castsi256_ps(_mm256_cmpeq_epi32(Bits, LaneBit));
+
+		__m256 Center = _mm256_loadu_ps(_pCenter + i);
+		__m256 OldVelocity = _mm256_loadu_ps(_pVelocity + i);
+		__m256 Right = _mm256_blendv_ps(_mm256_loadu_ps(_pCenter + i + 1), Center, SolidRight);
+		__m256 Down = _mm256_blendv_ps(_mm256_loadu_ps(_pDown + i), Center, SolidDown);
+		__m256 Left = _mm256_blendv_ps(_mm256_loadu_ps(_pCenter + i - 1), Center, SolidLeft);
+		__m256 Up = _mm256_blendv_ps(_mm256_loadu_ps(_pUp + i), Center, SolidUp);
+		__m256 Sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(Right, Down), Left), Up);
+
+		__m256 Velocity = _mm256_sub_ps(_mm256_mul_ps(Sum, Quarter), Center);
+		Velocity = _mm256_add_ps(OldVelocity, _mm256_mul_ps(Velocity, Spring));
+		Velocity = _mm256_sub_ps(Velocity, _mm256_mul_ps(_mm256_sub_ps(Velocity, Damping), VelocityDecay));
+		__m256 Height = _mm256_sub_ps(_mm256_add_ps(Center, Velocity), Damping);
+		Height = _mm256_sub_ps(Height, _mm256_mul_ps(_mm256_sub_ps(Height, RestHeight), HeightDecay));
+		Velocity = _mm256_add_ps(Velocity, _mm256_loadu_ps(_pAddVelocity + i));
+
+		Height = _mm256_min_ps(_mm256_max_ps(Height, Zero), One);
+		Velocity = _mm256_min_ps(_mm256_max_ps(Velocity, Zero), One);
+		Height = _mm256_blendv_ps(Height, Center, Solid);
+		Velocity = _mm256_blendv_ps(Velocity, OldVelocity, Solid);
+		_mm256_storeu_ps(_pOutHeight + i, Height);
+		_mm256_storeu_ps(_pOutVelocity + i, Velocity);
+
+		Energy = _mm256_max_ps(Energy, _mm256_andnot_ps(SignMask, _mm256_sub_ps(Height, Center)));
+		Energy = _mm256_max_ps(Energy, _mm256_andnot_ps(SignMask, _mm256_sub_ps(Velocity, OldVelocity)));
+	}
+
+	__m128 Energy4 = _mm_max_ps(_mm256_castps256_ps128(Energy), _mm256_extractf128_ps(Energy, 1));
+	Energy4 = _mm_max_ps(Energy4, _mm_movehl_ps(Energy4, Energy4));
+	Energy4 = _mm_max_ss(Energy4, _mm_shuffle_ps(Energy4, Energy4, 1));
+	float Result = _mm_cvtss_f32(Energy4);
+
+	if (i < _count)
+	{
+		WaveObstacleMask::ROW_MASK Mask = _mask;
+		Mask.Bit += i;
+		Result = std::max(Result, StepRowMaskSSE(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _springPower, Mask));
+	}
+
+	return Result;
+}
+
+CPUFEATURE_TARGET_SSE
+void WaveSimulator::WaveMapRowSSE(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count)
+{
+	const __m128 Scale = _mm_set1_ps(255.0f);
+	const __m128 Half = _mm_set1_ps(0.5f);
+	const __m128i Alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		// 4ピクセル分をまとめて32bitずつ組み立てる(リトルエンディアンなのでRが最下位).
+		__m128i Red = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_pHeight + i), Scale), Half));
+		__m128i Green = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_pVelocity + i), Scale), Half));
+		__m128i Pixel = _mm_or_si128(_mm_or_si128(Red, _mm_slli_epi32(Green, 8)), Alpha);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOut + i * 4), Pixel);
+	}
+
+	if (i < _count)
+	{
+		WaveMapRowScalar(_pHeight + i, _pVelocity + i, _pOut + i * 4, _count - i);
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void WaveSimulator::WaveMapRowAVX2(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count)
+{
+	const __m256 Scale = _mm256_set1_ps(255.0f);
+	const __m256 Half = _mm256_set1_ps(0.5f);
+	const __m256i Alpha = _mm256_set1_epi32(static_cast<int>(0xff000000));
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256i Red = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(_pHeight + i), Scale), Half));
+		__m256i Green = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(_pVelocity + i), Scale), Half));
+		__m256i Pixel = _mm256_or_si256(_mm256_or_si256(Red, _mm256_slli_epi32(Green, 8)), Alpha);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOut + i * 4), Pixel);
+	}
+
+	if (i < _count)
+	{
+		WaveMapRowSSE(_pHeight + i, _pVelocity + i, _pOut + i * 4, _count - i);
+	}
+}
+
+CPUFEATURE_TARGET_SSE
+void WaveSimulator::NormalMapRowSSE(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count)
+{
+	const __m128 Scale = _mm_set1_ps(255.0f);
+	const __m128 Half = _mm_set1_ps(0.5f);
+	const __m128i Green = _mm_set1_epi32(0x0000ff00);
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		__m128 TangentU = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_pCenter + i - 1), _mm_loadu_ps(_pCenter + i + 1)), Half), Half);
+		__m128 TangentV = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_pUp + i), _mm_loadu_ps(_pDown + i)), Half), Half);
+		__m128 Height = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_pCenter + i), Half), Half);
+
+		__m128i Red = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(TangentU, Scale), Half));
+		__m128i Blue = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(TangentV, Scale), Half));
+		__m128i Alpha = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(Height, Scale), Half));
+		__m128i Pixel = _mm_or_si128(_mm_or_si128(Red, Green), _mm_or_si128(_mm_slli_epi32(Blue, 16), _mm_slli_epi32(Alpha, 24)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_pOut + i * 4), Pixel);
+	}
+
+	if (i < _count)
+	{
+		NormalMapRowScalar(_pUp + i, _pCenter + i, _pDown + i, _pOut + i * 4, _count - i);
+	}
+}
+
+CPUFEATURE_TARGET_AVX2
+void WaveSimulator::NormalMapRowAVX2(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count)
+{
+	const __m256 Scale = _mm256_set1_ps(255.0f);
+	const __m256 Half = _mm256_set1_ps(0.5f);
+	const __m256i Green = _mm256_set1_epi32(0x0000ff00);
+
+	int i = 0;
+	for (; i + 8 <= _count; i += 8)
+	{
+		__m256 TangentU = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_pCenter + i - 1), _mm256_loadu_ps(_pCenter + i + 1)), Half), Half);
+		__m256 TangentV = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_pUp + i), _mm256_loadu_ps(_pDown + i)), Half), Half);
+		__m256 Height = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(_pCenter + i), Half), Half);
+
+		__m256i Red = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(TangentU, Scale), Half));
+		__m256i Blue = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(TangentV, Scale), Half));
+		__m256i Alpha = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(Height, Scale), Half));
+		__m256i Pixel = _mm256_or_si256(_mm256_or_si256(Red, Green), _mm256_or_si256(_mm256_slli_epi32(Blue, 16), _mm256_slli_epi32(Alpha, 24)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pOut + i * 4), Pixel);
+	}
+
+	if (i < _count)
+	{
+		NormalMapRowSSE(_pUp + i, _pCenter + i, _pDown + i, _pOut + i * 4, _count - i);
+	}
+}
+
+#else
+
+float WaveSimulator::StepRowSSE(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower)
+{
+	return StepRowScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _springPower);
+}
+
+float WaveSimulator::StepRowAVX2(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower)
+{
+	return StepRowScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _springPower);
+}
+
+float WaveSimulator::StepRowMaskSSE(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	return StepRowMaskScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _springPower, _mask);
+}
+
+float WaveSimulator::StepRowMaskAVX2(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	return StepRowMaskScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _springPower, _mask);
+}
+
+void WaveSimulator::WaveMapRowSSE(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count)
+{
+	WaveMapRowScalar(_pHeight, _pVelocity, _pOut, _count);
+}
+
+void WaveSimulator::WaveMapRowAVX2(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count)
+{
+	WaveMapRowScalar(_pHeight, _pVelocity, _pOut, _count);
+}
+
+void WaveSimulator::NormalMapRowSSE(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count)
+{
+	NormalMapRowScalar(_pUp, _pCenter, _pDown, _pOut, _count);
+}
+
+void WaveSimulator::NormalMapRowAVX2(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count)
+{
+	NormalMapRowScalar(_pUp, _pCenter, _pDown, _pOut, _count);
+}
+
+#endif // CPUFEATURE_X86
+
+#ifdef CPUFEATURE_NEON
+
+float WaveSimulator::StepRowNEON(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower)
+{
+	const float32x4_t Quarter = vdupq_n_f32(0.25f);
+	const float32x4_t Spring = vdupq_n_f32(_springPower);
+	const float32x4_t Damping = vdupq_n_f32(m_Damping);
+	const float32x4_t VelocityDecay = vdupq_n_f32(m_VelocityDecay);
+	const float32x4_t RestHeight = vdupq_n_f32(m_DefaultWaveHeight);
+	const float32x4_t HeightDecay = vdupq_n_f32(m_HeightDecay);
+	const float32x4_t Zero = vdupq_n_f32(0.0f);
+	const float32x4_t One = vdupq_n_f32(1.0f);
+	float32x4_t Energy = vdupq_n_f32(0.0f);
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		float32x4_t Center = vld1q_f32(_pCenter + i);
+		float32x4_t OldVelocity = vld1q_f32(_pVelocity + i);
+		float32x4_t Sum = vaddq_f32(vld1q_f32(_pCenter + i + 1), vld1q_f32(_pDown + i));
+		Sum = vaddq_f32(Sum, vld1q_f32(_pCenter + i - 1));
+		Sum = vaddq_f32(Sum, vld1q_f32(_pUp + i));
+
+		// 融合積和を使うとスカラー版と結果がずれるので乗算と加算を分ける.
+		float32x4_t Velocity = vsubq_f32(vmulq_f32(Sum, Quarter), Center);
+		Velocity = vaddq_f32(OldVelocity, vmulq_f32(Velocity, Spring));
+		Velocity = vsubq_f32(Velocity, vmulq_f32(vsubq_f32(Velocity, Damping), VelocityDecay));
+		float32x4_t Height = vsubq_f32(vaddq_f32(Center, Velocity), Damping);
+		Height = vsubq_f32(Height, vmulq_f32(vsubq_f32(Height, RestHeight), HeightDecay));
+		Velocity = vaddq_f32(Velocity, vld1q_f32(_pAddVelocity + i));
+
+		Height = vminq_f32(vmaxq_f32(Height, Zero), One);
+		Velocity = vminq_f32(vmaxq_f32(Velocity, Zero), One);
+		vst1q_f32(_pOutHeight + i, Height);
+		vst1q_f32(_pOutVelocity + i, Velocity);
+
+		Energy = vmaxq_f32(Energy, vabdq_f32(Height, Center));
+		Energy = vmaxq_f32(Energy, vabdq_f32(Velocity, OldVelocity));
+	}
+
+	float32x2_t Energy2 = vpmax_f32(vget_low_f32(Energy), vget_high_f32(Energy));
+	float Result = std::max(vget_lane_f32(Energy2, 0), vget_lane_f32(Energy2, 1));
+
+	if (i < _count)
+	{
+		Result = std::max(Result, StepRowScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _springPower));
+	}
+
+	return Result;
+}
+
+float WaveSimulator::StepRowMaskNEON(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	const float32x4_t Quarter = vdupq_n_f32(0.25f);
+	const float32x4_t Spring = vdupq_n_f32(_springPower);
+	const float32x4_t Damping = vdupq_n_f32(m_Damping);
+	const float32x4_t VelocityDecay = vdupq_n_f32(m_VelocityDecay);
+	const float32x4_t RestHeight = vdupq_n_f32(m_DefaultWaveHeight);
+	const float32x4_t HeightDecay = vdupq_n_f32(m_HeightDecay);
+	const float32x4_t Zero = vdupq_n_f32(0.0f);
+	const float32x4_t One = vdupq_n_f32(1.0f);
+	const uint32_t LaneBitData[4] = { 1, 2, 4, 8 };
+	const uint32x4_t LaneBit = vld1q_u32(LaneBitData);
+	float32x4_t Energy = vdupq_n_f32(0.0f);
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		unsigned int RowBits = WaveObstacleMask::LoadBits(_mask.pCenter, _mask.Bit + i - 1);
+		uint32x4_t SolidLeft = vtstq_u32(vdupq_n_u32(RowBits), LaneBit);
+		uint32x4_t Solid = vtstq_u32(vdupq_n_u32(RowBits >> 1), LaneBit);
+		uint32x4_t SolidRight = vtstq_u32(vdupq_n_u32(RowBits >> 2), LaneBit);
+		uint32x4_t SolidUp = vtstq_u32(vdupq_n_u32(WaveObstacleMask::LoadBits(_mask.pUp, _mask.Bit + i)), LaneBit);
+		uint32x4_t SolidDown = vtstq_u32(vdupq_n_u32(WaveObstacleMask::LoadBits(_mask.pDown, _mask.Bit + i)), LaneBit);
+
+		float32x4_t Center = vld1q_f32(_pCenter + i);
+		float32x4_t OldVelocity = vld1q_f32(_pVelocity + i);
+		float32x4_t Right = vbslq_f32(SolidRight, Center, vld1q_f32(_pCenter + i + 1));
+		float32x4_t Down = vbslq_f32(SolidDown, Center, vld1q_f32(_pDown + i));
+		float32x4_t Left = vbslq_f32(SolidLeft, Center, vld1q_f32(_pCenter + i - 1));
+		float32x4_t Up = vbslq_f32(SolidUp, Center, vld1q_f32(_pUp + i));
+		float32x4_t Sum = vaddq_f32(vaddq_f32(vaddq_f32(Right, Down), Left), Up);
+
+		float32x4_t Velocity = vsubq_f32(vmulq_f32(Sum, Quarter), Center);
+		Velocity = vaddq_f32(OldVelocity, vmulq_f32(Velocity, Spring));
+		Velocity = vsubq_f32(Velocity, vmulq_f32(vsubq_f32(Velocity, Damping), VelocityDecay));
+		float32x4_t Height = vsubq_f32(vaddq_f32(Center, Velocity), Damping);
+		Height = vsubq_f32(Height, vmulq_f32(vsubq_f32(Height, RestHeight), HeightDecay));
+		Velocity = vaddq_f32(Velocity, vld1q_f32(_pAddVelocity + i));
+
+		Height = vminq_f32(vmaxq_f32(Height, Zero), One);
+		Velocity = vminq_f32(vmaxq_f32(Velocity, Zero), One);
+		Height = vbslq_f32(Solid, Center, Height);
+		Velocity = vbslq_f32(Solid, OldVelocity, Velocity);
+		vst1q_f32(_pOutHeight + i, Height);
+		vst1q_f32(_pOutVelocity + i, Velocity);
+
+		Energy = vmaxq_f32(Energy, vabdq_f32(Height, Center));
+		Energy = vmaxq_f32(Energy, vabdq_f32(Velocity, OldVelocity));
+	}
+
+	float32x2_t Energy2 = vpmax_f32(vget_low_f32(Energy), vget_high_f32(Energy));
+	float Result = std::max(vget_lane_f32(Energy2, 0), vget_lane_f32(Energy2, 1));
+
+	if (i < _count)
+	{
+		WaveObstacleMask::ROW_MASK Mask = _mask;
+		Mask.Bit += i;
+		Result = std::max(Result, StepRowMaskScalar(
+			_pUp + i, _pCenter + i, _pDown + i, _pVelocity + i, _pAddVelocity + i,
+			_pOutHeight + i, _pOutVelocity + i, _count - i, _springPower, Mask));
+	}
+
+	return Result;
+}
+
+void WaveSimulator::WaveMapRowNEON(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count)
+{
+	const float32x4_t Scale = vdupq_n_f32(255.0f);
+	const float32x4_t Half = vdupq_n_f32(0.5f);
+	const uint32x4_t Alpha = vdupq_n_u32(0xff000000);
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		uint32x4_t Red = vcvtq_u32_f32(vaddq_f32(vmulq_f32(vld1q_f32(_pHeight + i), Scale), Half));
+		uint32x4_t Green = vcvtq_u32_f32(vaddq_f32(vmulq_f32(vld1q_f32(_pVelocity + i), Scale), Half));
+		uint32x4_t Pixel = vorrq_u32(vorrq_u32(Red, vshlq_n_u32(Green, 8)), Alpha);
+		vst1q_u8(_pOut + i * 4, vreinterpretq_u8_u32(Pixel));
+	}
+
+	if (i < _count)
+	{
+		WaveMapRowScalar(_pHeight + i, _pVelocity + i, _pOut + i * 4, _count - i);
+	}
+}
+
+void WaveSimulator::NormalMapRowNEON(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count)
+{
+	const float32x4_t Scale = vdupq_n_f32(255.0f);
+	const float32x4_t Half = vdupq_n_f32(0.5f);
+	const uint32x4_t Green = vdupq_n_u32(0x0000ff00);
+
+	int i = 0;
+	for (; i + 4 <= _count; i += 4)
+	{
+		float32x4_t TangentU = vaddq_f32(vmulq_f32(vsubq_f32(vld1q_f32(_pCenter + i - 1), vld1q_f32(_pCenter + i + 1)), Half), Half);
+		float32x4_t TangentV = vaddq_f32(vmulq_f32(vsubq_f32(vld1q_f32(_pUp + i), vld1q_f32(_pDown + i)), Half), Half);
+		float32x4_t Height = vaddq_f32(vmulq_f32(vld1q_f32(_pCenter + i), Half), Half);
+
+		uint32x4_t Red = vcvtq_u32_f32(vaddq_f32(vmulq_f32(TangentU, Scale), Half));
+		uint32x4_t Blue = vcvtq_u32_f32(vaddq_f32(vmulq_f32(TangentV, Scale), Half));
+		uint32x4_t Alpha = vcvtq_u32_f32(vaddq_f32(vmulq_f32(Height, Scale), Half));
+		uint32x4_t Pixel = vorrq_u32(vorrq_u32(Red, Green), vorrq_u32(vshlq_n_u32(Blue, 16), vshlq_n_u32(Alpha, 24)));
+		vst1q_u8(_pOut + i * 4, vreinterpretq_u8_u32(Pixel));
+	}
+
+	if (i < _count)
+	{
+		NormalMapRowScalar(_pUp + i, _pCenter + i, _pDown + i, _pOut + i * 4, _count - i);
+	}
+}
+
+#else
+
+float WaveSimulator::StepRowNEON(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower)
+{
+	return StepRowScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _springPower);
+}
+
+float WaveSimulator::StepRowMaskNEON(
+	const float* _pUp, const float* _pCenter, const float* _pDown,
+	const float* _pVelocity, const float* _pAddVelocity,
+	float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+	const WaveObstacleMask::ROW_MASK& _mask)
+{
+	return StepRowMaskScalar(_pUp, _pCenter, _pDown, _pVelocity, _pAddVelocity, _pOutHeight, _pOutVelocity, _count, _springPower, _mask);
+}
+
+void WaveSimulator::WaveMapRowNEON(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count)
+{
+	WaveMapRowScalar(_pHeight, _pVelocity, _pOut, _count);
+}
+
+void WaveSimulator::NormalMapRowNEON(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count)
+{
+	NormalMapRowScalar(_pUp, _pCenter, _pDown, _pOut, _count);
+}
+
+#endif // CPUFEATURE_NEON
@@ -0,0 +1,889 @@
+﻿/**
+ * @file	WaveSimulator.h
+ * @brief	波シミュレーションクラス定義
+ * @author	morimoto
+ */
+#ifndef WAVESIMULATOR_H
+#define WAVESIMULATOR_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "WaveImpulseQueue\WaveImpulseQueue.h"
+#include "FixedWaveSolver\FixedWaveSolver.h"
+#include "WaveObstacleMask\WaveObstacleMask.h"
+#include "WaveQuery\WaveQuery.h"
+#include "WaveSnapshot\WaveSnapshot.h"
+
+
+class ThreadPool;
+
+
+/**
+ * 波シミュレーションクラス
+ *
+ * Wave.fxのPS_WAVEMAPと同じばねモデルをCPUで計算する.
+ * 速度と高さは毎ステップ静止時の値に向けて減衰させるので(m_VelocityDecay, m_HeightDecay), 追加した波は時間とともに収まる.
+ * 高さと速度はそれぞれ別の配列(SoA)で保持し, 外周1セルに端の値を複製して
+ * テクスチャのクランプサンプリングと同じ境界条件にしている.
+ *
+ * 波マップはキャッシュに収まる大きさのタイルに分割して更新する.
+ * 各タイルは前ステップのバッファから上下左右1セル分(ハロー)を読み込むだけなので,
+ * タイル同士は独立しており, スレッドプールが設定されていれば並列に更新される.
+ *
+ * スパース更新が有効な場合は, 1ステップでの変化量(エネルギー)がしきい値以下のタイルを休止させ,
+ * 自身か上下左右のタイルが活動しているか, 波が追加されたタイルだけを更新する.
+ * 休止したタイルは両方のバッファを同じ値にそろえてから更新を止めるので, 値はそのまま保たれる.
+ *
+ * 時間ブロッキングが有効な場合は, タイルの周囲Kセルを含めた領域をスレッドごとの作業領域に読み込み,
+ * Kステップ分を作業領域の中で進めてからタイルの部分だけを書き戻す(台形タイリング).
+ * 周囲の重複部分は毎ステップ1セルずつ狭くなるので, 波マップ全体の読み書きはKステップで1回になる.
+ *
+ * 追加する波はWaveImpulseQueueに溜めておき, ステップの開始時にかかるタイルごとに振り分ける.
+ * 各タイルは更新の直前に自身に振り分けられた波だけを作業領域に展開するので,
+ * 波の数に関係なく波マップの更新は1回で済む.
+ *
+ * StepWithMapは更新した行がキャッシュに残っているうちに波マップと法線マップへ書き出すので,
+ * Step→WriteWaveMap→法線マップ作成と波マップを3回走査する場合に比べてメモリの読み込みが減る.
+ *
+ * 障害物マスクが設定されている場合は, 更新範囲に障害物があるタイル(固定小数点では行)だけを
+ * マスク付きの更新関数で更新する. マスク付きの更新関数は障害物の隣接セルを中心セルの値に置き換え,
+ * 障害物のセル自身は値を保持するので, 波は分岐なしで障害物に反射する.
+ *
+ * 計算精度はSetPrecisionで選択でき, PRECISION_FIXED16ではFixedWaveSolverによるint16の固定小数点で計算する.
+ * 固定小数点ではスパース更新と時間ブロッキングは行われず, 高さと速度の配列(GetHeightRowなど)も更新されない.
+ *
+ * QueryHeightはGPUの波マップを読み戻さずに, 任意のワールド座標の高さと法線をまとめて取得する(WaveQueryを参照).
+ * 固定小数点の場合は, ステップ後の最初の取得で高さ配列に書き戻してから取得する.
+ *
+ * SaveSnapshotとLoadSnapshotで高さと速度をWaveSnapshotのファイルに保存, 復元できる.
+ * 落ち着いた状態を保存しておけば, 起動時や計測時に平らな水面から計算し直さずに同じ状態から始められる.
+ */
+class WaveSimulator
+{
+public:
+	/**
+	 * 計算精度の列挙子
+	 */
+	enum PRECISION
+	{
+		PRECISION_FLOAT32,	//!< floatで計算する.
+		PRECISION_FIXED16	//!< int16の固定小数点(Q14)で計算する(誤差はFixedWaveSolverを参照).
+	};
+
+	/**
+	 * コンストラクタ
+	 * @param[in] _width 波マップの幅
+	 * @param[in] _height 波マップの高さ
+	 */
+	WaveSimulator(int _width, int _height);
+
+	/**
+	 * デストラクタ
+	 */
+	virtual ~WaveSimulator();
+
+	/**
+	 * 初期化処理
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool Initialize();
+
+	/**
+	 * 終了処理
+	 */
+	void Finalize();
+
+	/**
+	 * 波マップを一定値で初期化
+	 * @param[in] _height 高さの初期値
+	 * @param[in] _velocity 速度の初期値
+	 */
+	void Clear(float _height, float _velocity);
+
+	/**
+	 * 現在の高さと速度をスナップショットファイルに保存
+	 * @param[in] _pFileName 保存するファイル名
+	 * @param[in] _encoding 面の格納形式
+	 * @return 保存に成功したらtrue 失敗したらfalse
+	 */
+	bool SaveSnapshot(const char* _pFileName, WaveSnapshot::ENCODING _encoding);
+
+	/**
+	 * スナップショットから高さと速度を復元
+	 *
+	 * 追加待ちの波はそのまま残り, 全てのタイルを活動状態にする.
+	 * @param[in] _snapshot 開いているスナップショット
+	 * @return 復元に成功したらtrue 大きさが異なるかデータが壊れていればfalse(波マップは変更しない)
+	 */
+	bool LoadSnapshot(const WaveSnapshot& _snapshot);
+
+	/**
+	 * 波の追加(次のStepで反映される)
+	 * @param[in] _u 波を追加するテクスチャ座標u(0～1)
+	 * @param[in] _v 波を追加するテクスチャ座標v(0～1)
+	 * @param[in] _height 追加する波の高さ
+	 */
+	void AddWave(float _u, float _v, float _height)
+	{
+		m_pImpulseQueue->Push(_u, _v, m_WaveRadius, _height);
+	}
+
+	/**
+	 * 半径を指定して波の追加(次のStepで反映される)
+	 * @param[in] _u 波を追加するテクスチャ座標u(0～1)
+	 * @param[in] _v 波を追加するテクスチャ座標v(0～1)
+	 * @param[in] _radius 波の半径(テクスチャ座標)
+	 * @param[in] _height 追加する波の高さ
+	 */
+	void AddWave(float _u, float _v, float _radius, float _height)
+	{
+		m_pImpulseQueue->Push(_u, _v, _radius, _height);
+	}
+
+	/**
+	 * 追加する波を受け付けるキューを設定
+	 * @param[in] _pImpulseQueue 複数のオブジェクトで共有するキュー(nullptrなら内部のキューを使用する)
+	 */
+	void SetImpulseQueue(WaveImpulseQueue* _pImpulseQueue)
+	{
+		m_pImpulseQueue = _pImpulseQueue != nullptr ? _pImpulseQueue : &m_ImpulseQueue;
+	}
+
+	/**
+	 * 追加する波を受け付けるキューを取得
+	 * @return キュー
+	 */
+	WaveImpulseQueue* GetImpulseQueue()
+	{
+		return m_pImpulseQueue;
+	}
+
+	/**
+	 * 障害物マスクを設定
+	 *
+	 * マスクの内容を変更した場合も再度設定すること.
+	 * @param[in] _pObstacleMask 波マップと同じ大きさでBuildしたマスク(nullptrなら障害物なし)
+	 * @return 設定に成功したらtrue 大きさが異なればfalse
+	 */
+	bool SetObstacleMask(const WaveObstacleMask* _pObstacleMask);
+
+	/**
+	 * 障害物マスクを取得
+	 * @return 障害物マスク
+	 */
+	const WaveObstacleMask* GetObstacleMask() const
+	{
+		return m_pObstacleMask;
+	}
+
+	/**
+	 * 波のシミュレーションを1ステップ進める
+	 */
+	void Step();
+
+	/**
+	 * 波のシミュレーションを指定したステップ数進める
+	 *
+	 * 時間ブロッキングが有効ならブロックのステップ数ごとにまとめて進める.
+	 * 追加した波は最初のステップで反映される.
+	 * @param[in] _stepNum 進めるステップ数
+	 */
+	void Step(int _stepNum);
+
+	/**
+	 * 波のシミュレーションを1ステップ進め, 波マップと法線マップを書き込む
+	 *
+	 * 波マップは更新後の値で, 法線マップはWave.fxのPS_BUMPMAPと同じく更新前の高さで作成する.
+	 * 更新も複製もしなかった休止中のタイルには書き込まないので, 書き込み先は前回の内容を保持しておくこと.
+	 * @param[out] _pWaveMap 波マップの書き込み先(幅x高さ分のピクセル)
+	 * @param[in] _waveRowPitch 波マップの1行分のバイト数
+	 * @param[out] _pNormalMap 法線マップの書き込み先(幅x高さ分のピクセル)
+	 * @param[in] _normalRowPitch 法線マップの1行分のバイト数
+	 */
+	void StepWithMap(void* _pWaveMap, int _waveRowPitch, void* _pNormalMap, int _normalRowPitch);
+
+	/**
+	 * 波マップをRGBA8(高さ, 速度, 0, 1)でテクスチャデータに書き込む
+	 * @param[out] _pData 書き込み先(幅x高さ分のピクセル)
+	 * @param[in] _rowPitch 書き込み先の1行分のバイト数
+	 */
+	void WriteWaveMap(void* _pData, int _rowPitch) const;
+
+	/**
+	 * 現在の高さから法線マップをRGBA8(Wave.fxのPS_BUMPMAPと同じ形式)でテクスチャデータに書き込む
+	 * @param[out] _pData 書き込み先(幅x高さ分のピクセル)
+	 * @param[in] _rowPitch 書き込み先の1行分のバイト数
+	 */
+	void WriteNormalMap(void* _pData, int _rowPitch);
+
+	/**
+	 * 波マップが覆うワールド座標の範囲を設定(QueryHeightで使用する)
+	 * @param[in] _minX 波マップの左端(u=0)のx座標
+	 * @param[in] _maxZ 波マップの上端(v=0)のz座標
+	 * @param[in] _width 波マップのx方向の大きさ
+	 * @param[in] _depth 波マップのz方向の大きさ
+	 */
+	void SetWorldArea(float _minX, float _maxZ, float _width, float _depth)
+	{
+		m_Query.SetWorldArea(_minX, _maxZ, _width, _depth);
+	}
+
+	/**
+	 * 複数のワールド座標の高さと法線をまとめて取得
+	 * @param[in] _pX 取得する座標のx(_count個)
+	 * @param[in] _pZ 取得する座標のz(_count個)
+	 * @param[in] _count 取得する座標の数
+	 * @param[out] _pHeight 高さの書き込み先(Wave.fxの高さと同じ値)
+	 * @param[out] _pNormalX 法線のx成分の書き込み先(nullptrなら法線を求めない)
+	 * @param[out] _pNormalY 法線のy成分の書き込み先
+	 * @param[out] _pNormalZ 法線のz成分の書き込み先
+	 */
+	void QueryHeight(const float* _pX, const float* _pZ, int _count, float* _pHeight, float* _pNormalX, float* _pNormalY, float* _pNormalZ);
+
+	/**
+	 * 更新に使用するスレッドプールを設定
+	 * @param[in] _pThreadPool スレッドプール(nullptrなら呼び出し元スレッドのみで更新する)
+	 */
+	void SetThreadPool(ThreadPool* _pThreadPool)
+	{
+		m_pThreadPool = _pThreadPool;
+		m_FixedSolver.SetThreadPool(_pThreadPool);
+	}
+
+	/**
+	 * タイルの大きさを設定
+	 * @param[in] _tileWidth タイルの幅(SIMDの幅に合わせて8の倍数に切り上げる)
+	 * @param[in] _tileHeight タイルの高さ
+	 */
+	void SetTileSize(int _tileWidth, int _tileHeight);
+
+	/**
+	 * 時間ブロッキングで1度に進めるステップ数を設定
+	 * @param[in] _blockStepNum 1度に進めるステップ数(1なら時間ブロッキングを行わない)
+	 */
+	void SetBlockStepNum(int _blockStepNum)
+	{
+		m_BlockStepNum = std::min(std::max(_blockStepNum, 1), m_MaxBlockStepNum);
+	}
+
+	/**
+	 * 時間ブロッキングで1度に進めるステップ数を取得
+	 * @return 1度に進めるステップ数
+	 */
+	int GetBlockStepNum() const
+	{
+		return m_BlockStepNum;
+	}
+
+	/**
+	 * タイルの数を取得
+	 * @return タイルの数
+	 */
+	int GetTileNum() const
+	{
+		return m_TileNumX * m_TileNumY;
+	}
+
+	/**
+	 * スパース更新を行うかを設定
+	 * @param[in] _isSparse 活動しているタイルだけを更新するならtrue
+	 */
+	void SetIsSparse(bool _isSparse)
+	{
+		m_IsSparse = _isSparse;
+	}
+
+	/**
+	 * タイルを休止させるしきい値を設定
+	 * @param[in] _threshold 1ステップでの高さと速度の変化量の最大値がこの値以下なら休止する
+	 */
+	void SetSleepThreshold(float _threshold)
+	{
+		m_SleepThreshold = _threshold;
+	}
+
+	/**
+	 * 全てのタイルを活動状態にする(外部から波マップを書き換えた場合に呼ぶ)
+	 */
+	void WakeAllTiles();
+
+	/**
+	 * 直前のステップで更新したタイルの数を取得
+	 * @return 更新したタイルの数
+	 */
+	int GetActiveTileNum() const
+	{
+		return m_ActiveTileNum;
+	}
+
+	/**
+	 * 直前のステップで更新したタイルの割合を取得
+	 * @return 更新したタイルの割合(0～1)
+	 */
+	float GetActiveTileRatio() const
+	{
+		return static_cast<float>(m_ActiveTileNum) / static_cast<float>(GetTileNum());
+	}
+
+	/**
+	 * 計測開始からの更新したタイルの割合の平均を取得
+	 * @return 更新したタイルの割合の平均(0～1)
+	 */
+	float GetAverageActiveTileRatio() const
+	{
+		return m_CounterStepNum > 0 ? static_cast<float>(m_TotalActiveTileRatio / m_CounterStepNum) : 0.0f;
+	}
+
+	/**
+	 * 更新したタイルの割合の計測をリセット
+	 */
+	void ResetTileCounter()
+	{
+		m_TotalActiveTileRatio = 0.0;
+		m_CounterStepNum = 0;
+	}
+
+	/**
+	 * ばねの強さを設定
+	 * @param[in] _springPower ばねの強さ
+	 */
+	void SetSpringPower(float _springPower)
+	{
+		m_SpringPower = _springPower;
+		m_FixedSolver.SetSpringPower(_springPower);
+	}
+
+	/**
+	 * 使用する命令セットを設定
+	 * @param[in] _simdType 命令セット(使用できない場合は自動選択される)
+	 */
+	void SetSimdType(CpuFeature::SIMD_TYPE _simdType)
+	{
+		m_SimdType = CpuFeature::Resolve(_simdType);
+		m_FixedSolver.SetSimdType(m_SimdType);
+		m_Query.SetSimdType(m_SimdType);
+	}
+
+	/**
+	 * 計算精度を設定
+	 *
+	 * 切り替え時に現在の波マップを変換して引き継ぐ.
+	 * @param[in] _precision 計算精度
+	 */
+	void SetPrecision(PRECISION _precision);
+
+	/**
+	 * 計算精度を取得
+	 * @return 計算精度
+	 */
+	PRECISION GetPrecision() const
+	{
+		return m_Precision;
+	}
+
+	/**
+	 * 使用している命令セットを取得
+	 * @return 命令セット
+	 */
+	CpuFeature::SIMD_TYPE GetSimdType() const
+	{
+		return m_SimdType;
+	}
+
+	/**
+	 * 波マップの幅を取得
+	 * @return 波マップの幅
+	 */
+	int GetWidth() const
+	{
+		return m_Width;
+	}
+
+	/**
+	 * 波マップの高さを取得
+	 * @return 波マップの高さ
+	 */
+	int GetHeight() const
+	{
+		return m_Height;
+	}
+
+	/**
+	 * 1行分の要素数(外周を含む)を取得
+	 * @return 1行分の要素数
+	 */
+	int GetStride() const
+	{
+		return m_Stride;
+	}
+
+	/**
+	 * 高さ配列の行の先頭を取得
+	 * @param[in] _y 行番号(0～高さ-1)
+	 * @return 行の先頭要素へのポインタ
+	 */
+	const float* GetHeightRow(int _y) const
+	{
+		return &m_WaveHeight[m_ReadIndex][CellIndex(0, _y)];
+	}
+
+	/**
+	 * 速度配列の行の先頭を取得
+	 * @param[in] _y 行番号(0～高さ-1)
+	 * @return 行の先頭要素へのポインタ
+	 */
+	const float* GetVelocityRow(int _y) const
+	{
+		return &m_WaveVelocity[m_ReadIndex][CellIndex(0, _y)];
+	}
+
+	/**
+	 * 指定セルの高さを取得
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @return 高さ
+	 */
+	float GetWaveHeight(int _x, int _y) const
+	{
+		return m_WaveHeight[m_ReadIndex][CellIndex(_x, _y)];
+	}
+
+	/**
+	 * 指定セルの速度を取得
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @return 速度
+	 */
+	float GetWaveVelocity(int _x, int _y) const
+	{
+		return m_WaveVelocity[m_ReadIndex][CellIndex(_x, _y)];
+	}
+
+	static const float m_DefaultSpringPower;	//!< ばねの強さの初期値(Wave.fxのSpringPower).
+	static const float m_DefaultWaveHeight;		//!< 高さの初期値(Water::m_WaterClearColorのr).
+	static const float m_DefaultWaveVelocity;	//!< 速度の初期値(Water::m_WaterClearColorのg).
+	static const float m_Damping;				//!< 1ステップごとに高さから引く量(静止時の速度).
+	static const float m_VelocityDecay;			//!< 1ステップごとに速度の静止時からのずれを減らす割合(1 / 2^m_VelocityDecayShift).
+	static const int m_VelocityDecayShift;		//!< 速度の減衰率のシフト量(固定小数点はシフトで減衰させる).
+	static const float m_HeightDecay;			//!< 1ステップごとに高さの静止時(m_DefaultWaveHeight)からのずれを減らす割合(1 / 2^m_HeightDecayShift).
+	static const int m_HeightDecayShift;		//!< 高さの減衰率のシフト量.
+	static const float m_WaveRadius;			//!< 追加する波の半径(テクスチャ座標).
+	static const int m_DefaultTileWidth;		//!< タイルの幅の初期値.
+	static const int m_DefaultTileHeight;		//!< タイルの高さの初期値.
+	static const float m_DefaultSleepThreshold;	//!< タイルを休止させるしきい値の初期値.
+	static const int m_MaxBlockStepNum;			//!< 時間ブロッキングで1度に進めるステップ数の最大値.
+
+private:
+	/**
+	 * 追加する波がかかるセルの範囲構造体(MaxX < MinXなら範囲外)
+	 */
+	struct IMPULSE_RECT
+	{
+		int MinX;	//!< 左端のセル.
+		int MinY;	//!< 上端のセル.
+		int MaxX;	//!< 右端のセル.
+		int MaxY;	//!< 下端のセル.
+	};
+
+	/**
+	 * スレッドごとの作業領域
+	 */
+	struct WORK_BUFFER
+	{
+		std::vector<float> Height[2];	//!< 時間ブロッキングの高さ配列(ダブルバッファ).
+		std::vector<float> Velocity[2];	//!< 時間ブロッキングの速度配列(ダブルバッファ).
+		std::vector<float> AddVelocity;	//!< 速度の加算値.
+	};
+
+	/**
+	 * StepWithMapの書き込み先の構造体
+	 */
+	struct MAP_OUTPUT
+	{
+		unsigned char*	pWaveMap;		//!< 波マップの書き込み先.
+		int				WaveRowPitch;	//!< 波マップの1行分のバイト数.
+		unsigned char*	pNormalMap;		//!< 法線マップの書き込み先.
+		int				NormalRowPitch;	//!< 法線マップの1行分のバイト数.
+	};
+
+	/**
+	 * 1行分の更新関数
+	 * @param[in] _pUp 上の行の高さ
+	 * @param[in] _pCenter 更新する行の高さ(前後1要素を参照する)
+	 * @param[in] _pDown 下の行の高さ
+	 * @param[in] _pVelocity 更新する行の速度
+	 * @param[in] _pAddVelocity 速度への加算値(加算しない行は0の配列を渡す)
+	 * @param[out] _pOutHeight 更新後の高さの出力先
+	 * @param[out] _pOutVelocity 更新後の速度の出力先
+	 * @param[in] _count 更新する要素数
+	 * @param[in] _springPower ばねの強さ
+	 * @return 高さと速度の変化量の最大値
+	 */
+	typedef float(*STEPROW_FUNC)(
+		const float* _pUp,
+		const float* _pCenter,
+		const float* _pDown,
+		const float* _pVelocity,
+		const float* _pAddVelocity,
+		float* _pOutHeight,
+		float* _pOutVelocity,
+		int _count,
+		float _springPower);
+
+	/**
+	 * 障害物マスク付きの1行分の更新関数
+	 *
+	 * 引数はSTEPROW_FUNCに障害物マスクを加えたもの.
+	 * 障害物の隣接セルは中心セルの値として扱い, 障害物のセルは高さと速度をそのまま出力する.
+	 * @param[in] _mask 更新する行の障害物マスク
+	 * @return 高さと速度の変化量の最大値
+	 */
+	typedef float(*STEPROW_MASK_FUNC)(
+		const float* _pUp,
+		const float* _pCenter,
+		const float* _pDown,
+		const float* _pVelocity,
+		const float* _pAddVelocity,
+		float* _pOutHeight,
+		float* _pOutVelocity,
+		int _count,
+		float _springPower,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 1行分の波マップの書き込み関数
+	 * @param[in] _pHeight 高さ
+	 * @param[in] _pVelocity 速度
+	 * @param[out] _pOut 書き込み先(RGBA8)
+	 * @param[in] _count 書き込む要素数
+	 */
+	typedef void(*WAVEMAPROW_FUNC)(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み関数
+	 * @param[in] _pUp 上の行の高さ
+	 * @param[in] _pCenter 書き込む行の高さ(前後1要素を参照する)
+	 * @param[in] _pDown 下の行の高さ
+	 * @param[out] _pOut 書き込み先(RGBA8)
+	 * @param[in] _count 書き込む要素数
+	 */
+	typedef void(*NORMALMAPROW_FUNC)(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count);
+
+
+	/**
+	 * セルの配列インデックスを取得
+	 * @param[in] _x セルのx座標
+	 * @param[in] _y セルのy座標
+	 * @return 配列インデックス
+	 */
+	int CellIndex(int _x, int _y) const
+	{
+		return (_y + 1) * m_Stride + (_x + 1);
+	}
+
+	/**
+	 * 外周セルに端の値を複製する
+	 * @param[in] _index 対象のバッファインデックス
+	 */
+	void UpdateHalo(int _index);
+
+	/**
+	 * キューから追加する波を取り出し, かかるタイルごとに振り分ける
+	 *
+	 * 振り分け結果は並列更新中は読み込みのみとなる.
+	 */
+	void BinImpulse();
+
+	/**
+	 * 指定範囲にかかる波を速度の加算値に展開する
+	 *
+	 * 範囲に重なるタイルに振り分けた波を, それぞれのタイルの内側だけに展開するので,
+	 * 複数のタイルにかかる波も1セルに1回だけ加算される.
+	 * @param[in] _minX 範囲の左端
+	 * @param[in] _minY 範囲の上端
+	 * @param[in] _maxX 範囲の右端(含まない)
+	 * @param[in] _maxY 範囲の下端(含まない)
+	 * @param[out] _pAddVelocity 加算値の出力先(_pTop～_pBottomの行を範囲の幅で格納する)
+	 * @param[out] _pTop 加算値が存在する最初の行
+	 * @param[out] _pBottom 加算値が存在する最後の行の次(_pTopと同じなら加算値は存在しない)
+	 */
+	void BuildAddVelocity(int _minX, int _minY, int _maxX, int _maxY, std::vector<float>* _pAddVelocity, int* _pTop, int* _pBottom) const;
+
+	/**
+	 * タイルの数を計算
+	 */
+	void UpdateTileNum();
+
+	/**
+	 * タイルの更新範囲に障害物があるかを更新
+	 */
+	void UpdateTileObstacle();
+
+	/**
+	 * 更新するタイルの一覧を作成
+	 * @param[in] _isDiagonal 斜めのタイルの影響も考慮するか(複数ステップまとめて進める場合)
+	 */
+	void BuildStepTileList(bool _isDiagonal);
+
+	/**
+	 * 1ステップ進める
+	 * @param[in] _pMapOutput 波マップと法線マップの書き込み先(nullptrなら書き込まない)
+	 */
+	void StepSingle(const MAP_OUTPUT* _pMapOutput);
+
+	/**
+	 * 固定小数点で1ステップ進める
+	 * @param[in] _pMapOutput 波マップと法線マップの書き込み先(nullptrなら書き込まない)
+	 */
+	void StepFixed(const MAP_OUTPUT* _pMapOutput);
+
+	/**
+	 * 時間ブロッキングで複数ステップまとめて進める
+	 * @param[in] _stepNum 進めるステップ数
+	 */
+	void StepBlock(int _stepNum);
+
+	/**
+	 * 更新結果からタイルの活動状態を更新
+	 */
+	void UpdateTileState();
+
+	/**
+	 * スレッドごとの作業領域をスレッド数分確保する
+	 */
+	void ReserveWorkBuffer();
+
+	/**
+	 * タイル1つ分の更新
+	 * @param[in] _tileIndex タイルのインデックス
+	 * @param[in] _pStepRow 行更新関数
+	 * @param[in] _pStepRowMask 障害物マスク付きの行更新関数
+	 * @param[in] _pBuffer 作業領域
+	 * @param[in] _pMapOutput 波マップと法線マップの書き込み先(nullptrなら書き込まない)
+	 * @return タイルのエネルギー(高さと速度の変化量の最大値)
+	 */
+	float StepTile(int _tileIndex, STEPROW_FUNC _pStepRow, STEPROW_MASK_FUNC _pStepRowMask, WORK_BUFFER* _pBuffer, const MAP_OUTPUT* _pMapOutput);
+
+	/**
+	 * タイル1つ分を作業領域で複数ステップ進める
+	 * @param[in] _tileIndex タイルのインデックス
+	 * @param[in] _stepNum 進めるステップ数
+	 * @param[in] _pStepRow 行更新関数
+	 * @param[in] _pStepRowMask 障害物マスク付きの行更新関数
+	 * @param[in] _pBuffer 作業領域
+	 * @return 最後のステップでのタイルのエネルギー
+	 */
+	float StepTileBlock(int _tileIndex, int _stepNum, STEPROW_FUNC _pStepRow, STEPROW_MASK_FUNC _pStepRowMask, WORK_BUFFER* _pBuffer);
+
+	/**
+	 * 読み込み側のバッファのタイルを書き込み側のバッファに複製する
+	 * @param[in] _tileIndex タイルのインデックス
+	 * @param[in] _pMapOutput 波マップと法線マップの書き込み先(nullptrなら書き込まない)
+	 */
+	void CopyTile(int _tileIndex, const MAP_OUTPUT* _pMapOutput);
+
+	/**
+	 * 1行分の波マップと法線マップを書き込む
+	 * @param[in] _x 書き込む先頭のセルのx座標
+	 * @param[in] _y 書き込む行
+	 * @param[in] _count 書き込む要素数
+	 * @param[in] _pHeight 法線を求める高さ配列
+	 * @param[in] _pNewHeight 波マップに書き込む高さ配列
+	 * @param[in] _pNewVelocity 波マップに書き込む速度配列
+	 * @param[in] _pMapOutput 書き込み先
+	 */
+	void WriteMapRow(int _x, int _y, int _count, const float* _pHeight, const float* _pNewHeight, const float* _pNewVelocity, const MAP_OUTPUT* _pMapOutput) const;
+
+	/**
+	 * 命令セットに対応した行更新関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 行更新関数
+	 */
+	static STEPROW_FUNC GetStepRowFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 命令セットに対応した障害物マスク付きの行更新関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 障害物マスク付きの行更新関数
+	 */
+	static STEPROW_MASK_FUNC GetStepRowMaskFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 命令セットに対応した波マップの書き込み関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 波マップの書き込み関数
+	 */
+	static WAVEMAPROW_FUNC GetWaveMapRowFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 命令セットに対応した法線マップの書き込み関数を取得
+	 * @param[in] _simdType 命令セット
+	 * @return 法線マップの書き込み関数
+	 */
+	static NORMALMAPROW_FUNC GetNormalMapRowFunc(CpuFeature::SIMD_TYPE _simdType);
+
+	/**
+	 * 1行分の更新(スカラー版)
+	 */
+	static float StepRowScalar(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower);
+
+	/**
+	 * 1行分の更新(SSE2版)
+	 */
+	static float StepRowSSE(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower);
+
+	/**
+	 * 1行分の更新(AVX2版)
+	 */
+	static float StepRowAVX2(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower);
+
+	/**
+	 * 1行分の更新(NEON版)
+	 */
+	static float StepRowNEON(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(スカラー版)
+	 */
+	static float StepRowMaskScalar(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(SSE2版)
+	 */
+	static float StepRowMaskSSE(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(AVX2版)
+	 */
+	static float StepRowMaskAVX2(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 障害物マスク付きの1行分の更新(NEON版)
+	 */
+	static float StepRowMaskNEON(
+		const float* _pUp, const float* _pCenter, const float* _pDown,
+		const float* _pVelocity, const float* _pAddVelocity,
+		float* _pOutHeight, float* _pOutVelocity, int _count, float _springPower,
+		const WaveObstacleMask::ROW_MASK& _mask);
+
+	/**
+	 * 1行分の波マップの書き込み(スカラー版)
+	 */
+	static void WaveMapRowScalar(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の波マップの書き込み(SSE2版)
+	 */
+	static void WaveMapRowSSE(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の波マップの書き込み(AVX2版)
+	 */
+	static void WaveMapRowAVX2(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の波マップの書き込み(NEON版)
+	 */
+	static void WaveMapRowNEON(const float* _pHeight, const float* _pVelocity, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(スカラー版)
+	 */
+	static void NormalMapRowScalar(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(SSE2版)
+	 */
+	static void NormalMapRowSSE(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(AVX2版)
+	 */
+	static void NormalMapRowAVX2(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count);
+
+	/**
+	 * 1行分の法線マップの書き込み(NEON版)
+	 */
+	static void NormalMapRowNEON(const float* _pUp, const float* _pCenter, const float* _pDown, unsigned char* _pOut, int _count);
+
+
+	int						m_Width;				//!< 波マップの幅.
+	int						m_Height;				//!< 波マップの高さ.
+	int						m_Stride;				//!< 1行分の要素数(外周を含む).
+	float					m_SpringPower;			//!< ばねの強さ.
+	CpuFeature::SIMD_TYPE	m_SimdType;				//!< 使用する命令セット.
+	PRECISION				m_Precision;			//!< 計算精度.
+	FixedWaveSolver			m_FixedSolver;			//!< 固定小数点で計算する場合の計算クラス.
+
+	std::vector<float>		m_WaveHeight[2];		//!< 高さ配列(ダブルバッファ).
+	std::vector<float>		m_WaveVelocity[2];		//!< 速度配列(ダブルバッファ).
+	int						m_ReadIndex;			//!< 読み込み側のバッファインデックス.
+
+	ThreadPool*				m_pThreadPool;			//!< 更新に使用するスレッドプール.
+	int						m_TileWidth;			//!< タイルの幅.
+	int						m_TileHeight;			//!< タイルの高さ.
+	int						m_TileNumX;				//!< 横方向のタイル数.
+	int						m_TileNumY;				//!< 縦方向のタイル数.
+	int						m_BlockStepNum;			//!< 時間ブロッキングで1度に進めるステップ数.
+	std::vector<WORK_BUFFER>	m_WorkBuffer;		//!< スレッドごとの作業領域.
+
+	bool					m_IsSparse;				//!< 活動しているタイルだけを更新するか.
+	float					m_SleepThreshold;		//!< タイルを休止させるしきい値.
+	std::vector<unsigned char>	m_IsTileActive;		//!< タイルが活動しているか.
+	std::vector<unsigned char>	m_IsTileWake;		//!< 波が追加されたタイルか.
+	std::vector<unsigned char>	m_IsTileStep;		//!< 現在のステップで更新するタイルか.
+	std::vector<unsigned char>	m_IsTileSync;		//!< 休止前にバッファをそろえる必要があるタイルか.
+	std::vector<float>		m_TileEnergy;			//!< タイルのエネルギー.
+	std::vector<int>		m_StepTileList;			//!< 現在のステップで処理するタイル.
+	int						m_ActiveTileNum;		//!< 直前のステップで更新したタイル数.
+	double					m_TotalActiveTileRatio;	//!< 更新したタイルの割合の合計.
+	int						m_CounterStepNum;		//!< 割合を計測したステップ数.
+
+	WaveImpulseQueue		m_ImpulseQueue;			//!< 内部で使用する追加する波のキュー.
+	WaveImpulseQueue*		m_pImpulseQueue;		//!< 追加する波を受け付けるキュー.
+	std::vector<WaveImpulseQueue::IMPULSE>	m_Impulse;	//!< 現在のステップで追加する波.
+	std::vector<IMPULSE_RECT>	m_ImpulseRect;		//!< 追加する波がかかるセルの範囲.
+	std::vector<int>		m_TileImpulseStart;		//!< タイルごとに振り分けた波の開始位置(タイル数+1個).
+	std::vector<int>		m_TileImpulseCursor;	//!< 振り分け中の書き込み位置.
+	std::vector<int>		m_TileImpulseIndex;		//!< タイルごとに振り分けた波のインデックス.
+	std::vector<float>		m_ZeroRow;				//!< 加算しない行に渡す0の配列.
+
+	const WaveObstacleMask*	m_pObstacleMask;		//!< 障害物マスク.
+	std::vector<unsigned char>	m_IsTileObstacle;	//!< 更新範囲に障害物があるタイルか.
+
+	WaveQuery				m_Query;				//!< 高さと法線の取得処理.
+	bool					m_IsFixedQuerySync;		//!< 固定小数点の高さを高さ配列に書き戻したか.
+
+};
+
+
+#endif // !WAVESIMULATOR_H
@@ -0,0 +1,445 @@
+﻿/**
+ * @file	WaveSnapshot.cpp
+ * @brief	波の状態のスナップショットファイルクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaveSnapshot.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // !NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const unsigned int WaveSnapshot::m_Version = 1;
+const unsigned int WaveSnapshot::m_PlaneAlignment = 64;
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const char WaveSnapshot::m_Magic[4] = { 'W', 'V', 'S', 'N' };
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+WaveSnapshot::WaveSnapshot() :
+	m_pView(nullptr),
+	m_ViewSize(0),
+	m_Width(0),
+	m_Height(0),
+	m_Encoding(ENCODING_RAW)
+{
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		m_PlaneOffset[i] = 0;
+		m_PlaneSize[i] = 0;
+		m_PlaneChecksum[i] = 0;
+	}
+}
+
+WaveSnapshot::~WaveSnapshot()
+{
+	Close();
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool WaveSnapshot::Open(const char* _pFileName)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE File = CreateFileA(_pFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart < static_cast<LONGLONG>(sizeof(HEADER)))
+	{
+		CloseHandle(File);
+		return false;
+	}
+
+	// ビューはハンドルを閉じても解放するまで有効.
+	HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(File);
+	if (Mapping == nullptr)
+	{
+		return false;
+	}
+
+	m_pView = static_cast<const unsigned char*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+	CloseHandle(Mapping);
+	m_ViewSize = static_cast<size_t>(FileSize.QuadPart);
+#else
+	int File = open(_pFileName, O_RDONLY);
+	if (File < 0)
+	{
+		return false;
+	}
+
+	struct stat FileStat;
+	if (fstat(File, &FileStat) != 0 || FileStat.st_size < static_cast<off_t>(sizeof(HEADER)))
+	{
+		close(File);
+		return false;
+	}
+
+	// マップした領域はファイルを閉じても解放するまで有効.
+	void* pView = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+	close(File);
+	m_pView = pView != MAP_FAILED ? static_cast<const unsigned char*>(pView) : nullptr;
+	m_ViewSize = static_cast<size_t>(FileStat.st_size);
+#endif // _WIN32
+
+	if (m_pView == nullptr)
+	{
+		m_ViewSize = 0;
+		return false;
+	}
+
+	HEADER Header;
+	memcpy(&Header, m_pView, sizeof(HEADER));
+
+	if (memcmp(Header.Magic, m_Magic, sizeof(m_Magic)) != 0 ||
+		Header.Version != m_Version ||
+		Header.HeaderSize != sizeof(HEADER) ||
+		Header.Width <= 0 || Header.Height <= 0 ||
+		Header.Width > 0x8000 || Header.Height > 0x8000 ||
+		(Header.Encoding != ENCODING_RAW && Header.Encoding != ENCODING_DELTA))
+	{
+		Close();
+		return false;
+	}
+
+	size_t RawPlaneSize = static_cast<size_t>(Header.Width) * Header.Height * sizeof(float);
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		// 面はヘッダの後ろでファイルに収まっている必要がある.
+		if (Header.PlaneOffset[i] < sizeof(HEADER) ||
+			Header.PlaneOffset[i] > m_ViewSize ||
+			Header.PlaneSize[i] > m_ViewSize - Header.PlaneOffset[i])
+		{
+			Close();
+			return false;
+		}
+
+		// そのまま配列として使うので大きさとアライメントも検証する.
+		if (Header.Encoding == ENCODING_RAW &&
+			(Header.PlaneSize[i] != RawPlaneSize || Header.PlaneOffset[i] % m_PlaneAlignment != 0))
+		{
+			Close();
+			return false;
+		}
+
+		m_PlaneOffset[i] = Header.PlaneOffset[i];
+		m_PlaneSize[i] = Header.PlaneSize[i];
+		m_PlaneChecksum[i] = Header.PlaneChecksum[i];
+	}
+
+	m_Width = Header.Width;
+	m_Height = Header.Height;
+	m_Encoding = static_cast<ENCODING>(Header.Encoding);
+
+	return true;
+}
+
+void WaveSnapshot::Close()
+{
+	if (m_pView != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pView);
+#else
+		munmap(const_cast<unsigned char*>(m_pView), m_ViewSize);
+#endif // _WIN32
+	}
+
+	m_pView = nullptr;
+	m_ViewSize = 0;
+	m_Width = 0;
+	m_Height = 0;
+	m_Encoding = ENCODING_RAW;
+
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		m_PlaneOffset[i] = 0;
+		m_PlaneSize[i] = 0;
+		m_PlaneChecksum[i] = 0;
+	}
+}
+
+const float* WaveSnapshot::GetRawPlane(PLANE _plane) const
+{
+	if (m_pView == nullptr || m_Encoding != ENCODING_RAW)
+	{
+		return nullptr;
+	}
+
+	return reinterpret_cast<const float*>(m_pView + m_PlaneOffset[_plane]);
+}
+
+bool WaveSnapshot::Read(float* _pHeight, float* _pVelocity, int _stride) const
+{
+	if (m_pView == nullptr || _stride < m_Width)
+	{
+		return false;
+	}
+
+	float* pOut[PLANE_NUM] = { _pHeight, _pVelocity };
+
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		const unsigned char* pPlane = m_pView + m_PlaneOffset[i];
+		if (Checksum(pPlane, m_PlaneSize[i]) != m_PlaneChecksum[i])
+		{
+			return false;
+		}
+
+		if (m_Encoding == ENCODING_RAW)
+		{
+			const float* pValue = reinterpret_cast<const float*>(pPlane);
+			for (int y = 0; y < m_Height; y++)
+			{
+				memcpy(pOut[i] + static_cast<size_t>(y) * _stride, pValue + static_cast<size_t>(y) * m_Width, sizeof(float) * m_Width);
+			}
+		}
+		else if (!DecodeDelta(pPlane, m_PlaneSize[i], m_Width, m_Height, pOut[i], _stride))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//----------------------------------------------------------------------
+// Static Public Functions
+//----------------------------------------------------------------------
+bool WaveSnapshot::Write(
+	const char* _pFileName,
+	int _width,
+	int _height,
+	const float* _pHeight,
+	const float* _pVelocity,
+	int _stride,
+	ENCODING _encoding)
+{
+	if (_width <= 0 || _height <= 0 || _stride < _width)
+	{
+		return false;
+	}
+
+	const float* pPlane[PLANE_NUM] = { _pHeight, _pVelocity };
+	std::vector<unsigned char> PlaneData[PLANE_NUM];
+
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		if (_encoding == ENCODING_RAW)
+		{
+			PlaneData[i].resize(static_cast<size_t>(_width) * _height * sizeof(float));
+			for (int y = 0; y < _height; y++)
+			{
+				memcpy(&PlaneData[i][static_cast<size_t>(y) * _width * sizeof(float)], pPlane[i] + static_cast<size_t>(y) * _stride, sizeof(float) * _width);
+			}
+		}
+		else
+		{
+			EncodeDelta(pPlane[i], _width, _height, _stride, &PlaneData[i]);
+		}
+	}
+
+	HEADER Header;
+	memset(&Header, 0, sizeof(HEADER));
+	memcpy(Header.Magic, m_Magic, sizeof(m_Magic));
+	Header.Version = m_Version;
+	Header.HeaderSize = sizeof(HEADER);
+	Header.Width = _width;
+	Header.Height = _height;
+	Header.Encoding = _encoding;
+
+	size_t Offset = sizeof(HEADER);
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		Offset = (Offset + m_PlaneAlignment - 1) / m_PlaneAlignment * m_PlaneAlignment;
+		if (Offset + PlaneData[i].size() > 0xffffffffu)
+		{
+			return false;
+		}
+
+		Header.PlaneOffset[i] = static_cast<unsigned int>(Offset);
+		Header.PlaneSize[i] = static_cast<unsigned int>(PlaneData[i].size());
+		Header.PlaneChecksum[i] = PlaneData[i].empty() ? Checksum(nullptr, 0) : Checksum(&PlaneData[i][0], PlaneData[i].size());
+		Offset += PlaneData[i].size();
+	}
+
+	std::ofstream File(_pFileName, std::ios::binary | std::ios::trunc);
+	if (!File)
+	{
+		return false;
+	}
+
+	const char Padding[64] = {};
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(HEADER));
+	Offset = sizeof(HEADER);
+
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		File.write(Padding, Header.PlaneOffset[i] - Offset);
+		if (!PlaneData[i].empty())
+		{
+			File.write(reinterpret_cast<const char*>(&PlaneData[i][0]), PlaneData[i].size());
+		}
+
+		Offset = Header.PlaneOffset[i] + PlaneData[i].size();
+	}
+
+	return static_cast<bool>(File);
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+void WaveSnapshot::EncodeDelta(const float* _pValue, int _width, int _height, int _stride, std::vector<unsigned char>* _pOut)
+{
+	// 最初のセルは0との差分になる.
+	unsigned int RowPrev = 0;
+
+	for (int y = 0; y < _height; y++)
+	{
+		const float* pRow = _pValue + static_cast<size_t>(y) * _stride;
+		unsigned int Prev = RowPrev;
+
+		for (int x = 0; x < _width; x++)
+		{
+			unsigned int Bits = ToOrderedBits(pRow[x]);
+
+			// 差分を符号付きとして扱い, 0に近いほど小さな値になるようにしてから7bitずつ書き込む.
+			int Delta = static_cast<int>(Bits - Prev);
+			unsigned int Code = (static_cast<unsigned int>(Delta) << 1) ^ static_cast<unsigned int>(Delta >> 31);
+			while (Code >= 0x80)
+			{
+				_pOut->push_back(static_cast<unsigned char>(Code | 0x80));
+				Code >>= 7;
+			}
+			_pOut->push_back(static_cast<unsigned char>(Code));
+
+			Prev = Bits;
+			if (x == 0)
+			{
+				RowPrev = Bits;
+			}
+		}
+	}
+}
+
+bool WaveSnapshot::DecodeDelta(const unsigned char* _pData, size_t _size, int _width, int _height, float* _pValue, int _stride)
+{
+	const unsigned char* pCurrent = _pData;
+	const unsigned char* pEnd = _pData + _size;
+	unsigned int RowPrev = 0;
+
+	for (int y = 0; y < _height; y++)
+	{
+		float* pRow = _pValue + static_cast<size_t>(y) * _stride;
+		unsigned int Prev = RowPrev;
+
+		for (int x = 0; x < _width; x++)
+		{
+			unsigned int Code = 0;
+			int Shift = 0;
+			for (;;)
+			{
+				if (pCurrent == pEnd || Shift > 28)
+				{
+					return false;
+				}
+
+				unsigned char Byte = *pCurrent++;
+				Code |= static_cast<unsigned int>(Byte & 0x7f) << Shift;
+				Shift += 7;
+
+				if ((Byte & 0x80) == 0)
+				{
+					break;
+				}
+			}
+
+			unsigned int Bits = Prev + ((Code >> 1) ^ (0u - (Code & 1)));
+			pRow[x] = FromOrderedBits(Bits);
+
+			Prev = Bits;
+			if (x == 0)
+			{
+				RowPrev = Bits;
+			}
+		}
+	}
+
+	return pCurrent == pEnd;
+}
+
+unsigned int WaveSnapshot::Checksum(const unsigned char* _pData, size_t _size)
+{
+	// FNV-1aを4バイト単位で計算し, 端数はバイト単位で計算する.
+	unsigned int Hash = 2166136261u;
+	size_t WordNum = _size / 4;
+
+	for (size_t i = 0; i < WordNum; i++)
+	{
+		unsigned int Word;
+		memcpy(&Word, _pData + i * 4, sizeof(Word));
+		Hash = (Hash ^ Word) * 16777619u;
+	}
+
+	for (size_t i = WordNum * 4; i < _size; i++)
+	{
+		Hash = (Hash ^ _pData[i]) * 16777619u;
+	}
+
+	return Hash;
+}
+
+unsigned int WaveSnapshot::ToOrderedBits(float _value)
+{
+	unsigned int Bits;
+	memcpy(&Bits, &_value, sizeof(Bits));
+
+	// 負の値は全ビットを反転し, 正の値は符号ビットを立てると整数の大小がfloatの大小と一致する.
+	return (Bits & 0x80000000u) != 0 ? ~Bits : (Bits | 0x80000000u);
+}
+
+float WaveSnapshot::FromOrderedBits(unsigned int _bits)
+{
+	unsigned int Bits = (_bits & 0x80000000u) != 0 ? (_bits & 0x7fffffffu) : ~_bits;
+
+	float Value;
+	memcpy(&Value, &Bits, sizeof(Value));
+
+	return Value;
+}
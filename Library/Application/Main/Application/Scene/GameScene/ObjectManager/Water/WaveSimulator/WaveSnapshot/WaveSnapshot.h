@@ -0,0 +1,229 @@
+﻿/**
+ * @file	WaveSnapshot.h
+ * @brief	波の状態のスナップショットファイルクラス定義
+ * @author	morimoto
+ */
+#ifndef WAVESNAPSHOT_H
+#define WAVESNAPSHOT_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * 波の状態のスナップショットファイルクラス
+ *
+ * 波マップの高さと速度をバイナリファイルに保存し, 読み込み時はファイルをメモリにマップして参照する.
+ * ファイルは固定長のヘッダと高さ, 速度の2つの面で構成され, 各面はヘッダに書かれたオフセットから始まる.
+ *
+ * ENCODING_RAWの面はfloatの配列をそのまま格納し, 面の先頭をm_PlaneAlignmentバイトにそろえるので,
+ * マップしたメモリをGetRawPlaneでそのまま配列として使える(開く処理はファイルサイズによらない).
+ * ENCODING_DELTAの面は各セルを左隣(行の先頭は1つ上の行の先頭)との差分にして可変長で格納する.
+ * 差分はfloatのビット列を大小関係を保つ整数に変換してから取るので可逆で,
+ * 落ち着いた水面のようにほぼ一様な波マップは1セルあたり1バイト程度になる.
+ *
+ * 各面にはチェックサムを持たせ, Readで検証する(GetRawPlaneでは検証しない).
+ * バイト順はリトルエンディアンのみ扱う.
+ */
+class WaveSnapshot
+{
+public:
+	/**
+	 * 面の格納形式の列挙子
+	 */
+	enum ENCODING
+	{
+		ENCODING_RAW,	//!< floatの配列をそのまま格納する.
+		ENCODING_DELTA	//!< 隣のセルとの差分を可変長で格納する.
+	};
+
+	/**
+	 * 面の種類の列挙子
+	 */
+	enum PLANE
+	{
+		PLANE_HEIGHT,	//!< 高さ.
+		PLANE_VELOCITY,	//!< 速度.
+		PLANE_NUM		//!< 面の数.
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	WaveSnapshot();
+
+	/**
+	 * デストラクタ
+	 */
+	~WaveSnapshot();
+
+	/**
+	 * ファイルを開いてメモリにマップする
+	 *
+	 * ヘッダと面の範囲を検証し, 不正なファイルであれば失敗する.
+	 * @param[in] _pFileName 開くファイル名
+	 * @return 開くことに成功したらtrue 失敗したらfalse
+	 */
+	bool Open(const char* _pFileName);
+
+	/**
+	 * ファイルを閉じる
+	 */
+	void Close();
+
+	/**
+	 * ファイルを開いているかを取得
+	 * @return ファイルを開いていればtrue
+	 */
+	bool IsOpen() const
+	{
+		return m_pView != nullptr;
+	}
+
+	/**
+	 * 波マップの幅を取得
+	 * @return 波マップの幅
+	 */
+	int GetWidth() const
+	{
+		return m_Width;
+	}
+
+	/**
+	 * 波マップの高さを取得
+	 * @return 波マップの高さ
+	 */
+	int GetHeight() const
+	{
+		return m_Height;
+	}
+
+	/**
+	 * 面の格納形式を取得
+	 * @return 格納形式
+	 */
+	ENCODING GetEncoding() const
+	{
+		return m_Encoding;
+	}
+
+	/**
+	 * マップしたメモリ上の面を配列として取得
+	 * @param[in] _plane 面の種類
+	 * @return 面の配列(幅x高さ, 行優先) ENCODING_RAWでなければnullptr
+	 */
+	const float* GetRawPlane(PLANE _plane) const;
+
+	/**
+	 * 高さと速度を読み込む
+	 * @param[out] _pHeight 高さの書き込み先
+	 * @param[out] _pVelocity 速度の書き込み先
+	 * @param[in] _stride 書き込み先の1行分の要素数
+	 * @return 読み込みに成功したらtrue 失敗したらfalse
+	 */
+	bool Read(float* _pHeight, float* _pVelocity, int _stride) const;
+
+	/**
+	 * 高さと速度をファイルに書き込む
+	 * @param[in] _pFileName 書き込むファイル名
+	 * @param[in] _width 波マップの幅
+	 * @param[in] _height 波マップの高さ
+	 * @param[in] _pHeight 高さ
+	 * @param[in] _pVelocity 速度
+	 * @param[in] _stride 1行分の要素数
+	 * @param[in] _encoding 面の格納形式
+	 * @return 書き込みに成功したらtrue 失敗したらfalse
+	 */
+	static bool Write(
+		const char* _pFileName,
+		int _width,
+		int _height,
+		const float* _pHeight,
+		const float* _pVelocity,
+		int _stride,
+		ENCODING _encoding);
+
+	static const unsigned int m_Version;		//!< ファイル形式のバージョン.
+	static const unsigned int m_PlaneAlignment;	//!< 面の先頭のアライメント(バイト).
+
+private:
+	/**
+	 * ファイルのヘッダ構造体
+	 */
+	struct HEADER
+	{
+		char			Magic[4];				//!< 識別子("WVSN").
+		unsigned int	Version;				//!< ファイル形式のバージョン.
+		unsigned int	HeaderSize;				//!< ヘッダのバイト数.
+		int				Width;					//!< 波マップの幅.
+		int				Height;					//!< 波マップの高さ.
+		unsigned int	Encoding;				//!< 面の格納形式.
+		unsigned int	PlaneOffset[PLANE_NUM];	//!< ファイル先頭から面までのバイト数.
+		unsigned int	PlaneSize[PLANE_NUM];	//!< 面のバイト数.
+		unsigned int	PlaneChecksum[PLANE_NUM];	//!< 面のチェックサム.
+		unsigned int	Reserved[4];			//!< 予約領域(0).
+	};
+
+	/**
+	 * 1つの面を差分の可変長形式に変換する
+	 * @param[in] _pValue 面の値
+	 * @param[in] _width 幅
+	 * @param[in] _height 高さ
+	 * @param[in] _stride 1行分の要素数
+	 * @param[out] _pOut 出力先(末尾に追加する)
+	 */
+	static void EncodeDelta(const float* _pValue, int _width, int _height, int _stride, std::vector<unsigned char>* _pOut);
+
+	/**
+	 * 差分の可変長形式の面を展開する
+	 * @param[in] _pData 面のデータ
+	 * @param[in] _size 面のバイト数
+	 * @param[in] _width 幅
+	 * @param[in] _height 高さ
+	 * @param[out] _pValue 展開先
+	 * @param[in] _stride 展開先の1行分の要素数
+	 * @return 展開に成功したらtrue データが壊れていればfalse
+	 */
+	static bool DecodeDelta(const unsigned char* _pData, size_t _size, int _width, int _height, float* _pValue, int _stride);
+
+	/**
+	 * チェックサムを計算
+	 * @param[in] _pData データ
+	 * @param[in] _size データのバイト数
+	 * @return チェックサム
+	 */
+	static unsigned int Checksum(const unsigned char* _pData, size_t _size);
+
+	/**
+	 * floatのビット列を大小関係を保つ整数に変換する
+	 * @param[in] _value 変換する値
+	 * @return 変換後の整数
+	 */
+	static unsigned int ToOrderedBits(float _value);
+
+	/**
+	 * ToOrderedBitsで変換した整数をfloatに戻す
+	 * @param[in] _bits 変換した整数
+	 * @return 元の値
+	 */
+	static float FromOrderedBits(unsigned int _bits);
+
+
+	static const char m_Magic[4];	//!< ファイルの識別子.
+
+	const unsigned char*	m_pView;		//!< マップしたファイルの先頭.
+	size_t					m_ViewSize;		//!< マップしたファイルのバイト数.
+	int						m_Width;		//!< 波マップの幅.
+	int						m_Height;		//!< 波マップの高さ.
+	ENCODING				m_Encoding;		//!< 面の格納形式.
+	unsigned int			m_PlaneOffset[PLANE_NUM];	//!< ファイル先頭から面までのバイト数.
+	unsigned int			m_PlaneSize[PLANE_NUM];		//!< 面のバイト数.
+	unsigned int			m_PlaneChecksum[PLANE_NUM];	//!< 面のチェックサム.
+
+};
+
+
+#endif // !WAVESNAPSHOT_H
@@ -0,0 +1,109 @@
+﻿/**
+ * @file	CubeFaceCuller.cpp
+ * @brief	キューブマップの面ごとのカリングクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "CubeFaceCuller.h"
+
+#include <cmath>
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const float CubeFaceCuller::m_FaceDir[FACE_NUM][3] =
+{
+	{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+};
+
+const float CubeFaceCuller::m_FaceUp[FACE_NUM][3] =
+{
+	{ 0, 1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 0 }
+};
+
+const float CubeFaceCuller::m_FaceRight[FACE_NUM][3] =
+{
+	{ 0, 0, -1 }, { 0, 0, 1 }, { 1, 0, 0 }, { 1, 0, 0 }, { 1, 0, 0 }, { -1, 0, 0 }
+};
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+CubeFaceCuller::CubeFaceCuller() :
+	m_FarClip(0.0f)
+{
+	m_Origin[0] = 0.0f;
+	m_Origin[1] = 0.0f;
+	m_Origin[2] = 0.0f;
+}
+
+CubeFaceCuller::~CubeFaceCuller()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void CubeFaceCuller::SetOrigin(float _x, float _y, float _z)
+{
+	m_Origin[0] = _x;
+	m_Origin[1] = _y;
+	m_Origin[2] = _z;
+}
+
+unsigned int CubeFaceCuller::GetSphereFaceMask(float _x, float _y, float _z, float _radius) const
+{
+	// 画角90度の面の視錐台は, 面の向きaと上方向u, 横方向rに対して|p・u| <= p・a, |p・r| <= p・aとなる範囲なので,
+	// 側面は(a ± u) / √2, (a ± r) / √2を法線とする4つの平面になる.
+	const float InvSqrt2 = 0.70710678f;
+
+	float X = _x - m_Origin[0];
+	float Y = _y - m_Origin[1];
+	float Z = _z - m_Origin[2];
+
+	// 球が原点を含んでいれば全ての面に写る.
+	if (X * X + Y * Y + Z * Z <= _radius * _radius)
+	{
+		return ALL_FACE_MASK;
+	}
+
+	unsigned int FaceMask = 0;
+	for (int i = 0; i < FACE_NUM; i++)
+	{
+		float Forward = X * m_FaceDir[i][0] + Y * m_FaceDir[i][1] + Z * m_FaceDir[i][2];
+		float Vertical = X * m_FaceUp[i][0] + Y * m_FaceUp[i][1] + Z * m_FaceUp[i][2];
+		float Horizontal = X * m_FaceRight[i][0] + Y * m_FaceRight[i][1] + Z * m_FaceRight[i][2];
+
+		// 4つの平面のどれかの外側に半径以上離れていれば写らない.
+		if ((Forward - std::fabs(Vertical)) * InvSqrt2 < -_radius ||
+			(Forward - std::fabs(Horizontal)) * InvSqrt2 < -_radius)
+		{
+			continue;
+		}
+
+		// 遠クリップ面より奥に半径以上離れていれば写らない.
+		if (m_FarClip > 0.0f && Forward - m_FarClip > _radius)
+		{
+			continue;
+		}
+
+		FaceMask |= 1u << i;
+	}
+
+	return FaceMask;
+}
+
+void CubeFaceCuller::GetSphereFaceMasks(const float* _pSpheres, int _sphereNum, unsigned int* _pFaceMasks) const
+{
+	for (int i = 0; i < _sphereNum; i++)
+	{
+		const float* pSphere = &_pSpheres[i * 4];
+		_pFaceMasks[i] = GetSphereFaceMask(pSphere[0], pSphere[1], pSphere[2], pSphere[3]);
+	}
+}
@@ -0,0 +1,85 @@
+﻿/**
+ * @file	CubeFaceCuller.h
+ * @brief	キューブマップの面ごとのカリングクラス定義
+ * @author	morimoto
+ */
+#ifndef CUBEFACECULLER_H
+#define CUBEFACECULLER_H
+
+
+/**
+ * キューブマップの面ごとのカリングクラス
+ *
+ * キューブマップを描画する位置から見た6面の視錐台(画角90度)に対して境界球を判定し,
+ * 球が写る面のビットマスクを求める.
+ * オブジェクトをこのマスクの面だけに描画すれば, ジオメトリシェーダーで全ての面に複製する必要がなくなる.
+ *
+ * 面の順番はD3D11のキューブマップの配列の順番(+X, -X, +Y, -Y, +Z, -Z)で, ビットiが面iになる.
+ * 判定は保守的で, 写る可能性のある面は必ずマスクに含まれる(近クリップ面は判定しない).
+ */
+class CubeFaceCuller
+{
+public:
+	enum
+	{
+		FACE_NUM = 6,						//!< キューブマップの面の数.
+		ALL_FACE_MASK = (1 << FACE_NUM) - 1	//!< 全ての面のビットマスク.
+	};
+
+	/**
+	 * コンストラクタ
+	 */
+	CubeFaceCuller();
+
+	/**
+	 * デストラクタ
+	 */
+	~CubeFaceCuller();
+
+	/**
+	 * キューブマップを描画する位置を設定
+	 * @param[in] _x 位置のx
+	 * @param[in] _y 位置のy
+	 * @param[in] _z 位置のz
+	 */
+	void SetOrigin(float _x, float _y, float _z);
+
+	/**
+	 * 遠クリップ面までの距離を設定
+	 * @param[in] _farClip 遠クリップ面までの距離(0以下なら判定しない)
+	 */
+	void SetFarClip(float _farClip)
+	{
+		m_FarClip = _farClip;
+	}
+
+	/**
+	 * 球が写る面のビットマスクを取得
+	 * @param[in] _x 球の中心のx
+	 * @param[in] _y 球の中心のy
+	 * @param[in] _z 球の中心のz
+	 * @param[in] _radius 球の半径
+	 * @return 球が写る面のビットマスク
+	 */
+	unsigned int GetSphereFaceMask(float _x, float _y, float _z, float _radius) const;
+
+	/**
+	 * 複数の球が写る面のビットマスクをまとめて取得
+	 * @param[in] _pSpheres 球の配列(中心x, y, z, 半径の4要素ずつ)
+	 * @param[in] _sphereNum 球の数
+	 * @param[out] _pFaceMasks 球ごとのビットマスクの出力先
+	 */
+	void GetSphereFaceMasks(const float* _pSpheres, int _sphereNum, unsigned int* _pFaceMasks) const;
+
+private:
+	static const float m_FaceDir[FACE_NUM][3];		//!< 面の向き.
+	static const float m_FaceUp[FACE_NUM][3];		//!< 面の上方向.
+	static const float m_FaceRight[FACE_NUM][3];	//!< 面の横方向.
+
+	float	m_Origin[3];	//!< キューブマップを描画する位置.
+	float	m_FarClip;		//!< 遠クリップ面までの距離.
+
+};
+
+
+#endif // !CUBEFACECULLER_H
@@ -10,13 +10,21 @@
 #include "CubeMapDrawTask.h"
 
 #include "Main\Object3DBase\Object3DBase.h"
+#include "CubeFaceCuller\CubeFaceCuller.h"
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+unsigned int CubeMapDrawTask::m_FrameFaceMask = CubeFaceCuller::ALL_FACE_MASK;
 
 
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
 CubeMapDrawTask::CubeMapDrawTask() : 
-	m_pObject(nullptr)
+	m_pObject(nullptr),
+	m_FaceMask(CubeFaceCuller::ALL_FACE_MASK)
 {
 }
 
@@ -30,6 +38,12 @@ CubeMapDrawTask::~CubeMapDrawTask()
 //----------------------------------------------------------------------
 void CubeMapDrawTask::Run()
 {
+	// このフレームで描画する面に写らなければ描画しない.
+	if ((m_FaceMask & m_FrameFaceMask) == 0)
+	{
+		return;
+	}
+
 	m_pObject->CubeMapDraw();
 }
 
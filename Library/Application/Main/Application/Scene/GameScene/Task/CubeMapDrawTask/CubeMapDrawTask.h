@@ -43,8 +43,40 @@ public:
 	 */
 	void SetObject(Object3DBase* _pObject);
 
+	/**
+	 * オブジェクトが写るキューブマップの面を設定
+	 * @param[in] _faceMask 写る面のビットマスク(CubeFaceCullerで求める)
+	 */
+	void SetFaceMask(unsigned int _faceMask)
+	{
+		m_FaceMask = _faceMask;
+	}
+
+	/**
+	 * オブジェクトが写るキューブマップの面を取得
+	 * @return 写る面のビットマスク
+	 */
+	unsigned int GetFaceMask() const
+	{
+		return m_FaceMask;
+	}
+
+	/**
+	 * このフレームで描画するキューブマップの面を設定
+	 *
+	 * 写る面がこのマスクと重ならないオブジェクトは描画しない.
+	 * @param[in] _frameFaceMask このフレームで描画する面のビットマスク
+	 */
+	static void SetFrameFaceMask(unsigned int _frameFaceMask)
+	{
+		m_FrameFaceMask = _frameFaceMask;
+	}
+
 private:
-	Object3DBase* m_pObject;	//!< 描画を行うオブジェクト.
+	static unsigned int m_FrameFaceMask;	//!< このフレームで描画する面のビットマスク.
+
+	Object3DBase*	m_pObject;		//!< 描画を行うオブジェクト.
+	unsigned int	m_FaceMask;		//!< オブジェクトが写る面のビットマスク.
 
 };
 
@@ -0,0 +1,113 @@
+﻿/**
+ * @file	ReflectFrustumCuller.cpp
+ * @brief	反射カメラの視錐台カリングクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "ReflectFrustumCuller.h"
+
+#include <cmath>
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+ReflectFrustumCuller::ReflectFrustumCuller() :
+	m_WaterHeight(0.0f)
+{
+	// 行列が設定されるまでは何も除外しない.
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		m_Plane[i][0] = 0.0f;
+		m_Plane[i][1] = 0.0f;
+		m_Plane[i][2] = 0.0f;
+		m_Plane[i][3] = 1.0f;
+	}
+}
+
+ReflectFrustumCuller::~ReflectFrustumCuller()
+{
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+void ReflectFrustumCuller::SetViewProjection(const float* _pViewProj)
+{
+	// 行列の列j(M[0][j]～M[3][j])をCjとすると, クリップ座標の各要素はp・Cjになる.
+	// -w <= x <= w, -w <= y <= w, 0 <= z <= wの各不等式がそのまま平面になる.
+	const float* M = _pViewProj;
+	for (int i = 0; i < 4; i++)
+	{
+		float Column0 = M[i * 4 + 0];
+		float Column1 = M[i * 4 + 1];
+		float Column2 = M[i * 4 + 2];
+		float Column3 = M[i * 4 + 3];
+
+		m_Plane[0][i] = Column3 + Column0;	// 左.
+		m_Plane[1][i] = Column3 - Column0;	// 右.
+		m_Plane[2][i] = Column3 + Column1;	// 下.
+		m_Plane[3][i] = Column3 - Column1;	// 上.
+		m_Plane[4][i] = Column2;			// 近.
+		m_Plane[5][i] = Column3 - Column2;	// 遠.
+	}
+
+	// 距離を比べられるように法線を正規化する.
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		float Length = std::sqrt(
+			m_Plane[i][0] * m_Plane[i][0] +
+			m_Plane[i][1] * m_Plane[i][1] +
+			m_Plane[i][2] * m_Plane[i][2]);
+
+		if (Length > 0.0f)
+		{
+			float InvLength = 1.0f / Length;
+			m_Plane[i][0] *= InvLength;
+			m_Plane[i][1] *= InvLength;
+			m_Plane[i][2] *= InvLength;
+			m_Plane[i][3] *= InvLength;
+		}
+	}
+}
+
+bool ReflectFrustumCuller::IsVisible(float _x, float _y, float _z, float _radius) const
+{
+	// 水面より完全に下にあれば反射しない.
+	if (_y + _radius < m_WaterHeight)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < PLANE_NUM; i++)
+	{
+		float Distance = m_Plane[i][0] * _x + m_Plane[i][1] * _y + m_Plane[i][2] * _z + m_Plane[i][3];
+		if (Distance < -_radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int ReflectFrustumCuller::CullSpheres(const float* _pSpheres, int _sphereNum, bool* _pIsVisible) const
+{
+	int VisibleNum = 0;
+	for (int i = 0; i < _sphereNum; i++)
+	{
+		const float* pSphere = &_pSpheres[i * 4];
+		_pIsVisible[i] = IsVisible(pSphere[0], pSphere[1], pSphere[2], pSphere[3]);
+
+		if (_pIsVisible[i])
+		{
+			VisibleNum++;
+		}
+	}
+
+	return VisibleNum;
+}
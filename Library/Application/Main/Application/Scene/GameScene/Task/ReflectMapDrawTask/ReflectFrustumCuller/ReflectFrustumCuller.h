@@ -0,0 +1,78 @@
+﻿/**
+ * @file	ReflectFrustumCuller.h
+ * @brief	反射カメラの視錐台カリングクラス定義
+ * @author	morimoto
+ */
+#ifndef REFLECTFRUSTUMCULLER_H
+#define REFLECTFRUSTUMCULLER_H
+
+
+/**
+ * 反射カメラの視錐台カリングクラス
+ *
+ * 水面で反転させたカメラのビュー行列とプロジェクション行列を掛けた行列から視錐台の6平面を取り出し,
+ * 境界球が視錐台の外にあるか, 水面より完全に下にあるオブジェクトを反射マップに描画しないようにする.
+ *
+ * 行列はD3DXと同じ行優先の行ベクトル形式(クリップ座標 = [x y z 1] * M)で, 深度はD3Dと同じ0～wの範囲とする.
+ * 判定は保守的で, 視錐台の角の近くでは写らない球を残すことがある.
+ */
+class ReflectFrustumCuller
+{
+public:
+	/**
+	 * コンストラクタ
+	 */
+	ReflectFrustumCuller();
+
+	/**
+	 * デストラクタ
+	 */
+	~ReflectFrustumCuller();
+
+	/**
+	 * 反射カメラのビュー行列とプロジェクション行列を掛けた行列を設定
+	 * @param[in] _pViewProj 4x4の行列(16要素, 行優先)
+	 */
+	void SetViewProjection(const float* _pViewProj);
+
+	/**
+	 * 水面の高さを設定
+	 * @param[in] _waterHeight 水面の高さ
+	 */
+	void SetWaterHeight(float _waterHeight)
+	{
+		m_WaterHeight = _waterHeight;
+	}
+
+	/**
+	 * 球が反射マップに写るかを判定
+	 * @param[in] _x 球の中心のx
+	 * @param[in] _y 球の中心のy
+	 * @param[in] _z 球の中心のz
+	 * @param[in] _radius 球の半径
+	 * @return 写る可能性があればtrue 写らなければfalse
+	 */
+	bool IsVisible(float _x, float _y, float _z, float _radius) const;
+
+	/**
+	 * 複数の球が反射マップに写るかをまとめて判定
+	 * @param[in] _pSpheres 球の配列(中心x, y, z, 半径の4要素ずつ)
+	 * @param[in] _sphereNum 球の数
+	 * @param[out] _pIsVisible 球ごとの判定結果の出力先
+	 * @return 写る球の数
+	 */
+	int CullSpheres(const float* _pSpheres, int _sphereNum, bool* _pIsVisible) const;
+
+private:
+	enum
+	{
+		PLANE_NUM = 6	//!< 視錐台の平面の数.
+	};
+
+	float	m_Plane[PLANE_NUM][4];	//!< 正規化した視錐台の平面(内側が正).
+	float	m_WaterHeight;			//!< 水面の高さ.
+
+};
+
+
+#endif // !REFLECTFRUSTUMCULLER_H
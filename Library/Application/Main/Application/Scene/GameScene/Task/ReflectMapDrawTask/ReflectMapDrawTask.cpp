@@ -10,14 +10,28 @@
 #include "ReflectMapDrawTask.h"
 
 #include "Main\Object3DBase\Object3DBase.h"
+#include "ReflectFrustumCuller\ReflectFrustumCuller.h"
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+const ReflectFrustumCuller* ReflectMapDrawTask::m_pFrustumCuller = nullptr;
+int ReflectMapDrawTask::m_VisibleNum = 0;
+int ReflectMapDrawTask::m_CulledNum = 0;
 
 
 //----------------------------------------------------------------------
 // Constructor	Destructor
 //----------------------------------------------------------------------
 ReflectMapDrawTask::ReflectMapDrawTask() :
-	m_pObject(nullptr)
+	m_pObject(nullptr),
+	m_IsBounded(false)
 {
+	for (int i = 0; i < 4; i++)
+	{
+		m_BoundingSphere[i] = 0.0f;
+	}
 }
 
 ReflectMapDrawTask::~ReflectMapDrawTask()
@@ -30,6 +44,15 @@ ReflectMapDrawTask::~ReflectMapDrawTask()
 //----------------------------------------------------------------------
 void ReflectMapDrawTask::Run()
 {
+	// 反射カメラの視錐台の外か, 水面より下にあれば描画しない.
+	if (m_IsBounded && m_pFrustumCuller != nullptr &&
+		!m_pFrustumCuller->IsVisible(m_BoundingSphere[0], m_BoundingSphere[1], m_BoundingSphere[2], m_BoundingSphere[3]))
+	{
+		m_CulledNum++;
+		return;
+	}
+
+	m_VisibleNum++;
 	m_pObject->ReflectMapDraw();
 }
 
@@ -38,3 +61,23 @@ void ReflectMapDrawTask::SetObject(Object3DBase* _pObject)
 	m_pObject = _pObject;
 }
 
+void ReflectMapDrawTask::SetBoundingSphere(float _x, float _y, float _z, float _radius)
+{
+	m_BoundingSphere[0] = _x;
+	m_BoundingSphere[1] = _y;
+	m_BoundingSphere[2] = _z;
+	m_BoundingSphere[3] = _radius;
+	m_IsBounded = true;
+}
+
+
+//----------------------------------------------------------------------
+// Static Public Functions
+//----------------------------------------------------------------------
+void ReflectMapDrawTask::BeginCulling(const ReflectFrustumCuller* _pFrustumCuller)
+{
+	m_pFrustumCuller = _pFrustumCuller;
+	m_VisibleNum = 0;
+	m_CulledNum = 0;
+}
+
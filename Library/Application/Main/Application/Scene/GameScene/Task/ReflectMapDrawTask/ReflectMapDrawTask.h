@@ -14,6 +14,7 @@
 
 
 class Object3DBase;
+class ReflectFrustumCuller;
 
 
 /**
@@ -43,8 +44,47 @@ public:
 	 */
 	void SetObject(Object3DBase* _pObject);
 
+	/**
+	 * オブジェクトの境界球を設定(設定しなければカリングしない)
+	 * @param[in] _x 球の中心のx
+	 * @param[in] _y 球の中心のy
+	 * @param[in] _z 球の中心のz
+	 * @param[in] _radius 球の半径
+	 */
+	void SetBoundingSphere(float _x, float _y, float _z, float _radius);
+
+	/**
+	 * このフレームのカリングに使う反射カメラの視錐台を設定し, 描画数を0に戻す
+	 * @param[in] _pFrustumCuller 反射カメラの視錐台(nullptrならカリングしない)
+	 */
+	static void BeginCulling(const ReflectFrustumCuller* _pFrustumCuller);
+
+	/**
+	 * 前回のBeginCulling以降に描画したオブジェクトの数を取得
+	 * @return 描画したオブジェクトの数
+	 */
+	static int GetVisibleNum()
+	{
+		return m_VisibleNum;
+	}
+
+	/**
+	 * 前回のBeginCulling以降にカリングしたオブジェクトの数を取得
+	 * @return カリングしたオブジェクトの数
+	 */
+	static int GetCulledNum()
+	{
+		return m_CulledNum;
+	}
+
 private:
-	Object3DBase* m_pObject;	//!< 描画を行うオブジェクト.
+	static const ReflectFrustumCuller*	m_pFrustumCuller;	//!< 反射カメラの視錐台.
+	static int							m_VisibleNum;		//!< 描画したオブジェクトの数.
+	static int							m_CulledNum;		//!< カリングしたオブジェクトの数.
+
+	Object3DBase*	m_pObject;				//!< 描画を行うオブジェクト.
+	bool			m_IsBounded;			//!< 境界球が設定されているか.
+	float			m_BoundingSphere[4];	//!< 境界球(中心x, y, z, 半径).
 
 };
 
@@ -0,0 +1,141 @@
+﻿/**
+ * @file	CpuFeature.cpp
+ * @brief	CPU機能判定クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "CpuFeature.h"
+
+#if defined(CPUFEATURE_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+std::atomic<int> CpuFeature::m_DetectType(-1);
+
+
+//----------------------------------------------------------------------
+// Static Public Functions
+//----------------------------------------------------------------------
+CpuFeature::SIMD_TYPE CpuFeature::GetSimdType()
+{
+	// 複数のスレッドから同時に呼ばれるのでアトミックに読み書きする.
+	// 判定結果は常に同じなので, 同時に判定して書き込んでも同じ値になる.
+	int DetectType = m_DetectType.load(std::memory_order_acquire);
+	if (DetectType < 0)
+	{
+		DetectType = Detect();
+		m_DetectType.store(DetectType, std::memory_order_release);
+	}
+
+	return static_cast<SIMD_TYPE>(DetectType);
+}
+
+bool CpuFeature::IsSupport(SIMD_TYPE _type)
+{
+	SIMD_TYPE Type = GetSimdType();
+
+	switch (_type)
+	{
+	case SIMD_SCALAR:
+	case SIMD_AUTO:
+		return true;
+	case SIMD_SSE:
+		return Type == SIMD_SSE || Type == SIMD_AVX2;
+	case SIMD_AVX2:
+		return Type == SIMD_AVX2;
+	case SIMD_NEON:
+		return Type == SIMD_NEON;
+	}
+
+	return false;
+}
+
+CpuFeature::SIMD_TYPE CpuFeature::Resolve(SIMD_TYPE _type)
+{
+	if (_type == SIMD_AUTO || !IsSupport(_type))
+	{
+		return GetSimdType();
+	}
+
+	return _type;
+}
+
+const char* CpuFeature::GetSimdName(SIMD_TYPE _type)
+{
+	switch (_type)
+	{
+	case SIMD_SCALAR:	return "Scalar";
+	case SIMD_SSE:		return "SSE2";
+	case SIMD_AVX2:		return "AVX2";
+	case SIMD_NEON:		return "NEON";
+	case SIMD_AUTO:		return GetSimdName(GetSimdType());
+	}
+
+	return "Unknown";
+}
+
+int CpuFeature::GetSimdWidth(SIMD_TYPE _type)
+{
+	switch (_type)
+	{
+	case SIMD_SCALAR:	return 1;
+	case SIMD_SSE:		return 4;
+	case SIMD_AVX2:		return 8;
+	case SIMD_NEON:		return 4;
+	case SIMD_AUTO:		return GetSimdWidth(GetSimdType());
+	}
+
+	return 1;
+}
+
+
+//----------------------------------------------------------------------
+// Static Private Functions
+//----------------------------------------------------------------------
+CpuFeature::SIMD_TYPE CpuFeature::Detect()
+{
+#if defined(CPUFEATURE_X86) && defined(_MSC_VER)
+	int CpuInfo[4] = { 0, 0, 0, 0 };
+	__cpuid(CpuInfo, 0);
+	int MaxLeaf = CpuInfo[0];
+
+	__cpuid(CpuInfo, 1);
+	bool IsSSE2 = (CpuInfo[3] & (1 << 26)) != 0;
+	bool IsOSXSave = (CpuInfo[2] & (1 << 27)) != 0;
+	bool IsAVX = (CpuInfo[2] & (1 << 28)) != 0;
+
+	// OSがYMMレジスタを退避しているかも確認する.
+	bool IsAVX2 = false;
+	if (MaxLeaf >= 7 && IsOSXSave && IsAVX && (_xgetbv(0) & 0x6) == 0x6)
+	{
+		__cpuidex(CpuInfo, 7, 0);
+		IsAVX2 = (CpuInfo[1] & (1 << 5)) != 0;
+	}
+
+	if (IsAVX2)	return SIMD_AVX2;
+	if (IsSSE2)	return SIMD_SSE;
+
+	return SIMD_SCALAR;
+
+#elif defined(CPUFEATURE_X86) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))	return SIMD_AVX2;
+	if (__builtin_cpu_supports("sse2"))	return SIMD_SSE;
+
+	return SIMD_SCALAR;
+
+#elif defined(CPUFEATURE_NEON)
+	return SIMD_NEON;
+
+#else
+	return SIMD_SCALAR;
+
+#endif
+}
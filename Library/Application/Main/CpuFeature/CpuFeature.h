@@ -0,0 +1,101 @@
+﻿/**
+ * @file	CpuFeature.h
+ * @brief	CPU機能判定クラス定義
+ * @author	morimoto
+ */
+#ifndef CPUFEATURE_H
+#define CPUFEATURE_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <atomic>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CPUFEATURE_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CPUFEATURE_NEON
+#include <arm_neon.h>
+#endif
+
+
+//----------------------------------------------------------------------
+// Define
+//----------------------------------------------------------------------
+// gcc/clangでは関数単位で命令セットを有効にする(MSVCは指定不要).
+#if defined(CPUFEATURE_X86) && defined(__GNUC__)
+#define CPUFEATURE_TARGET_SSE	__attribute__((target("sse2")))
+#define CPUFEATURE_TARGET_AVX2	__attribute__((target("avx2")))
+#else
+#define CPUFEATURE_TARGET_SSE
+#define CPUFEATURE_TARGET_AVX2
+#endif
+
+
+/**
+ * CPU機能判定クラス
+ */
+class CpuFeature
+{
+public:
+	/**
+	 * SIMD命令セットの列挙子
+	 */
+	enum SIMD_TYPE
+	{
+		SIMD_SCALAR = 0,	//!< SIMDを使用しない.
+		SIMD_SSE = 1,		//!< SSE2(4レーン).
+		SIMD_AVX2 = 2,		//!< AVX2(8レーン).
+		SIMD_NEON = 3,		//!< NEON(4レーン).
+		SIMD_AUTO = 4		//!< 実行環境で使用可能な最速の命令セット.
+	};
+
+	/**
+	 * 実行環境で使用可能な最速の命令セットを取得
+	 * @return 命令セット
+	 */
+	static SIMD_TYPE GetSimdType();
+
+	/**
+	 * 命令セットが実行環境で使用可能か
+	 * @param[in] _type 確認する命令セット
+	 * @return 使用可能であればtrue 使用できなければfalse
+	 */
+	static bool IsSupport(SIMD_TYPE _type);
+
+	/**
+	 * 命令セットを実行環境で使用可能なものに解決する
+	 * @param[in] _type 要求する命令セット
+	 * @return 使用可能であれば_type そうでなければ使用可能な最速の命令セット
+	 */
+	static SIMD_TYPE Resolve(SIMD_TYPE _type);
+
+	/**
+	 * 命令セットの名前を取得
+	 * @param[in] _type 命令セット
+	 * @return 命令セットの名前
+	 */
+	static const char* GetSimdName(SIMD_TYPE _type);
+
+	/**
+	 * 命令セットのfloatレーン数を取得
+	 * @param[in] _type 命令セット
+	 * @return 1命令で処理できるfloatの数
+	 */
+	static int GetSimdWidth(SIMD_TYPE _type);
+
+private:
+	/**
+	 * 命令セットの判定
+	 * @return 実行環境で使用可能な最速の命令セット
+	 */
+	static SIMD_TYPE Detect();
+
+
+	static std::atomic<int> m_DetectType;	//!< 判定済みの命令セット(未判定なら-1).
+
+};
+
+
+#endif // !CPUFEATURE_H
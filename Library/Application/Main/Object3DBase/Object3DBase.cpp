@@ -289,6 +289,10 @@ bool Object3DBase::WriteConstantBuffer()
 		CONSTANT_BUFFER ConstantBuffer;
 		ConstantBuffer.World = MatWorld;
 		D3DXMatrixTranspose(&ConstantBuffer.World, &ConstantBuffer.World);
+		ConstantBuffer.CubeFaceMask[0] = m_pCubeMapDrawTask->GetFaceMask();
+		ConstantBuffer.CubeFaceMask[1] = 0;
+		ConstantBuffer.CubeFaceMask[2] = 0;
+		ConstantBuffer.CubeFaceMask[3] = 0;
 
 		memcpy_s(
 			SubResourceData.pData,
@@ -96,6 +96,7 @@ protected:
 	struct CONSTANT_BUFFER
 	{
 		D3DXMATRIX World;	//!< ワールド変換行列.
+		unsigned int CubeFaceMask[4];	//!< キューブマップの写る面のビットマスク(CubeFaceMask[0]のみ使用).
 	};
 
 	/**
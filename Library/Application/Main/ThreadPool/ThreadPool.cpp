@@ -0,0 +1,163 @@
+﻿/**
+ * @file	ThreadPool.cpp
+ * @brief	ワーカースレッドプールクラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "ThreadPool.h"
+
+
+//----------------------------------------------------------------------
+// Constructor	Destructor
+//----------------------------------------------------------------------
+ThreadPool::ThreadPool(int _threadNum) :
+	m_ThreadNum(_threadNum),
+	m_pJob(nullptr),
+	m_JobCount(0),
+	m_NextIndex(0),
+	m_PendingWorker(0),
+	m_Generation(0),
+	m_IsExit(false)
+{
+	if (m_ThreadNum <= 0)
+	{
+		m_ThreadNum = static_cast<int>(std::thread::hardware_concurrency());
+	}
+
+	if (m_ThreadNum <= 0)
+	{
+		m_ThreadNum = 1;
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	Finalize();
+}
+
+
+//----------------------------------------------------------------------
+// Public Functions
+//----------------------------------------------------------------------
+bool ThreadPool::Initialize()
+{
+	m_IsExit = false;
+
+	// 呼び出し元スレッドも処理を行うのでワーカーは1つ少なくする.
+	for (int i = 0; i < m_ThreadNum - 1; i++)
+	{
+		m_Threads.push_back(std::thread(&ThreadPool::WorkerThread, this, i + 1));
+	}
+
+	return true;
+}
+
+void ThreadPool::Finalize()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_IsExit = true;
+	}
+	m_WakeCondition.notify_all();
+
+	for (auto itr = m_Threads.begin(); itr != m_Threads.end(); itr++)
+	{
+		if (itr->joinable())
+		{
+			itr->join();
+		}
+	}
+
+	m_Threads.clear();
+}
+
+void ThreadPool::ParallelFor(int _count, const std::function<void(int)>& _func)
+{
+	ParallelForThread(_count, [&_func](int _index, int)
+	{
+		_func(_index);
+	});
+}
+
+void ThreadPool::ParallelForThread(int _count, const std::function<void(int, int)>& _func)
+{
+	if (_count <= 0)
+	{
+		return;
+	}
+
+	// ワーカーがいない または 1回だけなら呼び出し元で実行する.
+	if (m_Threads.empty() || _count == 1)
+	{
+		for (int i = 0; i < _count; i++)
+		{
+			_func(i, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_pJob = &_func;
+		m_JobCount = _count;
+		m_NextIndex = 0;
+		m_PendingWorker = static_cast<int>(m_Threads.size());
+		m_Generation++;
+	}
+	m_WakeCondition.notify_all();
+
+	RunJob(0);
+
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	m_DoneCondition.wait(Lock, [this] { return m_PendingWorker == 0; });
+	m_pJob = nullptr;
+}
+
+
+//----------------------------------------------------------------------
+// Private Functions
+//----------------------------------------------------------------------
+void ThreadPool::WorkerThread(int _threadIndex)
+{
+	unsigned int Generation = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_WakeCondition.wait(Lock, [this, Generation] { return m_IsExit || m_Generation != Generation; });
+
+			if (m_IsExit)
+			{
+				return;
+			}
+
+			Generation = m_Generation;
+		}
+
+		RunJob(_threadIndex);
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_PendingWorker--;
+		}
+		m_DoneCondition.notify_one();
+	}
+}
+
+void ThreadPool::RunJob(int _threadIndex)
+{
+	while (true)
+	{
+		int Index = m_NextIndex.fetch_add(1);
+		if (Index >= m_JobCount)
+		{
+			break;
+		}
+
+		(*m_pJob)(Index, _threadIndex);
+	}
+}
@@ -0,0 +1,106 @@
+﻿/**
+ * @file	ThreadPool.h
+ * @brief	ワーカースレッドプールクラス定義
+ * @author	morimoto
+ */
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * ワーカースレッドプールクラス
+ *
+ * ParallelForで渡された処理を呼び出し元スレッドとワーカースレッドで分担して実行する.
+ * ParallelForの入れ子呼び出しには対応していない.
+ */
+class ThreadPool
+{
+public:
+	/**
+	 * コンストラクタ
+	 * @param[in] _threadNum 呼び出し元を含めたスレッド数(0なら論理コア数)
+	 */
+	ThreadPool(int _threadNum = 0);
+
+	/**
+	 * デストラクタ
+	 */
+	~ThreadPool();
+
+	/**
+	 * 初期化処理
+	 * @return 初期化に成功したらtrue 失敗したらfalse
+	 */
+	bool Initialize();
+
+	/**
+	 * 終了処理
+	 */
+	void Finalize();
+
+	/**
+	 * 処理を並列実行し全て終わるまで待機する
+	 * @param[in] _count 実行する回数
+	 * @param[in] _func 実行する処理(引数は0～_count-1のインデックス)
+	 */
+	void ParallelFor(int _count, const std::function<void(int)>& _func);
+
+	/**
+	 * 処理を並列実行し全て終わるまで待機する(実行するスレッドの番号付き)
+	 *
+	 * スレッドごとの作業領域を使い分けたい場合に使用する.
+	 * @param[in] _count 実行する回数
+	 * @param[in] _func 実行する処理(引数は0～_count-1のインデックスと0～GetThreadNum()-1のスレッド番号)
+	 */
+	void ParallelForThread(int _count, const std::function<void(int, int)>& _func);
+
+	/**
+	 * 呼び出し元を含めたスレッド数を取得
+	 * @return スレッド数
+	 */
+	int GetThreadNum() const
+	{
+		return static_cast<int>(m_Threads.size()) + 1;
+	}
+
+private:
+	/**
+	 * ワーカースレッドの処理
+	 * @param[in] _threadIndex スレッド番号(呼び出し元スレッドは0)
+	 */
+	void WorkerThread(int _threadIndex);
+
+	/**
+	 * 未処理のインデックスがなくなるまで処理を実行する
+	 * @param[in] _threadIndex スレッド番号
+	 */
+	void RunJob(int _threadIndex);
+
+
+	int									m_ThreadNum;		//!< 呼び出し元を含めたスレッド数.
+	std::vector<std::thread>			m_Threads;			//!< ワーカースレッド.
+	std::mutex							m_Mutex;			//!< 状態変更の排他制御.
+	std::condition_variable				m_WakeCondition;	//!< ワーカーの起床通知.
+	std::condition_variable				m_DoneCondition;	//!< ワーカーの完了通知.
+
+	const std::function<void(int, int)>*	m_pJob;				//!< 実行中の処理.
+	int									m_JobCount;			//!< 実行する回数.
+	std::atomic<int>					m_NextIndex;		//!< 次に実行するインデックス.
+	int									m_PendingWorker;	//!< 完了していないワーカー数.
+	unsigned int						m_Generation;		//!< ParallelForの呼び出し世代.
+	bool								m_IsExit;			//!< 終了要求フラグ.
+
+};
+
+
+#endif // !THREADPOOL_H
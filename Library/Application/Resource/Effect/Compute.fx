@@ -1,10 +1,20 @@
 
+// SmokeComputeKernel::PARTICLEƓ.
 struct ParticleData
 {
-	float4 Pos;
-	float4 Scale;
-	float4 Color;
-	float4 Life;
+	float4 Pos;		// W(w͊Ȃ1, ҋ@Ȃ0).
+	float4 Vel;		// 1t[̈ړ(w0).
+	float4 Emitter;	// oW(w1).
+	float4 State;	// JE^, g嗦, At@l, 0.
+};
+
+// SmokeComputeKernel::CONSTANTƓ.
+cbuffer SmokeCompute : register(b0)
+{
+	float g_LifeFrame;
+	float g_ScaleSpeed;
+	float g_AlphaSpeed;
+	uint g_ParticleNum;
 };
 
 RWStructuredBuffer<ParticleData> DataBuffer : register(u0);
@@ -17,11 +27,31 @@ struct CSInput
 	uint3   Dispatch     : SV_DispatchThreadID;
 };
 
-[numthreads(600, 1, 1)]
+// XbhSmokeComputeKernel::THREAD_GROUP_SIZEƍ킹.
+// CPUŎsꍇSmokeComputeKernel::RunScalar菇ŌvZ.
+[numthreads(64, 1, 1)]
 void CS(const CSInput In)
 {
-	uint Index = In.GroupThread.x;
+	uint Index = In.Dispatch.x;
+	if (Index >= g_ParticleNum)
+	{
+		return;
+	}
+
+	ParticleData Data = DataBuffer[Index];
+
+	// Ȃړ, g, tF[hAEg, JE^0ɂȂҋ@ɖ߂.
+	float4 ActivePos = Data.Pos + Data.Vel;
+	float4 ActiveState = Data.State + float4(-1.0f, g_ScaleSpeed, -g_AlphaSpeed, 0.0f);
+	ActivePos.w = ActiveState.x <= 0.0f ? 0.0f : ActivePos.w;
 
-	DataBuffer[Index].Pos;
+	// ҋ@ȂJE^𑝂₵, ɒBG~b^̍Wɏo.
+	float4 InactiveState = Data.State + float4(1.0f, 0.0f, 0.0f, 0.0f);
+	bool IsSpawn = InactiveState.x >= g_LifeFrame;
+	float4 InactivePos = IsSpawn ? Data.Emitter : Data.Pos;
+	InactiveState = IsSpawn ? float4(InactiveState.x, 1.0f, 1.0f, 0.0f) : InactiveState;
 
+	bool IsActive = Data.Pos.w > 0.0f;
+	DataBuffer[Index].Pos = IsActive ? ActivePos : InactivePos;
+	DataBuffer[Index].State = IsActive ? ActiveState : InactiveState;
 }
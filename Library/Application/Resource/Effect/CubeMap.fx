@@ -4,12 +4,14 @@ SamplerState g_Sampler : register(s0);
 cbuffer model : register(b0)
 {
 	matrix g_World;
+	uint4 g_CubeFaceMask;	// x̃rbgiĂʂɃIuWFNgʂ
 };
 
 cbuffer CubeMapData : register(b5)
 {
 	matrix g_View[6];
 	matrix g_Proj;
+	uint4 g_FaceMask;	// x̃rbgiĂʂ`悷
 };
 
 struct VS_INPUT
@@ -51,6 +53,12 @@ void GS(triangle VS_OUTPUT In[3], inout TriangleStream<GS_OUTPUT> TriStream)
 {
 	for (int i = 0; i < 6; i++)
 	{
+		// ̃t[ōXVȂʂ, IuWFNgʂȂʂɂ͏o͂Ȃ
+		if ((((g_FaceMask.x & g_CubeFaceMask.x) >> i) & 1) == 0)
+		{
+			continue;
+		}
+
 		GS_OUTPUT Out;
 		Out.RTIndex = i;
 		for (int j = 0; j < 3; j++)
@@ -12,13 +12,15 @@ cbuffer camera : register(b1)
 	matrix g_ReflectProj;
 };
 
+// ̉J̏c̃XP[Ol
+static const float g_FallScaleY = 45.0f;
+
 struct VS_INPUT
 {
 	float3 Pos		: POSITION;
 	float2 UV		: TEXCOORD;
 	float4 Color    : COLOR;
-	float4x4 mat    : MATRIX;          // CX^XƂɐݒ肳s
-	float4 Position	: POS;
+	float4 Position	: POS;             // CX^XƂ̍W(w͗Ȃ0, gȂg̑傫)
 	uint InstanceId : SV_InstanceID;   // CX^Xhc
 };
 
@@ -34,9 +36,28 @@ struct VS_OUTPUT
 VS_OUTPUT VS(VS_INPUT In)
 {
 	VS_OUTPUT Out;
-	float4x4 Mat = mul(In.mat, g_View);
-	Mat = mul(Mat, g_Proj);
-	Out.PosWVP = mul(float4(In.Pos, 1.0f), Mat);
+	float3 Center = In.Position.xyz;
+	float3 WorldPos;
+
+	if (In.Position.w == 0.0f)
+	{
+		// ̓J̕r{[hɂ(^Ɛ^猩ꍇׂ͒).
+		float3 AxisZ = normalize(Center - g_CameraPos.xyz);
+		float3 AxisX = float3(AxisZ.z, 0.0f, -AxisZ.x);
+		float LengthSq = dot(AxisX, AxisX);
+		AxisX = LengthSq > 0.0f ? AxisX * rsqrt(LengthSq) : float3(0.0f, 0.0f, 0.0f);
+		float3 AxisY = cross(AxisZ, AxisX);
+		WorldPos = Center + AxisX * In.Pos.x + AxisY * (In.Pos.y * g_FallScaleY) + AxisZ * In.Pos.z;
+	}
+	else
+	{
+		// g͏悤x-90x].
+		float Scale = In.Position.w;
+		WorldPos = Center + float3(In.Pos.x, In.Pos.z, -In.Pos.y) * Scale;
+	}
+
+	Out.PosWVP = mul(float4(WorldPos, 1.0f), g_View);
+	Out.PosWVP = mul(Out.PosWVP, g_Proj);
 	Out.UV = In.UV;
 	Out.Color = In.Color;
 	Out.Position = In.Position;
@@ -47,7 +68,8 @@ VS_OUTPUT VS(VS_INPUT In)
 float4 PS(VS_OUTPUT In) : SV_TARGET
 {
 	float4 TextureColor = float4(1, 1, 1, 1);
-	if (In.Position.y <= 1)
+	// ̏łgô, ł͂Ȃg䂩ǂŔ肷.
+	if (In.Position.w > 0.0f)
 	{
 		TextureColor = g_Texture.Sample(g_Sampler, In.UV);
 	}
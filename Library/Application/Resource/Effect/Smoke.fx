@@ -32,6 +32,24 @@ struct VS_INPUT
 	uint InstanceId : SV_InstanceID;   // CX^Xhc
 };
 
+// Rs[gVF[_[ōXVp[eBN(Compute.fxParticleDataƓ).
+struct ParticleData
+{
+	float4 Pos;
+	float4 Vel;
+	float4 Emitter;
+	float4 State;
+};
+
+StructuredBuffer<ParticleData> g_Particle : register(t1);
+
+struct VS_COMPUTE_INPUT
+{
+	float3 Pos		: POSITION;
+	float2 UV		: TEXCOORD;
+	uint InstanceId : SV_InstanceID;   // p[eBÑCfbNX
+};
+
 struct VS_OUTPUT
 {
 	float4 PosWVP   : SV_POSITION;
@@ -52,6 +70,27 @@ VS_OUTPUT VS(VS_INPUT In)
 	return Out;
 }
 
+VS_OUTPUT VS_COMPUTE(VS_COMPUTE_INPUT In)
+{
+	VS_OUTPUT Out;
+	ParticleData Particle = g_Particle[In.InstanceId];
+
+	// CPUōr{[hsƓ, Jp[eBNւ̌𐳖ʂɂ.
+	float3 AxisZ = normalize(Particle.Pos.xyz - g_CameraPos.xyz);
+	float3 AxisX = normalize(cross(float3(0.0f, 1.0f, 0.0f), AxisZ));
+	float3 AxisY = cross(AxisZ, AxisX);
+
+	// ҋ@̃p[eBN(w = 0)͑傫0ɂĕ`悳Ȃ悤ɂ.
+	float Scale = Particle.State.y * Particle.Pos.w;
+	float3 WorldPos = Particle.Pos.xyz + (AxisX * In.Pos.x + AxisY * In.Pos.y) * Scale;
+
+	Out.PosWVP = mul(mul(float4(WorldPos, 1.0f), g_View), g_Proj);
+	Out.UV = In.UV;
+	Out.Color = float4(1.0f, 1.0f, 1.0f, Particle.State.z);
+
+	return Out;
+}
+
 float4 PS(VS_OUTPUT In) : SV_TARGET
 {
 	float4 FinalColor = 
@@ -1,6 +1,7 @@
 TextureCube g_Texture : register(t0);
 Texture2D g_WaterTexture : register(t1);
 Texture2D g_SkyTexture : register(t2);
+Texture2D g_OceanTexture : register(t6);	// C̖@eNX`(ʂɌJԂē\)
 SamplerState g_Sampler : register(s0);
 
 cbuffer model : register(b0)
@@ -10,6 +11,7 @@ cbuffer model : register(b0)
 	float4 g_AddWavePos;	// ǉg̃eNZl
 	float4 g_AddWaveHeight; // ǉg̍
 	matrix g_MapWorld;		// g}bv @}bv`s
+	float4 g_OceanParam;	// C̖@}bv(x:1 / iq傫, y:̋)
 };
 
 cbuffer camera : register(b1)
@@ -48,6 +50,7 @@ struct VS_OUTPUT
 	float2 UV		: TEXCOORD;
 	float3 EyeRay	: TEXCOORD2;
 	float3 Eye      : TEXCOORD3;
+	float3 WorldPos	: TEXCOORD5;
 };
 
 VS_OUTPUT VS(VS_INPUT In)
@@ -60,6 +63,7 @@ VS_OUTPUT VS(VS_INPUT In)
 
 	// JIuWFNgւ̌
 	Out.EyeRay = In.Pos - g_CameraPos.xyz;
+	Out.WorldPos = mul(float4(In.Pos, 1.0f), g_World).xyz;
 
 	// IuWFNgJւ̌
 	float3 Eye = normalize(g_CameraPos.xyz - In.Pos);
@@ -73,13 +77,18 @@ VS_OUTPUT VS(VS_INPUT In)
 
 float4 PS(VS_OUTPUT In) : SV_TARGET
 {
+	// C̖@擾(ȂԂ͏)
+	float3 Normal = 2.0f * g_OceanTexture.Sample(g_Sampler, frac(In.WorldPos.xz * g_OceanParam.x)).rgb - 1.0f;
+	Normal.xz *= g_OceanParam.y;
+	Normal = normalize(Normal);
+
 	// ˏ
-	float3 vReflect = reflect(normalize(In.EyeRay), float3(0, 1, 0));
+	float3 vReflect = reflect(normalize(In.EyeRay), Normal);
 	float4 FinalColor = g_Texture.Sample(g_Sampler, vReflect);
 
 	// Cg
 	float3 InvLightDir = normalize(g_LightDir.xyz);
-	FinalColor *= max(0.5, dot(float3(0, 1, 0), InvLightDir));
+	FinalColor *= max(0.5, dot(Normal, InvLightDir));
 
 	return FinalColor
 		* g_WaterTexture.Sample(g_Sampler, In.UV)
@@ -4,6 +4,7 @@ Texture2D g_SkyTexture : register(t2);
 Texture2D g_HeightTexture : register(t3);	// geNX`(HeightMapƂĎg)
 Texture2D g_BumpTexture : register(t4);		// @eNX`
 Texture2D g_ColorTexture : register(t5);	// J[eNX`
+Texture2D g_OceanTexture : register(t6);	// C̖@eNX`(ʂɌJԂē\)
 SamplerState g_Sampler : register(s0);
 
 cbuffer model : register(b0)
@@ -13,6 +14,7 @@ cbuffer model : register(b0)
 	float4 g_AddWavePos;	// ǉg̃eNZl
 	float4 g_AddWaveHeight; // ǉg̍
 	matrix g_MapWorld;		// g}bv @}bv`s
+	float4 g_OceanParam;	// C̖@}bv(x:1 / iq傫, y:̋)
 };
 
 cbuffer camera : register(b1)
@@ -58,6 +60,7 @@ struct VS_OUTPUT
 	float3 EyeRay		: TEXCOORD2;
 	float3 Eye			: TEXCOORD3;
 	float4 ReflectPos	: TEXCOORD4;
+	float3 WorldPos		: TEXCOORD5;
 };
 
 VS_OUTPUT VS(VS_INPUT In)
@@ -69,6 +72,7 @@ VS_OUTPUT VS(VS_INPUT In)
 	Out.UV = In.UV;
 
 	Out.EyeRay = In.Pos - g_CameraPos.xyz;
+	Out.WorldPos = mul(float4(In.Pos, 1.0f), g_World).xyz;
 
 	float4x4 InvMat = mul(g_World, g_ReflectView);
 	InvMat = mul(InvMat, g_ReflectProj);
@@ -84,6 +88,11 @@ float4 PS(VS_OUTPUT In) : SV_TARGET
 {
 	float3 Normal = normalize(2.0f * g_BumpTexture.Sample(g_Sampler, In.UV).rgb - 1.0f);	// ϊĎ擾
 
+	// C̖@(X𑫂킹)
+	float3 Ocean = 2.0f * g_OceanTexture.Sample(g_Sampler, frac(In.WorldPos.xz * g_OceanParam.x)).rgb - 1.0f;
+	Ocean.xz *= g_OceanParam.y;
+	Normal = normalize(float3(Normal.x + Ocean.x, Normal.y * Ocean.y, Normal.z + Ocean.z));
+
 	float2 UV = In.ReflectPos.xy / In.ReflectPos.w;	// ]eNX`UV̌vZ
 
 	// ]eNX`F擾
@@ -1,6 +1,9 @@
 float SpringPower = 0.5f;	// ΂˂̋
+float VelocityDecay = 1.0f / 32.0f;	// x̌(Î~̑x0.1̂炷)
+float HeightDecay = 1.0f / 256.0f;	// ̌(Î~̍0.1̂炷)
 
 Texture2D g_WaveTexture : register(t0);
+Texture2D g_ObstacleTexture : register(t1);	// Q(1ȂQ)
 SamplerState g_Sampler : register(s0);
 
 cbuffer model : register(b0)
@@ -10,6 +13,7 @@ cbuffer model : register(b0)
 	float4 g_AddWavePos;	// ǉg̃eNZl
 	float4 g_AddWaveHeight; // ǉg̍
 	matrix g_MapWorld;		// g}bv @}bv`s
+	float4 g_OceanParam;	// C̖@}bv(x:1 / iq傫, y:̋)
 };
 
 cbuffer camera : register(b1)
@@ -69,14 +73,27 @@ float4 PS_WAVEMAP(VS_OUTPUT In) : SV_TARGET
 	float H3 = g_WaveTexture.Sample(g_Sampler, In.UV + float2(-g_TexelOffset.x, 0.0f			)).r;	// 
 	float H4 = g_WaveTexture.Sample(g_Sampler, In.UV + float2(0.0f,				-g_TexelOffset.y)).r;	// 
 
-	float WaveSpeed = Wave.y + ((H1 + H2 + H3 + H4) * 0.25f - Wave.x) * SpringPower;
+	// Q̗אڃZ͒S̍ƂĈ˂
+	float S1 = lerp(H1, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(g_TexelOffset.x,  0.0f			)).r);
+	float S2 = lerp(H2, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(0.0f,				g_TexelOffset.y )).r);
+	float S3 = lerp(H3, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(-g_TexelOffset.x, 0.0f			)).r);
+	float S4 = lerp(H4, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(0.0f,				-g_TexelOffset.y)).r);
+
+	float WaveSpeed = Wave.y + ((S1 + S2 + S3 + S4) * 0.25f - Wave.x) * SpringPower;
+	WaveSpeed -= (WaveSpeed - 0.1f) * VelocityDecay;
 	float WaveHeight = Wave.x + WaveSpeed - 0.1f;
+	WaveHeight -= (WaveHeight - 0.1f) * HeightDecay;
 
 	if (distance(In.UV, g_AddWavePos.xy) < 0.03f)
 	{
 		WaveSpeed += g_AddWaveHeight.x;
 	}
 
+	// Q̃Z͍XVȂ
+	float Solid = g_ObstacleTexture.Sample(g_Sampler, In.UV).r;
+	WaveHeight = lerp(WaveHeight, Wave.x, Solid);
+	WaveSpeed = lerp(WaveSpeed, Wave.y, Solid);
+
 	return float4(WaveHeight, WaveSpeed, 0, 1);
 }
 
@@ -97,3 +114,56 @@ float4 PS_BUMPMAP(VS_OUTPUT In) : SV_TARGET
 		tv,			// z
 		g_WaveTexture.Sample(g_Sampler, In.UV).r * 0.5f + 0.5f);	// 
 }
+
+// g}bvƖ@}bv̓쐬̏o
+struct PS_WAVEBUMP_OUTPUT
+{
+	float4 Wave : SV_TARGET0;	// g}bv
+	float4 Bump : SV_TARGET1;	// @}bv
+};
+
+// g}bvƖ@}bv쐬(͂̍̓ǂݍ݂1ōς܂)
+// @}bvPS_BUMPMAPƓXVO̍쐬
+PS_WAVEBUMP_OUTPUT PS_WAVEBUMPMAP(VS_OUTPUT In)
+{
+	PS_WAVEBUMP_OUTPUT Out;
+
+	// (R), x(G)
+	float4 Wave = g_WaveTexture.Sample(g_Sampler, In.UV);
+
+	// ͂̍擾
+	float H1 = g_WaveTexture.Sample(g_Sampler, In.UV + float2(g_TexelOffset.x,  0.0f			)).r;	// E
+	float H2 = g_WaveTexture.Sample(g_Sampler, In.UV + float2(0.0f,				g_TexelOffset.y )).r;	// 
+	float H3 = g_WaveTexture.Sample(g_Sampler, In.UV + float2(-g_TexelOffset.x, 0.0f			)).r;	// 
+	float H4 = g_WaveTexture.Sample(g_Sampler, In.UV + float2(0.0f,				-g_TexelOffset.y)).r;	// 
+
+	// Q̗אڃZ͒S̍ƂĈ˂
+	float S1 = lerp(H1, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(g_TexelOffset.x,  0.0f			)).r);
+	float S2 = lerp(H2, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(0.0f,				g_TexelOffset.y )).r);
+	float S3 = lerp(H3, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(-g_TexelOffset.x, 0.0f			)).r);
+	float S4 = lerp(H4, Wave.x, g_ObstacleTexture.Sample(g_Sampler, In.UV + float2(0.0f,				-g_TexelOffset.y)).r);
+
+	float WaveSpeed = Wave.y + ((S1 + S2 + S3 + S4) * 0.25f - Wave.x) * SpringPower;
+	WaveSpeed -= (WaveSpeed - 0.1f) * VelocityDecay;
+	float WaveHeight = Wave.x + WaveSpeed - 0.1f;
+	WaveHeight -= (WaveHeight - 0.1f) * HeightDecay;
+
+	if (distance(In.UV, g_AddWavePos.xy) < 0.03f)
+	{
+		WaveSpeed += g_AddWaveHeight.x;
+	}
+
+	// Q̃Z͍XVȂ
+	float Solid = g_ObstacleTexture.Sample(g_Sampler, In.UV).r;
+	WaveHeight = lerp(WaveHeight, Wave.x, Solid);
+	WaveSpeed = lerp(WaveSpeed, Wave.y, Solid);
+
+	Out.Wave = float4(WaveHeight, WaveSpeed, 0, 1);
+	Out.Bump = float4(
+		0.5f * (H3 - H1) + 0.5f,	// x
+		1.0f,						// y
+		0.5f * (H4 - H2) + 0.5f,	// z
+		Wave.x * 0.5f + 0.5f);		// 
+
+	return Out;
+}
@@ -0,0 +1,145 @@
+﻿/**
+ * @file	Benchmark.cpp
+ * @brief	CPUモジュールの計測
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveBenchmark\WaveBenchmark.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\House\Smoke\SmokeComputeKernel\SmokeComputeKernel.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	/**
+	 * 波シミュレーションの計測(WaveBenchmark.csvにも書き込む)
+	 * @return 計測に成功したらtrue
+	 */
+	bool RunWaveBenchmark()
+	{
+		ThreadPool Pool;
+		if (!Pool.Initialize())
+		{
+			return false;
+		}
+
+		WaveBenchmark Benchmark(&Pool);
+		bool IsSuccess = Benchmark.Run(32, 8) && Benchmark.WriteResult("WaveBenchmark.csv");
+		Pool.Finalize();
+
+		if (!IsSuccess)
+		{
+			return false;
+		}
+
+		printf("WaveBenchmark (%d threads)\n", Pool.GetThreadNum());
+		printf("%-6s %-2s %-6s %-9s %10s %10s\n", "Size", "K", "Prec", "SIMD", "ms/step", "Mcell/s");
+		const std::vector<WaveBenchmark::RESULT>& Result = Benchmark.GetResult();
+		for (auto itr = Result.begin(); itr != Result.end(); itr++)
+		{
+			printf("%-6d %-2d %-6s %-9s %10.3f %10.1f\n",
+				itr->Size, itr->BlockStepNum, itr->IsFixed ? "Q14" : "F32", CpuFeature::GetSimdName(itr->SimdType),
+				itr->MilliSecondPerStep, itr->MegaCellPerSecond);
+		}
+
+		return true;
+	}
+
+	/**
+	 * 煙パーティクルのコンピュートカーネルをスレッドグループの数とスレッド数を変えて計測
+	 * @return 計測に成功したらtrue
+	 */
+	bool RunSmokeComputeBenchmark()
+	{
+		const int GroupNums[] = { 1, 16, 113, 1024, 8192 };	// 113は家12軒分(7200個).
+		const int GroupNumNum = sizeof(GroupNums) / sizeof(GroupNums[0]);
+		const int FrameNum = 200;
+
+		std::vector<int> ThreadNums;
+		int HardwareThreadNum = static_cast<int>(std::thread::hardware_concurrency());
+		for (int ThreadNum = 1; ThreadNum < HardwareThreadNum; ThreadNum *= 2)
+		{
+			ThreadNums.push_back(ThreadNum);
+		}
+		ThreadNums.push_back(HardwareThreadNum > 0 ? HardwareThreadNum : 1);
+
+		std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+
+		printf("SmokeComputeKernel (%d frames)\n", FrameNum);
+		printf("%-7s %-9s %-8s %-8s %10s %10s\n", "Groups", "Particles", "SIMD", "Threads", "us/frame", "ns/part");
+
+		for (int i = 0; i < GroupNumNum; i++)
+		{
+			int ParticleNum = GroupNums[i] * SmokeComputeKernel::THREAD_GROUP_SIZE;
+			SmokeComputeKernel::CONSTANT Constant = { 300.0f, 0.01f, 0.003f, static_cast<unsigned int>(ParticleNum) };
+
+			std::vector<SmokeComputeKernel::PARTICLE> Initial(ParticleNum);
+			for (int j = 0; j < ParticleNum; j++)
+			{
+				SmokeComputeKernel::ResetParticle(&Initial[j], 0.0f, 25.0f, 0.0f, 0.01f, 0.1f, 0.01f, Constant.LifeFrame, j % 600 + 1);
+			}
+
+			for (size_t s = 0; s < SimdTypes.size(); s++)
+			{
+				for (size_t t = 0; t < ThreadNums.size(); t++)
+				{
+					ThreadPool Pool(ThreadNums[t]);
+					if (!Pool.Initialize())
+					{
+						return false;
+					}
+
+					SmokeComputeKernel Kernel;
+					Kernel.SetSimdType(SimdTypes[s]);
+					Kernel.SetThreadPool(&Pool);
+
+					std::vector<SmokeComputeKernel::PARTICLE> Particle = Initial;
+					Kernel.Dispatch(Constant, &Particle[0], GroupNums[i]);
+
+					std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+					for (int Frame = 0; Frame < FrameNum; Frame++)
+					{
+						Kernel.Dispatch(Constant, &Particle[0], GroupNums[i]);
+					}
+					std::chrono::steady_clock::time_point EndTime = std::chrono::steady_clock::now();
+
+					Pool.Finalize();
+
+					double MicroSecond = std::chrono::duration<double, std::micro>(EndTime - StartTime).count() / FrameNum;
+					printf("%-7d %-9d %-8s %-8d %10.2f %10.3f\n",
+						GroupNums[i], ParticleNum, CpuFeature::GetSimdName(Kernel.GetSimdType()), Pool.GetThreadNum(),
+						MicroSecond, MicroSecond * 1000.0 / ParticleNum);
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+
+int main()
+{
+	if (!RunSmokeComputeBenchmark())
+	{
+		printf("SmokeComputeKernel benchmark failed\n");
+		return 1;
+	}
+
+	if (!RunWaveBenchmark())
+	{
+		printf("WaveBenchmark failed\n");
+		return 1;
+	}
+
+	return 0;
+}
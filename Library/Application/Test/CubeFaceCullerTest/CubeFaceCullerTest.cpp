@@ -0,0 +1,176 @@
+﻿/**
+ * @file	CubeFaceCullerTest.cpp
+ * @brief	キューブマップの面ごとのカリングのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cmath>
+#include <cstdio>
+
+#include "Main\Application\Scene\GameScene\Task\CubeMapDrawTask\CubeFaceCuller\CubeFaceCuller.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const float FAR_CLIP = 700.0f;			//!< キューブマップの遠クリップ面までの距離(Water).
+	const float HOUSE_HALF_WIDTH = 9.0f;	//!< 家の幅の半分(House::m_BoundingHalfSize).
+	const float HOUSE_HALF_HEIGHT = 13.0f;	//!< 家の高さの半分(House::m_BoundingHalfSize).
+	const float HOUSE_HALF_DEPTH = 13.3f;	//!< 家の奥行きの半分(House::m_BoundingHalfSize).
+
+	/**
+	 * ボックスを囲む球が写る面のビットマスクを取得
+	 */
+	unsigned int GetBoxFaceMask(
+		const CubeFaceCuller& _culler, float _x, float _y, float _z, float _halfX, float _halfY, float _halfZ)
+	{
+		float Radius = std::sqrt(_halfX * _halfX + _halfY * _halfY + _halfZ * _halfZ);
+		return _culler.GetSphereFaceMask(_x, _y, _z, Radius);
+	}
+
+	/**
+	 * ビットの数
+	 */
+	int GetBitNum(unsigned int _mask)
+	{
+		int BitNum = 0;
+		for (; _mask != 0; _mask &= _mask - 1)
+		{
+			BitNum++;
+		}
+
+		return BitNum;
+	}
+
+	/**
+	 * 軸の上のボックスは軸の面にだけ写るか
+	 */
+	void TestAxis()
+	{
+		const float Dir[CubeFaceCuller::FACE_NUM][3] =
+		{
+			{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+		};
+
+		CubeFaceCuller Culler;
+		for (int i = 0; i < CubeFaceCuller::FACE_NUM; i++)
+		{
+			unsigned int FaceMask = GetBoxFaceMask(Culler, Dir[i][0] * 50, Dir[i][1] * 50, Dir[i][2] * 50, 4, 6, 5);
+			if (!TEST_CHECK(FaceMask == 1u << i))
+			{
+				printf("  face %d: mask 0x%02x\n", i, FaceMask);
+			}
+		}
+	}
+
+	/**
+	 * 面の境目にかかるボックスは両側の面に写るか
+	 */
+	void TestEdge()
+	{
+		CubeFaceCuller Culler;
+
+		// +Xと+Zの境目(x = z).
+		TEST_CHECK(GetBoxFaceMask(Culler, 40, 0, 40, 4, 4, 4) == ((1u << 0) | (1u << 4)));
+
+		// -Xと-Yの境目(-x = -y).
+		TEST_CHECK(GetBoxFaceMask(Culler, -30, -30, 0, 4, 4, 4) == ((1u << 1) | (1u << 3)));
+
+		// 境目から半径より離れていれば片側だけ.
+		TEST_CHECK(GetBoxFaceMask(Culler, 40, 0, 20, 4, 4, 4) == (1u << 0));
+
+		// 3つの面の角.
+		TEST_CHECK(GetBoxFaceMask(Culler, 30, 30, -30, 4, 4, 4) == ((1u << 0) | (1u << 2) | (1u << 5)));
+	}
+
+	/**
+	 * 描画する位置を含むボックスは全ての面に写るか
+	 */
+	void TestContain()
+	{
+		CubeFaceCuller Culler;
+		TEST_CHECK(GetBoxFaceMask(Culler, 1, 2, -1, 5, 5, 5) == CubeFaceCuller::ALL_FACE_MASK);
+
+		// 描画する位置を動かすとボックスから外れる.
+		Culler.SetOrigin(0, 0, -60);
+		TEST_CHECK(GetBoxFaceMask(Culler, 1, 2, -1, 5, 5, 5) == (1u << 4));
+
+		Culler.SetOrigin(1, 2, -1);
+		TEST_CHECK(Culler.GetSphereFaceMask(1, 2, -1, 0.5f) == CubeFaceCuller::ALL_FACE_MASK);
+	}
+
+	/**
+	 * 遠クリップ面より奥のボックスはどの面にも写らないか
+	 */
+	void TestFarClip()
+	{
+		CubeFaceCuller Culler;
+		Culler.SetFarClip(FAR_CLIP);
+		TEST_CHECK(GetBoxFaceMask(Culler, 0, 0, -(FAR_CLIP + 20), 4, 4, 4) == 0);
+		TEST_CHECK(GetBoxFaceMask(Culler, 0, 0, -(FAR_CLIP + 5), 4, 4, 4) == (1u << 5));
+
+		Culler.SetFarClip(0.0f);
+		TEST_CHECK(GetBoxFaceMask(Culler, 0, 0, -(FAR_CLIP + 20), 4, 4, 4) == (1u << 5));
+	}
+
+	/**
+	 * シーンの家が写る面の数を数え, 全ての面に描画する場合との比を求める
+	 */
+	void TestHouse()
+	{
+		// ObjectManagerの家の位置(地形の高さは家の位置では0).
+		const float HousePos[][2] =
+		{
+			{ 0, 45 }, { 20, 45 }, { 40, 45 }, { 0, 95 }, { 20, 95 }, { 40, 95 },
+			{ 80, 80 }, { 80, 60 }, { 80, 40 }, { 80, 20 }, { -100, 20 }, { -100, 40 }
+		};
+		const int HouseNum = sizeof(HousePos) / sizeof(HousePos[0]);
+
+		float HalfHeight = HOUSE_HALF_HEIGHT;
+		float Spheres[HouseNum * 4];
+		for (int i = 0; i < HouseNum; i++)
+		{
+			Spheres[i * 4 + 0] = HousePos[i][0];
+			Spheres[i * 4 + 1] = HalfHeight;
+			Spheres[i * 4 + 2] = HousePos[i][1];
+			Spheres[i * 4 + 3] = std::sqrt(
+				HOUSE_HALF_WIDTH * HOUSE_HALF_WIDTH + HOUSE_HALF_DEPTH * HOUSE_HALF_DEPTH + HalfHeight * HalfHeight);
+		}
+
+		// キューブマップはWaterで原点から描画している.
+		CubeFaceCuller Culler;
+		Culler.SetFarClip(FAR_CLIP);
+		unsigned int FaceMasks[HouseNum];
+		Culler.GetSphereFaceMasks(Spheres, HouseNum, FaceMasks);
+
+		int FaceDrawNum = 0;
+		for (int i = 0; i < HouseNum; i++)
+		{
+			TEST_CHECK(FaceMasks[i] == Culler.GetSphereFaceMask(Spheres[i * 4], Spheres[i * 4 + 1], Spheres[i * 4 + 2], Spheres[i * 4 + 3]));
+			TEST_CHECK(FaceMasks[i] != 0);
+			FaceDrawNum += GetBitNum(FaceMasks[i]);
+		}
+
+		int AllFaceDrawNum = HouseNum * CubeFaceCuller::FACE_NUM;
+		printf("House cube face draws: %d / %d (%.1fx fewer)\n",
+			FaceDrawNum, AllFaceDrawNum, static_cast<float>(AllFaceDrawNum) / FaceDrawNum);
+
+		// 全ての面に複製する場合の1/3以下になる.
+		TEST_CHECK(FaceDrawNum * 3 <= AllFaceDrawNum);
+	}
+}
+
+
+int main()
+{
+	TestAxis();
+	TestEdge();
+	TestContain();
+	TestFarClip();
+	TestHouse();
+
+	return TestUtility::Finish("CubeFaceCullerTest");
+}
@@ -0,0 +1,267 @@
+﻿/**
+ * @file	CubeFaceSchedulerTest.cpp
+ * @brief	キューブマップの面の更新スケジューラのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cstdio>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\CubeFaceScheduler\CubeFaceScheduler.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const unsigned int ALL_FACE_MASK = (1u << CubeFaceScheduler::FACE_NUM) - 1;	//!< 全ての面のビットマスク.
+
+	/**
+	 * ビットの数
+	 */
+	int GetBitNum(unsigned int _mask)
+	{
+		int BitNum = 0;
+		for (; _mask != 0; _mask &= _mask - 1)
+		{
+			BitNum++;
+		}
+
+		return BitNum;
+	}
+
+	/**
+	 * 最初の無効化された面を描き終えるまでスケジュールを進める
+	 */
+	void Warmup(CubeFaceScheduler* _pScheduler)
+	{
+		unsigned int DrawMask = 0;
+		while (DrawMask != ALL_FACE_MASK)
+		{
+			DrawMask |= _pScheduler->Schedule();
+		}
+	}
+
+	/**
+	 * 選ぶ面の数が予算どおりか
+	 */
+	void TestBudget()
+	{
+		for (int Budget = 1; Budget <= CubeFaceScheduler::FACE_NUM; Budget++)
+		{
+			CubeFaceScheduler Scheduler;
+			Scheduler.SetFaceBudget(Budget);
+			Scheduler.SetViewDir(1.0f, 0.5f, -0.3f);
+
+			for (int i = 0; i < 50; i++)
+			{
+				unsigned int FaceMask = Scheduler.Schedule();
+				if (!TEST_CHECK(GetBitNum(FaceMask) == Budget && (FaceMask & ~ALL_FACE_MASK) == 0))
+				{
+					printf("  budget %d, frame %d: mask 0x%02x\n", Budget, i, FaceMask);
+					break;
+				}
+
+				TEST_CHECK(Scheduler.GetFaceMask() == FaceMask);
+			}
+		}
+
+		// 範囲外の予算は1～6に丸める.
+		CubeFaceScheduler Scheduler;
+		TEST_CHECK(Scheduler.GetFaceBudget() == CubeFaceScheduler::m_DefaultFaceBudget);
+		Scheduler.SetFaceBudget(0);
+		TEST_CHECK(Scheduler.GetFaceBudget() == 1);
+		Scheduler.SetFaceBudget(CubeFaceScheduler::FACE_NUM + 1);
+		TEST_CHECK(Scheduler.GetFaceBudget() == CubeFaceScheduler::FACE_NUM);
+	}
+
+	/**
+	 * 最初は無効化された面(全ての面)を先に描画し, 描画した面の古さが0になるか
+	 */
+	void TestFirstFrame()
+	{
+		CubeFaceScheduler Scheduler;
+		Scheduler.SetFaceBudget(4);
+
+		unsigned int FaceMask0 = Scheduler.Schedule();
+		unsigned int FaceMask1 = Scheduler.Schedule();
+		// 2フレーム目は1フレーム目に描画しなかった2面を必ず選び, 残りの予算で古い面を選ぶ.
+		TEST_CHECK((FaceMask1 & (ALL_FACE_MASK & ~FaceMask0)) == (ALL_FACE_MASK & ~FaceMask0));
+		TEST_CHECK(GetBitNum(FaceMask0 & FaceMask1) == 2);
+
+		for (int i = 0; i < CubeFaceScheduler::FACE_NUM; i++)
+		{
+			TEST_CHECK(Scheduler.GetStaleness(i) == ((FaceMask1 & (1u << i)) != 0 ? 0 : 1));
+		}
+	}
+
+	/**
+	 * 向きを考慮しなければ順番に描画し, 考慮しても全ての面が一定のフレーム数以内に描画されるか
+	 */
+	void TestStarvation()
+	{
+		// 向きを考慮しないと予算1なら6フレームごとに1回ずつ, 順番に描画する.
+		{
+			CubeFaceScheduler Scheduler;
+			Scheduler.SetFaceBudget(1);
+			Scheduler.SetFacingWeight(0.0f);
+			Warmup(&Scheduler);
+
+			unsigned int PrevFaceMask = Scheduler.GetFaceMask();
+			for (int i = 0; i < 60; i++)
+			{
+				unsigned int FaceMask = Scheduler.Schedule();
+				unsigned int NextFaceMask = PrevFaceMask << 1 > ALL_FACE_MASK ? 1u : PrevFaceMask << 1;
+				if (!TEST_CHECK(FaceMask == NextFaceMask && Scheduler.GetMaxStaleness() == CubeFaceScheduler::FACE_NUM - 1))
+				{
+					printf("  round robin frame %d: mask 0x%02x, max staleness %d\n", i, FaceMask, Scheduler.GetMaxStaleness());
+					break;
+				}
+
+				PrevFaceMask = FaceMask;
+			}
+		}
+
+		// 視線の向きの面は多く描画するが, 背後の面も古くなれば描画する.
+		const float ViewDir[][3] = { { 1, 0, 0 }, { 0, -1, 0 }, { 0.3f, 0.2f, -1.0f } };
+		for (int i = 0; i < static_cast<int>(sizeof(ViewDir) / sizeof(ViewDir[0])); i++)
+		{
+			for (int Budget = 1; Budget <= 2; Budget++)
+			{
+				CubeFaceScheduler Scheduler;
+				Scheduler.SetFaceBudget(Budget);
+				Scheduler.SetViewDir(ViewDir[i][0], ViewDir[i][1], ViewDir[i][2]);
+				Warmup(&Scheduler);
+
+				const int FrameNum = 600;
+				int DrawNum[CubeFaceScheduler::FACE_NUM] = {};
+				int MaxStaleness = 0;
+				for (int j = 0; j < FrameNum; j++)
+				{
+					unsigned int FaceMask = Scheduler.Schedule();
+					for (int k = 0; k < CubeFaceScheduler::FACE_NUM; k++)
+					{
+						DrawNum[k] += (FaceMask >> k) & 1;
+					}
+
+					MaxStaleness = Scheduler.GetMaxStaleness() > MaxStaleness ? Scheduler.GetMaxStaleness() : MaxStaleness;
+				}
+
+				// 倍率3なら視線と関係の無い面が選ばれるまで, 視線の面を最大4回描画するまで待つ.
+				int StalenessLimit = 4 * CubeFaceScheduler::FACE_NUM / Budget;
+				int FrontFace = 0;
+				for (int k = 0; k < CubeFaceScheduler::FACE_NUM; k++)
+				{
+					TEST_CHECK(DrawNum[k] > 0);
+					FrontFace = DrawNum[k] > DrawNum[FrontFace] ? k : FrontFace;
+				}
+
+				if (!TEST_CHECK(MaxStaleness <= StalenessLimit))
+				{
+					printf("  view %d, budget %d: max staleness %d (limit %d)\n", i, Budget, MaxStaleness, StalenessLimit);
+				}
+
+				// 最も多く描画する面は視線の向きに最も近い面.
+				const float FaceDir[CubeFaceScheduler::FACE_NUM][3] =
+				{
+					{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+				};
+				float FrontDot = ViewDir[i][0] * FaceDir[FrontFace][0] + ViewDir[i][1] * FaceDir[FrontFace][1] + ViewDir[i][2] * FaceDir[FrontFace][2];
+				for (int k = 0; k < CubeFaceScheduler::FACE_NUM; k++)
+				{
+					TEST_CHECK(ViewDir[i][0] * FaceDir[k][0] + ViewDir[i][1] * FaceDir[k][1] + ViewDir[i][2] * FaceDir[k][2] <= FrontDot);
+				}
+			}
+		}
+	}
+
+	/**
+	 * 無効化した面は次のフレームで描画されるか
+	 */
+	void TestInvalidate()
+	{
+		CubeFaceScheduler Scheduler;
+		Scheduler.SetFaceBudget(1);
+		Scheduler.SetViewDir(0.0f, 0.0f, 1.0f);
+		Warmup(&Scheduler);
+
+		// 視線と反対の面でも優先する.
+		Scheduler.Invalidate(5);
+		TEST_CHECK(Scheduler.Schedule() == 1u << 5);
+
+		// 範囲外の面は無視する.
+		Scheduler.Invalidate(-1);
+		Scheduler.Invalidate(CubeFaceScheduler::FACE_NUM);
+		TEST_CHECK(GetBitNum(Scheduler.Schedule()) == 1);
+
+		// +X軸上の球は+Xの面だけを無効化する.
+		Scheduler.SetFaceBudget(2);
+		Scheduler.InvalidateSphere(50.0f, 0.0f, 0.0f, 3.0f);
+		TEST_CHECK((Scheduler.Schedule() & (1u << 0)) != 0);
+
+		Scheduler.InvalidateAll();
+		Scheduler.SetFaceBudget(CubeFaceScheduler::FACE_NUM);
+		TEST_CHECK(Scheduler.Schedule() == ALL_FACE_MASK);
+	}
+
+	/**
+	 * 無効にしている間は面を選ばず, 有効に戻したら全ての面を描画し直すか
+	 */
+	void TestDisable()
+	{
+		CubeFaceScheduler Scheduler;
+		Scheduler.SetFaceBudget(2);
+		Warmup(&Scheduler);
+		Scheduler.Schedule();
+
+		int Staleness[CubeFaceScheduler::FACE_NUM];
+		for (int i = 0; i < CubeFaceScheduler::FACE_NUM; i++)
+		{
+			Staleness[i] = Scheduler.GetStaleness(i);
+		}
+
+		Scheduler.SetIsEnable(false);
+		TEST_CHECK(!Scheduler.IsEnable());
+		for (int i = 0; i < 10; i++)
+		{
+			TEST_CHECK(Scheduler.Schedule() == 0);
+			TEST_CHECK(Scheduler.GetFaceMask() == 0);
+		}
+
+		// 無効にしている間は古さを進めない.
+		for (int i = 0; i < CubeFaceScheduler::FACE_NUM; i++)
+		{
+			TEST_CHECK(Scheduler.GetStaleness(i) == Staleness[i]);
+		}
+
+		Scheduler.SetIsEnable(true);
+		TEST_CHECK(Scheduler.IsEnable());
+		unsigned int DrawMask = 0;
+		for (int i = 0; i < CubeFaceScheduler::FACE_NUM / 2; i++)
+		{
+			DrawMask |= Scheduler.Schedule();
+		}
+
+		TEST_CHECK(DrawMask == ALL_FACE_MASK);
+
+		// 有効なまま設定しても無効化しない.
+		Scheduler.SetFaceBudget(1);
+		Scheduler.SetFacingWeight(0.0f);
+		unsigned int PrevFaceMask = Scheduler.Schedule();
+		Scheduler.SetIsEnable(true);
+		TEST_CHECK(Scheduler.Schedule() != PrevFaceMask);
+	}
+}
+
+
+int main()
+{
+	TestBudget();
+	TestFirstFrame();
+	TestStarvation();
+	TestInvalidate();
+	TestDisable();
+
+	return TestUtility::Finish("CubeFaceSchedulerTest");
+}
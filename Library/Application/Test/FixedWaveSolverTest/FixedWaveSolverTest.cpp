@@ -0,0 +1,224 @@
+﻿/**
+ * @file	FixedWaveSolverTest.cpp
+ * @brief	固定小数点波計算のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\FixedWaveSolver\FixedWaveSolver.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+namespace
+{
+	const int ERROR_MAP_SIZE = 256;		//!< 誤差を計測する波マップの大きさ.
+	const int ERROR_STEP_NUM = 1200;	//!< 誤差を計測するステップ数.
+	const int SETTLE_STEP_NUM = 200;	//!< 最後に波が収まった後の誤差を確認するステップ数.
+
+	/**
+	 * 誤差を計測するシミュレーションを作成し, 波を追加する
+	 * @param[out] _pSimulator 作成するシミュレーション
+	 * @param[in] _precision 計算精度
+	 * @return 作成に成功したらtrue
+	 */
+	bool PrepareErrorSimulator(WaveSimulator* _pSimulator, WaveSimulator::PRECISION _precision)
+	{
+		if (!_pSimulator->Initialize())
+		{
+			return false;
+		}
+
+		// 休止したタイルは固定小数点と比較できないので全タイルを更新する.
+		_pSimulator->SetIsSparse(false);
+		_pSimulator->SetPrecision(_precision);
+		_pSimulator->AddWave(0.3f, 0.4f, 0.05f, 0.8f);
+		_pSimulator->AddWave(0.7f, 0.6f, 0.03f, 0.6f);
+
+		return true;
+	}
+
+	/**
+	 * 2つの波マップの高さと速度(R, G)の差の最大値を求める
+	 * @param[in] _a 比較する波マップ
+	 * @param[in] _b 比較する波マップ
+	 * @return 差の最大値
+	 */
+	int GetMaxMapError(const std::vector<unsigned char>& _a, const std::vector<unsigned char>& _b)
+	{
+		int MaxError = 0;
+		for (size_t i = 0; i < _a.size(); i += 4)
+		{
+			MaxError = std::max(MaxError, std::abs(_a[i + 0] - _b[i + 0]));
+			MaxError = std::max(MaxError, std::abs(_a[i + 1] - _b[i + 1]));
+		}
+
+		return MaxError;
+	}
+
+	/**
+	 * 2つのシミュレーションの浮動小数点の高さと速度の差の最大値を求める
+	 * @param[in] _a 比較するシミュレーション
+	 * @param[in] _b 比較するシミュレーション
+	 * @return 差の最大値
+	 */
+	float GetMaxStateError(const WaveSimulator& _a, const WaveSimulator& _b)
+	{
+		float MaxError = 0.0f;
+		for (int y = 0; y < ERROR_MAP_SIZE; y++)
+		{
+			for (int x = 0; x < ERROR_MAP_SIZE; x++)
+			{
+				MaxError = std::max(MaxError, std::fabs(_a.GetHeightRow(y)[x] - _b.GetHeightRow(y)[x]));
+				MaxError = std::max(MaxError, std::fabs(_a.GetVelocityRow(y)[x] - _b.GetVelocityRow(y)[x]));
+			}
+		}
+
+		return MaxError;
+	}
+
+	/**
+	 * 同じ状態から1ステップ進めた浮動小数点と固定小数点の差がm_MaxStepError以下か確認する
+	 */
+	void CheckStepError()
+	{
+		float MaxError = 0.0f;
+		const int CheckStep[] = { 1, 10, 50, 200 };
+		for (int i = 0; i < 4; i++)
+		{
+			WaveSimulator Float(ERROR_MAP_SIZE, ERROR_MAP_SIZE);
+			WaveSimulator Fixed(ERROR_MAP_SIZE, ERROR_MAP_SIZE);
+			if (!TEST_CHECK(PrepareErrorSimulator(&Float, WaveSimulator::PRECISION_FLOAT32)) ||
+				!TEST_CHECK(PrepareErrorSimulator(&Fixed, WaveSimulator::PRECISION_FLOAT32)))
+			{
+				return;
+			}
+
+			Float.Step(CheckStep[i]);
+			Fixed.Step(CheckStep[i]);
+
+			// 固定小数点を経由して両方の状態を固定小数点で表せる値にそろえる.
+			Float.SetPrecision(WaveSimulator::PRECISION_FIXED16);
+			Float.SetPrecision(WaveSimulator::PRECISION_FLOAT32);
+			Fixed.SetPrecision(WaveSimulator::PRECISION_FIXED16);
+
+			Float.Step();
+			Fixed.Step();
+			Fixed.SetPrecision(WaveSimulator::PRECISION_FLOAT32);
+			MaxError = std::max(MaxError, GetMaxStateError(Float, Fixed));
+
+			Float.Finalize();
+			Fixed.Finalize();
+		}
+
+		printf("  step error: %.2f LSB\n", MaxError * FixedWaveSolver::m_FixedOne);
+		TEST_CHECK(MaxError <= FixedWaveSolver::m_MaxStepError);
+	}
+
+	/**
+	 * 浮動小数点と固定小数点をそれぞれ進めた波マップの差がm_MaxOutputError以下で, 波が収まると1以下になるか確認する
+	 * @param[in] _simdType 命令セット
+	 */
+	void CheckOutputError(CpuFeature::SIMD_TYPE _simdType)
+	{
+		WaveSimulator Float(ERROR_MAP_SIZE, ERROR_MAP_SIZE);
+		WaveSimulator Fixed(ERROR_MAP_SIZE, ERROR_MAP_SIZE);
+		if (!TEST_CHECK(PrepareErrorSimulator(&Float, WaveSimulator::PRECISION_FLOAT32)) ||
+			!TEST_CHECK(PrepareErrorSimulator(&Fixed, WaveSimulator::PRECISION_FIXED16)))
+		{
+			return;
+		}
+
+		Float.SetSimdType(_simdType);
+		Fixed.SetSimdType(_simdType);
+
+		const int RowPitch = ERROR_MAP_SIZE * 4;
+		std::vector<unsigned char> FloatMap(RowPitch * ERROR_MAP_SIZE);
+		std::vector<unsigned char> FixedMap(RowPitch * ERROR_MAP_SIZE);
+		int MaxError = 0;
+		int SettleError = 0;
+		for (int i = 0; i < ERROR_STEP_NUM; i++)
+		{
+			Float.Step();
+			Fixed.Step();
+			Float.WriteWaveMap(&FloatMap[0], RowPitch);
+			Fixed.WriteWaveMap(&FixedMap[0], RowPitch);
+
+			int Error = GetMaxMapError(FloatMap, FixedMap);
+			MaxError = std::max(MaxError, Error);
+			if (i >= ERROR_STEP_NUM - SETTLE_STEP_NUM)
+			{
+				SettleError = std::max(SettleError, Error);
+			}
+		}
+
+		printf("  output error %s: max %d settle %d\n", CpuFeature::GetSimdName(_simdType), MaxError, SettleError);
+		TEST_CHECK(MaxError <= FixedWaveSolver::m_MaxOutputError);
+		TEST_CHECK(SettleError <= 1);
+
+		Float.Finalize();
+		Fixed.Finalize();
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+
+	WaveObstacleMask ObstacleMask;
+	TEST_CHECK(WaveTestUtility::BuildObstacleMask(&ObstacleMask));
+
+	// 固定小数点は命令セット, スレッド, 障害物の有無によらずスカラーとビット単位で同じになる.
+	for (int m = 0; m < 2; m++)
+	{
+		WaveTestUtility::CONFIG Reference = WaveTestUtility::GetReferenceConfig();
+		Reference.Precision = WaveSimulator::PRECISION_FIXED16;
+		Reference.pObstacleMask = m == 0 ? nullptr : &ObstacleMask;
+
+		WaveTestUtility::STATE ReferenceState;
+		if (!TEST_CHECK(WaveTestUtility::Run(Reference, &ReferenceState)))
+		{
+			continue;
+		}
+		TEST_CHECK(WaveTestUtility::IsWaveMoved(ReferenceState));
+
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int p = 0; p < 2; p++)
+			{
+				WaveTestUtility::CONFIG Config = Reference;
+				Config.SimdType = SimdTypes[s];
+				Config.pThreadPool = p == 0 ? nullptr : &Pool;
+				WaveTestUtility::CheckSame(Config, ReferenceState, "fixed16");
+			}
+		}
+	}
+
+	// 浮動小数点との差は公開している誤差の上限に収まる.
+	CheckStepError();
+	for (size_t s = 0; s < SimdTypes.size(); s++)
+	{
+		CheckOutputError(SimdTypes[s]);
+	}
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("FixedWaveSolverTest");
+}
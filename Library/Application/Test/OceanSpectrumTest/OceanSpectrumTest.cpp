@@ -0,0 +1,266 @@
+﻿/**
+ * @file	OceanSpectrumTest.cpp
+ * @brief	海の波スペクトル生成と2次元高速フーリエ変換のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\OceanSpectrum\OceanSpectrum.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const double PI = 3.14159265358979323846;	//!< 円周率.
+	const double GRAVITY = 9.81;				//!< 重力加速度(OceanSpectrum::m_Gravity).
+	const int OCEAN_SIZE = 128;					//!< スペクトルの格子の幅と高さ.
+	const float PATCH_SIZE = 200.0f;			//!< 格子が覆うワールド座標の大きさ.
+	const float WIND_SPEED = 6.0f;				//!< 風速.
+	const int SAMPLE_TIME_NUM = 8;				//!< 分散を平均する時刻の数.
+	const double MAX_ENERGY_ERROR = 0.2;		//!< 高さの分散とスペクトルの積分の許容する比の誤差.
+
+	/**
+	 * 2次元の逆変換を定義どおりに計算する(x = Σ X(k) exp(+2πi k・n / N))
+	 * @param[in] _size 配列の幅と高さ
+	 * @param[in] _real 実部
+	 * @param[in] _imag 虚部
+	 * @param[out] _pReal 変換後の実部
+	 * @param[out] _pImag 変換後の虚部
+	 */
+	void InverseDFT(int _size, const std::vector<float>& _real, const std::vector<float>& _imag, std::vector<double>* _pReal, std::vector<double>* _pImag)
+	{
+		_pReal->assign(_size * _size, 0.0);
+		_pImag->assign(_size * _size, 0.0);
+
+		for (int y = 0; y < _size; y++)
+		{
+			for (int x = 0; x < _size; x++)
+			{
+				double SumReal = 0.0;
+				double SumImag = 0.0;
+				for (int ky = 0; ky < _size; ky++)
+				{
+					for (int kx = 0; kx < _size; kx++)
+					{
+						// 位相は整数のまま折り返して誤差を抑える.
+						double Phase = 2.0 * PI * static_cast<double>((kx * x + ky * y) % _size) / _size;
+						double Cos = std::cos(Phase);
+						double Sin = std::sin(Phase);
+						double Real = _real[ky * _size + kx];
+						double Imag = _imag[ky * _size + kx];
+						SumReal += Real * Cos - Imag * Sin;
+						SumImag += Real * Sin + Imag * Cos;
+					}
+				}
+
+				(*_pReal)[y * _size + x] = SumReal;
+				(*_pImag)[y * _size + x] = SumImag;
+			}
+		}
+	}
+
+	/**
+	 * OceanFFTの逆変換を, 全ての命令セットとスレッドプールの有無で定義どおりの計算と比較する
+	 * @param[in] _size 配列の幅と高さ
+	 * @param[in] _simdTypes 命令セット
+	 * @param[in] _pThreadPool スレッドプール
+	 */
+	void CheckFFT(int _size, const std::vector<CpuFeature::SIMD_TYPE>& _simdTypes, ThreadPool* _pThreadPool)
+	{
+		std::vector<float> Real(_size * _size);
+		std::vector<float> Imag(_size * _size);
+		unsigned int Seed = 777 + _size;
+		for (int i = 0; i < _size * _size; i++)
+		{
+			Seed = Seed * 1664525 + 1013904223;
+			Real[i] = static_cast<float>(Seed >> 8) / 16777216.0f - 0.5f;
+			Seed = Seed * 1664525 + 1013904223;
+			Imag[i] = static_cast<float>(Seed >> 8) / 16777216.0f - 0.5f;
+		}
+
+		std::vector<double> ExpectReal;
+		std::vector<double> ExpectImag;
+		InverseDFT(_size, Real, Imag, &ExpectReal, &ExpectImag);
+
+		double MaxValue = 0.0;
+		for (int i = 0; i < _size * _size; i++)
+		{
+			MaxValue = std::max(MaxValue, std::fabs(ExpectReal[i]));
+			MaxValue = std::max(MaxValue, std::fabs(ExpectImag[i]));
+		}
+
+		OceanFFT FFT(_size);
+		if (!TEST_CHECK(FFT.Initialize()))
+		{
+			return;
+		}
+
+		for (size_t s = 0; s < _simdTypes.size(); s++)
+		{
+			for (int p = 0; p < 2; p++)
+			{
+				std::vector<float> OutReal = Real;
+				std::vector<float> OutImag = Imag;
+				FFT.SetSimdType(_simdTypes[s]);
+				FFT.SetThreadPool(p == 0 ? nullptr : _pThreadPool);
+				FFT.Inverse2D(&OutReal[0], &OutImag[0]);
+
+				// 各要素はN^2個の値の和なので, 最大の値に対する相対誤差で見る.
+				double MaxError = 0.0;
+				for (int i = 0; i < _size * _size; i++)
+				{
+					MaxError = std::max(MaxError, std::fabs(OutReal[i] - ExpectReal[i]));
+					MaxError = std::max(MaxError, std::fabs(OutImag[i] - ExpectImag[i]));
+				}
+
+				if (!TEST_CHECK(MaxError < MaxValue * 1e-5))
+				{
+					printf("  fft: size %d %s pool=%d error %g max %g\n",
+						_size, CpuFeature::GetSimdName(_simdTypes[s]), p, MaxError, MaxValue);
+				}
+			}
+		}
+
+		FFT.Finalize();
+	}
+
+	/**
+	 * 格子で表せる範囲のJONSWAPスペクトルの積分(高さの分散)を求める
+	 * @return 分散
+	 */
+	double GetJonswapVariance()
+	{
+		// 格子1つ分の波数からナイキスト周波数までの角周波数で, S(ω)を数値積分する.
+		double WaveNumberStep = 2.0 * PI / PATCH_SIZE;
+		double MinOmega = std::sqrt(GRAVITY * WaveNumberStep);
+		double MaxOmega = std::sqrt(GRAVITY * WaveNumberStep * OCEAN_SIZE / 2);
+		double PeakOmega = 0.855 * GRAVITY / WIND_SPEED;
+		const double Step = 1e-4;
+
+		double Variance = 0.0;
+		for (double Omega = MinOmega + Step * 0.5; Omega < MaxOmega; Omega += Step)
+		{
+			double Sigma = Omega <= PeakOmega ? 0.07 : 0.09;
+			double Peak = std::exp(-(Omega - PeakOmega) * (Omega - PeakOmega) / (2.0 * Sigma * Sigma * PeakOmega * PeakOmega));
+			double PeakRatio = PeakOmega / Omega;
+			Variance += 0.0081 * GRAVITY * GRAVITY / std::pow(Omega, 5.0)
+				* std::exp(-1.25 * PeakRatio * PeakRatio * PeakRatio * PeakRatio)
+				* std::pow(3.3, Peak) * Step;
+		}
+
+		return Variance;
+	}
+
+	/**
+	 * 複数の時刻の高さの平均と分散を求める
+	 * @param[in] _pSpectrum スペクトル
+	 * @param[out] _pMean 平均の出力先
+	 * @param[out] _pVariance 分散の出力先
+	 */
+	void GetHeightVariance(OceanSpectrum* _pSpectrum, double* _pMean, double* _pVariance)
+	{
+		const int CellNum = OCEAN_SIZE * OCEAN_SIZE;
+		double Sum = 0.0;
+		double SquareSum = 0.0;
+		for (int t = 0; t < SAMPLE_TIME_NUM; t++)
+		{
+			_pSpectrum->Update(static_cast<float>(t) * 3.7f);
+
+			const float* pHeight = _pSpectrum->GetHeight();
+			for (int i = 0; i < CellNum; i++)
+			{
+				Sum += pHeight[i];
+				SquareSum += static_cast<double>(pHeight[i]) * pHeight[i];
+			}
+		}
+
+		*_pMean = Sum / (CellNum * SAMPLE_TIME_NUM);
+		*_pVariance = SquareSum / (CellNum * SAMPLE_TIME_NUM) - *_pMean * *_pMean;
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+
+	// 基数4だけの大きさ(16, 64)と基数2のステージを含む大きさ(32)で, 定義どおりの逆変換と一致する.
+	const int FFTSize[] = { 16, 32, 64 };
+	for (int i = 0; i < 3; i++)
+	{
+		CheckFFT(FFTSize[i], SimdTypes, &Pool);
+	}
+
+	// 2の累乗でない大きさは作成できない.
+	OceanFFT InvalidFFT(48);
+	TEST_CHECK(!InvalidFFT.Initialize());
+
+	OceanSpectrum Spectrum(OCEAN_SIZE, PATCH_SIZE);
+	if (!TEST_CHECK(Spectrum.Initialize()))
+	{
+		return TestUtility::Finish("OceanSpectrumTest");
+	}
+	Spectrum.SetThreadPool(&Pool);
+	Spectrum.SetSpectrum(OceanSpectrum::SPECTRUM_JONSWAP);
+	Spectrum.SetWind(WIND_SPEED, 1.0f, 0.3f);
+
+	// 高さの平均は0で, 分散は格子で表せる範囲のスペクトルの積分と一致する.
+	double Mean = 0.0;
+	double Variance = 0.0;
+	GetHeightVariance(&Spectrum, &Mean, &Variance);
+	double ExpectVariance = GetJonswapVariance();
+	TEST_CHECK(std::fabs(Mean) < std::sqrt(Variance) * 1e-3);
+	if (!TEST_CHECK(std::fabs(Variance / ExpectVariance - 1.0) < MAX_ENERGY_ERROR))
+	{
+		printf("  energy: variance %g expect %g\n", Variance, ExpectVariance);
+	}
+
+	// 波の高さの倍率は分散を2乗で変える.
+	Spectrum.SetAmplitude(2.0f);
+	double ScaledMean = 0.0;
+	double ScaledVariance = 0.0;
+	GetHeightVariance(&Spectrum, &ScaledMean, &ScaledVariance);
+	TEST_CHECK(std::fabs(ScaledVariance / Variance - 4.0) < 1e-3);
+	Spectrum.SetAmplitude(1.0f);
+
+	// 風が強いほど波は高くなる.
+	Spectrum.SetWind(WIND_SPEED * 1.5f, 1.0f, 0.3f);
+	double StrongMean = 0.0;
+	double StrongVariance = 0.0;
+	GetHeightVariance(&Spectrum, &StrongMean, &StrongVariance);
+	TEST_CHECK(StrongVariance > Variance * 2.0);
+	Spectrum.SetWind(WIND_SPEED, 1.0f, 0.3f);
+
+	// 波は繰り返しの周期で同じ形に戻る.
+	const float RepeatTime = 20.0f;
+	Spectrum.SetRepeatTime(RepeatTime);
+	Spectrum.Update(1.5f);
+	std::vector<float> Height(Spectrum.GetHeight(), Spectrum.GetHeight() + OCEAN_SIZE * OCEAN_SIZE);
+	Spectrum.Update(1.5f + RepeatTime * 3.0f);
+	float MaxRepeatError = 0.0f;
+	for (int i = 0; i < OCEAN_SIZE * OCEAN_SIZE; i++)
+	{
+		MaxRepeatError = std::max(MaxRepeatError, std::fabs(Spectrum.GetHeight()[i] - Height[i]));
+	}
+	TEST_CHECK(MaxRepeatError < static_cast<float>(std::sqrt(Variance)) * 1e-3f);
+
+	Spectrum.Finalize();
+	Pool.Finalize();
+
+	return TestUtility::Finish("OceanSpectrumTest");
+}
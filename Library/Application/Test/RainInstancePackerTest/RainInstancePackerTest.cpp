@@ -0,0 +1,177 @@
+﻿/**
+ * @file	RainInstancePackerTest.cpp
+ * @brief	雨粒のインスタンスデータ書き込みのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Rain\RainInstancePacker\RainInstancePacker.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Rain\RainParticles\RainParticles.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const int PARTICLE_NUM = RainParticles::CHUNK_SIZE * 2 + 13;	//!< 雨粒の数(チャンクとSIMDの幅で割り切れない数).
+	const int FRAME_NUM = 90;										//!< 書き込むフレーム数.
+	const int INSTANCE_STRIDE = 16;									//!< インスタンスデータ1つのバイト数(Rain::INSTANCE_DATA).
+	const float GUARD_VALUE = -12345.0f;							//!< 書き込み先の後ろに置く値.
+
+	/**
+	 * Rain.fxが読み出した1つの雨粒
+	 */
+	struct DECODE_DATA
+	{
+		float Pos[3];		//!< 位置座標.
+		bool IsFall;		//!< 頂点シェーダーで落下中のビルボードにするか(w == 0).
+		bool IsRipple;		//!< ピクセルシェーダーで波紋のテクスチャを使うか(w > 0).
+		float Scale;		//!< 波紋の大きさ.
+	};
+
+	/**
+	 * Rain.fxと同じく, 16byteのインスタンスデータを読み出す
+	 */
+	DECODE_DATA Decode(const unsigned char* _pInstance)
+	{
+		float Position[4];
+		std::memcpy(Position, _pInstance, sizeof(Position));
+
+		DECODE_DATA Data;
+		Data.Pos[0] = Position[0];
+		Data.Pos[1] = Position[1];
+		Data.Pos[2] = Position[2];
+		Data.IsFall = Position[3] == 0.0f;
+		Data.IsRipple = Position[3] > 0.0f;
+		Data.Scale = Position[3];
+		return Data;
+	}
+
+	/**
+	 * 全ての雨粒を書き込み, 読み出した位置と状態と波紋の大きさがパーティクルと一致するか
+	 * @param[out] _pFallNum 落下中の雨粒の数の合計
+	 * @param[out] _pRippleNum 波紋を出している雨粒の数の合計
+	 * @param[out] _pMaxScaleError 波紋の大きさの最大誤差
+	 */
+	bool CheckRoundTrip(
+		const RainParticles& _particles, const std::vector<float>& _instance, int* _pFallNum, int* _pRippleNum,
+		float* _pMaxScaleError)
+	{
+		const unsigned char* pInstance = reinterpret_cast<const unsigned char*>(_instance.data());
+		bool IsMatch = true;
+
+		for (int i = 0; i < PARTICLE_NUM; i++)
+		{
+			DECODE_DATA Data = Decode(pInstance + i * INSTANCE_STRIDE);
+			float RippleTime = _particles.GetRippleTime()[i];
+
+			// 位置はfloatのまま渡すので完全に一致する.
+			IsMatch = IsMatch &&
+				Data.Pos[0] == _particles.GetPosX()[i] &&
+				Data.Pos[1] == _particles.GetPosY()[i] &&
+				Data.Pos[2] == _particles.GetPosZ()[i];
+
+			// 頂点シェーダーとピクセルシェーダーの判定が食い違わない.
+			IsMatch = IsMatch && Data.IsFall != Data.IsRipple && Data.IsFall == (RippleTime == 0.0f);
+
+			if (Data.IsRipple)
+			{
+				float Error = std::fabs(Data.Scale - RainParticles::GetRippleScale(RippleTime));
+				*_pMaxScaleError = Error > *_pMaxScaleError ? Error : *_pMaxScaleError;
+				(*_pRippleNum)++;
+			}
+			else
+			{
+				(*_pFallNum)++;
+			}
+		}
+
+		return IsMatch;
+	}
+
+	/**
+	 * 命令セットとスレッドプールによらず, 書き込んだインスタンスデータが読み出せるか
+	 */
+	void TestPack(ThreadPool* _pThreadPool)
+	{
+		std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int p = 0; p < 2; p++)
+			{
+				// 水面(高さ0)の上から落とす.
+				RainParticles Particles;
+				Particles.SetSimdType(SimdTypes[s]);
+				Particles.SetSpawnArea(-50.0f, 50.0f, 0.0f, 30.0f, -50.0f, 50.0f);
+				Particles.SetCapacity(PARTICLE_NUM, 1234);
+
+				RainInstancePacker Packer;
+				Packer.SetSimdType(SimdTypes[s]);
+				Packer.SetThreadPool(p == 0 ? nullptr : _pThreadPool);
+
+				// 書き込み先の後ろには書き込まない.
+				std::vector<float> Instance(PARTICLE_NUM * 4 + 4, GUARD_VALUE);
+
+				bool IsMatch = true;
+				int FallNum = 0;
+				int RippleNum = 0;
+				float MaxScaleError = 0.0f;
+				for (int Frame = 0; Frame < FRAME_NUM; Frame++)
+				{
+					Particles.Update();
+					Packer.Pack(&Particles, Instance.data());
+					IsMatch = CheckRoundTrip(Particles, Instance, &FallNum, &RippleNum, &MaxScaleError) && IsMatch;
+				}
+
+				bool IsGuard = true;
+				for (int i = PARTICLE_NUM * 4; i < PARTICLE_NUM * 4 + 4; i++)
+				{
+					IsGuard = IsGuard && Instance[i] == GUARD_VALUE;
+				}
+
+				// 波紋の大きさは式を展開した分の丸め誤差(数ulp)だけずれる.
+				if (!TEST_CHECK(IsMatch && IsGuard && FallNum > 0 && RippleNum > 0 && MaxScaleError <= 4e-6f))
+				{
+					printf("  %s pool=%d: match=%d guard=%d fall=%d ripple=%d scale error=%g\n",
+						CpuFeature::GetSimdName(SimdTypes[s]), p, IsMatch ? 1 : 0, IsGuard ? 1 : 0,
+						FallNum, RippleNum, MaxScaleError);
+				}
+			}
+		}
+	}
+
+	/**
+	 * 最初と最後の波紋の大きさが正になり, 落下中と区別できるか
+	 */
+	void TestRippleScale()
+	{
+		TEST_CHECK(RainParticles::GetRippleScale(1.0f) == RainParticles::m_RippleStartScale);
+		TEST_CHECK(RainParticles::GetRippleScale(1.0f) > 0.0f);
+		TEST_CHECK(RainParticles::m_RippleScaleSpeed > 0.0f);
+		TEST_CHECK(RainParticles::GetRippleScale(RainParticles::m_RippleEndTime - 1.0f) > RainParticles::m_RippleStartScale);
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	TestRippleScale();
+	TestPack(&Pool);
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("RainInstancePackerTest");
+}
@@ -0,0 +1,251 @@
+﻿/**
+ * @file	RainParticlesTest.cpp
+ * @brief	雨粒パーティクルと地形の着水のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\FieldManager\TerrainHeightField\TerrainHeightField.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Rain\RainOcclusionMap\RainOcclusionMap.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Rain\RainParticles\RainParticles.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const float TERRAIN_SCALE = 3.5f;		//!< 地面と山のスケーリング値(Ground, Mountain).
+	const float MAP_MIN_X = -180.0f;		//!< 遮蔽高さマップの左端(Rain::m_OcclusionMapPos).
+	const float MAP_MAX_Z = 180.0f;			//!< 遮蔽高さマップの上端(Rain::m_OcclusionMapPos).
+	const float MAP_SIZE = 360.0f;			//!< 遮蔽高さマップの大きさ(Rain::m_OcclusionMapSize).
+	const int MAP_CELL_NUM = 360;			//!< 遮蔽高さマップのセルの数(Rain::m_OcclusionCellNum).
+	const float ROOF_HEIGHT = 16.0f;		//!< 家の屋根の高さ(House::m_RoofHeight).
+	const int PARTICLE_NUM = 20000;			//!< 雨粒の数.
+	const int FRAME_NUM = 120;				//!< 更新するフレーム数.
+
+	/**
+	 * 家の位置と回転(ObjectManager)
+	 */
+	const float HOUSE[][3] =
+	{
+		{ 0, 45, 0 }, { 20, 45, 0 }, { 40, 45, 0 }, { 0, 95, 180 }, { 20, 95, 180 }, { 40, 95, 180 },
+		{ 80, 80, -90 }, { 80, 60, -90 }, { 80, 40, -90 }, { 80, 20, -90 }, { -100, 20, 90 }, { -100, 40, 90 }
+	};
+	const int HOUSE_NUM = sizeof(HOUSE) / sizeof(HOUSE[0]);
+
+	/**
+	 * 地面と山の高さマップを作成(アプリケーションのディレクトリで実行する)
+	 */
+	bool BuildTerrain(TerrainHeightField* _pTerrain, ThreadPool* _pThreadPool)
+	{
+		_pTerrain->AddModel("Resource/Model/map.fbx", TERRAIN_SCALE, TERRAIN_SCALE, TERRAIN_SCALE);
+		_pTerrain->AddModel("Resource/Model/mountain.fbx", TERRAIN_SCALE, TERRAIN_SCALE, TERRAIN_SCALE);
+		_pTerrain->SetThreadPool(_pThreadPool);
+		bool IsSuccess = _pTerrain->Build(nullptr, 1.0f);
+		_pTerrain->SetThreadPool(nullptr);
+
+		return IsSuccess;
+	}
+
+	/**
+	 * 家は平らな地面にあり, 山は基準の高さより高いか. まとめて取得しても同じ高さになるか
+	 */
+	void TestTerrain(const TerrainHeightField& _terrain)
+	{
+		for (int i = 0; i < HOUSE_NUM; i++)
+		{
+			TEST_CHECK(_terrain.GetHeight(HOUSE[i][0], HOUSE[i][1]) == 0.0f);
+		}
+
+		// 東西の山.
+		float EastHeight = _terrain.GetHeight(150.0f, 0.0f);
+		float WestHeight = _terrain.GetHeight(-150.0f, 0.0f);
+		printf("Terrain height at x=+150: %.2f, x=-150: %.2f\n", EastHeight, WestHeight);
+		TEST_CHECK(EastHeight > 15.0f && WestHeight > 15.0f);
+
+		std::vector<float> X, Z;
+		for (int z = -170; z <= 170; z += 17)
+		{
+			for (int x = -170; x <= 170; x += 13)
+			{
+				X.push_back(static_cast<float>(x) + 0.3f);
+				Z.push_back(static_cast<float>(z) - 0.6f);
+			}
+		}
+
+		int Count = static_cast<int>(X.size());
+		std::vector<float> Height(Count);
+		_terrain.SampleHeight(X.data(), Z.data(), Count, Height.data());
+
+		bool IsSame = true;
+		for (int i = 0; i < Count; i++)
+		{
+			IsSame = IsSame && std::fabs(Height[i] - _terrain.GetHeight(X[i], Z[i])) <= 1e-4f;
+		}
+		TEST_CHECK(IsSame);
+
+		// 法線は単位ベクトルで上を向き, 家のある平らな地面では真上を向く.
+		std::vector<float> NormalX(Count), NormalY(Count), NormalZ(Count);
+		_terrain.SampleNormal(X.data(), Z.data(), Count, NormalX.data(), NormalY.data(), NormalZ.data());
+
+		bool IsUnit = true;
+		bool IsSlope = false;
+		for (int i = 0; i < Count; i++)
+		{
+			float Length = std::sqrt(NormalX[i] * NormalX[i] + NormalY[i] * NormalY[i] + NormalZ[i] * NormalZ[i]);
+			IsUnit = IsUnit && std::fabs(Length - 1.0f) <= 1e-3f && NormalY[i] > 0.0f;
+			IsSlope = IsSlope || NormalY[i] < 0.9f;
+		}
+		TEST_CHECK(IsUnit);
+		TEST_CHECK(IsSlope);
+
+		float HouseX[HOUSE_NUM], HouseZ[HOUSE_NUM];
+		float HouseNormalX[HOUSE_NUM], HouseNormalY[HOUSE_NUM], HouseNormalZ[HOUSE_NUM];
+		for (int i = 0; i < HOUSE_NUM; i++)
+		{
+			HouseX[i] = HOUSE[i][0];
+			HouseZ[i] = HOUSE[i][1];
+		}
+		_terrain.SampleNormal(HouseX, HouseZ, HOUSE_NUM, HouseNormalX, HouseNormalY, HouseNormalZ);
+		for (int i = 0; i < HOUSE_NUM; i++)
+		{
+			TEST_CHECK(HouseNormalX[i] == 0.0f && HouseNormalY[i] == 1.0f && HouseNormalZ[i] == 0.0f);
+		}
+	}
+
+	/**
+	 * 遮蔽高さマップが地形と屋根の高い方になり, 水面より低い地形は水面になるか
+	 */
+	void TestOcclusionMap(const TerrainHeightField& _terrain, const RainOcclusionMap& _map)
+	{
+		// セルの中心の地形の高さ.
+		const float Pos[][2] = { { 150.5f, -0.5f }, { -149.5f, 40.5f }, { -20.5f, 140.5f } };
+		for (int i = 0; i < 3; i++)
+		{
+			float Height = _terrain.GetHeight(Pos[i][0], Pos[i][1]);
+			TEST_CHECK(Height > 0.0f);
+			TEST_CHECK(std::fabs(_map.GetHeight(Pos[i][0], Pos[i][1]) - Height) <= 1e-4f);
+		}
+
+		for (int i = 0; i < HOUSE_NUM; i++)
+		{
+			TEST_CHECK(_map.GetHeight(HOUSE[i][0], HOUSE[i][1]) == ROOF_HEIGHT);
+		}
+
+		TEST_CHECK(_map.GetHeight(-20.5f, -20.5f) == _map.GetBaseHeight());
+		TEST_CHECK(_terrain.GetHeight(-159.5f, 159.5f) < 0.0f);
+		TEST_CHECK(_map.GetHeight(-159.5f, 159.5f) == _map.GetBaseHeight());
+	}
+
+	/**
+	 * 山の上の雨粒は地面を通り抜けずに地面で着水し, 水面の雨粒は水面の下まで落ちてから着水するか
+	 * @param[in] _simdType 命令セット
+	 * @param[out] _pPosY 最後のフレームの雨粒のy座標の出力先
+	 */
+	void TestLand(const RainOcclusionMap& _map, ThreadPool* _pThreadPool, CpuFeature::SIMD_TYPE _simdType, std::vector<float>* _pPosY)
+	{
+		RainParticles Particles;
+		Particles.SetThreadPool(_pThreadPool);
+		Particles.SetSimdType(_simdType);
+		Particles.SetOcclusionMap(&_map);
+
+		// 東の山から水面にかかる範囲(高さはRainと同じく山より上から落とす).
+		Particles.SetSpawnArea(100.0f, 175.0f, 40.0f, 80.0f, -60.0f, 60.0f);
+		Particles.SetCapacity(PARTICLE_NUM, 1234);
+
+		bool IsAboveGround = true;
+		bool IsOnSurface = true;
+		int GroundLandNum = 0;
+		int WaterLandNum = 0;
+		for (int Frame = 0; Frame < FRAME_NUM; Frame++)
+		{
+			Particles.Update();
+			WaterLandNum += Particles.GetLandedNum();
+
+			for (int i = 0; i < PARTICLE_NUM; i++)
+			{
+				float Ground = _map.GetHeight(Particles.GetPosX()[i], Particles.GetPosZ()[i]);
+				bool IsWater = Ground <= _map.GetBaseHeight();
+				float Y = Particles.GetPosY()[i];
+				float RippleTime = Particles.GetRippleTime()[i];
+
+				if (RippleTime == 0.0f)
+				{
+					// 落下中は地面より上にあり, 水面の上では水面の下まで落ちる.
+					IsAboveGround = IsAboveGround && Y > Ground + (IsWater ? RainParticles::m_LandHeight : 0.0f);
+				}
+				else if (RippleTime == 1.0f)
+				{
+					IsOnSurface = IsOnSurface && Y == Ground + RainParticles::m_SurfaceHeight;
+					GroundLandNum += IsWater ? 0 : 1;
+				}
+			}
+		}
+
+		if (!TEST_CHECK(IsAboveGround && IsOnSurface && GroundLandNum > 0 && WaterLandNum > 0))
+		{
+			printf("  %s: above=%d surface=%d ground=%d water=%d\n", CpuFeature::GetSimdName(_simdType),
+				IsAboveGround ? 1 : 0, IsOnSurface ? 1 : 0, GroundLandNum, WaterLandNum);
+		}
+
+		_pPosY->assign(Particles.GetPosY(), Particles.GetPosY() + PARTICLE_NUM);
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	TerrainHeightField Terrain;
+	if (TEST_CHECK(BuildTerrain(&Terrain, &Pool)))
+	{
+		TestTerrain(Terrain);
+
+		RainOcclusionMap Map;
+		Map.SetWorldArea(MAP_MIN_X, MAP_MAX_Z, MAP_SIZE, MAP_SIZE);
+		Map.SetTerrain(&Terrain);
+		for (int i = 0; i < HOUSE_NUM; i++)
+		{
+			const float PI = 3.14159265f;
+			Map.AddBox(HOUSE[i][0], HOUSE[i][1], 8.0f, 7.0f, HOUSE[i][2] * PI / 180.0f, ROOF_HEIGHT);
+		}
+
+		if (TEST_CHECK(Map.Build(MAP_CELL_NUM, MAP_CELL_NUM)))
+		{
+			TestOcclusionMap(Terrain, Map);
+
+			// 命令セットによらずスカラーと同じ結果になる.
+			std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+			std::vector<float> ReferencePosY;
+			for (size_t s = 0; s < SimdTypes.size(); s++)
+			{
+				std::vector<float> PosY;
+				TestLand(Map, &Pool, SimdTypes[s], &PosY);
+				if (s == 0)
+				{
+					ReferencePosY = PosY;
+				}
+				else if (!TEST_CHECK(std::memcmp(PosY.data(), ReferencePosY.data(), sizeof(float) * PARTICLE_NUM) == 0))
+				{
+					printf("  %s differs from scalar\n", CpuFeature::GetSimdName(SimdTypes[s]));
+				}
+			}
+		}
+	}
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("RainParticlesTest");
+}
@@ -0,0 +1,287 @@
+﻿/**
+ * @file	ReflectFrustumCullerTest.cpp
+ * @brief	反射カメラの視錐台カリングのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Main\Application\Scene\GameScene\Task\ReflectMapDrawTask\ReflectFrustumCuller\ReflectFrustumCuller.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const float PI = 3.14159265f;	//!< 円周率.
+
+	/**
+	 * 4x4の行列(行優先, 行ベクトル形式)
+	 */
+	struct MATRIX
+	{
+		float m[4][4];
+	};
+
+	/**
+	 * 行列の積(_a * _b)
+	 */
+	MATRIX Multiply(const MATRIX& _a, const MATRIX& _b)
+	{
+		MATRIX Result = {};
+		for (int i = 0; i < 4; i++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				for (int k = 0; k < 4; k++)
+				{
+					Result.m[i][j] += _a.m[i][k] * _b.m[k][j];
+				}
+			}
+		}
+
+		return Result;
+	}
+
+	/**
+	 * D3DXMatrixPerspectiveFovLHと同じ透視投影行列
+	 */
+	MATRIX GetPerspective(float _fovY, float _aspect, float _nearZ, float _farZ)
+	{
+		float ScaleY = 1.0f / std::tan(_fovY * 0.5f);
+		MATRIX Result = {};
+		Result.m[0][0] = ScaleY / _aspect;
+		Result.m[1][1] = ScaleY;
+		Result.m[2][2] = _farZ / (_farZ - _nearZ);
+		Result.m[2][3] = 1.0f;
+		Result.m[3][2] = -_nearZ * _farZ / (_farZ - _nearZ);
+		return Result;
+	}
+
+	/**
+	 * D3DXMatrixLookAtLHと同じビュー行列
+	 */
+	MATRIX GetLookAt(const float* _pEye, const float* _pAt)
+	{
+		float AxisZ[3] = { _pAt[0] - _pEye[0], _pAt[1] - _pEye[1], _pAt[2] - _pEye[2] };
+		float LengthZ = std::sqrt(AxisZ[0] * AxisZ[0] + AxisZ[1] * AxisZ[1] + AxisZ[2] * AxisZ[2]);
+		for (int i = 0; i < 3; i++)
+		{
+			AxisZ[i] /= LengthZ;
+		}
+
+		// 上方向は(0, 1, 0)とする.
+		float AxisX[3] = { AxisZ[2], 0.0f, -AxisZ[0] };
+		float LengthX = std::sqrt(AxisX[0] * AxisX[0] + AxisX[2] * AxisX[2]);
+		AxisX[0] /= LengthX;
+		AxisX[2] /= LengthX;
+
+		float AxisY[3] =
+		{
+			AxisZ[1] * AxisX[2] - AxisZ[2] * AxisX[1],
+			AxisZ[2] * AxisX[0] - AxisZ[0] * AxisX[2],
+			AxisZ[0] * AxisX[1] - AxisZ[1] * AxisX[0]
+		};
+
+		MATRIX Result = {};
+		for (int i = 0; i < 3; i++)
+		{
+			Result.m[i][0] = AxisX[i];
+			Result.m[i][1] = AxisY[i];
+			Result.m[i][2] = AxisZ[i];
+			Result.m[3][0] -= AxisX[i] * _pEye[i];
+			Result.m[3][1] -= AxisY[i] * _pEye[i];
+			Result.m[3][2] -= AxisZ[i] * _pEye[i];
+		}
+
+		Result.m[3][3] = 1.0f;
+		return Result;
+	}
+
+	/**
+	 * 視錐台の平面から球の中心までの距離の最小値(ビュー空間で計算する, 負なら外側)
+	 */
+	float GetViewDistance(
+		const MATRIX& _view, float _fovY, float _aspect, float _nearZ, float _farZ, float _x, float _y, float _z)
+	{
+		float View[3];
+		for (int i = 0; i < 3; i++)
+		{
+			View[i] = _x * _view.m[0][i] + _y * _view.m[1][i] + _z * _view.m[2][i] + _view.m[3][i];
+		}
+
+		float ScaleY = 1.0f / std::tan(_fovY * 0.5f);
+		float ScaleX = ScaleY / _aspect;
+		float InvLengthX = 1.0f / std::sqrt(ScaleX * ScaleX + 1.0f);
+		float InvLengthY = 1.0f / std::sqrt(ScaleY * ScaleY + 1.0f);
+
+		float Distance[6] =
+		{
+			(View[2] + View[0] * ScaleX) * InvLengthX,
+			(View[2] - View[0] * ScaleX) * InvLengthX,
+			(View[2] + View[1] * ScaleY) * InvLengthY,
+			(View[2] - View[1] * ScaleY) * InvLengthY,
+			View[2] - _nearZ,
+			_farZ - View[2]
+		};
+
+		float MinDistance = Distance[0];
+		for (int i = 1; i < 6; i++)
+		{
+			MinDistance = Distance[i] < MinDistance ? Distance[i] : MinDistance;
+		}
+
+		return MinDistance;
+	}
+
+	/**
+	 * 原点から+Zを向いた視野角90度のカメラで, 各平面の外側の球が半径の境目で判定が変わるか
+	 */
+	void TestPlane()
+	{
+		MATRIX Identity = {};
+		for (int i = 0; i < 4; i++)
+		{
+			Identity.m[i][i] = 1.0f;
+		}
+
+		MATRIX ViewProj = Multiply(Identity, GetPerspective(PI * 0.5f, 1.0f, 1.0f, 100.0f));
+
+		ReflectFrustumCuller Culler;
+		Culler.SetWaterHeight(-1000.0f);
+
+		// 行列を設定するまでは何も除外しない.
+		TEST_CHECK(Culler.IsVisible(0.0f, 0.0f, -500.0f, 1.0f));
+
+		Culler.SetViewProjection(&ViewProj.m[0][0]);
+
+		// 左右上下の平面は|x| = z, |y| = zなので, 平面からの距離は(z - |x|) / √2になる.
+		const float Center[6][3] =
+		{
+			{ -20, 0, 10 }, { 20, 0, 10 }, { 0, -20, 10 }, { 0, 20, 10 }, { 0, 0, -2 }, { 0, 0, 105 }
+		};
+		const float Distance[6] = { 10 / std::sqrt(2.0f), 10 / std::sqrt(2.0f), 10 / std::sqrt(2.0f), 10 / std::sqrt(2.0f), 3, 5 };
+
+		for (int i = 0; i < 6; i++)
+		{
+			bool IsInside = Culler.IsVisible(Center[i][0], Center[i][1], Center[i][2], Distance[i] * 0.98f);
+			bool IsTouch = Culler.IsVisible(Center[i][0], Center[i][1], Center[i][2], Distance[i] * 1.02f);
+			if (!TEST_CHECK(!IsInside && IsTouch))
+			{
+				printf("  plane %d: %d %d\n", i, IsInside, IsTouch);
+			}
+		}
+
+		// 中の点は写る.
+		TEST_CHECK(Culler.IsVisible(0.0f, 0.0f, 50.0f, 0.0f));
+		TEST_CHECK(Culler.IsVisible(9.0f, -9.0f, 10.0f, 0.0f));
+	}
+
+	/**
+	 * 水面より完全に下の球は写らないか
+	 */
+	void TestWaterHeight()
+	{
+		MATRIX ViewProj = GetPerspective(PI * 0.5f, 1.0f, 1.0f, 100.0f);
+
+		ReflectFrustumCuller Culler;
+		Culler.SetViewProjection(&ViewProj.m[0][0]);
+		Culler.SetWaterHeight(2.0f);
+
+		TEST_CHECK(!Culler.IsVisible(0.0f, -1.1f, 50.0f, 3.0f));
+		TEST_CHECK(Culler.IsVisible(0.0f, -0.9f, 50.0f, 3.0f));
+		TEST_CHECK(Culler.IsVisible(0.0f, 2.0f, 50.0f, 0.0f));
+	}
+
+	/**
+	 * 水面で反転させた見上げるカメラで, ビュー空間で計算した距離と判定が一致し, まとめた判定が1つずつの判定と一致するか
+	 */
+	void TestReflectCamera()
+	{
+		const float FovY = PI * 80.0f / 180.0f;
+		const float Aspect = 16.0f / 9.0f;
+		const float NearZ = 1.0f;
+		const float FarZ = 700.0f;
+
+		// 反射カメラはカメラの位置と注視点をy = 0で反転させて作る(MainCamera::Update).
+		const float Eye[3] = { 30.0f, -40.0f, -80.0f };
+		const float At[3] = { -10.0f, -5.0f, 60.0f };
+		MATRIX View = GetLookAt(Eye, At);
+		MATRIX ViewProj = Multiply(View, GetPerspective(FovY, Aspect, NearZ, FarZ));
+
+		ReflectFrustumCuller Culler;
+		Culler.SetViewProjection(&ViewProj.m[0][0]);
+		Culler.SetWaterHeight(-1000.0f);
+
+		const int SphereNum = 4000;
+		std::mt19937 Random(1234);
+		std::uniform_real_distribution<float> Position(-800.0f, 800.0f);
+		std::uniform_real_distribution<float> Radius(0.0f, 60.0f);
+
+		std::vector<float> Spheres(SphereNum * 4);
+		int ExpectVisibleNum = 0;
+		int MismatchNum = 0;
+		for (int i = 0; i < SphereNum; i++)
+		{
+			float* pSphere = &Spheres[i * 4];
+			pSphere[0] = Position(Random);
+			pSphere[1] = Position(Random) * 0.25f;
+			pSphere[2] = Position(Random);
+			pSphere[3] = Radius(Random);
+
+			// 平面ごとの判定は保守的なので, 全ての平面の内側か, ある平面の完全に外側の球だけを比べる.
+			float Distance = GetViewDistance(View, FovY, Aspect, NearZ, FarZ, pSphere[0], pSphere[1], pSphere[2]);
+			bool IsVisible = Culler.IsVisible(pSphere[0], pSphere[1], pSphere[2], pSphere[3]);
+			if (Distance >= 0.01f)
+			{
+				MismatchNum += IsVisible ? 0 : 1;
+			}
+			else if (Distance + pSphere[3] < -0.01f)
+			{
+				MismatchNum += IsVisible ? 1 : 0;
+			}
+
+			ExpectVisibleNum += IsVisible ? 1 : 0;
+		}
+
+		if (!TEST_CHECK(MismatchNum == 0))
+		{
+			printf("  reflect camera: %d mismatches\n", MismatchNum);
+		}
+
+		// 無作為な配置なら両方の判定が十分に含まれる.
+		TEST_CHECK(ExpectVisibleNum > SphereNum / 20 && ExpectVisibleNum < SphereNum - SphereNum / 20);
+
+		std::vector<char> IsVisible(SphereNum + 1, 2);
+		bool* pIsVisible = reinterpret_cast<bool*>(&IsVisible[0]);
+		int VisibleNum = Culler.CullSpheres(&Spheres[0], SphereNum, pIsVisible);
+		TEST_CHECK(VisibleNum == ExpectVisibleNum);
+
+		int SameNum = 0;
+		for (int i = 0; i < SphereNum; i++)
+		{
+			SameNum += pIsVisible[i] == Culler.IsVisible(Spheres[i * 4], Spheres[i * 4 + 1], Spheres[i * 4 + 2], Spheres[i * 4 + 3]) ? 1 : 0;
+		}
+
+		TEST_CHECK(SameNum == SphereNum);
+
+		// 範囲外には書き込まない.
+		TEST_CHECK(IsVisible[SphereNum] == 2);
+		TEST_CHECK(Culler.CullSpheres(&Spheres[0], 0, pIsVisible) == 0);
+	}
+}
+
+
+int main()
+{
+	TestPlane();
+	TestWaterHeight();
+	TestReflectCamera();
+
+	return TestUtility::Finish("ReflectFrustumCullerTest");
+}
@@ -0,0 +1,264 @@
+﻿/**
+ * @file	SmokeComputeKernelTest.cpp
+ * @brief	煙パーティクルのコンピュートカーネルのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\House\Smoke\SmokeComputeKernel\SmokeComputeKernel.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	typedef SmokeComputeKernel::PARTICLE PARTICLE;
+	typedef SmokeComputeKernel::CONSTANT CONSTANT;
+
+	const int LIFE_FRAME = 300;			//!< パーティクルの寿命(Smoke::m_LifeFrame).
+	const int EMITTER_NUM = 12;			//!< エミッタの数(家の数).
+	const int EMITTER_PARTICLE_NUM = 600;	//!< エミッタごとのパーティクルの数(Smoke::m_ComputeParticleNum).
+
+	/**
+	 * Compute.fxのCSをそのまま書き写した1スレッド分の計算
+	 */
+	void ComputeShader(const CONSTANT& _constant, PARTICLE* _pData)
+	{
+		PARTICLE Data = *_pData;
+
+		float ActivePos[4], ActiveState[4];
+		const float ActiveDelta[4] = { -1.0f, _constant.ScaleSpeed, -_constant.AlphaSpeed, 0.0f };
+		for (int i = 0; i < 4; i++)
+		{
+			ActivePos[i] = Data.Pos[i] + Data.Vel[i];
+			ActiveState[i] = Data.State[i] + ActiveDelta[i];
+		}
+		ActivePos[3] = ActiveState[0] <= 0.0f ? 0.0f : ActivePos[3];
+
+		float InactiveState[4] = { Data.State[0] + 1.0f, Data.State[1] + 0.0f, Data.State[2] + 0.0f, Data.State[3] + 0.0f };
+		bool IsSpawn = InactiveState[0] >= _constant.LifeFrame;
+		float InactivePos[4];
+		for (int i = 0; i < 4; i++)
+		{
+			InactivePos[i] = IsSpawn ? Data.Emitter[i] : Data.Pos[i];
+		}
+		if (IsSpawn)
+		{
+			InactiveState[1] = 1.0f;
+			InactiveState[2] = 1.0f;
+			InactiveState[3] = 0.0f;
+		}
+
+		bool IsActive = Data.Pos[3] > 0.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			_pData->Pos[i] = IsActive ? ActivePos[i] : InactivePos[i];
+			_pData->State[i] = IsActive ? ActiveState[i] : InactiveState[i];
+		}
+	}
+
+	/**
+	 * 定数の作成
+	 */
+	CONSTANT CreateConstant(int _particleNum)
+	{
+		CONSTANT Constant = { static_cast<float>(LIFE_FRAME), 0.01f, 0.003f, static_cast<unsigned int>(_particleNum) };
+		return Constant;
+	}
+
+	/**
+	 * Smoke::CreateComputeDataと同じ並びのパーティクルを作成
+	 */
+	void CreateParticle(int _particleNum, std::vector<PARTICLE>* _pParticle)
+	{
+		std::mt19937 Random(1234);
+		std::uniform_real_distribution<float> Velocity(-0.05f, 0.05f);
+
+		_pParticle->resize(_particleNum);
+		for (int i = 0; i < _particleNum; i++)
+		{
+			int Emitter = i / EMITTER_PARTICLE_NUM;
+			SmokeComputeKernel::ResetParticle(
+				&(*_pParticle)[i],
+				static_cast<float>(Emitter * 20), 25.0f, 45.0f,
+				Velocity(Random), 0.1f + Velocity(Random), Velocity(Random),
+				static_cast<float>(LIFE_FRAME), i % EMITTER_PARTICLE_NUM + 1);
+		}
+	}
+
+	/**
+	 * 活動中のパーティクルの数
+	 */
+	int GetActiveNum(const std::vector<PARTICLE>& _particle, int _particleNum)
+	{
+		int ActiveNum = 0;
+		for (int i = 0; i < _particleNum; i++)
+		{
+			ActiveNum += _particle[i].Pos[3] > 0.0f ? 1 : 0;
+		}
+
+		return ActiveNum;
+	}
+
+	/**
+	 * 1つのパーティクルが出現, 活動, 待機を寿命の2倍の周期で繰り返し, Compute.fxと同じ値になるか
+	 */
+	void TestCycle()
+	{
+		const int SpawnFrame = 7;
+		CONSTANT Constant = CreateConstant(1);
+
+		PARTICLE Particle;
+		SmokeComputeKernel::ResetParticle(&Particle, 1.0f, 2.0f, 3.0f, 0.01f, 0.1f, -0.02f, Constant.LifeFrame, SpawnFrame);
+		PARTICLE Reference = Particle;
+
+		SmokeComputeKernel Kernel;
+		Kernel.SetSimdType(CpuFeature::SIMD_SCALAR);
+
+		bool IsSame = true;
+		bool IsCycle = true;
+		for (int Frame = 1; Frame <= SpawnFrame + LIFE_FRAME * 4; Frame++)
+		{
+			Kernel.Dispatch(Constant, &Particle, 1);
+			ComputeShader(Constant, &Reference);
+			IsSame = IsSame && std::memcmp(&Particle, &Reference, sizeof(PARTICLE)) == 0;
+
+			// 出現したフレームから寿命の間だけ活動する.
+			int Phase = (Frame - SpawnFrame) % (LIFE_FRAME * 2);
+			bool IsActive = Frame >= SpawnFrame && Phase < LIFE_FRAME;
+			IsCycle = IsCycle && (Particle.Pos[3] > 0.0f) == IsActive;
+
+			if (Frame >= SpawnFrame && Phase == 0)
+			{
+				IsCycle = IsCycle &&
+					Particle.Pos[0] == 1.0f && Particle.Pos[1] == 2.0f && Particle.Pos[2] == 3.0f &&
+					Particle.State[0] == Constant.LifeFrame && Particle.State[1] == 1.0f && Particle.State[2] == 1.0f;
+			}
+		}
+
+		TEST_CHECK(IsSame);
+		TEST_CHECK(IsCycle);
+	}
+
+	/**
+	 * 全てのパーティクルが出現した後は, エミッタごとに寿命と同じ数が常に活動しているか
+	 */
+	void TestActiveNum()
+	{
+		int ParticleNum = EMITTER_NUM * EMITTER_PARTICLE_NUM;
+		CONSTANT Constant = CreateConstant(ParticleNum);
+
+		std::vector<PARTICLE> Particle;
+		CreateParticle(ParticleNum, &Particle);
+
+		SmokeComputeKernel Kernel;
+		int GroupNum = SmokeComputeKernel::GetGroupNum(ParticleNum);
+
+		bool IsRampUp = true;
+		bool IsSteady = true;
+		for (int Frame = 1; Frame <= 1300; Frame++)
+		{
+			Kernel.Dispatch(Constant, &Particle[0], GroupNum);
+
+			int ActiveNum = GetActiveNum(Particle, ParticleNum);
+			if (Frame < LIFE_FRAME)
+			{
+				IsRampUp = IsRampUp && ActiveNum == EMITTER_NUM * Frame;
+			}
+			else
+			{
+				IsSteady = IsSteady && ActiveNum == EMITTER_NUM * LIFE_FRAME;
+			}
+		}
+
+		TEST_CHECK(IsRampUp);
+		TEST_CHECK(IsSteady);
+		TEST_CHECK(GetActiveNum(Particle, ParticleNum) == 3600);
+	}
+
+	/**
+	 * 命令セットとスレッドプールによらずスカラーと同じ結果になり, ParticleNum以降は書き換えないか
+	 */
+	void TestSimd(ThreadPool* _pThreadPool)
+	{
+		// スレッドグループの大きさで割り切れず, AVX2の2つずつでも余りが出る数にする.
+		const int ParticleNum = EMITTER_NUM * EMITTER_PARTICLE_NUM + 37;
+		const int GuardNum = SmokeComputeKernel::THREAD_GROUP_SIZE * 2;
+		CONSTANT Constant = CreateConstant(ParticleNum);
+
+		std::vector<PARTICLE> Initial;
+		CreateParticle(ParticleNum + GuardNum, &Initial);
+
+		// 途中の状態からも始まるように, 一部のパーティクルは活動中にしておく.
+		for (int i = 0; i < ParticleNum; i += 3)
+		{
+			Initial[i].Pos[3] = 1.0f;
+			Initial[i].State[0] = static_cast<float>(i % LIFE_FRAME);
+		}
+
+		std::vector<PARTICLE> Reference = Initial;
+		for (int Frame = 0; Frame < LIFE_FRAME * 2 + 50; Frame++)
+		{
+			for (int i = 0; i < ParticleNum; i++)
+			{
+				ComputeShader(Constant, &Reference[i]);
+			}
+		}
+
+		std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int p = 0; p < 2; p++)
+			{
+				SmokeComputeKernel Kernel;
+				Kernel.SetSimdType(SimdTypes[s]);
+				Kernel.SetThreadPool(p == 0 ? nullptr : _pThreadPool);
+
+				// 必要な数より多いグループを実行しても, ParticleNum以降のスレッドは何もしない.
+				std::vector<PARTICLE> Particle = Initial;
+				int GroupNum = SmokeComputeKernel::GetGroupNum(ParticleNum) + 1;
+				for (int Frame = 0; Frame < LIFE_FRAME * 2 + 50; Frame++)
+				{
+					Kernel.Dispatch(Constant, &Particle[0], GroupNum);
+				}
+
+				bool IsSame = std::memcmp(&Particle[0], &Reference[0], sizeof(PARTICLE) * ParticleNum) == 0;
+				bool IsGuard = std::memcmp(&Particle[ParticleNum], &Initial[ParticleNum], sizeof(PARTICLE) * GuardNum) == 0;
+				if (!TEST_CHECK(IsSame && IsGuard))
+				{
+					printf("  %s pool=%d same=%d guard=%d\n", CpuFeature::GetSimdName(SimdTypes[s]), p, IsSame ? 1 : 0, IsGuard ? 1 : 0);
+				}
+			}
+		}
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	TEST_CHECK(SmokeComputeKernel::GetGroupNum(0) == 0);
+	TEST_CHECK(SmokeComputeKernel::GetGroupNum(1) == 1);
+	TEST_CHECK(SmokeComputeKernel::GetGroupNum(SmokeComputeKernel::THREAD_GROUP_SIZE) == 1);
+	TEST_CHECK(SmokeComputeKernel::GetGroupNum(SmokeComputeKernel::THREAD_GROUP_SIZE + 1) == 2);
+
+	TestCycle();
+	TestActiveNum();
+	TestSimd(&Pool);
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("SmokeComputeKernelTest");
+}
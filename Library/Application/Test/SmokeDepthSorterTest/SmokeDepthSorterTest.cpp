@@ -0,0 +1,291 @@
+﻿/**
+ * @file	SmokeDepthSorterTest.cpp
+ * @brief	煙パーティクルの深度ソートのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\House\Smoke\SmokeDepthSorter\SmokeDepthSorter.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const int SLOT_NUM = 12 * 300;	//!< スロットの数(家の数 * Smoke::m_LifeFrame).
+
+	/**
+	 * 深度を求める平面
+	 */
+	struct PLANE
+	{
+		float A;	//!< xの係数.
+		float B;	//!< yの係数.
+		float C;	//!< zの係数.
+		float D;	//!< 定数項.
+	};
+
+	/**
+	 * スロットの座標
+	 */
+	struct POSITION
+	{
+		std::vector<float> X;	//!< x座標.
+		std::vector<float> Y;	//!< y座標.
+		std::vector<float> Z;	//!< z座標.
+	};
+
+	/**
+	 * SmokeDepthSorterと同じ順番で深度を求める
+	 */
+	float GetDepth(const PLANE& _plane, const POSITION& _pos, int _slot)
+	{
+		return ((_pos.X[_slot] * _plane.A + _pos.Y[_slot] * _plane.B) + _pos.Z[_slot] * _plane.C) + _plane.D;
+	}
+
+	/**
+	 * 並べた順番が生きているスロットを並べ替えたもので, 奥から手前に並び, 同じ深度は渡した順番のままか
+	 * @param[in] _isStable 同じ深度のスロットが渡した順番のままであることも確認するか
+	 */
+	bool IsBackToFront(
+		const PLANE& _plane, const POSITION& _pos, const std::vector<int>& _liveSlot, const int* _pOrder, bool _isStable)
+	{
+		int LiveNum = static_cast<int>(_liveSlot.size());
+		if (LiveNum == 0)
+		{
+			return true;
+		}
+
+		std::vector<int> LiveRank(SLOT_NUM, -1);
+		for (int i = 0; i < LiveNum; i++)
+		{
+			LiveRank[_liveSlot[i]] = i;
+		}
+
+		std::vector<bool> IsUsed(SLOT_NUM, false);
+		for (int i = 0; i < LiveNum; i++)
+		{
+			int Slot = _pOrder[i];
+			if (Slot < 0 || Slot >= SLOT_NUM || LiveRank[Slot] < 0 || IsUsed[Slot])
+			{
+				return false;
+			}
+			IsUsed[Slot] = true;
+
+			if (i == 0)
+			{
+				continue;
+			}
+
+			float PrevDepth = GetDepth(_plane, _pos, _pOrder[i - 1]);
+			float Depth = GetDepth(_plane, _pos, Slot);
+			if (PrevDepth < Depth)
+			{
+				return false;
+			}
+
+			// ビット列まで同じ深度は同じキーになる.
+			if (_isStable && std::memcmp(&PrevDepth, &Depth, sizeof(float)) == 0 && LiveRank[_pOrder[i - 1]] > LiveRank[Slot])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * 生きているスロットを並べる
+	 */
+	const int* Sort(
+		SmokeDepthSorter* _pSorter, const PLANE& _plane, const POSITION& _pos, const std::vector<int>& _liveSlot)
+	{
+		_pSorter->SetDepthPlane(_plane.A, _plane.B, _plane.C, _plane.D);
+		_pSorter->Sort(
+			_pos.X.data(), _pos.Y.data(), _pos.Z.data(), SLOT_NUM,
+			_liveSlot.empty() ? nullptr : _liveSlot.data(), static_cast<int>(_liveSlot.size()));
+
+		return _pSorter->GetOrder();
+	}
+
+	/**
+	 * 正と負の深度, 同じ深度, ±0を含むスロットを基数ソートで奥から手前に並べられるか
+	 */
+	void TestRadixSort()
+	{
+		std::mt19937 Random(1234);
+		std::uniform_real_distribution<float> Coord(-50.0f, 50.0f);
+
+		// カメラのビュー行列の3列目を想定した斜めの平面で, 原点の前後に深度が分かれる.
+		const PLANE Plane = { 0.36f, -0.48f, 0.8f, 0.0f };
+
+		POSITION Pos;
+		Pos.X.resize(SLOT_NUM);
+		Pos.Y.resize(SLOT_NUM);
+		Pos.Z.resize(SLOT_NUM);
+		const float SameZ[] = { -2.5f, 0.0f, -0.0f, 3.0f, -37.25f };
+		for (int i = 0; i < SLOT_NUM; i++)
+		{
+			// 4つに1つは同じ座標(同じ深度)にする.
+			bool IsSame = (i & 3) == 0;
+			Pos.X[i] = IsSame ? 0.0f : Coord(Random);
+			Pos.Y[i] = IsSame ? 0.0f : Coord(Random);
+			Pos.Z[i] = IsSame ? SameZ[(i >> 2) % 5] : Coord(Random);
+		}
+
+		// 死んだスロットを除き, 生きているスロットは順番を混ぜて渡す.
+		std::vector<int> LiveSlot;
+		for (int i = 0; i < SLOT_NUM; i++)
+		{
+			if (i % 7 != 3)
+			{
+				LiveSlot.push_back(i);
+			}
+		}
+		std::shuffle(LiveSlot.begin(), LiveSlot.end(), Random);
+
+		int NegativeNum = 0;
+		for (size_t i = 0; i < LiveSlot.size(); i++)
+		{
+			NegativeNum += GetDepth(Plane, Pos, LiveSlot[i]) < 0.0f ? 1 : 0;
+		}
+		TEST_CHECK(NegativeNum > 0 && NegativeNum < static_cast<int>(LiveSlot.size()));
+
+		std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+		std::vector<int> Reference;
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			SmokeDepthSorter Sorter;
+			Sorter.SetSimdType(SimdTypes[s]);
+			Sorter.SetIncremental(false);
+
+			const int* pOrder = Sort(&Sorter, Plane, Pos, LiveSlot);
+			bool IsSorted = IsBackToFront(Plane, Pos, LiveSlot, pOrder, true) && !Sorter.IsIncrementalSorted();
+
+			// 命令セットによらず同じ順番になる.
+			std::vector<int> Order(pOrder, pOrder + LiveSlot.size());
+			if (s == 0)
+			{
+				Reference = Order;
+			}
+
+			if (!TEST_CHECK(IsSorted && Order == Reference))
+			{
+				printf("  %s: sorted=%d same=%d\n", CpuFeature::GetSimdName(SimdTypes[s]), IsSorted ? 1 : 0, Order == Reference ? 1 : 0);
+			}
+		}
+
+		SmokeDepthSorter Sorter;
+		Sorter.SetIncremental(false);
+
+		// 全て同じ深度なら渡した順番のまま.
+		const PLANE FlatPlane = { 0.0f, 0.0f, 0.0f, -4.0f };
+		const int* pOrder = Sort(&Sorter, FlatPlane, Pos, LiveSlot);
+		TEST_CHECK(std::equal(LiveSlot.begin(), LiveSlot.end(), pOrder));
+
+		// 深度の範囲が狭く上位の桁が全て同じでも並べられる.
+		const PLANE NarrowPlane = { 0.0f, 0.0f, 1e-4f, 100.0f };
+		TEST_CHECK(IsBackToFront(NarrowPlane, Pos, LiveSlot, Sort(&Sorter, NarrowPlane, Pos, LiveSlot), true));
+
+		// 全て負の深度(カメラの後ろ).
+		const PLANE BehindPlane = { Plane.A, Plane.B, Plane.C, -200.0f };
+		TEST_CHECK(IsBackToFront(BehindPlane, Pos, LiveSlot, Sort(&Sorter, BehindPlane, Pos, LiveSlot), true));
+
+		// 生きているスロットが無い.
+		Sort(&Sorter, Plane, Pos, std::vector<int>());
+		TEST_CHECK(Sorter.GetOrder() == nullptr);
+	}
+
+	/**
+	 * 少しずつ動くパーティクルを差分ソートで並べ, カメラが大きく動いたら基数ソートに切り替えるか
+	 */
+	void TestIncrementalSort()
+	{
+		std::mt19937 Random(5678);
+		std::uniform_real_distribution<float> Coord(-50.0f, 50.0f);
+		std::uniform_real_distribution<float> Move(-0.05f, 0.05f);
+
+		POSITION Pos;
+		Pos.X.resize(SLOT_NUM);
+		Pos.Y.resize(SLOT_NUM);
+		Pos.Z.resize(SLOT_NUM);
+		for (int i = 0; i < SLOT_NUM; i++)
+		{
+			Pos.X[i] = Coord(Random);
+			Pos.Y[i] = Coord(Random);
+			Pos.Z[i] = Coord(Random);
+		}
+
+		PLANE Plane = { 0.6f, 0.0f, 0.8f, 5.0f };
+
+		SmokeDepthSorter Sorter;
+		TEST_CHECK(Sorter.IsIncremental());
+
+		// リングのように古いスロットが消えて新しいスロットが出現する.
+		const int LiveNum = SLOT_NUM * 3 / 4;
+		const int SpawnNum = 12;
+		int LiveBegin = 0;
+		bool IsSorted = true;
+		int IncrementalNum = 0;
+		const int FrameNum = 60;
+		for (int Frame = 0; Frame < FrameNum; Frame++)
+		{
+			std::vector<int> LiveSlot(LiveNum);
+			for (int i = 0; i < LiveNum; i++)
+			{
+				LiveSlot[i] = (LiveBegin + i) % SLOT_NUM;
+			}
+
+			IsSorted = IsSorted && IsBackToFront(Plane, Pos, LiveSlot, Sort(&Sorter, Plane, Pos, LiveSlot), false);
+			IncrementalNum += Sorter.IsIncrementalSorted() ? 1 : 0;
+
+			LiveBegin = (LiveBegin + SpawnNum) % SLOT_NUM;
+			for (int i = 0; i < SLOT_NUM; i++)
+			{
+				Pos.X[i] += Move(Random);
+				Pos.Y[i] += Move(Random);
+				Pos.Z[i] += Move(Random);
+			}
+			Plane.D += 0.01f;
+		}
+
+		// 最初のフレームだけは前の順番が無いので基数ソートになる.
+		if (!TEST_CHECK(IsSorted && IncrementalNum == FrameNum - 1))
+		{
+			printf("  incremental: sorted=%d incremental=%d / %d\n", IsSorted ? 1 : 0, IncrementalNum, FrameNum);
+		}
+
+		// カメラが反対を向くと前の順番は逆順になるので, 差分ソートをやめて並べ直す.
+		std::vector<int> LiveSlot(LiveNum);
+		for (int i = 0; i < LiveNum; i++)
+		{
+			LiveSlot[i] = (LiveBegin + i) % SLOT_NUM;
+		}
+		const PLANE FlipPlane = { -Plane.A, -Plane.B, -Plane.C, -Plane.D };
+		TEST_CHECK(IsBackToFront(FlipPlane, Pos, LiveSlot, Sort(&Sorter, FlipPlane, Pos, LiveSlot), true));
+		TEST_CHECK(!Sorter.IsIncrementalSorted());
+
+		// 順番を消すと次は基数ソートになる.
+		Sorter.Reset();
+		Sort(&Sorter, FlipPlane, Pos, LiveSlot);
+		TEST_CHECK(!Sorter.IsIncrementalSorted());
+		Sort(&Sorter, FlipPlane, Pos, LiveSlot);
+		TEST_CHECK(Sorter.IsIncrementalSorted());
+	}
+}
+
+
+int main()
+{
+	TestRadixSort();
+	TestIncrementalSort();
+
+	return TestUtility::Finish("SmokeDepthSorterTest");
+}
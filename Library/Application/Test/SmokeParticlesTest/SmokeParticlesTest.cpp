@@ -0,0 +1,367 @@
+﻿/**
+ * @file	SmokeParticlesTest.cpp
+ * @brief	煙パーティクルの計算のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\House\Smoke\SmokeParticles\SmokeParticles.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const float EMIT_RATE = 1.0f;			//!< 1フレームに出現する数(Smoke::m_EmitRate).
+	const int LIFE_FRAME = 300;				//!< パーティクルの寿命(Smoke::m_LifeFrame).
+	const float VELOCITY_X = 0.08f;			//!< 出現時のx方向の速さ(Smoke::m_EmitVelocity).
+	const float VELOCITY_Y = 0.5f;			//!< 出現時のy方向の速さ(Smoke::m_EmitVelocity).
+	const float VELOCITY_Z = 0.08f;			//!< 出現時のz方向の速さ(Smoke::m_EmitVelocity).
+	const float ANGLE_RANGE = 6.0f;			//!< 移動方向のばらつき(Smoke::m_EmitAngleRange).
+	const float SCALE_SPEED = 0.01f;		//!< 1フレームに増える拡大率(Smoke::m_ScaleSpeed).
+	const float ALPHA_SPEED = 1.0f / 512.0f;	//!< 1フレームに減るアルファ値(年齢を誤差無く求められる値).
+	const float EMITTER_SPACING = 1000.0f;	//!< エミッタの間隔(煙が他のエミッタまで届かない距離).
+
+	/**
+	 * Smokeと同じ設定のパーティクルを作る
+	 */
+	void Setup(SmokeParticles* _pParticles, float _emitRate, int _lifeFrame)
+	{
+		_pParticles->SetEmission(_emitRate, _lifeFrame);
+		_pParticles->SetVelocity(VELOCITY_X, VELOCITY_Y, VELOCITY_Z, ANGLE_RANGE);
+		_pParticles->SetGrowth(SCALE_SPEED, ALPHA_SPEED);
+	}
+
+	/**
+	 * アルファ値からパーティクルの年齢を求める
+	 */
+	float GetAge(float _alpha)
+	{
+		return (1.0f - _alpha) / ALPHA_SPEED;
+	}
+
+	/**
+	 * スロットがエミッタの生きている範囲に含まれるか
+	 */
+	bool IsLiveSlot(int _index, int _liveBegin, int _liveNum, int _capacity)
+	{
+		int Offset = _index - _liveBegin;
+		return (Offset < 0 ? Offset + _capacity : Offset) < _liveNum;
+	}
+
+	/**
+	 * エミッタの生きているパーティクルが全てそのエミッタの近くにあるか
+	 */
+	bool IsNearEmitter(const SmokeParticles& _particles, int _emitter, float _x, float _y, float _z)
+	{
+		float MaxDistance = std::max(VELOCITY_X, std::max(VELOCITY_Y, VELOCITY_Z)) * static_cast<float>(LIFE_FRAME);
+		int Capacity = _particles.GetCapacity();
+		int Index = _particles.GetLiveBegin(_emitter);
+
+		for (int i = 0; i < _particles.GetLiveNum(_emitter); i++)
+		{
+			int Slot = _emitter * Capacity + Index;
+			if (std::fabs(_particles.GetPosX()[Slot] - _x) > MaxDistance ||
+				_particles.GetPosY()[Slot] < _y || _particles.GetPosY()[Slot] - _y > MaxDistance ||
+				std::fabs(_particles.GetPosZ()[Slot] - _z) > MaxDistance)
+			{
+				return false;
+			}
+
+			Index = Index + 1 < Capacity ? Index + 1 : 0;
+		}
+
+		return true;
+	}
+
+	/**
+	 * 全てのエミッタが1つのプールを分け合い, 後から追加したエミッタが他のエミッタの領域を壊さないか
+	 */
+	void TestSharedPool()
+	{
+		SmokeParticles Particles;
+		Setup(&Particles, EMIT_RATE, LIFE_FRAME);
+
+		const int EmitterNum = 12;
+		for (int i = 0; i < EmitterNum; i++)
+		{
+			TEST_CHECK(Particles.AddEmitter(static_cast<float>(i) * EMITTER_SPACING, 5.0f, 0.0f, 100 + i) == i);
+		}
+
+		TEST_CHECK(Particles.GetEmitterNum() == EmitterNum);
+		TEST_CHECK(Particles.GetCapacity() == LIFE_FRAME);
+		TEST_CHECK(Particles.GetTotalLiveNum() == 0);
+
+		for (int Frame = 0; Frame < 100; Frame++)
+		{
+			Particles.Update();
+		}
+
+		// 全てのエミッタは同じ出現率なので, 生きている範囲は同じになる.
+		int TotalLiveNum = 0;
+		bool IsSameRange = true;
+		bool IsNear = true;
+		for (int i = 0; i < EmitterNum; i++)
+		{
+			IsSameRange = IsSameRange &&
+				Particles.GetLiveBegin(i) == Particles.GetLiveBegin(0) && Particles.GetLiveNum(i) == Particles.GetLiveNum(0);
+			IsNear = IsNear && IsNearEmitter(Particles, i, static_cast<float>(i) * EMITTER_SPACING, 5.0f, 0.0f);
+			TotalLiveNum += Particles.GetLiveNum(i);
+		}
+
+		TEST_CHECK(Particles.GetLiveNum(0) == 100);
+		TEST_CHECK(IsSameRange && IsNear);
+		TEST_CHECK(Particles.GetTotalLiveNum() == TotalLiveNum);
+
+		// エミッタを追加しても, 既にあるエミッタのパーティクルはそのまま残る.
+		size_t Size = static_cast<size_t>(EmitterNum * Particles.GetCapacity());
+		std::vector<float> PosY(Particles.GetPosY(), Particles.GetPosY() + Size);
+		std::vector<float> Alpha(Particles.GetAlpha(), Particles.GetAlpha() + Size);
+
+		int NewEmitter = Particles.AddEmitter(-EMITTER_SPACING, 50.0f, 0.0f, 7);
+		TEST_CHECK(NewEmitter == EmitterNum);
+		TEST_CHECK(Particles.GetLiveNum(NewEmitter) == 0);
+		TEST_CHECK(std::memcmp(Particles.GetPosY(), PosY.data(), Size * sizeof(float)) == 0);
+		TEST_CHECK(std::memcmp(Particles.GetAlpha(), Alpha.data(), Size * sizeof(float)) == 0);
+
+		Particles.Update();
+		TEST_CHECK(Particles.GetLiveNum(0) == 101 && Particles.GetLiveNum(NewEmitter) == 1);
+		TEST_CHECK(Particles.GetTotalLiveNum() == 101 * EmitterNum + 1);
+		TEST_CHECK(IsNearEmitter(Particles, NewEmitter, -EMITTER_SPACING, 50.0f, 0.0f));
+		TEST_CHECK(IsNearEmitter(Particles, 0, 0.0f, 5.0f, 0.0f));
+	}
+
+	/**
+	 * リングの末尾で折り返しても生きているパーティクルが古い順に隙間無く並び, 死んだスロットは更新しないか
+	 */
+	void TestRing()
+	{
+		// 出現率は1未満, 1, 1より大きいものを試す.
+		const float EmitRate[] = { 0.7f, 1.0f, 2.5f };
+		const int LifeFrame[] = { 10, 12, 8 };
+		const int EmitterNum = 3;
+		const int FrameNum = 100;
+
+		for (int i = 0; i < 3; i++)
+		{
+			SmokeParticles Particles;
+			Setup(&Particles, EmitRate[i], LifeFrame[i]);
+			for (int j = 0; j < EmitterNum; j++)
+			{
+				Particles.AddEmitter(static_cast<float>(j) * EMITTER_SPACING, 0.0f, 0.0f, 1 + j);
+			}
+
+			int Capacity = Particles.GetCapacity();
+			TEST_CHECK(Capacity == static_cast<int>(std::ceil(EmitRate[i] * static_cast<float>(LifeFrame[i]))));
+
+			bool IsOrdered = true;
+			bool IsLiveNum = true;
+			bool IsDeadKeep = true;
+			bool IsStraddle = false;
+			bool IsWrap = false;
+			int MaxGap = static_cast<int>(std::ceil(1.0f / EmitRate[i]));
+			std::vector<float> PrevAlpha;
+			for (int Frame = 1; Frame <= FrameNum; Frame++)
+			{
+				std::vector<int> PrevBegin(EmitterNum), PrevNum(EmitterNum);
+				for (int j = 0; j < EmitterNum; j++)
+				{
+					PrevBegin[j] = Particles.GetLiveBegin(j);
+					PrevNum[j] = Particles.GetLiveNum(j);
+				}
+				PrevAlpha.assign(Particles.GetAlpha(), Particles.GetAlpha() + EmitterNum * Capacity);
+
+				Particles.Update();
+
+				for (int j = 0; j < EmitterNum; j++)
+				{
+					int Base = j * Capacity;
+					int LiveBegin = Particles.GetLiveBegin(j);
+					int LiveNum = Particles.GetLiveNum(j);
+
+					// 古い順に年齢が減り, 出現の間隔より大きな隙間が無く, 寿命を超えたものは残らない.
+					int Index = LiveBegin;
+					float PrevAge = static_cast<float>(LifeFrame[i]);
+					for (int k = 0; k < LiveNum; k++)
+					{
+						float Age = GetAge(Particles.GetAlpha()[Base + Index]);
+						bool IsGap = k > 0 && PrevAge - Age > static_cast<float>(MaxGap);
+						IsOrdered = IsOrdered && Age >= 0.0f && Age <= PrevAge && Age < static_cast<float>(LifeFrame[i]) && !IsGap;
+						PrevAge = Age;
+						Index = Index + 1 < Capacity ? Index + 1 : 0;
+					}
+
+					// 一番新しいパーティクルは出現の間隔以内に出現している.
+					IsOrdered = IsOrdered && (LiveNum == 0 || PrevAge < static_cast<float>(MaxGap));
+
+					// 寿命の間に出現した数だけ生きている.
+					float ExpectNum = EmitRate[i] * static_cast<float>(std::min(Frame, LifeFrame[i]));
+					IsLiveNum = IsLiveNum && LiveNum <= Capacity && std::fabs(static_cast<float>(LiveNum) - ExpectNum) <= 1.0f;
+
+					// 前後のフレームのどちらでも死んでいるスロットは触らない.
+					for (int k = 0; k < Capacity; k++)
+					{
+						if (!IsLiveSlot(k, PrevBegin[j], PrevNum[j], Capacity) && !IsLiveSlot(k, LiveBegin, LiveNum, Capacity))
+						{
+							IsDeadKeep = IsDeadKeep && Particles.GetAlpha()[Base + k] == PrevAlpha[Base + k];
+						}
+					}
+
+					IsStraddle = IsStraddle || LiveBegin + LiveNum > Capacity;
+					IsWrap = IsWrap || LiveBegin < PrevBegin[j];
+				}
+			}
+
+			if (!TEST_CHECK(IsOrdered && IsLiveNum && IsDeadKeep && IsStraddle && IsWrap))
+			{
+				printf("  rate %.1f life %d: ordered=%d live=%d dead=%d straddle=%d wrap=%d\n", EmitRate[i], LifeFrame[i],
+					IsOrdered ? 1 : 0, IsLiveNum ? 1 : 0, IsDeadKeep ? 1 : 0, IsStraddle ? 1 : 0, IsWrap ? 1 : 0);
+			}
+		}
+	}
+
+	/**
+	 * 状態を持たないモードで求めた生きているパーティクルを取得
+	 */
+	std::vector<float> GetLiveState(const SmokeParticles& _particles)
+	{
+		std::vector<float> State;
+		for (int i = 0; i < _particles.GetEmitterNum(); i++)
+		{
+			int Base = i * _particles.GetCapacity() + _particles.GetLiveBegin(i);
+			for (int j = 0; j < _particles.GetLiveNum(i); j++)
+			{
+				State.push_back(_particles.GetPosX()[Base + j]);
+				State.push_back(_particles.GetPosY()[Base + j]);
+				State.push_back(_particles.GetPosZ()[Base + j]);
+				State.push_back(_particles.GetScale()[Base + j]);
+				State.push_back(_particles.GetAlpha()[Base + j]);
+			}
+		}
+
+		return State;
+	}
+
+	/**
+	 * Smokeと同じ設定で, 状態を持たないモードのパーティクルを作る
+	 */
+	void SetupStateless(SmokeParticles* _pParticles, CpuFeature::SIMD_TYPE _simdType, int _emitterNum)
+	{
+		Setup(_pParticles, EMIT_RATE, LIFE_FRAME);
+		_pParticles->SetSimdType(_simdType);
+		_pParticles->SetStateless(true);
+		for (int i = 0; i < _emitterNum; i++)
+		{
+			_pParticles->AddEmitter(static_cast<float>(i) * EMITTER_SPACING, 5.0f, -3.0f, 100 + i);
+		}
+	}
+
+	/**
+	 * 状態を持たないモードの結果が(時刻, 種, エミッタ)だけで決まり, 命令セットと求める順番によらないか
+	 */
+	void TestStateless()
+	{
+		const int EmitterNum = 12;
+		const float Time[] = { 0.0f, 0.5f, 37.0f, 299.75f, 300.0f, 1000.25f };
+		const int TimeNum = sizeof(Time) / sizeof(Time[0]);
+
+		// スカラー版を基準にする.
+		std::vector<std::vector<float>> Reference(TimeNum);
+		{
+			SmokeParticles Particles;
+			SetupStateless(&Particles, CpuFeature::SIMD_SCALAR, EmitterNum);
+			TEST_CHECK(Particles.IsStateless() && Particles.GetTotalLiveNum() == 0);
+
+			for (int i = 0; i < TimeNum; i++)
+			{
+				Particles.Evaluate(Time[i]);
+				Reference[i] = GetLiveState(Particles);
+
+				// n番目のパーティクルは時刻nに出現し, 寿命の間だけ生きている.
+				float Last = std::floor(Time[i] * EMIT_RATE);
+				float First = std::max(std::floor((Time[i] - static_cast<float>(LIFE_FRAME)) * EMIT_RATE) + 1.0f, 0.0f);
+				int ExpectNum = static_cast<int>(Last - First) + 1;
+				TEST_CHECK(Particles.GetLiveNum(0) == ExpectNum && Particles.GetTotalLiveNum() == ExpectNum * EmitterNum);
+				TEST_CHECK(Particles.GetTime() == 0.0f);
+
+				// 古い順に並び, アルファ値は年齢から閉じた式で決まる.
+				bool IsClosedForm = true;
+				for (int j = 0; j < EmitterNum; j++)
+				{
+					int Base = j * Particles.GetCapacity() + Particles.GetLiveBegin(j);
+					for (int k = 0; k < Particles.GetLiveNum(j); k++)
+					{
+						float Age = Time[i] - (First + static_cast<float>(k)) / EMIT_RATE;
+						IsClosedForm = IsClosedForm &&
+							Particles.GetAlpha()[Base + k] == 1.0f - ALPHA_SPEED * Age &&
+							std::fabs(Particles.GetScale()[Base + k] - (1.0f + SCALE_SPEED * Age)) <= 1e-5f &&
+							Particles.GetPosY()[Base + k] >= 5.0f &&
+							Age >= 0.0f && Age < static_cast<float>(LIFE_FRAME);
+					}
+				}
+				TEST_CHECK(IsClosedForm);
+			}
+
+			// 別の時刻を求めてから戻っても同じ結果になる(巻き戻し).
+			Particles.Evaluate(Time[2]);
+			TEST_CHECK(GetLiveState(Particles) == Reference[2]);
+
+			// 種が違うエミッタは別の煙になる.
+			int Base = Particles.GetCapacity();
+			TEST_CHECK(Particles.GetPosX()[Base] - EMITTER_SPACING != Particles.GetPosX()[0] ||
+				Particles.GetPosZ()[Base] != Particles.GetPosZ()[0]);
+		}
+
+		std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			// 新しく作っても, 求める順番を変えても同じ結果になる.
+			SmokeParticles Particles;
+			SetupStateless(&Particles, SimdTypes[s], EmitterNum);
+
+			bool IsSame = true;
+			for (int i = TimeNum - 1; i >= 0; i--)
+			{
+				Particles.Evaluate(Time[i]);
+				IsSame = IsSame && GetLiveState(Particles) == Reference[i];
+			}
+
+			// Updateは時刻を1進めて求める.
+			Particles.SetTime(Time[2] - 3.0f);
+			for (int i = 0; i < 3; i++)
+			{
+				Particles.Update();
+			}
+			IsSame = IsSame && Particles.GetTime() == Time[2] && GetLiveState(Particles) == Reference[2];
+
+			if (!TEST_CHECK(IsSame))
+			{
+				printf("  %s differs from scalar\n", CpuFeature::GetSimdName(SimdTypes[s]));
+			}
+		}
+
+		// 積分するモードに戻すとパーティクルは消える.
+		SmokeParticles Particles;
+		SetupStateless(&Particles, CpuFeature::SIMD_AUTO, EmitterNum);
+		Particles.Evaluate(Time[2]);
+		Particles.SetStateless(false);
+		TEST_CHECK(!Particles.IsStateless() && Particles.GetTotalLiveNum() == 0 && Particles.GetLiveNum(0) == 0);
+	}
+}
+
+
+int main()
+{
+	TestSharedPool();
+	TestRing();
+	TestStateless();
+
+	return TestUtility::Finish("SmokeParticlesTest");
+}
@@ -0,0 +1,60 @@
+﻿/**
+ * @file	TestUtility.cpp
+ * @brief	テスト補助クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "TestUtility.h"
+
+#include <cstdio>
+
+
+//----------------------------------------------------------------------
+// Static Private Variables
+//----------------------------------------------------------------------
+int TestUtility::m_CheckNum = 0;
+int TestUtility::m_FailNum = 0;
+
+
+//----------------------------------------------------------------------
+// Static Public Functions
+//----------------------------------------------------------------------
+bool TestUtility::Check(bool _condition, const char* _pExpression, const char* _pFile, int _line)
+{
+	m_CheckNum++;
+	if (!_condition)
+	{
+		m_FailNum++;
+		printf("%s(%d): failed: %s\n", _pFile, _line, _pExpression);
+	}
+
+	return _condition;
+}
+
+int TestUtility::Finish(const char* _pTestName)
+{
+	printf("%s: %d checks, %d failed\n", _pTestName, m_CheckNum, m_FailNum);
+	return m_FailNum == 0 ? 0 : 1;
+}
+
+std::vector<CpuFeature::SIMD_TYPE> TestUtility::GetSupportSimdTypes()
+{
+	const CpuFeature::SIMD_TYPE SimdTypes[] =
+	{
+		CpuFeature::SIMD_SCALAR, CpuFeature::SIMD_SSE, CpuFeature::SIMD_AVX2, CpuFeature::SIMD_NEON
+	};
+
+	std::vector<CpuFeature::SIMD_TYPE> SupportTypes;
+	for (int i = 0; i < static_cast<int>(sizeof(SimdTypes) / sizeof(SimdTypes[0])); i++)
+	{
+		if (CpuFeature::IsSupport(SimdTypes[i]))
+		{
+			SupportTypes.push_back(SimdTypes[i]);
+		}
+	}
+
+	return SupportTypes;
+}
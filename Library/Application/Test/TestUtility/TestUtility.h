@@ -0,0 +1,61 @@
+﻿/**
+ * @file	TestUtility.h
+ * @brief	テスト補助クラス定義
+ * @author	morimoto
+ */
+#ifndef TESTUTILITY_H
+#define TESTUTILITY_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+
+
+/**
+ * 条件を確認し, 失敗したら式と位置を出力する
+ */
+#define TEST_CHECK(_condition) TestUtility::Check((_condition), #_condition, __FILE__, __LINE__)
+
+
+/**
+ * テスト補助クラス
+ *
+ * 確認の失敗を数え, テストの終了時に結果を出力して終了コードを返す.
+ */
+class TestUtility
+{
+public:
+	/**
+	 * 条件の確認
+	 * @param[in] _condition 確認する条件
+	 * @param[in] _pExpression 条件の式
+	 * @param[in] _pFile 確認したファイル名
+	 * @param[in] _line 確認した行番号
+	 * @return 条件が成り立っていればtrue
+	 */
+	static bool Check(bool _condition, const char* _pExpression, const char* _pFile, int _line);
+
+	/**
+	 * テストの終了
+	 * @param[in] _pTestName テスト名
+	 * @return 全ての確認が成功していれば0, 失敗があれば1(mainの戻り値)
+	 */
+	static int Finish(const char* _pTestName);
+
+	/**
+	 * 実行環境で使用可能な命令セットを取得
+	 * @return スカラーを先頭にした命令セットの配列
+	 */
+	static std::vector<CpuFeature::SIMD_TYPE> GetSupportSimdTypes();
+
+private:
+	static int m_CheckNum;	//!< 確認した数.
+	static int m_FailNum;	//!< 失敗した数.
+
+};
+
+
+#endif // !TESTUTILITY_H
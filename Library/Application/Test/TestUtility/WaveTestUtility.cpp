@@ -0,0 +1,141 @@
+﻿/**
+ * @file	WaveTestUtility.cpp
+ * @brief	波シミュレーションテスト補助クラス実装
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include "WaveTestUtility.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Test\TestUtility\TestUtility.h"
+
+
+//----------------------------------------------------------------------
+// Static Public Variables
+//----------------------------------------------------------------------
+const int WaveTestUtility::m_Width = 203;
+const int WaveTestUtility::m_Height = 141;
+const int WaveTestUtility::m_StepNum = 20;
+
+
+//----------------------------------------------------------------------
+// Static Public Functions
+//----------------------------------------------------------------------
+WaveTestUtility::CONFIG WaveTestUtility::GetReferenceConfig()
+{
+	CONFIG Config =
+	{
+		CpuFeature::SIMD_SCALAR, WaveSimulator::PRECISION_FLOAT32,
+		64, 32, 1, false, nullptr, nullptr
+	};
+
+	return Config;
+}
+
+bool WaveTestUtility::BuildObstacleMask(WaveObstacleMask* _pObstacleMask)
+{
+	_pObstacleMask->SetWorldArea(0.0f, static_cast<float>(m_Height), static_cast<float>(m_Width), static_cast<float>(m_Height));
+	_pObstacleMask->AddRect(70.0f, 80.0f, 9.0f, 5.0f, 0.5f);
+	_pObstacleMask->AddRect(150.0f, 40.0f, 4.0f, 18.0f, 0.0f);
+
+	return _pObstacleMask->Build(m_Width, m_Height) && _pObstacleMask->GetSolidNum() > 0;
+}
+
+bool WaveTestUtility::Prepare(const CONFIG& _config, WaveSimulator* _pSimulator)
+{
+	if (!_pSimulator->Initialize())
+	{
+		return false;
+	}
+
+	_pSimulator->SetSimdType(_config.SimdType);
+	_pSimulator->SetPrecision(_config.Precision);
+	_pSimulator->SetTileSize(_config.TileWidth, _config.TileHeight);
+	_pSimulator->SetBlockStepNum(_config.BlockStepNum);
+	_pSimulator->SetIsSparse(_config.IsSparse);
+	_pSimulator->SetThreadPool(_config.pThreadPool);
+	if (!_pSimulator->SetObstacleMask(_config.pObstacleMask))
+	{
+		return false;
+	}
+
+	// タイルの境界と障害物にかかる波を追加し, 途中でも追加する.
+	_pSimulator->AddWave(0.3f, 0.4f, 0.05f, 0.8f);
+	_pSimulator->AddWave(0.62f, 0.25f, 0.03f, 0.6f);
+	_pSimulator->Step(m_StepNum);
+	_pSimulator->AddWave(0.75f, 0.7f, 0.04f, 0.9f);
+	_pSimulator->AddWave(0.1f, 0.9f, 0.02f, 0.5f);
+	_pSimulator->Step(m_StepNum + 1);
+
+	return true;
+}
+
+bool WaveTestUtility::Run(const CONFIG& _config, STATE* _pState)
+{
+	WaveSimulator Simulator(m_Width, m_Height);
+	if (!Prepare(_config, &Simulator))
+	{
+		return false;
+	}
+
+	_pState->WaveMap.assign(m_Width * m_Height * 4, 0);
+	_pState->NormalMap.assign(m_Width * m_Height * 4, 0);
+	Simulator.StepWithMap(&_pState->WaveMap[0], m_Width * 4, &_pState->NormalMap[0], m_Width * 4);
+
+	_pState->Height.clear();
+	_pState->Velocity.clear();
+	if (_config.Precision == WaveSimulator::PRECISION_FLOAT32)
+	{
+		for (int y = 0; y < m_Height; y++)
+		{
+			_pState->Height.insert(_pState->Height.end(), Simulator.GetHeightRow(y), Simulator.GetHeightRow(y) + m_Width);
+			_pState->Velocity.insert(_pState->Velocity.end(), Simulator.GetVelocityRow(y), Simulator.GetVelocityRow(y) + m_Width);
+		}
+	}
+
+	Simulator.Finalize();
+
+	return true;
+}
+
+bool WaveTestUtility::IsSameState(const STATE& _a, const STATE& _b)
+{
+	return
+		_a.Height.size() == _b.Height.size() &&
+		_a.Velocity.size() == _b.Velocity.size() &&
+		(_a.Height.empty() || std::memcmp(&_a.Height[0], &_b.Height[0], _a.Height.size() * sizeof(float)) == 0) &&
+		(_a.Velocity.empty() || std::memcmp(&_a.Velocity[0], &_b.Velocity[0], _a.Velocity.size() * sizeof(float)) == 0) &&
+		_a.WaveMap == _b.WaveMap &&
+		_a.NormalMap == _b.NormalMap;
+}
+
+bool WaveTestUtility::IsWaveMoved(const STATE& _state)
+{
+	for (size_t i = 0; i < _state.WaveMap.size(); i += 4)
+	{
+		if (_state.WaveMap[i] != _state.WaveMap[0])
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WaveTestUtility::CheckSame(const CONFIG& _config, const STATE& _reference, const char* _pCase)
+{
+	STATE State;
+	bool IsRun = TEST_CHECK(Run(_config, &State));
+	if (IsRun && !TEST_CHECK(IsSameState(State, _reference)))
+	{
+		printf("  %s: %s tile %dx%d K=%d sparse=%d pool=%d mask=%d\n",
+			_pCase, CpuFeature::GetSimdName(_config.SimdType), _config.TileWidth, _config.TileHeight,
+			_config.BlockStepNum, _config.IsSparse ? 1 : 0, _config.pThreadPool != nullptr ? 1 : 0,
+			_config.pObstacleMask != nullptr ? 1 : 0);
+	}
+}
@@ -0,0 +1,115 @@
+﻿/**
+ * @file	WaveTestUtility.h
+ * @brief	波シミュレーションテスト補助クラス定義
+ * @author	morimoto
+ */
+#ifndef WAVETESTUTILITY_H
+#define WAVETESTUTILITY_H
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSimulator.h"
+
+
+class ThreadPool;
+
+
+/**
+ * 波シミュレーションテスト補助クラス
+ *
+ * 各テストで共通のシナリオ(タイルの境界と障害物にかかる波を途中でも追加して進める)を
+ * 設定を変えて実行し, 結果をビット単位で比較する.
+ */
+class WaveTestUtility
+{
+public:
+	/**
+	 * シミュレーションの設定
+	 */
+	struct CONFIG
+	{
+		CpuFeature::SIMD_TYPE		SimdType;		//!< 命令セット.
+		WaveSimulator::PRECISION	Precision;		//!< 計算精度.
+		int							TileWidth;		//!< タイルの幅.
+		int							TileHeight;		//!< タイルの高さ.
+		int							BlockStepNum;	//!< 時間ブロッキングのステップ数.
+		bool						IsSparse;		//!< スパース更新を行うか.
+		ThreadPool*					pThreadPool;	//!< スレッドプール.
+		const WaveObstacleMask*		pObstacleMask;	//!< 障害物マスク.
+	};
+
+	/**
+	 * シミュレーションの結果
+	 */
+	struct STATE
+	{
+		std::vector<float>			Height;		//!< 高さ(固定小数点では空).
+		std::vector<float>			Velocity;	//!< 速度(固定小数点では空).
+		std::vector<unsigned char>	WaveMap;	//!< 最後のステップの波マップ.
+		std::vector<unsigned char>	NormalMap;	//!< 最後のステップの法線マップ.
+	};
+
+	/**
+	 * 基準の設定(スカラー, 浮動小数点, 64x32タイル, K=1, 全タイル更新, 1スレッド, 障害物なし)を取得
+	 * @return 基準の設定
+	 */
+	static CONFIG GetReferenceConfig();
+
+	/**
+	 * 2つの障害物(タイルの境界にかかる矩形と回転した細長い矩形)を配置した障害物マスクを作成
+	 * @param[out] _pObstacleMask 作成先
+	 * @return 作成に成功したらtrue
+	 */
+	static bool BuildObstacleMask(WaveObstacleMask* _pObstacleMask);
+
+	/**
+	 * 設定を適用し, 共通のシナリオを最後のステップの手前まで進める
+	 * @param[in] _config 設定
+	 * @param[in,out] _pSimulator 進めるシミュレーション(m_Width x m_Heightで作成したもの)
+	 * @return 準備に成功したらtrue
+	 */
+	static bool Prepare(const CONFIG& _config, WaveSimulator* _pSimulator);
+
+	/**
+	 * 設定のシミュレーションを実行する
+	 * @param[in] _config 設定
+	 * @param[out] _pState 結果の出力先
+	 * @return 実行に成功したらtrue
+	 */
+	static bool Run(const CONFIG& _config, STATE* _pState);
+
+	/**
+	 * 2つの結果がビット単位で同じか
+	 * @param[in] _a 比較する結果
+	 * @param[in] _b 比較する結果
+	 * @return 同じならtrue
+	 */
+	static bool IsSameState(const STATE& _a, const STATE& _b);
+
+	/**
+	 * 波が伝わっているか(全て初期値のままなら比較の意味がない)
+	 * @param[in] _state 確認する結果
+	 * @return 波マップに初期値と異なる高さがあればtrue
+	 */
+	static bool IsWaveMoved(const STATE& _state);
+
+	/**
+	 * 設定の結果を基準の結果と比較し, 異なれば設定を出力する
+	 * @param[in] _config 設定
+	 * @param[in] _reference 基準の結果
+	 * @param[in] _pCase 出力する比較の名前
+	 */
+	static void CheckSame(const CONFIG& _config, const STATE& _reference, const char* _pCase);
+
+	static const int m_Width;	//!< 波マップの幅(SIMDの幅とタイルの幅で割り切れない大きさ).
+	static const int m_Height;	//!< 波マップの高さ.
+	static const int m_StepNum;	//!< 波を追加してから進めるステップ数.
+
+};
+
+
+#endif // !WAVETESTUTILITY_H
@@ -0,0 +1,237 @@
+﻿/**
+ * @file	WaterClipmapTest.cpp
+ * @brief	水面のクリップマップメッシュ生成のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaterClipmap\WaterClipmap.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const int LEVEL_NUM = 4;			//!< レベルの数.
+	const int GRID_SIZE = 16;			//!< 1レベルのセル数.
+	const int PITCH = GRID_SIZE + 1;	//!< 1レベルの頂点の1行分の数.
+	const float CELL_SIZE = 0.5f;		//!< レベル0のセルの大きさ.
+	const int FADE_LEVEL = 2;			//!< 変位をフェードさせるレベル.
+
+	/**
+	 * レベルの描画するセル(インデックスが覆うセル)を求める
+	 * @param[in] _clipmap クリップマップ
+	 * @param[in] _level レベル
+	 * @param[out] _pCover セルごとの三角形の数(GRID_SIZE x GRID_SIZE)
+	 * @return インデックスが全てレベルの頂点を指していればtrue
+	 */
+	bool GetCover(const WaterClipmap& _clipmap, int _level, std::vector<int>* _pCover)
+	{
+		_pCover->assign(GRID_SIZE * GRID_SIZE, 0);
+
+		const std::vector<unsigned short>& Index = _clipmap.GetIndex();
+		int Start = _clipmap.GetIndexStart(_level);
+		for (int i = Start; i < Start + _clipmap.GetIndexNum(_level); i += 3)
+		{
+			int MinX = GRID_SIZE;
+			int MinZ = GRID_SIZE;
+			for (int j = 0; j < 3; j++)
+			{
+				if (Index[i + j] >= PITCH * PITCH)
+				{
+					return false;
+				}
+
+				MinX = std::min(MinX, Index[i + j] % PITCH);
+				MinZ = std::min(MinZ, Index[i + j] / PITCH);
+			}
+
+			(*_pCover)[MinZ * GRID_SIZE + MinX]++;
+		}
+
+		return true;
+	}
+
+	/**
+	 * 全てのレベルの継ぎ目を確認する
+	 * @param[in] _clipmap 更新済みのクリップマップ
+	 * @param[in] _x カメラのx座標(出力用)
+	 * @param[in] _z カメラのz座標(出力用)
+	 */
+	void CheckSeam(const WaterClipmap& _clipmap, float _x, float _z)
+	{
+		const float* pX = _clipmap.GetVertexX();
+		const float* pZ = _clipmap.GetVertexZ();
+
+		for (int i = 1; i < LEVEL_NUM; i++)
+		{
+			const int Inner = _clipmap.GetBaseVertex(i - 1);
+			const int Outer = _clipmap.GetBaseVertex(i);
+
+			// 穴は描画されず, 穴以外のセルは2つの三角形で1回ずつ覆われる.
+			std::vector<int> Cover;
+			if (!TEST_CHECK(GetCover(_clipmap, i, &Cover)))
+			{
+				continue;
+			}
+
+			// 内側のレベルの左手前の頂点がある外側のレベルの頂点を探す.
+			int HoleX = -1;
+			int HoleZ = -1;
+			for (int v = 0; v < PITCH * PITCH; v++)
+			{
+				if (pX[Outer + v] == pX[Inner] && pZ[Outer + v] == pZ[Inner])
+				{
+					HoleX = v % PITCH;
+					HoleZ = v / PITCH;
+				}
+			}
+
+			bool IsHole = TEST_CHECK(HoleX == GRID_SIZE / 4 || HoleX == GRID_SIZE / 4 + 1);
+			IsHole = TEST_CHECK(HoleZ == GRID_SIZE / 4 || HoleZ == GRID_SIZE / 4 + 1) && IsHole;
+			if (!IsHole)
+			{
+				printf("  hole: camera (%f, %f) level %d\n", _x, _z, i);
+				continue;
+			}
+
+			bool IsCover = true;
+			for (int z = 0; z < GRID_SIZE; z++)
+			{
+				for (int x = 0; x < GRID_SIZE; x++)
+				{
+					bool IsInHole = x >= HoleX && x < HoleX + GRID_SIZE / 2 && z >= HoleZ && z < HoleZ + GRID_SIZE / 2;
+					IsCover = IsCover && Cover[z * GRID_SIZE + x] == (IsInHole ? 0 : 2);
+				}
+			}
+
+			// 内側の外周の偶数番目の頂点は穴の縁の頂点と同じ位置で, 奇数番目の頂点は両隣の中点にある.
+			bool IsSeam = true;
+			for (int j = 0; j <= GRID_SIZE; j++)
+			{
+				const int Edge[4][2] = { { j, 0 }, { j, GRID_SIZE }, { 0, j }, { GRID_SIZE, j } };
+				for (int e = 0; e < 4; e++)
+				{
+					int InnerIndex = Inner + Edge[e][1] * PITCH + Edge[e][0];
+					int OuterX0 = HoleX + Edge[e][0] / 2;
+					int OuterZ0 = HoleZ + Edge[e][1] / 2;
+					int OuterX1 = HoleX + (Edge[e][0] + 1) / 2;
+					int OuterZ1 = HoleZ + (Edge[e][1] + 1) / 2;
+					int OuterIndex0 = Outer + OuterZ0 * PITCH + OuterX0;
+					int OuterIndex1 = Outer + OuterZ1 * PITCH + OuterX1;
+
+					IsSeam = IsSeam &&
+						pX[InnerIndex] == (pX[OuterIndex0] + pX[OuterIndex1]) * 0.5f &&
+						pZ[InnerIndex] == (pZ[OuterIndex0] + pZ[OuterIndex1]) * 0.5f;
+				}
+			}
+
+			bool IsCoverChecked = TEST_CHECK(IsCover);
+			bool IsSeamChecked = TEST_CHECK(IsSeam);
+			if (!IsCoverChecked || !IsSeamChecked)
+			{
+				printf("  seam: camera (%f, %f) level %d\n", _x, _z, i);
+			}
+		}
+	}
+}
+
+
+int main()
+{
+	// 4の倍数でないセル数は作成できない.
+	WaterClipmap Invalid(LEVEL_NUM, 18, CELL_SIZE);
+	TEST_CHECK(!Invalid.Initialize());
+
+	WaterClipmap Clipmap(LEVEL_NUM, GRID_SIZE, CELL_SIZE);
+	if (!TEST_CHECK(Clipmap.Initialize()))
+	{
+		return TestUtility::Finish("WaterClipmapTest");
+	}
+	Clipmap.SetFadeLevel(FADE_LEVEL);
+
+	// 頂点は全てのレベルで(N+1) x (N+1)個で, レベル0は全体を, それ以外は中央のN/2 x N/2セルを除いて描画する.
+	TEST_CHECK(Clipmap.GetLevelVertexNum() == PITCH * PITCH);
+	TEST_CHECK(Clipmap.GetVertexNum() == LEVEL_NUM * PITCH * PITCH);
+	TEST_CHECK(Clipmap.Update(0.0f, 0.0f));
+	TEST_CHECK(Clipmap.GetIndexNum(0) == GRID_SIZE * GRID_SIZE * 6);
+	for (int i = 1; i < LEVEL_NUM; i++)
+	{
+		TEST_CHECK(Clipmap.GetIndexNum(i) == (GRID_SIZE * GRID_SIZE - GRID_SIZE * GRID_SIZE / 4) * 6);
+		TEST_CHECK(Clipmap.GetBaseVertex(i) == i * PITCH * PITCH);
+	}
+
+	// カメラがどこにあっても, 内側のレベルは外側のレベルの穴にひび割れなく収まる.
+	const float CameraX[] = { 0.0f, 0.3f, 1.7f, -3.2f, 13.9f, -27.4f, 100.6f };
+	const float CameraZ[] = { 0.0f, 0.2f, -2.6f, 5.1f, -11.3f, 42.8f, -99.1f };
+	for (int i = 0; i < 7; i++)
+	{
+		Clipmap.Update(CameraX[i], CameraZ[i]);
+		CheckSeam(Clipmap, CameraX[i], CameraZ[i]);
+	}
+
+	// 外側のレベルのセルより小さい移動では頂点は変わらない.
+	Clipmap.Update(0.05f, 0.05f);
+	TEST_CHECK(!Clipmap.Update(0.1f, 0.1f));
+	TEST_CHECK(Clipmap.Update(0.05f + CELL_SIZE * 4.0f, 0.05f));
+
+	// 変位の重みはフェードするレベルより内側で1, 外側で0, フェードするレベルの外周で0になる.
+	const float* pWeight = Clipmap.GetWeight();
+	bool IsWeight = true;
+	for (int i = 0; i < LEVEL_NUM; i++)
+	{
+		const float* pLevel = pWeight + Clipmap.GetBaseVertex(i);
+		for (int v = 0; v < PITCH * PITCH; v++)
+		{
+			int x = v % PITCH;
+			int z = v / PITCH;
+			bool IsOuterEdge = x == 0 || z == 0 || x == GRID_SIZE || z == GRID_SIZE;
+			if (i < FADE_LEVEL)
+			{
+				IsWeight = IsWeight && pLevel[v] == 1.0f;
+			}
+			else if (i > FADE_LEVEL || IsOuterEdge)
+			{
+				IsWeight = IsWeight && pLevel[v] == 0.0f;
+			}
+			else
+			{
+				IsWeight = IsWeight && pLevel[v] >= 0.0f && pLevel[v] <= 1.0f;
+			}
+		}
+	}
+	TEST_CHECK(IsWeight);
+
+	// Stitchで外周の奇数番目の頂点の値が両隣の平均になる.
+	std::vector<float> Value(Clipmap.GetVertexNum());
+	for (size_t i = 0; i < Value.size(); i++)
+	{
+		Value[i] = static_cast<float>((i * 7919) % 101);
+	}
+	Clipmap.Stitch(&Value[0], LEVEL_NUM);
+	bool IsStitch = true;
+	for (int i = 0; i < LEVEL_NUM; i++)
+	{
+		const float* pLevel = &Value[Clipmap.GetBaseVertex(i)];
+		for (int j = 1; j < GRID_SIZE; j += 2)
+		{
+			int Last = GRID_SIZE * PITCH;
+			IsStitch = IsStitch &&
+				pLevel[j] == (pLevel[j - 1] + pLevel[j + 1]) * 0.5f &&
+				pLevel[Last + j] == (pLevel[Last + j - 1] + pLevel[Last + j + 1]) * 0.5f &&
+				pLevel[j * PITCH] == (pLevel[(j - 1) * PITCH] + pLevel[(j + 1) * PITCH]) * 0.5f &&
+				pLevel[j * PITCH + GRID_SIZE] == (pLevel[(j - 1) * PITCH + GRID_SIZE] + pLevel[(j + 1) * PITCH + GRID_SIZE]) * 0.5f;
+		}
+	}
+	TEST_CHECK(IsStitch);
+
+	Clipmap.Finalize();
+
+	return TestUtility::Finish("WaterClipmapTest");
+}
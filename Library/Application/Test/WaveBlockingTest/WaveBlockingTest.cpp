@@ -0,0 +1,89 @@
+﻿/**
+ * @file	WaveBlockingTest.cpp
+ * @brief	波シミュレーションの時間ブロッキングのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+	const int TileSize[][2] = { { 64, 32 }, { 16, 8 }, { 40, 13 }, { WaveTestUtility::m_Width, WaveTestUtility::m_Height } };
+	const int TileSizeNum = sizeof(TileSize) / sizeof(TileSize[0]);
+
+	// 基準はK=1の結果.
+	WaveTestUtility::CONFIG Reference = WaveTestUtility::GetReferenceConfig();
+	WaveTestUtility::STATE ReferenceState;
+	if (TEST_CHECK(WaveTestUtility::Run(Reference, &ReferenceState)))
+	{
+		TEST_CHECK(WaveTestUtility::IsWaveMoved(ReferenceState));
+
+		// Kステップ分をまとめて進めても, ステップ数がKで割り切れなくても同じ結果になる.
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int t = 0; t < TileSizeNum; t++)
+			{
+				for (int k = 2; k <= 4; k++)
+				{
+					for (int p = 0; p < 2; p++)
+					{
+						WaveTestUtility::CONFIG Config = Reference;
+						Config.SimdType = SimdTypes[s];
+						Config.TileWidth = TileSize[t][0];
+						Config.TileHeight = TileSize[t][1];
+						Config.BlockStepNum = k;
+						Config.pThreadPool = p == 0 ? nullptr : &Pool;
+						WaveTestUtility::CheckSame(Config, ReferenceState, "block");
+					}
+				}
+			}
+		}
+	}
+
+	// スパース更新は休止の判定がKステップごとになるので, 同じ設定のスカラー, 1スレッドの結果と比較する.
+	for (int t = 0; t < TileSizeNum; t++)
+	{
+		WaveTestUtility::CONFIG SparseReference = Reference;
+		SparseReference.TileWidth = TileSize[t][0];
+		SparseReference.TileHeight = TileSize[t][1];
+		SparseReference.BlockStepNum = 4;
+		SparseReference.IsSparse = true;
+
+		WaveTestUtility::STATE SparseState;
+		if (!TEST_CHECK(WaveTestUtility::Run(SparseReference, &SparseState)))
+		{
+			continue;
+		}
+
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int p = 0; p < 2; p++)
+			{
+				WaveTestUtility::CONFIG Config = SparseReference;
+				Config.SimdType = SimdTypes[s];
+				Config.pThreadPool = p == 0 ? nullptr : &Pool;
+				WaveTestUtility::CheckSame(Config, SparseState, "sparse block");
+			}
+		}
+	}
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("WaveBlockingTest");
+}
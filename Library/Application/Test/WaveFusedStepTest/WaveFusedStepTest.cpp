@@ -0,0 +1,109 @@
+﻿/**
+ * @file	WaveFusedStepTest.cpp
+ * @brief	波マップと法線マップを同時に書き込むステップのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cstdio>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+namespace
+{
+	/**
+	 * StepWithMapと, 更新前のWriteNormalMap, Step, 更新後のWriteWaveMapを順に呼んだ結果を比較する
+	 * @param[in] _config 設定
+	 * @param[in] _pCase 出力する比較の名前
+	 */
+	void CheckFused(const WaveTestUtility::CONFIG& _config, const char* _pCase)
+	{
+		const int Width = WaveTestUtility::m_Width;
+		const int Height = WaveTestUtility::m_Height;
+		const int RowPitch = Width * 4;
+
+		WaveSimulator Fused(Width, Height);
+		WaveSimulator Separate(Width, Height);
+		if (!TEST_CHECK(WaveTestUtility::Prepare(_config, &Fused)) ||
+			!TEST_CHECK(WaveTestUtility::Prepare(_config, &Separate)))
+		{
+			return;
+		}
+
+		// 休止中のタイルは書き込まれないので, 書き込み先は同じ内容で始める.
+		std::vector<unsigned char> FusedWaveMap(RowPitch * Height, 0);
+		std::vector<unsigned char> FusedNormalMap(RowPitch * Height, 0);
+		std::vector<unsigned char> SeparateWaveMap(RowPitch * Height, 0);
+		std::vector<unsigned char> SeparateNormalMap(RowPitch * Height, 0);
+
+		Fused.StepWithMap(&FusedWaveMap[0], RowPitch, &FusedNormalMap[0], RowPitch);
+
+		Separate.WriteNormalMap(&SeparateNormalMap[0], RowPitch);
+		Separate.Step();
+		Separate.WriteWaveMap(&SeparateWaveMap[0], RowPitch);
+
+		bool IsSameWaveMap = TEST_CHECK(FusedWaveMap == SeparateWaveMap);
+		bool IsSameNormalMap = TEST_CHECK(FusedNormalMap == SeparateNormalMap);
+
+		// 書き込みと同時に進めても, 状態は通常のステップと同じになる.
+		Fused.Step();
+		Separate.Step();
+		Fused.WriteWaveMap(&FusedWaveMap[0], RowPitch);
+		Separate.WriteWaveMap(&SeparateWaveMap[0], RowPitch);
+		bool IsSameState = TEST_CHECK(FusedWaveMap == SeparateWaveMap);
+
+		if (!IsSameWaveMap || !IsSameNormalMap || !IsSameState)
+		{
+			printf("  %s: %s tile %dx%d pool=%d wave=%d normal=%d state=%d\n",
+				_pCase, CpuFeature::GetSimdName(_config.SimdType), _config.TileWidth, _config.TileHeight,
+				_config.pThreadPool != nullptr ? 1 : 0,
+				IsSameWaveMap ? 1 : 0, IsSameNormalMap ? 1 : 0, IsSameState ? 1 : 0);
+		}
+
+		Fused.Finalize();
+		Separate.Finalize();
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+
+	const WaveSimulator::PRECISION Precision[] = { WaveSimulator::PRECISION_FLOAT32, WaveSimulator::PRECISION_FIXED16 };
+	const char* const pPrecisionName[] = { "float32", "fixed16" };
+
+	// 浮動小数点と固定小数点のどちらでも, 命令セット, タイル, スレッドによらず同時に書き込んだ結果が一致する.
+	for (int p = 0; p < 2; p++)
+	{
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			WaveTestUtility::CONFIG Config = WaveTestUtility::GetReferenceConfig();
+			Config.Precision = Precision[p];
+			Config.SimdType = SimdTypes[s];
+			CheckFused(Config, pPrecisionName[p]);
+
+			Config.TileWidth = 40;
+			Config.TileHeight = 13;
+			Config.pThreadPool = &Pool;
+			CheckFused(Config, pPrecisionName[p]);
+		}
+	}
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("WaveFusedStepTest");
+}
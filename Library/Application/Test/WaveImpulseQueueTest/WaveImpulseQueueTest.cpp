@@ -0,0 +1,239 @@
+﻿/**
+ * @file	WaveImpulseQueueTest.cpp
+ * @brief	波の追加要求キューのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSimulator.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+namespace
+{
+	const int RAIN_MAP_SIZE = 200;			//!< 雨の波を追加する波マップの大きさ(Waterと同じく1あたり5セル).
+	const float RAIN_AREA_SIZE = 40.0f;		//!< 波マップが覆うワールド座標の大きさ.
+	const int RAIN_DROP_NUM = 32;			//!< 1ステップに着水する雨粒の数(Rainの最大数を面積で割ったもの).
+	const float RAIN_RADIUS = 1.0f;			//!< 雨粒の波の半径(Rain::m_WaveRadius).
+	const float RAIN_STRENGTH = 0.01f;		//!< 雨粒の波の強さ(Rain::m_WaveStrength).
+	const int RAIN_STEP_NUM = 1000;			//!< 雨を降らせ続けるステップ数.
+	const float MAX_MEAN_OFFSET = 0.01f;	//!< 平均の高さと静止時の高さの差の上限.
+	const float MAX_CLAMP_RATIO = 0.001f;	//!< 0か1に張り付いたセルの割合の上限.
+
+	/**
+	 * 雨の波を降らせ続けた結果
+	 */
+	struct RAIN_RESULT
+	{
+		float MeanHeight;	//!< 平均の高さ.
+		float ClampRatio;	//!< 0か1に張り付いたセルの割合.
+	};
+
+	/**
+	 * 雨粒の波を毎ステップ追加し続ける
+	 * @param[in] _isDrop 着水の波(PushWorldDrop)で追加するか(falseならPushWorld)
+	 * @param[in] _precision 計算精度
+	 * @param[out] _pResult 結果の出力先
+	 * @return 実行に成功したらtrue
+	 */
+	bool RunRain(bool _isDrop, WaveSimulator::PRECISION _precision, RAIN_RESULT* _pResult)
+	{
+		WaveSimulator Simulator(RAIN_MAP_SIZE, RAIN_MAP_SIZE);
+		if (!Simulator.Initialize())
+		{
+			return false;
+		}
+
+		Simulator.SetPrecision(_precision);
+
+		WaveImpulseQueue Queue;
+		Queue.SetWorldArea(0.0f, RAIN_AREA_SIZE, RAIN_AREA_SIZE, RAIN_AREA_SIZE);
+		Simulator.SetImpulseQueue(&Queue);
+
+		// 乱数は環境によらず同じ値にするため線形合同法で作る.
+		unsigned int Random = 12345;
+		std::vector<float> DropX(RAIN_DROP_NUM);
+		std::vector<float> DropZ(RAIN_DROP_NUM);
+		for (int i = 0; i < RAIN_STEP_NUM; i++)
+		{
+			for (int j = 0; j < RAIN_DROP_NUM; j++)
+			{
+				Random = Random * 1664525u + 1013904223u;
+				DropX[j] = static_cast<float>(Random >> 8) / 16777216.0f * RAIN_AREA_SIZE;
+				Random = Random * 1664525u + 1013904223u;
+				DropZ[j] = static_cast<float>(Random >> 8) / 16777216.0f * RAIN_AREA_SIZE;
+			}
+
+			if (_isDrop)
+			{
+				Queue.PushWorldDrop(&DropX[0], &DropZ[0], RAIN_DROP_NUM, RAIN_RADIUS, RAIN_STRENGTH);
+			}
+			else
+			{
+				Queue.PushWorld(&DropX[0], &DropZ[0], RAIN_DROP_NUM, RAIN_RADIUS, RAIN_STRENGTH);
+			}
+
+			Simulator.Step();
+		}
+
+		double HeightSum = 0.0;
+		int ClampNum = 0;
+		for (int y = 0; y < RAIN_MAP_SIZE; y++)
+		{
+			for (int x = 0; x < RAIN_MAP_SIZE; x++)
+			{
+				float Height = Simulator.GetWaveHeight(x, y);
+				HeightSum += Height;
+				ClampNum += (Height <= 0.0f || Height >= 1.0f) ? 1 : 0;
+			}
+		}
+
+		_pResult->MeanHeight = static_cast<float>(HeightSum / (RAIN_MAP_SIZE * RAIN_MAP_SIZE));
+		_pResult->ClampRatio = static_cast<float>(ClampNum) / (RAIN_MAP_SIZE * RAIN_MAP_SIZE);
+
+		Simulator.Finalize();
+
+		return true;
+	}
+}
+
+
+int main()
+{
+	// 外部のキューに追加した波はAddWaveと同じ結果になり, ステップで取り出される.
+	{
+		WaveSimulator Added(WaveTestUtility::m_Width, WaveTestUtility::m_Height);
+		WaveSimulator Queued(WaveTestUtility::m_Width, WaveTestUtility::m_Height);
+		WaveImpulseQueue Queue;
+		if (TEST_CHECK(Added.Initialize() && Queued.Initialize()))
+		{
+			Queued.SetImpulseQueue(&Queue);
+
+			// 同じセルに重なる波と, タイルの境界にかかる波を1ステップにまとめて追加する.
+			const WaveImpulseQueue::IMPULSE Impulse[] =
+			{
+				{ 0.3f, 0.4f, 0.05f, 0.3f },
+				{ 0.31f, 0.41f, 0.04f, -0.1f },
+				{ 0.62f, 0.25f, 0.03f, 0.2f },
+			};
+			const int ImpulseNum = sizeof(Impulse) / sizeof(Impulse[0]);
+			for (int i = 0; i < ImpulseNum; i++)
+			{
+				Added.AddWave(Impulse[i].U, Impulse[i].V, Impulse[i].Radius, Impulse[i].Strength);
+			}
+			Queue.Push(Impulse, ImpulseNum);
+			TEST_CHECK(Queue.GetImpulseNum() == ImpulseNum);
+
+			Added.Step(5);
+			Queued.Step(5);
+			TEST_CHECK(Queue.GetImpulseNum() == 0);
+
+			bool IsSame = true;
+			for (int y = 0; y < WaveTestUtility::m_Height; y++)
+			{
+				for (int x = 0; x < WaveTestUtility::m_Width; x++)
+				{
+					IsSame = IsSame && Added.GetWaveHeight(x, y) == Queued.GetWaveHeight(x, y) && Added.GetWaveVelocity(x, y) == Queued.GetWaveVelocity(x, y);
+				}
+			}
+			TEST_CHECK(IsSame);
+			TEST_CHECK(Added.GetWaveHeight(61, 56) != WaveSimulator::m_DefaultWaveHeight);
+		}
+	}
+
+	// ワールド座標はvがz軸と逆向きのテクスチャ座標に変換される.
+	{
+		WaveImpulseQueue Queue;
+		Queue.SetWorldArea(-10.0f, 30.0f, 40.0f, 20.0f);
+
+		const float X = 10.0f;
+		const float Z = 25.0f;
+		Queue.PushWorld(X, Z, 2.0f, 0.5f);
+		Queue.PushWorldDrop(&X, &Z, 1, 2.0f, 0.5f);
+
+		std::vector<WaveImpulseQueue::IMPULSE> Impulse;
+		Queue.PopAll(&Impulse);
+		if (TEST_CHECK(Impulse.size() == 2))
+		{
+			for (int i = 0; i < 2; i++)
+			{
+				TEST_CHECK(std::fabs(Impulse[i].U - 0.5f) < 1e-6f);
+				TEST_CHECK(std::fabs(Impulse[i].V - 0.25f) < 1e-6f);
+				TEST_CHECK(std::fabs(Impulse[i].Radius - 0.05f) < 1e-6f);
+				TEST_CHECK(Impulse[i].Strength == 0.5f);
+			}
+			TEST_CHECK(!Impulse[0].IsDrop);
+			TEST_CHECK(Impulse[1].IsDrop);
+		}
+		TEST_CHECK(Queue.GetImpulseNum() == 0);
+	}
+
+	// 着水の波は中心が強さの分だけ下がり, 波マップの端にかかっても合計が0になる.
+	{
+		const int Width = 64;
+		const int Height = 48;
+		const WaveImpulseQueue::IMPULSE Drop[] =
+		{
+			{ 0.5f, 0.5f, 0.1f, 0.01f, true },
+			{ 0.02f, 0.97f, 0.15f, 0.01f, true },
+		};
+
+		for (int i = 0; i < 2; i++)
+		{
+			double Sum = 0.0;
+			double Magnitude = 0.0;
+			for (int y = 0; y < Height; y++)
+			{
+				for (int x = 0; x < Width; x++)
+				{
+					double Velocity = WaveImpulseQueue::GetDropVelocity(Drop[i], x, y, Width, Height);
+					Sum += Velocity;
+					Magnitude += std::fabs(Velocity);
+				}
+			}
+
+			TEST_CHECK(Magnitude > 0.01);
+			TEST_CHECK(std::fabs(Sum) < Magnitude * 1e-12);
+		}
+
+		double CenterVelocity = WaveImpulseQueue::GetDropVelocity(Drop[0], Width / 2, Height / 2, Width, Height);
+		TEST_CHECK(std::fabs(CenterVelocity + Drop[0].Strength) < Drop[0].Strength * 0.1);
+		TEST_CHECK(WaveImpulseQueue::GetDropVelocity(Drop[0], Width / 2 + 6, Height / 2, Width, Height) > 0.0);
+		TEST_CHECK(WaveImpulseQueue::GetDropVelocity(Drop[0], Width / 2 + 9, Height / 2, Width, Height) == 0.0);
+	}
+
+	// 雨粒の波を降らせ続けても, 着水の波なら平均の高さは静止時のまま変わらず, 0や1に張り付かない.
+	const WaveSimulator::PRECISION Precision[] = { WaveSimulator::PRECISION_FLOAT32, WaveSimulator::PRECISION_FIXED16 };
+	for (int i = 0; i < 2; i++)
+	{
+		RAIN_RESULT DropResult = {};
+		if (TEST_CHECK(RunRain(true, Precision[i], &DropResult)))
+		{
+			bool IsRest = TEST_CHECK(std::fabs(DropResult.MeanHeight - WaveSimulator::m_DefaultWaveHeight) < MAX_MEAN_OFFSET);
+			bool IsNotClamp = TEST_CHECK(DropResult.ClampRatio < MAX_CLAMP_RATIO);
+			if (!IsRest || !IsNotClamp)
+			{
+				printf("  drop: precision %d mean %f clamp %f\n", i, DropResult.MeanHeight, DropResult.ClampRatio);
+			}
+		}
+	}
+
+	// 押し上げるだけの波は水面全体を持ち上げる(比較のための確認).
+	RAIN_RESULT PushResult = {};
+	if (TEST_CHECK(RunRain(false, WaveSimulator::PRECISION_FLOAT32, &PushResult)))
+	{
+		if (!TEST_CHECK(PushResult.MeanHeight > WaveSimulator::m_DefaultWaveHeight + MAX_MEAN_OFFSET))
+		{
+			printf("  push: mean %f clamp %f\n", PushResult.MeanHeight, PushResult.ClampRatio);
+		}
+	}
+
+	return TestUtility::Finish("WaveImpulseQueueTest");
+}
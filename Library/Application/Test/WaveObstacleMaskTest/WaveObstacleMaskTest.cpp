@@ -0,0 +1,187 @@
+﻿/**
+ * @file	WaveObstacleMaskTest.cpp
+ * @brief	障害物マスクを使用した波シミュレーションのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cstdio>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+namespace
+{
+	const int WALL_MAP_WIDTH = 128;		//!< 壁の確認に使用する波マップの幅.
+	const int WALL_MAP_HEIGHT = 64;		//!< 壁の確認に使用する波マップの高さ.
+	const int WALL_X = 64;				//!< 壁の中心のx座標.
+
+	/**
+	 * 波マップを上下に貫く壁の左側に波を追加し, 壁の右側に波が伝わらないか確認する
+	 * @param[in] _precision 計算精度
+	 * @param[in] _simdType 命令セット
+	 */
+	void CheckWall(WaveSimulator::PRECISION _precision, CpuFeature::SIMD_TYPE _simdType)
+	{
+		WaveObstacleMask Wall;
+		Wall.SetWorldArea(0.0f, static_cast<float>(WALL_MAP_HEIGHT), static_cast<float>(WALL_MAP_WIDTH), static_cast<float>(WALL_MAP_HEIGHT));
+		Wall.AddRect(static_cast<float>(WALL_X), WALL_MAP_HEIGHT * 0.5f, 1.0f, WALL_MAP_HEIGHT * 0.5f + 1.0f, 0.0f);
+		if (!TEST_CHECK(Wall.Build(WALL_MAP_WIDTH, WALL_MAP_HEIGHT)))
+		{
+			return;
+		}
+
+		for (int y = 0; y < WALL_MAP_HEIGHT; y++)
+		{
+			TEST_CHECK(Wall.IsSolid(WALL_X, y));
+		}
+
+		WaveSimulator Simulator(WALL_MAP_WIDTH, WALL_MAP_HEIGHT);
+		if (!TEST_CHECK(Simulator.Initialize()) || !TEST_CHECK(Simulator.SetObstacleMask(&Wall)))
+		{
+			return;
+		}
+
+		Simulator.SetSimdType(_simdType);
+		Simulator.SetPrecision(_precision);
+		Simulator.SetIsSparse(false);
+		Simulator.AddWave(0.3f, 0.5f, 0.1f, 0.8f);
+		Simulator.Step(200);
+
+		const int RowPitch = WALL_MAP_WIDTH * 4;
+		std::vector<unsigned char> WaveMap(RowPitch * WALL_MAP_HEIGHT);
+		Simulator.WriteWaveMap(&WaveMap[0], RowPitch);
+
+		// 右端の高さは動いておらず, 壁の右側は全て同じ高さのまま.
+		const unsigned char Rest = WaveMap[(WALL_MAP_WIDTH - 1) * 4];
+		bool IsLeftMoved = false;
+		bool IsRightRest = true;
+		for (int y = 0; y < WALL_MAP_HEIGHT; y++)
+		{
+			for (int x = 0; x < WALL_MAP_WIDTH; x++)
+			{
+				unsigned char Height = WaveMap[y * RowPitch + x * 4];
+				if (x < WALL_X - 1)
+				{
+					IsLeftMoved = IsLeftMoved || Height != Rest;
+				}
+				else if (x > WALL_X + 1)
+				{
+					IsRightRest = IsRightRest && Height == Rest;
+				}
+			}
+		}
+
+		bool IsLeftMovedChecked = TEST_CHECK(IsLeftMoved);
+		bool IsRightRestChecked = TEST_CHECK(IsRightRest);
+		if (!IsLeftMovedChecked || !IsRightRestChecked)
+		{
+			printf("  wall: precision %d %s\n", static_cast<int>(_precision), CpuFeature::GetSimdName(_simdType));
+		}
+
+		Simulator.Finalize();
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+	const int TileSize[][2] = { { 64, 32 }, { 16, 8 }, { 40, 13 }, { WaveTestUtility::m_Width, WaveTestUtility::m_Height } };
+	const int TileSizeNum = sizeof(TileSize) / sizeof(TileSize[0]);
+
+	// 矩形の中心は障害物になり, 離れたセルは障害物にならない(vはz軸と逆向き).
+	WaveObstacleMask ObstacleMask;
+	if (!TEST_CHECK(WaveTestUtility::BuildObstacleMask(&ObstacleMask)))
+	{
+		return TestUtility::Finish("WaveObstacleMaskTest");
+	}
+	TEST_CHECK(ObstacleMask.IsSolid(70, WaveTestUtility::m_Height - 80));
+	TEST_CHECK(ObstacleMask.IsSolid(150, WaveTestUtility::m_Height - 40));
+	TEST_CHECK(!ObstacleMask.IsSolid(160, WaveTestUtility::m_Height - 40));
+	TEST_CHECK(!ObstacleMask.IsSolid(10, 10));
+
+	// 壁で波が反射し, 反対側には伝わらない.
+	for (size_t s = 0; s < SimdTypes.size(); s++)
+	{
+		CheckWall(WaveSimulator::PRECISION_FLOAT32, SimdTypes[s]);
+		CheckWall(WaveSimulator::PRECISION_FIXED16, SimdTypes[s]);
+	}
+
+	// 基準は障害物あり, スカラー, 64x32タイル, K=1, 1スレッドの結果.
+	WaveTestUtility::CONFIG Reference = WaveTestUtility::GetReferenceConfig();
+	Reference.pObstacleMask = &ObstacleMask;
+	WaveTestUtility::STATE ReferenceState;
+	if (TEST_CHECK(WaveTestUtility::Run(Reference, &ReferenceState)))
+	{
+		// 障害物がない場合とは結果が異なる.
+		WaveTestUtility::STATE OpenState;
+		if (TEST_CHECK(WaveTestUtility::Run(WaveTestUtility::GetReferenceConfig(), &OpenState)))
+		{
+			TEST_CHECK(!WaveTestUtility::IsSameState(ReferenceState, OpenState));
+		}
+
+		// 障害物があっても, 命令セット, タイル, 時間ブロッキング, スレッドによらず同じ結果になる.
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int t = 0; t < TileSizeNum; t++)
+			{
+				for (int k = 1; k <= 4; k++)
+				{
+					for (int p = 0; p < 2; p++)
+					{
+						WaveTestUtility::CONFIG Config = Reference;
+						Config.SimdType = SimdTypes[s];
+						Config.TileWidth = TileSize[t][0];
+						Config.TileHeight = TileSize[t][1];
+						Config.BlockStepNum = k;
+						Config.pThreadPool = p == 0 ? nullptr : &Pool;
+						WaveTestUtility::CheckSame(Config, ReferenceState, "mask");
+					}
+				}
+			}
+		}
+	}
+
+	// スパース更新は同じタイルのスカラー, 1スレッドの結果と比較する.
+	for (int t = 0; t < TileSizeNum; t++)
+	{
+		WaveTestUtility::CONFIG SparseReference = Reference;
+		SparseReference.TileWidth = TileSize[t][0];
+		SparseReference.TileHeight = TileSize[t][1];
+		SparseReference.IsSparse = true;
+
+		WaveTestUtility::STATE SparseState;
+		if (!TEST_CHECK(WaveTestUtility::Run(SparseReference, &SparseState)))
+		{
+			continue;
+		}
+
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int p = 0; p < 2; p++)
+			{
+				WaveTestUtility::CONFIG Config = SparseReference;
+				Config.SimdType = SimdTypes[s];
+				Config.pThreadPool = p == 0 ? nullptr : &Pool;
+				WaveTestUtility::CheckSame(Config, SparseState, "sparse mask");
+			}
+		}
+	}
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("WaveObstacleMaskTest");
+}
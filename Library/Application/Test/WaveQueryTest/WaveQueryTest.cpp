@@ -0,0 +1,252 @@
+﻿/**
+ * @file	WaveQueryTest.cpp
+ * @brief	波の高さ取得のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSimulator.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveQuery\WaveQuery.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const int MAP_WIDTH = 37;			//!< 高さ配列の幅(SIMDの幅で割り切れない大きさ).
+	const int MAP_HEIGHT = 23;			//!< 高さ配列の高さ.
+	const int MAP_STRIDE = 40;			//!< 高さ配列の1行分の要素数.
+	const float MIN_X = -5.0f;			//!< 高さ配列の左端のx座標.
+	const float MAX_Z = 10.0f;			//!< 高さ配列の上端のz座標.
+	const float CELL_SIZE = 2.0f;		//!< 1セルのワールド座標での大きさ.
+	const float SLOPE_X = 0.01f;		//!< 斜面の1セルあたりのx方向の傾き.
+	const float SLOPE_Y = 0.02f;		//!< 斜面の1セルあたりのy方向(z軸と逆向き)の傾き.
+	const int QUERY_NUM = 1003;			//!< SIMDの比較で取得する座標の数(SIMDの幅で割り切れない数).
+
+	/**
+	 * 取得結果
+	 */
+	struct RESULT
+	{
+		std::vector<float>	Height;		//!< 高さ.
+		std::vector<float>	NormalX;	//!< 法線のx成分.
+		std::vector<float>	NormalY;	//!< 法線のy成分.
+		std::vector<float>	NormalZ;	//!< 法線のz成分.
+	};
+
+	/**
+	 * セルの中心のワールド座標を求める
+	 * @param[in] _x セルのx座標(小数も可)
+	 * @param[in] _y セルのy座標(小数も可)
+	 * @param[out] _pX x座標の出力先
+	 * @param[out] _pZ z座標の出力先
+	 */
+	void GetCellPosition(float _x, float _y, float* _pX, float* _pZ)
+	{
+		*_pX = MIN_X + (_x + 0.5f) * CELL_SIZE;
+		*_pZ = MAX_Z - (_y + 0.5f) * CELL_SIZE;
+	}
+
+	/**
+	 * 高さ配列から取得する
+	 * @param[in] _height 高さ配列
+	 * @param[in] _simdType 命令セット
+	 * @param[in] _x 取得する座標のx
+	 * @param[in] _z 取得する座標のz
+	 * @param[out] _pResult 結果の出力先
+	 */
+	void Query(const std::vector<float>& _height, CpuFeature::SIMD_TYPE _simdType, const std::vector<float>& _x, const std::vector<float>& _z, RESULT* _pResult)
+	{
+		size_t Count = _x.size();
+		_pResult->Height.assign(Count, 0.0f);
+		_pResult->NormalX.assign(Count, 0.0f);
+		_pResult->NormalY.assign(Count, 0.0f);
+		_pResult->NormalZ.assign(Count, 0.0f);
+
+		WaveQuery::OUTPUT Output = { &_pResult->Height[0], &_pResult->NormalX[0], &_pResult->NormalY[0], &_pResult->NormalZ[0] };
+
+		WaveQuery Query;
+		Query.SetWorldArea(MIN_X, MAX_Z, MAP_WIDTH * CELL_SIZE, MAP_HEIGHT * CELL_SIZE);
+		Query.SetSimdType(_simdType);
+		Query.Query(&_height[0], MAP_STRIDE, MAP_WIDTH, MAP_HEIGHT, &_x[0], &_z[0], static_cast<int>(Count), Output);
+	}
+
+	/**
+	 * 2つの取得結果がビット単位で同じか
+	 * @param[in] _a 比較する結果
+	 * @param[in] _b 比較する結果
+	 * @return 同じならtrue
+	 */
+	bool IsSameResult(const RESULT& _a, const RESULT& _b)
+	{
+		size_t Size = _a.Height.size() * sizeof(float);
+		return
+			std::memcmp(&_a.Height[0], &_b.Height[0], Size) == 0 &&
+			std::memcmp(&_a.NormalX[0], &_b.NormalX[0], Size) == 0 &&
+			std::memcmp(&_a.NormalY[0], &_b.NormalY[0], Size) == 0 &&
+			std::memcmp(&_a.NormalZ[0], &_b.NormalZ[0], Size) == 0;
+	}
+}
+
+
+int main()
+{
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+
+	// 斜面の高さ配列(右と下ほど高い).
+	std::vector<float> Slope(MAP_STRIDE * MAP_HEIGHT, -1.0f);
+	for (int y = 0; y < MAP_HEIGHT; y++)
+	{
+		for (int x = 0; x < MAP_WIDTH; x++)
+		{
+			Slope[y * MAP_STRIDE + x] = 0.1f + SLOPE_X * x + SLOPE_Y * y;
+		}
+	}
+
+	// 不規則な高さ配列.
+	std::vector<float> Random(MAP_STRIDE * MAP_HEIGHT, -1.0f);
+	unsigned int Seed = 12345;
+	for (int y = 0; y < MAP_HEIGHT; y++)
+	{
+		for (int x = 0; x < MAP_WIDTH; x++)
+		{
+			Seed = Seed * 1664525 + 1013904223;
+			Random[y * MAP_STRIDE + x] = static_cast<float>(Seed >> 8) / 16777216.0f;
+		}
+	}
+
+	// 範囲外を含む座標.
+	std::vector<float> QueryX(QUERY_NUM);
+	std::vector<float> QueryZ(QUERY_NUM);
+	for (int i = 0; i < QUERY_NUM; i++)
+	{
+		Seed = Seed * 1664525 + 1013904223;
+		float CellX = static_cast<float>(Seed >> 8) / 16777216.0f * (MAP_WIDTH + 8) - 4.5f;
+		Seed = Seed * 1664525 + 1013904223;
+		float CellY = static_cast<float>(Seed >> 8) / 16777216.0f * (MAP_HEIGHT + 8) - 4.5f;
+		GetCellPosition(CellX, CellY, &QueryX[i], &QueryZ[i]);
+	}
+
+	for (size_t s = 0; s < SimdTypes.size(); s++)
+	{
+		const char* pName = CpuFeature::GetSimdName(SimdTypes[s]);
+
+		// 命令セットによらず, 高さと法線がビット単位で同じになる.
+		for (int m = 0; m < 2; m++)
+		{
+			const std::vector<float>& Height = m == 0 ? Slope : Random;
+			RESULT Reference;
+			RESULT Result;
+			Query(Height, CpuFeature::SIMD_SCALAR, QueryX, QueryZ, &Reference);
+			Query(Height, SimdTypes[s], QueryX, QueryZ, &Result);
+			if (!TEST_CHECK(IsSameResult(Reference, Result)))
+			{
+				printf("  simd: %s map %d\n", pName, m);
+			}
+		}
+
+		// 範囲外の座標は端のセルにクランプされる.
+		{
+			std::vector<float> X(4);
+			std::vector<float> Z(4);
+			GetCellPosition(-3.0f, -7.0f, &X[0], &Z[0]);
+			GetCellPosition(MAP_WIDTH + 5.0f, -2.0f, &X[1], &Z[1]);
+			GetCellPosition(-10.0f, MAP_HEIGHT + 9.0f, &X[2], &Z[2]);
+			GetCellPosition(10.25f, MAP_HEIGHT + 0.2f, &X[3], &Z[3]);
+
+			RESULT Result;
+			Query(Random, SimdTypes[s], X, Z, &Result);
+			const int Last = MAP_HEIGHT - 1;
+			bool IsClamp =
+				TEST_CHECK(Result.Height[0] == Random[0]) &&
+				TEST_CHECK(Result.Height[1] == Random[MAP_WIDTH - 1]) &&
+				TEST_CHECK(Result.Height[2] == Random[Last * MAP_STRIDE]) &&
+				TEST_CHECK(std::fabs(Result.Height[3] - (Random[Last * MAP_STRIDE + 10] * 0.75f + Random[Last * MAP_STRIDE + 11] * 0.25f)) < 1e-6f);
+			if (!IsClamp)
+			{
+				printf("  clamp: %s\n", pName);
+			}
+		}
+
+		// 斜面ではセルの間も双線形補間で平面上の高さになり, 法線は下り方向(-x, +z)を向く.
+		{
+			const float CellX[] = { 5.0f, 12.3f, 20.75f, 30.5f };
+			const float CellY[] = { 3.0f, 7.6f, 15.25f, 18.9f };
+			std::vector<float> X(4);
+			std::vector<float> Z(4);
+			for (int i = 0; i < 4; i++)
+			{
+				GetCellPosition(CellX[i], CellY[i], &X[i], &Z[i]);
+			}
+
+			RESULT Result;
+			Query(Slope, SimdTypes[s], X, Z, &Result);
+
+			// セルの(左 - 右, 1, 上 - 下)を正規化したもの.
+			float Length = std::sqrt(4.0f * SLOPE_X * SLOPE_X + 1.0f + 4.0f * SLOPE_Y * SLOPE_Y);
+			float NormalX = -2.0f * SLOPE_X / Length;
+			float NormalY = 1.0f / Length;
+			float NormalZ = -2.0f * SLOPE_Y / Length;
+			for (int i = 0; i < 4; i++)
+			{
+				float Height = 0.1f + SLOPE_X * CellX[i] + SLOPE_Y * CellY[i];
+				bool IsSlope =
+					TEST_CHECK(std::fabs(Result.Height[i] - Height) < 1e-5f) &&
+					TEST_CHECK(std::fabs(Result.NormalX[i] - NormalX) < 1e-5f) &&
+					TEST_CHECK(std::fabs(Result.NormalY[i] - NormalY) < 1e-5f) &&
+					TEST_CHECK(std::fabs(Result.NormalZ[i] - NormalZ) < 1e-5f);
+				if (!IsSlope)
+				{
+					printf("  slope: %s point %d\n", pName, i);
+				}
+			}
+		}
+	}
+
+	// WaveSimulator::QueryHeightは浮動小数点でも固定小数点でも同じ状態なら同じ高さを返す.
+	{
+		const float Size = static_cast<float>(MAP_WIDTH);
+		WaveSimulator Float(MAP_WIDTH, MAP_WIDTH);
+		WaveSimulator Fixed(MAP_WIDTH, MAP_WIDTH);
+		if (TEST_CHECK(Float.Initialize()) && TEST_CHECK(Fixed.Initialize()))
+		{
+			Float.SetWorldArea(0.0f, Size, Size, Size);
+			Fixed.SetWorldArea(0.0f, Size, Size, Size);
+			Float.SetIsSparse(false);
+			Float.AddWave(0.5f, 0.5f, 0.2f, 0.5f);
+			Float.Step(5);
+
+			// 固定小数点で表せる値にそろえてから固定小数点へ切り替える.
+			Float.SetPrecision(WaveSimulator::PRECISION_FIXED16);
+			Float.SetPrecision(WaveSimulator::PRECISION_FLOAT32);
+			Fixed.SetIsSparse(false);
+			Fixed.AddWave(0.5f, 0.5f, 0.2f, 0.5f);
+			Fixed.Step(5);
+			Fixed.SetPrecision(WaveSimulator::PRECISION_FIXED16);
+
+			const float X[] = { 18.5f, 10.2f, -4.0f };
+			const float Z[] = { 18.5f, 30.7f, 50.0f };
+			float FloatHeight[3];
+			float FixedHeight[3];
+			Float.QueryHeight(X, Z, 3, FloatHeight, nullptr, nullptr, nullptr);
+			Fixed.QueryHeight(X, Z, 3, FixedHeight, nullptr, nullptr, nullptr);
+			for (int i = 0; i < 3; i++)
+			{
+				TEST_CHECK(FloatHeight[i] == FixedHeight[i]);
+			}
+			TEST_CHECK(FloatHeight[0] != WaveSimulator::m_DefaultWaveHeight);
+		}
+
+		Float.Finalize();
+		Fixed.Finalize();
+	}
+
+	return TestUtility::Finish("WaveQueryTest");
+}
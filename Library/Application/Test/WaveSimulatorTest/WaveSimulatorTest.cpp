@@ -0,0 +1,43 @@
+﻿/**
+ * @file	WaveSimulatorTest.cpp
+ * @brief	波シミュレーションのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cstdio>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+int main()
+{
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+	for (size_t i = 0; i < SimdTypes.size(); i++)
+	{
+		printf("SIMD: %s\n", CpuFeature::GetSimdName(SimdTypes[i]));
+	}
+
+	// 基準はスカラーの結果.
+	WaveTestUtility::CONFIG Reference = WaveTestUtility::GetReferenceConfig();
+	WaveTestUtility::STATE ReferenceState;
+	if (TEST_CHECK(WaveTestUtility::Run(Reference, &ReferenceState)))
+	{
+		TEST_CHECK(WaveTestUtility::IsWaveMoved(ReferenceState));
+
+		// 命令セットによらず, 高さ, 速度, 波マップ, 法線マップがビット単位で同じになる.
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			WaveTestUtility::CONFIG Config = Reference;
+			Config.SimdType = SimdTypes[s];
+			WaveTestUtility::CheckSame(Config, ReferenceState, "float32");
+		}
+	}
+
+	return TestUtility::Finish("WaveSimulatorTest");
+}
@@ -0,0 +1,277 @@
+﻿/**
+ * @file	WaveSnapshotTest.cpp
+ * @brief	波の状態のスナップショットファイルのテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSimulator.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSnapshot\WaveSnapshot.h"
+#include "Test\TestUtility\TestUtility.h"
+
+
+namespace
+{
+	const int MAP_WIDTH = 67;				//!< 波マップの幅.
+	const int MAP_HEIGHT = 29;				//!< 波マップの高さ.
+	const int MAP_STRIDE = 72;				//!< 配列の1行分の要素数.
+	const char* const FILE_NAME = "WaveSnapshotTest.tmp";	//!< 作業用のファイル名.
+
+	// ヘッダの各項目のファイル先頭からのバイト数(WaveSnapshot::HEADERの並び).
+	const size_t PLANE_OFFSET_POS = 24;		//!< PlaneOffset[0].
+	const size_t PLANE_SIZE_POS = 32;		//!< PlaneSize[0].
+
+	/**
+	 * ファイルの内容を読み込む
+	 * @param[in] _pFileName ファイル名
+	 * @return ファイルの内容
+	 */
+	std::vector<unsigned char> LoadFile(const char* _pFileName)
+	{
+		std::ifstream File(_pFileName, std::ios::binary);
+		return std::vector<unsigned char>(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+	}
+
+	/**
+	 * ファイルに書き込む
+	 * @param[in] _pFileName ファイル名
+	 * @param[in] _data 書き込む内容
+	 */
+	void SaveFile(const char* _pFileName, const std::vector<unsigned char>& _data)
+	{
+		std::ofstream File(_pFileName, std::ios::binary | std::ios::trunc);
+		File.write(reinterpret_cast<const char*>(&_data[0]), _data.size());
+	}
+
+	/**
+	 * ファイル中の32bitの値を取得
+	 * @param[in] _data ファイルの内容
+	 * @param[in] _pos ファイル先頭からのバイト数
+	 * @return 値
+	 */
+	uint32_t GetUint(const std::vector<unsigned char>& _data, size_t _pos)
+	{
+		uint32_t Value;
+		memcpy(&Value, &_data[_pos], sizeof(Value));
+		return Value;
+	}
+
+	/**
+	 * ファイル中の32bitの値を書き換える
+	 * @param[in,out] _pData ファイルの内容
+	 * @param[in] _pos ファイル先頭からのバイト数
+	 * @param[in] _value 値
+	 */
+	void SetUint(std::vector<unsigned char>* _pData, size_t _pos, uint32_t _value)
+	{
+		memcpy(&(*_pData)[_pos], &_value, sizeof(_value));
+	}
+
+	/**
+	 * 書き込んだ値と読み込んだ値がビット単位で同じか
+	 * @param[in] _a 比較する配列
+	 * @param[in] _b 比較する配列
+	 * @return 同じならtrue
+	 */
+	bool IsSamePlane(const std::vector<float>& _a, const std::vector<float>& _b)
+	{
+		for (int y = 0; y < MAP_HEIGHT; y++)
+		{
+			if (memcmp(&_a[y * MAP_STRIDE], &_b[y * MAP_STRIDE], sizeof(float) * MAP_WIDTH) != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * 書き換えたファイルを開けないか
+	 * @param[in] _data 書き換えたファイルの内容
+	 * @return 開けなければtrue
+	 */
+	bool IsRejected(const std::vector<unsigned char>& _data)
+	{
+		SaveFile(FILE_NAME, _data);
+
+		WaveSnapshot Snapshot;
+		return !Snapshot.Open(FILE_NAME);
+	}
+}
+
+
+int main()
+{
+	// 負の値, -0, 非正規化数, 無限大を含む不規則な値と, ほぼ一様な値.
+	std::vector<float> Height(MAP_STRIDE * MAP_HEIGHT, 0.0f);
+	std::vector<float> Velocity(MAP_STRIDE * MAP_HEIGHT, 0.0f);
+	unsigned int Seed = 4321;
+	for (int y = 0; y < MAP_HEIGHT; y++)
+	{
+		for (int x = 0; x < MAP_WIDTH; x++)
+		{
+			Seed = Seed * 1664525 + 1013904223;
+			Height[y * MAP_STRIDE + x] = (static_cast<float>(Seed >> 8) / 16777216.0f - 0.5f) * 4.0f;
+			Velocity[y * MAP_STRIDE + x] = (x + y) % 7 == 0 ? 0.1001f : 0.1f;
+		}
+	}
+	Height[1] = -0.0f;
+	Height[2] = std::numeric_limits<float>::denorm_min();
+	Height[3] = -std::numeric_limits<float>::infinity();
+	Height[MAP_STRIDE + 5] = std::numeric_limits<float>::max();
+
+	const size_t RawPlaneSize = MAP_WIDTH * MAP_HEIGHT * sizeof(float);
+	const WaveSnapshot::ENCODING Encoding[] = { WaveSnapshot::ENCODING_RAW, WaveSnapshot::ENCODING_DELTA };
+	for (int e = 0; e < 2; e++)
+	{
+		const bool IsRaw = Encoding[e] == WaveSnapshot::ENCODING_RAW;
+
+		// 書き込んで読み込むとビット単位で元に戻る.
+		if (!TEST_CHECK(WaveSnapshot::Write(FILE_NAME, MAP_WIDTH, MAP_HEIGHT, &Height[0], &Velocity[0], MAP_STRIDE, Encoding[e])))
+		{
+			continue;
+		}
+
+		std::vector<unsigned char> File = LoadFile(FILE_NAME);
+		{
+			WaveSnapshot Snapshot;
+			if (TEST_CHECK(Snapshot.Open(FILE_NAME)))
+			{
+				TEST_CHECK(Snapshot.GetWidth() == MAP_WIDTH && Snapshot.GetHeight() == MAP_HEIGHT);
+				TEST_CHECK(Snapshot.GetEncoding() == Encoding[e]);
+
+				std::vector<float> ReadHeight(MAP_STRIDE * MAP_HEIGHT, 0.0f);
+				std::vector<float> ReadVelocity(MAP_STRIDE * MAP_HEIGHT, 0.0f);
+				TEST_CHECK(Snapshot.Read(&ReadHeight[0], &ReadVelocity[0], MAP_STRIDE));
+				if (!TEST_CHECK(IsSamePlane(Height, ReadHeight) && IsSamePlane(Velocity, ReadVelocity)))
+				{
+					printf("  round trip: encoding %d\n", e);
+				}
+
+				// 狭い書き込み先には読み込まない.
+				TEST_CHECK(!Snapshot.Read(&ReadHeight[0], &ReadVelocity[0], MAP_WIDTH - 1));
+
+				// 生の面はアライメントされた配列としてそのまま使え, 差分の面は取得できない.
+				const float* pRawHeight = Snapshot.GetRawPlane(WaveSnapshot::PLANE_HEIGHT);
+				if (IsRaw && TEST_CHECK(pRawHeight != nullptr))
+				{
+					TEST_CHECK(reinterpret_cast<uintptr_t>(pRawHeight) % WaveSnapshot::m_PlaneAlignment == 0);
+					TEST_CHECK(memcmp(pRawHeight + MAP_WIDTH, &Height[MAP_STRIDE], sizeof(float) * MAP_WIDTH) == 0);
+				}
+				else if (!IsRaw)
+				{
+					TEST_CHECK(pRawHeight == nullptr);
+				}
+			}
+		}
+
+		// ほぼ一様な速度の面は差分にすると小さくなる.
+		if (!IsRaw)
+		{
+			TEST_CHECK(GetUint(File, PLANE_SIZE_POS + 4) < RawPlaneSize / 2);
+		}
+
+		// 面の内容が壊れていれば開けても読み込みは失敗する.
+		for (int p = 0; p < WaveSnapshot::PLANE_NUM; p++)
+		{
+			std::vector<unsigned char> Broken = File;
+			Broken[GetUint(File, PLANE_OFFSET_POS + p * 4) + GetUint(File, PLANE_SIZE_POS + p * 4) / 2] ^= 0x10;
+			SaveFile(FILE_NAME, Broken);
+
+			WaveSnapshot Snapshot;
+			std::vector<float> ReadHeight(MAP_STRIDE * MAP_HEIGHT);
+			std::vector<float> ReadVelocity(MAP_STRIDE * MAP_HEIGHT);
+			if (TEST_CHECK(Snapshot.Open(FILE_NAME)))
+			{
+				TEST_CHECK(!Snapshot.Read(&ReadHeight[0], &ReadVelocity[0], MAP_STRIDE));
+			}
+		}
+
+		// 途中で切れたファイルは開けない.
+		{
+			std::vector<unsigned char> Truncated(File.begin(), File.end() - 1);
+			TEST_CHECK(IsRejected(Truncated));
+			Truncated.resize(PLANE_SIZE_POS);
+			TEST_CHECK(IsRejected(Truncated));
+		}
+
+		// 面の位置と大きさがファイルに収まらなければ開けない.
+		{
+			std::vector<unsigned char> Broken = File;
+			SetUint(&Broken, PLANE_OFFSET_POS + 4, static_cast<uint32_t>(File.size() + WaveSnapshot::m_PlaneAlignment));
+			TEST_CHECK(IsRejected(Broken));
+
+			Broken = File;
+			SetUint(&Broken, PLANE_OFFSET_POS, 0xffffffc0u);
+			TEST_CHECK(IsRejected(Broken));
+
+			Broken = File;
+			SetUint(&Broken, PLANE_SIZE_POS, 0xffffffffu);
+			TEST_CHECK(IsRejected(Broken));
+
+			Broken = File;
+			SetUint(&Broken, PLANE_OFFSET_POS, 8);
+			TEST_CHECK(IsRejected(Broken));
+		}
+
+		// 生の面はアライメントされていないか, 大きさが合わなければ開けない.
+		if (IsRaw)
+		{
+			std::vector<unsigned char> Broken = File;
+			SetUint(&Broken, PLANE_OFFSET_POS, GetUint(File, PLANE_OFFSET_POS) + 4);
+			TEST_CHECK(IsRejected(Broken));
+
+			Broken = File;
+			SetUint(&Broken, PLANE_SIZE_POS, static_cast<uint32_t>(RawPlaneSize - 4));
+			TEST_CHECK(IsRejected(Broken));
+		}
+	}
+
+	// WaveSimulatorの状態を保存して読み込むと同じ波マップになる.
+	{
+		WaveSimulator Source(MAP_WIDTH, MAP_HEIGHT);
+		WaveSimulator Destination(MAP_WIDTH, MAP_HEIGHT);
+		if (TEST_CHECK(Source.Initialize()) && TEST_CHECK(Destination.Initialize()))
+		{
+			Source.AddWave(0.4f, 0.6f, 0.1f, 0.7f);
+			Source.Step(7);
+			TEST_CHECK(Source.SaveSnapshot(FILE_NAME, WaveSnapshot::ENCODING_DELTA));
+
+			WaveSnapshot Snapshot;
+			if (TEST_CHECK(Snapshot.Open(FILE_NAME)) && TEST_CHECK(Destination.LoadSnapshot(Snapshot)))
+			{
+				std::vector<unsigned char> SourceMap(MAP_WIDTH * MAP_HEIGHT * 4);
+				std::vector<unsigned char> DestinationMap(MAP_WIDTH * MAP_HEIGHT * 4);
+				Source.WriteWaveMap(&SourceMap[0], MAP_WIDTH * 4);
+				Destination.WriteWaveMap(&DestinationMap[0], MAP_WIDTH * 4);
+				TEST_CHECK(SourceMap == DestinationMap);
+			}
+
+			// 大きさの異なるシミュレーションには読み込まない.
+			WaveSimulator Other(MAP_WIDTH + 1, MAP_HEIGHT);
+			if (TEST_CHECK(Other.Initialize()))
+			{
+				TEST_CHECK(!Other.LoadSnapshot(Snapshot));
+			}
+			Other.Finalize();
+		}
+
+		Source.Finalize();
+		Destination.Finalize();
+	}
+
+	std::remove(FILE_NAME);
+
+	return TestUtility::Finish("WaveSnapshotTest");
+}
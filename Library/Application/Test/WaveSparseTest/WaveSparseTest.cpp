@@ -0,0 +1,122 @@
+﻿/**
+ * @file	WaveSparseTest.cpp
+ * @brief	波シミュレーションのスパース更新のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Main\Application\Scene\GameScene\ObjectManager\Water\WaveSimulator\WaveSimulator.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+namespace
+{
+	const int DECAY_SIZE = 256;			//!< 休止を確認する波マップの大きさ.
+	const int DECAY_TILE_SIZE = 32;		//!< 休止を確認するタイルの大きさ.
+	const int DECAY_STEP_NUM = 600;		//!< 全てのタイルが休止するまでのステップ数の上限.
+
+	/**
+	 * 1つの波が減衰して全てのタイルが休止するか確認する
+	 */
+	void CheckSleep(CpuFeature::SIMD_TYPE _simdType)
+	{
+		WaveSimulator Simulator(DECAY_SIZE, DECAY_SIZE);
+		if (!TEST_CHECK(Simulator.Initialize()))
+		{
+			return;
+		}
+
+		Simulator.SetSimdType(_simdType);
+		Simulator.SetTileSize(DECAY_TILE_SIZE, DECAY_TILE_SIZE);
+		Simulator.SetIsSparse(true);
+
+		// 最初のステップは全てのタイルを更新し, 平らなタイルはすぐに休止する.
+		Simulator.Step(2);
+		TEST_CHECK(Simulator.GetActiveTileNum() < Simulator.GetTileNum());
+
+		Simulator.AddWave(0.5f, 0.5f, 0.05f);
+
+		int MaxActiveTileNum = 0;
+		int SleepStep = -1;
+		for (int i = 0; i < DECAY_STEP_NUM && SleepStep < 0; i++)
+		{
+			Simulator.Step();
+			MaxActiveTileNum = std::max(MaxActiveTileNum, Simulator.GetActiveTileNum());
+			if (Simulator.GetActiveTileNum() == 0)
+			{
+				SleepStep = i;
+			}
+		}
+
+		// 波は周囲のタイルに広がってから減衰し, 全てのタイルが休止する.
+		bool IsSpread = TEST_CHECK(MaxActiveTileNum > 4);
+		bool IsSleep = TEST_CHECK(SleepStep >= 0);
+		if (!IsSpread || !IsSleep)
+		{
+			printf("  sleep: %s max active %d/%d, active %d after %d steps\n",
+				CpuFeature::GetSimdName(_simdType), MaxActiveTileNum, Simulator.GetTileNum(),
+				Simulator.GetActiveTileNum(), DECAY_STEP_NUM);
+		}
+
+		Simulator.Finalize();
+	}
+}
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+	const int TileSize[][2] = { { 64, 32 }, { 16, 8 }, { 40, 13 }, { WaveTestUtility::m_Width, WaveTestUtility::m_Height } };
+	const int TileSizeNum = sizeof(TileSize) / sizeof(TileSize[0]);
+
+	// スパース更新は休止の判定がタイルの大きさで変わるので, 同じタイルの大きさのスカラー, 1スレッドの結果と比較する.
+	for (int t = 0; t < TileSizeNum; t++)
+	{
+		WaveTestUtility::CONFIG Reference = WaveTestUtility::GetReferenceConfig();
+		Reference.TileWidth = TileSize[t][0];
+		Reference.TileHeight = TileSize[t][1];
+		Reference.IsSparse = true;
+
+		WaveTestUtility::STATE ReferenceState;
+		if (!TEST_CHECK(WaveTestUtility::Run(Reference, &ReferenceState)))
+		{
+			continue;
+		}
+		TEST_CHECK(WaveTestUtility::IsWaveMoved(ReferenceState));
+
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int p = 0; p < 2; p++)
+			{
+				WaveTestUtility::CONFIG Config = Reference;
+				Config.SimdType = SimdTypes[s];
+				Config.pThreadPool = p == 0 ? nullptr : &Pool;
+				WaveTestUtility::CheckSame(Config, ReferenceState, "sparse");
+			}
+		}
+	}
+
+	for (size_t s = 0; s < SimdTypes.size(); s++)
+	{
+		CheckSleep(SimdTypes[s]);
+	}
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("WaveSparseTest");
+}
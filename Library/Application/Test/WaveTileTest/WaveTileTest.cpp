@@ -0,0 +1,58 @@
+﻿/**
+ * @file	WaveTileTest.cpp
+ * @brief	波シミュレーションのタイル分割と並列更新のテスト
+ * @author	morimoto
+ */
+
+//----------------------------------------------------------------------
+// Include
+//----------------------------------------------------------------------
+#include <vector>
+
+#include "Main\CpuFeature\CpuFeature.h"
+#include "Main\ThreadPool\ThreadPool.h"
+#include "Test\TestUtility\TestUtility.h"
+#include "Test\TestUtility\WaveTestUtility.h"
+
+
+int main()
+{
+	ThreadPool Pool(4);
+	if (!Pool.Initialize())
+	{
+		return 1;
+	}
+
+	std::vector<CpuFeature::SIMD_TYPE> SimdTypes = TestUtility::GetSupportSimdTypes();
+	const int TileSize[][2] = { { 64, 32 }, { 16, 8 }, { 40, 13 }, { WaveTestUtility::m_Width, WaveTestUtility::m_Height } };
+	const int TileSizeNum = sizeof(TileSize) / sizeof(TileSize[0]);
+
+	// 基準はスカラー, 64x32タイル, 1スレッドの結果.
+	WaveTestUtility::CONFIG Reference = WaveTestUtility::GetReferenceConfig();
+	WaveTestUtility::STATE ReferenceState;
+	if (TEST_CHECK(WaveTestUtility::Run(Reference, &ReferenceState)))
+	{
+		TEST_CHECK(WaveTestUtility::IsWaveMoved(ReferenceState));
+
+		// タイルの分け方(割り切れない大きさや1タイルを含む)とスレッドによらず同じ結果になる.
+		for (size_t s = 0; s < SimdTypes.size(); s++)
+		{
+			for (int t = 0; t < TileSizeNum; t++)
+			{
+				for (int p = 0; p < 2; p++)
+				{
+					WaveTestUtility::CONFIG Config = Reference;
+					Config.SimdType = SimdTypes[s];
+					Config.TileWidth = TileSize[t][0];
+					Config.TileHeight = TileSize[t][1];
+					Config.pThreadPool = p == 0 ? nullptr : &Pool;
+					WaveTestUtility::CheckSame(Config, ReferenceState, "tile");
+				}
+			}
+		}
+	}
+
+	Pool.Finalize();
+
+	return TestUtility::Finish("WaveTileTest");
+}